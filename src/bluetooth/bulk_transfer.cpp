@@ -0,0 +1,218 @@
+#include "bulk_transfer.h"
+
+#include <string.h>
+
+static_assert(BLE_BULK_MAX_WINDOW <= 32, "resend_mask_ holds one bit per frame in the window");
+static_assert(BLE_BULK_MAX_FRAME_BYTES > BULK_DATA_HEADER_SIZE, "Frames need room for a payload");
+
+namespace {
+
+void put_u16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+void put_u32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+uint16_t get_u16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+}
+
+bool BulkAck::parse(const uint8_t* data, size_t length) {
+    if (length < 3) {
+        return false;
+    }
+    next_seq = get_u16(data);
+    range_count = data[2];
+    if (range_count > MAX_RANGES || length < 3 + (size_t)range_count * 3) {
+        return false;
+    }
+    for (uint8_t i = 0; i < range_count; i++) {
+        const uint8_t* range = data + 3 + i * 3;
+        range_start[i] = get_u16(range);
+        range_count_frames[i] = range[2];
+    }
+    return true;
+}
+
+bool BulkTransferSender::begin(BulkTransport* transport, BulkSource* source, uint32_t id, uint32_t total_size,
+                               uint32_t start_offset, uint8_t window, uint16_t max_frame_size, uint32_t now_ms) {
+    cancel();
+    if (!transport || !source || start_offset > total_size) {
+        return false;
+    }
+
+    if (max_frame_size == 0) max_frame_size = BLE_BULK_DEFAULT_FRAME_BYTES;
+    if (max_frame_size > BLE_BULK_MAX_FRAME_BYTES) max_frame_size = BLE_BULK_MAX_FRAME_BYTES;
+    if (max_frame_size <= BULK_DATA_HEADER_SIZE) return false;
+    if (window == 0) window = BLE_BULK_DEFAULT_WINDOW;
+    if (window > BLE_BULK_MAX_WINDOW) window = BLE_BULK_MAX_WINDOW;
+
+    transport_ = transport;
+    source_ = source;
+    id_ = id;
+    total_size_ = total_size;
+    start_offset_ = start_offset;
+    payload_size_ = max_frame_size - BULK_DATA_HEADER_SIZE;
+    window_ = window;
+    frame_count_ = (total_size - start_offset + payload_size_ - 1) / payload_size_;
+    base_seq_ = 0;
+    next_seq_ = 0;
+    resend_mask_ = 0;
+    last_progress_ms_ = now_ms;
+    stats_ = BulkTransferStats();
+
+    if (!send_start()) {
+        return false;
+    }
+    active_ = true;
+    return true;
+}
+
+void BulkTransferSender::poll(uint32_t now_ms, uint8_t max_frames) {
+    if (!active_) {
+        return;
+    }
+
+    if (base_seq_ >= frame_count_) {
+        if (send_end(BULK_END_OK)) {
+            active_ = false;
+            complete_ = true;
+        }
+        return;
+    }
+
+    // Nothing acknowledged for a while: the frames or their ACKs were lost - resend the window
+    if (next_seq_ > base_seq_ && now_ms - last_progress_ms_ >= BLE_BULK_ACK_TIMEOUT_MS) {
+        uint32_t outstanding = next_seq_ - base_seq_;
+        resend_mask_ = (outstanding >= 32) ? 0xFFFFFFFFu : ((1u << outstanding) - 1);
+        last_progress_ms_ = now_ms;
+        stats_.timeouts++;
+
+        // Without an ACK the client may never have seen START, and DATA means nothing without it
+        if (stats_.acks_received == 0 && !send_start()) {
+            return;
+        }
+    }
+
+    uint8_t sent = 0;
+    while (resend_mask_ != 0 && sent < max_frames) {
+        uint32_t bit = __builtin_ctz(resend_mask_);
+        if (!send_data(base_seq_ + bit)) {
+            return;
+        }
+        resend_mask_ &= ~(1u << bit);
+        stats_.frames_retransmitted++;
+        sent++;
+    }
+
+    while (next_seq_ < frame_count_ && next_seq_ - base_seq_ < window_ && sent < max_frames) {
+        if (!send_data(next_seq_)) {
+            return;
+        }
+        next_seq_++;
+        sent++;
+    }
+}
+
+void BulkTransferSender::on_ack(const BulkAck& ack, uint32_t now_ms) {
+    if (!active_) {
+        return;
+    }
+    stats_.acks_received++;
+
+    uint32_t acked = seq_from_wire(ack.next_seq);
+    if (acked > base_seq_ && acked <= next_seq_) {
+        uint32_t shift = acked - base_seq_;
+        resend_mask_ = (shift >= 32) ? 0 : (resend_mask_ >> shift);
+        base_seq_ = acked;
+        last_progress_ms_ = now_ms;
+    }
+
+    for (uint8_t i = 0; i < ack.range_count; i++) {
+        uint32_t first = seq_from_wire(ack.range_start[i]);
+        for (uint32_t seq = first; seq < first + ack.range_count_frames[i]; seq++) {
+            if (seq >= base_seq_ && seq < next_seq_ && seq - base_seq_ < 32) {
+                resend_mask_ |= 1u << (seq - base_seq_);
+            }
+        }
+    }
+}
+
+void BulkTransferSender::cancel() {
+    active_ = false;
+    complete_ = false;
+    failed_ = false;
+}
+
+uint32_t BulkTransferSender::acked_bytes() const {
+    uint32_t bytes = base_seq_ * (uint32_t)payload_size_;
+    uint32_t remaining = total_size_ - start_offset_;
+    return bytes < remaining ? bytes : remaining;
+}
+
+uint32_t BulkTransferSender::seq_from_wire(uint16_t seq) const {
+    // Frames on the wire are within a window of base_seq_, so the 16-bit difference is enough
+    return base_seq_ + (int16_t)(uint16_t)(seq - (uint16_t)base_seq_);
+}
+
+bool BulkTransferSender::send_data(uint32_t seq) {
+    uint32_t offset = start_offset_ + seq * (uint32_t)payload_size_;
+    uint32_t length = total_size_ - offset;
+    if (length > payload_size_) {
+        length = payload_size_;
+    }
+
+    frame_[0] = BULK_FRAME_DATA;
+    frame_[1] = 0;
+    put_u16(frame_ + 2, (uint16_t)seq);
+    put_u32(frame_ + 4, offset);
+    if (!source_->read_at(offset, frame_ + BULK_DATA_HEADER_SIZE, length)) {
+        // Tell the client rather than leave it waiting for the timeout
+        if (send_end(BULK_END_READ_ERROR)) {
+            active_ = false;
+            failed_ = true;
+        }
+        return false;
+    }
+    if (!transport_->send_frame(frame_, BULK_DATA_HEADER_SIZE + length)) {
+        return false;
+    }
+    stats_.frames_sent++;
+    return true;
+}
+
+bool BulkTransferSender::send_start() {
+    uint8_t start[20] = {};
+    start[0] = BULK_FRAME_START;
+    start[1] = BULK_PROTOCOL_VERSION;
+    start[2] = window_;
+    put_u16(start + 4, frame_size());
+    put_u32(start + 8, id_);
+    put_u32(start + 12, total_size_);
+    put_u32(start + 16, start_offset_);
+    return transport_->send_frame(start, sizeof(start));
+}
+
+bool BulkTransferSender::send_end(uint8_t status) {
+    uint8_t end[12] = {};
+    end[0] = BULK_FRAME_END;
+    end[1] = status;
+    put_u32(end + 4, id_);
+    put_u32(end + 8, total_size_);
+    return transport_->send_frame(end, sizeof(end));
+}
+
+bool MemoryBulkSource::read_at(uint32_t offset, uint8_t* buffer, size_t length) {
+    if (!data_ || offset > size_ || length > size_ - offset) {
+        return false;
+    }
+    memcpy(buffer, data_ + offset, length);
+    return true;
+}
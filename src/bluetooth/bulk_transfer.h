@@ -0,0 +1,136 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../config/bluetooth.h"
+
+/*
+ * Windowed bulk transfer for the data service - replaces one paced notification per 25 ms
+ * with a sliding window of sequence-numbered frames that the client acknowledges.
+ *
+ * Device -> client (notifications on the data transfer characteristic), little-endian:
+ *   START  [0xB0][version][window][0][frame_size u16][0 u16][id u32][total_size u32][start_offset u32]
+ *   DATA   [0xB1][0][seq u16][offset u32][payload]      seq counts from 0 at start_offset
+ *   END    [0xB2][status][0 u16][id u32][total_size u32] after every frame was acknowledged
+ *
+ * Client -> device (writes to the data control characteristic):
+ *   REQUEST [0x16][session_id u32][offset u32][window u8][max_frame_size u16]
+ *           offset resumes an interrupted transfer; window and frame size 0 take the defaults.
+ *           The frame size is also capped by the negotiated ATT MTU.
+ *   ACK     [0x17][next_seq u16][nack_count u8] then nack_count x [start_seq u16][count u8]
+ *           Every frame before next_seq arrived; the NACK ranges are missing and are resent first.
+ *
+ * Clients ACK at least every window/2 frames and whenever they see a gap or a duplicate. When no
+ * ACK moves the window for BLE_BULK_ACK_TIMEOUT_MS, the sender resends everything unacknowledged,
+ * preceded by START until the first ACK arrives. Clients ignore a repeated identical START.
+ *
+ * The sender only sees the BulkTransport and BulkSource interfaces, so it also runs on the host
+ * against a simulated lossy link (bench-bulk).
+ */
+
+#define BULK_PROTOCOL_VERSION 1
+#define BULK_DATA_HEADER_SIZE 8
+
+enum BulkFrameType : uint8_t {
+    BULK_FRAME_START = 0xB0,
+    BULK_FRAME_DATA = 0xB1,
+    BULK_FRAME_END = 0xB2
+};
+
+enum BulkEndStatus : uint8_t {
+    BULK_END_OK = 0,
+    BULK_END_READ_ERROR = 1
+};
+
+// Outgoing frames. send_frame() returns false when the link cannot take the frame now.
+class BulkTransport {
+public:
+    virtual ~BulkTransport() = default;
+    virtual bool send_frame(const uint8_t* frame, size_t length) = 0;
+};
+
+// Random access to the data being sent, for retransmissions and resumed transfers
+class BulkSource {
+public:
+    virtual ~BulkSource() = default;
+    virtual bool read_at(uint32_t offset, uint8_t* buffer, size_t length) = 0;
+};
+
+// A BulkSource over a buffer in memory (e.g. the task trace snapshot)
+class MemoryBulkSource : public BulkSource {
+public:
+    void set(const uint8_t* data, size_t size) { data_ = data; size_ = size; }
+    size_t size() const { return size_; }
+    bool read_at(uint32_t offset, uint8_t* buffer, size_t length) override;
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// A parsed ACK message
+struct BulkAck {
+    static const uint8_t MAX_RANGES = 8;
+    uint16_t next_seq;
+    uint8_t range_count;
+    uint16_t range_start[MAX_RANGES];
+    uint8_t range_count_frames[MAX_RANGES];
+
+    // Parses the bytes after the command byte. False if malformed.
+    bool parse(const uint8_t* data, size_t length);
+};
+
+struct BulkTransferStats {
+    uint32_t frames_sent;             // Including retransmissions
+    uint32_t frames_retransmitted;
+    uint32_t timeouts;                // Whole-window resends after BLE_BULK_ACK_TIMEOUT_MS
+    uint32_t acks_received;
+};
+
+class BulkTransferSender {
+public:
+    // Starts sending total_size bytes of source from start_offset. window and max_frame_size are
+    // clamped to BLE_BULK_MAX_WINDOW / BLE_BULK_MAX_FRAME_BYTES (0 = default). Sends START.
+    bool begin(BulkTransport* transport, BulkSource* source, uint32_t id, uint32_t total_size,
+               uint32_t start_offset, uint8_t window, uint16_t max_frame_size, uint32_t now_ms);
+
+    // Sends up to max_frames frames: requested resends first, then new frames within the window.
+    // Sends END once everything is acknowledged. Call periodically.
+    void poll(uint32_t now_ms, uint8_t max_frames = BLE_BULK_FRAMES_PER_POLL);
+
+    void on_ack(const BulkAck& ack, uint32_t now_ms);
+    void cancel();
+
+    bool is_active() const { return active_; }
+    bool is_complete() const { return complete_; }      // END sent
+    bool failed() const { return failed_; }             // Source read failed, END carries the error
+    uint32_t acked_bytes() const;                        // Contiguous from start_offset
+    uint32_t total_size() const { return total_size_; }
+    uint8_t window() const { return window_; }
+    uint16_t frame_size() const { return payload_size_ + BULK_DATA_HEADER_SIZE; }
+    const BulkTransferStats& stats() const { return stats_; }
+
+private:
+    uint32_t seq_from_wire(uint16_t seq) const;          // Nearest 32-bit seq to the window base
+    bool send_start();
+    bool send_data(uint32_t seq);
+    bool send_end(uint8_t status);
+
+    BulkTransport* transport_ = nullptr;
+    BulkSource* source_ = nullptr;
+    uint32_t id_ = 0;
+    uint32_t total_size_ = 0;
+    uint32_t start_offset_ = 0;
+    uint16_t payload_size_ = 0;
+    uint8_t window_ = 0;
+    uint32_t frame_count_ = 0;
+    uint32_t base_seq_ = 0;            // Oldest unacknowledged frame
+    uint32_t next_seq_ = 0;            // Next frame never sent
+    uint32_t resend_mask_ = 0;         // Bit i: resend base_seq_ + i
+    uint32_t last_progress_ms_ = 0;
+    bool active_ = false;
+    bool complete_ = false;
+    bool failed_ = false;
+    BulkTransferStats stats_ = {};
+    uint8_t frame_[BLE_BULK_MAX_FRAME_BYTES];
+};
@@ -35,66 +35,14 @@ void DataStreamManager::close_stream() {
 }
 
 uint32_t DataStreamManager::get_session_list(uint32_t* session_ids, uint32_t max_sessions) {
-    uint32_t total_sessions = grind_logger.count_sessions_in_flash();
-    if (total_sessions == 0 || !session_ids) {
+    if (!session_ids) {
         return 0;
     }
     
-    // Reuse the session list logic from export_sessions_binary_chunk
-    uint32_t* session_list = (uint32_t*)heap_caps_malloc(total_sessions * sizeof(uint32_t), MALLOC_CAP_8BIT);
-    if (!session_list) {
-        LOG_BLE("ERROR: Failed to allocate session list memory\n");
-        return 0;
-    }
-    
-    uint32_t list_count = 0;
-    
-    // Try individual session files first (new approach)
-    if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-        File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-        if (dir && dir.isDirectory()) {
-            File file = dir.openNextFile();
-            while (file && list_count < total_sessions) {
-                String filename = file.name();
-                bool is_session_file = (filename.startsWith("session_") || filename.indexOf("/session_") != -1)
-                                       && filename.endsWith(".bin");
-                if (is_session_file) {
-                    // Extract session ID from filename
-                    int start_pos = filename.indexOf('_') + 1;
-                    int end_pos = filename.lastIndexOf('.');
-                    if (start_pos > 0 && end_pos > start_pos) {
-                        uint32_t session_id = filename.substring(start_pos, end_pos).toInt();
-                        if (session_id > 0) {
-                            session_list[list_count++] = session_id;
-                        }
-                    }
-                }
-                file = dir.openNextFile();
-            }
-            dir.close();
-        }
-    }
-    
-    // Sort session IDs for consistent order
-    for (uint32_t i = 0; i < list_count - 1; i++) {
-        for (uint32_t j = i + 1; j < list_count; j++) {
-            if (session_list[i] > session_list[j]) {
-                uint32_t temp = session_list[i];
-                session_list[i] = session_list[j];
-                session_list[j] = temp;
-            }
-        }
-    }
-    
-    // Copy results to output array
-    uint32_t copy_count = (list_count < max_sessions) ? list_count : max_sessions;
-    for (uint32_t i = 0; i < copy_count; i++) {
-        session_ids[i] = session_list[i];
-    }
-    
-    heap_caps_free(session_list);
-    LOG_BLE("DataStream: Found %lu session files\n", list_count);
-    return copy_count;
+    // Already sorted oldest first by the session index
+    uint32_t session_count = grind_logger.get_session_ids(session_ids, max_sessions);
+    LOG_BLE("DataStream: Found %lu session files\n", session_count);
+    return session_count;
 }
 
 bool DataStreamManager::initialize_file_stream(uint32_t session_id) {
@@ -119,6 +67,13 @@ bool DataStreamManager::initialize_file_stream(uint32_t session_id) {
         return false;
     }
 
+    // Verified here rather than at boot - a corrupt file is reported as an error and the client moves on
+    if (!GrindLogger::verify_session_file(active_file)) {
+        LOG_BLE("ERROR: Session file %s failed its integrity check - skipping\n", filename);
+        active_file.close();
+        return false;
+    }
+
     file_total_size = active_file.size();
     LOG_BLE("DataStream: Initialized file stream for session %lu (%lu bytes)\n", session_id, file_total_size);
     file_stream_active = true;
@@ -160,6 +115,21 @@ bool DataStreamManager::read_file_chunk(uint8_t* buffer, size_t buffer_size, siz
     return false;
 }
 
+bool DataStreamManager::read_at(uint32_t offset, uint8_t* buffer, size_t length) {
+    if (!file_stream_active || !active_file || offset + length > file_total_size) {
+        return false;
+    }
+    if (!active_file.seek(offset) || active_file.read(buffer, length) != length) {
+        LOG_BLE("ERROR: Read of %u bytes at %lu failed for session %lu\n",
+                (unsigned)length, (unsigned long)offset, (unsigned long)current_session_id);
+        return false;
+    }
+    if (offset + length > file_bytes_sent) {
+        file_bytes_sent = offset + length;
+    }
+    return true;
+}
+
 uint8_t DataStreamManager::get_progress_percent() const {
     if (!file_stream_active || file_total_size == 0) {
         return 0;
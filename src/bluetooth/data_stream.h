@@ -3,14 +3,16 @@
 #include <cstdint>
 #include <cstddef>
 #include <LittleFS.h>
+#include "bulk_transfer.h"
 
 /**
  * DataStreamManager - Handles streaming data from the grind logger
  * 
  * This class isolates file I/O and progress tracking from BLE communication,
- * providing a clean interface for reading data in chunks.
+ * providing a clean interface for reading data in chunks. It is also the
+ * BulkSource of windowed transfers, which read at arbitrary offsets.
  */
-class DataStreamManager {
+class DataStreamManager : public BulkSource {
 private:
     // Per-file streaming state
     uint32_t current_session_id;
@@ -62,4 +64,15 @@ public:
      * @return Progress percentage, or 0 if no stream is active
      */
     uint8_t get_progress_percent() const;
+
+    /**
+     * Size of the file being streamed, or 0 if no stream is active
+     */
+    uint32_t get_file_size() const { return file_stream_active ? file_total_size : 0; }
+
+    /**
+     * Read length bytes at offset of the current file (BulkSource)
+     * @return true if all bytes were read
+     */
+    bool read_at(uint32_t offset, uint8_t* buffer, size_t length) override;
 };
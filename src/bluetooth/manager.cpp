@@ -2,11 +2,13 @@
 #include <cstdarg>
 #include <Arduino.h>
 #include <esp_system.h>
+#include <esp_heap_caps.h>
 #include <LittleFS.h>
 #include <nvs_flash.h>
 #include <nvs.h>
 #include "../system/performance_monitor.h"
 #include "../system/statistics_manager.h"
+#include "../system/task_trace.h"
 #include "../system/diagnostics_controller.h"
 #include "../config/constants.h"
 #include "../config/user.h"
@@ -17,6 +19,28 @@
 #include "../hardware/WeightSensor.h"
 #include "../controllers/grind_controller.h"
 
+namespace {
+
+// Sends bulk transfer frames as notifications on the data transfer characteristic
+class CharacteristicTransport : public BulkTransport {
+public:
+    explicit CharacteristicTransport(BLECharacteristic** characteristic) : characteristic_(characteristic) {}
+
+    bool send_frame(const uint8_t* frame, size_t length) override {
+        if (!*characteristic_) {
+            return false;
+        }
+        (*characteristic_)->setValue(const_cast<uint8_t*>(frame), length);
+        (*characteristic_)->notify();
+        return true;
+    }
+
+private:
+    BLECharacteristic** characteristic_;   // Cleared when BLE is disabled
+};
+
+}
+
 BluetoothManager::BluetoothManager()
     : ble_server(nullptr)
     , ota_service(nullptr)
@@ -46,6 +70,17 @@ BluetoothManager::BluetoothManager()
     , data_status(BLE_DATA_IDLE)
     , current_chunk(0)
     , next_chunk_time(0)
+    , bulk_transport(nullptr)
+    , bulk_transfer_pending(false)
+    , bulk_start_offset(0)
+    , bulk_window(0)
+    , bulk_frame_size(0)
+    , bulk_last_progress(0)
+    , bulk_ack_queue(nullptr)
+    , bulk_source(nullptr)
+    , bulk_total_size(0)
+    , trace_capture_pending(false)
+    , trace_snapshot(nullptr)
     , ui_status_queue(nullptr)
     , diagnostic_report_pending(false)
     , diagnostic_report_in_progress(false) {
@@ -53,6 +88,10 @@ BluetoothManager::BluetoothManager()
 
 BluetoothManager::~BluetoothManager() {
     disable();
+    delete bulk_transport;
+    if (trace_snapshot) {
+        heap_caps_free(trace_snapshot);
+    }
 }
 
 void BluetoothManager::init(Preferences* prefs) {
@@ -62,6 +101,12 @@ void BluetoothManager::init(Preferences* prefs) {
     if (!ui_status_queue) {
         ui_status_queue = xQueueCreate(8, sizeof(UIStatusMessage));
     }
+    if (!bulk_ack_queue) {
+        bulk_ack_queue = xQueueCreate(8, sizeof(BulkAck));
+    }
+    if (!bulk_transport) {
+        bulk_transport = new CharacteristicTransport(&data_transfer_characteristic);
+    }
 }
 
 void BluetoothManager::set_ui_status_callback(UIStatusCallback callback) {
@@ -82,7 +127,8 @@ void BluetoothManager::enqueue_ui_status(const char* status) {
         msg.text[sizeof(msg.text) - 1] = '\0';
     }
     // Non-blocking send; drop if full to avoid blocking BLE task
-    xQueueSend(ui_status_queue, &msg, 0);
+    BaseType_t result = xQueueSend(ui_status_queue, &msg, 0);
+    TRACE_QUEUE_SEND(TRACE_ID_QUEUE_UI_STATUS, ui_status_queue, result);
 }
 
 bool BluetoothManager::dequeue_ui_status(char* out, size_t out_len) {
@@ -160,9 +206,10 @@ void BluetoothManager::enable(unsigned long timeout_ms) {
     data_service = ble_server->createService(BLE_DATA_SERVICE_UUID);
     delay(BLE_INIT_SERVICE_DELAY_MS);
     
+    // Write without response lets bulk transfer ACKs go out without a round trip
     data_control_characteristic = data_service->createCharacteristic(
         BLE_DATA_CONTROL_CHAR_UUID,
-        BLECharacteristic::PROPERTY_WRITE
+        BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_WRITE_NR
     );
     data_control_characteristic->setCallbacks(this);
     delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
@@ -287,7 +334,7 @@ void BluetoothManager::disable() {
     
     log("Bluetooth: Disabling BLE and restoring normal power...\n");
     
-    if (ota_handler.is_ota_active()) {
+    if (ota_handler.is_ota_active() || ota_handler.is_ota_paused()) {
         ota_handler.abort_ota();
     }
     
@@ -428,6 +475,9 @@ void BluetoothManager::stop_data_export() {
     current_chunk = 0;
     next_chunk_time = 0;
     current_file_session_id = 0;
+    bulk_transfer_pending = false;
+    trace_capture_pending = false;
+    bulk_sender.cancel();
     
     // Clean shutdown of stream
     data_stream.close_stream();
@@ -436,8 +486,15 @@ void BluetoothManager::stop_data_export() {
 }
 
 void BluetoothManager::update_data_export() {
-    // Check if we need to send the next chunk
-    if (data_export_in_progress && millis() >= next_chunk_time) {
+    // Acquire pairs with the release in the request handlers: the transfer state is complete
+    if (!data_export_in_progress.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    if (bulk_transfer_pending || bulk_sender.is_active()) {
+        update_bulk_transfer();
+    } else if (millis() >= next_chunk_time) {
+        // Check if we need to send the next chunk
         send_next_data_chunk();
     }
 }
@@ -620,13 +677,212 @@ void BluetoothManager::send_individual_file(uint32_t session_id) {
     
     log("Bluetooth Data: Starting individual file transfer for session %lu\n", session_id);
     
-    data_export_in_progress = true;
     current_file_session_id = session_id;
     current_chunk = 0;
     next_chunk_time = millis(); // Start immediately
+    data_export_in_progress.store(true, std::memory_order_release);
     set_data_status(BLE_DATA_EXPORTING);
 }
 
+void BluetoothManager::request_windowed_file(const uint8_t* data, size_t length) {
+    // [session_id u32][offset u32][window u8][max_frame_size u16] - window and frame size are optional
+    if (length < 8) {
+        log("Bluetooth Data: Invalid REQUEST_FILE_WINDOWED command length\n");
+        set_data_status(BLE_DATA_ERROR);
+        return;
+    }
+    if (!ble_enabled || !device_connected) {
+        log("Bluetooth Data: Cannot start file transfer - BLE not enabled or not connected\n");
+        set_data_status(BLE_DATA_ERROR);
+        return;
+    }
+    if (data_export_in_progress) {
+        log("Bluetooth Data: Windowed request ignored - transfer already in progress\n");
+        return;
+    }
+
+    uint32_t session_id = 0;
+    uint32_t offset = 0;
+    memcpy(&session_id, data, 4);
+    memcpy(&offset, data + 4, 4);
+    uint8_t window = (length >= 9) ? data[8] : 0;
+    uint16_t frame_size = 0;
+    if (length >= 11) {
+        memcpy(&frame_size, data + 9, 2);
+    }
+
+    if (!data_stream.initialize_file_stream(session_id)) {
+        log("Bluetooth Data: Failed to initialize file stream for session %lu\n", session_id);
+        set_data_status(BLE_DATA_ERROR);
+        return;
+    }
+    if (offset > data_stream.get_file_size()) {
+        log("Bluetooth Data: Resume offset %lu is past the end of session %lu\n", offset, session_id);
+        data_stream.close_stream();
+        set_data_status(BLE_DATA_ERROR);
+        return;
+    }
+
+    if (bulk_ack_queue) {
+        xQueueReset(bulk_ack_queue);
+    }
+    bulk_source = &data_stream;
+    bulk_total_size = data_stream.get_file_size();
+    bulk_start_offset = offset;
+    bulk_window = window;
+    bulk_frame_size = clamp_bulk_frame_size(frame_size);
+    current_file_session_id = session_id;
+    bulk_transfer_pending = true;        // START goes out from the BLE task
+    // Last: update_data_export() must not see the export before it knows it is windowed
+    data_export_in_progress.store(true, std::memory_order_release);
+    set_data_status(BLE_DATA_EXPORTING);
+}
+
+void BluetoothManager::request_trace(const uint8_t* data, size_t length) {
+    // [offset u32][window u8][max_frame_size u16] - all optional; offset 0 captures a new trace
+    if (!ble_enabled || !device_connected) {
+        log("Bluetooth Data: Cannot send trace - BLE not enabled or not connected\n");
+        set_data_status(BLE_DATA_ERROR);
+        return;
+    }
+    if (data_export_in_progress) {
+        log("Bluetooth Data: Trace request ignored - transfer already in progress\n");
+        return;
+    }
+#if SYS_TASK_TRACE
+    uint32_t offset = 0;
+    if (length >= 4) {
+        memcpy(&offset, data, 4);
+    }
+    uint8_t window = (length >= 5) ? data[4] : 0;
+    uint16_t frame_size = 0;
+    if (length >= 7) {
+        memcpy(&frame_size, data + 5, 2);
+    }
+
+    if (offset > 0 && (!trace_snapshot || offset > trace_source.size())) {
+        log("Bluetooth Data: No trace capture to resume at byte %lu\n", offset);
+        set_data_status(BLE_DATA_ERROR);
+        return;
+    }
+
+    if (bulk_ack_queue) {
+        xQueueReset(bulk_ack_queue);
+    }
+    trace_capture_pending = (offset == 0);
+    bulk_source = &trace_source;
+    bulk_total_size = trace_source.size();
+    bulk_start_offset = offset;
+    bulk_window = window;
+    bulk_frame_size = clamp_bulk_frame_size(frame_size);
+    current_file_session_id = BLE_TRACE_TRANSFER_ID;
+    bulk_transfer_pending = true;        // Capture and START go out from the BLE task
+    // Last: update_data_export() must not see the export before it knows it is windowed
+    data_export_in_progress.store(true, std::memory_order_release);
+    set_data_status(BLE_DATA_EXPORTING);
+#else
+    log("Bluetooth Data: Task trace not built in (SYS_TASK_TRACE=0)\n");
+    set_data_status(BLE_DATA_ERROR);
+#endif
+}
+
+bool BluetoothManager::capture_trace() {
+    if (trace_snapshot) {
+        trace_source.set(nullptr, 0);
+        heap_caps_free(trace_snapshot);
+        trace_snapshot = nullptr;
+    }
+
+    size_t size = 0;
+    trace_snapshot = task_trace_snapshot(&size);
+    if (!trace_snapshot) {
+        return false;
+    }
+    trace_source.set(trace_snapshot, size);
+    log("Bluetooth Data: Captured %u-byte task trace\n", (unsigned)size);
+    return true;
+}
+
+uint16_t BluetoothManager::clamp_bulk_frame_size(uint16_t frame_size) const {
+    // A notification carries at most MTU - 3 bytes
+    uint16_t mtu = ble_server ? ble_server->getPeerMTU(ble_server->getConnId()) : 0;
+    if (mtu > BULK_DATA_HEADER_SIZE + 3 && (frame_size == 0 || frame_size > mtu - 3)) {
+        frame_size = mtu - 3;
+    }
+    return frame_size;
+}
+
+void BluetoothManager::update_bulk_transfer() {
+    // If client dropped mid-transfer, stop cleanly and avoid further notify attempts
+    if (!device_connected) {
+        stop_data_export();
+        set_data_status(BLE_DATA_ERROR);
+        return;
+    }
+
+    uint32_t now = millis();
+    if (bulk_transfer_pending) {
+        bulk_transfer_pending = false;
+        if (trace_capture_pending) {
+            trace_capture_pending = false;
+            if (!capture_trace()) {
+                log("Bluetooth Data: Failed to capture the task trace\n");
+                stop_data_export();
+                set_data_status(BLE_DATA_ERROR);
+                return;
+            }
+            bulk_total_size = trace_source.size();
+        }
+        if (!bulk_sender.begin(bulk_transport, bulk_source, current_file_session_id, bulk_total_size,
+                               bulk_start_offset, bulk_window, bulk_frame_size, now)) {
+            log("Bluetooth Data: Failed to start windowed transfer for session %lu\n", current_file_session_id);
+            stop_data_export();
+            set_data_status(BLE_DATA_ERROR);
+            return;
+        }
+        bulk_last_progress = 0;
+        log("Bluetooth Data: Windowed transfer of session %lu from byte %lu/%lu (window %u, %u-byte frames)\n",
+            current_file_session_id, bulk_start_offset, bulk_sender.total_size(),
+            bulk_sender.window(), bulk_sender.frame_size());
+    }
+
+    BulkAck ack;
+    while (bulk_ack_queue && xQueueReceive(bulk_ack_queue, &ack, 0) == pdTRUE) {
+        bulk_sender.on_ack(ack, now);
+    }
+    bulk_sender.poll(now);
+
+    if (bulk_sender.is_complete() || bulk_sender.failed()) {
+        finish_bulk_transfer();
+        return;
+    }
+
+    uint32_t total = bulk_sender.total_size();
+    uint8_t progress = total ? (uint8_t)((uint64_t)(bulk_start_offset + bulk_sender.acked_bytes()) * 100 / total) : 0;
+    if (progress != bulk_last_progress && data_status_characteristic) {
+        bulk_last_progress = progress;
+        uint8_t status_data[2] = { (uint8_t)BLE_DATA_EXPORTING, progress };
+        data_status_characteristic->setValue(status_data, 2);
+        data_status_characteristic->notify();
+    }
+}
+
+void BluetoothManager::finish_bulk_transfer() {
+    const BulkTransferStats& stats = bulk_sender.stats();
+    bool failed = bulk_sender.failed();
+    log("Bluetooth Data: Windowed transfer %s for session %lu - %lu frames, %lu resent, %lu timeouts, %lu ACKs\n",
+        failed ? "failed" : "complete", current_file_session_id, stats.frames_sent,
+        stats.frames_retransmitted, stats.timeouts, stats.acks_received);
+
+    data_export_in_progress = false;
+    current_file_session_id = 0;
+    bulk_sender.cancel();
+    data_stream.close_stream();
+
+    // END already told the client; no need to wait for the buffer to drain
+    set_data_status(failed ? BLE_DATA_ERROR : BLE_DATA_COMPLETE);
+}
+
 void BluetoothManager::log(const char* format, ...) {
     char buffer[512]; // Increased from 256 to 2048 bytes for large debug messages.
     va_list args;
@@ -645,8 +901,12 @@ void BluetoothManager::log(const char* format, ...) {
 
 void BluetoothManager::set_ota_status(BLEOTAStatus status) {
     if (ota_status_characteristic) {
-        uint8_t status_value = static_cast<uint8_t>(status);
-        ota_status_characteristic->setValue(&status_value, 1);
+        // [status][last verified patch offset u32] - older clients only read the first byte
+        uint8_t status_value[5];
+        uint32_t resume_offset = ota_handler.get_resume_offset();
+        status_value[0] = static_cast<uint8_t>(status);
+        memcpy(status_value + 1, &resume_offset, sizeof(resume_offset));
+        ota_status_characteristic->setValue(status_value, sizeof(status_value));
         ota_status_characteristic->notify();
     }
 }
@@ -669,6 +929,7 @@ void BluetoothManager::handle_ota_control_command(BLECharacteristic* characteris
     switch (command) {
         case BLE_OTA_CMD_START:
             // New protocol: [CMD][patch_size:4][is_full_update:1][build_number_length:1][build_number:N]
+            //               [version_length:1][version:N][patch_crc32:4] (optional extensions)
             if (data.length() >= 6) {  // 1 + 4 + 1 bytes minimum (cmd + patch_size + full_update_flag)
                 uint32_t patch_size = *(uint32_t*)(data.c_str() + 1);
                 bool is_full_update = data[5] != 0;
@@ -698,10 +959,19 @@ void BluetoothManager::handle_ota_control_command(BLECharacteristic* characteris
                             expected_firmware_version = String(data.c_str() + offset, version_length);
                             log("Bluetooth OTA: Expected firmware version after update: %s\n", expected_firmware_version.c_str());
                         }
+                        offset += version_length;
                     }
                 }
+
+                // Patch CRC if present: the client sends block CRCs and can resume
+                bool verify_blocks = data.length() >= offset + 4;
+                uint32_t patch_crc = 0;
+                if (verify_blocks) {
+                    memcpy(&patch_crc, data.c_str() + offset, sizeof(patch_crc));
+                }
                 
-                if (ota_handler.start_ota(patch_size, expected_build, is_full_update, expected_firmware_version)) {
+                if (ota_handler.start_ota(patch_size, expected_build, is_full_update, expected_firmware_version,
+                                          verify_blocks, patch_crc)) {
                     set_ota_status(BLE_OTA_RECEIVING);
                 } else {
                     set_ota_status(BLE_OTA_ERROR);
@@ -736,6 +1006,22 @@ void BluetoothManager::handle_ota_control_command(BLECharacteristic* characteris
             ota_handler.abort_ota();
             set_ota_status(BLE_OTA_ERROR);
             break;
+
+        case BLE_OTA_CMD_BLOCK:
+            // [CMD][offset:4][crc32:4]
+            if (data.length() >= 9) {
+                uint32_t block_offset, block_crc;
+                memcpy(&block_offset, data.c_str() + 1, sizeof(block_offset));
+                memcpy(&block_crc, data.c_str() + 5, sizeof(block_crc));
+                if (!ota_handler.verify_block(block_offset, block_crc)) {
+                    set_ota_status(BLE_OTA_ERROR);
+                }
+            }
+            break;
+
+        case BLE_OTA_CMD_QUERY:
+            set_ota_status(ota_handler.get_status());
+            break;
     }
 }
 
@@ -788,6 +1074,16 @@ void BluetoothManager::handle_data_control_command(BLECharacteristic* characteri
     if (data.length() == 0) return;
     
     uint8_t command = data[0];
+
+    // ACKs arrive several times a second during a transfer - hand them to the BLE task quietly
+    if (command == BLE_DATA_CMD_ACK) {
+        BulkAck ack;
+        if (bulk_ack_queue && ack.parse((const uint8_t*)data.c_str() + 1, data.length() - 1)) {
+            xQueueSend(bulk_ack_queue, &ack, 0);
+        }
+        return;
+    }
+
     log("Bluetooth Data: Received command 0x%02X\n", command);
     
     switch (command) {
@@ -822,6 +1118,14 @@ void BluetoothManager::handle_data_control_command(BLECharacteristic* characteri
                 set_data_status(BLE_DATA_ERROR);
             }
             break;
+
+        case BLE_DATA_CMD_REQUEST_FILE_WINDOWED:
+            request_windowed_file((const uint8_t*)data.c_str() + 1, data.length() - 1);
+            break;
+
+        case BLE_DATA_CMD_REQUEST_TRACE:
+            request_trace((const uint8_t*)data.c_str() + 1, data.length() - 1);
+            break;
             
         default:
             log("Bluetooth Data: Unknown command: 0x%02X\n", command);
@@ -843,7 +1147,8 @@ void BluetoothManager::onDisconnect(BLEServer* server) {
     log("BLE: Client disconnected - timeout countdown resumed\n");
     
     if (ota_handler.is_ota_active()) {
-        ota_handler.abort_ota();
+        // Keeps the verified blocks when the client can resume
+        ota_handler.suspend_ota();
     }
     
     if (data_export_in_progress) {
@@ -1102,14 +1407,16 @@ void BluetoothManager::generate_diagnostic_report() {
 
     if (weight_sensor) {
         // Get load cell noise measurements
-        float std_dev_g = weight_sensor->get_standard_deviation_g(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
-        int32_t std_dev_adc = weight_sensor->get_standard_deviation_adc(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
+        const WeightSnapshot snapshot = weight_sensor->get_snapshot();
+        float std_dev_g = snapshot.std_dev_g;
+        int32_t std_dev_adc = (int32_t)snapshot.std_dev_raw;
         bool noise_acceptable = weight_sensor->noise_level_diagnostic();
         float cal_factor = weight_sensor->get_calibration_factor();
         bool is_calibrated = weight_sensor->is_calibrated();
 
         // Get motor latency
         float motor_latency = grind_controller.get_motor_response_latency();
+        const ModelStopPlanner& stop_model = grind_controller.get_model_stop_planner();
 
         snprintf(buf, sizeof(buf),
             "[RUNTIME DIAGNOSTICS]\n"
@@ -1119,13 +1426,17 @@ void BluetoothManager::generate_diagnostic_report() {
             "  Std Dev (ADC): %ld\n"
             "  Noise Level: %s\n"
             "  Motor Latency: %.0f ms\n"
+            "  Stop Planner: %s (model: %u stops, residual %.3fg)\n"
             "\n",
             is_calibrated ? "Calibrated" : "NOT CALIBRATED",
             cal_factor,
             std_dev_g,
             (long)std_dev_adc,
             noise_acceptable ? "OK" : "Too High",
-            motor_latency
+            motor_latency,
+            grind_controller.get_stop_planner_name(),
+            (unsigned)stop_model.get_history_count(),
+            stop_model.get_residual_sd_g()
         );
         send_chunk(buf);
     }
@@ -1488,192 +1799,156 @@ void BluetoothManager::generate_diagnostic_report() {
     snprintf(buf, sizeof(buf), "[LAST 5 GRIND SESSIONS]\n");
     send_chunk(buf);
 
-    if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-        File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-        if (dir && dir.isDirectory()) {
-            // Collect all session IDs
-            const int MAX_SESSIONS = 100;
-            uint32_t* session_ids = (uint32_t*)malloc(MAX_SESSIONS * sizeof(uint32_t));
-            int count = 0;
-
-            if (session_ids) {
-                File file = dir.openNextFile();
-                while (file && count < MAX_SESSIONS) {
-                    String filename = file.name();
-                    if ((filename.startsWith("session_") || filename.indexOf("/session_") != -1) && filename.endsWith(".bin")) {
-                        int start_pos = filename.indexOf('_') + 1;
-                        int end_pos = filename.lastIndexOf('.');
-                        if (start_pos > 0 && end_pos > start_pos) {
-                            session_ids[count++] = filename.substring(start_pos, end_pos).toInt();
-                        }
-                    }
-                    file = dir.openNextFile();
-                }
-                dir.close();
-
-                // Sort session IDs descending (highest/newest first)
-                for (int i = 0; i < count - 1; i++) {
-                    for (int j = i + 1; j < count; j++) {
-                        if (session_ids[i] < session_ids[j]) {
-                            uint32_t temp = session_ids[i];
-                            session_ids[i] = session_ids[j];
-                            session_ids[j] = temp;
-                        }
-                    }
-                }
+    // Newest first, straight from the session index
+    uint32_t session_ids[5];
+    uint32_t count = grind_logger.get_recent_session_ids(session_ids, 5);
+    if (count > 0) {
+        for (uint32_t i = 0; i < count; i++) {
+            char filename[64];
+            snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, session_ids[i]);
+
+            File sessionFile = LittleFS.open(filename, "r");
+            if (sessionFile) {
+                TimeSeriesSessionHeader header;
+                GrindSession session;
+
+                if (sessionFile.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                    sessionFile.read((uint8_t*)&session, sizeof(session)) == sizeof(session)) {
+
+                    const char* mode_name = (session.grind_mode == 0) ? "WEIGHT" : "TIME";
+                    const char* term_names[] = {"COMPLETED", "TIMEOUT", "OVERSHOOT", "MAX_PULSES", "UNKNOWN"};
+                    const char* term_name = (session.termination_reason < 4) ? term_names[session.termination_reason] : term_names[4];
+
+                    snprintf(buf, sizeof(buf),
+                        "\n--- Session #%lu ---\n"
+                        "  Mode: %s | Profile: %u | Status: %.16s\n"
+                        "  Target: %.1fg | Final: %.1fg | Error: %+.2fg\n"
+                        "  Total Time: %.1fs | Motor Time: %.1fs | Pulses: %u\n"
+                        "  Termination: %s\n",
+                        session.session_id,
+                        mode_name, session.profile_id, session.result_status,
+                        session.target_weight, session.final_weight, session.error_grams,
+                        session.total_time_ms / 1000.0f, session.total_motor_on_time_ms / 1000.0f, session.pulse_count,
+                        term_name
+                    );
+                    send_chunk(buf);
 
-                // Read and output last 5 sessions
-                int sessions_to_show = (count < 5) ? count : 5;
-                for (int i = 0; i < sessions_to_show; i++) {
-                    char filename[64];
-                    snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, session_ids[i]);
-
-                    File sessionFile = LittleFS.open(filename, "r");
-                    if (sessionFile) {
-                        TimeSeriesSessionHeader header;
-                        GrindSession session;
-
-                        if (sessionFile.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
-                            sessionFile.read((uint8_t*)&session, sizeof(session)) == sizeof(session)) {
-
-                            const char* mode_name = (session.grind_mode == 0) ? "WEIGHT" : "TIME";
-                            const char* term_names[] = {"COMPLETED", "TIMEOUT", "OVERSHOOT", "MAX_PULSES", "UNKNOWN"};
-                            const char* term_name = (session.termination_reason < 4) ? term_names[session.termination_reason] : term_names[4];
-
-                            snprintf(buf, sizeof(buf),
-                                "\n--- Session #%lu ---\n"
-                                "  Mode: %s | Profile: %u | Status: %.16s\n"
-                                "  Target: %.1fg | Final: %.1fg | Error: %+.2fg\n"
-                                "  Total Time: %.1fs | Motor Time: %.1fs | Pulses: %u\n"
-                                "  Termination: %s\n",
-                                session.session_id,
-                                mode_name, session.profile_id, session.result_status,
-                                session.target_weight, session.final_weight, session.error_grams,
-                                session.total_time_ms / 1000.0f, session.total_motor_on_time_ms / 1000.0f, session.pulse_count,
-                                term_name
-                            );
-                            send_chunk(buf);
-
-                            // Read and output events
-                            if (header.event_count > 0) {
-                                snprintf(buf, sizeof(buf), "  Events (%u):\n", header.event_count);
-                                send_chunk(buf);
+                    // Read and output events
+                    if (header.event_count > 0) {
+                        snprintf(buf, sizeof(buf), "  Events (%u):\n", header.event_count);
+                        send_chunk(buf);
+
+                        const char* phase_names[] = {
+                            "IDLE", "INITIALIZING", "SETUP", "TARING", "TARE_CONFIRM",
+                            "PREDICTIVE", "PULSE_DECISION", "PULSE_EXECUTE", "PULSE_SETTLING",
+                            "FINAL_SETTLING", "TIME_GRINDING", "TIME_ADDITIONAL_PULSE", "COMPLETED", "TIMEOUT"
+                        };
+
+                        GrindEvent* events = (GrindEvent*)malloc(header.event_count * sizeof(GrindEvent));
+                        bool events_read = events && GrindLogger::read_session_events(sessionFile, header, events);
+                        for (uint16_t e = 0; events_read && e < header.event_count; e++) {
+                            const GrindEvent& event = events[e];
+                            {
+                                const char* phase_name = (event.phase_id < 14) ? phase_names[event.phase_id] : "UNKNOWN";
+
+                                // Calculate event yield (delta)
+                                float event_yield = event.end_weight - event.start_weight;
+
+                                // Build base event string
+                                char base_str[256];
+                                if (event.pulse_attempt_number > 0) {
+                                    snprintf(base_str, sizeof(base_str),
+                                        "    [%lums] %s (pulse #%u): %.2fg -> %.2fg (%+.2fg) (%.1fms pulse)",
+                                        event.timestamp_ms,
+                                        phase_name,
+                                        event.pulse_attempt_number,
+                                        event.start_weight,
+                                        event.end_weight,
+                                        event_yield,
+                                        event.pulse_duration_ms
+                                    );
+                                } else {
+                                    snprintf(base_str, sizeof(base_str),
+                                        "    [%lums] %s: %.2fg -> %.2fg (%+.2fg) (%lums)",
+                                        event.timestamp_ms,
+                                        phase_name,
+                                        event.start_weight,
+                                        event.end_weight,
+                                        event_yield,
+                                        event.duration_ms
+                                    );
+                                }
+
+                                // Build phase-specific metrics suffix
+                                char metrics_str[256] = "";
+
+                                switch (event.phase_id) {
+                                    case 5: // PREDICTIVE
+                                        if (event.grind_latency_ms > 0 || event.pulse_flow_rate > 0 || event.motor_stop_target_weight > 0) {
+                                            snprintf(metrics_str, sizeof(metrics_str), " | Latency: %lums, Flow: %.1fg/s, Target: %.1fg",
+                                                event.grind_latency_ms,
+                                                event.pulse_flow_rate,
+                                                event.motor_stop_target_weight
+                                            );
+                                        }
+                                        break;
 
-                                const char* phase_names[] = {
-                                    "IDLE", "INITIALIZING", "SETUP", "TARING", "TARE_CONFIRM",
-                                    "PREDICTIVE", "PULSE_DECISION", "PULSE_EXECUTE", "PULSE_SETTLING",
-                                    "FINAL_SETTLING", "TIME_GRINDING", "TIME_ADDITIONAL_PULSE", "COMPLETED", "TIMEOUT"
-                                };
-
-                                for (uint16_t e = 0; e < header.event_count; e++) {
-                                    GrindEvent event;
-                                    if (sessionFile.read((uint8_t*)&event, sizeof(event)) == sizeof(event)) {
-                                        const char* phase_name = (event.phase_id < 14) ? phase_names[event.phase_id] : "UNKNOWN";
-
-                                        // Calculate event yield (delta)
-                                        float event_yield = event.end_weight - event.start_weight;
-
-                                        // Build base event string
-                                        char base_str[256];
-                                        if (event.pulse_attempt_number > 0) {
-                                            snprintf(base_str, sizeof(base_str),
-                                                "    [%lums] %s (pulse #%u): %.2fg -> %.2fg (%+.2fg) (%.1fms pulse)",
-                                                event.timestamp_ms,
-                                                phase_name,
-                                                event.pulse_attempt_number,
-                                                event.start_weight,
-                                                event.end_weight,
-                                                event_yield,
-                                                event.pulse_duration_ms
+                                    case 7: // PULSE_EXECUTE
+                                        if (event.pulse_flow_rate > 0 || event.motor_stop_target_weight > 0) {
+                                            snprintf(metrics_str, sizeof(metrics_str), " | Flow: %.1fg/s, Target: %.1fg",
+                                                event.pulse_flow_rate,
+                                                event.motor_stop_target_weight
                                             );
-                                        } else {
-                                            snprintf(base_str, sizeof(base_str),
-                                                "    [%lums] %s: %.2fg -> %.2fg (%+.2fg) (%lums)",
-                                                event.timestamp_ms,
-                                                phase_name,
-                                                event.start_weight,
-                                                event.end_weight,
-                                                event_yield,
-                                                event.duration_ms
+                                        }
+                                        break;
+
+                                    case 8: // PULSE_SETTLING
+                                        if (event.settling_duration_ms > 0 || event.motor_stop_target_weight > 0) {
+                                            snprintf(metrics_str, sizeof(metrics_str), " | Settled: %lums, Target: %.1fg",
+                                                event.settling_duration_ms,
+                                                event.motor_stop_target_weight
                                             );
                                         }
+                                        break;
 
-                                        // Build phase-specific metrics suffix
-                                        char metrics_str[256] = "";
-
-                                        switch (event.phase_id) {
-                                            case 5: // PREDICTIVE
-                                                if (event.grind_latency_ms > 0 || event.pulse_flow_rate > 0 || event.motor_stop_target_weight > 0) {
-                                                    snprintf(metrics_str, sizeof(metrics_str), " | Latency: %lums, Flow: %.1fg/s, Target: %.1fg",
-                                                        event.grind_latency_ms,
-                                                        event.pulse_flow_rate,
-                                                        event.motor_stop_target_weight
-                                                    );
-                                                }
-                                                break;
-
-                                            case 7: // PULSE_EXECUTE
-                                                if (event.pulse_flow_rate > 0 || event.motor_stop_target_weight > 0) {
-                                                    snprintf(metrics_str, sizeof(metrics_str), " | Flow: %.1fg/s, Target: %.1fg",
-                                                        event.pulse_flow_rate,
-                                                        event.motor_stop_target_weight
-                                                    );
-                                                }
-                                                break;
-
-                                            case 8: // PULSE_SETTLING
-                                                if (event.settling_duration_ms > 0 || event.motor_stop_target_weight > 0) {
-                                                    snprintf(metrics_str, sizeof(metrics_str), " | Settled: %lums, Target: %.1fg",
-                                                        event.settling_duration_ms,
-                                                        event.motor_stop_target_weight
-                                                    );
-                                                }
-                                                break;
-
-                                            case 9: // FINAL_SETTLING
-                                                if (event.settling_duration_ms > 0) {
-                                                    snprintf(metrics_str, sizeof(metrics_str), " | Settled: %lums",
-                                                        event.settling_duration_ms
-                                                    );
-                                                }
-                                                break;
-
-                                            case 10: // TIME_GRINDING
-                                                if (event.pulse_flow_rate > 0) {
-                                                    snprintf(metrics_str, sizeof(metrics_str), " | Flow: %.1fg/s",
-                                                        event.pulse_flow_rate
-                                                    );
-                                                }
-                                                break;
-
-                                            case 11: // TIME_ADDITIONAL_PULSE
-                                                if (event.pulse_flow_rate > 0) {
-                                                    snprintf(metrics_str, sizeof(metrics_str), " | Flow: %.1fg/s",
-                                                        event.pulse_flow_rate
-                                                    );
-                                                }
-                                                break;
+                                    case 9: // FINAL_SETTLING
+                                        if (event.settling_duration_ms > 0) {
+                                            snprintf(metrics_str, sizeof(metrics_str), " | Settled: %lums",
+                                                event.settling_duration_ms
+                                            );
                                         }
+                                        break;
 
-                                        // Combine base and metrics, add newline
-                                        snprintf(buf, sizeof(buf), "%s%s\n", base_str, metrics_str);
-                                        send_chunk(buf);
-                                    }
+                                    case 10: // TIME_GRINDING
+                                        if (event.pulse_flow_rate > 0) {
+                                            snprintf(metrics_str, sizeof(metrics_str), " | Flow: %.1fg/s",
+                                                event.pulse_flow_rate
+                                            );
+                                        }
+                                        break;
+
+                                    case 11: // TIME_ADDITIONAL_PULSE
+                                        if (event.pulse_flow_rate > 0) {
+                                            snprintf(metrics_str, sizeof(metrics_str), " | Flow: %.1fg/s",
+                                                event.pulse_flow_rate
+                                            );
+                                        }
+                                        break;
                                 }
+
+                                // Combine base and metrics, add newline
+                                snprintf(buf, sizeof(buf), "%s%s\n", base_str, metrics_str);
+                                send_chunk(buf);
                             }
                         }
-                        sessionFile.close();
+                        free(events);
                     }
                 }
-
-                free(session_ids);
+                sessionFile.close();
             }
-        } else {
-            snprintf(buf, sizeof(buf), "  [NONE] No session files found\n");
-            send_chunk(buf);
         }
     } else {
-        snprintf(buf, sizeof(buf), "  [NONE] Sessions directory does not exist\n");
+        snprintf(buf, sizeof(buf), "  [NONE] No session files found\n");
         send_chunk(buf);
     }
 
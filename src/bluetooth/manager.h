@@ -4,6 +4,7 @@
 #include <BLEServer.h>
 #include <BLEUtils.h>
 #include <BLE2902.h>
+#include <atomic>
 #include <functional>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
@@ -12,6 +13,7 @@
 #include "../config/constants.h"
 #include "ota_handler.h"
 #include "data_stream.h"
+#include "bulk_transfer.h"
 
 // Forward declaration to avoid circular dependency
 class UIManager;
@@ -36,7 +38,10 @@ enum BLEDataCommand {
     BLE_DATA_CMD_GET_COUNT = 0x12,
     BLE_DATA_CMD_CLEAR_DATA = 0x13,
     BLE_DATA_CMD_GET_FILE_LIST = 0x14,
-    BLE_DATA_CMD_REQUEST_FILE = 0x15
+    BLE_DATA_CMD_REQUEST_FILE = 0x15,
+    BLE_DATA_CMD_REQUEST_FILE_WINDOWED = 0x16,  // Windowed transfer, see bulk_transfer.h
+    BLE_DATA_CMD_ACK = 0x17,
+    BLE_DATA_CMD_REQUEST_TRACE = 0x18           // Windowed transfer of the task trace, see task_trace.h
 };
 
 enum BLEDataStatus {
@@ -95,12 +100,30 @@ private:
     OTAHandler ota_handler;
     DataStreamManager data_stream;
     
-    // Data export state
-    bool data_export_in_progress;
+    // Data export state - published last by the BLE callback (release), read by the BLE task (acquire)
+    std::atomic<bool> data_export_in_progress;
     BLEDataStatus data_status;
     uint16_t current_chunk;
     unsigned long next_chunk_time;
     uint32_t current_file_session_id;  // For per-file streaming
+
+    // Windowed transfer state (BLE_DATA_CMD_REQUEST_FILE_WINDOWED)
+    BulkTransferSender bulk_sender;
+    BulkTransport* bulk_transport;
+    std::atomic<bool> bulk_transfer_pending;   // Requested from the BLE callback, started on the BLE task
+    uint32_t bulk_start_offset;
+    uint8_t bulk_window;
+    uint16_t bulk_frame_size;
+    uint8_t bulk_last_progress;
+    QueueHandle_t bulk_ack_queue;      // BulkAck from the BLE callback to the BLE task
+    BulkSource* bulk_source;           // Session file or trace snapshot
+    uint32_t bulk_total_size;
+
+    // Task trace download (BLE_DATA_CMD_REQUEST_TRACE). The capture is kept until the next
+    // request from offset 0, so a stalled download resumes on the same data.
+    std::atomic<bool> trace_capture_pending;   // Captured on the BLE task, the snapshot waits for writers
+    uint8_t* trace_snapshot;
+    MemoryBulkSource trace_source;
     
     // UI status callback
     UIStatusCallback ui_status_callback;
@@ -127,6 +150,12 @@ private:
     void clear_measurement_data();
     void send_file_list();
     void send_individual_file(uint32_t session_id);
+    void request_windowed_file(const uint8_t* data, size_t length);
+    void request_trace(const uint8_t* data, size_t length);
+    bool capture_trace();
+    uint16_t clamp_bulk_frame_size(uint16_t frame_size) const;
+    void update_bulk_transfer();
+    void finish_bulk_transfer();
     void update_system_info();
     void update_performance_info();
     void update_hardware_info();
@@ -0,0 +1,60 @@
+#include "ota_block_receiver.h"
+#include "../system/crc32.h"
+
+#include <string.h>
+
+void OtaBlockReceiver::begin(uint32_t patch_size, uint32_t patch_crc, bool verify_blocks) {
+    patch_size_ = patch_size;
+    patch_crc_ = patch_crc;
+    verify_blocks_ = verify_blocks;
+    committed_ = 0;
+    buffered_ = 0;
+}
+
+void OtaBlockReceiver::resume_at(uint32_t offset) {
+    committed_ = offset < patch_size_ ? offset : patch_size_;
+    buffered_ = 0;
+}
+
+bool OtaBlockReceiver::matches(uint32_t patch_size, uint32_t patch_crc) const {
+    return verify_blocks_ && patch_size == patch_size_ && patch_crc == patch_crc_;
+}
+
+OtaBlockResult OtaBlockReceiver::write(const uint8_t* data, size_t length, OtaPatchSink* sink) {
+    if (!verify_blocks_) {
+        if (committed_ + length > patch_size_) {
+            return OTA_BLOCK_OVERFLOW;
+        }
+        if (!sink->write_patch(data, length)) {
+            return OTA_BLOCK_SINK_FAILED;
+        }
+        committed_ += length;
+        return OTA_BLOCK_OK;
+    }
+
+    if (buffered_ + length > sizeof(block_) || committed_ + buffered_ + length > patch_size_) {
+        buffered_ = 0;
+        return OTA_BLOCK_OVERFLOW;
+    }
+    memcpy(block_ + buffered_, data, length);
+    buffered_ += length;
+    return OTA_BLOCK_OK;
+}
+
+OtaBlockResult OtaBlockReceiver::end_block(uint32_t offset, uint32_t crc, OtaPatchSink* sink) {
+    if (!verify_blocks_ || buffered_ == 0 || offset != committed_) {
+        buffered_ = 0;
+        return OTA_BLOCK_BAD_OFFSET;
+    }
+    if (crc32_update(0, block_, buffered_) != crc) {
+        buffered_ = 0;
+        return OTA_BLOCK_BAD_CRC;
+    }
+    if (!sink->write_patch(block_, buffered_)) {
+        buffered_ = 0;
+        return OTA_BLOCK_SINK_FAILED;
+    }
+    committed_ += buffered_;
+    buffered_ = 0;
+    return OTA_BLOCK_OK;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../config/bluetooth.h"
+
+/*
+ * CRC-checked, resumable OTA patch reception.
+ *
+ * Clients that send a patch CRC-32 with START follow every BLE_OTA_BLOCK_BYTES of patch data
+ * (the last block may be shorter) with
+ *   BLOCK [0x05][offset u32][crc32 u32]      offset of the block's first byte, zlib.crc32 of it
+ * The block is held in RAM until its CRC matches and only then handed to the patch sink, so the
+ * sink only ever sees verified bytes and committed() is always a valid place to continue from.
+ * Data arrives in order over one link, so this offset is the whole receive state - no bitmap.
+ *
+ * After a dropped link or a bad block the partial block is discarded and the client starts
+ * again with the same patch size and CRC; START answers with committed() and the client resends
+ * from there. Clients without a patch CRC get the original unchecked pass-through.
+ *
+ * Only sees the OtaPatchSink interface, so it also runs on the host (bench-ota-resume).
+ */
+
+// Where verified patch bytes go, strictly in order
+class OtaPatchSink {
+public:
+    virtual ~OtaPatchSink() = default;
+    virtual bool write_patch(const uint8_t* data, size_t length) = 0;
+};
+
+enum OtaBlockResult {
+    OTA_BLOCK_OK = 0,
+    OTA_BLOCK_BAD_OFFSET,       // Not the block the receiver holds - some data was lost
+    OTA_BLOCK_BAD_CRC,
+    OTA_BLOCK_OVERFLOW,         // More than BLE_OTA_BLOCK_BYTES without a BLOCK command
+    OTA_BLOCK_SINK_FAILED
+};
+
+class OtaBlockReceiver {
+public:
+    // verify_blocks false is the unchecked pass-through for clients without block CRCs
+    void begin(uint32_t patch_size, uint32_t patch_crc, bool verify_blocks);
+
+    // Continues a session whose first offset bytes already reached the sink (NVS checkpoint)
+    void resume_at(uint32_t offset);
+
+    // True if a session for this patch can continue at committed()
+    bool matches(uint32_t patch_size, uint32_t patch_crc) const;
+
+    OtaBlockResult write(const uint8_t* data, size_t length, OtaPatchSink* sink);
+
+    // BLOCK command: checks the held block and hands it to the sink. On a mismatch the block is
+    // dropped and the client has to continue at committed().
+    OtaBlockResult end_block(uint32_t offset, uint32_t crc, OtaPatchSink* sink);
+
+    // Link lost: forget the unverified partial block
+    void drop_partial() { buffered_ = 0; }
+
+    bool verifies_blocks() const { return verify_blocks_; }
+    uint32_t committed() const { return committed_; }
+    uint32_t received() const { return committed_ + buffered_; }
+    uint32_t patch_size() const { return patch_size_; }
+    uint32_t patch_crc() const { return patch_crc_; }
+
+    // Every byte arrived and, when checked, was verified
+    bool complete() const { return buffered_ == 0 && committed_ == patch_size_; }
+
+private:
+    uint32_t patch_size_ = 0;
+    uint32_t patch_crc_ = 0;
+    bool verify_blocks_ = false;
+    uint32_t committed_ = 0;                 // Bytes handed to the sink
+    size_t buffered_ = 0;
+    uint8_t block_[BLE_OTA_BLOCK_BYTES];
+};
@@ -6,20 +6,88 @@
 #include "../tasks/task_manager.h"
 #include <Arduino.h>
 #include <BLEDevice.h>
+#include <new>
+
+namespace {
+
+// The running firmware, read back while patching
+class PartitionImageSource : public OtaImageSource {
+public:
+    explicit PartitionImageSource(const esp_partition_t* partition) : partition_(partition) {}
+
+    bool read(uint32_t offset, uint8_t* buffer, size_t length) override {
+        return esp_partition_read(partition_, offset, buffer, length) == ESP_OK;
+    }
+
+    uint32_t size() const override { return partition_->size; }
+
+private:
+    const esp_partition_t* partition_;
+};
+
+// The update partition, erased sector by sector as esp_ota_write() reaches it
+class OtaWriteSink : public OtaImageSink {
+public:
+    esp_ota_handle_t handle = 0;
+
+    bool write(const uint8_t* data, size_t length) override {
+        return esp_ota_write(handle, data, length) == ESP_OK;
+    }
+};
+
+}
+
+struct StreamingUpdate {
+    const esp_partition_t* update_partition;
+    PartitionImageSource source;
+    OtaWriteSink sink;
+    OtaPatchStream stream;
+
+    StreamingUpdate(const esp_partition_t* running, const esp_partition_t* update)
+        : update_partition(update), source(running) {}
+};
+
+namespace {
+
+// NVS record of the last checkpoint, so a staged update survives a restart
+struct OtaCheckpoint {
+    uint32_t patch_size;
+    uint32_t patch_crc;
+    uint32_t offset;
+    uint8_t is_full_update;
+};
+
+const char* OTA_CHECKPOINT_KEY = "ota_ckpt";
+
+const char* block_result_name(OtaBlockResult result) {
+    switch (result) {
+        case OTA_BLOCK_OK: return "ok";
+        case OTA_BLOCK_BAD_OFFSET: return "unexpected block";
+        case OTA_BLOCK_BAD_CRC: return "CRC mismatch";
+        case OTA_BLOCK_OVERFLOW: return "block too long";
+        case OTA_BLOCK_SINK_FAILED: return "apply failed";
+    }
+    return "unknown";
+}
+
+}
 
 OTAHandler::OTAHandler() 
     : ota_in_progress(false)
+    , ota_paused(false)
     , patch_size(0)
     , received_size(0)
     , current_status(BLE_OTA_IDLE)
     , current_firmware_build_number("")
     , is_full_update(false)
+    , streaming(nullptr)
+    , blocks(nullptr)
     , power_state(NORMAL_POWER)
     , normal_cpu_freq_mhz(BLE_NORMAL_CPU_FREQ_MHZ) {
 }
 
 OTAHandler::~OTAHandler() {
-    if (ota_in_progress) {
+    if (ota_in_progress || ota_paused) {
         abort_ota();
     }
     restore_normal_power_mode();
@@ -97,7 +165,8 @@ void OTAHandler::restore_normal_power() {
     LOG_BLE("OTA Power: Normal power mode restored\n");
 }
 
-bool OTAHandler::start_ota(uint32_t size, const String& expected_build_number, bool is_full_update, const String& expected_firmware_version) {
+bool OTAHandler::start_ota(uint32_t size, const String& expected_build_number, bool is_full_update,
+                           const String& expected_firmware_version, bool verify_blocks, uint32_t patch_crc) {
     LOG_OTA_DEBUG("start_ota() called - size=%lu, build=%s, full=%d\n", 
                   (unsigned long)size, expected_build_number.c_str(), is_full_update);
     
@@ -106,6 +175,22 @@ bool OTAHandler::start_ota(uint32_t size, const String& expected_build_number, b
         LOG_OTA_DEBUG("start_ota() FAILED - already in progress\n");
         return false;
     }
+
+    // Same patch after a dropped link: continue after the last verified block
+    if (ota_paused && verify_blocks && blocks->matches(size, patch_crc) && this->is_full_update == is_full_update) {
+        ota_paused = false;
+        ota_in_progress = true;
+        received_size = blocks->committed();
+        task_manager.suspend_hardware_tasks();
+        current_status = BLE_OTA_RECEIVING;
+        LOG_BLE("OTA: Resuming %s update at %lu / %lu KB\n", is_full_update ? "full" : "delta",
+                (unsigned long)received_size / 1024, (unsigned long)size / 1024);
+        return true;
+    }
+    if (ota_paused) {
+        LOG_BLE("OTA: New update replaces the paused one\n");
+        release_session();
+    }
     
     patch_size = size;
     received_size = 0;
@@ -130,11 +215,20 @@ bool OTAHandler::start_ota(uint32_t size, const String& expected_build_number, b
         LOG_OTA_DEBUG("No expected firmware version to store\n");
     }
 
+    blocks = new (std::nothrow) OtaBlockReceiver();
+    if (!blocks) {
+        LOG_BLE("OTA: Out of memory for the block buffer\n");
+        current_status = BLE_OTA_ERROR;
+        return false;
+    }
+    blocks->begin(size, patch_crc, verify_blocks);
+
     task_manager.suspend_hardware_tasks();
     LOG_OTA_DEBUG("Calling start_update()...\n");
     if (!start_update()) {
         current_status = BLE_OTA_ERROR;
         LOG_OTA_DEBUG("start_update() FAILED\n");
+        release_session();
         task_manager.resume_hardware_tasks();
         return false;
     }
@@ -151,10 +245,9 @@ bool OTAHandler::process_data_chunk(const uint8_t* data, size_t size) {
         return false;
     }
 
-    // Write patch data to patch partition
-    if (delta_partition_write(&patch_writer, (const char*)data, size) != ESP_OK) {
-        LOG_BLE("OTA: Patch write failed at offset %lu\n", (unsigned long)received_size);
-        current_status = BLE_OTA_ERROR;
+    // Held until its block CRC arrives, or passed straight to write_patch() for unchecked clients
+    OtaBlockResult result = blocks->write(data, size, this);
+    if (!handle_block_result(result)) {
         return false;
     }
 
@@ -180,6 +273,11 @@ bool OTAHandler::complete_ota() {
         LOG_OTA_DEBUG("complete_ota() FAILED - no update in progress\n");
         return false;
     }
+    if (!blocks->complete()) {
+        LOG_BLE("OTA: Only %lu of %lu bytes verified\n", (unsigned long)blocks->committed(), (unsigned long)patch_size);
+        suspend_ota();
+        return false;
+    }
     
     LOG_BLE("OTA: Finalizing update...\n");
     LOG_OTA_DEBUG("patch_size=%lu, received_size=%lu\n", 
@@ -203,6 +301,7 @@ bool OTAHandler::complete_ota() {
     LOG_OTA_DEBUG("Calling finalize_update()...\n");
     bool success = finalize_update();
     if (success) {
+        clear_checkpoint();
         current_status = BLE_OTA_SUCCESS;
         LOG_OTA_DEBUG("finalize_update() SUCCESS\n");
         LOG_BLE("OTA: Update complete (%lu KB)\n", (unsigned long)received_size / 1024);
@@ -238,20 +337,104 @@ bool OTAHandler::complete_ota() {
     }
     
     ota_in_progress = false;
+    release_session();
+    clear_checkpoint();
     task_manager.resume_hardware_tasks();
     LOG_OTA_DEBUG("complete_ota() returning %s\n", success ? "SUCCESS" : "FAILED");
     return success;
 }
 
 void OTAHandler::abort_ota() {
-    if (ota_in_progress) {
+    if (ota_in_progress || ota_paused) {
         LOG_BLE("OTA: Aborting update\n");
+        bool was_receiving = ota_in_progress;
         ota_in_progress = false;
         received_size = 0;
         patch_size = 0;
         current_status = BLE_OTA_ERROR;
-        task_manager.resume_hardware_tasks();
+        release_session();
+        clear_checkpoint();
+        if (was_receiving) {
+            task_manager.resume_hardware_tasks();
+        }
+    }
+}
+
+bool OTAHandler::verify_block(uint32_t offset, uint32_t crc) {
+    if (!ota_in_progress) {
+        return false;
+    }
+
+    OtaBlockResult result = blocks->end_block(offset, crc, this);
+    if (!handle_block_result(result)) {
+        return false;
     }
+    received_size = blocks->received();
+
+#if !BLE_OTA_STREAMING_APPLY
+    if (blocks->committed() % (BLE_OTA_BLOCK_BYTES * BLE_OTA_CHECKPOINT_BLOCKS) == 0) {
+        save_checkpoint();
+    }
+#endif
+    return true;
+}
+
+void OTAHandler::suspend_ota() {
+    if (!ota_in_progress) {
+        return;
+    }
+    if (!blocks->verifies_blocks()) {
+        abort_ota();
+        return;
+    }
+
+    blocks->drop_partial();
+    received_size = blocks->committed();
+    ota_in_progress = false;
+    ota_paused = true;
+    current_status = BLE_OTA_ERROR;
+    LOG_BLE("OTA: Paused at %lu / %lu KB - waiting for the client to resume\n",
+            (unsigned long)received_size / 1024, (unsigned long)patch_size / 1024);
+    task_manager.resume_hardware_tasks();
+}
+
+uint32_t OTAHandler::get_resume_offset() const {
+    return (blocks && blocks->verifies_blocks()) ? blocks->committed() : 0;
+}
+
+bool OTAHandler::write_patch(const uint8_t* data, size_t length) {
+#if BLE_OTA_STREAMING_APPLY
+    // Patch straight into the update partition
+    int result = streaming->stream.write(data, length);
+    if (result < 0) {
+        LOG_BLE("OTA: Patch apply failed at offset %lu: %s\n", (unsigned long)blocks->committed(),
+                detools_error_as_string(result));
+        return false;
+    }
+#else
+    // Write patch data to patch partition
+    if (delta_partition_write(&patch_writer, (const char*)data, length) != ESP_OK) {
+        LOG_BLE("OTA: Patch write failed at offset %lu\n", (unsigned long)blocks->committed());
+        return false;
+    }
+#endif
+    return true;
+}
+
+bool OTAHandler::handle_block_result(OtaBlockResult result) {
+    if (result == OTA_BLOCK_OK) {
+        return true;
+    }
+
+    LOG_BLE("OTA: Block at %lu rejected: %s\n", (unsigned long)blocks->committed(), block_result_name(result));
+    if (result == OTA_BLOCK_SINK_FAILED || !blocks->verifies_blocks()) {
+        // Nothing to resume from: the apply state or the unchecked data is broken
+        abort_ota();
+    } else {
+        // The verified blocks are fine - the client resends from get_resume_offset()
+        suspend_ota();
+    }
+    return false;
 }
 
 float OTAHandler::get_progress() const {
@@ -260,17 +443,32 @@ float OTAHandler::get_progress() const {
 }
 
 bool OTAHandler::start_update() {
+#if BLE_OTA_STREAMING_APPLY
+    return start_streaming_update();
+#else
+    // A checkpoint from before a restart: the patch partition still holds the verified blocks
+    uint32_t checkpoint = load_checkpoint();
+    if (checkpoint > 0 && resume_patch_partition(checkpoint)) {
+        blocks->resume_at(checkpoint);
+        received_size = checkpoint;
+        LOG_BLE("OTA: Resuming from checkpoint at %lu KB\n", (unsigned long)checkpoint / 1024);
+        return true;
+    }
+
     // Initialize patch partition for writing
     if (delta_partition_init(&patch_writer, "patch", patch_size) != ESP_OK) {
         LOG_BLE("OTA: Failed to initialize patch partition\n");
         return false;
     }
     return true;
+#endif
 }
 
 bool OTAHandler::finalize_update() {
     LOG_OTA_DEBUG("finalize_update() called\n");
-    
+#if BLE_OTA_STREAMING_APPLY
+    return finalize_streaming_update();
+#else
     // Verify received size matches expected
     LOG_OTA_DEBUG("Verifying received size: expected=%lu, got=%lu\n", 
                   (unsigned long)patch_size, (unsigned long)received_size);
@@ -331,6 +529,141 @@ bool OTAHandler::finalize_update() {
     
     LOG_OTA_DEBUG("finalize_update() SUCCESS - delta patch applied\n");
     return true;
+#endif
+}
+
+bool OTAHandler::start_streaming_update() {
+    release_streaming_update();
+
+    const esp_partition_t* running_partition = esp_ota_get_running_partition();
+    const esp_partition_t* update_partition = esp_ota_get_next_update_partition(NULL);
+    if (!running_partition || !update_partition) {
+        LOG_BLE("OTA: Could not find the running or update partition\n");
+        return false;
+    }
+
+    streaming = new (std::nothrow) StreamingUpdate(running_partition, update_partition);
+    if (!streaming) {
+        LOG_BLE("OTA: Out of memory for streaming apply\n");
+        return false;
+    }
+
+    // Sequential writes erase each sector as it is reached instead of the whole partition up front
+    if (esp_ota_begin(update_partition, OTA_WITH_SEQUENTIAL_WRITES, &streaming->sink.handle) != ESP_OK) {
+        LOG_BLE("OTA: esp_ota_begin failed for '%s'\n", update_partition->label);
+        delete streaming;
+        streaming = nullptr;
+        return false;
+    }
+
+    int result = streaming->stream.begin(is_full_update ? nullptr : &streaming->source, &streaming->sink, patch_size);
+    if (result < 0) {
+        LOG_BLE("OTA: Patch stream init failed: %s\n", detools_error_as_string(result));
+        release_streaming_update();
+        return false;
+    }
+
+    LOG_BLE("OTA Info: Streaming %s patch from '%s' into '%s'\n", is_full_update ? "full" : "delta",
+            running_partition->label, update_partition->label);
+    return true;
+}
+
+bool OTAHandler::finalize_streaming_update() {
+    if (!streaming) {
+        return false;
+    }
+    if (received_size != patch_size) {
+        LOG_BLE("OTA: Size mismatch - expected %lu, got %lu\n",
+                (unsigned long)patch_size, (unsigned long)received_size);
+        return false;
+    }
+
+    int image_size = streaming->stream.finish();
+    if (image_size < 0) {
+        LOG_BLE("Delta patch failed: %s\n", detools_error_as_string(image_size));
+        return false;
+    }
+
+    // esp_ota_end() checks the image header, segments and SHA-256 before it can be booted
+    esp_err_t err = esp_ota_end(streaming->sink.handle);
+    streaming->sink.handle = 0;
+    if (err != ESP_OK) {
+        LOG_BLE("OTA: New image failed verification: %s\n", esp_err_to_name(err));
+        return false;
+    }
+    if (esp_ota_set_boot_partition(streaming->update_partition) != ESP_OK) {
+        LOG_BLE("OTA: Failed to set boot partition '%s'\n", streaming->update_partition->label);
+        return false;
+    }
+
+    LOG_BLE("OTA: Patched image verified (%d bytes from %lu patch bytes)\n", image_size, (unsigned long)patch_size);
+    return true;
+}
+
+void OTAHandler::release_streaming_update() {
+    if (!streaming) {
+        return;
+    }
+    if (streaming->sink.handle) {
+        esp_ota_abort(streaming->sink.handle);
+    }
+    delete streaming;
+    streaming = nullptr;
+}
+
+void OTAHandler::release_session() {
+    release_streaming_update();
+    delete blocks;
+    blocks = nullptr;
+    ota_paused = false;
+}
+
+uint32_t OTAHandler::load_checkpoint() const {
+    OtaCheckpoint checkpoint;
+    if (!preferences || !blocks->verifies_blocks() ||
+        preferences->getBytes(OTA_CHECKPOINT_KEY, &checkpoint, sizeof(checkpoint)) != sizeof(checkpoint)) {
+        return 0;
+    }
+    if (!blocks->matches(checkpoint.patch_size, checkpoint.patch_crc) ||
+        checkpoint.is_full_update != (is_full_update ? 1 : 0)) {
+        return 0;
+    }
+    return checkpoint.offset;
+}
+
+void OTAHandler::save_checkpoint() {
+    if (!preferences) {
+        return;
+    }
+    OtaCheckpoint checkpoint = {patch_size, blocks->patch_crc(), blocks->committed(), (uint8_t)(is_full_update ? 1 : 0)};
+    preferences->putBytes(OTA_CHECKPOINT_KEY, &checkpoint, sizeof(checkpoint));
+}
+
+void OTAHandler::clear_checkpoint() {
+    if (preferences && preferences->isKey(OTA_CHECKPOINT_KEY)) {
+        preferences->remove(OTA_CHECKPOINT_KEY);
+    }
+}
+
+bool OTAHandler::resume_patch_partition(uint32_t offset) {
+    const esp_partition_t* patch = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                            ESP_PARTITION_SUBTYPE_DATA_SPIFFS, "patch");
+    if (!patch || offset % PARTITION_PAGE_SIZE != 0) {
+        return false;
+    }
+
+    // Blocks after the checkpoint may have been written before the restart - erase them again
+    uint32_t end = ((patch_size + PARTITION_PAGE_SIZE - 1) / PARTITION_PAGE_SIZE) * PARTITION_PAGE_SIZE;
+    if (esp_partition_erase_range(patch, offset, end - offset) != ESP_OK) {
+        LOG_BLE("OTA: Could not erase the patch partition after the checkpoint\n");
+        return false;
+    }
+
+    patch_writer.name = "patch";
+    patch_writer.patch = patch;
+    patch_writer.size = patch_size;
+    patch_writer.offset = offset;
+    return true;
 }
 
 String OTAHandler::check_ota_failure_after_boot() {
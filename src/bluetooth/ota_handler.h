@@ -16,13 +16,19 @@ extern "C" {
 
 // Removed config.h - not needed for HX711Core integration
 #include "../config/constants.h"
+#include "ota_block_receiver.h"
+#include "ota_patch_stream.h"
+
+struct StreamingUpdate;
 
 // OTA-specific enums
 enum BLEOTACommand {
     BLE_OTA_CMD_START = 0x01,
     BLE_OTA_CMD_DATA = 0x02,
     BLE_OTA_CMD_END = 0x03,
-    BLE_OTA_CMD_ABORT = 0x04
+    BLE_OTA_CMD_ABORT = 0x04,
+    BLE_OTA_CMD_BLOCK = 0x05,           // [offset u32][crc32 u32] - see ota_block_receiver.h
+    BLE_OTA_CMD_QUERY = 0x06            // Re-send the status with the last verified offset
 };
 
 enum BLEOTAStatus {
@@ -44,11 +50,17 @@ enum BLEPowerState {
  * OTAHandler - Manages over-the-air firmware updates via BLE
  * 
  * Handles delta patching, power management, and firmware validation
- * for BLE-based firmware updates.
+ * for BLE-based firmware updates. With BLE_OTA_STREAMING_APPLY the patch is
+ * applied to the update partition while it arrives; otherwise it is staged in
+ * the "patch" partition and applied by finalize_update().
+ *
+ * Clients that send block CRCs can resume: a dropped link pauses the update at
+ * the last verified block, and a START for the same patch continues from there.
  */
-class OTAHandler {
+class OTAHandler : public OtaPatchSink {
 private:
     bool ota_in_progress;
+    bool ota_paused;                     // Link dropped, waiting for the client to resume
     uint32_t patch_size;
     uint32_t received_size;
     BLEOTAStatus current_status;
@@ -64,11 +76,22 @@ private:
     
     // Delta OTA components
     delta_partition_writer_t patch_writer;
+    StreamingUpdate* streaming;          // Streaming apply state, allocated while an update runs
+    OtaBlockReceiver* blocks;            // Block CRC checks and the resume offset, same lifetime
     
     void reduce_power_for_ble();
     void restore_normal_power();
     bool start_update();
     bool finalize_update();
+    bool start_streaming_update();
+    bool finalize_streaming_update();
+    void release_streaming_update();
+    void release_session();
+    bool handle_block_result(OtaBlockResult result);
+    uint32_t load_checkpoint() const;
+    void save_checkpoint();
+    void clear_checkpoint();
+    bool resume_patch_partition(uint32_t offset);
     
 public:
     OTAHandler();
@@ -85,9 +108,12 @@ public:
      * @param size Size of the patch data to receive
      * @param expected_build_number Build number we expect after successful update
      * @param is_full_update True for full update, false for delta update
-     * @return true if successfully started
+     * @param verify_blocks True if the client sends BLE_OTA_CMD_BLOCK after every block
+     * @param patch_crc CRC-32 of the whole patch, identifies the update when resuming
+     * @return true if successfully started or resumed
      */
-    bool start_ota(uint32_t size, const String& expected_build_number = "", bool is_full_update = false, const String& expected_firmware_version = "");
+    bool start_ota(uint32_t size, const String& expected_build_number = "", bool is_full_update = false,
+                   const String& expected_firmware_version = "", bool verify_blocks = false, uint32_t patch_crc = 0);
     
     /**
      * Process received OTA data chunk
@@ -96,6 +122,24 @@ public:
      * @return true if chunk processed successfully
      */
     bool process_data_chunk(const uint8_t* data, size_t size);
+
+    /**
+     * Check the block that ends here and pass it on (BLE_OTA_CMD_BLOCK)
+     * @return false if it did not match - the update is paused at get_resume_offset()
+     */
+    bool verify_block(uint32_t offset, uint32_t crc);
+
+    /**
+     * Link lost: keep the verified blocks for a resume, or abort if the client cannot resume
+     */
+    void suspend_ota();
+
+    /**
+     * Verified patch bytes the client can continue after, 0 without a resumable update
+     */
+    uint32_t get_resume_offset() const;
+
+    bool write_patch(const uint8_t* data, size_t length) override;
     
     /**
      * Finalize OTA update and restart device
@@ -122,6 +166,11 @@ public:
      * Check if OTA is in progress
      */
     bool is_ota_active() const { return ota_in_progress; }
+
+    /**
+     * Check if an update is paused waiting for the client to resume
+     */
+    bool is_ota_paused() const { return ota_paused; }
     
     /**
      * Get current firmware build number
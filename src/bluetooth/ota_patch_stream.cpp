@@ -0,0 +1,126 @@
+#include "ota_patch_stream.h"
+
+#include <string.h>
+
+int OtaPatchStream::begin(OtaImageSource* source, OtaImageSink* sink, uint32_t patch_size) {
+    source_ = source;
+    sink_ = sink;
+    patch_size_ = patch_size;
+    patch_bytes_ = 0;
+    image_bytes_ = 0;
+    source_offset_ = 0;
+    buffered_ = 0;
+    header_bytes_ = 0;
+    header_complete_ = false;
+    error_ = sink ? detools_apply_patch_init(&apply_, read_source, seek_source, patch_size, write_image, this)
+                  : -DETOOLS_IO_FAILED;
+    return error_;
+}
+
+int OtaPatchStream::write(const uint8_t* data, size_t length) {
+    if (error_ < 0) {
+        return error_;
+    }
+    if (patch_bytes_ + length > patch_size_) {
+        error_ = -DETOOLS_CORRUPT_PATCH;
+        return error_;
+    }
+    patch_bytes_ += length;
+
+    // detools expects the whole header in its first call - BLE writes may split it
+    while (!header_complete_ && length > 0) {
+        header_[header_bytes_++] = *data++;
+        length--;
+        bool size_done = header_bytes_ > 1 && (header_[header_bytes_ - 1] & 0x80) == 0;
+        if (size_done || header_bytes_ == sizeof(header_)) {
+            header_complete_ = true;
+            if (process(header_, header_bytes_) < 0) {
+                return error_;
+            }
+        }
+    }
+    if (length > 0) {
+        process(data, length);
+    }
+    return error_;
+}
+
+int OtaPatchStream::finish() {
+    if (error_ < 0) {
+        return error_;
+    }
+    if (patch_bytes_ != patch_size_) {
+        error_ = -DETOOLS_NOT_ENOUGH_PATCH_DATA;
+        return error_;
+    }
+    if (!header_complete_) {
+        error_ = -DETOOLS_SHORT_HEADER;
+        return error_;
+    }
+    int result = detools_apply_patch_finalize(&apply_);
+    if (result < 0) {
+        error_ = result;
+        return error_;
+    }
+    if (!flush()) {
+        error_ = -DETOOLS_IO_FAILED;
+        return error_;
+    }
+    return result;
+}
+
+int OtaPatchStream::process(const uint8_t* data, size_t length) {
+    int result = detools_apply_patch_process(&apply_, data, length);
+    if (result < 0) {
+        error_ = result;
+    }
+    return error_;
+}
+
+int OtaPatchStream::read_source(void* arg, uint8_t* buffer, size_t length) {
+    OtaPatchStream* self = static_cast<OtaPatchStream*>(arg);
+    if (!self->source_) {
+        memset(buffer, 0, length);
+    } else if (self->source_offset_ < 0 || self->source_offset_ + length > self->source_->size() ||
+               !self->source_->read((uint32_t)self->source_offset_, buffer, length)) {
+        return -DETOOLS_IO_FAILED;
+    }
+    self->source_offset_ += length;
+    return 0;
+}
+
+int OtaPatchStream::seek_source(void* arg, int offset) {
+    // Checked on the next read - detools may seek past the end after the last segment
+    static_cast<OtaPatchStream*>(arg)->source_offset_ += offset;
+    return 0;
+}
+
+int OtaPatchStream::write_image(void* arg, const uint8_t* data, size_t length) {
+    OtaPatchStream* self = static_cast<OtaPatchStream*>(arg);
+    while (length > 0) {
+        size_t piece = sizeof(self->buffer_) - self->buffered_;
+        if (piece > length) {
+            piece = length;
+        }
+        memcpy(self->buffer_ + self->buffered_, data, piece);
+        self->buffered_ += piece;
+        data += piece;
+        length -= piece;
+        if (self->buffered_ == sizeof(self->buffer_) && !self->flush()) {
+            return -DETOOLS_IO_FAILED;
+        }
+    }
+    return 0;
+}
+
+bool OtaPatchStream::flush() {
+    if (buffered_ == 0) {
+        return true;
+    }
+    if (!sink_->write(buffer_, buffered_)) {
+        return false;
+    }
+    image_bytes_ += buffered_;
+    buffered_ = 0;
+    return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../config/bluetooth.h"
+
+extern "C" {
+#include "detools.h"
+}
+
+/*
+ * Streaming detools patch apply - feeds patch bytes to the heatshrink decoder as they arrive and
+ * writes the patched image out at the same time, so nothing is staged and no second flash pass
+ * is needed once the transfer ends.
+ *
+ * The patch is a sequential detools patch (detools create_patch -c heatshrink). It reads the
+ * running image through OtaImageSource and writes the new one through OtaImageSink, gathered
+ * into BLE_OTA_WRITE_BUFFER_BYTES writes. A full update has no source and patches against zeros.
+ * All state lives in the object - no heap allocation.
+ */
+
+// The image being patched, read at increasing offsets with small backward/forward seeks
+class OtaImageSource {
+public:
+    virtual ~OtaImageSource() = default;
+    virtual bool read(uint32_t offset, uint8_t* buffer, size_t length) = 0;
+    virtual uint32_t size() const = 0;
+};
+
+// The new image, written strictly in order
+class OtaImageSink {
+public:
+    virtual ~OtaImageSink() = default;
+    virtual bool write(const uint8_t* data, size_t length) = 0;
+};
+
+class OtaPatchStream {
+public:
+    // source may be null for a full update. Returns 0 or a negative detools error.
+    int begin(OtaImageSource* source, OtaImageSink* sink, uint32_t patch_size);
+
+    // Applies the next patch bytes. Returns 0 or a negative detools error; after an error the
+    // stream stays failed.
+    int write(const uint8_t* data, size_t length);
+
+    // Flushes the output once the whole patch was written. Returns the image size or a negative
+    // detools error (also when the patch ended early or had trailing data).
+    int finish();
+
+    uint32_t patch_bytes() const { return patch_bytes_; }
+    uint32_t image_bytes() const { return image_bytes_; }
+
+private:
+    static int read_source(void* arg, uint8_t* buffer, size_t length);
+    static int seek_source(void* arg, int offset);
+    static int write_image(void* arg, const uint8_t* data, size_t length);
+    int process(const uint8_t* data, size_t length);
+    bool flush();
+
+    struct detools_apply_patch_t apply_;
+    OtaImageSource* source_ = nullptr;
+    OtaImageSink* sink_ = nullptr;
+    uint32_t patch_size_ = 0;
+    uint32_t patch_bytes_ = 0;
+    uint32_t image_bytes_ = 0;               // Handed to the sink so far
+    int64_t source_offset_ = 0;
+    int error_ = 0;
+    uint8_t header_[6];                      // Patch type and image size, parsed by detools in one call
+    uint8_t header_bytes_ = 0;
+    bool header_complete_ = false;
+    size_t buffered_ = 0;
+    uint8_t buffer_[BLE_OTA_WRITE_BUFFER_BYTES];
+};
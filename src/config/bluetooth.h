@@ -29,6 +29,15 @@
 #define BLE_DATA_STATUS_CHAR_UUID "55667788-99aa-bbcc-ddee-ffaabbccddee"      // Status notifications characteristic
 #define BLE_DATA_CHUNK_SIZE_BYTES 512                                          // Per-chunk payload size for data export
 
+// Windowed bulk transfer (src/bluetooth/bulk_transfer.h)
+#define BLE_BULK_DEFAULT_WINDOW 16                                             // Frames in flight when the client does not ask
+#define BLE_BULK_MAX_WINDOW 32                                                 // Upper bound on a requested window
+#define BLE_BULK_MAX_FRAME_BYTES 512                                           // Largest frame (header + payload), ATT limit
+#define BLE_BULK_DEFAULT_FRAME_BYTES 244                                       // Frame size when the MTU is unknown (247 MTU - 3)
+#define BLE_BULK_FRAMES_PER_POLL 6                                             // Notifications queued per BLE task cycle
+#define BLE_BULK_ACK_TIMEOUT_MS 400                                            // No ACK progress for this long: resend the window
+#define BLE_TRACE_TRANSFER_ID 0xFFFFFFFFu                                      // START/END id of task trace downloads (never a session id)
+
 //------------------------------------------------------------------------------
 // BLE DEBUG SERVICE (Nordic UART Service)
 //------------------------------------------------------------------------------
@@ -72,6 +81,14 @@
 #define BLE_SHUTDOWN_ADVERTISING_DELAY_MS 50                                   // Delay to allow advertising to stop cleanly
 #define BLE_SHUTDOWN_DEINIT_DELAY_MS 100                                       // Delay to allow BLE stack to deinitialize
 
+//------------------------------------------------------------------------------
+// OTA PATCH APPLY
+//------------------------------------------------------------------------------
+#define BLE_OTA_STREAMING_APPLY 1                                              // 1: patch the update partition as chunks arrive, 0: stage in "patch" first
+#define BLE_OTA_WRITE_BUFFER_BYTES 4096                                        // Patched output gathered per esp_ota_write() (one flash sector)
+#define BLE_OTA_BLOCK_BYTES 4096                                               // Patch bytes per CRC-checked block (resume granularity, one flash sector)
+#define BLE_OTA_CHECKPOINT_BLOCKS 16                                           // Verified blocks between NVS checkpoints (staged apply only)
+
 //------------------------------------------------------------------------------
 // BLE POWER MANAGEMENT
 //------------------------------------------------------------------------------
@@ -37,6 +37,25 @@ enum class GrinderPurgeMode {
 #define GRIND_UNDERSHOOT_TARGET_G 1.0f                                    // Default conservative undershoot target
 #define GRIND_LATENCY_TO_COAST_RATIO 1.0f                                 // Ratio of expected coast time to measured latency (e.g., 0.8 = 80%)
 
+// Motor stop planner (controllers/stop_planner.h) - selected per grind from preferences
+#define GRIND_STOP_PLANNER_DEFAULT 1                                      // 0 = coast ratio heuristic above, 1 = learned in-flight model
+#define GRIND_STOP_PLANNER_HISTORY 8                                      // Predictive stops kept for the coast time fit
+#define GRIND_STOP_PLANNER_MIN_HISTORY 3                                  // Stops needed before the fit replaces the coast ratio
+#define GRIND_STOP_PLANNER_FLOW_WINDOW_MS 1500                            // Flow rate window used for stop planning
+#define GRIND_STOP_PLANNER_FLOW_ALPHA 0.3f                                // Flow level smoothing (per control update)
+#define GRIND_STOP_PLANNER_TREND_BETA 0.1f                                // Flow trend smoothing (per control update)
+#define GRIND_STOP_PLANNER_MAX_TREND_PROJECTION 0.25f                     // Max flow correction from the trend, fraction of measured flow
+#define GRIND_STOP_PLANNER_AIM_SIGMA 2.0f                                 // Model residual standard deviations to aim below target
+#define GRIND_STOP_PLANNER_MAX_COAST_MS 3000.0f                           // Longer apparent coasts are rejected as disturbances
+
+// Learned per-profile grinder model (controllers/learned_grind_model.h) - updated after every completed weight grind
+#define GRIND_MODEL_ALPHA 0.3f                                            // Weight of the newest session in the smoothed values
+#define GRIND_MODEL_MIN_SESSIONS 1                                        // Sessions before the model seeds the next grind
+#define GRIND_MODEL_MIN_PULSES 3                                          // Pulses before the learned pulse gain sizes pulses
+#define GRIND_MODEL_MIN_PULSE_TIME_MS 100.0f                              // Shorter pulses (beyond motor latency) don't count towards the gain
+#define GRIND_MODEL_MAX_LATENCY_MS 3000.0f                                // Sanity limit for the learned start latency
+#define GRIND_MODEL_MAX_COAST_G 3.0f                                      // Sanity limit for the learned coast mass
+
 // Prime phase behavior
 #define GRIND_PRIME_TARGET_WEIGHT_G 1.0f                                   // Amount of coffee delivered during chute priming
 #define GRIND_PRIME_MAX_DURATION_MS 5000                                   // Safety timeout for chute priming run
@@ -80,6 +99,34 @@ enum class GrinderPurgeMode {
 #define GRIND_SCALE_PRECISION_SETTLING_TIME_MS 500                                // High-precision settling time
 #define GRIND_SCALE_SETTLING_TIMEOUT_MS 10000                                     // Maximum time to wait for settling
 
+// Sequential settling detector - a settled reading is accepted as soon as a change-point
+// test is confident enough, instead of only after the fixed settling windows above.
+// The fixed-window rule stays in place, whichever settles first wins.
+#ifndef GRIND_SEQUENTIAL_SETTLING
+    #define GRIND_SEQUENTIAL_SETTLING 1                                           // Default: enabled, override with build flag
+#endif
+#define GRIND_SETTLE_FALSE_SETTLE_PROBABILITY 0.01f                               // Accepted chance of settling further than the tolerance from the final weight
+#define GRIND_SETTLE_TOLERANCE_G 0.015f                                           // Largest acceptable error of a sequentially settled reading
+#define GRIND_SETTLE_MIN_SAMPLES 3                                                // Samples since the last change before the detector may settle
+#define GRIND_SETTLE_NOISE_INITIAL_G 0.005f                                       // Load cell noise assumed until learned from settled readings
+#define GRIND_SETTLE_NOISE_MIN_G 0.002f                                           // Floor for the learned load cell noise
+#define GRIND_SETTLE_CUSUM_SLACK 0.5f                                             // Change detector slack, in noise standard deviations
+#define GRIND_SETTLE_CUSUM_THRESHOLD 4.0f                                         // Change detector threshold, in noise standard deviations
+
+// Weight/flow Kalman estimator - control weight and flow rate from a [weight, flow] filter
+// updated on every sample, with process noise switched by the motor state, instead of the
+// 100ms weight window and the 200ms two-point flow rate
+#ifndef GRIND_WEIGHT_FLOW_ESTIMATOR
+    #define GRIND_WEIGHT_FLOW_ESTIMATOR 1                                         // Default: enabled, override with build flag
+#endif
+#define GRIND_ESTIMATOR_IDLE_NOISE_G 0.005f                                       // Sample noise with the motor stopped
+#define GRIND_ESTIMATOR_MOTOR_NOISE_G 0.033f                                      // Sample noise with the motor running (vibration)
+#define GRIND_ESTIMATOR_FLOWING_Q 1.0f                                           // Flow random walk while grounds can arrive ((g/s)^2/s)
+#define GRIND_ESTIMATOR_IDLE_Q 0.001f                                             // Flow random walk once they cannot ((g/s)^2/s)
+#define GRIND_ESTIMATOR_COAST_WINDOW_MS 1500                                      // Grounds can still land this long after the motor stops
+#define GRIND_ESTIMATOR_IDLE_FLOW_DECAY_MS 200.0f                                 // Flow estimate time constant once no grounds can arrive
+#define GRIND_ESTIMATOR_RESET_SIGMA 6.0f                                          // Innovation (standard deviations) that restarts the filter
+
 // Tare and calibration timing (hardware sample rate dependent)
 #define GRIND_TARE_SAMPLE_WINDOW_MS 500                                           // Time window for tare sampling
 #define GRIND_TARE_TIMEOUT_MS 3000                                                // Maximum tare completion time
@@ -103,3 +150,12 @@ enum class GrinderPurgeMode {
 #define GRIND_AUTOTUNE_COLLECTION_DELAY_MS 1500                                   // Minimum wait after pulse for grounds to drop
 #define GRIND_AUTOTUNE_SETTLING_TIMEOUT_MS 5000                                   // Max wait per pulse for scale settling
 #define GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G GRIND_SCALE_SETTLING_TOLERANCE_G        // 0.010g detection threshold
+
+// Bayesian latency search (controllers/latency_search.h) - picks each test pulse from a posterior over
+// the latency and stops at the target confidence instead of step halving plus verification rounds
+#ifndef GRIND_AUTOTUNE_SEARCH_DEFAULT
+    #define GRIND_AUTOTUNE_SEARCH_DEFAULT 1                                       // 0 = binary search + verification, 1 = Bayesian (default), override with build flag
+#endif
+#define GRIND_AUTOTUNE_BAYES_CONFIDENCE 0.80f                                     // Credible interval that must fit within +/- GRIND_AUTOTUNE_TARGET_ACCURACY_MS
+#define GRIND_AUTOTUNE_BAYES_LAPSE 0.02f                                          // Chance a test pulse is misread either way
+#define GRIND_AUTOTUNE_BAYES_MAX_PULSES 30                                        // Hard stop safety limit
@@ -40,6 +40,15 @@
 #define HW_LOADCELL_SAMPLE_RATE_SPS 10                                         // Current sample rate setting
 #define HW_LOADCELL_SAMPLE_INTERVAL_MS (1000 / HW_LOADCELL_SAMPLE_RATE_SPS)   // Calculated sample interval
 
+// Acquisition mode: DOUT falling-edge interrupt timestamps each conversion and wakes the
+// sampling task, which clocks the word out with the SPI peripheral (no interrupt-off window).
+// 0 = original 20ms polling with bit-banged reads.
+#ifndef HW_LOADCELL_IRQ_ACQUISITION
+    #define HW_LOADCELL_IRQ_ACQUISITION 1                                     // Default: interrupt-driven, override with build flag
+#endif
+#define HW_LOADCELL_SPI_CLOCK_HZ 1000000                                       // SCK rate for SPI-clocked reads (HX711 allows up to ~5MHz)
+#define HW_LOADCELL_SAMPLE_RING_SIZE 8                                         // Timestamped conversions buffered between read and filter (power of 2)
+
 // Calibration validation
 #define HW_LOADCELL_CAL_MIN_ADC_VALUE 1000                                    // Minimum ADC value to confirm weight placed on scale
 
@@ -54,6 +63,14 @@
 #define HW_DISPLAY_IPS_INVERT_Y 24                                             // IPS Y-axis inversion setting
 #define HW_DISPLAY_COLOR_ORDER 20                                              // Color channel ordering
 #define HW_DISPLAY_MINIMAL_BRIGHTNESS_PERCENT 15                               // Minimum brightness percentage (to avoid too dim to see)
+#define HW_DISPLAY_DRAW_BUFFER_ROWS 40                                         // Rows per LVGL draw buffer (280 * 40 * 2 = 22,400 bytes)
+#define HW_DISPLAY_STAGING_ROWS 16                                             // Rows per internal DMA staging copy (halved until it allocates)
+
+// Flush areas: 1 = whole rows (original behaviour), 0 = invalidated area rounded to the CO5300's
+// 2-pixel column/row granularity, which sends fewer bytes for small widgets like the weight label
+#ifndef HW_DISPLAY_FLUSH_FULL_WIDTH
+    #define HW_DISPLAY_FLUSH_FULL_WIDTH 1                                      // Default: full-width strips, override with build flag
+#endif
 
 //------------------------------------------------------------------------------
 // SERIAL COMMUNICATION
@@ -31,12 +31,32 @@
 #define SYS_TASK_BLUETOOTH_INTERVAL_MS 20                                      // Bluetooth handling frequency (50Hz) - Core 1
 #define SYS_TASK_FILE_IO_INTERVAL_MS 100                                       // File I/O operations frequency (10Hz) - Core 1
 
+// Grind control wakeups: the sampling task notifies the control task after every fed sample,
+// so stop decisions run as soon as new weight data exists. Phases that time the motor
+// (prime, time mode, pulses) still wake at the fixed interval; others fall back to a slower timer.
+// 0 = original fixed 20ms vTaskDelayUntil cadence.
+#ifndef SYS_GRIND_CONTROL_EVENT_DRIVEN
+    #define SYS_GRIND_CONTROL_EVENT_DRIVEN 1                                   // Default: sample-driven, override with build flag
+#endif
+#define SYS_TASK_GRIND_CONTROL_FALLBACK_MS 100                                 // Longest wait for a sample outside motor-timing phases
+
+// UI frame governor: the UI task still wakes every SYS_TASK_UI_INTERVAL_MS to poll touch and drain
+// queued UI events, but UI logic and lv_timer_handler() only run at that rate while grinding,
+// autotuning, touching, animating or just after a screen change. Static screens run at the idle rate.
+// 0 = original fixed-rate UI loop.
+#ifndef SYS_UI_FRAME_GOVERNOR
+    #define SYS_UI_FRAME_GOVERNOR 1                                            // Default: adaptive rate, override with build flag
+#endif
+#define SYS_UI_IDLE_INTERVAL_MS 100                                            // UI update + LVGL interval on static screens (10Hz)
+#define SYS_UI_ACTIVE_HOLD_MS 1000                                             // Full rate kept after the last touch, event or screen change
+
 // Task Stack Sizes (bytes) - Increased for BLE_LOG overhead and complex operations
 #define SYS_TASK_WEIGHT_SAMPLING_STACK_SIZE 4096                               // 4KB stack for weight sampling (was 2KB, increased for BLE_LOG)
 #define SYS_TASK_GRIND_CONTROL_STACK_SIZE 6144                                 // 6KB stack for grind control logic (was 4KB, increased for complex algorithms)
 #define SYS_TASK_UI_STACK_SIZE 8192                                            // 8KB stack for LVGL rendering (unchanged)
 #define SYS_TASK_BLUETOOTH_STACK_SIZE 4096                                     // 4KB stack for BLE operations (unchanged)
 #define SYS_TASK_FILE_IO_STACK_SIZE 6144                                       // 6KB stack for LittleFS operations (was 4KB, increased for file operations)
+#define SYS_TASK_SESSION_COMMIT_STACK_SIZE 6144                                // 6KB stack for session file writes (same LittleFS paths as FileIO)
 
 // Task Priorities (higher number = higher priority)
 #define SYS_TASK_PRIORITY_WEIGHT_SAMPLING 4                                    // Highest priority (real-time sampling)
@@ -45,6 +65,9 @@
 // Raise BLE above UI to prevent starvation during transfers
 #define SYS_TASK_PRIORITY_BLUETOOTH 3                                          // Higher priority (BLE operations)
 #define SYS_TASK_PRIORITY_FILE_IO 1                                            // Low priority (file operations)
+// Session commits run below FileIO on Core 1, so a session start queued during a session
+// file write preempts the write instead of waiting for it to finish
+#define SYS_TASK_PRIORITY_SESSION_COMMIT 0                                     // Lowest priority (session file writes)
 
 // Inter-Task Communication Queue Sizes
 #define SYS_QUEUE_UI_TO_GRIND_SIZE 5                                           // UI events to grind controller
@@ -96,6 +119,19 @@
 #define SYS_ENABLE_REALTIME_HEARTBEAT 1                                            // Enable Core 0/Core 1 heartbeat logging (0=disabled, 1=enabled)
 #define SYS_REALTIME_HEARTBEAT_INTERVAL_MS 10000                                   // Heartbeat interval in milliseconds
 
+//------------------------------------------------------------------------------
+// TASK TRACE (src/system/task_trace.h)
+//------------------------------------------------------------------------------
+// Microsecond begin/end records of every task cycle and queue send, downloadable over BLE
+#ifndef SYS_TASK_TRACE
+    #ifdef NATIVE_BUILD
+        #define SYS_TASK_TRACE 0                                               // Host tools have no esp_timer or second core
+    #else
+        #define SYS_TASK_TRACE 1                                               // Default: enabled, override with build flag
+    #endif
+#endif
+#define SYS_TASK_TRACE_EVENTS_PER_CORE 4096                                    // Ring size per core, power of two (8 bytes each, PSRAM)
+
 //------------------------------------------------------------------------------
 // PRINTF FORMAT STRINGS
 //------------------------------------------------------------------------------
@@ -4,10 +4,6 @@
 #include <cstring>
 #include <cstdarg>
 
-#if defined(DEBUG_ENABLE_LOADCELL_MOCK) && (DEBUG_ENABLE_LOADCELL_MOCK != 0)
-#include "../hardware/mock_hx711_driver.h"
-#endif
-
 AutoTuneController::AutoTuneController()
     : weight_sensor(nullptr)
     , grinder(nullptr)
@@ -16,6 +12,7 @@ AutoTuneController::AutoTuneController()
     , sub_phase(AutoTuneSubPhase::IDLE)
     , is_running(false)
     , cancel_requested(false)
+    , search(static_cast<AutoTuneSearch>(GRIND_AUTOTUNE_SEARCH_DEFAULT))
     , current_pulse_ms(0.0f)
     , active_pulse_ms(0.0f)
     , last_executed_pulse_ms(0.0f)
@@ -40,6 +37,15 @@ AutoTuneController::AutoTuneController()
     memset(&progress, 0, sizeof(progress));
     progress.phase = AutoTunePhase::IDLE;
     progress.has_new_message = false;
+
+    LatencySearch::Config search_config = {};
+    search_config.min_ms = GRIND_AUTOTUNE_LATENCY_MIN_MS;
+    search_config.max_ms = GRIND_AUTOTUNE_LATENCY_MAX_MS;
+    search_config.target_success_rate = GRIND_AUTOTUNE_SUCCESS_RATE;
+    search_config.confidence = GRIND_AUTOTUNE_BAYES_CONFIDENCE;
+    search_config.accuracy_ms = GRIND_AUTOTUNE_TARGET_ACCURACY_MS;
+    search_config.lapse = GRIND_AUTOTUNE_BAYES_LAPSE;
+    latency_search.configure(search_config);
 }
 
 void AutoTuneController::init(WeightSensor* ws, Grinder* gr, GrindController* gc) {
@@ -84,6 +90,8 @@ bool AutoTuneController::start() {
     verification_success_count = 0;
     candidate_ms = 0.0f;
 
+    latency_search.reset();
+
     // Store previous latency for comparison
     progress.previous_latency_ms = grind_controller->get_motor_response_latency();
 
@@ -136,6 +144,10 @@ void AutoTuneController::update() {
             update_verification_phase();
             break;
 
+        case AutoTunePhase::ADAPTIVE_SEARCH:
+            update_adaptive_search_phase();
+            break;
+
         case AutoTunePhase::COMPLETE_SUCCESS:
         case AutoTunePhase::COMPLETE_FAILURE:
         case AutoTunePhase::IDLE:
@@ -475,6 +487,96 @@ void AutoTuneController::update_verification_phase() {
     }
 }
 
+void AutoTuneController::update_adaptive_search_phase() {
+    switch (sub_phase) {
+        case AutoTuneSubPhase::IDLE:
+            if (iteration >= GRIND_AUTOTUNE_BAYES_MAX_PULSES) {
+                LOG_BLE("AutoTune: Max pulses (%d) reached\n", GRIND_AUTOTUNE_BAYES_MAX_PULSES);
+                complete_with_failure("Max iterations reached");
+                return;
+            }
+
+            if (iteration == 0) {
+                log_message("\nAdaptive Search:");
+            }
+
+            // The posterior picks the pulse whose outcome narrows the latency the most
+            current_pulse_ms = latency_search.next_pulse_ms();
+            LOG_BLE("AutoTune Pulse %d: Testing %.1fms (latency %.1f-%.1fms, median %.1fms)\n",
+                    iteration, current_pulse_ms, latency_search.get_lower_ms(),
+                    latency_search.get_upper_ms(), latency_search.get_median_ms());
+            log_message("Test %.0fms", current_pulse_ms);
+
+            pre_pulse_weight = weight_sensor->get_weight_high_latency();
+            start_pulse(current_pulse_ms);
+            break;
+
+        case AutoTuneSubPhase::PULSE_EXECUTE:
+            update_pulse_execute();
+            break;
+
+        case AutoTuneSubPhase::MOTOR_SETTLING:
+            update_motor_settling();
+            break;
+
+        case AutoTuneSubPhase::COLLECTION_DELAY:
+            update_collection_delay();
+            break;
+
+        case AutoTuneSubPhase::SCALE_SETTLING:
+            update_scale_settling();
+            break;
+
+        case AutoTuneSubPhase::MEASURE_COMPLETE: {
+            float weight_delta = last_settled_weight - pre_pulse_weight;
+            bool pulse_produced_grounds = (weight_delta > GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G);
+
+            last_executed_pulse_ms = active_pulse_ms;
+            progress.last_pulse_success = pulse_produced_grounds;
+            latency_search.record(active_pulse_ms, pulse_produced_grounds);
+
+            log_message("  -> %.2fg %s", weight_delta,
+                       pulse_produced_grounds ? "[OK]" : "[X]");
+
+            switch_sub_phase(AutoTuneSubPhase::RESULT_LOGGED);
+            break;
+        }
+
+        case AutoTuneSubPhase::RESULT_LOGGED: {
+            iteration++;
+            step_size = latency_search.get_upper_ms() - latency_search.get_lower_ms();
+
+            if (latency_search.is_converged()) {
+                if (latency_search.get_success_count() == 0) {
+                    log_message("\nNo grounds\nCheck:");
+                    log_message("- Beans loaded");
+                    log_message("- Power on");
+                    log_message("- Cup placed");
+                    complete_with_failure("No successful pulse found");
+                    return;
+                }
+
+                // Upper end of the credible interval: the pulse reaches the success rate with confidence
+                candidate_ms = ceilf(latency_search.get_latency_ms());
+                LOG_BLE("AutoTune: Adaptive search converged after %d pulses - latency %.1f-%.1fms, using %.1fms\n",
+                        iteration, latency_search.get_lower_ms(), latency_search.get_upper_ms(), candidate_ms);
+                log_message("\nFound %.0fms", candidate_ms);
+                log_message("%d pulses", iteration);
+                log_message("\nComplete!");
+                complete_with_success(candidate_ms);
+                return;
+            }
+
+            update_progress();
+            switch_sub_phase(AutoTuneSubPhase::IDLE);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
 //==============================================================================
 // Sub-Phase Execution (Matches GrindController Pattern)
 //==============================================================================
@@ -484,13 +586,9 @@ void AutoTuneController::start_pulse(float pulse_duration_ms) {
 
     active_pulse_ms = pulse_duration_ms;
 
+    // Mock builds: Grinder passes the pulse on to the mock driver
     grinder->start_pulse_rmt(static_cast<uint32_t>(pulse_duration_ms));
 
-    // Notify mock driver for weight simulation
-#if defined(DEBUG_ENABLE_LOADCELL_MOCK) && (DEBUG_ENABLE_LOADCELL_MOCK != 0)
-    MockHX711Driver::notify_pulse(static_cast<uint32_t>(pulse_duration_ms));
-#endif
-
     switch_sub_phase(AutoTuneSubPhase::PULSE_EXECUTE);
 }
 
@@ -536,7 +634,8 @@ void AutoTuneController::update_scale_settling() {
         return;
     }
 
-    // Non-blocking settling check
+    // Non-blocking settling check. Fixed window only - the sequential detector's tolerance is
+    // coarser than the GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G this measurement resolves
     float settled_weight = 0.0f;
     if (weight_sensor->check_settling_complete(GRIND_SCALE_PRECISION_SETTLING_TIME_MS, &settled_weight)) {
         LOG_BLE("AutoTune: Scale settled at %.3fg\n", settled_weight);
@@ -562,10 +661,15 @@ void AutoTuneController::update_tare() {
         return;  // Still taring, return to main loop
     }
 
-    LOG_BLE("AutoTune: Tare complete, starting binary search\n");
     last_settled_weight = 0.0f;
     pre_pulse_weight = 0.0f;
-    switch_phase(AutoTunePhase::BINARY_SEARCH);
+    if (search == AutoTuneSearch::BAYESIAN) {
+        LOG_BLE("AutoTune: Tare complete, starting adaptive search\n");
+        switch_phase(AutoTunePhase::ADAPTIVE_SEARCH);
+    } else {
+        LOG_BLE("AutoTune: Tare complete, starting binary search\n");
+        switch_phase(AutoTunePhase::BINARY_SEARCH);
+    }
 }
 
 //==============================================================================
@@ -687,6 +791,7 @@ const char* AutoTuneController::get_phase_name(AutoTunePhase phase) const {
         case AutoTunePhase::PRIMING: return "PRIMING";
         case AutoTunePhase::BINARY_SEARCH: return "BINARY_SEARCH";
         case AutoTunePhase::VERIFICATION: return "VERIFICATION";
+        case AutoTunePhase::ADAPTIVE_SEARCH: return "ADAPTIVE_SEARCH";
         case AutoTunePhase::COMPLETE_SUCCESS: return "SUCCESS";
         case AutoTunePhase::COMPLETE_FAILURE: return "FAILURE";
         default: return "UNKNOWN";
@@ -4,6 +4,7 @@
 #include "../hardware/WeightSensor.h"
 #include "../hardware/grinder.h"
 #include "grind_controller.h"
+#include "latency_search.h"
 #include <LittleFS.h>
 
 // Auto-tune phases for UI display
@@ -12,10 +13,17 @@ enum class AutoTunePhase {
     PRIMING,                // Chute priming phase
     BINARY_SEARCH,          // Binary search phase
     VERIFICATION,           // Statistical verification phase
+    ADAPTIVE_SEARCH,        // Bayesian search (replaces binary search + verification)
     COMPLETE_SUCCESS,       // Successfully completed
     COMPLETE_FAILURE        // Failed to find reliable value
 };
 
+// Latency search algorithm (GRIND_AUTOTUNE_SEARCH_DEFAULT)
+enum class AutoTuneSearch {
+    BINARY = 0,             // Step-halving search, then 5-pulse verification rounds
+    BAYESIAN = 1            // LatencySearch posterior, stops at the target confidence
+};
+
 // Internal execution sub-phases (matches GrindController pattern)
 enum class AutoTuneSubPhase {
     IDLE,
@@ -63,6 +71,10 @@ private:
     AutoTuneSubPhase sub_phase;
     bool is_running;
     bool cancel_requested;
+    AutoTuneSearch search;
+
+    // Bayesian search state
+    LatencySearch latency_search;
 
     // Binary search state
     float current_pulse_ms;
@@ -105,6 +117,8 @@ public:
     bool start();  // Returns false if preconditions not met
     void cancel();
     void update(); // Call from main loop (non-blocking state machine)
+    void set_search(AutoTuneSearch new_search) { if (!is_running) search = new_search; }
+    AutoTuneSearch get_search() const { return search; }
 
     // Status methods
     bool is_active() const { return is_running; }
@@ -118,6 +132,7 @@ private:
     void update_priming_phase();
     void update_binary_search_phase();
     void update_verification_phase();
+    void update_adaptive_search_phase();
 
     // Sub-phase execution (matches GrindController pattern)
     void start_pulse(float pulse_duration_ms);
@@ -4,6 +4,7 @@
 #include "../config/constants.h"
 #include "../system/diagnostics_controller.h"
 #include "../system/statistics_manager.h"
+#include "../system/task_trace.h"
 #include <Arduino.h>
 #include <cstdarg>
 #include <cstring>
@@ -64,6 +65,14 @@ void GrindController::init(WeightSensor* lc, Grinder* gr, Preferences* prefs) {
         LOG_BLE("Warning: Grind logging disabled due to initialization failure\n");
     }
     
+    learned_model_store.init();
+
+    // Seed the learned stop model with the predictive stops of the sessions still on flash
+    uint32_t seeded_sessions = grind_logger.visit_recent_sessions(GRIND_STOP_PLANNER_HISTORY, seed_stop_planner_from_session, this);
+    LOG_BLE("Stop planner: %u stops recovered from %lu logged sessions\n",
+            model_stop_planner.get_history_count(), (unsigned long)seeded_sessions);
+    select_stop_planner();
+    
     // RealtimeController removed - functionality moved to FreeRTOS WeightSamplingTask and GrindControlTask
     
     // Initialize UI event system
@@ -125,9 +134,24 @@ void GrindController::start_grind(float target, uint32_t time_ms, GrindMode grin
         configured_amount = std::clamp(configured_amount, GRIND_PURGE_AMOUNT_MIN_G, GRIND_PURGE_AMOUNT_MAX_G);
         grinder_purge_amount_g_for_session = configured_amount;
     }
+    // Start from what this profile's previous grinds learned instead of the fixed defaults
+    learned_model_valid = learned_model_store.get(current_profile_id, &learned_model) && mode == GrindMode::WEIGHT;
+    if (!learned_model_valid) {
+        learned_model = LearnedGrindModel();
+    }
+    model_sample = {};
+    model_stop_planner.set_prior_coast_time_ms(learned_model_valid ? learned_model.coast_time_ms() : 0.0f);
+
+    select_stop_planner();
+    active_stop_planner->begin_session();
+    stop_flow_rate = 0.0f;
+    stop_reference_weight = 0.0f;
+    stop_observation_pending = false;
+    stop_imminent = false;
 
     start_time = millis();
     pulse_attempts = 0;
+    pulse_start_time = 0;
     timeout_phase = GrindPhase::IDLE; // Initialize timeout phase
     timeout_pause_start = 0;
     timeout_offset_ms = 0;
@@ -193,7 +217,8 @@ void GrindController::start_grind(float target, uint32_t time_ms, GrindMode grin
     GrindLoopData loop_data = {};
     loop_data.now = millis();
     loop_data.timestamp_ms = loop_data.now - start_time;
-    loop_data.current_weight = weight_sensor ? weight_sensor->get_weight_low_latency() : 0.0f;
+    loop_data.measured_weight = weight_sensor ? weight_sensor->get_weight_low_latency() : 0.0f;
+    loop_data.current_weight = loop_data.measured_weight;
 
     if (active_strategy) {
         active_strategy->on_enter(session_descriptor, strategy_context, loop_data);
@@ -230,6 +255,7 @@ void GrindController::stop_grind() {
     if (!grinder) return;
     
     grinder->stop();
+    if (weight_sensor) weight_sensor->set_motor_running(false);
     
     // Cancelled grinds just discard PSRAM data and go to IDLE
     grind_logger.discard_current_session();
@@ -272,7 +298,14 @@ void GrindController::continue_from_purge() {
         grinder->start();
     }
     time_grind_start_ms = millis();
-    switch_phase(GrindPhase::PREDICTIVE);  // No loop_data needed for phase transition
+
+    // Pass loop_data so the purge wait and the predictive run are logged as separate events
+    GrindLoopData loop_data = {};
+    loop_data.now = millis();
+    loop_data.timestamp_ms = loop_data.now - start_time;
+    loop_data.measured_weight = weight_sensor ? weight_sensor->get_weight_low_latency() : 0.0f;
+    loop_data.current_weight = loop_data.measured_weight;
+    switch_phase(GrindPhase::PREDICTIVE, loop_data);
 }
 
 void GrindController::update() {
@@ -284,18 +317,30 @@ void GrindController::update() {
     GrindLoopData loop_data = {};
     loop_data.now = now;
     loop_data.timestamp_ms = now - start_time;  // Relative to session start
-    loop_data.current_weight = weight_sensor ? weight_sensor->get_weight_low_latency() : 0.0f;
+    loop_data.measured_weight = weight_sensor ? weight_sensor->get_weight_low_latency() : 0.0f;
+    loop_data.current_weight = loop_data.measured_weight;
     loop_data.display_weight = weight_sensor ? weight_sensor->get_display_weight() : 0.0f;
     loop_data.motor_is_on = grinder ? (grinder->is_grinding() ? 1 : 0) : 0;
     loop_data.phase_id = get_current_phase_id();
     loop_data.flow_rate = weight_sensor ? weight_sensor->get_flow_rate() : 0.0f;
-    loop_data.weight_delta = loop_data.current_weight - last_logged_weight;
+    loop_data.weight_delta = loop_data.measured_weight - last_logged_weight;
+#if GRIND_WEIGHT_FLOW_ESTIMATOR
+    if (weight_sensor) {
+        // The estimate tracks the newest sample without the window's lag; the motor state picks its noise model
+        weight_sensor->set_motor_running(loop_data.motor_is_on != 0);
+        WeightFlowEstimator::Estimate estimate;
+        if (weight_sensor->get_weight_flow_estimate(&estimate)) {
+            loop_data.current_weight = estimate.weight;
+            loop_data.flow_rate = estimate.flow_rate;
+        }
+    }
+#endif
 
     if (control_loop_paused_) {
         emit_progress_update(loop_data);
 
         // Keep measurement baseline aligned for when logging resumes
-        last_logged_weight = loop_data.current_weight;
+        last_logged_weight = loop_data.measured_weight;
         last_logged_time = loop_data.now;
         return;
     }
@@ -443,7 +488,7 @@ void GrindController::update() {
 
         case GrindPhase::FINAL_SETTLING:
             // Wait for weight to settle with precision settling window
-            if (weight_sensor->check_settling_complete(GRIND_SCALE_PRECISION_SETTLING_TIME_MS)) {
+            if (weight_sensor->check_settling_complete(GRIND_SCALE_PRECISION_SETTLING_TIME_MS, nullptr, true)) {
                 final_measurement(loop_data);
             }
             break;
@@ -460,7 +505,8 @@ void GrindController::update() {
             break;
             
         case GrindPhase::COMPLETED:
-            if (grind_logger.is_logging_active() && !session_end_flash_queued) {
+            // Queued even with logging off - Core 1 also folds the session into the learned model
+            if (!session_end_flash_queued) {
                 float error = final_weight - target_weight;
                 if (mode == GrindMode::TIME) {
                     error = 0.0f;
@@ -487,6 +533,11 @@ void GrindController::update() {
                 strncpy(request.result_string, result_string, sizeof(request.result_string) - 1);
                 request.final_weight = final_weight;
                 request.pulse_count = pulse_attempts;
+                request.session_id = grind_logger.get_active_session_id();
+                request.descriptor = session_descriptor;
+                request.model_sample = model_sample;
+                request.model_sample.valid = (mode == GrindMode::WEIGHT);
+                request.model_sample.grind_latency_ms = grind_latency_ms;
                 queue_flash_operation(request);
                 
                 // Mark flash operation as queued to prevent repeated calls
@@ -502,6 +553,7 @@ void GrindController::update() {
                 strncpy(request.result_string, "TIMEOUT", sizeof(request.result_string) - 1);
                 request.final_weight = final_weight;
                 request.pulse_count = pulse_attempts;
+                request.session_id = grind_logger.get_active_session_id();
                 queue_flash_operation(request);
                 
                 // Mark flash operation as queued to prevent repeated calls
@@ -515,11 +567,11 @@ void GrindController::update() {
     
     // Unified continuous logging for ALL active phases at the control loop rate
     if (should_log_measurements()) {
-        grind_logger.log_continuous_measurement(loop_data.timestamp_ms, loop_data.current_weight, loop_data.weight_delta, 
+        grind_logger.log_continuous_measurement(loop_data.timestamp_ms, loop_data.measured_weight, loop_data.weight_delta, 
                                                loop_data.flow_rate, loop_data.motor_is_on, loop_data.phase_id, motor_stop_target_weight);
         
         // Update tracking variables for next measurement
-        last_logged_weight = loop_data.current_weight;
+        last_logged_weight = loop_data.measured_weight;
         last_logged_time = loop_data.now;
         force_measurement_log = false;
     }
@@ -633,7 +685,7 @@ void GrindController::switch_phase(GrindPhase new_phase, const GrindLoopData& lo
     // Finalize and log the event for the phase that just ENDED (only when we have loop_data)
     if (has_loop_data && grind_logger.is_logging_active() && phase != GrindPhase::IDLE) {
         event_in_progress.duration_ms = now - phase_start_time;
-        event_in_progress.end_weight = loop_data.current_weight;  // Use pre-calculated weight
+        event_in_progress.end_weight = loop_data.measured_weight;  // Use pre-calculated weight
         
         // Populate context-specific data for the completed event
         if (phase == GrindPhase::PREDICTIVE) {
@@ -681,7 +733,7 @@ void GrindController::switch_phase(GrindPhase new_phase, const GrindLoopData& lo
         memset(&event_in_progress, 0, sizeof(GrindEvent));
         event_in_progress.phase_id = (uint8_t)new_phase;
         event_in_progress.timestamp_ms = loop_data.timestamp_ms;  // Use pre-calculated timestamp for perfect alignment
-        event_in_progress.start_weight = loop_data.current_weight;  // Use pre-calculated weight
+        event_in_progress.start_weight = loop_data.measured_weight;  // Use pre-calculated weight
 
         if (session_descriptor.mode == GrindMode::TIME) {
             event_in_progress.event_flags |= GRIND_EVENT_FLAG_TIME_MODE;
@@ -707,8 +759,6 @@ void GrindController::switch_phase(GrindPhase new_phase, const GrindLoopData& lo
         }
     }
     
-    // pulse_start_time no longer needed for RMT-based pulses
-    
     // Emit UI event for phase change
     GrindEventData event_data = {};
     event_data.event = UIGrindEvent::PHASE_CHANGED;
@@ -778,6 +828,65 @@ bool GrindController::is_active() const {
     return phase != GrindPhase::IDLE;
 }
 
+void GrindController::select_stop_planner() {
+    int planner = preferences ? preferences->getInt(PREF_KEY_STOP_PLANNER, GRIND_STOP_PLANNER_DEFAULT)
+                              : GRIND_STOP_PLANNER_DEFAULT;
+    if (planner == static_cast<int>(StopPlannerType::COAST_RATIO)) {
+        active_stop_planner = &coast_ratio_stop_planner;
+    } else {
+        active_stop_planner = &model_stop_planner;
+    }
+}
+
+void GrindController::record_stop_observation(float settled_weight) {
+    if (!stop_observation_pending) return;
+    stop_observation_pending = false;
+
+    StopObservation observation;
+    observation.flow_rate = stop_flow_rate;
+    observation.coast_mass_g = settled_weight - stop_reference_weight;
+    observation.grind_latency_ms = grind_latency_ms;
+
+    model_sample.has_stop = true;
+    model_sample.flow_rate_gps = observation.flow_rate;
+    model_sample.coast_mass_g = observation.coast_mass_g;
+
+    // Only the model learns; the coast ratio planner is stateless
+    model_stop_planner.observe(observation);
+    queue_log_message("[STOP PLANNER] %s: coast %.3fg at %.2fg/s, model %.0fms +/-%.3fg (%u stops)\n",
+                      active_stop_planner->name(), observation.coast_mass_g, observation.flow_rate,
+                      model_stop_planner.get_coast_time_ms(grind_latency_ms),
+                      model_stop_planner.get_residual_sd_g(), model_stop_planner.get_history_count());
+}
+
+void GrindController::seed_stop_planner_from_session(const GrindSession&, const GrindEvent* events,
+                                                     uint16_t event_count, void* context) {
+    auto* controller = static_cast<GrindController*>(context);
+    StopObservation observation;
+    if (ModelStopPlanner::observation_from_events(events, event_count, &observation)) {
+        controller->model_stop_planner.observe(observation);
+    }
+}
+
+bool GrindController::needs_timed_updates() const {
+    // Phases whose next step depends on elapsed time or a UI/pulse handshake rather than new weight data
+    switch (phase) {
+        case GrindPhase::INITIALIZING:
+        case GrindPhase::SETUP:
+        case GrindPhase::TARING:
+        case GrindPhase::PRIME:
+        case GrindPhase::TIME_GRINDING:
+        case GrindPhase::PULSE_EXECUTE:
+        case GrindPhase::TIME_ADDITIONAL_PULSE:
+            return true;
+        case GrindPhase::PREDICTIVE:
+            // The stop point falls between samples; waiting for the next one would overshoot
+            return stop_imminent;
+        default:
+            return false;
+    }
+}
+
 int GrindController::get_progress_percent() const {
     if (active_strategy && session_descriptor.mode == GrindMode::TIME) {
         return active_strategy->progress_percent(session_descriptor, *this);
@@ -854,6 +963,7 @@ void GrindController::emit_ui_event(const GrindEventData& data) {
     // Thread-safe Core 0 → Core 1 UI event emission using FreeRTOS queue
     if (ui_event_queue) {
         BaseType_t result = xQueueSend(ui_event_queue, &data, 0); // 0 = no wait (non-blocking)
+        TRACE_QUEUE_SEND(TRACE_ID_QUEUE_UI_EVENT, ui_event_queue, result);
         
         if (result != pdPASS) {
             // Queue full - drop event to prevent Core 0 blocking
@@ -912,21 +1022,25 @@ bool GrindController::should_log_measurements() const {
         && phase != GrindPhase::PURGE_CONFIRM;  // Don't log while waiting for user to confirm purge
 }
 
-void GrindController::process_queued_ui_events() {
+bool GrindController::process_queued_ui_events() {
     GrindEventData event;
+    bool handled = false;
     
     // Process all queued events from Core 0
     while (xQueueReceive(ui_event_queue, &event, 0) == pdPASS) {
         if (ui_event_callback) {
             ui_event_callback(event); // Safe - runs on Core 1
         }
+        handled = true;
     }
+    return handled;
 }
 
 void GrindController::queue_flash_operation(const FlashOpRequest& request) {
     // Thread-safe Core 0 → Core 1 flash operation queuing
     if (flash_op_queue) {
         BaseType_t result = xQueueSend(flash_op_queue, &request, 0); // 0 = no wait (non-blocking)
+        TRACE_QUEUE_SEND(TRACE_ID_QUEUE_FLASH_OP, flash_op_queue, result);
         
         if (result != pdPASS) {
             // Queue full - this shouldn't happen with reasonable queue size
@@ -958,7 +1072,11 @@ void GrindController::process_queued_flash_operations() {
                 // Perform the blocking flash operation on Core 1
                 LOG_BLE("[%lums FLASH_OP] Processing END_GRIND_SESSION on Core 1: %s, %.2fg, %d pulses\n", 
                         millis(), request.result_string, request.final_weight, request.pulse_count);
-                grind_logger.end_grind_session(request.result_string, request.final_weight, request.pulse_count);
+                // Only finalizes the PSRAM slot; the session commit task writes it to flash
+                if (request.session_id != 0) {
+                    grind_logger.end_grind_session(request.result_string, request.final_weight, request.pulse_count, request.session_id);
+                }
+                learned_model_store.update(request.descriptor.profile_id, request.model_sample);
                 break;
                 
             default:
@@ -983,6 +1101,7 @@ void GrindController::queue_log_message(const char* format, ...) {
         log_msg.message[sizeof(log_msg.message) - 1] = '\0';
         
         BaseType_t result = xQueueSend(log_queue, &log_msg, 0); // 0 = no wait (non-blocking)
+        TRACE_QUEUE_SEND(TRACE_ID_QUEUE_LOG, log_queue, result);
         
         if (result != pdPASS) {
             // Queue full - silently drop the message to avoid blocking Core 0
@@ -8,6 +8,8 @@
 #include "grind_strategy.h"
 #include "weight_grind_strategy.h"
 #include "time_grind_strategy.h"
+#include "stop_planner.h"
+#include "learned_grind_model.h"
 #include <Preferences.h>
 #include <LittleFS.h>
 #include <freertos/FreeRTOS.h>
@@ -32,6 +34,8 @@ struct FlashOpRequest {
     float start_weight;      // For START_GRIND_SESSION (pre-tare snapshot)
     float final_weight;      // For END_GRIND_SESSION
     uint8_t pulse_count;     // For END_GRIND_SESSION
+    uint32_t session_id;     // For END_GRIND_SESSION (logged session to end, 0 when not logging)
+    GrindModelSample model_sample; // For END_GRIND_SESSION (folded into descriptor.profile_id's model)
 };
 
 // Log message structure for Core 0 → Core 1 communication
@@ -41,7 +45,8 @@ struct LogMessage {
 
 // Calculated values for a single update cycle - passed to methods to avoid redundant calculations
 struct GrindLoopData {
-    float current_weight;       // For control logic (low_latency)
+    float current_weight;       // For control logic (Kalman estimate, or low_latency without GRIND_WEIGHT_FLOW_ESTIMATOR)
+    float measured_weight;      // low_latency window - logged measurements and events stay comparable across builds
     float display_weight;       // For UI display (always calculated)
     uint32_t timestamp_ms;
     float weight_delta;
@@ -166,6 +171,22 @@ private:
     WeightGrindStrategy weight_strategy;
     TimeGrindStrategy time_strategy;
 
+    // Motor stop planning for the predictive phase; the model learns from every stop
+    IStopPlanner* active_stop_planner = nullptr;
+    CoastRatioStopPlanner coast_ratio_stop_planner;
+    ModelStopPlanner model_stop_planner;
+    float stop_flow_rate = 0.0f;               // Planner flow rate at the predictive stop
+    float stop_reference_weight = 0.0f;        // Newest sample extrapolated to the stop command
+    bool stop_observation_pending = false;     // Waiting for the first settled weight after the stop
+    bool stop_imminent = false;                // Stop expected before the next sample - keep timed updates
+    uint32_t predictive_stop_count = 0;        // Predictive motor stops since boot
+
+    // Per-profile learned model: read at start_grind, updated from model_sample on Core 1 at session end
+    LearnedGrindModelStore learned_model_store;
+    LearnedGrindModel learned_model;
+    bool learned_model_valid = false;
+    GrindModelSample model_sample = {};
+
     // Mechanical instability tracking
     int mechanical_anomaly_count_ = 0;
     unsigned long last_mechanical_event_ms_ = 0;
@@ -208,7 +229,7 @@ public:
     void set_ui_event_callback(void (*callback)(const GrindEventData&));
     GrindSessionResult get_last_session_result() const { return last_session_result_; }
     void ui_acknowledge_phase_transition(); // Called by UI to confirm phase transition
-    void process_queued_ui_events(); // Core 1: Process events from Core 0 queue
+    bool process_queued_ui_events(); // Core 1: Process events from Core 0 queue, true if any were handled
     QueueHandle_t get_ui_event_queue() const { return ui_event_queue; }
     
     // Flash operation system
@@ -220,12 +241,14 @@ public:
     void queue_log_message(const char* format, ...); // Core 0: Queue formatted log message
     
     bool is_active() const;
+    bool needs_timed_updates() const; // Motor-timing phases that must not wait for the next sample
     bool is_control_loop_paused() const { return control_loop_paused_; }
     float get_target_weight() const { return target_weight; }
     uint32_t get_target_time_ms() const { return target_time_ms; }
     static constexpr const char* PREF_KEY_PRIME_ENABLED = "prime_enabled";
     static constexpr const char* PREF_KEY_GRINDER_MODE = "grinder_mode";
     static constexpr const char* PREF_KEY_GRINDER_AMOUNT_G = "grinder_amount_g";
+    static constexpr const char* PREF_KEY_STOP_PLANNER = "stop_planner";
     GrindMode get_mode() const { return mode; }
     const GrindSessionDescriptor& get_session_descriptor() const { return session_descriptor; }
     
@@ -252,6 +275,14 @@ public:
     float get_max_pulse_duration() const { return motor_response_latency_ms + GRIND_MOTOR_MAX_PULSE_DURATION_MS; }
     void load_motor_latency();
     void save_motor_latency(float value);
+
+    // Motor stop planner
+    uint32_t get_predictive_stop_count() const { return predictive_stop_count; }
+    const char* get_stop_planner_name() const { return active_stop_planner ? active_stop_planner->name() : "none"; }
+    const ModelStopPlanner& get_model_stop_planner() const { return model_stop_planner; }
+    bool get_learned_model(uint8_t profile_id, LearnedGrindModel* model_out) const {
+        return learned_model_store.get(profile_id, model_out);
+    }
     
     // Removed - predictive logic now inline in update_realtime()
     
@@ -260,6 +291,10 @@ private:
     void switch_phase(GrindPhase new_phase, const GrindLoopData& loop_data = {});
     void final_measurement(const GrindLoopData& loop_data);
     void monitor_mechanical_instability(const GrindLoopData& loop_data);
+    void select_stop_planner();
+    void record_stop_observation(float settled_weight);
+    static void seed_stop_planner_from_session(const GrindSession& session, const GrindEvent* events,
+                                               uint16_t event_count, void* context);
 
     bool check_timeout() const;
     uint8_t get_current_phase_id() const;
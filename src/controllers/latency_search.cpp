@@ -0,0 +1,184 @@
+#include "latency_search.h"
+#include <math.h>
+
+// Pulse-to-pulse jitter of the motor start, from a clean relay/RMT start to a sluggish motor
+const float LatencySearch::SPREADS_MS[LatencySearch::SPREAD_COUNT] = {1.0f, 3.0f, 6.0f, 12.0f};
+
+LatencySearch::LatencySearch() {
+    Config defaults = {};
+    defaults.min_ms = 30.0f;
+    defaults.max_ms = 300.0f;
+    defaults.target_success_rate = 0.8f;
+    defaults.confidence = 0.8f;
+    defaults.accuracy_ms = 5.0f;
+    defaults.lapse = 0.02f;
+    configure(defaults);
+}
+
+void LatencySearch::configure(const Config& new_config) {
+    config = new_config;
+    if (config.max_ms < config.min_ms + 1.0f) config.max_ms = config.min_ms + 1.0f;
+
+    // Whole-millisecond grid so the offsets between pulses and thresholds stay integral
+    float range_ms = config.max_ms - config.min_ms;
+    grid_step_ms = ceilf(range_ms / (MAX_GRID_POINTS - 1));
+    if (grid_step_ms < 1.0f) grid_step_ms = 1.0f;
+    grid_count = (uint16_t)(range_ms / grid_step_ms) + 1;
+
+    target_z = inverse_normal_cdf(config.target_success_rate);
+
+    for (uint8_t s = 0; s < SPREAD_COUNT; s++) {
+        for (int offset = -TABLE_HALF_WIDTH; offset <= TABLE_HALF_WIDTH; offset++) {
+            success_table[s][offset + TABLE_HALF_WIDTH] =
+                config.lapse + (1.0f - 2.0f * config.lapse) * normal_cdf(offset * grid_step_ms / SPREADS_MS[s]);
+        }
+    }
+    reset();
+}
+
+void LatencySearch::reset() {
+    float uniform = 1.0f / (SPREAD_COUNT * grid_count);
+    for (uint8_t s = 0; s < SPREAD_COUNT; s++) {
+        for (uint16_t i = 0; i < grid_count; i++) {
+            posterior[s][i] = uniform;
+        }
+    }
+    pulse_count = 0;
+    success_count = 0;
+    update_interval();
+    choose_next_pulse();
+}
+
+float LatencySearch::success_probability(uint8_t spread, int offset) const {
+    if (offset < -TABLE_HALF_WIDTH) return config.lapse;
+    if (offset > TABLE_HALF_WIDTH) return 1.0f - config.lapse;
+    return success_table[spread][offset + TABLE_HALF_WIDTH];
+}
+
+void LatencySearch::record(float pulse_ms, bool produced_grounds) {
+    int pulse_index = (int)lroundf((pulse_ms - config.min_ms) / grid_step_ms);
+
+    float total = 0.0f;
+    for (uint8_t s = 0; s < SPREAD_COUNT; s++) {
+        for (uint16_t i = 0; i < grid_count; i++) {
+            float p = success_probability(s, pulse_index - i);
+            posterior[s][i] *= produced_grounds ? p : 1.0f - p;
+            total += posterior[s][i];
+        }
+    }
+    if (total > 0.0f) {
+        for (uint8_t s = 0; s < SPREAD_COUNT; s++) {
+            for (uint16_t i = 0; i < grid_count; i++) {
+                posterior[s][i] /= total;
+            }
+        }
+    }
+
+    pulse_count++;
+    if (produced_grounds) success_count++;
+    update_interval();
+    choose_next_pulse();
+}
+
+void LatencySearch::choose_next_pulse() {
+    // Pick the pulse whose outcome is expected to leave the smallest posterior variance of the
+    // latency itself - threshold and spread only matter through it. Ties go to the shorter pulse.
+    float shifts_ms[SPREAD_COUNT];
+    for (uint8_t s = 0; s < SPREAD_COUNT; s++) {
+        shifts_ms[s] = SPREADS_MS[s] * target_z;
+    }
+
+    float best_variance = INFINITY;
+    uint16_t best_index = 0;
+    for (uint16_t candidate = 0; candidate < grid_count; candidate++) {
+        // Posterior mass, mean and second moment of the latency after grounds / no grounds,
+        // relative to min_ms and unnormalised
+        float mass[2] = {0.0f, 0.0f};
+        float sum[2] = {0.0f, 0.0f};
+        float sum_squares[2] = {0.0f, 0.0f};
+        for (uint8_t s = 0; s < SPREAD_COUNT; s++) {
+            for (uint16_t i = 0; i < grid_count; i++) {
+                float weight = posterior[s][i];
+                float latency = i * grid_step_ms + shifts_ms[s];
+                float success = weight * success_probability(s, candidate - i);
+                float failure = weight - success;
+                mass[1] += success;
+                sum[1] += success * latency;
+                sum_squares[1] += success * latency * latency;
+                mass[0] += failure;
+                sum[0] += failure * latency;
+                sum_squares[0] += failure * latency * latency;
+            }
+        }
+        float expected_variance = 0.0f;
+        for (int outcome = 0; outcome < 2; outcome++) {
+            if (mass[outcome] <= 0.0f) continue;
+            float mean = sum[outcome] / mass[outcome];
+            expected_variance += sum_squares[outcome] - mass[outcome] * mean * mean;
+        }
+        if (expected_variance < best_variance - 1e-6f) {
+            best_variance = expected_variance;
+            best_index = candidate;
+        }
+    }
+    next_pulse = config.min_ms + best_index * grid_step_ms;
+}
+
+void LatencySearch::update_interval() {
+    // Posterior of the latency = threshold + spread * target_z, walked in threshold grid steps
+    int shifts[SPREAD_COUNT];
+    for (uint8_t s = 0; s < SPREAD_COUNT; s++) {
+        int shift = (int)lroundf(SPREADS_MS[s] * target_z / grid_step_ms);
+        if (shift < -MAX_LATENCY_SHIFT) shift = -MAX_LATENCY_SHIFT;
+        if (shift > MAX_LATENCY_SHIFT) shift = MAX_LATENCY_SHIFT;
+        shifts[s] = shift;
+    }
+
+    float tail = 0.5f - 0.5f * config.confidence;
+    float quantiles[3] = {tail, 0.5f, 1.0f - tail};
+    float values[3];
+    uint8_t next = 0;
+    float cumulative = 0.0f;
+    int last_bin = grid_count - 1 + MAX_LATENCY_SHIFT;
+    for (int bin = -MAX_LATENCY_SHIFT; bin <= last_bin && next < 3; bin++) {
+        for (uint8_t s = 0; s < SPREAD_COUNT; s++) {
+            int i = bin - shifts[s];
+            if (i >= 0 && i < grid_count) cumulative += posterior[s][i];
+        }
+        while (next < 3 && cumulative >= quantiles[next]) {
+            values[next++] = config.min_ms + bin * grid_step_ms;
+        }
+    }
+    while (next < 3) {
+        values[next++] = config.min_ms + last_bin * grid_step_ms;
+    }
+    lower_ms = values[0];
+    median_ms = values[1];
+    upper_ms = values[2];
+}
+
+bool LatencySearch::is_converged() const {
+    return pulse_count > 0 && upper_ms - lower_ms <= 2.0f * config.accuracy_ms;
+}
+
+float LatencySearch::get_latency_ms() const {
+    if (upper_ms < config.min_ms) return config.min_ms;
+    if (upper_ms > config.max_ms) return config.max_ms;
+    return upper_ms;
+}
+
+float LatencySearch::normal_cdf(float z) {
+    return 0.5f * erfcf(-z * 0.70710678f);
+}
+
+float LatencySearch::inverse_normal_cdf(float p) {
+    // Bisection - configure() is not on a hot path
+    float low = -8.0f;
+    float high = 8.0f;
+    for (int i = 0; i < 50; i++) {
+        float mid = 0.5f * (low + high);
+        if (normal_cdf(mid) < p) low = mid;
+        else high = mid;
+    }
+    return 0.5f * (low + high);
+}
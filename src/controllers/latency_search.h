@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * LatencySearch - Bayesian search for the shortest pulse that reliably produces grounds
+ *
+ * Every test pulse either produces grounds or it does not. The chance that a pulse of
+ * d ms does is modelled as a probit dose-response curve
+ *
+ *     P(grounds | d) = lapse + (1 - 2 * lapse) * Phi((d - threshold) / spread)
+ *
+ * with the threshold and the spread (pulse-to-pulse jitter of the motor start) unknown.
+ * The posterior over both is kept on a grid - the threshold every grid step between
+ * min_ms and max_ms, SPREAD_COUNT spreads - and updated exactly after every pulse.
+ *
+ * The latency is the pulse that produces grounds with target_success_rate, the criterion
+ * the verification rounds of the binary search test: threshold + spread * z(target_success_rate).
+ * next_pulse_ms() is the grid pulse whose outcome is expected to leave the smallest posterior
+ * variance of that latency, and the search has converged once the central `confidence`
+ * credible interval of the latency is no wider than 2 * accuracy_ms. The lapse rate
+ * covers misread pulses (noise at the detection threshold, grounds that drop late), so a
+ * single one moves the posterior instead of ruling out the true threshold.
+ */
+class LatencySearch {
+public:
+    struct Config {
+        float min_ms;                 // Pulse range searched, also the threshold prior (uniform)
+        float max_ms;
+        float target_success_rate;    // Success rate the reported latency must reach
+        float confidence;             // Credible interval mass used for convergence
+        float accuracy_ms;            // Converged once that interval is within +/- accuracy_ms
+        float lapse;                  // Chance that a pulse is misread, either way
+    };
+
+    LatencySearch();
+
+    void configure(const Config& config);
+    void reset();
+
+    // Folds in the outcome of a pulse and picks the next one
+    void record(float pulse_ms, bool produced_grounds);
+
+    float next_pulse_ms() const { return next_pulse; }
+    bool is_converged() const;
+    int get_pulse_count() const { return pulse_count; }
+    int get_success_count() const { return success_count; }
+
+    // Latency credible interval; get_latency_ms() is its upper end within the search range
+    float get_latency_ms() const;
+    float get_median_ms() const { return median_ms; }
+    float get_lower_ms() const { return lower_ms; }
+    float get_upper_ms() const { return upper_ms; }
+
+private:
+    static const uint16_t MAX_GRID_POINTS = 272;    // 1ms steps over the default 30-300ms range
+    static const uint8_t SPREAD_COUNT = 4;
+    static const float SPREADS_MS[SPREAD_COUNT];
+    static const int16_t TABLE_HALF_WIDTH = 96;     // Pulse - threshold offsets (grid steps) tabulated
+    static const int16_t MAX_LATENCY_SHIFT = 64;    // Largest spread * target z offset (grid steps)
+
+    Config config;
+    float grid_step_ms;
+    uint16_t grid_count;
+    float target_z;
+
+    // Posterior over [spread][threshold index], normalised
+    float posterior[SPREAD_COUNT][MAX_GRID_POINTS];
+
+    // P(grounds) by spread and pulse - threshold offset in grid steps;
+    // offsets beyond the table are saturated at lapse / 1 - lapse
+    float success_table[SPREAD_COUNT][2 * TABLE_HALF_WIDTH + 1];
+
+    float next_pulse;
+    int pulse_count;
+    int success_count;
+    float median_ms;
+    float lower_ms;
+    float upper_ms;
+
+    float success_probability(uint8_t spread, int offset) const;
+    void choose_next_pulse();
+    void update_interval();
+
+    static float normal_cdf(float z);
+    static float inverse_normal_cdf(float p);
+};
@@ -0,0 +1,150 @@
+#include "learned_grind_model.h"
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "../config/logging.h"
+
+namespace {
+class ModelLockGuard {
+public:
+    explicit ModelLockGuard(SemaphoreHandle_t mutex) : mutex_(mutex) {
+        if (mutex_) {
+            xSemaphoreTake(mutex_, portMAX_DELAY);
+        }
+    }
+
+    ~ModelLockGuard() {
+        if (mutex_) {
+            xSemaphoreGive(mutex_);
+        }
+    }
+
+private:
+    SemaphoreHandle_t mutex_;
+};
+
+constexpr const char* kNamespace = "grindmodel";
+
+void make_key(uint8_t profile_id, char* key, size_t key_size) {
+    snprintf(key, key_size, "p%u", (unsigned)profile_id);
+}
+
+float smooth(float current, float sample, uint32_t count) {
+    return count == 0 ? sample : current + GRIND_MODEL_ALPHA * (sample - current);
+}
+
+bool in_range(float value, float min_value, float max_value) {
+    return value >= min_value && value <= max_value;
+}
+
+// Returns true if the sample changed the model
+bool fold_sample(LearnedGrindModel& model, const GrindModelSample& sample) {
+    bool changed = false;
+
+    if (sample.has_stop &&
+        in_range(sample.grind_latency_ms, 0.0f, GRIND_MODEL_MAX_LATENCY_MS) &&
+        in_range(sample.flow_rate_gps, GRIND_FLOW_RATE_MIN_SANE_GPS, GRIND_FLOW_RATE_MAX_SANE_GPS) &&
+        in_range(sample.coast_mass_g, 0.0f, GRIND_MODEL_MAX_COAST_G)) {
+        model.grind_latency_ms = smooth(model.grind_latency_ms, sample.grind_latency_ms, model.session_count);
+        model.flow_rate_gps = smooth(model.flow_rate_gps, sample.flow_rate_gps, model.session_count);
+        model.coast_mass_g = smooth(model.coast_mass_g, sample.coast_mass_g, model.session_count);
+        model.session_count++;
+        changed = true;
+    }
+
+    if (sample.pulse_count > 0 && sample.pulse_productive_ms > 0.0f) {
+        float gain_gps = sample.pulse_mass_g / sample.pulse_productive_ms * SYS_MS_PER_SECOND;
+        if (in_range(gain_gps, GRIND_FLOW_RATE_MIN_SANE_GPS, GRIND_FLOW_RATE_MAX_SANE_GPS)) {
+            model.pulse_gain_gps = smooth(model.pulse_gain_gps, gain_gps, model.pulse_count);
+            model.pulse_count += sample.pulse_count;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+} // namespace
+
+void LearnedGrindModelStore::init() {
+    if (!mutex_) {
+        mutex_ = xSemaphoreCreateMutexStatic(&mutex_buffer_);
+    }
+
+    ModelLockGuard lock(mutex_);
+    Preferences model_prefs;
+    model_prefs.begin(kNamespace, true);
+    for (uint8_t i = 0; i < USER_PROFILE_COUNT; i++) {
+        load_locked(model_prefs, i);
+    }
+    model_prefs.end();
+}
+
+void LearnedGrindModelStore::load_locked(Preferences& model_prefs, uint8_t profile_id) {
+    char key[8];
+    make_key(profile_id, key, sizeof(key));
+
+    LearnedGrindModel stored;
+    if (model_prefs.getBytesLength(key) == sizeof(LearnedGrindModel)) {
+        model_prefs.getBytes(key, &stored, sizeof(LearnedGrindModel));
+    }
+
+    // Anything out of range (older layout, corrupted flash) starts the profile over
+    bool sane = stored.version == LearnedGrindModel::kVersion &&
+                in_range(stored.grind_latency_ms, 0.0f, GRIND_MODEL_MAX_LATENCY_MS) &&
+                in_range(stored.flow_rate_gps, 0.0f, GRIND_FLOW_RATE_MAX_SANE_GPS) &&
+                in_range(stored.coast_mass_g, 0.0f, GRIND_MODEL_MAX_COAST_G) &&
+                in_range(stored.pulse_gain_gps, 0.0f, GRIND_FLOW_RATE_MAX_SANE_GPS);
+    models_[profile_id] = sane ? stored : LearnedGrindModel();
+
+    if (models_[profile_id].session_count > 0) {
+        LOG_BLE("Grind model P%u: %lu sessions, latency %.0fms, flow %.2fg/s, coast %.3fg, pulse gain %.2fg/s\n",
+                (unsigned)profile_id, (unsigned long)models_[profile_id].session_count,
+                models_[profile_id].grind_latency_ms, models_[profile_id].flow_rate_gps,
+                models_[profile_id].coast_mass_g, models_[profile_id].pulse_gain_gps);
+    }
+}
+
+bool LearnedGrindModelStore::get(uint8_t profile_id, LearnedGrindModel* model_out) const {
+    if (profile_id >= USER_PROFILE_COUNT) {
+        *model_out = LearnedGrindModel();
+        return false;
+    }
+
+    ModelLockGuard lock(mutex_);
+    *model_out = models_[profile_id];
+    return model_out->is_valid();
+}
+
+void LearnedGrindModelStore::update(uint8_t profile_id, const GrindModelSample& sample) {
+    if (!sample.valid || profile_id >= USER_PROFILE_COUNT) {
+        return;
+    }
+
+    // Fold in under the lock, write to flash after releasing it - start_grind() waits on the lock.
+    // Only the file I/O task updates models, so writes cannot overtake each other.
+    LearnedGrindModel updated;
+    {
+        ModelLockGuard lock(mutex_);
+        if (!fold_sample(models_[profile_id], sample)) {
+            return; // Nothing usable in this session - flash already holds the model
+        }
+        updated = models_[profile_id];
+    }
+
+    persist(profile_id, updated);
+}
+
+void LearnedGrindModelStore::persist(uint8_t profile_id, const LearnedGrindModel& model) {
+    char key[8];
+    make_key(profile_id, key, sizeof(key));
+
+    Preferences model_prefs;
+    model_prefs.begin(kNamespace, false);
+    size_t written = model_prefs.putBytes(key, &model, sizeof(LearnedGrindModel));
+    model_prefs.end();
+
+    if (written != sizeof(LearnedGrindModel)) {
+        LOG_BLE("ERROR: Failed to save grind model for profile %u\n", (unsigned)profile_id);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <Preferences.h>
+#include <cstdint>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "../config/constants.h"
+
+// Persistent per-profile grinder behaviour, smoothed over completed weight-mode sessions
+struct LearnedGrindModel {
+    static constexpr uint32_t kVersion = 1;
+
+    uint32_t version = kVersion;
+    uint32_t session_count = 0;       // Sessions folded into the smoothed values below
+    float grind_latency_ms = 0.0f;    // Motor start to first grounds
+    float flow_rate_gps = 0.0f;       // Steady-state flow at the predictive stop
+    float coast_mass_g = 0.0f;        // Grounds that arrived after the predictive stop
+    uint32_t pulse_count = 0;         // Pulses folded into pulse_gain_gps
+    float pulse_gain_gps = 0.0f;      // Grams per second of pulse time beyond the motor latency
+
+    bool is_valid() const { return session_count >= GRIND_MODEL_MIN_SESSIONS; }
+    bool has_pulse_gain() const { return pulse_count >= GRIND_MODEL_MIN_PULSES; }
+    float coast_time_ms() const {
+        return flow_rate_gps > 0.0f ? coast_mass_g / flow_rate_gps * SYS_MS_PER_SECOND : 0.0f;
+    }
+};
+
+// What one completed session measured - gathered on Core 0, folded in on Core 1
+struct GrindModelSample {
+    bool valid;                       // Weight-mode session that reached COMPLETED
+    bool has_stop;                    // Predictive stop observed (flow + coast below)
+    float grind_latency_ms;
+    float flow_rate_gps;
+    float coast_mass_g;
+    uint8_t pulse_count;
+    float pulse_mass_g;               // Settled weight gained over all pulses
+    float pulse_productive_ms;        // Pulse time beyond the motor latency, summed
+};
+
+// Learned models for every profile (Preferences namespace: "grindmodel", key per profile)
+class LearnedGrindModelStore {
+public:
+    void init();
+
+    // Copy of the profile's model; false (and a default model) if it has not learned enough yet
+    bool get(uint8_t profile_id, LearnedGrindModel* model_out) const;
+
+    // Folds a session into the profile's model and persists it if it changed. Blocking flash
+    // write, made after releasing the model lock - Core 1 only.
+    void update(uint8_t profile_id, const GrindModelSample& sample);
+
+private:
+    void load_locked(Preferences& model_prefs, uint8_t profile_id);
+    void persist(uint8_t profile_id, const LearnedGrindModel& model);
+
+    LearnedGrindModel models_[USER_PROFILE_COUNT];
+
+    // Guards models_ - created by init(), get() runs on Core 0 while update() runs on Core 1
+    StaticSemaphore_t mutex_buffer_;
+    SemaphoreHandle_t mutex_ = nullptr;
+};
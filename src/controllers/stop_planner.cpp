@@ -0,0 +1,179 @@
+#include "stop_planner.h"
+
+#include "grind_controller.h"
+#include "../logging/grind_logging.h"
+#include <Arduino.h>
+#include <math.h>
+
+//==============================================================================
+// COAST RATIO PLANNER
+//==============================================================================
+
+float CoastRatioStopPlanner::plan(const StopPlannerInput& input) {
+    last_flow_rate = input.flow_rate;
+    return ((input.grind_latency_ms * GRIND_LATENCY_TO_COAST_RATIO) / (float)SYS_MS_PER_SECOND) * input.flow_rate;
+}
+
+//==============================================================================
+// MODEL PLANNER
+//==============================================================================
+
+ModelStopPlanner::ModelStopPlanner() {
+    history_count = 0;
+    history_next = 0;
+    prior_coast_time_ms = 0.0f;
+    median_coast_time_ms = 0.0f;
+    residual_sd_g = GRIND_ACCURACY_TOLERANCE_G;
+    begin_session();
+}
+
+void ModelStopPlanner::begin_session() {
+    flow_level = 0.0f;
+    flow_trend_gps2 = 0.0f;
+    last_flow_time = 0;
+    flow_initialized = false;
+    last_flow_rate = 0.0f;
+}
+
+float ModelStopPlanner::plan(const StopPlannerInput& input) {
+    if (!input.flow_measured) {
+        // Learned estimate - nothing to smooth or trend yet
+        last_flow_rate = input.flow_rate;
+    } else if (!flow_initialized) {
+        flow_level = input.flow_rate;
+        flow_trend_gps2 = 0.0f;
+        last_flow_time = input.now;
+        flow_initialized = true;
+    } else if (input.now > last_flow_time) {
+        float dt_s = (input.now - last_flow_time) / (float)SYS_MS_PER_SECOND;
+        float predicted_level = flow_level + flow_trend_gps2 * dt_s;
+        float new_level = GRIND_STOP_PLANNER_FLOW_ALPHA * input.flow_rate +
+                          (1.0f - GRIND_STOP_PLANNER_FLOW_ALPHA) * predicted_level;
+        flow_trend_gps2 = GRIND_STOP_PLANNER_TREND_BETA * (new_level - flow_level) / dt_s +
+                          (1.0f - GRIND_STOP_PLANNER_TREND_BETA) * flow_trend_gps2;
+        flow_level = new_level;
+        last_flow_time = input.now;
+    }
+
+    // The windowed rate describes the middle of its window; project it to now while the grinder ramps
+    if (input.flow_measured) {
+        float max_projection = input.flow_rate * GRIND_STOP_PLANNER_MAX_TREND_PROJECTION;
+        float projection = flow_trend_gps2 * (GRIND_STOP_PLANNER_FLOW_WINDOW_MS / 2.0f) / (float)SYS_MS_PER_SECOND;
+        projection = min(max(projection, -max_projection), max_projection);
+        last_flow_rate = input.flow_rate + projection;
+    }
+
+    float in_flight_g = last_flow_rate * get_coast_time_ms(input.grind_latency_ms) / (float)SYS_MS_PER_SECOND;
+
+    // The next chance to stop is one control tick later: stop once waiting for it would land further from
+    // the aim than stopping now, i.e. half a tick's worth of flow before the aim is reached
+    float decision_lead_g = last_flow_rate * (SYS_TASK_GRIND_CONTROL_INTERVAL_MS / 2.0f) / (float)SYS_MS_PER_SECOND;
+
+    // Aim below target by the model uncertainty; pulses can add grounds but never remove them
+    float margin_g = max(GRIND_ACCURACY_TOLERANCE_G / 2.0f, GRIND_STOP_PLANNER_AIM_SIGMA * residual_sd_g);
+
+    // Stop once the newest sample, extrapolated to now, reaches the aim. Returned relative to the
+    // smoothed control weight the caller compares against.
+    float projected_weight = input.latest_sample_weight + last_flow_rate * input.sample_age_ms / (float)SYS_MS_PER_SECOND;
+    return in_flight_g + margin_g + decision_lead_g + (projected_weight - input.current_weight);
+}
+
+void ModelStopPlanner::observe(const StopObservation& observation) {
+    if (observation.flow_rate < GRIND_FLOW_RATE_MIN_SANE_GPS || observation.flow_rate > GRIND_FLOW_RATE_MAX_SANE_GPS) {
+        return;
+    }
+    float coast_time_ms = coast_time_of(observation);
+    if (coast_time_ms < 0.0f || coast_time_ms > GRIND_STOP_PLANNER_MAX_COAST_MS) {
+        return; // Cup bumped or removed - not a coast
+    }
+
+    history[history_next] = observation;
+    history_next = (history_next + 1) % GRIND_STOP_PLANNER_HISTORY;
+    if (history_count < GRIND_STOP_PLANNER_HISTORY) {
+        history_count++;
+    }
+    refit();
+}
+
+float ModelStopPlanner::get_coast_time_ms(float grind_latency_ms) const {
+    float prior_ms = prior_coast_time_ms > 0.0f ? prior_coast_time_ms : grind_latency_ms * GRIND_LATENCY_TO_COAST_RATIO;
+    if (history_count >= GRIND_STOP_PLANNER_MIN_HISTORY) {
+        return median_coast_time_ms;
+    }
+
+    // Too few stops to trust on their own - count the coast-ratio estimate as one more observation
+    float sum_ms = prior_ms;
+    for (uint8_t i = 0; i < history_count; i++) {
+        sum_ms += coast_time_of(history[i]);
+    }
+    return sum_ms / (history_count + 1);
+}
+
+float ModelStopPlanner::coast_time_of(const StopObservation& observation) {
+    return observation.coast_mass_g / observation.flow_rate * SYS_MS_PER_SECOND;
+}
+
+void ModelStopPlanner::refit() {
+    if (history_count < GRIND_STOP_PLANNER_MIN_HISTORY) {
+        residual_sd_g = GRIND_ACCURACY_TOLERANCE_G;
+        return;
+    }
+
+    float coast_times_ms[GRIND_STOP_PLANNER_HISTORY];
+    for (uint8_t i = 0; i < history_count; i++) {
+        coast_times_ms[i] = coast_time_of(history[i]);
+    }
+    // Insertion sort - at most GRIND_STOP_PLANNER_HISTORY entries
+    for (uint8_t i = 1; i < history_count; i++) {
+        float value = coast_times_ms[i];
+        int j = i - 1;
+        while (j >= 0 && coast_times_ms[j] > value) {
+            coast_times_ms[j + 1] = coast_times_ms[j];
+            j--;
+        }
+        coast_times_ms[j + 1] = value;
+    }
+    uint8_t mid = history_count / 2;
+    median_coast_time_ms = (history_count % 2) ? coast_times_ms[mid]
+                                               : 0.5f * (coast_times_ms[mid - 1] + coast_times_ms[mid]);
+
+    float sum_squares = 0.0f;
+    for (uint8_t i = 0; i < history_count; i++) {
+        float residual_g = history[i].coast_mass_g - history[i].flow_rate * median_coast_time_ms / SYS_MS_PER_SECOND;
+        sum_squares += residual_g * residual_g;
+    }
+    residual_sd_g = sqrtf(sum_squares / history_count);
+}
+
+bool ModelStopPlanner::observation_from_events(const GrindEvent* events, uint16_t event_count,
+                                               StopObservation* observation_out) {
+    for (uint16_t i = 0; i < event_count; i++) {
+        const GrindEvent& predictive = events[i];
+        if (predictive.phase_id != (uint8_t)GrindPhase::PREDICTIVE ||
+            (predictive.event_flags & GRIND_EVENT_FLAG_TIME_MODE)) {
+            continue;
+        }
+
+        // Flow is not logged per event; use the mean rate after the first grounds arrived
+        float flowing_ms = (float)predictive.duration_ms - (float)predictive.grind_latency_ms;
+        if (flowing_ms < GRIND_STOP_PLANNER_FLOW_WINDOW_MS) {
+            return false;
+        }
+        float flow_rate = (predictive.end_weight - predictive.start_weight) * SYS_MS_PER_SECOND / flowing_ms;
+
+        // The settling phase that follows ends on the first settled weight after the stop
+        for (uint16_t j = i + 1; j < event_count; j++) {
+            if (events[j].phase_id == (uint8_t)GrindPhase::PULSE_SETTLING) {
+                // end_weight is the smoothed control weight, which trails the scale by about half a
+                // sample interval while grounds are flowing
+                float trailing_g = flow_rate * (HW_LOADCELL_SAMPLE_INTERVAL_MS / 2.0f) / (float)SYS_MS_PER_SECOND;
+                observation_out->flow_rate = flow_rate;
+                observation_out->coast_mass_g = events[j].end_weight - (predictive.end_weight + trailing_g);
+                observation_out->grind_latency_ms = predictive.grind_latency_ms;
+                return true;
+            }
+        }
+        return false;
+    }
+    return false;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <stdint.h>
+#include "../config/constants.h"
+
+struct GrindEvent;
+
+// Selectable motor-stop planners (preference GrindController::PREF_KEY_STOP_PLANNER)
+enum class StopPlannerType {
+    COAST_RATIO = 0,   // motor_stop_target_weight = latency * GRIND_LATENCY_TO_COAST_RATIO * flow
+    MODEL = 1          // Learned coast time, flow trend and decision timing
+};
+
+// Predictive phase state handed to the planner on every control update once flow is measured
+struct StopPlannerInput {
+    unsigned long now;
+    float current_weight;       // Control weight the stop decision compares against
+    float latest_sample_weight; // Newest single sample
+    float target_weight;
+    float flow_rate;          // g/s over the predictive flow window
+    float grind_latency_ms;   // Motor start to first grounds for this session
+    float sample_age_ms;      // Time since the newest sample
+    bool flow_measured;       // false while flow_rate is the learned estimate, before the flow window fills
+};
+
+// One predictive stop: flow when the motor was stopped and what arrived afterwards
+struct StopObservation {
+    float flow_rate;          // g/s at the stop decision
+    float coast_mass_g;       // Settled weight minus the weight on the scale at the stop command
+    float grind_latency_ms;
+};
+
+class IStopPlanner {
+public:
+    virtual ~IStopPlanner() = default;
+
+    virtual void begin_session() = 0;
+
+    // Returns the motor stop target weight: grams still expected on the scale after a
+    // stop issued now. The motor stops once current_weight >= target - this value.
+    virtual float plan(const StopPlannerInput& input) = 0;
+
+    // Flow rate the last plan() was based on - recorded with the stop so observations match the model
+    virtual float get_planned_flow_rate() const = 0;
+
+    // True if plan() extrapolates between samples, so re-planning without new data can move the stop
+    virtual bool plans_between_samples() const = 0;
+
+    // Result of a completed predictive stop (live or recovered from a logged session)
+    virtual void observe(const StopObservation& observation) = 0;
+
+    virtual const char* name() const = 0;
+};
+
+// Original heuristic: coast time proportional to the measured start latency
+class CoastRatioStopPlanner : public IStopPlanner {
+public:
+    void begin_session() override { last_flow_rate = 0.0f; }
+    float plan(const StopPlannerInput& input) override;
+    float get_planned_flow_rate() const override { return last_flow_rate; }
+    bool plans_between_samples() const override { return false; }
+    void observe(const StopObservation&) override {}
+    const char* name() const override { return "CoastRatio"; }
+
+private:
+    float last_flow_rate = 0.0f;
+};
+
+/**
+ * ModelStopPlanner - online in-flight mass model
+ *
+ * Everything that lands after the stop command (grounds in flight, grinder spin-down,
+ * scale filter lag) is modeled as flow * coast_time + noise. coast_time is the median
+ * of the last GRIND_STOP_PLANNER_HISTORY observed stops, shrunk towards the profile's
+ * learned coast (or the coast-ratio estimate) while there are fewer than
+ * GRIND_STOP_PLANNER_MIN_HISTORY. The spread of the model residuals sets how far below
+ * target the planner aims.
+ *
+ * Within a session a smoothed flow trend projects the windowed flow rate (which lags a
+ * ramping grinder) to the present, and the newest sample is extrapolated by its age so
+ * the stop can fall between samples. Coast times are measured from the weight on the
+ * scale at the stop command, not from the sample it was based on.
+ */
+class ModelStopPlanner : public IStopPlanner {
+public:
+    ModelStopPlanner();
+
+    void begin_session() override;
+    float plan(const StopPlannerInput& input) override;
+    float get_planned_flow_rate() const override { return last_flow_rate; }
+    bool plans_between_samples() const override { return true; }
+    void observe(const StopObservation& observation) override;
+    const char* name() const override { return "Model"; }
+
+    // Coast time to assume while the history is short (0 = coast ratio estimate)
+    void set_prior_coast_time_ms(float coast_time_ms) { prior_coast_time_ms = coast_time_ms; }
+
+    uint8_t get_history_count() const { return history_count; }
+    float get_coast_time_ms(float grind_latency_ms) const;
+    float get_residual_sd_g() const { return residual_sd_g; }
+
+    // Recovers the predictive stop of a logged weight-mode session, false if it has none
+    static bool observation_from_events(const GrindEvent* events, uint16_t event_count,
+                                        StopObservation* observation_out);
+
+private:
+    void refit();
+    static float coast_time_of(const StopObservation& observation);
+
+    StopObservation history[GRIND_STOP_PLANNER_HISTORY];
+    uint8_t history_count;
+    uint8_t history_next;
+
+    // Fitted from history
+    float prior_coast_time_ms;
+    float median_coast_time_ms;
+    float residual_sd_g;
+
+    // Per-session flow trend (Holt smoothing of the windowed flow rate)
+    float flow_level;
+    float flow_trend_gps2;
+    unsigned long last_flow_time;
+    bool flow_initialized;
+    float last_flow_rate;
+};
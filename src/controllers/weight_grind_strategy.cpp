@@ -48,7 +48,9 @@ int WeightGrindStrategy::progress_percent(const GrindSessionDescriptor&,
 }
 
 float WeightGrindStrategy::get_clamped_pulse_flow_rate(const GrindController& controller) const {
-    float flow_rate = controller.pulse_flow_rate;
+    // What past pulses actually delivered beats the flow rate measured at the predictive stop
+    float flow_rate = controller.learned_model.has_pulse_gain() ? controller.learned_model.pulse_gain_gps
+                                                                : controller.pulse_flow_rate;
 
     if (flow_rate < GRIND_FLOW_RATE_MIN_SANE_GPS) {
         flow_rate = GRIND_PULSE_FLOW_RATE_FALLBACK_GPS;
@@ -78,6 +80,22 @@ float WeightGrindStrategy::calculate_pulse_duration_ms(const GrindController& co
     return final_duration;
 }
 
+float WeightGrindStrategy::get_sample_age_ms(const GrindController& controller, unsigned long now) const {
+    uint32_t sample_time = controller.weight_sensor->get_latest_sample_time_ms();
+    return (sample_time && now > sample_time) ? (float)(now - sample_time) : 0.0f;
+}
+
+// Weight at the newest sample - the planner extrapolates it by the sample age
+float WeightGrindStrategy::get_newest_sample_weight(const GrindController& controller) const {
+#if GRIND_WEIGHT_FLOW_ESTIMATOR
+    WeightFlowEstimator::Estimate estimate;
+    if (controller.weight_sensor->get_weight_flow_estimate(&estimate)) {
+        return estimate.weight;
+    }
+#endif
+    return controller.weight_sensor->get_instant_weight();
+}
+
 void WeightGrindStrategy::run_predictive_phase(GrindController& controller,
                                                const GrindLoopData& loop_data) const {
     if (!controller.weight_sensor) {
@@ -96,23 +114,56 @@ void WeightGrindStrategy::run_predictive_phase(GrindController& controller,
         }
     }
 
+    // Plan from the measured flow once its window has filled; until then from the profile's learned model
+    float planning_flow_rate = 0.0f;
+    bool flow_measured = false;
     if (controller.flow_start_confirmed) {
-        const uint32_t flow_rate_calc_window_ms = 1500;
+        const uint32_t flow_rate_calc_window_ms = GRIND_STOP_PLANNER_FLOW_WINDOW_MS;
         if (loop_data.now > (controller.phase_start_time + controller.grind_latency_ms + flow_rate_calc_window_ms)) {
             float current_flow_rate = controller.weight_sensor->get_flow_rate(flow_rate_calc_window_ms);
 
             if (current_flow_rate > GRIND_FLOW_DETECTION_THRESHOLD_GPS) {
-                controller.motor_stop_target_weight = ((controller.grind_latency_ms * GRIND_LATENCY_TO_COAST_RATIO) /
-                                                       (float)SYS_MS_PER_SECOND) * current_flow_rate;
+                planning_flow_rate = current_flow_rate;
+                flow_measured = true;
             }
         }
     }
+    if (!flow_measured && controller.learned_model_valid) {
+        planning_flow_rate = controller.learned_model.flow_rate_gps;
+    }
+
+    if (planning_flow_rate > 0.0f) {
+        StopPlannerInput input;
+        input.now = loop_data.now;
+        input.current_weight = loop_data.current_weight;
+        input.latest_sample_weight = get_newest_sample_weight(controller);
+        input.sample_age_ms = get_sample_age_ms(controller, loop_data.now);
+        input.target_weight = controller.target_weight;
+        input.flow_rate = planning_flow_rate;
+        input.grind_latency_ms = controller.flow_start_confirmed ? controller.grind_latency_ms
+                                                                 : controller.learned_model.grind_latency_ms;
+        input.flow_measured = flow_measured;
+        controller.motor_stop_target_weight = controller.active_stop_planner->plan(input);
+
+        if (controller.active_stop_planner->plans_between_samples()) {
+            float next_sample_weight = loop_data.current_weight + controller.active_stop_planner->get_planned_flow_rate() *
+                                       HW_LOADCELL_SAMPLE_INTERVAL_MS / (float)SYS_MS_PER_SECOND;
+            controller.stop_imminent = next_sample_weight >= (controller.target_weight - controller.motor_stop_target_weight);
+        }
+    }
 
     // Only allow motor stop decision after motor has settled to avoid startup transients
     if (controller.grinder->is_motor_settled() &&
         loop_data.current_weight >= (controller.target_weight - controller.motor_stop_target_weight)) {
         controller.grinder->stop();
+        controller.predictive_stop_count++;
         controller.predictive_end_weight = loop_data.current_weight;
+        controller.stop_flow_rate = controller.active_stop_planner->get_planned_flow_rate();
+        controller.stop_reference_weight = get_newest_sample_weight(controller) +
+                                           controller.stop_flow_rate * get_sample_age_ms(controller, loop_data.now) /
+                                           (float)SYS_MS_PER_SECOND;
+        controller.stop_observation_pending = controller.stop_flow_rate > 0.0f;
+        controller.stop_imminent = false;
         controller.pulse_flow_rate = controller.weight_sensor->get_flow_rate_95th_percentile(2500);
         controller.switch_phase(GrindPhase::PULSE_SETTLING, loop_data);
     }
@@ -125,10 +176,26 @@ void WeightGrindStrategy::run_pulse_decision_phase(GrindController& controller,
     }
 
     float settled_weight;
-    if (!controller.weight_sensor->check_settling_complete(GRIND_SCALE_PRECISION_SETTLING_TIME_MS, &settled_weight)) {
+    if (!controller.weight_sensor->check_settling_complete(GRIND_SCALE_PRECISION_SETTLING_TIME_MS, &settled_weight, true)) {
         return;
     }
 
+    // First settled weight after the predictive stop closes the planner's observation
+    controller.record_stop_observation(settled_weight);
+
+    // Settled weight after a pulse closes that pulse for the learned pulse gain. Short pulses
+    // deliver less than their length suggests (spin-up), so only longer ones measure the gain.
+    if (controller.pulse_attempts > 0) {
+        PulseReport& pulse = controller.pulse_history[controller.pulse_attempts - 1];
+        pulse.end_weight = settled_weight;
+        float productive_ms = pulse.duration_ms - controller.get_motor_response_latency();
+        if (productive_ms >= GRIND_MODEL_MIN_PULSE_TIME_MS) {
+            controller.model_sample.pulse_count++;
+            controller.model_sample.pulse_mass_g += pulse.end_weight - pulse.start_weight;
+            controller.model_sample.pulse_productive_ms += productive_ms;
+        }
+    }
+
     float conservative_target = controller.target_weight - GRIND_ACCURACY_TOLERANCE_G;
     float error = conservative_target - settled_weight;
 
@@ -148,6 +215,7 @@ void WeightGrindStrategy::run_pulse_decision_phase(GrindController& controller,
 
     controller.switch_phase(GrindPhase::PULSE_EXECUTE, loop_data);
     controller.grinder->start_pulse_rmt(static_cast<uint32_t>(controller.current_pulse_duration_ms));
+    controller.pulse_start_time = loop_data.now;
 
     controller.pulse_attempts++;
 }
@@ -165,8 +233,27 @@ void WeightGrindStrategy::run_pulse_settling_phase(GrindController& controller,
         return;
     }
 
+    // Grounds keep landing for up to the grind latency after the stop. Once they have been
+    // seen arriving and came to rest, the sequential detector ends the wait early; otherwise
+    // wait out latency + settling window. After the predictive stop the rise must follow the
+    // motor vibration window, as grounds were landing all along. A pulse's grounds often land
+    // before the pulse completes, so any rise after its motor response latency counts - but
+    // the round cannot end before the grind latency has passed since the pulse started, or a
+    // lump or the chute draining followed by a few quiet samples would pass for settled.
+    uint32_t rise_after_ms = controller.phase_start_time + GRIND_MOTOR_SETTLING_TIME_MS;
+    uint32_t settle_after_ms = controller.phase_start_time;
+    if (controller.pulse_attempts > 0) {
+        rise_after_ms = controller.pulse_start_time + (uint32_t)controller.get_motor_response_latency();
+        settle_after_ms = controller.pulse_start_time + (uint32_t)controller.grind_latency_ms;
+    }
+    if ((int32_t)(loop_data.now - settle_after_ms) >= 0 &&
+        controller.weight_sensor->check_settled_after_rise(rise_after_ms)) {
+        controller.switch_phase(GrindPhase::PULSE_DECISION, loop_data);
+        return;
+    }
+
     if (loop_data.now - controller.phase_start_time >= controller.grind_latency_ms + GRIND_MOTOR_SETTLING_TIME_MS) {
-        if (controller.weight_sensor->check_settling_complete(GRIND_MOTOR_SETTLING_TIME_MS)) {
+        if (controller.weight_sensor->check_settling_complete(GRIND_MOTOR_SETTLING_TIME_MS, nullptr, true)) {
             controller.switch_phase(GrindPhase::PULSE_DECISION, loop_data);
         }
     }
@@ -25,6 +25,8 @@ public:
 private:
     float get_clamped_pulse_flow_rate(const GrindController& controller) const;
     float calculate_pulse_duration_ms(const GrindController& controller, float error_grams) const;
+    float get_sample_age_ms(const GrindController& controller, unsigned long now) const;
+    float get_newest_sample_weight(const GrindController& controller) const;
     void run_predictive_phase(GrindController& controller, const GrindLoopData& loop_data) const;
     void run_pulse_decision_phase(GrindController& controller, const GrindLoopData& loop_data) const;
     void run_pulse_execute_phase(GrindController& controller, const GrindLoopData& loop_data) const;
@@ -32,7 +32,34 @@ WeightSensor::WeightSensor() {
     current_weight = 0.0;
     current_temperature = NAN;
     current_raw_adc = 0;
+    last_sample_timestamp_us = 0;
     last_update = 0;
+    snapshot_sequence = 0;
+    activity_min_raw = 0;
+    activity_max_raw = 0;
+    last_activity_ms = 0;
+    
+    SettlingDetector::Config settling_config = {};
+    settling_config.tolerance = GRIND_SETTLE_TOLERANCE_G;
+    settling_config.false_settle_probability = GRIND_SETTLE_FALSE_SETTLE_PROBABILITY;
+    settling_config.min_samples = GRIND_SETTLE_MIN_SAMPLES;
+    settling_config.noise_initial = GRIND_SETTLE_NOISE_INITIAL_G;
+    settling_config.noise_min = GRIND_SETTLE_NOISE_MIN_G;
+    settling_config.cusum_slack = GRIND_SETTLE_CUSUM_SLACK;
+    settling_config.cusum_threshold = GRIND_SETTLE_CUSUM_THRESHOLD;
+    settling_detector.configure(settling_config);
+    
+    WeightFlowEstimator::Config estimator_config = {};
+    estimator_config.idle_noise = GRIND_ESTIMATOR_IDLE_NOISE_G;
+    estimator_config.motor_noise = GRIND_ESTIMATOR_MOTOR_NOISE_G;
+    estimator_config.flowing_q = GRIND_ESTIMATOR_FLOWING_Q;
+    estimator_config.idle_q = GRIND_ESTIMATOR_IDLE_Q;
+    estimator_config.coast_window_ms = GRIND_ESTIMATOR_COAST_WINDOW_MS;
+    estimator_config.idle_flow_decay_ms = GRIND_ESTIMATOR_IDLE_FLOW_DECAY_MS;
+    estimator_config.reset_sigma = GRIND_ESTIMATOR_RESET_SIGMA;
+    weight_flow_estimator.configure(estimator_config);
+    motor_running_ = false;
+    
     data_available = false;
     prefs = nullptr;
     hardware_fault_ = HardwareFault::NONE;
@@ -147,6 +174,10 @@ bool WeightSensor::update_async() {
     return adc_driver ? adc_driver->update_async() : false;
 }
 
+bool WeightSensor::set_data_ready_task(TaskHandle_t task) {
+    return adc_driver ? adc_driver->set_data_ready_task(task) : false;
+}
+
 // conversion_24bit() method removed - now handled by ADC driver
 
 void WeightSensor::power_down() {
@@ -413,19 +444,18 @@ float WeightSensor::get_weight_low_latency() const {
     return raw_to_weight(raw_filter.get_raw_low_latency());
 }
 
-float WeightSensor::get_display_weight() {
-    float weight = raw_to_weight(raw_filter.get_display_raw());
-    // Clamp tiny values around zero to prevent -0.0g display
-    if (weight > -0.05f && weight < 0.05f) {
-        weight = 0.0f;
-    }
-    return weight;
+float WeightSensor::get_display_weight() const {
+    return snapshot_publisher.read().display_weight;
 }
 
 float WeightSensor::get_weight_high_latency() const {
     return raw_to_weight(raw_filter.get_raw_high_latency());
 }
 
+uint32_t WeightSensor::get_latest_sample_time_ms() const {
+    return raw_filter.get_latest_timestamp_ms();
+}
+
 bool WeightSensor::get_weight_delta(uint32_t window_ms, float* delta_out,
                                     int* sample_count_out, uint32_t* span_ms_out) const {
     if (!delta_out) {
@@ -495,6 +525,15 @@ float WeightSensor::get_flow_rate(uint32_t window_ms) const {
     return raw_flow / cal_factor;  // Convert raw units per second to grams per second
 }
 
+bool WeightSensor::get_weight_flow_estimate(WeightFlowEstimator::Estimate* estimate_out) const {
+    WeightFlowEstimator::Estimate estimate = snapshot_publisher.read().estimate;
+    if (estimate.timestamp_ms == 0) {
+        return false;
+    }
+    *estimate_out = estimate;
+    return true;
+}
+
 float WeightSensor::get_flow_rate_95th_percentile(uint32_t window_ms) const {
     float raw_flow = raw_filter.get_raw_flow_rate_95th_percentile(window_ms);
     return raw_flow / cal_factor;  // Convert raw units per second to grams per second
@@ -641,7 +680,22 @@ void WeightSensor::set_calibrated(bool calibrated) {
 }
 
 // Non-blocking settling check with window_ms parameter
-bool WeightSensor::check_settling_complete(uint32_t window_ms, float* settled_weight_out) {
+bool WeightSensor::check_settling_complete(uint32_t window_ms, float* settled_weight_out, bool allow_sequential) {
+#if GRIND_SEQUENTIAL_SETTLING
+    // The change-point detector usually settles before the fixed window has filled
+    if (allow_sequential) {
+        SettlingEstimate settling = snapshot_publisher.read().settling;
+        if (settling.settled) {
+            if (settled_weight_out) {
+                *settled_weight_out = settling.value;
+            }
+            LOG_SETTLING_DEBUG("[DEBUG %lums] SETTLING_COMPLETE: Sequential settle (%.3fg, confidence=%.3f, %u samples, drift=%.4fg)\n",
+                          millis(), settling.value, settling.confidence, settling.samples, settling.drift);
+            return true;
+        }
+    }
+#endif
+    
     // Check if data has settled based on gram values
     if (is_settled(window_ms)) {
         if (settled_weight_out) {
@@ -656,6 +710,25 @@ bool WeightSensor::check_settling_complete(uint32_t window_ms, float* settled_we
     return false; // Still settling
 }
 
+bool WeightSensor::check_settled_after_rise(uint32_t rise_after_ms, float* settled_weight_out) {
+#if GRIND_SEQUENTIAL_SETTLING
+    SettlingEstimate settling = snapshot_publisher.read().settling;
+    if (settling.settled && settling.last_rise_ms != 0 &&
+        (int32_t)(settling.last_rise_ms - rise_after_ms) >= 0 &&
+        (int32_t)(settling.segment_start_ms - settling.last_rise_ms) >= 0) {
+        if (settled_weight_out) {
+            *settled_weight_out = settling.value;
+        }
+        LOG_SETTLING_DEBUG("[DEBUG %lums] SETTLING_COMPLETE: Settled after rise at %lums (%.3fg, confidence=%.3f)\n",
+                      millis(), (unsigned long)settling.last_rise_ms, settling.value, settling.confidence);
+        return true;
+    }
+#endif
+    (void)rise_after_ms;
+    (void)settled_weight_out;
+    return false;
+}
+
 void WeightSensor::cancel_settling() {
     // Settling cancellation no longer needed with direct window_ms approach
     LOG_SETTLING_DEBUG("[DEBUG %lums] SETTLING_CANCEL: Settling cancelled\n", millis());
@@ -667,7 +740,7 @@ void WeightSensor::cancel_settling() {
 
 bool WeightSensor::noise_level_diagnostic() const {
     // Check noise level using same threshold and window as grind control settling
-    float std_dev_g = get_standard_deviation_g(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
+    float std_dev_g = snapshot_publisher.read().std_dev_g;
     bool currently_settled = std_dev_g < GRIND_SCALE_SETTLING_TOLERANCE_G;
     
     unsigned long now = millis();
@@ -712,7 +785,11 @@ bool WeightSensor::sample_and_feed_filter() {
     if (data_waiting_async()) {
         update_async();
         int32_t raw_adc = get_raw_adc_data();  // Get raw ADC data from driver
-        uint32_t timestamp = millis();
+        
+        // Prefer the driver's conversion time over the time we got around to reading it.
+        // millis() is esp_timer time / 1000, so both share one clock.
+        uint64_t sample_time_us = adc_driver->get_sample_timestamp_us();
+        uint32_t timestamp = sample_time_us ? (uint32_t)(sample_time_us / 1000ULL) : millis();
         
         // Raw ADC validation (24-bit range - valid for all supported ADCs)
         if (raw_adc >= 0 && raw_adc <= 0xFFFFFF) {  // Valid 24-bit range
@@ -727,6 +804,7 @@ bool WeightSensor::sample_and_feed_filter() {
                     // Use CircularBufferMath smoothed data instead of original smoothedData()
                     int32_t smoothed_raw = raw_filter.get_smoothed_raw(250); // 250ms window for stability
                     tare_offset = smoothed_raw;  // Set tare offset to smoothed raw ADC value
+                    weight_flow_estimator.reset();  // Weights before the tare are on the old zero
                     tareTimes = 0;
                     doTare = 0;
                     tareStatus = 1;
@@ -735,11 +813,14 @@ bool WeightSensor::sample_and_feed_filter() {
             
             // Update instance variables atomically (ESP32 guarantees atomic 32-bit writes)
             current_raw_adc = raw_adc;
+            last_sample_timestamp_us = sample_time_us;
             current_weight = raw_to_weight(raw_adc);  // Convert using WeightSensor calibration
             
             // Update temperature if available
             update_temperature_if_available();
             
+            publish_snapshot(raw_adc, timestamp);
+            
             data_available = true;
             
             return true; // Successfully processed new sample
@@ -757,6 +838,55 @@ bool WeightSensor::sample_and_feed_filter() {
     return false; // No new data available
 }
 
+void WeightSensor::publish_snapshot(int32_t raw_adc, uint32_t timestamp_ms) {
+    WeightSnapshot snapshot = {};
+    snapshot.sequence = ++snapshot_sequence;
+    snapshot.sample_time_ms = timestamp_ms;
+    snapshot.raw_instant = raw_adc;
+    snapshot.sample_count = raw_filter.get_sample_count();
+    snapshot.buffer_span_ms = raw_filter.get_buffer_time_span_ms();
+    
+    snapshot.instant_weight = raw_to_weight(raw_adc);
+    snapshot.low_latency_weight = get_weight_low_latency();
+    snapshot.high_latency_weight = get_weight_high_latency();
+    
+    // The display filter keeps state, so it only advances here - once per sample
+    float display_weight = raw_to_weight(raw_filter.get_display_raw());
+    // Clamp tiny values around zero to prevent -0.0g display
+    if (display_weight > -0.05f && display_weight < 0.05f) {
+        display_weight = 0.0f;
+    }
+    snapshot.display_weight = display_weight;
+    
+    snapshot.flow_rate = get_flow_rate();
+    snapshot.std_dev_raw = raw_filter.get_standard_deviation_raw(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
+    snapshot.std_dev_g = snapshot.std_dev_raw / fabsf(cal_factor);
+    snapshot.settled = is_settled();
+    
+    // Weight activity: the raw range since the last activity reaching the threshold starts a new
+    // one, so readers check a timestamp instead of scanning minutes of samples for min/max
+    if (snapshot.sequence == 1 || raw_adc < activity_min_raw) activity_min_raw = raw_adc;
+    if (snapshot.sequence == 1 || raw_adc > activity_max_raw) activity_max_raw = raw_adc;
+    if (activity_max_raw - activity_min_raw >= weight_to_raw_threshold(USER_WEIGHT_ACTIVITY_THRESHOLD_G)) {
+        last_activity_ms = timestamp_ms;
+        activity_min_raw = raw_adc;
+        activity_max_raw = raw_adc;
+    }
+    snapshot.last_activity_ms = last_activity_ms;
+    
+    settling_detector.add_sample(snapshot.instant_weight, timestamp_ms);
+    snapshot.settling = settling_detector.estimate();
+    
+    weight_flow_estimator.set_motor_running(motor_running_.load(std::memory_order_relaxed), timestamp_ms);
+    weight_flow_estimator.add_sample(snapshot.instant_weight, timestamp_ms);
+    snapshot.estimate = weight_flow_estimator.estimate();
+    
+    snapshot.rise_valid = get_weight_delta(USER_AUTO_GRIND_TRIGGER_SETTLING_MS + USER_AUTO_GRIND_TRIGGER_WINDOW_MS,
+                                           &snapshot.rise_delta_g, &snapshot.rise_samples, &snapshot.rise_span_ms);
+    
+    snapshot_publisher.publish(snapshot);
+}
+
 float WeightSensor::get_saved_calibration_factor() {
     // Return saved calibration factor from preferences, or default if none
     if (prefs && prefs->isKey("hx_cal")) {
@@ -3,6 +3,7 @@
 #include "circular_buffer_math/circular_buffer_math.h"
 #include "load_cell_driver.h"
 #include "hx711_driver.h"
+#include "weight_snapshot.h"
 #include "../config/constants.h"
 #include <Preferences.h>
 #include <freertos/FreeRTOS.h>
@@ -45,6 +46,16 @@ private:
     // CircularBufferMath for advanced filtering and analysis
     CircularBufferMath raw_filter;
     
+    // Derived values published after every sample for readers on other tasks
+    WeightSnapshotPublisher snapshot_publisher;
+    uint32_t snapshot_sequence;
+    int32_t activity_min_raw;        // Raw range since the last weight activity
+    int32_t activity_max_raw;
+    uint32_t last_activity_ms;
+    SettlingDetector settling_detector;   // Fed with every sample, result published in the snapshot
+    WeightFlowEstimator weight_flow_estimator;   // Fed with every sample, result published in the snapshot
+    std::atomic<bool> motor_running_;   // Set by grind control, read by the sampling task
+    
     // Calibration parameters
     float cal_factor;
     int32_t tare_offset;
@@ -53,6 +64,7 @@ private:
     float current_weight;
     float current_temperature;  // For ADCs with temperature sensors
     int32_t current_raw_adc;
+    uint64_t last_sample_timestamp_us;  // Driver conversion time of current_raw_adc, 0 if not timestamped
     unsigned long last_update;
     Preferences* prefs;
     
@@ -95,6 +107,9 @@ private:
     bool initialize_adc_hardware();
     void update_temperature_if_available();
     
+    // Core 0: derives and publishes the snapshot for the sample just fed
+    void publish_snapshot(int32_t raw_adc, uint32_t timestamp_ms);
+    
 #if SYS_ENABLE_REALTIME_HEARTBEAT
     // SPS tracking for performance monitoring
     static const int SPS_TRACKING_BUFFER_SIZE = 160;  // ~2 seconds at 80 SPS (ample headroom at lower SPS)
@@ -125,6 +140,7 @@ public:
     // Legacy wrapper methods for compatibility
     bool start_nonblocking_tare() { tareNoDelay(); return true; }
     bool is_tare_in_progress() const { return doTare; }
+    static const uint8_t TARE_SAMPLES = DATA_SET + 1;   // Samples a tare takes; the last one sets the new zero
     
     // Calibration
     void calibrate(float known_weight);
@@ -138,9 +154,16 @@ public:
     // Non-blocking HX711 data acquisition (merged from HX711Core)
     bool data_waiting_async();
     bool update_async();
+    bool set_data_ready_task(TaskHandle_t task);     // Wake task on new conversions (false = poll)
+    uint64_t get_last_sample_timestamp_us() const { return last_sample_timestamp_us; }
     
     // Unified settling methods with window_ms
-    bool check_settling_complete(uint32_t window_ms, float* settled_weight_out = nullptr);
+    // allow_sequential: also accept the sequential detector (GRIND_SEQUENTIAL_SETTLING) before the window is quiet.
+    // Pulse and final grind settling only - its tolerance is in calibrated grams
+    bool check_settling_complete(uint32_t window_ms, float* settled_weight_out = nullptr, bool allow_sequential = false);
+    // Sequential detector only: settled on samples that all follow a rise in weight detected at or
+    // after rise_after_ms, i.e. grounds that landed after that time and have come to rest
+    bool check_settled_after_rise(uint32_t rise_after_ms, float* settled_weight_out = nullptr);
     void cancel_settling();
     
     // Load cell noise level diagnostic for UI display
@@ -156,20 +179,29 @@ public:
     
     // Primary weight readings using CircularBufferMath with single conversion point
     float get_instant_weight() const;                        // Latest single sample converted to weight
-    float get_weight_low_latency() const;                    // 50ms window - for real-time control
-    float get_display_weight();                              // 250ms + asymmetric filter - for UI
-    float get_weight_high_latency() const;                   // 250ms window - for final measurements
+    float get_weight_low_latency() const;                    // 100ms window - for real-time control
+    float get_display_weight() const;                        // Published display weight (300ms + asymmetric filter) - for UI
+    float get_weight_high_latency() const;                   // 300ms window - for final measurements
+    uint32_t get_latest_sample_time_ms() const;              // millis() timestamp of the newest sample, 0 if none
     bool get_weight_delta(uint32_t window_ms, float* delta_out,
                           int* sample_count_out = nullptr,
                           uint32_t* span_ms_out = nullptr) const;
     float get_weight_range(uint32_t window_ms) const;
     bool weight_range_exceeds(uint32_t window_ms, float threshold_g) const;
     
+    // Latest published snapshot - what UI, BLE and diagnostics read (lock-free, any task)
+    WeightSnapshot get_snapshot() const { return snapshot_publisher.read(); }
+    
     // Flow rate analysis using CircularBufferMath
     float get_flow_rate(uint32_t window_ms = 200) const;     // Flow rate calculation (default 200ms window)
     float get_flow_rate_95th_percentile(uint32_t window_ms = 200) const; // 95th percentile flow rate for dynamic pulse algorithm
     bool is_flow_rate_stable(uint32_t window_ms = 100) const; // Check if flow rate has stabilized
     
+    // Kalman weight/flow estimate at the newest sample (GRIND_WEIGHT_FLOW_ESTIMATOR); false before the first sample
+    bool get_weight_flow_estimate(WeightFlowEstimator::Estimate* estimate_out) const;
+    // Motor state for the estimator's noise model - grind control sets it every update
+    void set_motor_running(bool running) { motor_running_.store(running, std::memory_order_relaxed); }
+    
     // Settling methods - WARNING: These methods block execution!
     float get_motor_settled_weight(float* settle_time_out = nullptr);     // Motor settling (300ms window) - for after motor vibrations
     float get_precision_settled_weight(float* settle_time_out = nullptr); // Precision settling (500ms window) - for tare/calibration/final measurements
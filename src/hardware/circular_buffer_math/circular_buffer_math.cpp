@@ -3,6 +3,18 @@
 #include <math.h>
 #include <algorithm>
 
+// Windows maintained incrementally by add_sample() - every window queried on the
+// control or UI path should be listed here, anything else falls back to a scan
+const uint32_t CircularBufferMath::TRACKED_WINDOWS_MS[CircularBufferMath::TRACKED_WINDOW_COUNT] = {
+    50,     // Flow stability half window
+    100,    // Low latency weight, flow stability
+    200,    // Default flow rate, motor settling
+    250,    // Tare smoothing
+    300,    // Display and high latency weight
+    500,    // Precision settling, noise diagnostics, flow detection
+    1500    // Predictive flow rate estimate
+};
+
 CircularBufferMath::CircularBufferMath() {
     write_index = 0;
     samples_count = 0;
@@ -10,21 +22,41 @@ CircularBufferMath::CircularBufferMath() {
     display_filter_initialized = false;
     flow_stable_since_ms = 0;
     flow_stability_initialized = false;
+    windowed_stats_enabled = true;
+    flow_percentile_sweep_enabled = true;
+    stats_sequence.store(0);
     
     // Initialize buffer
     for (uint16_t i = 0; i < MAX_BUFFER_SIZE; i++) {
         circular_buffer[i].raw_value = 0;
         circular_buffer[i].timestamp_ms = 0;
     }
+    
+    reset_window_stats();
 }
 
 void CircularBufferMath::add_sample(int32_t raw_adc_value, uint32_t timestamp_ms) {
     // Raw ADC values should be valid 24-bit signed integers
     // We don't validate range here as different ADCs have different ranges
     
+    // Mark statistics as being updated so concurrent readers retry
+    stats_sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    // A full buffer overwrites its oldest slot - drop it from any window still holding it
+    if (windowed_stats_enabled && samples_count == MAX_BUFFER_SIZE) {
+        for (uint8_t w = 0; w < TRACKED_WINDOW_COUNT; w++) {
+            WindowStats& stats = window_stats[w];
+            if (stats.count > 0 && stats.oldest_index == write_index) {
+                window_evict_oldest(stats);
+            }
+        }
+    }
+    
     // Add raw value directly to circular buffer (no IIR filtering)
-    circular_buffer[write_index].raw_value = raw_adc_value;
-    circular_buffer[write_index].timestamp_ms = timestamp_ms;
+    uint16_t sample_index = write_index;
+    circular_buffer[sample_index].raw_value = raw_adc_value;
+    circular_buffer[sample_index].timestamp_ms = timestamp_ms;
     
     // Advance write index (circular)
     write_index = (write_index + 1) % MAX_BUFFER_SIZE;
@@ -33,6 +65,234 @@ void CircularBufferMath::add_sample(int32_t raw_adc_value, uint32_t timestamp_ms
     if (samples_count < MAX_BUFFER_SIZE) {
         samples_count++;
     }
+    
+    if (windowed_stats_enabled) {
+        update_window_stats(sample_index, raw_adc_value, timestamp_ms);
+    }
+    
+    std::atomic_thread_fence(std::memory_order_release);
+    stats_sequence.fetch_add(1, std::memory_order_relaxed);
+}
+
+//==============================================================================
+// INCREMENTAL WINDOW STATISTICS
+//==============================================================================
+
+void CircularBufferMath::reset_window_stats() {
+    stats_offset = 0;
+    stats_offset_initialized = false;
+    
+    for (uint8_t w = 0; w < TRACKED_WINDOW_COUNT; w++) {
+        WindowStats& stats = window_stats[w];
+        stats.window_ms = TRACKED_WINDOWS_MS[w];
+        stats.oldest_index = write_index;
+        stats.count = 0;
+        stats.sum = 0;
+        stats.sum_squares = 0;
+        stats.min_deque.head = 0;
+        stats.min_deque.size = 0;
+        stats.max_deque.head = 0;
+        stats.max_deque.size = 0;
+        stats.overflowed = false;
+    }
+}
+
+void CircularBufferMath::update_window_stats(uint16_t index, int32_t raw_value, uint32_t timestamp_ms) {
+    if (!stats_offset_initialized) {
+        stats_offset = raw_value;
+        stats_offset_initialized = true;
+    }
+    
+    // Slide every tracked window forward to end at this sample
+    for (uint8_t w = 0; w < TRACKED_WINDOW_COUNT; w++) {
+        WindowStats& stats = window_stats[w];
+        window_push_sample(stats, index, raw_value);
+        
+        uint32_t window_start = (timestamp_ms >= stats.window_ms) ? timestamp_ms - stats.window_ms : 0;
+        while (stats.count > 1 && circular_buffer[stats.oldest_index].timestamp_ms < window_start) {
+            window_evict_oldest(stats);
+        }
+        
+        if (stats.overflowed && stats.count <= WINDOW_DEQUE_CAPACITY) {
+            window_rebuild_deques(stats);
+        }
+    }
+}
+
+void CircularBufferMath::set_windowed_stats_enabled(bool enabled) {
+    if (enabled == windowed_stats_enabled) return;
+    
+    stats_sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    windowed_stats_enabled = enabled;
+    reset_window_stats();
+    
+    // Replay the buffered history so tracked windows are valid immediately
+    if (enabled) {
+        uint16_t oldest = (samples_count < MAX_BUFFER_SIZE) ? 0 : write_index;
+        for (uint16_t i = 0; i < samples_count; i++) {
+            uint16_t index = (oldest + i) % MAX_BUFFER_SIZE;
+            update_window_stats(index, circular_buffer[index].raw_value, circular_buffer[index].timestamp_ms);
+        }
+    }
+    
+    std::atomic_thread_fence(std::memory_order_release);
+    stats_sequence.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CircularBufferMath::window_push_sample(WindowStats& stats, uint16_t index, int32_t raw_value) {
+    if (stats.count == 0) {
+        stats.oldest_index = index;
+    }
+    
+    int64_t relative = (int64_t)raw_value - stats_offset;
+    stats.count++;
+    stats.sum += relative;
+    stats.sum_squares += relative * relative;
+    
+    if (stats.overflowed) {
+        return; // Deques are rebuilt once the window fits again
+    }
+    
+    // Monotonic deques: drop candidates that can never be the extreme again
+    IndexDeque& min_q = stats.min_deque;
+    while (min_q.size > 0 &&
+           circular_buffer[min_q.items[(min_q.head + min_q.size - 1) & WINDOW_DEQUE_MASK]].raw_value >= raw_value) {
+        min_q.size--;
+    }
+    IndexDeque& max_q = stats.max_deque;
+    while (max_q.size > 0 &&
+           circular_buffer[max_q.items[(max_q.head + max_q.size - 1) & WINDOW_DEQUE_MASK]].raw_value <= raw_value) {
+        max_q.size--;
+    }
+    
+    if (min_q.size == WINDOW_DEQUE_CAPACITY || max_q.size == WINDOW_DEQUE_CAPACITY) {
+        stats.overflowed = true;
+        return;
+    }
+    
+    min_q.items[(min_q.head + min_q.size) & WINDOW_DEQUE_MASK] = index;
+    min_q.size++;
+    max_q.items[(max_q.head + max_q.size) & WINDOW_DEQUE_MASK] = index;
+    max_q.size++;
+}
+
+void CircularBufferMath::window_evict_oldest(WindowStats& stats) {
+    uint16_t index = stats.oldest_index;
+    int64_t relative = (int64_t)circular_buffer[index].raw_value - stats_offset;
+    stats.sum -= relative;
+    stats.sum_squares -= relative * relative;
+    stats.count--;
+    stats.oldest_index = (index + 1) % MAX_BUFFER_SIZE;
+    
+    if (stats.min_deque.size > 0 && stats.min_deque.items[stats.min_deque.head] == index) {
+        stats.min_deque.head = (stats.min_deque.head + 1) & WINDOW_DEQUE_MASK;
+        stats.min_deque.size--;
+    }
+    if (stats.max_deque.size > 0 && stats.max_deque.items[stats.max_deque.head] == index) {
+        stats.max_deque.head = (stats.max_deque.head + 1) & WINDOW_DEQUE_MASK;
+        stats.max_deque.size--;
+    }
+}
+
+void CircularBufferMath::window_rebuild_deques(WindowStats& stats) {
+    // Replay the window into empty deques; only runs after a capacity overflow
+    uint16_t count = stats.count;
+    uint16_t oldest = stats.oldest_index;
+    int64_t sum = stats.sum;
+    int64_t sum_squares = stats.sum_squares;
+    
+    stats.min_deque.head = 0;
+    stats.min_deque.size = 0;
+    stats.max_deque.head = 0;
+    stats.max_deque.size = 0;
+    stats.overflowed = false;
+    stats.count = 0;
+    
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t index = (oldest + i) % MAX_BUFFER_SIZE;
+        window_push_sample(stats, index, circular_buffer[index].raw_value);
+    }
+    
+    // Running sums were already correct - restore them rather than accumulating twice
+    stats.oldest_index = oldest;
+    stats.count = count;
+    stats.sum = sum;
+    stats.sum_squares = sum_squares;
+}
+
+const CircularBufferMath::WindowStats* CircularBufferMath::find_tracked_window(uint32_t window_ms) const {
+    for (uint8_t w = 0; w < TRACKED_WINDOW_COUNT; w++) {
+        if (window_stats[w].window_ms == window_ms) {
+            return &window_stats[w];
+        }
+    }
+    return nullptr;
+}
+
+bool CircularBufferMath::summarize_window(uint32_t window_ms, WindowSummary* summary_out) const {
+    if (!windowed_stats_enabled || !summary_out) return false;
+    
+    const WindowStats* stats = find_tracked_window(window_ms);
+    if (!stats) return false;
+    
+    uint32_t window_start = millis() - window_ms;
+    
+    for (uint8_t attempt = 0; attempt < WINDOW_QUERY_MAX_RETRIES; attempt++) {
+        uint32_t sequence_before = stats_sequence.load(std::memory_order_acquire);
+        if (sequence_before & 1) {
+            continue; // add_sample() in progress on another task
+        }
+        
+        if (stats->overflowed) {
+            return false;
+        }
+        
+        WindowSummary summary;
+        summary.count = stats->count;
+        summary.sum = stats->sum;
+        summary.sum_squares = stats->sum_squares;
+        summary.oldest_index = stats->oldest_index;
+        summary.newest_index = (write_index - 1 + MAX_BUFFER_SIZE) % MAX_BUFFER_SIZE;
+        summary.min_raw = 0;
+        summary.max_raw = 0;
+        
+        // Age out samples that left the window since the last add_sample()
+        while (summary.count > 0 && circular_buffer[summary.oldest_index].timestamp_ms < window_start) {
+            int64_t relative = (int64_t)circular_buffer[summary.oldest_index].raw_value - stats_offset;
+            summary.sum -= relative;
+            summary.sum_squares -= relative * relative;
+            summary.oldest_index = (summary.oldest_index + 1) % MAX_BUFFER_SIZE;
+            summary.count--;
+        }
+        
+        // Deques are time ordered, so the first candidate still inside the window is the extreme
+        const IndexDeque& min_q = stats->min_deque;
+        for (uint16_t i = 0; i < min_q.size; i++) {
+            const AdcSample& sample = circular_buffer[min_q.items[(min_q.head + i) & WINDOW_DEQUE_MASK]];
+            if (sample.timestamp_ms >= window_start) {
+                summary.min_raw = sample.raw_value;
+                break;
+            }
+        }
+        const IndexDeque& max_q = stats->max_deque;
+        for (uint16_t i = 0; i < max_q.size; i++) {
+            const AdcSample& sample = circular_buffer[max_q.items[(max_q.head + i) & WINDOW_DEQUE_MASK]];
+            if (sample.timestamp_ms >= window_start) {
+                summary.max_raw = sample.raw_value;
+                break;
+            }
+        }
+        
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (stats_sequence.load(std::memory_order_relaxed) == sequence_before) {
+            *summary_out = summary;
+            return true;
+        }
+    }
+    
+    return false; // Writer kept interfering - caller falls back to a buffer scan
 }
 
 int32_t CircularBufferMath::get_instant_raw() const {
@@ -50,10 +310,32 @@ int32_t CircularBufferMath::get_latest_sample() const {
     return circular_buffer[latest_index].raw_value;
 }
 
+uint32_t CircularBufferMath::get_latest_timestamp_ms() const {
+    if (samples_count == 0) return 0;
+
+    uint16_t latest_index = (write_index - 1 + MAX_BUFFER_SIZE) % MAX_BUFFER_SIZE;
+    return circular_buffer[latest_index].timestamp_ms;
+}
+
 // Unified smoothing method with outlier rejection on raw data
 int32_t CircularBufferMath::get_smoothed_raw(uint32_t window_ms) const {
     if (samples_count == 0) return 0;
     
+    WindowSummary summary;
+    if (summarize_window(window_ms, &summary)) {
+        if (summary.count == 0) {
+            return get_latest_sample(); // Fallback to latest sample
+        }
+        
+        // Same trimmed mean as apply_outlier_rejection(): drop one min and one max
+        int64_t total = summary.sum + (int64_t)stats_offset * summary.count;
+        if (summary.count == 1) return (int32_t)total;
+        if (summary.count == 2) return (int32_t)(total / 2);
+        
+        int64_t trimmed = total - summary.min_raw - summary.max_raw;
+        return static_cast<int32_t>(trimmed / (summary.count - 2));
+    }
+    
     // Calculate max samples needed for this window
     int max_samples = calculate_max_samples_for_window(window_ms);
     
@@ -61,7 +343,7 @@ int32_t CircularBufferMath::get_smoothed_raw(uint32_t window_ms) const {
     int32_t* samples = (int32_t*)alloca(max_samples * sizeof(int32_t));
     
     // Get samples within time window
-    int actual_samples = get_samples_in_window(window_ms, samples);
+    int actual_samples = get_samples_in_window(window_ms, samples, max_samples);
     
     if (actual_samples == 0) {
         return get_latest_sample(); // Fallback to latest sample
@@ -71,7 +353,7 @@ int32_t CircularBufferMath::get_smoothed_raw(uint32_t window_ms) const {
     return apply_outlier_rejection(samples, actual_samples);
 }
 
-int CircularBufferMath::get_samples_in_window(uint32_t window_ms, int32_t* samples_out) const {
+int CircularBufferMath::get_samples_in_window(uint32_t window_ms, int32_t* samples_out, int max_samples) const {
     if (samples_count == 0) return 0;
     
     uint32_t current_time = millis();
@@ -79,7 +361,7 @@ int CircularBufferMath::get_samples_in_window(uint32_t window_ms, int32_t* sampl
     int collected_samples = 0;
     
     // Walk backwards from most recent sample
-    for (int i = 0; i < samples_count; i++) {
+    for (int i = 0; i < samples_count && collected_samples < max_samples; i++) {
         uint16_t index = (write_index - 1 - i + MAX_BUFFER_SIZE) % MAX_BUFFER_SIZE;
         
         // Check if sample is within time window
@@ -126,8 +408,14 @@ int32_t CircularBufferMath::apply_outlier_rejection(const int32_t* samples, int
 }
 
 int CircularBufferMath::calculate_max_samples_for_window(uint32_t window_ms) const {
-    // Estimate max samples
-    int estimated_samples = (window_ms * HW_LOADCELL_SAMPLE_RATE_SPS) / 1000 + 10; // +10 for safety margin
+    // Estimate max samples from the configured rate, or the observed buffer rate if the ADC runs faster
+    uint32_t rate_sps = HW_LOADCELL_SAMPLE_RATE_SPS;
+    uint32_t span_ms = get_buffer_time_span_ms();
+    if (span_ms > 0) {
+        uint32_t observed_sps = ((uint32_t)(samples_count - 1) * 1000 + span_ms - 1) / span_ms;
+        rate_sps = std::max(rate_sps, observed_sps);
+    }
+    int estimated_samples = (window_ms * rate_sps) / 1000 + 10; // +10 for safety margin
     
     // Cap at reasonable limits
     if (estimated_samples > (int)samples_count) {
@@ -203,31 +491,42 @@ bool CircularBufferMath::get_window_delta(uint32_t window_ms, int32_t* delta_out
         return false;
     }
 
-    uint32_t current_time = millis();
-    uint32_t window_start = current_time - window_ms;
-
     int collected = 0;
     int32_t newest_raw = 0;
     int32_t oldest_raw = 0;
     uint32_t newest_ts = 0;
     uint32_t oldest_ts = 0;
 
-    for (int i = 0; i < samples_count; ++i) {
-        uint16_t index = (write_index - 1 - i + MAX_BUFFER_SIZE) % MAX_BUFFER_SIZE;
-        const AdcSample& sample = circular_buffer[index];
-
-        if (sample.timestamp_ms < window_start) {
-            break;
+    WindowSummary summary;
+    if (summarize_window(window_ms, &summary)) {
+        collected = summary.count;
+        if (collected > 0) {
+            newest_raw = circular_buffer[summary.newest_index].raw_value;
+            newest_ts = circular_buffer[summary.newest_index].timestamp_ms;
+            oldest_raw = circular_buffer[summary.oldest_index].raw_value;
+            oldest_ts = circular_buffer[summary.oldest_index].timestamp_ms;
         }
+    } else {
+        uint32_t current_time = millis();
+        uint32_t window_start = current_time - window_ms;
 
-        if (collected == 0) {
-            newest_raw = sample.raw_value;
-            newest_ts = sample.timestamp_ms;
-        }
+        for (int i = 0; i < samples_count; ++i) {
+            uint16_t index = (write_index - 1 - i + MAX_BUFFER_SIZE) % MAX_BUFFER_SIZE;
+            const AdcSample& sample = circular_buffer[index];
 
-        oldest_raw = sample.raw_value;
-        oldest_ts = sample.timestamp_ms;
-        ++collected;
+            if (sample.timestamp_ms < window_start) {
+                break;
+            }
+
+            if (collected == 0) {
+                newest_raw = sample.raw_value;
+                newest_ts = sample.timestamp_ms;
+            }
+
+            oldest_raw = sample.raw_value;
+            oldest_ts = sample.timestamp_ms;
+            ++collected;
+        }
     }
 
     if (samples_out) {
@@ -259,6 +558,7 @@ bool CircularBufferMath::is_settled(uint32_t window_ms, int32_t threshold_raw_un
     float std_dev = get_standard_deviation_raw(window_ms);
     bool settled = std_dev <= threshold_raw_units;
     
+#if DEBUG_LOAD_CELL
     // Debug output every 1s during settling checks
     static uint32_t last_debug_time = 0;
     if (millis() - last_debug_time > 1000) {
@@ -266,7 +566,7 @@ bool CircularBufferMath::is_settled(uint32_t window_ms, int32_t threshold_raw_un
         int max_samples = calculate_max_samples_for_window(window_ms);
         if (max_samples > 0) {
             int32_t* samples = (int32_t*)alloca(max_samples * sizeof(int32_t));
-            int actual_samples = get_samples_in_window(window_ms, samples);
+            int actual_samples = get_samples_in_window(window_ms, samples, max_samples);
             
             // Format raw samples on one line (limit to first 10 samples to avoid spam)
             char sample_str[256] = {0};
@@ -286,6 +586,7 @@ bool CircularBufferMath::is_settled(uint32_t window_ms, int32_t threshold_raw_un
         }
         last_debug_time = millis();
     }
+#endif
     
     return settled;
 }
@@ -303,6 +604,17 @@ float CircularBufferMath::get_settling_confidence(uint32_t window_ms) const {
 }
 
 float CircularBufferMath::get_standard_deviation_raw(uint32_t window_ms) const {
+    WindowSummary summary;
+    if (summarize_window(window_ms, &summary)) {
+        if (summary.count <= 1) return 0.0f;
+        
+        // Sample variance from exact offset-relative sums
+        double n = (double)summary.count;
+        double sum = (double)summary.sum;
+        double variance = ((double)summary.sum_squares - (sum * sum) / n) / (n - 1.0);
+        return variance > 0.0 ? (float)sqrt(variance) : 0.0f;
+    }
+    
     // Calculate max samples needed
     int max_samples = calculate_max_samples_for_window(window_ms);
     if (max_samples == 0) return 0.0f;
@@ -311,7 +623,7 @@ float CircularBufferMath::get_standard_deviation_raw(uint32_t window_ms) const {
     int32_t* samples = (int32_t*)alloca(max_samples * sizeof(int32_t));
     
     // Get samples within time window
-    int actual_samples = get_samples_in_window(window_ms, samples);
+    int actual_samples = get_samples_in_window(window_ms, samples, max_samples);
     
     return calculate_standard_deviation(samples, actual_samples);
 }
@@ -338,6 +650,18 @@ float CircularBufferMath::calculate_standard_deviation(const int32_t* samples, i
 }
 
 float CircularBufferMath::get_raw_flow_rate(uint32_t window_ms) const {
+    WindowSummary summary;
+    if (summarize_window(window_ms, &summary)) {
+        if (summary.count < 2) return 0.0f;
+        
+        const AdcSample& newest = circular_buffer[summary.newest_index];
+        const AdcSample& oldest = circular_buffer[summary.oldest_index];
+        uint32_t time_change = newest.timestamp_ms - oldest.timestamp_ms;
+        if (time_change == 0) return 0.0f;
+        
+        return (float)(newest.raw_value - oldest.raw_value) * 1000.0f / time_change;
+    }
+    
     // Calculate max samples needed
     int max_samples = calculate_max_samples_for_window(window_ms);
     if (max_samples < 2) return 0.0f;
@@ -376,13 +700,21 @@ float CircularBufferMath::get_raw_flow_rate(uint32_t window_ms) const {
 }
 
 float CircularBufferMath::get_raw_flow_rate_95th_percentile(uint32_t window_ms) const {
+    if (flow_percentile_sweep_enabled) {
+        return sweep_flow_rate_95th_percentile(window_ms);
+    } else {
+        return scan_flow_rate_95th_percentile(window_ms);
+    }
+}
+
+float CircularBufferMath::scan_flow_rate_95th_percentile(uint32_t window_ms) const {
     // Define parameters for the sub-window analysis
-    const uint32_t MIN_SAMPLES_FOR_PERCENTILE = 10;
-    const uint32_t SUB_WINDOW_MS = 300;
-    const uint32_t STEP_MS = 100;
-    const int MIN_SUB_WINDOWS = 4;
-    const int MAX_SUB_WINDOWS = 32;
-    const int MIN_SAMPLES_PER_SUB_WINDOW = 3;
+    const uint32_t MIN_SAMPLES_FOR_PERCENTILE = FLOW_PERCENTILE_MIN_SAMPLES;
+    const uint32_t SUB_WINDOW_MS = FLOW_PERCENTILE_SUB_WINDOW_MS;
+    const uint32_t STEP_MS = FLOW_PERCENTILE_STEP_MS;
+    const int MIN_SUB_WINDOWS = FLOW_PERCENTILE_MIN_SUB_WINDOWS;
+    const int MAX_SUB_WINDOWS = FLOW_PERCENTILE_MAX_SUB_WINDOWS;
+    const int MIN_SAMPLES_PER_SUB_WINDOW = FLOW_PERCENTILE_MIN_SUB_WINDOW_SAMPLES;
 
     if (samples_count < MIN_SAMPLES_FOR_PERCENTILE) {
         return get_raw_flow_rate(window_ms); // Fallback for insufficient data
@@ -394,7 +726,7 @@ float CircularBufferMath::get_raw_flow_rate_95th_percentile(uint32_t window_ms)
 
     // 1. Collect all relevant samples and timestamps in one go.
     int max_samples = calculate_max_samples_for_window(effective_window_ms);
-    if (max_samples < MIN_SAMPLES_FOR_PERCENTILE) {
+    if (max_samples < (int)MIN_SAMPLES_FOR_PERCENTILE) {
         return get_raw_flow_rate(effective_window_ms);
     }
 
@@ -416,7 +748,7 @@ float CircularBufferMath::get_raw_flow_rate_95th_percentile(uint32_t window_ms)
         }
     }
 
-    if (collected_samples < MIN_SAMPLES_FOR_PERCENTILE) {
+    if (collected_samples < (int)MIN_SAMPLES_FOR_PERCENTILE) {
         return get_raw_flow_rate(effective_window_ms);
     }
 
@@ -465,6 +797,85 @@ float CircularBufferMath::get_raw_flow_rate_95th_percentile(uint32_t window_ms)
     return get_raw_flow_rate(effective_window_ms);
 }
 
+float CircularBufferMath::sweep_flow_rate_95th_percentile(uint32_t window_ms) const {
+    // Same sub-windows, fallbacks and result as scan_flow_rate_95th_percentile(), read straight from
+    // the buffer. Samples are time ordered and the sub-windows step back in time, so the newest and
+    // oldest sample of each sub-window are found by two offsets that only move towards older samples.
+    if (samples_count < FLOW_PERCENTILE_MIN_SAMPLES) {
+        return get_raw_flow_rate(window_ms);
+    }
+
+    uint32_t min_window_for_samples = (FLOW_PERCENTILE_MIN_SAMPLES * 1000) / HW_LOADCELL_SAMPLE_RATE_SPS;
+    uint32_t effective_window_ms = std::max(window_ms, min_window_for_samples);
+    int max_samples = calculate_max_samples_for_window(effective_window_ms);
+    if (max_samples < FLOW_PERCENTILE_MIN_SAMPLES) {
+        return get_raw_flow_rate(effective_window_ms);
+    }
+
+    int num_sub_windows = (effective_window_ms > FLOW_PERCENTILE_SUB_WINDOW_MS)
+                              ? 1 + (effective_window_ms - FLOW_PERCENTILE_SUB_WINDOW_MS) / FLOW_PERCENTILE_STEP_MS
+                              : 1;
+    num_sub_windows = std::max(FLOW_PERCENTILE_MIN_SUB_WINDOWS, std::min(FLOW_PERCENTILE_MAX_SUB_WINDOWS, num_sub_windows));
+
+    // Windows reaching back past 0ms wrap around and break the ordering - only just after boot
+    uint32_t current_time = millis();
+    uint32_t reach_ms = std::max(effective_window_ms,
+                                 (num_sub_windows - 1) * FLOW_PERCENTILE_STEP_MS + FLOW_PERCENTILE_SUB_WINDOW_MS);
+    if (current_time < reach_ms) {
+        return scan_flow_rate_95th_percentile(window_ms);
+    }
+
+    // Samples in the window, newest first (offset 0 = newest sample), capped like the scan
+    auto sample_at = [this](int offset) -> const AdcSample& {
+        return circular_buffer[(write_index - 1 - offset + MAX_BUFFER_SIZE) % MAX_BUFFER_SIZE];
+    };
+    uint32_t window_start_time = current_time - effective_window_ms;
+    int sample_count = 0;
+    int sample_limit = std::min((int)samples_count, max_samples);
+    while (sample_count < sample_limit && sample_at(sample_count).timestamp_ms >= window_start_time) {
+        sample_count++;
+    }
+    if (sample_count < FLOW_PERCENTILE_MIN_SAMPLES) {
+        return get_raw_flow_rate(effective_window_ms);
+    }
+
+    float flow_rates[FLOW_PERCENTILE_MAX_SUB_WINDOWS];
+    int valid_flow_rates_count = 0;
+    int newest_offset = 0;   // First sample at or before the sub-window end
+    int past_offset = 0;     // First sample before the sub-window start
+
+    for (int i = 0; i < num_sub_windows; ++i) {
+        uint32_t sub_window_end_time = current_time - (i * FLOW_PERCENTILE_STEP_MS);
+        uint32_t sub_window_start_time = sub_window_end_time - FLOW_PERCENTILE_SUB_WINDOW_MS;
+
+        while (newest_offset < sample_count && sample_at(newest_offset).timestamp_ms > sub_window_end_time) {
+            newest_offset++;
+        }
+        while (past_offset < sample_count && sample_at(past_offset).timestamp_ms >= sub_window_start_time) {
+            past_offset++;
+        }
+
+        int oldest_offset = std::max(past_offset, newest_offset) - 1;
+        if (oldest_offset - newest_offset + 1 < FLOW_PERCENTILE_MIN_SUB_WINDOW_SAMPLES) continue;
+
+        const AdcSample& newest = sample_at(newest_offset);
+        const AdcSample& oldest = sample_at(oldest_offset);
+        uint32_t time_delta = newest.timestamp_ms - oldest.timestamp_ms;
+        if (time_delta > 0) {
+            flow_rates[valid_flow_rates_count++] = (float)(newest.raw_value - oldest.raw_value) * 1000.0f / time_delta;
+        }
+    }
+
+    if (valid_flow_rates_count < FLOW_PERCENTILE_MIN_SUB_WINDOW_SAMPLES) {
+        return get_raw_flow_rate(effective_window_ms);
+    }
+
+    int percentile_95_index = static_cast<int>(valid_flow_rates_count * 0.95f);
+    percentile_95_index = std::min(percentile_95_index, valid_flow_rates_count - 1);
+    std::nth_element(flow_rates, flow_rates + percentile_95_index, flow_rates + valid_flow_rates_count);
+    return flow_rates[percentile_95_index];
+}
+
 bool CircularBufferMath::raw_flowrate_is_stable(uint32_t window_ms) const {
     // Simple stability check - compare recent flow rates
     float current_flow = get_raw_flow_rate(window_ms);
@@ -476,11 +887,16 @@ bool CircularBufferMath::raw_flowrate_is_stable(uint32_t window_ms) const {
 }
 
 int32_t CircularBufferMath::get_min_raw(uint32_t window_ms) const {
+    WindowSummary summary;
+    if (summarize_window(window_ms, &summary)) {
+        return summary.count > 0 ? summary.min_raw : 0;
+    }
+    
     int max_samples = calculate_max_samples_for_window(window_ms);
     if (max_samples == 0) return 0;
     
     int32_t* samples = (int32_t*)alloca(max_samples * sizeof(int32_t));
-    int actual_samples = get_samples_in_window(window_ms, samples);
+    int actual_samples = get_samples_in_window(window_ms, samples, max_samples);
     
     if (actual_samples == 0) return 0;
     
@@ -494,11 +910,16 @@ int32_t CircularBufferMath::get_min_raw(uint32_t window_ms) const {
 }
 
 int32_t CircularBufferMath::get_max_raw(uint32_t window_ms) const {
+    WindowSummary summary;
+    if (summarize_window(window_ms, &summary)) {
+        return summary.count > 0 ? summary.max_raw : 0;
+    }
+    
     int max_samples = calculate_max_samples_for_window(window_ms);
     if (max_samples == 0) return 0;
     
     int32_t* samples = (int32_t*)alloca(max_samples * sizeof(int32_t));
-    int actual_samples = get_samples_in_window(window_ms, samples);
+    int actual_samples = get_samples_in_window(window_ms, samples, max_samples);
     
     if (actual_samples == 0) return 0;
     
@@ -517,6 +938,9 @@ void CircularBufferMath::reset_display_filter() {
 }
 
 void CircularBufferMath::clear_all_samples() {
+    stats_sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
     write_index = 0;
     samples_count = 0;
     display_filter_initialized = false;
@@ -527,4 +951,9 @@ void CircularBufferMath::clear_all_samples() {
         circular_buffer[i].raw_value = 0;
         circular_buffer[i].timestamp_ms = 0;
     }
+    
+    reset_window_stats();
+    
+    std::atomic_thread_fence(std::memory_order_release);
+    stats_sequence.fetch_add(1, std::memory_order_relaxed);
 }
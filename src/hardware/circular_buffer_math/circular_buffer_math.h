@@ -2,6 +2,7 @@
 
 #include <Arduino.h>
 #include <algorithm>
+#include <atomic>
 #include "../../config/constants.h"
 
 /**
@@ -22,17 +23,25 @@
  * - Outlier rejection using min/max removal
  * - Statistical analysis capabilities
  * - Ready for 10 SPS to 80+ SPS operation without code changes
+ * 
+ * Incremental Window Statistics:
+ * - The standard control/UI windows (see TRACKED_WINDOWS_MS) keep running sums,
+ *   sums of squares and monotonic min/max deques, updated by add_sample()
+ * - Queries on a tracked window only skip the few samples that aged out since the
+ *   last add_sample() call, so mean/stddev/min/max/delta cost O(1) instead of a
+ *   buffer walk plus sort
+ * - Any other window size falls back to the original buffer scan
+ * - A sequence counter lets readers on other tasks detect a concurrent add_sample()
+ *   and retry instead of mixing old and new running sums
+ * 
+ * 95th Percentile Flow Rate:
+ * - Computed on demand (once per grind, at motor stop) from the samples in the buffer -
+ *   nothing is maintained per sample
+ * - The 100ms-stepped 300ms sub-windows are found in one pass over the buffer, without
+ *   copying samples, and the percentile is selected with nth_element instead of a sort;
+ *   the result is identical to the original scan per sub-window
  */
 class CircularBufferMath {
-public:
-    
-    struct RawDataReading {
-        int32_t raw_value;
-        float confidence;        // 0.0-1.0 stability confidence  
-        uint32_t settle_time_ms; // How long settling took
-        bool timeout_occurred;   // True if settled due to timeout
-    };
-    
 private:
     struct AdcSample {
         int32_t raw_value;       // Raw signed ADC reading (e.g., 24-bit HX711)
@@ -55,13 +64,77 @@ private:
     mutable uint32_t flow_stable_since_ms;  // When flow rate first became stable
     mutable bool flow_stability_initialized;
     
+    // Incremental window statistics
+    static const uint8_t TRACKED_WINDOW_COUNT = 7;
+    static const uint16_t WINDOW_DEQUE_CAPACITY = 128;      // Power of 2, covers 1500ms at 80 SPS
+    static const uint16_t WINDOW_DEQUE_MASK = WINDOW_DEQUE_CAPACITY - 1;
+    static const uint8_t WINDOW_QUERY_MAX_RETRIES = 4;      // Reader retries before falling back to a scan
+    static const uint32_t TRACKED_WINDOWS_MS[TRACKED_WINDOW_COUNT];
+    
+    // Ring of buffer indices kept in time order (oldest at head)
+    struct IndexDeque {
+        uint16_t items[WINDOW_DEQUE_CAPACITY];
+        uint16_t head;
+        uint16_t size;
+    };
+    
+    struct WindowStats {
+        uint32_t window_ms;
+        uint16_t oldest_index;   // Buffer index of the oldest sample inside the window
+        uint16_t count;          // Samples inside the window
+        int64_t sum;             // Sum of (raw_value - stats_offset)
+        int64_t sum_squares;     // Sum of (raw_value - stats_offset)^2
+        IndexDeque min_deque;    // Candidates for window minimum (increasing values)
+        IndexDeque max_deque;    // Candidates for window maximum (decreasing values)
+        bool overflowed;         // Deque ran out of capacity - rebuilt once the window shrinks
+    };
+    
+    // Result of a tracked window query after aging out stale samples
+    struct WindowSummary {
+        int count;
+        int64_t sum;             // Offset-relative, see stats_offset
+        int64_t sum_squares;
+        int32_t min_raw;
+        int32_t max_raw;
+        uint16_t oldest_index;
+        uint16_t newest_index;
+    };
+    
+    WindowStats window_stats[TRACKED_WINDOW_COUNT];
+    int32_t stats_offset;                  // First sample after clear - keeps sums of squares small
+    bool stats_offset_initialized;
+    bool windowed_stats_enabled;
+    std::atomic<uint32_t> stats_sequence;  // Odd while add_sample() is updating
+    
+    // 95th percentile flow rate - 300ms sub-windows stepped by 100ms over the query window
+    static const uint32_t FLOW_PERCENTILE_SUB_WINDOW_MS = 300;
+    static const uint32_t FLOW_PERCENTILE_STEP_MS = 100;
+    static const int FLOW_PERCENTILE_MIN_SAMPLES = 10;
+    static const int FLOW_PERCENTILE_MIN_SUB_WINDOW_SAMPLES = 3;
+    static const int FLOW_PERCENTILE_MIN_SUB_WINDOWS = 4;
+    static const int FLOW_PERCENTILE_MAX_SUB_WINDOWS = 32;
+    bool flow_percentile_sweep_enabled;
+    
     // Helper methods - using dynamic arrays based on window size
-    int get_samples_in_window(uint32_t window_ms, int32_t* samples_out) const;
+    int get_samples_in_window(uint32_t window_ms, int32_t* samples_out, int max_samples) const;
     int32_t apply_outlier_rejection(const int32_t* samples, int count) const;
     float calculate_standard_deviation(const int32_t* samples, int count) const;
     int32_t get_latest_sample() const;
     int calculate_max_samples_for_window(uint32_t window_ms) const;
     
+    // Incremental window statistics helpers
+    void reset_window_stats();
+    void update_window_stats(uint16_t index, int32_t raw_value, uint32_t timestamp_ms);
+    void window_push_sample(WindowStats& stats, uint16_t index, int32_t raw_value);
+    void window_evict_oldest(WindowStats& stats);
+    void window_rebuild_deques(WindowStats& stats);
+    const WindowStats* find_tracked_window(uint32_t window_ms) const;
+    bool summarize_window(uint32_t window_ms, WindowSummary* summary_out) const;
+    
+    // 95th percentile flow rate - one pass over the buffer, or a collect-and-scan per sub-window
+    float sweep_flow_rate_95th_percentile(uint32_t window_ms) const;
+    float scan_flow_rate_95th_percentile(uint32_t window_ms) const;
+    
 public:
     CircularBufferMath();
     
@@ -73,15 +146,16 @@ public:
     
     // Specialized raw readings with different time windows
     int32_t get_instant_raw() const;           // Latest single sample
-    int32_t get_raw_low_latency() const;       // 50ms window - for real-time control  
-    int32_t get_display_raw();                 // 250ms window + asymmetric filter - for UI
-    int32_t get_raw_high_latency() const;      // 250ms window - for final measurements
+    int32_t get_raw_low_latency() const;       // 100ms window - for real-time control  
+    int32_t get_display_raw();                 // 300ms window + asymmetric filter - for UI
+    int32_t get_raw_high_latency() const;      // 300ms window - for final measurements
     bool get_window_delta(uint32_t window_ms, int32_t* delta_out,
                           uint32_t* span_ms_out = nullptr, int* samples_out = nullptr) const;
     
     // Raw access for diagnostics
     uint16_t get_sample_count() const { return samples_count; }
     uint32_t get_buffer_time_span_ms() const;
+    uint32_t get_latest_timestamp_ms() const;  // Timestamp of the newest sample, 0 if empty
     
     // Settling analysis - window_ms based with raw value threshold
     bool is_settled(uint32_t window_ms, int32_t threshold_raw_units) const;
@@ -100,4 +174,11 @@ public:
     // Reset functions
     void reset_display_filter();
     void clear_all_samples();
+    
+    // Incremental statistics toggle (disabled = always scan the buffer, used for A/B benchmarking)
+    void set_windowed_stats_enabled(bool enabled);
+    bool is_windowed_stats_enabled() const { return windowed_stats_enabled; }
+    
+    // 95th percentile sweep toggle (disabled = original scan per sub-window, used for A/B benchmarking)
+    void set_flow_percentile_sweep_enabled(bool enabled) { flow_percentile_sweep_enabled = enabled; }
 };
@@ -0,0 +1,134 @@
+#include "settling_detector.h"
+#include <math.h>
+
+namespace {
+
+const float NOISE_EWMA_WEIGHT = 1.0f / 64.0f;   // ~6s of settled samples at 10 SPS
+
+} // namespace
+
+SettlingDetector::SettlingDetector() {
+    Config defaults = {};
+    defaults.tolerance = 0.015f;
+    defaults.false_settle_probability = 0.01f;
+    defaults.min_samples = 3;
+    defaults.noise_initial = 0.005f;
+    defaults.noise_min = 0.002f;
+    defaults.cusum_slack = 0.5f;
+    defaults.cusum_threshold = 4.0f;
+    configure(defaults);
+    reset();
+}
+
+void SettlingDetector::configure(const Config& new_config) {
+    config = new_config;
+    if (config.min_samples < 2) config.min_samples = 2;
+    if (config.min_samples > MAX_SEGMENT_SAMPLES) config.min_samples = MAX_SEGMENT_SAMPLES;
+
+    // Invert the normal CDF once by bisection - configure() is not on the sample path
+    float target = 1.0f - config.false_settle_probability;
+    float low = 0.0f;
+    float high = 8.0f;
+    for (int i = 0; i < 40; i++) {
+        float mid = 0.5f * (low + high);
+        if (normal_cdf(mid) < target) low = mid;
+        else high = mid;
+    }
+    settle_z = high;
+    noise_variance = config.noise_initial * config.noise_initial;
+}
+
+void SettlingDetector::reset() {
+    has_last_value = false;
+    restart_segment();
+    current.segment_start_ms = 0;
+    current.last_rise_ms = 0;
+}
+
+void SettlingDetector::restart_segment() {
+    head = 0;
+    count = 0;
+    cusum_high = 0.0f;
+    cusum_low = 0.0f;
+
+    current.settled = false;
+    current.confidence = 0.0f;
+    current.drift = 0.0f;
+    current.samples = 0;
+    current.noise = noise();
+}
+
+float SettlingDetector::noise() const {
+    float sigma = sqrtf(noise_variance);
+    return sigma > config.noise_min ? sigma : config.noise_min;
+}
+
+float SettlingDetector::normal_cdf(float z) {
+    return 0.5f * erfcf(-z * 0.70710678f);
+}
+
+void SettlingDetector::add_sample(float value, uint32_t timestamp_ms) {
+    if (count > 0) {
+        float sigma = noise();
+        float residual = (value - current.value) / sigma;
+        cusum_high = fmaxf(0.0f, cusum_high + residual - config.cusum_slack);
+        cusum_low = fmaxf(0.0f, cusum_low - residual - config.cusum_slack);
+
+        if (cusum_high > config.cusum_threshold || cusum_low > config.cusum_threshold) {
+            if (cusum_high > config.cusum_threshold) {
+                current.last_rise_ms = timestamp_ms;
+            }
+            restart_segment();
+        } else if (current.settled && has_last_value) {
+            // Successive differences of a settled reading carry twice the per-sample variance
+            float difference = value - last_value;
+            noise_variance += (0.5f * difference * difference - noise_variance) * NOISE_EWMA_WEIGHT;
+        }
+    }
+
+    if (count == MAX_SEGMENT_SAMPLES) {
+        head = (head + 1) % MAX_SEGMENT_SAMPLES;
+        count--;
+    }
+    uint16_t slot = (head + count) % MAX_SEGMENT_SAMPLES;
+    values[slot] = value;
+    timestamps[slot] = timestamp_ms;
+    count++;
+
+    last_value = value;
+    has_last_value = true;
+    update_estimate();
+}
+
+void SettlingDetector::update_estimate() {
+    uint16_t older = count / 2;
+    float older_sum = 0.0f;
+    float newer_sum = 0.0f;
+    for (uint16_t i = 0; i < count; i++) {
+        float value = values[(head + i) % MAX_SEGMENT_SAMPLES];
+        if (i < older) older_sum += value;
+        else newer_sum += value;
+    }
+
+    // The newer half follows a slow creep more closely than the whole segment would
+    uint16_t newer = count - older;
+    float sigma = noise();
+    current.value = newer_sum / newer;
+    current.noise = sigma;
+    current.samples = count;
+    current.segment_start_ms = timestamps[head];
+
+    if (count < config.min_samples) {
+        current.drift = 0.0f;
+        current.confidence = 0.0f;
+        current.settled = false;
+        return;
+    }
+
+    current.drift = current.value - older_sum / older;
+
+    // Drift between the halves and the error of the mean itself both move the final value
+    float standard_error = sigma * sqrtf(1.0f / older + 1.0f / newer + 1.0f / count);
+    current.confidence = normal_cdf((config.tolerance - fabsf(current.drift)) / standard_error);
+    current.settled = (config.tolerance - fabsf(current.drift)) >= settle_z * standard_error;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * SettlingEstimate - what SettlingDetector currently believes about the reading
+ */
+struct SettlingEstimate {
+    bool settled;                 // confidence >= 1 - false settle probability
+    float confidence;             // 0.0-1.0 probability the value is within tolerance of the final reading
+    float value;                  // Mean of the newer half of the segment - the settled reading when settled
+    float drift;                  // Newer half minus older half of the segment
+    float noise;                  // Per-sample noise in use (learned while settled)
+    uint16_t samples;             // Samples in the current segment
+    uint32_t segment_start_ms;    // Timestamp of the oldest sample in the segment
+    uint32_t last_rise_ms;        // Sample at which the last upward change was detected, 0 = none
+};
+
+/**
+ * SettlingDetector - sequential change-point settling test
+ *
+ * Instead of waiting for a fixed window and comparing its standard deviation with a
+ * threshold, the detector keeps a segment of samples since the last detected change and
+ * decides after every sample whether that segment has stopped moving:
+ *
+ * - A two-sided CUSUM on the residuals against the current value (in units of the noise,
+ *   slack k, threshold h) detects a change - grounds landing, a cup being touched - and
+ *   restarts the segment at the new sample. Upward changes - grounds landing - are
+ *   timestamped so callers can tell a segment that follows the grounds of a pulse from the
+ *   quiet before they arrive.
+ * - The segment is settled once an equivalence test says the final value lies within
+ *   `tolerance` of the mean of the newer half: with D the drift between the newer and
+ *   older half and SE its standard error plus that of the segment mean,
+ *   confidence = Phi((tolerance - |D|) / SE). The segment is settled when confidence >= 1 - false_settle_probability, so a quiet
+ *   scale settles after a few samples and a noisy or creeping one waits as long as it must.
+ * - The per-sample noise is learned from successive differences while settled (idle scale
+ *   included), so it follows the load cell actually fitted. It never drops below noise_min.
+ *
+ * Units are whatever the samples are in (grams in WeightSensor). Single-threaded: the
+ * sampling task feeds it and publishes estimate() with the weight snapshot.
+ */
+class SettlingDetector {
+public:
+    struct Config {
+        float tolerance;                  // Largest acceptable |final value - settled value|
+        float false_settle_probability;   // Accepted chance of settling further than tolerance away
+        uint16_t min_samples;             // Samples a segment needs before it can settle
+        float noise_initial;              // Noise assumed until enough settled samples were seen
+        float noise_min;                  // Floor for the learned noise
+        float cusum_slack;                // k, in noise units
+        float cusum_threshold;            // h, in noise units
+    };
+
+    static const uint16_t MAX_SEGMENT_SAMPLES = 32;   // Older samples of a long segment are dropped
+
+    SettlingDetector();
+
+    void configure(const Config& config);
+    void reset();                                     // Forget the segment, keep the learned noise
+    void add_sample(float value, uint32_t timestamp_ms);
+
+    const SettlingEstimate& estimate() const { return current; }
+
+    // Standard normal CDF, exposed for the host replay
+    static float normal_cdf(float z);
+
+private:
+    Config config;
+    float settle_z;                   // Quantile for 1 - false_settle_probability
+
+    float values[MAX_SEGMENT_SAMPLES];
+    uint32_t timestamps[MAX_SEGMENT_SAMPLES];
+    uint16_t head;                    // Index of the oldest sample
+    uint16_t count;
+
+    float cusum_high;
+    float cusum_low;
+    float noise_variance;             // EWMA of squared successive differences / 2
+    float last_value;
+    bool has_last_value;
+
+    SettlingEstimate current;
+
+    float noise() const;
+    void restart_segment();
+    void update_estimate();
+};
@@ -0,0 +1,101 @@
+#include "weight_flow_estimator.h"
+#include <math.h>
+
+namespace {
+
+const float RESTART_FLOW_SD_FLOWING_GPS = 1.0f;   // Flow is unknown when restarting mid-grind
+const float RESTART_FLOW_SD_IDLE_GPS = 0.05f;
+
+} // namespace
+
+WeightFlowEstimator::WeightFlowEstimator() {
+    Config defaults = {};
+    defaults.idle_noise = 0.005f;
+    defaults.motor_noise = 0.033f;
+    defaults.flowing_q = 1.0f;
+    defaults.idle_q = 0.001f;
+    defaults.coast_window_ms = 1500;
+    defaults.idle_flow_decay_ms = 200.0f;
+    defaults.reset_sigma = 6.0f;
+    configure(defaults);
+    motor_running = false;
+    motor_stopped_ms = 0;
+    reset();
+}
+
+void WeightFlowEstimator::configure(const Config& new_config) {
+    config = new_config;
+}
+
+void WeightFlowEstimator::reset() {
+    initialized = false;
+    current = {};
+    p_ww = 0.0f;
+    p_wf = 0.0f;
+    p_ff = 0.0f;
+}
+
+void WeightFlowEstimator::set_motor_running(bool running, uint32_t timestamp_ms) {
+    if (motor_running && !running) {
+        motor_stopped_ms = timestamp_ms;
+    }
+    motor_running = running;
+}
+
+bool WeightFlowEstimator::grounds_can_arrive(uint32_t timestamp_ms) const {
+    return motor_running || (int32_t)(timestamp_ms - motor_stopped_ms) < (int32_t)config.coast_window_ms;
+}
+
+void WeightFlowEstimator::restart(float weight, uint32_t timestamp_ms) {
+    float noise = motor_running ? config.motor_noise : config.idle_noise;
+    float flow_sd = grounds_can_arrive(timestamp_ms) ? RESTART_FLOW_SD_FLOWING_GPS : RESTART_FLOW_SD_IDLE_GPS;
+
+    current.weight = weight;
+    current.flow_rate = 0.0f;
+    current.timestamp_ms = timestamp_ms;
+    p_ww = noise * noise;
+    p_wf = 0.0f;
+    p_ff = flow_sd * flow_sd;
+    initialized = true;
+}
+
+void WeightFlowEstimator::add_sample(float weight, uint32_t timestamp_ms) {
+    if (!initialized) {
+        restart(weight, timestamp_ms);
+    } else {
+        float dt = (int32_t)(timestamp_ms - current.timestamp_ms) / 1000.0f;
+        if (dt < 0.0f) dt = 0.0f;
+        bool flowing = grounds_can_arrive(timestamp_ms);
+
+        // Predict: weight integrates flow; once no grounds can arrive the flow decays to zero
+        float decay = flowing ? 1.0f : expf(-dt * 1000.0f / config.idle_flow_decay_ms);
+        float q = flowing ? config.flowing_q : config.idle_q;
+        float predicted_weight = current.weight + current.flow_rate * dt;
+        float predicted_flow = current.flow_rate * decay;
+
+        // P = F P F' + Q for F = [1 dt; 0 decay] and white flow acceleration of density q
+        float ww = p_ww + 2.0f * dt * p_wf + dt * dt * p_ff + q * dt * dt * dt / 3.0f;
+        float wf = decay * (p_wf + dt * p_ff) + q * dt * dt / 2.0f;
+        float ff = decay * decay * p_ff + q * dt;
+
+        // Update with the sample
+        float noise = motor_running ? config.motor_noise : config.idle_noise;
+        float innovation = weight - predicted_weight;
+        float innovation_var = ww + noise * noise;
+        if (innovation * innovation > config.reset_sigma * config.reset_sigma * innovation_var) {
+            restart(weight, timestamp_ms);
+        } else {
+            float gain_w = ww / innovation_var;
+            float gain_f = wf / innovation_var;
+            current.weight = predicted_weight + gain_w * innovation;
+            current.flow_rate = predicted_flow + gain_f * innovation;
+            current.timestamp_ms = timestamp_ms;
+            p_ww = (1.0f - gain_w) * ww;
+            p_wf = (1.0f - gain_w) * wf;
+            p_ff = ff - gain_f * wf;
+        }
+    }
+
+    current.weight_sd = sqrtf(p_ww);
+    current.flow_sd = sqrtf(p_ff);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * WeightFlowEstimator - Kalman filter for weight and flow rate, switched by motor state
+ *
+ * State is [weight, flow]: weight integrates flow between samples and flow follows a random
+ * walk. Every load cell sample is one predict/update step, so the estimate refers to the
+ * newest sample instead of the middle of a window, and the flow gain adapts to how far the
+ * weight has moved instead of differencing two noisy samples.
+ *
+ * The motor state decides what the flow may do:
+ * - motor running, and for coast_window_ms after it stops: flow changes with spectral
+ *   density flowing_q (spin-up, chute release, spin-down); samples carry motor vibration
+ *   noise (motor_noise)
+ * - motor stopped for longer: mass cannot arrive any more - flow decays to zero with
+ *   idle_flow_decay_ms, its process noise drops to idle_q, samples carry idle_noise
+ *
+ * A sample further than reset_sigma innovation standard deviations from the prediction
+ * (cup placed or lifted, tare) restarts the filter at that sample. Weight in grams, flow in
+ * g/s. Single-threaded: the sampling task feeds it and publishes estimate() with the
+ * weight snapshot.
+ */
+class WeightFlowEstimator {
+public:
+    struct Config {
+        float idle_noise;             // Sample noise sd with the motor stopped (g)
+        float motor_noise;            // Sample noise sd with the motor running (g)
+        float flowing_q;              // Flow random walk while grounds can arrive ((g/s)^2/s)
+        float idle_q;                 // Flow random walk once they cannot ((g/s)^2/s)
+        uint32_t coast_window_ms;     // Motor stop to the last grounds that can still land
+        float idle_flow_decay_ms;     // Time constant of the flow estimate once idle
+        float reset_sigma;            // Innovation that restarts the filter
+    };
+
+    struct Estimate {
+        float weight;                 // g, at the newest sample
+        float flow_rate;              // g/s
+        float weight_sd;              // Posterior standard deviations
+        float flow_sd;
+        uint32_t timestamp_ms;        // Newest sample, 0 = no sample yet
+    };
+
+    WeightFlowEstimator();
+
+    void configure(const Config& config);
+    void reset();
+
+    // Motor state as of timestamp_ms; call on every change (repeating the same state is harmless)
+    void set_motor_running(bool running, uint32_t timestamp_ms);
+    void add_sample(float weight, uint32_t timestamp_ms);
+
+    const Estimate& estimate() const { return current; }
+
+private:
+    Config config;
+    Estimate current;
+
+    // Covariance of [weight, flow]
+    float p_ww;
+    float p_wf;
+    float p_ff;
+
+    bool motor_running;
+    uint32_t motor_stopped_ms;
+    bool initialized;
+
+    bool grounds_can_arrive(uint32_t timestamp_ms) const;
+    void restart(float weight, uint32_t timestamp_ms);
+};
@@ -1,8 +1,10 @@
 #include "display_manager.h"
 #include "../config/constants.h"
 #include "../config/logging.h"
+#include "../system/task_trace.h"
 #include <Arduino.h>
 #include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include <algorithm>
 #include <cstring>
 
@@ -10,6 +12,8 @@ DisplayManager* g_display_manager = nullptr;
 
 void DisplayManager::init() {
     g_display_manager = this;
+    // Before anything that can fail - set_brightness() takes it even if init() returned early
+    bus_mutex = xSemaphoreCreateMutexStatic(&bus_mutex_buffer);
     
     // Initialize display hardware
     bus = new Arduino_ESP32QSPI(
@@ -34,14 +38,35 @@ void DisplayManager::init() {
     screen_width = gfx_device->width();
     screen_height = gfx_device->height();
 
-    // Full screen buffer, but only partial updates used
-    // RGB565 format (16bit per pixel)
+    if (!allocate_buffers()) {
+        return;
+    }
+
+    lvgl_display = lv_display_create(screen_width, screen_height);
+    lv_display_set_flush_cb(lvgl_display, display_flush_cb);
+    lv_display_set_buffers(lvgl_display, draw_buffer, NULL,
+                          buffer_size , LV_DISPLAY_RENDER_MODE_PARTIAL);
+
+    lv_display_add_event_cb(lvgl_display, display_rounder_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(lvgl_display, display_refresh_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(lvgl_display, display_refresh_cb, LV_EVENT_REFR_READY, NULL);
+
+    // Initialize touch
+    touch_driver.init();
+    lvgl_input = lv_indev_create();
+    lv_indev_set_type(lvgl_input, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(lvgl_input, touchpad_read_cb);
+
+    initialized = true;
+}
+
+bool DisplayManager::allocate_buffers() {
+    // Partial updates only - strips of HW_DISPLAY_DRAW_BUFFER_ROWS rows, RGB565 (16bit per pixel)
     draw_buffer = nullptr;
     dma_staging_buffer = nullptr;
-    dma_staging_rows = 16;
+    dma_staging_rows = HW_DISPLAY_STAGING_ROWS;
 
-    const size_t draw_rows = 40; // 280 * 40 * 2 = 22,400 bytes
-    buffer_size = screen_width * draw_rows * sizeof(uint16_t);
+    buffer_size = screen_width * HW_DISPLAY_DRAW_BUFFER_ROWS * sizeof(uint16_t);
 
     draw_buffer = static_cast<lv_color_t*>(
         heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN,
@@ -57,7 +82,7 @@ void DisplayManager::init() {
 
     if (!draw_buffer) {
         LOG_BLE("[DISPLAY] ERROR: Failed to allocate LVGL draw buffer\n");
-        return;
+        return false;
     }
 
     while (dma_staging_rows >= 4 && dma_staging_buffer == nullptr) {
@@ -74,54 +99,75 @@ void DisplayManager::init() {
         LOG_BLE("[DISPLAY] ERROR: Failed to allocate DMA staging buffer\n");
         heap_caps_free(draw_buffer);
         draw_buffer = nullptr;
-        return;
+        return false;
     }
-
-    lvgl_display = lv_display_create(screen_width, screen_height);
-    lv_display_set_flush_cb(lvgl_display, display_flush_cb);
-    lv_display_set_buffers(lvgl_display, draw_buffer, NULL,
-                          buffer_size , LV_DISPLAY_RENDER_MODE_PARTIAL);
-
-    lv_display_add_event_cb(lvgl_display, display_rounder_cb, LV_EVENT_INVALIDATE_AREA, NULL);
-    
-    // Initialize touch
-    touch_driver.init();
-    lvgl_input = lv_indev_create();
-    lv_indev_set_type(lvgl_input, LV_INDEV_TYPE_POINTER);
-    lv_indev_set_read_cb(lvgl_input, touchpad_read_cb);
-    
-    initialized = true;
+    return true;
 }
 
 void DisplayManager::update() {
     if (!initialized) return;
     
+    poll_touch();
+    render();
+}
+
+bool DisplayManager::poll_touch() {
+    if (!initialized) return false;
+
     touch_driver.update();
+    return touch_driver.is_pressed();
+}
+
+void DisplayManager::render() {
+    if (!initialized) return;
+
     lv_timer_handler();
 }
 
-// Update the refresh area to be full width
-// This avoids weird artifacts when partial row updates are used
+// Full width: avoids weird artifacts when partial row updates are used.
+// Otherwise round to the 2-pixel granularity the CO5300 column/row window needs.
 void DisplayManager::display_rounder_cb(lv_event_t* e) {
     lv_area_t* area = (lv_area_t*)lv_event_get_param(e);
     
+#if HW_DISPLAY_FLUSH_FULL_WIDTH
     area->x1 = 0;
     area->x2 = g_display_manager->screen_width - 1;
+#else
+    area->x1 &= ~1;
+    area->x2 |= 1;
+    area->y1 &= ~1;
+    area->y2 |= 1;
+#endif
 }
 
-void DisplayManager::display_flush_cb(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map) {
-    if (!g_display_manager || !g_display_manager->gfx_device) return;
+void DisplayManager::display_refresh_cb(lv_event_t* e) {
+    DisplayManager* self = g_display_manager;
+    uint32_t now = (uint32_t)esp_timer_get_time();
     
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        self->frame_start_us = now;
+        self->frame_flushed = false;
+        return;
+    }
+    if (!self->frame_flushed) return;  // Nothing was invalidated
+    portENTER_CRITICAL(&self->metrics_lock);
+    self->metrics.renders++;
+    self->metrics.render_us_sum += now - self->frame_start_us;
+    portEXIT_CRITICAL(&self->metrics_lock);
+}
+
+void DisplayManager::draw_area(const lv_area_t* area, const uint8_t* px_map) {
     uint32_t w = lv_area_get_width(area);
     uint32_t h = lv_area_get_height(area);
 
     uint32_t remaining_rows = h;
     uint32_t current_y = area->y1;
     uint32_t src_row_offset = 0;
-    uint16_t* staging = g_display_manager->dma_staging_buffer;
-    uint32_t staging_rows = g_display_manager->dma_staging_rows ? g_display_manager->dma_staging_rows : h;
+    uint16_t* staging = dma_staging_buffer;
+    uint32_t staging_rows = dma_staging_rows ? dma_staging_rows : h;
     const uint16_t* src_pixels = reinterpret_cast<const uint16_t*>(px_map);
 
+    xSemaphoreTake(bus_mutex, portMAX_DELAY);
     while (remaining_rows > 0) {
         uint32_t rows = std::min<uint32_t>(remaining_rows, staging_rows);
         size_t copy_pixels = static_cast<size_t>(w) * rows;
@@ -131,15 +177,15 @@ void DisplayManager::display_flush_cb(lv_display_t* disp, const lv_area_t* area,
             memcpy(staging, chunk_src, copy_pixels * sizeof(uint16_t));
 
             if (LV_COLOR_16_SWAP) {
-                g_display_manager->gfx_device->draw16bitBeRGBBitmap(area->x1, current_y, staging, w, rows);
+                gfx_device->draw16bitBeRGBBitmap(area->x1, current_y, staging, w, rows);
             } else {
-                g_display_manager->gfx_device->draw16bitRGBBitmap(area->x1, current_y, staging, w, rows);
+                gfx_device->draw16bitRGBBitmap(area->x1, current_y, staging, w, rows);
             }
         } else {
             if (LV_COLOR_16_SWAP) {
-                g_display_manager->gfx_device->draw16bitBeRGBBitmap(area->x1, current_y, const_cast<uint16_t*>(chunk_src), w, rows);
+                gfx_device->draw16bitBeRGBBitmap(area->x1, current_y, const_cast<uint16_t*>(chunk_src), w, rows);
             } else {
-                g_display_manager->gfx_device->draw16bitRGBBitmap(area->x1, current_y, const_cast<uint16_t*>(chunk_src), w, rows);
+                gfx_device->draw16bitRGBBitmap(area->x1, current_y, const_cast<uint16_t*>(chunk_src), w, rows);
             }
         }
 
@@ -147,6 +193,44 @@ void DisplayManager::display_flush_cb(lv_display_t* disp, const lv_area_t* area,
         src_row_offset += rows;
         current_y += rows;
     }
+    xSemaphoreGive(bus_mutex);
+}
+
+void DisplayManager::record_flush(uint32_t flush_us, bool last, uint32_t frame_start) {
+    uint32_t now = (uint32_t)esp_timer_get_time();
+
+    portENTER_CRITICAL(&metrics_lock);
+    metrics.strips++;
+    metrics.flush_us_sum += flush_us;
+    metrics.flush_us_max = std::max(metrics.flush_us_max, flush_us);
+    if (last) {
+        uint32_t frame_us = now - frame_start;
+        metrics.frames++;
+        metrics.frame_us_sum += frame_us;
+        metrics.frame_us_max = std::max(metrics.frame_us_max, frame_us);
+    }
+    portEXIT_CRITICAL(&metrics_lock);
+}
+
+DisplayMetrics DisplayManager::take_metrics() {
+    portENTER_CRITICAL(&metrics_lock);
+    DisplayMetrics snapshot = metrics;
+    metrics = DisplayMetrics();
+    portEXIT_CRITICAL(&metrics_lock);
+    return snapshot;
+}
+
+void DisplayManager::display_flush_cb(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map) {
+    DisplayManager* self = g_display_manager;
+    if (!self || !self->gfx_device) return;
+
+    uint32_t start = (uint32_t)esp_timer_get_time();
+    self->frame_flushed = true;
+    TRACE_BEGIN(TRACE_ID_DISPLAY_FLUSH);
+    self->draw_area(area, px_map);
+    TRACE_END(TRACE_ID_DISPLAY_FLUSH);
+    self->record_flush((uint32_t)esp_timer_get_time() - start, lv_display_flush_is_last(disp),
+                       self->frame_start_us);
     
     lv_display_flush_ready(disp);
 }
@@ -179,5 +263,7 @@ void DisplayManager::set_brightness(float brightness) {
     // Cast to CO5300 and call setBrightness with 8-bit value
     Arduino_CO5300* display = static_cast<Arduino_CO5300*>(gfx_device);
     uint8_t brightness_value = (uint8_t)(brightness * 255.0f);
+    xSemaphoreTake(bus_mutex, portMAX_DELAY);
     display->setBrightness(brightness_value);
+    xSemaphoreGive(bus_mutex);
 }
@@ -1,9 +1,23 @@
 #pragma once
 #include <Arduino_GFX_Library.h>
 #include <lvgl.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "touch_driver.h"
 #include "../config/constants.h"
 
+// Refresh and flush timing since the last take_metrics() call
+struct DisplayMetrics {
+    uint32_t frames;                 // Refreshes whose last strip reached the panel
+    uint32_t frame_us_sum;           // Refresh start -> last strip on the panel
+    uint32_t frame_us_max;
+    uint32_t renders;                // Refreshes that drew something
+    uint32_t render_us_sum;          // Time lv_timer_handler() spent in refreshes (includes flushes)
+    uint32_t strips;                 // Flushed draw buffers
+    uint32_t flush_us_sum;           // Copy + bus transfer per strip
+    uint32_t flush_us_max;
+};
+
 class DisplayManager {
 private:
     Arduino_DataBus* bus;
@@ -20,9 +34,20 @@ private:
     uint32_t buffer_size;
     bool initialized;
 
+    // Bus ownership - flushes and set_brightness() both talk to the panel
+    SemaphoreHandle_t bus_mutex;
+    StaticSemaphore_t bus_mutex_buffer;
+
+    uint32_t frame_start_us;
+    bool frame_flushed;
+    DisplayMetrics metrics;
+    portMUX_TYPE metrics_lock = portMUX_INITIALIZER_UNLOCKED;
+
 public:
     void init();
-    void update();
+    void update();                   // poll_touch() + render()
+    bool poll_touch();               // Reads the touch controller, returns true while pressed
+    void render();                   // LVGL timers, input and refresh
     void set_brightness(float brightness);
     
     uint32_t get_width() const { return screen_width; }
@@ -30,9 +55,17 @@ public:
     bool is_initialized() const { return initialized; }
     TouchDriver* get_touch_driver() { return &touch_driver; }
     
+    // Returns the timing gathered since the previous call and starts a new window
+    DisplayMetrics take_metrics();
+
 private:
+    bool allocate_buffers();
+    void draw_area(const lv_area_t* area, const uint8_t* px_map);
+    void record_flush(uint32_t flush_us, bool last, uint32_t frame_start);
+
     static void display_flush_cb(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map);
     static void display_rounder_cb(lv_event_t* e);
+    static void display_refresh_cb(lv_event_t* e);
     static void touchpad_read_cb(lv_indev_t* indev, lv_indev_data_t* data);
     static uint32_t millis_cb();
 };
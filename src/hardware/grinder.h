@@ -40,6 +40,7 @@ public:
     bool is_pulse_complete();
     
     bool is_grinding() const { return grinding; }
+    bool is_pulse_active() const { return pulse_active; }
     bool is_initialized() const { return initialized; }
     bool is_motor_settled() const;
 
@@ -2,6 +2,7 @@
 #include "../config/constants.h"
 #include <Arduino.h>
 #include <driver/gpio.h>
+#include <esp_timer.h>
 
 /**
  * HX711 Driver Implementation
@@ -21,7 +22,10 @@
 HX711Driver::HX711Driver(uint8_t sck_pin, uint8_t dout_pin) 
     : sck_pin(sck_pin), dout_pin(dout_pin), gain(1), last_raw_data(0), 
       data_ready_flag(false), conversion_start_time(0), conversion_time(0),
-      estimated_sample_rate_sps(HW_LOADCELL_SAMPLE_RATE_SPS) {
+      estimated_sample_rate_sps(HW_LOADCELL_SAMPLE_RATE_SPS),
+      irq_acquisition_active(false), spi_device(nullptr), data_ready_task(nullptr),
+      conversion_pending(false), reading_conversion(false), conversion_ready_us(0),
+      last_sample_timestamp_us(0), ring_overflow_count(0) {
 }
 
 bool HX711Driver::begin() {
@@ -29,6 +33,9 @@ bool HX711Driver::begin() {
 }
 
 bool HX711Driver::begin(uint8_t gain_value) {
+    // (Re)initialization runs on the bit-banged path
+    stop_irq_acquisition();
+    
     // Ensure GPIO pins are properly configured for ESP32-S3
     // GPIO 2 is a strapping pin that needs explicit configuration
     gpio_reset_pin((gpio_num_t)sck_pin);
@@ -68,6 +75,12 @@ bool HX711Driver::begin(uint8_t gain_value) {
 
         data_ready_flag = true;
         LOG_BLE("HX711Driver: First sample acquired successfully\n");
+        
+#if HW_LOADCELL_IRQ_ACQUISITION
+        if (!start_irq_acquisition()) {
+            LOG_BLE("HX711Driver: Interrupt acquisition unavailable - using polled bit-bang reads\n");
+        }
+#endif
         return true;
     }
     
@@ -101,6 +114,9 @@ void HX711Driver::power_up_sequence() {
 }
 
 void HX711Driver::power_down_sequence() {
+    // SCK has to be a plain GPIO again to be held high
+    stop_irq_acquisition();
+    
     // Ensure SCK is configured as GPIO output before toggling (may be called before begin())
     pinMode(sck_pin, OUTPUT);
     digitalWrite(sck_pin, LOW);
@@ -113,10 +129,28 @@ bool HX711Driver::is_ready() {
 }
 
 bool HX711Driver::data_waiting_async() {
+    if (irq_acquisition_active) {
+        service_pending_conversion();
+        return !sample_ring.empty();
+    }
     return is_ready();
 }
 
 bool HX711Driver::update_async() {
+    if (irq_acquisition_active) {
+        service_pending_conversion();
+        
+        TimedSample sample;
+        if (!sample_ring.pop(&sample)) {
+            return false;
+        }
+        record_conversion_interval(sample.timestamp_us);
+        last_raw_data = sample.raw_value;
+        last_sample_timestamp_us = sample.timestamp_us;
+        data_ready_flag = true;
+        return true;
+    }
+    
     if (!is_ready()) {
         return false;
     }
@@ -125,15 +159,19 @@ bool HX711Driver::update_async() {
     return true;
 }
 
-void HX711Driver::conversion_24bit() {
-    // Record conversion timing
-    unsigned long now = micros();
+void HX711Driver::record_conversion_interval(uint64_t timestamp_us) {
+    unsigned long now = (unsigned long)timestamp_us;
     if (conversion_start_time == 0) {
         conversion_time = 0;
     } else {
         conversion_time = now - conversion_start_time;
     }
     conversion_start_time = now;
+}
+
+void HX711Driver::conversion_24bit() {
+    // Record conversion timing
+    record_conversion_interval(micros());
     
     uint32_t raw_data = 0;  // Use explicit 32-bit unsigned for ESP32 consistency
     
@@ -171,6 +209,148 @@ void HX711Driver::conversion_24bit() {
     data_ready_flag = true;
 }
 
+//==============================================================================
+// INTERRUPT-DRIVEN ACQUISITION
+//==============================================================================
+
+bool HX711Driver::start_irq_acquisition() {
+    if (irq_acquisition_active) {
+        return true;
+    }
+    
+    // SCK and DOUT move from GPIO to the SPI peripheral: SCK idles low (CPOL 0) and
+    // data is sampled on the falling edge (CPHA 1), matching HX711 timing
+    spi_bus_config_t bus_config = {};
+    bus_config.mosi_io_num = -1;
+    bus_config.miso_io_num = dout_pin;
+    bus_config.sclk_io_num = sck_pin;
+    bus_config.quadwp_io_num = -1;
+    bus_config.quadhd_io_num = -1;
+    bus_config.max_transfer_sz = 4;
+    
+    esp_err_t result = spi_bus_initialize(SPI3_HOST, &bus_config, SPI_DMA_DISABLED);
+    if (result != ESP_OK) {
+        LOG_BLE("HX711Driver: SPI bus init failed (%d)\n", result);
+        return false;
+    }
+    
+    spi_device_interface_config_t device_config = {};
+    device_config.mode = 1;
+    device_config.clock_speed_hz = HW_LOADCELL_SPI_CLOCK_HZ;
+    device_config.spics_io_num = -1;
+    device_config.queue_size = 1;
+    device_config.flags = SPI_DEVICE_HALFDUPLEX;
+    
+    result = spi_bus_add_device(SPI3_HOST, &device_config, &spi_device);
+    if (result != ESP_OK) {
+        LOG_BLE("HX711Driver: SPI device add failed (%d)\n", result);
+        spi_bus_free(SPI3_HOST);
+        spi_device = nullptr;
+        return false;
+    }
+    gpio_pulldown_en((gpio_num_t)dout_pin);
+    
+    sample_ring.reset();
+    conversion_pending = false;
+    reading_conversion = false;
+    irq_acquisition_active = true;
+    attachInterruptArg(dout_pin, dout_falling_isr, this, FALLING);
+    
+    LOG_BLE("HX711Driver: Interrupt acquisition active (DOUT IRQ, SPI3 @ %dHz)\n", HW_LOADCELL_SPI_CLOCK_HZ);
+    return true;
+}
+
+void HX711Driver::stop_irq_acquisition() {
+    if (!irq_acquisition_active) {
+        return;
+    }
+    
+    detachInterrupt(dout_pin);
+    irq_acquisition_active = false;
+    conversion_pending = false;
+    last_sample_timestamp_us = 0;  // Bit-banged samples are not timestamped - callers use the current time
+    
+    spi_bus_remove_device(spi_device);
+    spi_bus_free(SPI3_HOST);
+    spi_device = nullptr;
+    
+    // Return the pins to GPIO for the bit-banged path
+    pinMode(sck_pin, OUTPUT);
+    digitalWrite(sck_pin, LOW);
+    pinMode(dout_pin, INPUT_PULLDOWN);
+}
+
+bool HX711Driver::set_data_ready_task(TaskHandle_t task) {
+    data_ready_task = task;
+    return irq_acquisition_active;
+}
+
+void ARDUINO_ISR_ATTR HX711Driver::dout_falling_isr(void* arg) {
+    HX711Driver* driver = static_cast<HX711Driver*>(arg);
+    if (driver->reading_conversion || driver->conversion_pending) {
+        return; // Data bits being clocked out, or the conversion is already queued
+    }
+    
+    driver->conversion_ready_us = esp_timer_get_time();
+    driver->conversion_pending = true;
+    
+    if (driver->data_ready_task) {
+        BaseType_t higher_priority_woken = pdFALSE;
+        vTaskNotifyGiveFromISR(driver->data_ready_task, &higher_priority_woken);
+        portYIELD_FROM_ISR(higher_priority_woken);
+    }
+}
+
+void HX711Driver::service_pending_conversion() {
+    uint64_t timestamp_us;
+    if (conversion_pending && !is_ready()) {
+        conversion_pending = false; // Late edge from the previous read - DOUT is high again
+        return;
+    }
+    if (conversion_pending) {
+        timestamp_us = conversion_ready_us;
+    } else if (is_ready()) {
+        timestamp_us = esp_timer_get_time(); // Edge missed (e.g. DOUT already low when armed)
+    } else {
+        return;
+    }
+    
+    reading_conversion = true;
+    conversion_pending = false;
+    uint32_t raw_data = 0;
+    bool read_ok = read_conversion_spi(&raw_data);
+    reading_conversion = false;
+    
+    if (!read_ok) {
+        return;
+    }
+    
+    // Same offset-binary normalization as conversion_24bit()
+    TimedSample sample;
+    sample.raw_value = (int32_t)(raw_data ^ 0x800000);
+    sample.timestamp_us = timestamp_us;
+    if (!sample_ring.push(sample)) {
+        ring_overflow_count++;
+    }
+}
+
+bool HX711Driver::read_conversion_spi(uint32_t* raw_out) {
+    // 24 data bits plus 1-3 gain-select pulses; the peripheral times SCK, interrupts stay enabled
+    spi_transaction_t transaction = {};
+    transaction.flags = SPI_TRANS_USE_RXDATA;
+    transaction.length = 0;
+    transaction.rxlength = 24 + gain;
+    
+    if (spi_device_polling_transmit(spi_device, &transaction) != ESP_OK) {
+        return false;
+    }
+    
+    *raw_out = ((uint32_t)transaction.rx_data[0] << 16) |
+               ((uint32_t)transaction.rx_data[1] << 8) |
+               (uint32_t)transaction.rx_data[2];
+    return true;
+}
+
 int32_t HX711Driver::get_raw_data() const {
     return last_raw_data;
 }
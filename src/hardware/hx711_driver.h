@@ -2,8 +2,10 @@
 
 #include "../config/constants.h"
 #include "load_cell_driver.h"
+#include "spsc_ring.h"
 #include <Arduino.h>
 #include <math.h>
+#include <driver/spi_master.h>
 
 /**
  * HX711 ADC Driver Implementation
@@ -18,6 +20,15 @@
  * Original HX711_ADC library:
  * Copyright (c) 2018 Olav Kallhovd
  * Licensed under MIT License
+ * 
+ * Interrupt-driven acquisition (HW_LOADCELL_IRQ_ACQUISITION):
+ * - A DOUT falling-edge interrupt records the conversion time in microseconds and
+ *   notifies the sampling task registered with set_data_ready_task()
+ * - The task clocks the 24-bit word out through the SPI peripheral, so SCK timing no
+ *   longer depends on keeping interrupts disabled
+ * - Timestamped samples pass through a lock-free SPSC ring to update_async()
+ * - begin() and power cycling still use the bit-banged path; if the SPI bus cannot
+ *   be claimed the driver stays on polling
  */
 class HX711Driver : public LoadCellDriver {
 private:
@@ -37,11 +48,35 @@ private:
     static const uint8_t SCK_DELAY = 1;           // Microsecond delay after SCK toggle
     static const uint16_t SIGNAL_TIMEOUT = 100;  // Signal timeout in ms
     
+    // Interrupt-driven acquisition state
+    struct TimedSample {
+        int32_t raw_value;
+        uint64_t timestamp_us;
+    };
+    
+    bool irq_acquisition_active;
+    spi_device_handle_t spi_device;
+    TaskHandle_t data_ready_task;
+    volatile bool conversion_pending;       // Set by the DOUT ISR
+    volatile bool reading_conversion;       // DOUT edges while clocking out data are ignored
+    volatile uint64_t conversion_ready_us;  // ISR timestamp of the pending conversion
+    SpscRing<TimedSample, HW_LOADCELL_SAMPLE_RING_SIZE> sample_ring;
+    uint64_t last_sample_timestamp_us;
+    uint32_t ring_overflow_count;
+    
     // HX711 hardware methods
     void conversion_24bit();
     void power_up_sequence();
     void power_down_sequence();
     
+    // Interrupt-driven acquisition
+    bool start_irq_acquisition();
+    void stop_irq_acquisition();
+    void service_pending_conversion();
+    bool read_conversion_spi(uint32_t* raw_out);
+    void record_conversion_interval(uint64_t timestamp_us);
+    static void dout_falling_isr(void* arg);
+    
 public:
     HX711Driver(uint8_t sck_pin = HW_LOADCELL_SCK_PIN, uint8_t dout_pin = HW_LOADCELL_DOUT_PIN);
     virtual ~HX711Driver() = default;
@@ -66,6 +101,11 @@ public:
     float get_temperature() const override { return NAN; }
     uint32_t get_max_sample_rate() const override { return HW_LOADCELL_SAMPLE_RATE_SPS; }
     float get_estimated_sample_rate_sps() const { return estimated_sample_rate_sps; }
+    
+    uint64_t get_sample_timestamp_us() const override { return last_sample_timestamp_us; }
+    bool set_data_ready_task(TaskHandle_t task) override;
+    bool is_irq_acquisition_active() const { return irq_acquisition_active; }
+    uint32_t get_ring_overflow_count() const { return ring_overflow_count; }
 
     uint8_t get_current_gain() const;
     const char* get_driver_name() const override { return "HX711"; }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 /**
  * Abstract interface for load cell ADC drivers.
@@ -30,5 +32,13 @@ public:
     virtual float get_temperature() const = 0;
     virtual uint32_t get_max_sample_rate() const = 0;
 
+    // Conversion time of the sample returned by the last update_async(), in esp_timer
+    // microseconds. 0 when the driver does not timestamp conversions (caller uses millis()).
+    virtual uint64_t get_sample_timestamp_us() const { return 0; }
+
+    // Wake `task` with a task notification as soon as a conversion is ready.
+    // Returns false if the driver can only be polled.
+    virtual bool set_data_ready_task(TaskHandle_t task) { (void)task; return false; }
+
     virtual const char* get_driver_name() const = 0;
 };
@@ -1,12 +1,15 @@
 #include "mock_hx711_driver.h"
 #include "../config/constants.h"
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #ifdef ESP_PLATFORM
 #include <esp_system.h>
 #endif
 
 MockHX711Driver* MockHX711Driver::instance = nullptr;
+MockGrinderModel MockHX711Driver::model;
+MockSampleSource* MockHX711Driver::sample_source = nullptr;
 
 MockHX711Driver::MockHX711Driver() {
     instance = this;
@@ -24,6 +27,7 @@ void MockHX711Driver::reset_state() {
     last_sample_time_ms = 0;
     next_sample_due_ms = 0;
     simulated_mass_g = 0.0f;
+    chute_mass_g = 0.0f;
     pending_pulse_mass_g = 0.0f;
     data_ready_flag = false;
 
@@ -57,7 +61,7 @@ bool MockHX711Driver::begin(uint8_t gain_value) {
     last_raw_data = static_cast<int32_t>(DEBUG_MOCK_BASELINE_RAW);
     data_ready_flag = false;
     LOG_BLE("MockHX711Driver: initialized (flow=%.2fg/s, cal=%.1f)\n",
-            DEBUG_MOCK_FLOW_RATE_GPS, DEBUG_MOCK_CAL_FACTOR);
+            model.flow_rate_gps, DEBUG_MOCK_CAL_FACTOR);
     return true;
 }
 
@@ -75,6 +79,10 @@ void MockHX711Driver::power_down() {
 
 bool MockHX711Driver::data_waiting_async() {
     unsigned long now = millis();
+    if (sample_source) {
+        data_ready_flag = sample_source->sample_due(now);
+        return data_ready_flag;
+    }
     if (now >= next_sample_due_ms) {
         data_ready_flag = true;
         return true;
@@ -92,6 +100,14 @@ bool MockHX711Driver::update_async() {
     }
 
     unsigned long now = millis();
+    if (sample_source) {
+        last_raw_data = std::max<int32_t>(0, std::min<int32_t>(sample_source->take_sample(now), 0xFFFFFF));
+        last_sample_time_ms = now;
+        data_ready_flag = false;
+        return true;
+    }
+
+    unsigned long elapsed_ms = now - last_sample_time_ms;
     last_sample_time_ms = now;
     next_sample_due_ms = now + HW_LOADCELL_SAMPLE_INTERVAL_MS;
 
@@ -100,8 +116,9 @@ bool MockHX711Driver::update_async() {
     bool pulse_flow = false;
     process_motor_state(now, mass_increment, continuous_flow, pulse_flow);
 
-    if (mass_increment > 0.0f) {
-        simulated_mass_g += mass_increment;
+    float delivered = release_from_chute(mass_increment, elapsed_ms);
+    if (delivered > 0.0f) {
+        simulated_mass_g += delivered;
     }
 
     if (simulated_mass_g < 0.0f) {
@@ -113,11 +130,11 @@ bool MockHX711Driver::update_async() {
     float raw_value = static_cast<float>(DEBUG_MOCK_BASELINE_RAW);
     raw_value += simulated_mass_g * DEBUG_MOCK_CAL_FACTOR;
 
-    float noise_peak = DEBUG_MOCK_IDLE_NOISE_RAW;
+    float noise_peak = model.idle_noise_raw;
     if (pulse_flow) {
-        noise_peak = DEBUG_MOCK_GRIND_NOISE_RAW * 3.0f;
+        noise_peak = model.grind_noise_raw * 3.0f;
     } else if (continuous_flow) {
-        noise_peak = DEBUG_MOCK_GRIND_NOISE_RAW;
+        noise_peak = model.grind_noise_raw;
     }
     raw_value += random_noise(noise_peak);
 
@@ -156,7 +173,7 @@ float MockHX711Driver::process_continuous_state(unsigned long now_ms, bool& cont
 
     if (continuous_commanded) {
         if (!continuous_started) {
-            if (now_ms - continuous_start_ms >= DEBUG_MOCK_START_DELAY_MS) {
+            if (now_ms - continuous_start_ms >= model.start_delay_ms) {
                 continuous_started = true;
                 continuous_ramp_start_ms = now_ms;
             }
@@ -164,18 +181,18 @@ float MockHX711Driver::process_continuous_state(unsigned long now_ms, bool& cont
 
         if (continuous_started) {
             continuous_flow = true;
-            if (DEBUG_MOCK_FLOW_RAMP_MS <= 0) {
+            if (model.flow_ramp_ms == 0) {
                 flow_factor = 1.0f;
             } else {
                 unsigned long elapsed = now_ms - continuous_ramp_start_ms;
-                flow_factor = std::min(1.0f, static_cast<float>(elapsed) / static_cast<float>(DEBUG_MOCK_FLOW_RAMP_MS));
+                flow_factor = std::min(1.0f, static_cast<float>(elapsed) / static_cast<float>(model.flow_ramp_ms));
             }
         }
     } else if (continuous_stop_pending) {
         unsigned long elapsed = now_ms - continuous_stop_ms;
         float ramp_factor = 0.0f;
-        if (DEBUG_MOCK_FLOW_RAMP_MS > 0) {
-            ramp_factor = std::max(0.0f, 1.0f - static_cast<float>(elapsed) / static_cast<float>(DEBUG_MOCK_FLOW_RAMP_MS));
+        if (model.flow_ramp_ms > 0) {
+            ramp_factor = std::max(0.0f, 1.0f - static_cast<float>(elapsed) / static_cast<float>(model.flow_ramp_ms));
         }
 
         if (ramp_factor > 0.0f) {
@@ -183,7 +200,7 @@ float MockHX711Driver::process_continuous_state(unsigned long now_ms, bool& cont
             flow_factor = ramp_factor;
         }
 
-        uint32_t stop_threshold = std::max<uint32_t>(DEBUG_MOCK_STOP_DELAY_MS, DEBUG_MOCK_FLOW_RAMP_MS);
+        uint32_t stop_threshold = std::max<uint32_t>(model.stop_delay_ms, model.flow_ramp_ms);
         if (elapsed >= stop_threshold) {
             continuous_stop_pending = false;
             continuous_started = false;
@@ -204,7 +221,7 @@ float MockHX711Driver::process_pulse_state(unsigned long now_ms, bool& pulse_flo
     float flow_factor = 0.0f;
 
     if (pulse_command_active && !pulse_started) {
-        if (now_ms - pulse_start_ms >= DEBUG_MOCK_START_DELAY_MS) {
+        if (now_ms - pulse_start_ms >= model.start_delay_ms) {
             pulse_started = true;
             pulse_ramp_start_ms = now_ms;
         }
@@ -216,19 +233,19 @@ float MockHX711Driver::process_pulse_state(unsigned long now_ms, bool& pulse_flo
     }
 
     if (pulse_started && pulse_command_active && !pulse_stop_pending) {
-        if (DEBUG_MOCK_FLOW_RAMP_MS <= 0) {
+        if (model.flow_ramp_ms == 0) {
             flow_factor = 1.0f;
         } else {
             unsigned long elapsed = now_ms - pulse_ramp_start_ms;
-            flow_factor = std::min(1.0f, static_cast<float>(elapsed) / static_cast<float>(DEBUG_MOCK_FLOW_RAMP_MS));
+            flow_factor = std::min(1.0f, static_cast<float>(elapsed) / static_cast<float>(model.flow_ramp_ms));
         }
         if (flow_factor > 0.0f && pending_pulse_mass_g > 0.0f) {
             pulse_flow = true;
         }
     } else if (pulse_started && pulse_stop_pending) {
         unsigned long elapsed = now_ms - pulse_stop_ms;
-        if (DEBUG_MOCK_FLOW_RAMP_MS > 0) {
-            flow_factor = std::max(0.0f, 1.0f - static_cast<float>(elapsed) / static_cast<float>(DEBUG_MOCK_FLOW_RAMP_MS));
+        if (model.flow_ramp_ms > 0) {
+            flow_factor = std::max(0.0f, 1.0f - static_cast<float>(elapsed) / static_cast<float>(model.flow_ramp_ms));
         } else {
             flow_factor = 0.0f;
         }
@@ -237,7 +254,7 @@ float MockHX711Driver::process_pulse_state(unsigned long now_ms, bool& pulse_flo
             pulse_flow = true;
         }
 
-        uint32_t stop_threshold = std::max<uint32_t>(DEBUG_MOCK_STOP_DELAY_MS, DEBUG_MOCK_FLOW_RAMP_MS);
+        uint32_t stop_threshold = std::max<uint32_t>(model.stop_delay_ms, model.flow_ramp_ms);
         if (elapsed >= stop_threshold) {
             pulse_stop_pending = false;
             pulse_command_active = false;
@@ -262,7 +279,25 @@ float MockHX711Driver::process_pulse_state(unsigned long now_ms, bool& pulse_flo
 }
 
 float MockHX711Driver::grams_per_sample() const {
-    return DEBUG_MOCK_FLOW_RATE_GPS / static_cast<float>(HW_LOADCELL_SAMPLE_RATE_SPS);
+    return model.flow_rate_gps / static_cast<float>(HW_LOADCELL_SAMPLE_RATE_SPS);
+}
+
+float MockHX711Driver::release_from_chute(float produced_g, unsigned long elapsed_ms) {
+    chute_mass_g += produced_g;
+
+    float excess = chute_mass_g - model.chute_retention_g;
+    if (excess <= 0.0f) {
+        return 0.0f;
+    }
+
+    float released = excess;
+    if (model.chute_release_ms > 0) {
+        float fraction = 1.0f - expf(-static_cast<float>(elapsed_ms) / static_cast<float>(model.chute_release_ms));
+        released = excess * fraction;
+    }
+
+    chute_mass_g -= released;
+    return released;
 }
 
 float MockHX711Driver::random_noise(float peak) const {
@@ -272,13 +307,17 @@ float MockHX711Driver::random_noise(float peak) const {
 #ifdef ESP_PLATFORM
     uint32_t value = esp_random();
 #else
-    uint32_t value = static_cast<uint32_t>(random());
+    // random() only yields 31 bits - combine two draws so the noise stays zero-mean
+    uint32_t value = (static_cast<uint32_t>(random()) << 16) ^ static_cast<uint32_t>(random());
 #endif
     const float normalized = static_cast<float>(value) / static_cast<float>(UINT32_MAX);
     return (normalized * 2.0f - 1.0f) * peak;
 }
 
 void MockHX711Driver::handle_grinder_start_request(unsigned long now_ms) {
+    if (sample_source && !continuous_commanded) {
+        sample_source->on_motor_start(now_ms);
+    }
     continuous_commanded = true;
     continuous_started = false;
     continuous_stop_pending = false;
@@ -287,6 +326,9 @@ void MockHX711Driver::handle_grinder_start_request(unsigned long now_ms) {
 }
 
 void MockHX711Driver::handle_grinder_stop_request(unsigned long now_ms) {
+    if (sample_source && continuous_commanded) {
+        sample_source->on_motor_stop(now_ms);
+    }
     if (!continuous_started) {
         continuous_commanded = false;
         continuous_stop_pending = false;
@@ -306,10 +348,16 @@ void MockHX711Driver::handle_pulse_request(unsigned long now_ms, uint32_t durati
     pulse_duration_ms = duration_ms;
     pulse_ramp_start_ms = now_ms;
 
+    if (sample_source) {
+        pulse_end_ms = now_ms + sample_source->on_pulse(now_ms, duration_ms);
+        return;
+    }
+
     // Only add mass if pulse duration exceeds motor latency threshold
     // This simulates the real motor behavior where short pulses don't produce grounds
-    if (static_cast<float>(duration_ms) >= DEBUG_MOCK_MOTOR_LATENCY_MS) {
-        pending_pulse_mass_g += DEBUG_MOCK_FLOW_RATE_GPS * (static_cast<float>(duration_ms - DEBUG_MOCK_MOTOR_LATENCY_MS) / 1000.0f);
+    float latency_ms = model.pulse_latency_ms + random_noise(model.pulse_latency_jitter_ms);
+    if (static_cast<float>(duration_ms) >= latency_ms) {
+        pending_pulse_mass_g += model.flow_rate_gps * ((static_cast<float>(duration_ms) - latency_ms) / 1000.0f);
     } else {
         // Pulse too short - no grounds will be produced
         pending_pulse_mass_g = 0.0f;
@@ -338,5 +386,30 @@ bool MockHX711Driver::is_pulse_active() {
     if (!instance) {
         return false;
     }
+    if (sample_source) {
+        return instance->pulse_command_active && static_cast<long>(millis() - instance->pulse_end_ms) < 0;
+    }
     return instance->pulse_command_active || instance->pulse_stop_pending || instance->pending_pulse_mass_g > 0.0001f;
 }
+
+void MockHX711Driver::set_model(const MockGrinderModel& new_model) {
+    model = new_model;
+}
+
+void MockHX711Driver::set_sample_source(MockSampleSource* source) {
+    sample_source = source;
+}
+
+float MockHX711Driver::get_cup_mass_g() {
+    return instance ? instance->simulated_mass_g : 0.0f;
+}
+
+float MockHX711Driver::get_chute_mass_g() {
+    return instance ? instance->chute_mass_g : 0.0f;
+}
+
+void MockHX711Driver::empty_cup() {
+    if (instance) {
+        instance->simulated_mass_g = 0.0f;
+    }
+}
@@ -4,6 +4,48 @@
 #include "../config/constants.h"
 #include <Arduino.h>
 
+/**
+ * Grinder and scale plant parameters used by MockHX711Driver. Defaults mirror the
+ * DEBUG_MOCK_* constants so firmware mock builds behave as before; host
+ * simulations override them per run through MockHX711Driver::set_model().
+ *
+ * Chute retention: ground coffee first collects in the chute. Anything above
+ * chute_retention_g drains into the cup with time constant chute_release_ms, so
+ * retention absorbs the first grams of a cold grinder and the release lag adds
+ * a coast tail after the motor stops. Zero for both passes grounds straight through.
+ */
+struct MockGrinderModel {
+    float flow_rate_gps = DEBUG_MOCK_FLOW_RATE_GPS;          // Steady-state flow out of the burrs
+    float idle_noise_raw = DEBUG_MOCK_IDLE_NOISE_RAW;        // Peak raw noise with motor off (counts)
+    float grind_noise_raw = DEBUG_MOCK_GRIND_NOISE_RAW;      // Peak raw noise with motor on (counts)
+    uint32_t flow_ramp_ms = DEBUG_MOCK_FLOW_RAMP_MS;         // Flow ramp up after start and down after stop
+    uint32_t start_delay_ms = DEBUG_MOCK_START_DELAY_MS;     // Motor start command to first grounds
+    uint32_t stop_delay_ms = DEBUG_MOCK_STOP_DELAY_MS;       // Motor stop command to flow end (coast)
+    float pulse_latency_ms = DEBUG_MOCK_MOTOR_LATENCY_MS;    // Pulses shorter than this produce no grounds
+    float pulse_latency_jitter_ms = 0.0f;                    // Peak pulse-to-pulse variation of that latency
+    float chute_retention_g = 0.0f;                          // Grounds held back in the chute
+    uint32_t chute_release_ms = 0;                           // Chute drain time constant (0 = instant)
+};
+
+/**
+ * Recorded load cell samples played back in place of the plant model (host session
+ * replay). The driver passes the motor commands on so the source can line the
+ * recording up with them; samples are raw ADC counts, so the scale's tare and
+ * filters see the recorded values rather than a conversion from grams.
+ */
+class MockSampleSource {
+public:
+    virtual ~MockSampleSource() = default;
+
+    virtual void on_motor_start(unsigned long now_ms) = 0;
+    virtual void on_motor_stop(unsigned long now_ms) = 0;
+    // Returns how long the pulse reports active (is_pulse_active())
+    virtual uint32_t on_pulse(unsigned long now_ms, uint32_t duration_ms) = 0;
+
+    virtual bool sample_due(unsigned long now_ms) const = 0;
+    virtual int32_t take_sample(unsigned long now_ms) = 0;
+};
+
 /**
  * MockHX711Driver provides a compile-time selectable simulated implementation of
  * the HX711 ADC. It generates synthetic raw ADC readings with configurable flow
@@ -41,8 +83,21 @@ public:
     static void notify_pulse(uint32_t duration_ms);
     static bool is_pulse_active();
 
+    // Plant model configuration and ground truth for host simulations
+    static void set_model(const MockGrinderModel& new_model);
+    static const MockGrinderModel& get_model() { return model; }
+    static float get_cup_mass_g();                 // Grounds actually in the cup
+    static float get_chute_mass_g();               // Grounds still held in the chute
+    static void empty_cup();                       // User removed and emptied the cup
+
+    // Playback instead of the plant model (nullptr = plant model). Pulses end when the
+    // source says, rather than when their grounds have landed.
+    static void set_sample_source(MockSampleSource* source);
+
 private:
     static MockHX711Driver* instance;
+    static MockGrinderModel model;
+    static MockSampleSource* sample_source;
 
     // Internal helpers
     void reset_state();
@@ -50,6 +105,7 @@ private:
     float process_continuous_state(unsigned long now_ms, bool& continuous_flow);
     float process_pulse_state(unsigned long now_ms, bool& pulse_flow);
     float grams_per_sample() const;
+    float release_from_chute(float produced_g, unsigned long elapsed_ms);
     float random_noise(float peak) const;
 
     void handle_grinder_start_request(unsigned long now_ms);
@@ -62,6 +118,7 @@ private:
     unsigned long next_sample_due_ms;
 
     float simulated_mass_g;
+    float chute_mass_g;
     float pending_pulse_mass_g;
 
     bool data_ready_flag;
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * SpscRing - Lock-free single-producer / single-consumer ring buffer
+ *
+ * One side only calls push(), the other only pop(); neither blocks or takes a lock,
+ * so the producer may run in an interrupt or a higher-priority task. Capacity must
+ * be a power of two; head/tail are free-running counters, so all slots are usable.
+ */
+template <typename T, uint16_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    // Producer side - returns false (and drops the item) when full
+    bool push(const T& item) {
+        uint16_t write = head.load(std::memory_order_relaxed);
+        if ((uint16_t)(write - tail.load(std::memory_order_acquire)) >= Capacity) {
+            return false;
+        }
+        items[write & (Capacity - 1)] = item;
+        head.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side - returns false when empty
+    bool pop(T* item_out) {
+        uint16_t read = tail.load(std::memory_order_relaxed);
+        if (read == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *item_out = items[read & (Capacity - 1)];
+        tail.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint16_t size() const {
+        return (uint16_t)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+    }
+    bool empty() const { return size() == 0; }
+
+    // Only safe while neither side is running
+    void reset() {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    T items[Capacity];
+    std::atomic<uint16_t> head;   // Next slot to write (producer owned)
+    std::atomic<uint16_t> tail;   // Next slot to read (consumer owned)
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "circular_buffer_math/settling_detector.h"
+#include "circular_buffer_math/weight_flow_estimator.h"
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * WeightSnapshot - values derived from one load cell sample, published for other tasks
+ *
+ * The Core 0 sampling task fills a snapshot after every sample it feeds into the filter.
+ * UI, BLE and diagnostics code on Core 1 read the snapshot instead of walking the
+ * CircularBufferMath buffer while Core 0 writes to it, and the stateful display filter
+ * runs once per sample on its single owner instead of once per reader.
+ *
+ * Grind control reads the sequential settling state and the weight/flow estimate from the
+ * snapshot too (the detectors have a single owner, the sampling task). For weight windows
+ * and flow rates it still queries the filter directly - it needs windows the snapshot does
+ * not carry.
+ */
+struct WeightSnapshot {
+    uint32_t sequence;            // Samples published since boot, 0 = no sample yet
+    uint32_t sample_time_ms;      // millis() time of the sample
+    int32_t raw_instant;          // Latest raw ADC reading
+    int sample_count;             // Samples held by the filter
+    uint32_t buffer_span_ms;      // Time covered by the held samples
+
+    float instant_weight;         // Latest sample in grams
+    float low_latency_weight;     // 100ms window
+    float display_weight;         // 300ms window + asymmetric display filter, clamped around zero
+    float high_latency_weight;    // 300ms window
+    float flow_rate;              // g/s over the default 200ms window
+    float std_dev_g;              // Precision settling window (500ms)
+    float std_dev_raw;
+    bool settled;                 // is_settled() over the precision settling window
+    uint32_t last_activity_ms;    // Last time the reading moved USER_WEIGHT_ACTIVITY_THRESHOLD_G, 0 = never
+
+    // Rise over the auto-start trigger window (settling + trigger window)
+    bool rise_valid;
+    float rise_delta_g;
+    int rise_samples;
+    uint32_t rise_span_ms;
+
+    SettlingEstimate settling;    // Sequential settling detector fed with instant_weight
+    WeightFlowEstimator::Estimate estimate;   // Kalman weight/flow fed with instant_weight and the motor state
+};
+
+/**
+ * Single-writer, double-buffered seqlock around a WeightSnapshot. publish() writes the
+ * buffer readers are not pointed at, so a reader never waits for a publish in progress -
+ * even one whose task was suspended midway - and copies the last complete snapshot.
+ * A copy is only retried when the writer has started on its buffer again meanwhile (the
+ * reader was preempted for a whole sample interval), at most READ_ATTEMPTS times before the
+ * latest copy is returned as is.
+ */
+class WeightSnapshotPublisher {
+public:
+    static constexpr int READ_ATTEMPTS = 4;
+
+    WeightSnapshotPublisher() : started(0), published(0), buffers() {}
+
+    void publish(const WeightSnapshot& next) {
+        uint32_t count = published.load(std::memory_order_relaxed) + 1;
+        started.store(count, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        buffers[count & 1u] = next;
+        std::atomic_thread_fence(std::memory_order_release);
+        published.store(count, std::memory_order_relaxed);
+    }
+
+    WeightSnapshot read() const {
+        WeightSnapshot copy;
+        for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+            uint32_t count = published.load(std::memory_order_acquire);
+            copy = buffers[count & 1u];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (started.load(std::memory_order_relaxed) - count < 2) {
+                break;  // The writer has not reused this buffer
+            }
+        }
+        return copy;
+    }
+
+private:
+    std::atomic<uint32_t> started;    // Publishes begun; buffers[started & 1] may be mid-write
+    std::atomic<uint32_t> published;  // Publishes completed; buffers[published & 1] is the latest
+    WeightSnapshot buffers[2];
+};
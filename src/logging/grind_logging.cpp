@@ -1,4 +1,5 @@
 #include "grind_logging.h"
+#include "session_codec.h"
 #include <LittleFS.h>
 #include <esp_heap_caps.h>
 #include <esp_log.h>
@@ -6,6 +7,7 @@
 #include "../hardware/grinder.h"
 #include "../config/constants.h"
 #include "../system/statistics_manager.h"
+#include "../system/crc32.h"
 
 namespace {
 
@@ -30,37 +32,85 @@ GrindTerminationReason classify_termination_reason(const char* final_result) {
     return GrindTerminationReason::UNKNOWN;
 }
 
+bool is_logging_enabled() {
+    Preferences logging_prefs;
+    logging_prefs.begin("logging", true); // read-only
+    bool enabled = logging_prefs.getBool("enabled", false);
+    logging_prefs.end();
+    return enabled;
+}
+
+// Sizing pass: the header records the block sizes and the CRC before the blocks are written
+class ChecksumSink : public SessionBlockSink {
+public:
+    bool write(const uint8_t* data, size_t length) override {
+        crc_ = crc32_update(crc_, data, length);
+        return true;
+    }
+
+    uint32_t crc() const { return crc_; }
+
+private:
+    uint32_t crc_ = 0;
+};
+
+// Batches the encoder's byte-sized writes into fewer LittleFS calls
+class FileSink : public SessionBlockSink {
+public:
+    explicit FileSink(File& file) : file_(file), used_(0) {}
+
+    bool write(const uint8_t* data, size_t length) override {
+        if (used_ + length > sizeof(buffer_) && !flush()) {
+            return false;
+        }
+        memcpy(buffer_ + used_, data, length);
+        used_ += length;
+        return true;
+    }
+
+    bool flush() {
+        if (used_ > 0 && file_.write(buffer_, used_) != used_) {
+            return false;
+        }
+        used_ = 0;
+        return true;
+    }
+
+private:
+    File& file_;
+    uint8_t buffer_[256];
+    size_t used_;
+};
+
 }
 
 GrindLogger grind_logger;
 
+uint32_t session_file_checksum(uint32_t body_crc, const TimeSeriesSessionHeader& header) {
+    TimeSeriesSessionHeader unsigned_header = header;
+    unsigned_header.checksum = 0;
+    return crc32_update(body_crc, &unsigned_header, sizeof(unsigned_header));
+}
+
 bool GrindLogger::init(Preferences* prefs) {
     _preferences = prefs;
-    current_session = (GrindSession*)heap_caps_malloc(sizeof(GrindSession), MALLOC_CAP_SPIRAM);
-    if (!current_session) {
-        LOG_BLE("ERROR: Failed to allocate PSRAM for grind session\n");
-        return false;
-    }
-    
-    event_buffer = (GrindEvent*)heap_caps_malloc(sizeof(GrindEvent) * EVENT_TEMP_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
-    if (!event_buffer) {
-        LOG_BLE("ERROR: Failed to allocate PSRAM for grind events\n");
-        heap_caps_free(current_session);
-        return false;
-    }
-    
-    measurement_buffer = (GrindMeasurement*)heap_caps_malloc(sizeof(GrindMeasurement) * MEASUREMENT_TEMP_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
-    if (!measurement_buffer) {
-        LOG_BLE("ERROR: Failed to allocate PSRAM for grind measurements\n");
-        heap_caps_free(current_session);
-        heap_caps_free(event_buffer);
-        return false;
+    for (int i = 0; i < SESSION_SLOT_COUNT; i++) {
+        SessionSlot& slot = slots[i];
+        slot.session = (GrindSession*)heap_caps_malloc(sizeof(GrindSession), MALLOC_CAP_SPIRAM);
+        slot.events = (GrindEvent*)heap_caps_malloc(sizeof(GrindEvent) * EVENT_TEMP_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+        slot.measurements = (GrindMeasurement*)heap_caps_malloc(sizeof(GrindMeasurement) * MEASUREMENT_TEMP_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+        if (!slot.session || !slot.events || !slot.measurements) {
+            LOG_BLE("ERROR: Failed to allocate PSRAM for grind session slot %d\n", i);
+            cleanup();
+            return false;
+        }
+        memset(slot.session, 0, sizeof(GrindSession));
+        clear_slot(slot);
+        slot.state = SLOT_FREE;
     }
-    
-    event_count = 0;
-    measurement_count = 0;
-    event_sequence_counter = 0;
-    logging_active = false;
+    active_slot = -1;
+    last_started_slot = -1;
+    slot_stalls = 0;
     
     // Load the next session ID from preferences
     _next_session_id = _preferences->getUInt("next_session_id", 1);
@@ -68,215 +118,465 @@ bool GrindLogger::init(Preferences* prefs) {
     LOG_BLE("Time-series Logger initialized:\n");
     LOG_BLE("  - Event Buffer: %lu KB (%d events)\n", (unsigned long)((sizeof(GrindEvent) * EVENT_TEMP_BUFFER_SIZE) / 1024), (int)EVENT_TEMP_BUFFER_SIZE);
     LOG_BLE("  - Measurement Buffer: %lu KB (%d measurements)\n", (unsigned long)((sizeof(GrindMeasurement) * MEASUREMENT_TEMP_BUFFER_SIZE) / 1024), (int)MEASUREMENT_TEMP_BUFFER_SIZE);
+    LOG_BLE("  - Session slots: %d\n", SESSION_SLOT_COUNT);
     LOG_BLE("  - Next session ID: %lu\n", _next_session_id);
     
+    session_index.init(SESSION_INDEX_CAPACITY, _next_session_id - 1);
+    recover_session_journals();
+    
     return true;
 }
 
 void GrindLogger::cleanup() {
-    if (current_session) heap_caps_free(current_session);
-    if (event_buffer) heap_caps_free(event_buffer);
-    if (measurement_buffer) heap_caps_free(measurement_buffer);
+    active_slot = -1;
+    for (int i = 0; i < SESSION_SLOT_COUNT; i++) {
+        SessionSlot& slot = slots[i];
+        if (slot.session) heap_caps_free(slot.session);
+        if (slot.events) heap_caps_free(slot.events);
+        if (slot.measurements) heap_caps_free(slot.measurements);
+        slot.session = nullptr;
+        slot.events = nullptr;
+        slot.measurements = nullptr;
+        slot.state = SLOT_FREE;
+    }
 }
 
 void GrindLogger::start_grind_session(const GrindSessionDescriptor& descriptor, float start_weight) {
-    if (!current_session || !event_buffer || !measurement_buffer) {
+    if (!slots[0].session) {
         return;
     }
+    
+    // The previous session may still be logging until Core 1 handles its end request; it keeps its slot
+    int8_t previous = active_slot.exchange(-1);
+    if (previous >= 0) {
+        wait_for_slot_writer(previous);
+    }
+    
+    // Prefer the slot after the last one so the previous session's data stays readable
+    uint32_t now = millis();
+    int8_t index = -1;
+    for (int i = 1; i <= SESSION_SLOT_COUNT && index < 0; i++) {
+        int candidate = (last_started_slot + i + SESSION_SLOT_COUNT) % SESSION_SLOT_COUNT;
+        uint8_t state = slots[candidate].state.load();
+        if (state == SLOT_LOGGING && now - slots[candidate].start_time_ms > SESSION_SLOT_STALE_MS) {
+            // Never ended (dropped end request) - reclaim unless Core 1 is ending it right now
+            slots[candidate].state.compare_exchange_strong(state, SLOT_FREE);
+        }
+        if (slots[candidate].state.load() == SLOT_FREE) {
+            index = candidate;
+        }
+    }
+    if (index < 0) {
+        // Every slot is still logging or waiting on flash; grinding goes ahead unlogged
+        slot_stalls++;
+        LOG_BLE("WARNING: No free session slot, session not logged (%lu stalls)\n", (unsigned long)slot_stalls);
+        return;
+    }
+    
+    SessionSlot& slot = slots[index];
+    GrindSession* session = slot.session;
+    clear_slot(slot);
+    memset(session, 0, sizeof(GrindSession));
 
-    clear_buffers();
-    memset(current_session, 0, sizeof(GrindSession));
-
-    current_session->session_id = _next_session_id;
+    session->session_id = _next_session_id;
     _next_session_id++;
-    _preferences->putUInt("next_session_id", _next_session_id);
 
-    current_session->session_timestamp = millis() / 1000;
-    current_session->profile_id = descriptor.profile_id;
-    current_session->target_weight = descriptor.target_weight;
-    current_session->tolerance = descriptor.tolerance;
-    current_session->grind_mode = static_cast<uint8_t>(descriptor.mode);
-    current_session->target_time_ms = descriptor.target_time_ms;
-    current_session->start_weight = start_weight;
-    current_session->max_pulse_attempts = GRIND_MAX_PULSE_ATTEMPTS;
-    current_session->time_error_ms = 0;
-    current_session->total_time_ms = 0;
-    current_session->total_motor_on_time_ms = 0;
-    current_session->termination_reason = static_cast<uint8_t>(GrindTerminationReason::UNKNOWN);
-
-    initialize_session_config();
-
-    logging_active = true;
-    session_start_time = millis();
-
-    // Initialize motor time tracking
-    last_motor_state = false;
-    motor_start_time = 0;
-    total_motor_time_ms = 0;
+    session->session_timestamp = millis() / 1000;
+    session->profile_id = descriptor.profile_id;
+    session->target_weight = descriptor.target_weight;
+    session->tolerance = descriptor.tolerance;
+    session->grind_mode = static_cast<uint8_t>(descriptor.mode);
+    session->target_time_ms = descriptor.target_time_ms;
+    session->start_weight = start_weight;
+    session->max_pulse_attempts = GRIND_MAX_PULSE_ATTEMPTS;
+    session->time_error_ms = 0;
+    session->total_time_ms = 0;
+    session->total_motor_on_time_ms = 0;
+    session->termination_reason = static_cast<uint8_t>(GrindTerminationReason::UNKNOWN);
+
+    initialize_session_config(*session);
+
+    slot.start_time_ms = now;
+    slot.state = SLOT_LOGGING;
+    last_started_slot = index;
+    active_slot = index;
+    
+    // Core 0 measurements are dropped until the slot is active, so the NVS write comes after
+    _preferences->putUInt("next_session_id", _next_session_id);
 
     const char* mode_name = (descriptor.mode == GrindMode::TIME) ? "TIME" : "WEIGHT";
     if (descriptor.mode == GrindMode::TIME) {
         LOG_BLE("Started time-series session %lu: mode=%s, target_time=%lums, profile=%d\n",
-                current_session->session_id,
+                session->session_id,
                 mode_name,
                 static_cast<unsigned long>(descriptor.target_time_ms),
                 descriptor.profile_id);
     } else {
         LOG_BLE("Started time-series session %lu: mode=%s, target=%.1fg, profile=%d\n",
-                current_session->session_id,
+                session->session_id,
                 mode_name,
                 descriptor.target_weight,
                 descriptor.profile_id);
     }
 }
 
+namespace {
 
-void GrindLogger::end_grind_session(const char* final_result, float final_weight, uint8_t pulse_count) {
-    if (!current_session || !logging_active) {
-        return;
+void log_session_end(const GrindSession& session, const char* disposition) {
+    if (static_cast<GrindMode>(session.grind_mode) == GrindMode::TIME) {
+        LOG_BLE("Ended session %lu: mode=TIME, final=%.1fg, time_error=%+ldms, %s (%s)\n",
+                session.session_id,
+                session.final_weight,
+                static_cast<long>(session.time_error_ms),
+                session.result_status,
+                disposition);
+    } else {
+        LOG_BLE("Ended session %lu: mode=WEIGHT, final=%.1fg, error=%+.2fg, %s (%s)\n",
+                session.session_id,
+                session.final_weight,
+                session.error_grams,
+                session.result_status,
+                disposition);
     }
+}
 
-    current_session->final_weight = final_weight;
-    current_session->error_grams = current_session->target_weight - final_weight;
-    current_session->total_time_ms = millis() - session_start_time;
-    current_session->pulse_count = pulse_count;
-    strncpy(current_session->result_status, final_result, sizeof(current_session->result_status) - 1);
+}
+
+void GrindLogger::end_grind_session(const char* final_result, float final_weight, uint8_t pulse_count, uint32_t session_id) {
+    int8_t index = -1;
+    if (session_id == 0) {
+        index = active_slot.load();
+    } else {
+        for (int i = 0; i < SESSION_SLOT_COUNT; i++) {
+            if (slots[i].session && slots[i].session->session_id == session_id) {
+                index = i;
+            }
+        }
+    }
+    
+    // Discarded (or never logged) sessions have nothing to end
+    uint8_t expected = SLOT_LOGGING;
+    if (index < 0 || !slots[index].state.compare_exchange_strong(expected, SLOT_ENDING)) {
+        return;
+    }
+    int8_t active = index;
+    active_slot.compare_exchange_strong(active, -1);
+    // Counts and motor tracking are only stable once a log call that saw the slot active has returned
+    wait_for_slot_writer(index);
+    
+    SessionSlot& slot = slots[index];
+    GrindSession* session = slot.session;
+    session->final_weight = final_weight;
+    session->error_grams = session->target_weight - final_weight;
+    session->total_time_ms = millis() - slot.start_time_ms;
+    session->pulse_count = pulse_count;
+    strncpy(session->result_status, final_result, sizeof(session->result_status) - 1);
 
     // Finalize motor time tracking - if motor is still on, count the final period
     uint32_t now = millis();
-    if (last_motor_state && motor_start_time > 0) {
-        total_motor_time_ms += (now - motor_start_time);
+    if (slot.last_motor_state && slot.motor_start_time > 0) {
+        slot.total_motor_time_ms += (now - slot.motor_start_time);
     }
-    current_session->total_motor_on_time_ms = total_motor_time_ms;
+    session->total_motor_on_time_ms = slot.total_motor_time_ms;
 
-    GrindMode mode = static_cast<GrindMode>(current_session->grind_mode);
+    GrindMode mode = static_cast<GrindMode>(session->grind_mode);
     if (mode == GrindMode::TIME) {
-        current_session->time_error_ms = static_cast<int32_t>(current_session->total_motor_on_time_ms) -
-                                         static_cast<int32_t>(current_session->target_time_ms);
+        session->time_error_ms = static_cast<int32_t>(session->total_motor_on_time_ms) -
+                                 static_cast<int32_t>(session->target_time_ms);
         // Weight error is not meaningful for time-based grinds
-        current_session->error_grams = 0.0f;
+        session->error_grams = 0.0f;
     } else {
-        current_session->time_error_ms = 0;
+        session->time_error_ms = 0;
     }
 
     GrindTerminationReason termination_reason = classify_termination_reason(final_result);
-    current_session->termination_reason = static_cast<uint8_t>(termination_reason);
+    session->termination_reason = static_cast<uint8_t>(termination_reason);
 
     // Only exclude cancelled sessions from saving (not failed grinds like timeout/overshoot)
-    bool is_cancelled = (strcmp(final_result, "STOPPED_BY_USER") == 0);
+    slot.save_requested = (strcmp(final_result, "STOPPED_BY_USER") != 0);
 
     // Only update statistics for successful grinds (completed within tolerance)
     // Failed grinds (timeout, overshoot) are saved for analysis but excluded from statistics
-    bool is_successful_grind = (termination_reason == GrindTerminationReason::COMPLETED ||
-                                termination_reason == GrindTerminationReason::MAX_PULSES);
+    slot.successful = (termination_reason == GrindTerminationReason::COMPLETED ||
+                       termination_reason == GrindTerminationReason::MAX_PULSES);
+
+    // Statistics and the file write happen in commit_pending_session(), on the committer task
+    slot.end_time_ms = now;
+    slot.state = SLOT_PENDING;
+}
 
-    if (is_successful_grind) {
-        bool is_weight_mode = (mode == GrindMode::WEIGHT);
+bool GrindLogger::commit_pending_session(SessionCommitResult* result) {
+    // Oldest pending session first, so files and the index stay in session order
+    int8_t index = -1;
+    for (int i = 0; i < SESSION_SLOT_COUNT; i++) {
+        if (slots[i].state.load() == SLOT_PENDING &&
+            (index < 0 || slots[i].session->session_id < slots[index].session->session_id)) {
+            index = i;
+        }
+    }
+    if (index < 0) {
+        return false;
+    }
+    
+    SessionSlot& slot = slots[index];
+    slot.state = SLOT_COMMITTING;
+    const GrindSession* session = slot.session;
+    uint32_t commit_start = millis();
+    
+    // Journal tail and END record - a few hundred bytes, after which the session survives a reset
+    if (slot.journal.is_open() && (slot.journal.session_id() != session->session_id || !slot.save_requested)) {
+        drop_journal(slot);
+    }
+    uint32_t journal_bytes = slot.journal.bytes_written();
+    bool durable = slot.journal.is_open() &&
+                   append_to_journal(slot, slot.event_count, slot.measurement_count) &&
+                   slot.journal.finish(*session);
+    uint32_t tail_bytes = durable ? slot.journal.bytes_written() - journal_bytes : 0;
+    uint32_t durable_end = millis();
+    
+    if (slot.successful) {
         statistics_manager.update_grind_session(
-            final_weight,
-            current_session->error_grams,
-            pulse_count,
-            is_weight_mode,
-            current_session->total_motor_on_time_ms
+            session->final_weight,
+            session->error_grams,
+            session->pulse_count,
+            static_cast<GrindMode>(session->grind_mode) == GrindMode::WEIGHT,
+            session->total_motor_on_time_ms
         );
     }
 
     // Check if logging is enabled before saving to flash
-    Preferences logging_prefs;
-    logging_prefs.begin("logging", true); // read-only
-    bool logging_enabled = logging_prefs.getBool("enabled", false);
-    logging_prefs.end();
+    bool logging_enabled = is_logging_enabled();
 
-    const char* mode_name = (mode == GrindMode::TIME) ? "TIME" : "WEIGHT";
-
-    if (!is_cancelled && logging_enabled) {
-        flush_session_to_flash();
-        if (mode == GrindMode::TIME) {
-            LOG_BLE("Ended session %lu: mode=%s, final=%.1fg, time_error=%+ldms, %s (saved)\n",
-                    current_session->session_id,
-                    mode_name,
-                    final_weight,
-                    static_cast<long>(current_session->time_error_ms),
-                    final_result);
-        } else {
-            LOG_BLE("Ended session %lu: mode=%s, final=%.1fg, error=%+.2fg, %s (saved)\n",
-                    current_session->session_id,
-                    mode_name,
-                    final_weight,
-                    current_session->error_grams,
-                    final_result);
+    bool saved = false;
+    if (!slot.save_requested) {
+        log_session_end(*session, "not saved - cancelled");
+    } else if (!logging_enabled) {
+        log_session_end(*session, "not saved - logging disabled");
+    } else {
+        saved = flush_session_to_flash(slot);
+        log_session_end(*session, saved ? "saved" : "save failed");
+    }
+    
+    // A journal whose session file failed to write is left for recovery at the next boot
+    if (durable && (saved || !logging_enabled)) {
+        SessionJournalWriter::remove(session->session_id);
+    }
+    
+    uint32_t commit_end = millis();
+    if (result) {
+        result->session_id = session->session_id;
+        result->latency_ms = commit_end - slot.end_time_ms;
+        result->duration_ms = commit_end - commit_start;
+        result->durable_ms = durable ? durable_end - slot.end_time_ms : 0;
+        result->journal_tail_bytes = tail_bytes;
+        result->saved = saved;
+    }
+    
+    // Contents stay readable through get_current_session() until the slot is reused
+    slot.state = SLOT_FREE;
+    return true;
+}
+
+void GrindLogger::write_session_journals() {
+    for (int i = 0; i < SESSION_SLOT_COUNT; i++) {
+        SessionSlot& slot = slots[i];
+        uint8_t state = slot.state.load();
+        if (state == SLOT_ENDING || state == SLOT_PENDING || state == SLOT_COMMITTING) {
+            continue;   // commit_pending_session() writes the tail
         }
-    } else if (!is_cancelled && !logging_enabled) {
-        if (mode == GrindMode::TIME) {
-            LOG_BLE("Ended session %lu: mode=%s, final=%.1fg, time_error=%+ldms, %s (not saved - logging disabled)\n",
-                    current_session->session_id,
-                    mode_name,
-                    final_weight,
-                    static_cast<long>(current_session->time_error_ms),
-                    final_result);
-        } else {
-            LOG_BLE("Ended session %lu: mode=%s, final=%.1fg, error=%+.2fg, %s (not saved - logging disabled)\n",
-                    current_session->session_id,
-                    mode_name,
-                    final_weight,
-                    current_session->error_grams,
-                    final_result);
+        
+        // A journal for a session that is no longer logging was discarded (or its slot reused)
+        uint32_t session_id = (state == SLOT_LOGGING) ? slot.session->session_id : 0;
+        if (slot.journal.is_open() && slot.journal.session_id() != session_id) {
+            drop_journal(slot);
         }
-    } else {
-        if (mode == GrindMode::TIME) {
-            LOG_BLE("Ended session %lu: mode=%s, final=%.1fg, time_error=%+ldms, %s (not saved - cancelled)\n",
-                    current_session->session_id,
-                    mode_name,
-                    final_weight,
-                    static_cast<long>(current_session->time_error_ms),
-                    final_result);
-        } else {
-            LOG_BLE("Ended session %lu: mode=%s, final=%.1fg, error=%+.2fg, %s (not saved - cancelled)\n",
-                    current_session->session_id,
-                    mode_name,
-                    final_weight,
-                    current_session->error_grams,
-                    final_result);
+        if (session_id == 0 || session_id == slot.journal_skipped_id) {
+            continue;
         }
+        
+        if (!slot.journal.is_open()) {
+            slot.journaled_events = 0;
+            slot.journaled_measurements = 0;
+            if (!is_logging_enabled() || !slot.journal.open(*slot.session)) {
+                slot.journal_skipped_id = session_id;
+                continue;
+            }
+        }
+        append_to_journal(slot, slot.published_events.load(), slot.published_measurements.load());
     }
+}
 
-    // Clear buffers to ensure clean state for next session
-    clear_buffers();
+bool GrindLogger::append_to_journal(SessionSlot& slot, uint16_t event_limit, uint16_t measurement_limit) {
+    bool ok = true;
+    if (event_limit > slot.journaled_events) {
+        ok = slot.journal.append_events(&slot.events[slot.journaled_events], event_limit - slot.journaled_events);
+        slot.journaled_events = event_limit;
+    }
+    while (ok && slot.journaled_measurements < measurement_limit) {
+        uint16_t count = min<uint16_t>(SESSION_JOURNAL_BLOCK_MEASUREMENTS, measurement_limit - slot.journaled_measurements);
+        ok = slot.journal.append_measurements(&slot.measurements[slot.journaled_measurements], count);
+        slot.journaled_measurements += count;
+    }
+    
+    if (!ok) {
+        // A journal with a gap would recover a misleading session; the PSRAM copy still gets saved
+        slot.journal_skipped_id = slot.journal.session_id();
+        drop_journal(slot);
+    }
+    return ok;
+}
 
-    logging_active = false;
+void GrindLogger::drop_journal(SessionSlot& slot) {
+    uint32_t session_id = slot.journal.session_id();
+    slot.journal.close();
+    SessionJournalWriter::remove(session_id);
 }
 
-void GrindLogger::discard_current_session() {
-    if (!current_session || !logging_active) return;
+void GrindLogger::recover_session_journals() {
+    File dir = LittleFS.open(SESSION_JOURNAL_DIR);
+    if (!dir || !dir.isDirectory()) {
+        return;
+    }
     
-    LOG_BLE("Discarded session %lu: target=%.1fg (not saved - cancelled)\n",
-                  current_session->session_id, current_session->target_weight);
+    // Collect first; files are rewritten and deleted below
+    uint32_t session_ids[SESSION_SLOT_COUNT * 2];
+    uint32_t found = 0;
+    File file = dir.openNextFile();
+    while (file) {
+        String filename = file.name();
+        int name_start = filename.lastIndexOf('/') + 1;
+        unsigned long session_id = 0;
+        if (sscanf(filename.c_str() + name_start, "session_%lu.jnl", &session_id) == 1 && session_id > 0) {
+            if (found < sizeof(session_ids) / sizeof(session_ids[0])) {
+                session_ids[found++] = session_id;
+            } else {
+                LOG_BLE("WARNING: Too many session journals, %s left for the next boot\n", filename.c_str());
+            }
+        }
+        file.close();
+        file = dir.openNextFile();
+    }
+    dir.close();
     
-    // Clear buffers to ensure clean state for next session
-    clear_buffers();
+    for (uint32_t i = 0; i < found; i++) {
+        recover_session_journal(session_ids[i]);
+    }
+}
+
+bool GrindLogger::recover_session_journal(uint32_t session_id) {
+    char path[64];
+    snprintf(path, sizeof(path), SESSION_JOURNAL_FORMAT, (unsigned long)session_id);
+    char session_path[64];
+    snprintf(session_path, sizeof(session_path), SESSION_FILE_FORMAT, (unsigned long)session_id);
+    
+    // Reset between the session file write and the journal delete - already recovered
+    if (LittleFS.exists(session_path)) {
+        LittleFS.remove(path);
+        return true;
+    }
     
-    logging_active = false;
+    // Staging slot 0 is free at boot
+    SessionSlot& slot = slots[0];
+    clear_slot(slot);
+    SessionJournalContents contents;
+    File file = LittleFS.open(path, "r");
+    bool readable = file && read_session_journal(file, slot.session, slot.events, EVENT_TEMP_BUFFER_SIZE,
+                                                 slot.measurements, MEASUREMENT_TEMP_BUFFER_SIZE, &contents);
+    if (file) {
+        file.close();
+    }
+    
+    bool recovered = false;
+    if (readable && contents.session_id == session_id && (contents.ended || contents.measurement_count > 0)) {
+        GrindSession* session = slot.session;
+        if (!contents.ended) {
+            // Interrupted mid-grind: summarise what reached the journal
+            const GrindMeasurement& first = slot.measurements[0];
+            const GrindMeasurement& last = slot.measurements[contents.measurement_count - 1];
+            uint32_t motor_on_ms = 0;
+            for (uint16_t i = 1; i < contents.measurement_count; i++) {
+                if (slot.measurements[i - 1].motor_is_on) {
+                    motor_on_ms += slot.measurements[i].timestamp_ms - slot.measurements[i - 1].timestamp_ms;
+                }
+            }
+            session->final_weight = last.weight_grams;
+            session->error_grams = session->target_weight - last.weight_grams;
+            session->total_time_ms = last.timestamp_ms - first.timestamp_ms;
+            session->total_motor_on_time_ms = motor_on_ms;
+            session->pulse_count = 0;
+            session->termination_reason = static_cast<uint8_t>(GrindTerminationReason::UNKNOWN);
+            memset(session->result_status, 0, sizeof(session->result_status));
+            strncpy(session->result_status, "INTERRUPTED", sizeof(session->result_status) - 1);
+        }
+        
+        recovered = ensure_sessions_directory_exists() &&
+                    write_individual_session_file(session_id, *session, slot.events, contents.event_count,
+                                                  slot.measurements, contents.measurement_count);
+        if (recovered) {
+            cleanup_old_session_files();
+            LOG_BLE("Recovered session %lu from its journal: %s, %u events, %u measurements\n",
+                    (unsigned long)session_id, contents.ended ? "ended" : "interrupted",
+                    contents.event_count, contents.measurement_count);
+        }
+    } else {
+        LOG_BLE("Discarded session journal %lu: nothing recoverable\n", (unsigned long)session_id);
+    }
+    
+    clear_slot(slot);
+    memset(slot.session, 0, sizeof(GrindSession));
+    
+    // Keep a journal whose session file could not be written, for the next boot
+    if (recovered || !readable || !(contents.ended || contents.measurement_count > 0)) {
+        LittleFS.remove(path);
+    }
+    return recovered;
+}
+
+void GrindLogger::discard_current_session() {
+    int8_t index = active_slot.exchange(-1);
+    if (index < 0) return;
+    // A log call that claimed the slot before the handoff may still be appending to it
+    wait_for_slot_writer(index);
+    
+    // end_grind_session() may have claimed it first; that session is committed as ended
+    uint8_t expected = SLOT_LOGGING;
+    if (slots[index].state.compare_exchange_strong(expected, SLOT_FREE)) {
+        LOG_BLE("Discarded session %lu: target=%.1fg (not saved - cancelled)\n",
+                      slots[index].session->session_id, slots[index].session->target_weight);
+    }
 }
 
 void GrindLogger::log_event(GrindEvent& event) {
-    if (!logging_active || event_count >= EVENT_TEMP_BUFFER_SIZE) {
+    int8_t index = claim_active_slot();
+    if (index < 0) {
+        return;
+    }
+    SessionSlot& slot = slots[index];
+    if (slot.event_count >= EVENT_TEMP_BUFFER_SIZE) {
+        writing_slot = -1;
         return;
     }
     // **FIX**: Assign a unique, sequential ID to the event before logging
-    if (current_session) {
-        GrindMode mode = static_cast<GrindMode>(current_session->grind_mode);
-        if (mode == GrindMode::TIME) {
-            event.event_flags |= GRIND_EVENT_FLAG_TIME_MODE;
-        }
+    GrindMode mode = static_cast<GrindMode>(slot.session->grind_mode);
+    if (mode == GrindMode::TIME) {
+        event.event_flags |= GRIND_EVENT_FLAG_TIME_MODE;
     }
-    event.event_sequence_id = event_sequence_counter++;
-    event_buffer[event_count++] = event;
+    event.event_sequence_id = slot.event_sequence_counter++;
+    slot.events[slot.event_count++] = event;
+    slot.published_events.store(slot.event_count);
+    writing_slot = -1;
 }
 
 void GrindLogger::log_continuous_measurement(uint32_t timestamp_ms, float weight_grams, float weight_delta, 
                                             float flow_rate_g_per_s, uint8_t motor_is_on, uint8_t phase_id, 
                                             float motor_stop_target_weight) {
-    if (!logging_active || measurement_count >= MEASUREMENT_TEMP_BUFFER_SIZE) {
+    int8_t index = claim_active_slot();
+    if (index < 0) {
+        return;
+    }
+    SessionSlot& slot = slots[index];
+    if (slot.measurement_count >= MEASUREMENT_TEMP_BUFFER_SIZE) {
+        writing_slot = -1;
         return;
     }
     
@@ -287,29 +587,29 @@ void GrindLogger::log_continuous_measurement(uint32_t timestamp_ms, float weight
     measurement.weight_delta = weight_delta;
     measurement.flow_rate_g_per_s = flow_rate_g_per_s;
     measurement.motor_stop_target_weight = motor_stop_target_weight;
-    measurement.sequence_id = measurement_sequence_counter++;
+    measurement.sequence_id = slot.measurement_sequence_counter++;
     measurement.motor_is_on = motor_is_on;
     measurement.phase_id = phase_id;
     
     // Track motor time changes for session summary
     bool current_motor_state = (motor_is_on == 1);
-    if (current_motor_state && !last_motor_state) {
+    if (current_motor_state && !slot.last_motor_state) {
         // Motor just turned ON
-        motor_start_time = millis();
-    } else if (!current_motor_state && last_motor_state && motor_start_time > 0) {
+        slot.motor_start_time = millis();
+    } else if (!current_motor_state && slot.last_motor_state && slot.motor_start_time > 0) {
         // Motor just turned OFF, accumulate the time
-        total_motor_time_ms += (millis() - motor_start_time);
+        slot.total_motor_time_ms += (millis() - slot.motor_start_time);
     }
-    last_motor_state = current_motor_state;
+    slot.last_motor_state = current_motor_state;
     
-    measurement_buffer[measurement_count++] = measurement;
+    slot.measurements[slot.measurement_count++] = measurement;
+    if (slot.measurement_count % SESSION_JOURNAL_BLOCK_MEASUREMENTS == 0) {
+        slot.published_measurements.store(slot.measurement_count);
+    }
+    writing_slot = -1;
 }
 
-bool GrindLogger::flush_session_to_flash() {
-    if (!current_session || !event_buffer || !measurement_buffer) {
-        return false;
-    }
-    
+bool GrindLogger::flush_session_to_flash(const SessionSlot& slot) {
     // Use new individual session file approach
     if (!ensure_sessions_directory_exists()) {
         LOG_BLE("ERROR: Failed to create sessions directory\n");
@@ -317,124 +617,54 @@ bool GrindLogger::flush_session_to_flash() {
     }
     
     // Write individual session file
-    bool success = write_individual_session_file(current_session->session_id, *current_session, event_buffer, measurement_buffer);
+    uint32_t session_id = slot.session->session_id;
+    bool success = write_individual_session_file(session_id, *slot.session, slot.events, slot.event_count,
+                                                 slot.measurements, slot.measurement_count);
     
     if (success) {
         // Clean up old session files to maintain the limit
         cleanup_old_session_files();
         
-        LOG_BLE("Session %lu flushed to individual file\n", current_session->session_id);
+        LOG_BLE("Session %lu flushed to individual file\n", session_id);
     } else {
-        LOG_BLE("ERROR: Failed to flush session %lu to file\n", current_session->session_id);
+        LOG_BLE("ERROR: Failed to flush session %lu to file\n", session_id);
     }
     
     return success;
 }
 
 uint32_t GrindLogger::count_sessions_in_flash() const {
-    uint32_t count = 0;
-    
-    // Count individual session files (new approach)
-    if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-        File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-        if (dir && dir.isDirectory()) {
-            File file = dir.openNextFile();
-            
-            while (file) {
-                String filename = file.name();
-                // Handle both base names and full paths
-                bool is_session_file = (filename.startsWith("session_") || filename.indexOf("/session_") != -1)
-                                       && filename.endsWith(".bin");
-                if (is_session_file) {
-                    count++;
-                }
-                file = dir.openNextFile();
-            }
-            
-            dir.close();
-        }
-    }
-    
-    return count;
+    return session_index.count();
 }
 
 uint32_t GrindLogger::count_total_events_in_flash() const {
-    uint32_t total_events = 0;
-    
-    // Count events from individual session files
-    if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-        File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-        if (dir && dir.isDirectory()) {
-            File file = dir.openNextFile();
-            
-            while (file) {
-                String filename = file.name();
-                bool is_session_file = (filename.startsWith("session_") || filename.indexOf("/session_") != -1)
-                                       && filename.endsWith(".bin");
-                if (is_session_file) {
-                    String full_path = filename.startsWith("/") ? filename : (String(GRIND_SESSIONS_DIR) + "/" + filename);
-                    File sessionFile = LittleFS.open(full_path.c_str(), "r");
-                    if (sessionFile) {
-                        TimeSeriesSessionHeader header;
-                        if (sessionFile.read((uint8_t*)&header, sizeof(header)) == sizeof(header)) {
-                            total_events += header.event_count;
-                        }
-                        sessionFile.close();
-                    }
-                }
-                file = dir.openNextFile();
-            }
-            
-            dir.close();
-        }
-    }
-    
-    return total_events;
+    return session_index.total_events();
 }
 
 uint32_t GrindLogger::count_total_measurements_in_flash() const {
-    uint32_t total_measurements = 0;
-    
-    // Count measurements from individual session files
-    if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-        File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-        if (dir && dir.isDirectory()) {
-            File file = dir.openNextFile();
-            
-            while (file) {
-                String filename = file.name();
-                bool is_session_file = (filename.startsWith("session_") || filename.indexOf("/session_") != -1)
-                                       && filename.endsWith(".bin");
-                if (is_session_file) {
-                    String full_path = filename.startsWith("/") ? filename : (String(GRIND_SESSIONS_DIR) + "/" + filename);
-                    File sessionFile = LittleFS.open(full_path.c_str(), "r");
-                    if (sessionFile) {
-                        TimeSeriesSessionHeader header;
-                        if (sessionFile.read((uint8_t*)&header, sizeof(header)) == sizeof(header)) {
-                            total_measurements += header.measurement_count;
-                        }
-                        sessionFile.close();
-                    }
-                }
-                file = dir.openNextFile();
-            }
-            
-            dir.close();
-        }
-    }
-    
-    return total_measurements;
+    return session_index.total_measurements();
+}
+
+uint32_t GrindLogger::get_session_ids(uint32_t* ids_out, uint32_t max_ids) const {
+    return session_index.get_ids(ids_out, max_ids);
+}
+
+uint32_t GrindLogger::get_recent_session_ids(uint32_t* ids_out, uint32_t max_ids) const {
+    return session_index.get_recent_ids(ids_out, max_ids);
 }
 
 void GrindLogger::send_current_session_via_serial() {
-    if (!current_session || !logging_active) {
+    int8_t index = active_slot.load();
+    if (index < 0) {
         LOG_BLE("No active session to display\n");
         return;
     }
     
-    LOG_BLE("\n=== Current Grind Session %lu ===\n", current_session->session_id);
-    LOG_BLE("Target: %.1fg, Profile: %d\n", current_session->target_weight, current_session->profile_id);
-    LOG_BLE("Events: %u/%d, Measurements: %u/%d\n", event_count, (int)EVENT_TEMP_BUFFER_SIZE, measurement_count, (int)MEASUREMENT_TEMP_BUFFER_SIZE);
+    const SessionSlot& slot = slots[index];
+    LOG_BLE("\n=== Current Grind Session %lu ===\n", slot.session->session_id);
+    LOG_BLE("Target: %.1fg, Profile: %d\n", slot.session->target_weight, slot.session->profile_id);
+    LOG_BLE("Events: %u/%d, Measurements: %u/%d\n", slot.event_count, (int)EVENT_TEMP_BUFFER_SIZE, slot.measurement_count, (int)MEASUREMENT_TEMP_BUFFER_SIZE);
+    LOG_BLE("Session slots in use: %u/%d\n", get_occupied_session_slots(), SESSION_SLOT_COUNT);
     LOG_BLE("=====================================\n");
 }
 
@@ -442,272 +672,77 @@ uint32_t GrindLogger::get_total_flash_sessions() const {
     return count_sessions_in_flash();
 }
 
-void GrindLogger::clear_buffers() {
-    event_count = 0;
-    measurement_count = 0;
-    event_sequence_counter = 0;
-    measurement_sequence_counter = 0;
-    if (event_buffer) memset(event_buffer, 0, sizeof(GrindEvent) * EVENT_TEMP_BUFFER_SIZE);
-    if (measurement_buffer) memset(measurement_buffer, 0, sizeof(GrindMeasurement) * MEASUREMENT_TEMP_BUFFER_SIZE);
+uint32_t GrindLogger::get_active_session_id() const {
+    int8_t index = active_slot.load();
+    return index >= 0 ? slots[index].session->session_id : 0;
 }
 
-void GrindLogger::initialize_session_config() {
-    if (!current_session) return;
-    current_session->initial_motor_stop_offset = GRIND_UNDERSHOOT_TARGET_G;
-    current_session->max_pulse_attempts = GRIND_MAX_PULSE_ATTEMPTS;
-    current_session->latency_to_coast_ratio = GRIND_LATENCY_TO_COAST_RATIO;
-    current_session->flow_rate_threshold = GRIND_FLOW_DETECTION_THRESHOLD_GPS;
-    // pulse_safety_factor_near_target field removed (was always 1.0f)
+const GrindSession* GrindLogger::get_current_session() const {
+    return last_started_slot >= 0 ? slots[last_started_slot].session : nullptr;
 }
 
-
-bool GrindLogger::write_time_series_session_to_flash(const GrindSession& session, const GrindEvent* events, const GrindMeasurement* measurements) {
-    File file = LittleFS.open(GRIND_LOG_FILE, "a");
-    if (!file) {
-        LOG_BLE("Failed to open log file for writing\n");
-        return false;
-    }
-    
-    TimeSeriesSessionHeader header;
-    header.session_id = session.session_id;
-    header.session_timestamp = session.session_timestamp;
-    header.session_size = sizeof(GrindSession) + (sizeof(GrindEvent) * event_count) + (sizeof(GrindMeasurement) * measurement_count);
-    header.checksum = calculate_checksum((const uint8_t*)&session, header.session_size);
-    header.event_count = event_count;
-    header.measurement_count = measurement_count;
-    header.schema_version = GRIND_LOG_SCHEMA_VERSION;
-    header.reserved = 0;
-
-    size_t written = 0;
-    written += file.write((uint8_t*)&header, sizeof(TimeSeriesSessionHeader));
-    written += file.write((uint8_t*)&session, sizeof(GrindSession));
-    written += file.write((uint8_t*)events, sizeof(GrindEvent) * event_count);
-    written += file.write((uint8_t*)measurements, sizeof(GrindMeasurement) * measurement_count);
-    
-    file.close();
-    
-    size_t expected = sizeof(TimeSeriesSessionHeader) + header.session_size;
-    if (written == expected) {
-        LOG_BLE("Wrote session %lu (%d events, %d measurements) to flash (%d bytes)\n", 
-                     session.session_id, event_count, measurement_count, written);
-        
-        return true;
-    } else {
-        LOG_BLE("Flash write error: wrote %d/%d bytes\n", written, expected);
-        return false;
+uint8_t GrindLogger::get_occupied_session_slots() const {
+    uint8_t occupied = 0;
+    for (int i = 0; i < SESSION_SLOT_COUNT; i++) {
+        if (slots[i].state.load() != SLOT_FREE) {
+            occupied++;
+        }
     }
+    return occupied;
 }
 
-
-
-static void write_uint32_le(uint8_t*& buffer, uint32_t value) {
-    *buffer++ = value & 0xFF;
-    *buffer++ = (value >> 8) & 0xFF;
-    *buffer++ = (value >> 16) & 0xFF;
-    *buffer++ = (value >> 24) & 0xFF;
-}
-
-static void write_uint16_le(uint8_t*& buffer, uint16_t value) {
-    *buffer++ = value & 0xFF;
-    *buffer++ = (value >> 8) & 0xFF;
+void GrindLogger::clear_slot(SessionSlot& slot) {
+    slot.event_count = 0;
+    slot.measurement_count = 0;
+    slot.event_sequence_counter = 0;
+    slot.measurement_sequence_counter = 0;
+    slot.last_motor_state = false;
+    slot.motor_start_time = 0;
+    slot.total_motor_time_ms = 0;
+    slot.start_time_ms = 0;
+    slot.end_time_ms = 0;
+    slot.save_requested = false;
+    slot.successful = false;
+    slot.published_events = 0;
+    slot.published_measurements = 0;
+    if (slot.events) memset(slot.events, 0, sizeof(GrindEvent) * EVENT_TEMP_BUFFER_SIZE);
+    if (slot.measurements) memset(slot.measurements, 0, sizeof(GrindMeasurement) * MEASUREMENT_TEMP_BUFFER_SIZE);
 }
 
-
-void GrindLogger::export_sessions_binary_chunk(uint8_t* buffer, size_t buffer_size,  
-                                               uint32_t start_pos, uint32_t* next_pos, size_t* actual_size) {
-    static File export_file;
-    static uint32_t total_sessions = 0;
-    static uint32_t session_idx = 0;
-    static uint32_t current_session_id = 0;
-    static uint32_t* session_list = nullptr;
-    static bool initialized = false;
-    static uint32_t event_idx = 0;
-    static uint32_t measurement_idx = 0;
-    static TimeSeriesSessionHeader current_header;
-    static GrindSession current_session_data;
-    static bool session_header_sent = false;
-
-    // Handle explicit cleanup call (buffer == nullptr or buffer_size == 0)
-    if (buffer == nullptr || buffer_size == 0) {
-        if (export_file) {
-            export_file.close();
-            LOG_DEBUG_PRINTLN("Forced closure of export file handle");
-        }
-        if (session_list) {
-            heap_caps_free(session_list);
-            session_list = nullptr;
-        }
-        initialized = false;
-        *actual_size = 0;
-        *next_pos = 0;
-        return;
+// Claim, then re-check: either Core 1 sees the claim and waits for it to be released,
+// or the slot was handed over first and this call logs nothing
+int8_t GrindLogger::claim_active_slot() {
+    int8_t index = active_slot.load();
+    if (index < 0) {
+        return -1;
     }
-
-    // Initialize session list on first call
-    if (start_pos == 0 || !initialized) {
-        if (export_file) export_file.close();
-        if (session_list) {
-            heap_caps_free(session_list);
-            session_list = nullptr;
-        }
-        
-        total_sessions = count_sessions_in_flash();
-        session_idx = 0;
-        current_session_id = 0;
-        event_idx = 0;
-        measurement_idx = 0;
-        session_header_sent = false;
-        initialized = false;
-        
-        if (total_sessions > 0) {
-            // Create list of available session IDs
-            session_list = (uint32_t*)heap_caps_malloc(total_sessions * sizeof(uint32_t), MALLOC_CAP_8BIT);
-            if (!session_list) {
-                LOG_BLE("ERROR: Failed to allocate session list memory\n");
-                *actual_size = 0;
-                *next_pos = 0;
-                return;
-            }
-            
-            // Collect valid session IDs from directory
-            uint32_t list_count = 0;
-            
-            // Try individual session files first (new approach)
-            if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-                File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-                if (dir && dir.isDirectory()) {
-                    File file = dir.openNextFile();
-                    while (file && list_count < total_sessions) {
-                        String filename = file.name();
-                        if (filename.startsWith("session_") && filename.endsWith(".bin")) {
-                            // Extract session ID from filename
-                            int start_pos = filename.indexOf('_') + 1;
-                            int end_pos = filename.lastIndexOf('.');
-                            if (start_pos > 0 && end_pos > start_pos) {
-                                uint32_t session_id = filename.substring(start_pos, end_pos).toInt();
-                                if (session_id > 0 && validate_session_file(session_id)) {
-                                    session_list[list_count++] = session_id;
-                                }
-                            }
-                        }
-                        file = dir.openNextFile();
-                    }
-                    dir.close();
-                }
-            }
-            
-            // Sort session IDs for consistent order
-            for (uint32_t i = 0; i < list_count - 1; i++) {
-                for (uint32_t j = i + 1; j < list_count; j++) {
-                    if (session_list[i] > session_list[j]) {
-                        uint32_t temp = session_list[i];
-                        session_list[i] = session_list[j];
-                        session_list[j] = temp;
-                    }
-                }
-            }
-            
-            total_sessions = list_count;
-            LOG_BLE("Export: Found %lu valid session files\n", total_sessions);
-        }
-        
-        initialized = true;
-        print_session_data_table();
-        LOG_GRIND_DEBUG("Starting export for Python data analysis\n");
-        print_struct_layout_debug();  // Print struct layout at start of export
+    writing_slot = index;
+    if (active_slot.load() != index) {
+        writing_slot = -1;
+        return -1;
     }
+    return index;
+}
 
-    if (session_idx >= total_sessions) {
-        if(export_file) export_file.close();
-        *actual_size = 0;
-        *next_pos = 0; // Signal completion
-        return;
-    }
-    
-    // Open current session file if not already open
-    if (!export_file && session_idx < total_sessions) {
-        current_session_id = session_list[session_idx];
-        char filename[64];
-        snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, current_session_id);
-        export_file = LittleFS.open(filename, "r");
-        if (!export_file) {
-            LOG_BLE("ERROR: Failed to open session file: %s\n", filename);
-            session_idx++; // Skip this session
-            *actual_size = 0;
-            *next_pos = start_pos + 1;
+void GrindLogger::wait_for_slot_writer(int8_t index) {
+    // A single append, unless the control task was preempted midway - sleep so it can finish
+    uint32_t start = millis();
+    while (writing_slot.load() == index) {
+        if (millis() - start >= SESSION_SLOT_WRITER_TIMEOUT_MS) {
+            LOG_BLE("WARNING: Session slot %d writer still active after %lums - continuing\n",
+                    index, (unsigned long)SESSION_SLOT_WRITER_TIMEOUT_MS);
             return;
         }
-        LOG_BLE("Export: Opened session file %lu\n", current_session_id);
-    }
-    
-    uint8_t* p = buffer;
-    size_t remaining_size = buffer_size;
-    
-    if (start_pos == 0) {
-        write_uint32_le(p, total_sessions);
-        remaining_size -= 4;
-    }
-    
-    while (remaining_size > 0 && session_idx < total_sessions) {
-        if (!session_header_sent) {
-            if (export_file.read((uint8_t*)&current_header, sizeof(current_header)) != sizeof(current_header) ||
-                export_file.read((uint8_t*)&current_session_data, sizeof(current_session_data)) != sizeof(current_session_data)) {
-                break; // Error reading file
-            }
-            event_idx = 0;
-            measurement_idx = 0;
-
-            // Send full GrindSession struct + event/measurement counts from header
-            const size_t session_data_size = sizeof(GrindSession) + 4; // +4 for event/measurement counts
-            if (remaining_size < session_data_size) break;
-
-            // First send the full GrindSession struct
-            memcpy(p, &current_session_data, sizeof(GrindSession));
-            p += sizeof(GrindSession);
-            
-            // Then append event_count and measurement_count from header
-            write_uint16_le(p, current_header.event_count);
-            write_uint16_le(p, current_header.measurement_count);
-            
-            remaining_size -= session_data_size;
-            session_header_sent = true;
-        }
-
-        // Write events
-        while(event_idx < current_header.event_count && remaining_size >= sizeof(GrindEvent)) {
-            export_file.read(p, sizeof(GrindEvent));
-            p += sizeof(GrindEvent);
-            remaining_size -= sizeof(GrindEvent);
-            event_idx++;
-        }
-
-        // Write measurements
-        while(measurement_idx < current_header.measurement_count && remaining_size >= sizeof(GrindMeasurement)) {
-            export_file.read(p, sizeof(GrindMeasurement));
-            p += sizeof(GrindMeasurement);
-            remaining_size -= sizeof(GrindMeasurement);
-            measurement_idx++;
-        }
-
-        // If session is fully sent, move to the next one
-        if (event_idx >= current_header.event_count && measurement_idx >= current_header.measurement_count) {
-            session_idx++;
-            session_header_sent = false;
-            event_idx = 0;
-            measurement_idx = 0;
-            // Close current session file
-            if (export_file) {
-                export_file.close();
-                LOG_BLE("Export: Completed session %lu\n", current_session_id);
-            }
-        } else {
-            // Buffer is full, break to send chunk
-            break;
-        }
+        vTaskDelay(1);
     }
+}
 
-    *actual_size = p - buffer;
-    *next_pos = (session_idx >= total_sessions) ? 0 : start_pos + 1;
+void GrindLogger::initialize_session_config(GrindSession& session) {
+    session.initial_motor_stop_offset = GRIND_UNDERSHOOT_TARGET_G;
+    session.max_pulse_attempts = GRIND_MAX_PULSE_ATTEMPTS;
+    session.latency_to_coast_ratio = GRIND_LATENCY_TO_COAST_RATIO;
+    session.flow_rate_threshold = GRIND_FLOW_DETECTION_THRESHOLD_GPS;
+    // pulse_safety_factor_near_target field removed (was always 1.0f)
 }
 
 
@@ -784,6 +819,9 @@ bool GrindLogger::rotate_flash_log_if_needed() { return true; }
 bool GrindLogger::clear_all_sessions_from_flash() {
     LOG_BLE("Attempting to purge grind history from directory: %s\n", GRIND_SESSIONS_DIR);
  
+    // Drop the index first - if the purge is interrupted, the next boot rebuilds it from what is left
+    session_index.clear();
+ 
     File dir = LittleFS.open(GRIND_SESSIONS_DIR);
     if (!dir) {
         LOG_BLE("Directory does not exist. Nothing to clear.");
@@ -833,26 +871,13 @@ bool GrindLogger::clear_all_sessions_from_flash() {
         LOG_DEBUG_PRINTLN("Grind history purge completed successfully.");
     } else {
         LOG_DEBUG_PRINTLN("WARNING: Grind history purge completed with some errors.");
+        session_index.rebuild();
     }
  
     return overall_result;
 }
 
 bool GrindLogger::remove_oldest_sessions(uint32_t sessions_to_remove) { return true; }
-uint32_t GrindLogger::calculate_checksum(const uint8_t* data, size_t length) { return 0; }
-
-void GrindLogger::reset_export_static_variables() {
-    // This function forces reset of static variables in export_sessions_binary_chunk
-    // by calling it with dummy parameters to trigger the reset logic
-    uint8_t dummy_buffer[1];
-    uint32_t dummy_next_pos;
-    size_t dummy_size;
-    export_sessions_binary_chunk(dummy_buffer, 0, 0, &dummy_next_pos, &dummy_size);
-    
-    // Also explicitly force close any static file handles by calling with 0 buffer size
-    // This ensures the file is closed in the static variable cleanup
-    export_sessions_binary_chunk(nullptr, 0, 0, &dummy_next_pos, &dummy_size);
-}
 
 #if ENABLE_GRIND_DEBUG
 void GrindLogger::print_struct_layout_debug() {
@@ -876,7 +901,7 @@ void GrindLogger::print_struct_layout_debug() {
     LOG_BLE("event_count offset: %zu\n", (size_t)&hdr->event_count);
     LOG_BLE("measurement_count offset: %zu\n", (size_t)&hdr->measurement_count);
     LOG_BLE("schema_version offset: %zu\n", (size_t)&hdr->schema_version);
-    LOG_BLE("reserved offset: %zu\n", (size_t)&hdr->reserved);
+    LOG_BLE("flags offset: %zu\n", (size_t)&hdr->flags);
     
     // Yield to allow BLE transmission
     vTaskDelay(pdMS_TO_TICKS(10));
@@ -1086,11 +1111,16 @@ void GrindLogger::print_comprehensive_debug() {
         }
         LOG_BLE("\n");
         
-        // Read and dump events with full raw data
+        // Read and dump events
+        GrindEvent* events = (GrindEvent*)heap_caps_malloc(max<size_t>(1, header.event_count) * sizeof(GrindEvent), MALLOC_CAP_SPIRAM);
+        if (!events || !read_session_events(file, header, events)) {
+            LOG_BLE("Events: read failed\n");
+            if (events) heap_caps_free(events);
+            break;
+        }
         LOG_BLE("Events (showing first %d of %d):\n", min(MAX_EVENTS_PER_SESSION, (int)header.event_count), header.event_count);
         for (int i = 0; i < min(MAX_EVENTS_PER_SESSION, (int)header.event_count); i++) {
-            GrindEvent event;
-            if (file.read((uint8_t*)&event, sizeof(event)) != sizeof(event)) break;
+            const GrindEvent& event = events[i];
             
             LOG_BLE("  Event %d:\n", i);
             LOG_BLE("    timestamp_ms: %lu, phase_id: %u, pulse_attempt: %u\n", 
@@ -1099,44 +1129,36 @@ void GrindLogger::print_comprehensive_debug() {
                          event.event_sequence_id, event.duration_ms);
             LOG_BLE("    start_weight: %.3f, end_weight: %.3f\n", 
                          event.start_weight, event.end_weight);
-            
-            // Full raw dump of this event
-            LOG_BLE("    Raw bytes (%d total): ", sizeof(event));
-            uint8_t* event_bytes = (uint8_t*)&event;
-            for (int j = 0; j < sizeof(event); j++) {
-                LOG_BLE("%02X ", event_bytes[j]);
-            }
-            LOG_BLE("\n");
         }
+        heap_caps_free(events);
         
-        // Skip remaining events
-        int remaining_events = header.event_count - min(MAX_EVENTS_PER_SESSION, (int)header.event_count);
-        file.seek(file.position() + remaining_events * sizeof(GrindEvent));
-        
-        // Read and dump measurements with raw data
-        LOG_BLE("Measurements (showing first %d of %d):\n", min(MAX_MEASUREMENTS_PER_SESSION, (int)header.measurement_count), header.measurement_count);
-        for (int i = 0; i < min(MAX_MEASUREMENTS_PER_SESSION, (int)header.measurement_count); i++) {
-            GrindMeasurement meas;
-            if (file.read((uint8_t*)&meas, sizeof(meas)) != sizeof(meas)) break;
-            
-            LOG_BLE("  Measurement %d:\n", i);
-            LOG_BLE("    timestamp_ms: %lu, weight: %.3f, delta: %.3f\n", 
-                         meas.timestamp_ms, meas.weight_grams, meas.weight_delta);
-            LOG_BLE("    flow_rate: %.3f, motor_on: %u, phase_id: %u\n", 
-                         meas.flow_rate_g_per_s, meas.motor_is_on, meas.phase_id);
-            
-            // Raw dump of this measurement
-            LOG_BLE("    Raw bytes (%d total): ", sizeof(meas));
-            uint8_t* meas_bytes = (uint8_t*)&meas;
-            for (int j = 0; j < sizeof(meas); j++) {
-                LOG_BLE("%02X ", meas_bytes[j]);
+        // Decode the measurement block and dump the first few measurements (v2 files hold raw structs)
+        size_t block_size = file.size() - file.position();
+        if (header.schema_version < 3) {
+            LOG_BLE("Measurements: schema %u, not dumped\n", header.schema_version);
+            break;
+        }
+        uint8_t* block = (uint8_t*)heap_caps_malloc(block_size, MALLOC_CAP_SPIRAM);
+        GrindMeasurement* decoded = (GrindMeasurement*)heap_caps_malloc(
+            max<size_t>(1, header.measurement_count) * sizeof(GrindMeasurement), MALLOC_CAP_SPIRAM);
+        bool decoded_ok = block && decoded &&
+                          file.read(block, block_size) == block_size &&
+                          decode_measurement_block(block, block_size, header.measurement_count, decoded);
+        LOG_BLE("Measurement block: %u bytes for %u measurements (%s)\n",
+                (unsigned)block_size, header.measurement_count, decoded_ok ? "decoded" : "DECODE FAILED");
+        if (decoded_ok) {
+            LOG_BLE("Measurements (showing first %d of %d):\n", min(MAX_MEASUREMENTS_PER_SESSION, (int)header.measurement_count), header.measurement_count);
+            for (int i = 0; i < min(MAX_MEASUREMENTS_PER_SESSION, (int)header.measurement_count); i++) {
+                const GrindMeasurement& meas = decoded[i];
+                LOG_BLE("  Measurement %d:\n", i);
+                LOG_BLE("    timestamp_ms: %lu, weight: %.3f, delta: %.3f\n", 
+                             meas.timestamp_ms, meas.weight_grams, meas.weight_delta);
+                LOG_BLE("    flow_rate: %.3f, motor_on: %u, phase_id: %u\n", 
+                             meas.flow_rate_g_per_s, meas.motor_is_on, meas.phase_id);
             }
-            LOG_BLE("\n");
         }
-        
-        // Skip remaining measurements
-        int remaining_measurements = header.measurement_count - min(MAX_MEASUREMENTS_PER_SESSION, (int)header.measurement_count);
-        file.seek(file.position() + remaining_measurements * sizeof(GrindMeasurement));
+        if (block) heap_caps_free(block);
+        if (decoded) heap_caps_free(decoded);
         
                             session_count++;
                         }
@@ -1175,7 +1197,8 @@ bool GrindLogger::ensure_sessions_directory_exists() {
     return true;
 }
 
-bool GrindLogger::write_individual_session_file(uint32_t session_id, const GrindSession& session, const GrindEvent* events, const GrindMeasurement* measurements) {
+bool GrindLogger::write_individual_session_file(uint32_t session_id, const GrindSession& session, const GrindEvent* events, uint16_t event_count,
+                                               const GrindMeasurement* measurements, uint16_t measurement_count) {
     char filename[64];
     snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, session_id);
     
@@ -1185,9 +1208,12 @@ bool GrindLogger::write_individual_session_file(uint32_t session_id, const Grind
         return false;
     }
     
-    // Calculate sizes
-    size_t events_size = event_count * sizeof(GrindEvent);
-    size_t measurements_size = measurement_count * sizeof(GrindMeasurement);
+    // Calculate sizes and the CRC of everything after the header
+    ChecksumSink checksum;
+    checksum.write((const uint8_t*)&session, sizeof(session));
+    size_t events_size = encode_event_block(events, event_count, checksum);
+    float quantum_g = weight_quantum_g > 0.0f ? weight_quantum_g : SESSION_CODEC_WEIGHT_QUANTUM_G;
+    size_t measurements_size = encode_measurement_block(measurements, measurement_count, checksum, quantum_g);
     size_t total_data_size = sizeof(GrindSession) + events_size + measurements_size;
     
     // Create and write session header (for compatibility with existing parsing)
@@ -1195,17 +1221,20 @@ bool GrindLogger::write_individual_session_file(uint32_t session_id, const Grind
     header.session_id = session_id;
     header.session_timestamp = session.session_timestamp;
     header.session_size = total_data_size;
-    header.checksum = calculate_checksum((const uint8_t*)&session, total_data_size);
+    header.checksum = 0;
     header.event_count = event_count;
     header.measurement_count = measurement_count;
     header.schema_version = GRIND_LOG_SCHEMA_VERSION;
-    header.reserved = 0;
+    header.flags = SESSION_FLAG_CRC32;
+    header.checksum = session_file_checksum(checksum.crc(), header);
     
-    // Write header, session, events, and measurements
+    // Write header, session, events, and the measurement block
+    FileSink sink(file);
     if (file.write((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
         file.write((uint8_t*)&session, sizeof(session)) != sizeof(session) ||
-        (events_size > 0 && file.write((uint8_t*)events, events_size) != events_size) ||
-        (measurements_size > 0 && file.write((uint8_t*)measurements, measurements_size) != measurements_size)) {
+        encode_event_block(events, event_count, sink) != events_size ||
+        encode_measurement_block(measurements, measurement_count, sink, quantum_g) != measurements_size ||
+        !sink.flush()) {
         
         file.close();
         LittleFS.remove(filename); // Clean up partial file
@@ -1214,38 +1243,111 @@ bool GrindLogger::write_individual_session_file(uint32_t session_id, const Grind
     }
     
     file.close();
-    LOG_BLE("Successfully wrote session %lu to file (%zu bytes)\n", session_id, total_data_size + sizeof(header));
+    
+    SessionIndexEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.session_id = session_id;
+    entry.session_timestamp = header.session_timestamp;
+    entry.file_size = sizeof(header) + total_data_size;
+    entry.checksum = header.checksum;
+    entry.event_count = event_count;
+    entry.measurement_count = measurement_count;
+    entry.termination_reason = session.termination_reason;
+    entry.grind_mode = session.grind_mode;
+    entry.profile_id = session.profile_id;
+    entry.schema_version = (uint8_t)header.schema_version;
+    session_index.add(entry);
+    
+    LOG_BLE("Successfully wrote session %lu to file (%zu bytes: %u events in %zu, %u measurements in %zu)\n",
+            session_id, total_data_size + sizeof(header), event_count, events_size, measurement_count, measurements_size);
     return true;
 }
 
-bool GrindLogger::validate_session_file(uint32_t session_id) {
-    char filename[64];
-    snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, session_id);
-    
-    if (!LittleFS.exists(filename)) {
+bool GrindLogger::verify_session_file(File& file) {
+    TimeSeriesSessionHeader header;
+    if (!file.seek(0) || file.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) {
         return false;
     }
     
-    File file = LittleFS.open(filename, "r");
-    if (!file) {
-        return false;
+    bool ok = file.size() == sizeof(header) + header.session_size;
+    if (ok && (header.flags & SESSION_FLAG_CRC32)) {
+        uint8_t chunk[256];
+        uint32_t crc = 0;
+        size_t remaining = header.session_size;
+        while (ok && remaining > 0) {
+            size_t length = min(remaining, sizeof(chunk));
+            ok = file.read(chunk, length) == length;
+            crc = crc32_update(crc, chunk, length);
+            remaining -= length;
+        }
+        ok = ok && session_file_checksum(crc, header) == header.checksum;
     }
     
-    // Check basic file structure
-    TimeSeriesSessionHeader header;
-    if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) {
-        file.close();
+    return file.seek(0) && ok;
+}
+
+bool GrindLogger::read_session_events(File& file, const TimeSeriesSessionHeader& header, GrindEvent* events_out) {
+    if (header.event_count == 0) {
+        return true;
+    }
+    if (header.schema_version < 3) {
+        size_t events_size = header.event_count * sizeof(GrindEvent);
+        return file.read((uint8_t*)events_out, events_size) == events_size;
+    }
+    
+    // Encoded events have no stored length; read the worst case (or what is left) and decode from that
+    size_t start = file.position();
+    size_t read_size = min<size_t>(header.event_count * SESSION_CODEC_MAX_EVENT_SIZE, file.size() - start);
+    uint8_t* block = (uint8_t*)malloc(read_size);
+    if (!block) {
         return false;
     }
+    size_t consumed = 0;
+    bool ok = file.read(block, read_size) == read_size &&
+              decode_event_block(block, read_size, header.event_count, events_out, &consumed);
+    free(block);
     
-    // Basic validation: session_id should match filename and file size should be reasonable
-    if (header.session_id != session_id || header.session_size == 0 || header.session_size > 100000) {
+    // Leave the file at the measurement block
+    return ok && file.seek(start + consumed);
+}
+
+uint32_t GrindLogger::visit_recent_sessions(uint32_t max_sessions, SessionEventVisitor visitor, void* context) {
+    if (!visitor || !slots[0].events || get_occupied_session_slots() > 0 || max_sessions == 0) {
+        return 0;
+    }
+    GrindEvent* event_buffer = slots[0].events;
+    
+    uint32_t session_ids[MAX_STORED_SESSIONS_FLASH];
+    uint32_t found = session_index.get_recent_ids(session_ids, min<uint32_t>(max_sessions, MAX_STORED_SESSIONS_FLASH));
+    
+    uint32_t visited = 0;
+    for (uint32_t i = found; i > 0; i--) {
+        char filename[64];
+        snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, session_ids[i - 1]);
+        
+        File file = LittleFS.open(filename, "r");
+        if (!file) {
+            continue;
+        }
+        
+        TimeSeriesSessionHeader header;
+        GrindSession session;
+        bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                  header.session_id == session_ids[i - 1] &&
+                  header.event_count <= EVENT_TEMP_BUFFER_SIZE &&
+                  file.read((uint8_t*)&session, sizeof(GrindSession)) == sizeof(GrindSession) &&
+                  read_session_events(file, header, event_buffer);
         file.close();
-        return false;
+        
+        if (ok) {
+            visitor(session, event_buffer, header.event_count, context);
+            visited++;
+        }
     }
     
-    file.close();
-    return true;
+    // Leave the staging buffers as an idle logger expects them
+    clear_slot(slots[0]);
+    return visited;
 }
 
 bool GrindLogger::remove_session_file(uint32_t session_id) {
@@ -1265,57 +1367,19 @@ bool GrindLogger::remove_session_file(uint32_t session_id) {
 }
 
 void GrindLogger::cleanup_old_session_files() {
-    File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-    if (!dir || !dir.isDirectory()) {
-        LOG_BLE("WARNING: Cannot open sessions directory for cleanup.\n");
-        return;
-    }
-
-    // Step 1: Count files and collect session IDs
-    uint32_t session_count = 0;
-    File file = dir.openNextFile();
-    while (file) {
-        session_count++;
-        file = dir.openNextFile();
-    }
-    dir.close(); // Close after counting
-
-    if (session_count <= MAX_STORED_SESSIONS_FLASH) {
-        return; // No cleanup needed
-    }
-
-    LOG_BLE("Session count (%lu) exceeds limit (%d). Cleaning up old files...\n", session_count, MAX_STORED_SESSIONS_FLASH);
-
-    // Step 2: Create a list of session IDs
-    uint32_t* session_ids = (uint32_t*)malloc(session_count * sizeof(uint32_t));
-    if (!session_ids) {
-        LOG_BLE("ERROR: Failed to allocate memory for session ID list during cleanup.\n");
-        return;
-    }
-
-    dir = LittleFS.open(GRIND_SESSIONS_DIR);
-    uint32_t list_idx = 0;
-    file = dir.openNextFile();
-    while (file && list_idx < session_count) {
-        String filename = file.name();
-        int start_pos = filename.indexOf('_') + 1;
-        int end_pos = filename.lastIndexOf('.');
-        if (start_pos > 0 && end_pos > start_pos) {
-            session_ids[list_idx++] = filename.substring(start_pos, end_pos).toInt();
+    uint32_t removed = 0;
+    SessionIndexEntry oldest;
+    while (session_index.count() > MAX_STORED_SESSIONS_FLASH && session_index.get_oldest(&oldest)) {
+        // File first: a crash in between leaves an index entry the next boot drops
+        if (!remove_session_file(oldest.session_id)) {
+            break;
         }
-        file = dir.openNextFile();
+        session_index.remove(oldest.session_id);
+        removed++;
     }
-    dir.close();
-
-    // Step 3: Sort the session IDs in ascending order
-    std::sort(session_ids, session_ids + session_count);
-
-    // Step 4: Remove the oldest files
-    uint32_t files_to_remove = session_count - MAX_STORED_SESSIONS_FLASH;
-    for (uint32_t i = 0; i < files_to_remove; i++) {
-        remove_session_file(session_ids[i]);
+    
+    if (removed > 0) {
+        LOG_BLE("Cleanup complete. Removed %lu old session(s), %lu kept.\n",
+                (unsigned long)removed, (unsigned long)session_index.count());
     }
-
-    free(session_ids);
-    LOG_BLE("Cleanup complete. Removed %lu old session(s).\n", files_to_remove);
 }
@@ -1,8 +1,12 @@
 #pragma once
 #include <Arduino.h>
 #include <Preferences.h>
+#include <FS.h>
+#include <atomic>
 #include "../config/constants.h"
 #include "../controllers/grind_session.h"
+#include "session_index.h"
+#include "session_journal.h"
 
 // Forward declarations
 class WeightSensor;
@@ -22,28 +26,43 @@ class Grinder;
 #define EVENT_TEMP_BUFFER_SIZE MAX_EVENTS_PER_GRIND  
 #define MEASUREMENT_TEMP_BUFFER_SIZE MAX_MEASUREMENTS_PER_GRIND
 
+// Staging slots: one logs on Core 0 while the previous session is committed on Core 1
+#define SESSION_SLOT_COUNT 2
+#define SESSION_SLOT_STALE_MS (GRIND_TIMEOUT_SEC * 2000UL)   // Still logging this long after start: its end request was lost
+#define SESSION_SLOT_WRITER_TIMEOUT_MS 50                  // Longest wait for a Core 0 log call to leave a slot
+
 // Flash storage settings
 #define GRIND_SESSIONS_DIR "/sessions"                      // Directory for individual session files
 #define SESSION_FILE_FORMAT "/sessions/session_%lu.bin"    // Individual session file naming format
 #define GRIND_LOG_FILE "/grind_sessions.bin"                // Legacy single-file storage (deprecated)
-#define MAX_STORED_SESSIONS_FLASH 10                        // Maximum sessions to keep in flash (configurable)
+#define MAX_STORED_SESSIONS_FLASH 100                       // Maximum sessions to keep in flash (configurable)
+#define SESSION_INDEX_CAPACITY (MAX_STORED_SESSIONS_FLASH * 2)  // Index entries held in PSRAM (headroom for rebuilds)
 
 #pragma pack(push, 1)
 
-constexpr uint16_t GRIND_LOG_SCHEMA_VERSION = 2;
+// v3: measurements stored as a compressed column block (see session_codec.h) instead of raw structs
+constexpr uint16_t GRIND_LOG_SCHEMA_VERSION = 3;
 
 // Time-series session header for flash file
 struct TimeSeriesSessionHeader {
     uint32_t session_id;           // Session identifier
     uint32_t session_timestamp;    // Unix timestamp when session started
-    uint32_t session_size;         // Total size of session, events, and measurements in bytes
-    uint32_t checksum;             // Checksum of all data
+    uint32_t session_size;         // Bytes after this header: session, events and the measurement block
+    uint32_t checksum;             // session_file_checksum() when SESSION_FLAG_CRC32 is set, else 0
     uint16_t event_count;          // Number of discrete events in this session
     uint16_t measurement_count;    // Number of continuous measurements in this session
     uint16_t schema_version;       // Schema/version so Python tools can adapt
-    uint16_t reserved;             // Reserved for future use (alignment + versioned flags)
+    uint16_t flags;                // TimeSeriesSessionFlags (was reserved, always 0)
+};
+
+enum TimeSeriesSessionFlags : uint16_t {
+    SESSION_FLAG_CRC32 = 1 << 0    // checksum is valid; files without it predate the CRC
 };
 
+// CRC-32 (system/crc32.h) of everything after the header - session, events, measurements - continued
+// over the header itself with checksum set to 0. body_crc is the CRC of the bytes after the header.
+uint32_t session_file_checksum(uint32_t body_crc, const TimeSeriesSessionHeader& header);
+
 enum GrindEventFlags : uint8_t {
     GRIND_EVENT_FLAG_TIME_MODE   = 1 << 0,  // Event recorded while grinding by time
     GRIND_EVENT_FLAG_MOTOR_ACTIVE = 1 << 1, // Phase kept the motor running
@@ -73,7 +92,7 @@ struct GrindEvent {
     }
 };
 
-// Continuous, high-frequency time-series measurements.
+// Continuous, high-frequency time-series measurements. In-memory layout; stored column-encoded.
 struct GrindMeasurement {
     uint32_t timestamp_ms;            // Relative to session start
     float    weight_grams;            // Current weight reading
@@ -140,42 +159,99 @@ static_assert(sizeof(GrindEvent) == 44, "Unexpected GrindEvent size");
 static_assert(sizeof(GrindMeasurement) == 24, "Unexpected GrindMeasurement size");
 static_assert(sizeof(GrindSession) == 80, "Unexpected GrindSession size");
 
+// Outcome of GrindLogger::commit_pending_session(), for FileIOTask statistics
+struct SessionCommitResult {
+    uint32_t session_id;
+    uint32_t latency_ms;           // From end_grind_session() until the commit finished
+    uint32_t duration_ms;          // Statistics update and file write
+    uint32_t durable_ms;           // From end_grind_session() until the journal END record was on flash (0 if not journaled)
+    uint32_t journal_tail_bytes;   // Journal bytes written at commit (remaining blocks and END record)
+    bool saved;                    // Written to flash (not cancelled, logging enabled, write succeeded)
+};
+
+// Callback for GrindLogger::visit_recent_sessions()
+typedef void (*SessionEventVisitor)(const GrindSession& session, const GrindEvent* events,
+                                    uint16_t event_count, void* context);
+
 // Time-series grind logging manager
 class GrindLogger {
 private:
-    // Time-series system
-    GrindSession* current_session;           // Current session metadata (PSRAM)
-    GrindEvent* event_buffer;                // PSRAM temp buffer for events
-    GrindMeasurement* measurement_buffer;    // PSRAM temp buffer for measurements
-    uint16_t event_count;                    // Current number of events in buffer
-    uint16_t measurement_count;              // Current number of measurements in buffer
-    uint16_t event_sequence_counter;         // **NEW**: Counter for unique event IDs
-    uint16_t measurement_sequence_counter;   // Sequence counter for continuous measurements
+    // One staged session. Core 0 owns a LOGGING slot, Core 1 owns ENDING, PENDING and COMMITTING slots;
+    // the state handoff, after Core 0 has left the slot (writing_slot), orders the buffer
+    // contents between the cores.
+    enum SlotState : uint8_t {
+        SLOT_FREE,
+        SLOT_LOGGING,       // Receiving events and measurements
+        SLOT_ENDING,        // Being finalized by end_grind_session()
+        SLOT_PENDING,       // Ended, waiting for the committer
+        SLOT_COMMITTING     // Being written to flash
+    };
     
-    char current_phase_name[16];             // Current grinding phase name
-    bool logging_active;                     // Whether a grind session is active
+    struct SessionSlot {
+        GrindSession* session = nullptr;         // Session metadata (PSRAM)
+        GrindEvent* events = nullptr;            // PSRAM buffer for events
+        GrindMeasurement* measurements = nullptr; // PSRAM buffer for measurements
+        uint16_t event_count;
+        uint16_t measurement_count;
+        uint16_t event_sequence_counter;         // Unique event IDs within the session
+        uint16_t measurement_sequence_counter;   // Sequence counter for continuous measurements
+        
+        // Motor time tracking
+        bool last_motor_state;                   // Previous motor state for change detection
+        uint32_t motor_start_time;               // When motor last turned on
+        uint32_t total_motor_time_ms;            // Accumulated motor on time for session
+        
+        uint32_t start_time_ms;
+        uint32_t end_time_ms;                    // When end_grind_session() queued it for commit
+        bool save_requested;                     // Not cancelled; still subject to the logging setting
+        bool successful;                         // Counts towards grind statistics
+        std::atomic<uint8_t> state{SLOT_FREE};   // SlotState
+        
+        // Published by Core 0 for the journal writer: events logged, measurements in whole blocks
+        std::atomic<uint16_t> published_events{0};
+        std::atomic<uint16_t> published_measurements{0};
+        
+        // Journal of this slot's session, owned by the FileIO task
+        SessionJournalWriter journal;
+        uint32_t journal_skipped_id = 0;         // Session not journaled (logging disabled or write failed)
+        uint16_t journaled_events = 0;
+        uint16_t journaled_measurements = 0;
+    };
     
-    // Motor time tracking
-    bool last_motor_state;                   // Previous motor state for change detection
-    uint32_t motor_start_time;               // When motor last turned on
-    uint32_t total_motor_time_ms;            // Accumulated motor on time for session
+    SessionSlot slots[SESSION_SLOT_COUNT];
+    std::atomic<int8_t> active_slot{-1};     // Slot receiving log calls, -1 when not logging
+    std::atomic<int8_t> writing_slot{-1};    // Slot a Core 0 log call is appending to, -1 between calls
+    int8_t last_started_slot = -1;           // For get_current_session()
+    uint32_t slot_stalls = 0;                // Sessions not logged because no slot was free
+    float weight_quantum_g = 0.0f;           // Session file weight step, 0 = SESSION_CODEC_WEIGHT_QUANTUM_G
     
-    // Current session data
-    uint32_t session_start_time;
+    char current_phase_name[16];             // Current grinding phase name
     
     // Session ID management
     Preferences* _preferences;
     uint32_t _next_session_id;
     
+    // Sessions on flash, so listing and counting do not scan the directory
+    SessionIndex session_index;
+    
 public:
     bool init(Preferences* prefs);           // Initialize PSRAM buffer
     void cleanup();                          // Free PSRAM buffer
     
     // Session management
     void start_grind_session(const GrindSessionDescriptor& descriptor, float start_weight);
-    void end_grind_session(const char* final_result, float final_weight, uint8_t pulse_count);
+    // Finalizes the session and queues it for commit_pending_session(); session_id 0 means the active one
+    void end_grind_session(const char* final_result, float final_weight, uint8_t pulse_count, uint32_t session_id = 0);
     void discard_current_session();         // Discard current session without saving
     
+    // Commits the oldest ended session (statistics and flash write). Returns false when none is pending.
+    // Called from the FileIO task so a new session can log into the other slot meanwhile.
+    bool commit_pending_session(SessionCommitResult* result = nullptr);
+    
+    // Appends new events and completed measurement blocks of logging sessions to their journals,
+    // spreading the flash writes over the grind. Called from the FileIO task.
+    void write_session_journals();
+    
     // Logging methods
     void log_event(GrindEvent& event);       // **MODIFIED**: Takes non-const reference to set sequence ID
     void log_continuous_measurement(uint32_t timestamp_ms, float weight_grams, float weight_delta, 
@@ -183,21 +259,37 @@ public:
                                   float motor_stop_target_weight);
     
     // Flash storage management
-    bool flush_session_to_flash();          // Flush current session to flash
     bool rotate_flash_log_if_needed();      // Remove old sessions if limit exceeded
     bool clear_all_sessions_from_flash();   // Purge all stored sessions (for developer purge)
     uint32_t count_sessions_in_flash() const; // Count total sessions in flash file
     uint32_t count_total_events_in_flash() const; // Count total events across all sessions
     uint32_t count_total_measurements_in_flash() const; // Count total measurements across all sessions
+    uint32_t get_session_ids(uint32_t* ids_out, uint32_t max_ids) const; // Stored session IDs, oldest first
+    uint32_t get_recent_session_ids(uint32_t* ids_out, uint32_t max_ids) const; // Newest first
     
-    // Fixed-length binary export method
-    void export_sessions_binary_chunk(uint8_t* buffer, size_t buffer_size,
-                                     uint32_t start_pos, uint32_t* next_pos, size_t* actual_size);
     void send_current_session_via_serial();  // Debug output for current session
     
+    // Checks the CRC of an open session file and rewinds it. Files written before the CRC pass.
+    static bool verify_session_file(File& file);
+    
+    // Reads the events that follow the GrindSession struct in an open session file (schema v2 raw or v3 encoded)
+    static bool read_session_events(File& file, const TimeSeriesSessionHeader& header, GrindEvent* events_out);
+    
+    // Replays the events of up to max_sessions most recent session files, oldest first.
+    // Reads into a staging slot's event buffer, so only valid while no session is staged.
+    uint32_t visit_recent_sessions(uint32_t max_sessions, SessionEventVisitor visitor, void* context);
+    
     // Data access
     uint32_t get_total_flash_sessions() const;
-    bool is_logging_active() const { return logging_active; }
+    bool is_logging_active() const { return active_slot.load() >= 0; }
+    uint32_t get_active_session_id() const;  // 0 when not logging
+    const GrindSession* get_current_session() const; // Last started session (kept after end)
+    uint8_t get_occupied_session_slots() const;   // Slots logging, pending or committing
+    uint32_t get_session_slot_stalls() const { return slot_stalls; }
+    
+    // Host tools: weight step of the session files written from now on (0 = codec default). A step
+    // below one ADC count keeps the raw samples recoverable, so `replay --self-check` can be exact.
+    void set_weight_quantum(float grams) { weight_quantum_g = grams; }
     
     // Debug output helpers - conditionally compiled based on debug flags (moved to public for BLE access)
 #if ENABLE_GRIND_DEBUG
@@ -213,19 +305,25 @@ public:
     
 private:
     // Time-series system helpers
-    void clear_buffers();
-    void initialize_session_config();       // Snapshot current config into session
-    void reset_export_static_variables();   // Reset static variables used in export function
+    void clear_slot(SessionSlot& slot);
+    int8_t claim_active_slot();                              // Core 0: active slot marked as being written, or -1
+    void wait_for_slot_writer(int8_t index);                 // Core 1: until a log call claimed before a handoff returns
+    void initialize_session_config(GrindSession& session);  // Snapshot current config into session
+    bool flush_session_to_flash(const SessionSlot& slot);   // Write one staged session to its file
+    
+    // Session journals
+    bool append_to_journal(SessionSlot& slot, uint16_t event_limit, uint16_t measurement_limit);
+    void drop_journal(SessionSlot& slot);                    // Close and delete, nothing to recover
+    void recover_session_journals();                         // At boot: journals left by a reset become session files
+    bool recover_session_journal(uint32_t session_id);
     
     // Flash storage helpers
-    uint32_t calculate_checksum(const uint8_t* data, size_t length); // Simple checksum calculation
-    bool write_time_series_session_to_flash(const GrindSession& session, const GrindEvent* events, const GrindMeasurement* measurements);
     bool remove_oldest_sessions(uint32_t sessions_to_remove); // Remove oldest sessions from flash file (legacy)
     
     // Individual session file management
     bool ensure_sessions_directory_exists();    // Create sessions directory if needed
-    bool write_individual_session_file(uint32_t session_id, const GrindSession& session, const GrindEvent* events, const GrindMeasurement* measurements);
-    bool validate_session_file(uint32_t session_id); // Check if session file is valid/readable
+    bool write_individual_session_file(uint32_t session_id, const GrindSession& session, const GrindEvent* events, uint16_t event_count,
+                                       const GrindMeasurement* measurements, uint16_t measurement_count);
     bool remove_session_file(uint32_t session_id);   // Delete specific session file
     void cleanup_old_session_files(); // Remove old session files to maintain MAX_STORED_SESSIONS_FLASH limit
     
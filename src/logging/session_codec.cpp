@@ -0,0 +1,429 @@
+#include "session_codec.h"
+#include "grind_logging.h"
+#include <math.h>
+
+namespace {
+
+constexpr int32_t kMaxQuantizedValue = 1 << 28;   // Keeps zigzag(value) << 1 within a uint32 varint
+
+int32_t quantize(float value, float quantum) {
+    if (!isfinite(value)) {
+        return 0;
+    }
+    float steps = roundf(value / quantum);
+    if (steps > kMaxQuantizedValue) return kMaxQuantizedValue;
+    if (steps < -kMaxQuantizedValue) return -kMaxQuantizedValue;
+    return (int32_t)steps;
+}
+
+uint32_t zigzag_encode(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+int32_t zigzag_decode(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+class ColumnWriter {
+public:
+    explicit ColumnWriter(SessionBlockSink& sink) : sink_(sink), bytes_(0), ok_(true) {}
+
+    void put_varint(uint32_t value) {
+        uint8_t encoded[5];
+        size_t length = 0;
+        do {
+            uint8_t byte = value & 0x7F;
+            value >>= 7;
+            encoded[length++] = value ? (byte | 0x80) : byte;
+        } while (value);
+        put_bytes(encoded, length);
+    }
+
+    void put_bytes(const uint8_t* data, size_t length) {
+        if (ok_ && !sink_.write(data, length)) {
+            ok_ = false;
+        }
+        bytes_ += length;
+    }
+
+    size_t bytes() const { return bytes_; }
+    bool ok() const { return ok_; }
+
+private:
+    SessionBlockSink& sink_;
+    size_t bytes_;
+    bool ok_;
+};
+
+// Numeric column: zero values collapse into runs, everything else is a zigzag varint
+class NumericColumnEncoder {
+public:
+    explicit NumericColumnEncoder(ColumnWriter& writer) : writer_(writer), zero_run_(0) {}
+
+    void put(int32_t value) {
+        if (value == 0) {
+            zero_run_++;
+            return;
+        }
+        flush_zero_run();
+        writer_.put_varint(zigzag_encode(value) << 1);
+    }
+
+    void finish() { flush_zero_run(); }
+
+private:
+    void flush_zero_run() {
+        if (zero_run_ > 0) {
+            writer_.put_varint((zero_run_ << 1) | 1);
+            zero_run_ = 0;
+        }
+    }
+
+    ColumnWriter& writer_;
+    uint32_t zero_run_;
+};
+
+class ColumnReader {
+public:
+    ColumnReader(const uint8_t* data, size_t size) : data_(data), size_(size), pos_(0), ok_(true) {}
+
+    uint32_t get_varint() {
+        uint32_t value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (pos_ >= size_) {
+                ok_ = false;
+                return 0;
+            }
+            uint8_t byte = data_[pos_++];
+            value |= (uint32_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        ok_ = false;
+        return 0;
+    }
+
+    uint8_t get_byte() {
+        if (pos_ >= size_) {
+            ok_ = false;
+            return 0;
+        }
+        return data_[pos_++];
+    }
+
+    void get_bytes(void* out, size_t length) {
+        if (size_ - pos_ < length) {
+            ok_ = false;
+            memset(out, 0, length);
+            return;
+        }
+        memcpy(out, data_ + pos_, length);
+        pos_ += length;
+    }
+
+    size_t position() const { return pos_; }
+    bool ok() const { return ok_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_;
+    bool ok_;
+};
+
+class NumericColumnDecoder {
+public:
+    explicit NumericColumnDecoder(ColumnReader& reader) : reader_(reader), zero_run_(0) {}
+
+    int32_t get() {
+        if (zero_run_ > 0) {
+            zero_run_--;
+            return 0;
+        }
+        uint32_t token = reader_.get_varint();
+        if (token & 1) {
+            uint32_t run = token >> 1;
+            if (run == 0) {
+                return 0; // Malformed, caught by the run accounting below
+            }
+            zero_run_ = run - 1;
+            return 0;
+        }
+        return zigzag_decode(token >> 1);
+    }
+
+    // A zero run may not spill into the next column
+    bool finished_cleanly() const { return zero_run_ == 0; }
+
+private:
+    ColumnReader& reader_;
+    uint32_t zero_run_;
+};
+
+// Event floats in mask bit order (copied by value - GrindEvent is packed)
+constexpr int kEventFloatCount = 5;
+
+void get_event_floats(const GrindEvent& event, float values[kEventFloatCount]) {
+    values[0] = event.start_weight;
+    values[1] = event.end_weight;
+    values[2] = event.motor_stop_target_weight;
+    values[3] = event.pulse_duration_ms;
+    values[4] = event.pulse_flow_rate;
+}
+
+void set_event_floats(GrindEvent& event, const float values[kEventFloatCount]) {
+    event.start_weight = values[0];
+    event.end_weight = values[1];
+    event.motor_stop_target_weight = values[2];
+    event.pulse_duration_ms = values[3];
+    event.pulse_flow_rate = values[4];
+}
+
+} // namespace
+
+size_t encode_event_block(const GrindEvent* events, uint16_t count, SessionBlockSink& sink) {
+    ColumnWriter writer(sink);
+    uint32_t previous_time = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        const GrindEvent& event = events[i];
+        writer.put_varint(zigzag_encode((int32_t)(event.timestamp_ms - previous_time)));
+        previous_time = event.timestamp_ms;
+        writer.put_varint(event.duration_ms);
+        writer.put_varint(event.grind_latency_ms);
+        writer.put_varint(event.settling_duration_ms);
+
+        float values[kEventFloatCount];
+        get_event_floats(event, values);
+        uint8_t mask = 0;
+        for (int f = 0; f < kEventFloatCount; f++) {
+            uint32_t bits;
+            memcpy(&bits, &values[f], sizeof(bits));
+            if (bits != 0) {
+                mask |= 1 << f; // Bit pattern, so -0.0 survives the round trip
+            }
+        }
+        writer.put_bytes(&mask, 1);
+        for (int f = 0; f < kEventFloatCount; f++) {
+            if (mask & (1 << f)) {
+                writer.put_bytes((const uint8_t*)&values[f], sizeof(float));
+            }
+        }
+
+        writer.put_varint(event.loop_count);
+        uint8_t tail[3] = {event.phase_id, event.pulse_attempt_number, event.event_flags};
+        writer.put_bytes(tail, sizeof(tail));
+    }
+    return writer.ok() ? writer.bytes() : 0;
+}
+
+bool decode_event_block(const uint8_t* data, size_t size, uint16_t count, GrindEvent* events_out, size_t* consumed_out) {
+    ColumnReader reader(data, size);
+    uint32_t time = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        GrindEvent& event = events_out[i];
+        event = GrindEvent();
+        time += zigzag_decode(reader.get_varint());
+        event.timestamp_ms = time;
+        event.duration_ms = reader.get_varint();
+        event.grind_latency_ms = reader.get_varint();
+        event.settling_duration_ms = reader.get_varint();
+
+        float values[kEventFloatCount] = {};
+        uint8_t mask = reader.get_byte();
+        for (int f = 0; f < kEventFloatCount; f++) {
+            if (mask & (1 << f)) {
+                reader.get_bytes(&values[f], sizeof(float));
+            }
+        }
+        set_event_floats(event, values);
+
+        event.loop_count = (uint16_t)reader.get_varint();
+        event.phase_id = reader.get_byte();
+        event.pulse_attempt_number = reader.get_byte();
+        event.event_flags = reader.get_byte();
+        event.event_sequence_id = i;
+        if (!reader.ok()) {
+            return false;
+        }
+    }
+    *consumed_out = reader.position();
+    return true;
+}
+
+size_t encode_measurement_block(const GrindMeasurement* measurements, uint16_t count, SessionBlockSink& sink,
+                                float weight_quantum_g) {
+    ColumnWriter writer(sink);
+
+    MeasurementBlockHeader header = {};
+    header.weight_quantum_g = weight_quantum_g;
+    header.flow_quantum_gps = SESSION_CODEC_FLOW_QUANTUM_GPS;
+    header.column_count = SESSION_CODEC_COLUMN_COUNT;
+    writer.put_bytes((const uint8_t*)&header, sizeof(header));
+
+    // Timestamps: steady control ticks make the second difference mostly zero
+    {
+        NumericColumnEncoder column(writer);
+        uint32_t previous_time = 0;
+        int32_t previous_step = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            int32_t step = (int32_t)(measurements[i].timestamp_ms - previous_time);
+            column.put(step - previous_step);
+            previous_time = measurements[i].timestamp_ms;
+            previous_step = step;
+        }
+        column.finish();
+    }
+
+    // Weight: step between quantized readings
+    {
+        NumericColumnEncoder column(writer);
+        int32_t previous = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            int32_t value = quantize(measurements[i].weight_grams, header.weight_quantum_g);
+            column.put(value - previous);
+            previous = value;
+        }
+        column.finish();
+    }
+
+    // weight_delta is the change since the previous logged weight - store only what the weight column doesn't say
+    {
+        NumericColumnEncoder column(writer);
+        int32_t previous = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            int32_t weight = quantize(measurements[i].weight_grams, header.weight_quantum_g);
+            int32_t delta = quantize(measurements[i].weight_delta, header.weight_quantum_g);
+            column.put(delta - (weight - previous));
+            previous = weight;
+        }
+        column.finish();
+    }
+
+    // Flow rate
+    {
+        NumericColumnEncoder column(writer);
+        int32_t previous = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            int32_t value = quantize(measurements[i].flow_rate_g_per_s, header.flow_quantum_gps);
+            column.put(value - previous);
+            previous = value;
+        }
+        column.finish();
+    }
+
+    // Motor stop target: constant outside the predictive phase
+    {
+        NumericColumnEncoder column(writer);
+        int32_t previous = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            int32_t value = quantize(measurements[i].motor_stop_target_weight, header.weight_quantum_g);
+            column.put(value - previous);
+            previous = value;
+        }
+        column.finish();
+    }
+
+    // Phase and motor state change a handful of times per session
+    for (uint16_t i = 0; i < count;) {
+        uint16_t run = 1;
+        while (i + run < count &&
+               measurements[i + run].phase_id == measurements[i].phase_id &&
+               measurements[i + run].motor_is_on == measurements[i].motor_is_on) {
+            run++;
+        }
+        writer.put_varint(run);
+        uint8_t state[2] = {measurements[i].phase_id, measurements[i].motor_is_on};
+        writer.put_bytes(state, sizeof(state));
+        i += run;
+    }
+
+    return writer.ok() ? writer.bytes() : 0;
+}
+
+bool decode_measurement_block(const uint8_t* data, size_t size, uint16_t count, GrindMeasurement* measurements_out) {
+    if (size < sizeof(MeasurementBlockHeader)) {
+        return false;
+    }
+    MeasurementBlockHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.column_count != SESSION_CODEC_COLUMN_COUNT ||
+        !(header.weight_quantum_g > 0.0f) || !(header.flow_quantum_gps > 0.0f)) {
+        return false;
+    }
+
+    ColumnReader reader(data + sizeof(header), size - sizeof(header));
+    for (uint16_t i = 0; i < count; i++) {
+        measurements_out[i] = GrindMeasurement();
+        measurements_out[i].sequence_id = i;
+    }
+
+    {
+        NumericColumnDecoder column(reader);
+        uint32_t time = 0;
+        int32_t step = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            step += column.get();
+            time += step;
+            measurements_out[i].timestamp_ms = time;
+        }
+        if (!column.finished_cleanly()) return false;
+    }
+
+    {
+        NumericColumnDecoder column(reader);
+        int32_t value = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            value += column.get();
+            measurements_out[i].weight_grams = value * header.weight_quantum_g;
+        }
+        if (!column.finished_cleanly()) return false;
+    }
+
+    {
+        NumericColumnDecoder column(reader);
+        int32_t previous = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            // Exact: the decoded weight is a whole number of quanta
+            int32_t weight = (int32_t)roundf(measurements_out[i].weight_grams / header.weight_quantum_g);
+            measurements_out[i].weight_delta = (column.get() + weight - previous) * header.weight_quantum_g;
+            previous = weight;
+        }
+        if (!column.finished_cleanly()) return false;
+    }
+
+    {
+        NumericColumnDecoder column(reader);
+        int32_t value = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            value += column.get();
+            measurements_out[i].flow_rate_g_per_s = value * header.flow_quantum_gps;
+        }
+        if (!column.finished_cleanly()) return false;
+    }
+
+    {
+        NumericColumnDecoder column(reader);
+        int32_t value = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            value += column.get();
+            measurements_out[i].motor_stop_target_weight = value * header.weight_quantum_g;
+        }
+        if (!column.finished_cleanly()) return false;
+    }
+
+    for (uint16_t i = 0; i < count;) {
+        uint32_t run = reader.get_varint();
+        uint8_t phase_id = reader.get_byte();
+        uint8_t motor_is_on = reader.get_byte();
+        if (!reader.ok() || run == 0 || run > (uint32_t)(count - i)) {
+            return false;
+        }
+        for (uint32_t j = 0; j < run; j++, i++) {
+            measurements_out[i].phase_id = phase_id;
+            measurements_out[i].motor_is_on = motor_is_on;
+        }
+    }
+
+    return reader.ok();
+}
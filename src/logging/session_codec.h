@@ -0,0 +1,70 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+struct GrindEvent;
+struct GrindMeasurement;
+
+/*
+ * Schema v3 session file body - everything after the GrindSession struct.
+ *
+ * Event block, one record per event (event_sequence_id is implicit, 0..n-1):
+ *   varint zigzag(timestamp_ms - previous event timestamp_ms)
+ *   varint duration_ms, grind_latency_ms, settling_duration_ms
+ *   u8 mask of non-zero floats (bit 0..4: start_weight, end_weight, motor_stop_target_weight,
+ *      pulse_duration_ms, pulse_flow_rate), then those floats as raw little-endian values
+ *   varint loop_count
+ *   u8 phase_id, pulse_attempt_number, event_flags
+ *
+ * Measurement block - columnar, delta + zigzag varint encoded:
+ *   [MeasurementBlockHeader]
+ *   [timestamp column]   delta-of-delta of timestamp_ms
+ *   [weight column]      delta of weight_grams / weight_quantum_g
+ *   [delta column]       weight_delta / weight_quantum_g minus the quantized weight step
+ *   [flow column]        delta of flow_rate_g_per_s / flow_quantum_gps
+ *   [stop target column] delta of motor_stop_target_weight / weight_quantum_g
+ *   [phase column]       runs of (varint length, phase_id, motor_is_on)
+ *
+ * Every column holds exactly measurement_count values, so no column lengths are stored.
+ * Numeric columns are a stream of varint tokens: (zigzag(value) << 1) for a non-zero
+ * value, (run_length << 1) | 1 for a run of zero values. sequence_id is implicit (0..n-1).
+ * tools/ble/grinder-ble.py decodes the same layout.
+ */
+
+#define SESSION_CODEC_WEIGHT_QUANTUM_G 0.001f      // Weights to 1mg - below the load cell's settled noise
+#define SESSION_CODEC_FLOW_QUANTUM_GPS 0.01f       // Flow to 10mg/s - the windowed rate is no finer
+#define SESSION_CODEC_COLUMN_COUNT 6
+#define SESSION_CODEC_MAX_EVENT_SIZE 47            // Worst-case encoded GrindEvent
+#define SESSION_CODEC_MAX_MEASUREMENT_SIZE 30      // Worst case per measurement: 5 varints of 5 bytes, one phase run
+
+#pragma pack(push, 1)
+struct MeasurementBlockHeader {
+    float    weight_quantum_g;        // Grams per step for weight, weight_delta and stop target columns
+    float    flow_quantum_gps;        // g/s per step for the flow column
+    uint8_t  column_count;            // SESSION_CODEC_COLUMN_COUNT
+    uint8_t  reserved[3];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(MeasurementBlockHeader) == 12, "Unexpected MeasurementBlockHeader size");
+
+// Destination for encoded bytes; returns false once a write fails
+class SessionBlockSink {
+public:
+    virtual ~SessionBlockSink() = default;
+    virtual bool write(const uint8_t* data, size_t length) = 0;
+};
+
+// Streams the event block for count events into sink. Returns the encoded size, 0 if the sink failed.
+size_t encode_event_block(const GrindEvent* events, uint16_t count, SessionBlockSink& sink);
+
+// Decodes count events; *consumed_out receives the block size. False if truncated or malformed.
+bool decode_event_block(const uint8_t* data, size_t size, uint16_t count, GrindEvent* events_out, size_t* consumed_out);
+
+// Streams the measurement block for count measurements into sink, weights in steps of weight_quantum_g.
+// Returns the encoded size in bytes, 0 if the sink failed.
+size_t encode_measurement_block(const GrindMeasurement* measurements, uint16_t count, SessionBlockSink& sink,
+                                float weight_quantum_g = SESSION_CODEC_WEIGHT_QUANTUM_G);
+
+// Decodes a block written by encode_measurement_block. False if the block is truncated or malformed.
+bool decode_measurement_block(const uint8_t* data, size_t size, uint16_t count, GrindMeasurement* measurements_out);
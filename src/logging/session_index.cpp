@@ -0,0 +1,421 @@
+#include "session_index.h"
+#include "grind_logging.h"
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "../config/logging.h"
+
+namespace {
+StaticSemaphore_t g_index_mutex_buffer;
+SemaphoreHandle_t g_index_mutex = nullptr;
+
+class IndexLockGuard {
+public:
+    explicit IndexLockGuard(SemaphoreHandle_t mutex) : mutex_(mutex) {
+        if (mutex_) {
+            xSemaphoreTake(mutex_, portMAX_DELAY);
+        }
+    }
+
+    ~IndexLockGuard() {
+        if (mutex_) {
+            xSemaphoreGive(mutex_);
+        }
+    }
+
+private:
+    SemaphoreHandle_t mutex_;
+};
+
+constexpr const char* kCompactFile = SESSION_INDEX_FILE ".tmp";
+constexpr uint32_t kCompactSlack = 32;           // REMOVE records tolerated beyond the live entries
+constexpr size_t kReadBatch = 16;
+
+uint16_t fletcher16(const uint8_t* data, size_t length) {
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+    for (size_t i = 0; i < length; i++) {
+        sum1 = (sum1 + data[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return (uint16_t)((sum2 << 8) | sum1);
+}
+
+uint16_t record_check(const SessionIndexRecord& record) {
+    uint8_t bytes[1 + sizeof(SessionIndexEntry)];
+    bytes[0] = record.type;
+    memcpy(bytes + 1, &record.entry, sizeof(SessionIndexEntry));
+    return fletcher16(bytes, sizeof(bytes));
+}
+
+SessionIndexRecord make_record(uint8_t type, const SessionIndexEntry& entry) {
+    SessionIndexRecord record;
+    memset(&record, 0, sizeof(record));
+    record.type = type;
+    record.entry = entry;
+    record.check = record_check(record);
+    return record;
+}
+
+void session_path(uint32_t session_id, char* path, size_t path_size) {
+    snprintf(path, path_size, SESSION_FILE_FORMAT, (unsigned long)session_id);
+}
+
+// A session file is indexable once its header, session and full body are on flash
+bool read_entry(File& file, SessionIndexEntry* entry_out) {
+    TimeSeriesSessionHeader header;
+    GrindSession session;
+    if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        file.read((uint8_t*)&session, sizeof(session)) != sizeof(session) ||
+        header.session_id == 0 ||
+        file.size() != sizeof(header) + header.session_size) {
+        return false;
+    }
+
+    memset(entry_out, 0, sizeof(SessionIndexEntry));
+    entry_out->session_id = header.session_id;
+    entry_out->session_timestamp = header.session_timestamp;
+    entry_out->file_size = file.size();
+    entry_out->checksum = header.checksum;
+    entry_out->event_count = header.event_count;
+    entry_out->measurement_count = header.measurement_count;
+    entry_out->termination_reason = session.termination_reason;
+    entry_out->grind_mode = session.grind_mode;
+    entry_out->profile_id = session.profile_id;
+    entry_out->schema_version = (uint8_t)header.schema_version;
+    return true;
+}
+} // namespace
+
+bool SessionIndex::init(uint32_t capacity, uint32_t last_session_id) {
+    if (!g_index_mutex) {
+        g_index_mutex = xSemaphoreCreateMutexStatic(&g_index_mutex_buffer);
+    }
+
+    IndexLockGuard lock(g_index_mutex);
+    if (!entries_) {
+        entries_ = (SessionIndexEntry*)heap_caps_malloc(capacity * sizeof(SessionIndexEntry), MALLOC_CAP_SPIRAM);
+        if (!entries_) {
+            LOG_BLE("ERROR: Failed to allocate PSRAM for session index\n");
+            return false;
+        }
+        capacity_ = capacity;
+    }
+
+    bool needs_compact = false;
+    if (!load_locked(&needs_compact)) {
+        LOG_BLE("Session index missing or unreadable - rebuilding from %s\n", GRIND_SESSIONS_DIR);
+        return rebuild_locked();
+    }
+
+    // Oldest files deleted before their REMOVE record was appended
+    char path[64];
+    while (count_ > 0) {
+        session_path(entries_[0].session_id, path, sizeof(path));
+        if (LittleFS.exists(path)) {
+            break;
+        }
+        erase_locked(entries_[0].session_id);
+        needs_compact = true;
+    }
+
+    // The last session started before boot may have been written without its ADD record
+    if (last_session_id > 0 && (count_ == 0 || entries_[count_ - 1].session_id < last_session_id)) {
+        session_path(last_session_id, path, sizeof(path));
+        if (LittleFS.exists(path)) {
+            File file = LittleFS.open(path, "r");
+            SessionIndexEntry entry;
+            bool complete = file && read_entry(file, &entry) && entry.session_id == last_session_id;
+            file.close();
+            if (complete && count_ < capacity_) {
+                insert_locked(entry);
+                needs_compact = true;
+            } else if (!complete) {
+                LOG_BLE("Removing partially written session file %s\n", path);
+                LittleFS.remove(path);
+            }
+        }
+    }
+
+    if (needs_compact) {
+        compact_locked();
+    }
+    LOG_BLE("Session index: %lu sessions, %lu events, %lu measurements\n",
+            (unsigned long)count_, (unsigned long)total_events_, (unsigned long)total_measurements_);
+    return true;
+}
+
+bool SessionIndex::load_locked(bool* needs_compact) {
+    reset_locked();
+    if (!LittleFS.exists(SESSION_INDEX_FILE)) {
+        return false;
+    }
+    File file = LittleFS.open(SESSION_INDEX_FILE, "r");
+    if (!file) {
+        return false;
+    }
+
+    SessionIndexFileHeader header;
+    if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != SESSION_INDEX_MAGIC || header.version != SESSION_INDEX_VERSION ||
+        header.record_size != sizeof(SessionIndexRecord)) {
+        file.close();
+        return false;
+    }
+
+    SessionIndexRecord batch[kReadBatch];
+    bool ok = true;
+    bool torn = false;
+    while (ok && !torn) {
+        size_t bytes = file.read((uint8_t*)batch, sizeof(batch));
+        size_t records = bytes / sizeof(SessionIndexRecord);
+        torn = (bytes % sizeof(SessionIndexRecord)) != 0;
+
+        for (size_t i = 0; i < records; i++) {
+            const SessionIndexRecord& record = batch[i];
+            if (record.check != record_check(record)) {
+                torn = true;
+                break;
+            }
+            if (record.type == SESSION_INDEX_ADD) {
+                if (count_ >= capacity_) {
+                    ok = false;     // More live sessions than the retention limit allows - start over
+                    break;
+                }
+                insert_locked(record.entry);
+            } else if (record.type == SESSION_INDEX_REMOVE) {
+                erase_locked(record.entry.session_id);
+            } else {
+                torn = true;
+                break;
+            }
+            file_records_++;
+        }
+
+        if (bytes < sizeof(batch)) {
+            break;
+        }
+    }
+    file.close();
+
+    if (torn) {
+        LOG_BLE("Session index: discarding a torn record after %lu records\n", (unsigned long)file_records_);
+        *needs_compact = true;
+    }
+    return ok;
+}
+
+bool SessionIndex::rebuild() {
+    IndexLockGuard lock(g_index_mutex);
+    return rebuild_locked();
+}
+
+bool SessionIndex::rebuild_locked() {
+    reset_locked();
+    if (!entries_) {
+        return false;
+    }
+
+    File dir = LittleFS.open(GRIND_SESSIONS_DIR);
+    if (!dir || !dir.isDirectory()) {
+        if (LittleFS.exists(SESSION_INDEX_FILE)) {
+            LittleFS.remove(SESSION_INDEX_FILE);
+        }
+        return true;    // Nothing logged yet; the index file is created with the first session
+    }
+
+    uint32_t dropped = 0;
+    File file = dir.openNextFile();
+    while (file) {
+        String filename = file.name();
+        bool is_session_file = (filename.startsWith("session_") || filename.indexOf("/session_") != -1)
+                               && filename.endsWith(".bin");
+        SessionIndexEntry entry;
+        if (is_session_file && read_entry(file, &entry)) {
+            if (count_ >= capacity_) {
+                // Over the retention limit - drop whichever is older, as cleanup would
+                uint32_t oldest_id = min(entries_[0].session_id, entry.session_id);
+                if (oldest_id == entries_[0].session_id) {
+                    erase_locked(oldest_id);
+                    insert_locked(entry);
+                }
+                char path[64];
+                session_path(oldest_id, path, sizeof(path));
+                file.close();
+                LittleFS.remove(path);
+                dropped++;
+            } else {
+                insert_locked(entry);
+            }
+        }
+        file = dir.openNextFile();
+    }
+    dir.close();
+
+    if (dropped > 0) {
+        LOG_BLE("Session index: removed %lu sessions beyond the index capacity\n", (unsigned long)dropped);
+    }
+    LOG_BLE("Session index rebuilt: %lu sessions\n", (unsigned long)count_);
+    return compact_locked();
+}
+
+bool SessionIndex::compact_locked() {
+    File file = LittleFS.open(kCompactFile, "w");
+    if (!file) {
+        LOG_BLE("ERROR: Failed to create %s\n", kCompactFile);
+        return false;
+    }
+
+    SessionIndexFileHeader header;
+    header.magic = SESSION_INDEX_MAGIC;
+    header.version = SESSION_INDEX_VERSION;
+    header.record_size = sizeof(SessionIndexRecord);
+    bool ok = file.write((uint8_t*)&header, sizeof(header)) == sizeof(header);
+    for (uint32_t i = 0; ok && i < count_; i++) {
+        SessionIndexRecord record = make_record(SESSION_INDEX_ADD, entries_[i]);
+        ok = file.write((uint8_t*)&record, sizeof(record)) == sizeof(record);
+    }
+    file.close();
+
+    // LittleFS renames atomically, so a crash leaves either the old or the new index
+    if (!ok || !LittleFS.rename(kCompactFile, SESSION_INDEX_FILE)) {
+        LittleFS.remove(kCompactFile);
+        LOG_BLE("ERROR: Failed to rewrite session index\n");
+        return false;
+    }
+    file_records_ = count_;
+    return true;
+}
+
+bool SessionIndex::append_locked(uint8_t type, const SessionIndexEntry& entry) {
+    bool ok = false;
+    if (LittleFS.exists(SESSION_INDEX_FILE)) {
+        File file = LittleFS.open(SESSION_INDEX_FILE, "a");
+        if (file) {
+            SessionIndexRecord record = make_record(type, entry);
+            ok = file.write((uint8_t*)&record, sizeof(record)) == sizeof(record);
+            file.close();
+        }
+    }
+
+    if (ok) {
+        file_records_++;
+        if (file_records_ <= 2 * count_ + kCompactSlack) {
+            return true;
+        }
+    }
+    // No index file yet, a failed append or mostly REMOVE records - rewrite from memory
+    return compact_locked();
+}
+
+bool SessionIndex::add(const SessionIndexEntry& entry) {
+    IndexLockGuard lock(g_index_mutex);
+    if (!entries_ || count_ >= capacity_) {
+        LOG_BLE("ERROR: Session index full, session %lu not indexed\n", (unsigned long)entry.session_id);
+        return false;
+    }
+    insert_locked(entry);
+    return append_locked(SESSION_INDEX_ADD, entry);
+}
+
+bool SessionIndex::remove(uint32_t session_id) {
+    IndexLockGuard lock(g_index_mutex);
+    if (!entries_) {
+        return false;
+    }
+    erase_locked(session_id);
+    SessionIndexEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.session_id = session_id;
+    return append_locked(SESSION_INDEX_REMOVE, entry);
+}
+
+void SessionIndex::clear() {
+    IndexLockGuard lock(g_index_mutex);
+    reset_locked();
+    if (LittleFS.exists(SESSION_INDEX_FILE)) {
+        LittleFS.remove(SESSION_INDEX_FILE);
+    }
+}
+
+void SessionIndex::insert_locked(const SessionIndexEntry& entry) {
+    // Sessions are appended in ID order, so this is almost always the end
+    uint32_t pos = count_;
+    while (pos > 0 && entries_[pos - 1].session_id >= entry.session_id) {
+        pos--;
+    }
+    if (pos < count_ && entries_[pos].session_id == entry.session_id) {
+        total_events_ -= entries_[pos].event_count;
+        total_measurements_ -= entries_[pos].measurement_count;
+    } else {
+        memmove(&entries_[pos + 1], &entries_[pos], (count_ - pos) * sizeof(SessionIndexEntry));
+        count_++;
+    }
+    entries_[pos] = entry;
+    total_events_ += entry.event_count;
+    total_measurements_ += entry.measurement_count;
+}
+
+void SessionIndex::erase_locked(uint32_t session_id) {
+    for (uint32_t i = 0; i < count_; i++) {
+        if (entries_[i].session_id == session_id) {
+            total_events_ -= entries_[i].event_count;
+            total_measurements_ -= entries_[i].measurement_count;
+            memmove(&entries_[i], &entries_[i + 1], (count_ - i - 1) * sizeof(SessionIndexEntry));
+            count_--;
+            return;
+        }
+    }
+}
+
+void SessionIndex::reset_locked() {
+    count_ = 0;
+    file_records_ = 0;
+    total_events_ = 0;
+    total_measurements_ = 0;
+}
+
+uint32_t SessionIndex::count() const {
+    IndexLockGuard lock(g_index_mutex);
+    return count_;
+}
+
+uint32_t SessionIndex::total_events() const {
+    IndexLockGuard lock(g_index_mutex);
+    return total_events_;
+}
+
+uint32_t SessionIndex::total_measurements() const {
+    IndexLockGuard lock(g_index_mutex);
+    return total_measurements_;
+}
+
+bool SessionIndex::get_oldest(SessionIndexEntry* entry_out) const {
+    IndexLockGuard lock(g_index_mutex);
+    if (count_ == 0) {
+        return false;
+    }
+    *entry_out = entries_[0];
+    return true;
+}
+
+uint32_t SessionIndex::get_ids(uint32_t* ids_out, uint32_t max_ids) const {
+    IndexLockGuard lock(g_index_mutex);
+    uint32_t copied = min(count_, max_ids);
+    for (uint32_t i = 0; i < copied; i++) {
+        ids_out[i] = entries_[i].session_id;
+    }
+    return copied;
+}
+
+uint32_t SessionIndex::get_recent_ids(uint32_t* ids_out, uint32_t max_ids) const {
+    IndexLockGuard lock(g_index_mutex);
+    uint32_t copied = min(count_, max_ids);
+    for (uint32_t i = 0; i < copied; i++) {
+        ids_out[i] = entries_[count_ - 1 - i].session_id;
+    }
+    return copied;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Append-only index of the session files in GRIND_SESSIONS_DIR.
+ *
+ * File layout: [SessionIndexFileHeader][SessionIndexRecord]...
+ * Every saved session appends an ADD record, every deleted one a REMOVE record, so listing
+ * and counting sessions is one read of this file at boot instead of a directory scan
+ * (plus a file open per session for the counts) on every request.
+ *
+ * Crash safety - session files are written before their ADD record and deleted before their
+ * REMOVE record, and records carry a check value:
+ *   - a torn record ends the log; the file is compacted to the records before it
+ *   - the newest session may be on flash without its ADD record: probed at boot
+ *   - the oldest entries may have lost their file without a REMOVE record: dropped at boot
+ *   - a missing or unreadable index is rebuilt from the directory once
+ * The file is compacted (rewritten and renamed over) once REMOVE records dominate it.
+ */
+
+#define SESSION_INDEX_FILE "/sessions.idx"
+#define SESSION_INDEX_MAGIC 0x58495347u                // "GSIX"
+#define SESSION_INDEX_VERSION 1
+
+#pragma pack(push, 1)
+
+// What listing, counting and export need without opening the session file
+struct SessionIndexEntry {
+    uint32_t session_id;
+    uint32_t session_timestamp;       // From the session header
+    uint32_t file_size;               // Whole session file in bytes
+    uint32_t checksum;                // TimeSeriesSessionHeader::checksum, for verifying exports
+    uint16_t event_count;
+    uint16_t measurement_count;
+    uint8_t  termination_reason;      // GrindTerminationReason
+    uint8_t  grind_mode;
+    uint8_t  profile_id;
+    uint8_t  schema_version;
+};
+
+struct SessionIndexFileHeader {
+    uint32_t magic;                   // SESSION_INDEX_MAGIC
+    uint16_t version;                 // SESSION_INDEX_VERSION
+    uint16_t record_size;             // sizeof(SessionIndexRecord)
+};
+
+enum SessionIndexRecordType : uint8_t {
+    SESSION_INDEX_ADD = 1,
+    SESSION_INDEX_REMOVE = 2          // Only session_id is meaningful
+};
+
+struct SessionIndexRecord {
+    uint8_t  type;                    // SessionIndexRecordType
+    uint8_t  reserved;
+    uint16_t check;                   // Fletcher-16 over type and entry
+    SessionIndexEntry entry;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(SessionIndexEntry) == 24, "Unexpected SessionIndexEntry size");
+static_assert(sizeof(SessionIndexRecord) == 28, "Unexpected SessionIndexRecord size");
+
+// In-memory copy of the index, ordered by session ID. Thread-safe; file writes block - Core 1 only.
+class SessionIndex {
+public:
+    // Loads the index (rebuilding it from the directory if needed) and reconciles it with the
+    // newest session started before boot. capacity bounds the entries kept in memory.
+    bool init(uint32_t capacity, uint32_t last_session_id);
+
+    bool add(const SessionIndexEntry& entry);
+    bool remove(uint32_t session_id);
+    void clear();                     // Forget every entry and delete the index file
+    bool rebuild();                   // Re-scan the sessions directory and rewrite the index
+
+    uint32_t count() const;
+    uint32_t total_events() const;
+    uint32_t total_measurements() const;
+    bool get_oldest(SessionIndexEntry* entry_out) const;
+
+    // Session IDs oldest first, up to max_ids; returns how many were copied
+    uint32_t get_ids(uint32_t* ids_out, uint32_t max_ids) const;
+    // The max_ids newest session IDs, newest first
+    uint32_t get_recent_ids(uint32_t* ids_out, uint32_t max_ids) const;
+
+private:
+    bool load_locked(bool* needs_compact);
+    bool rebuild_locked();
+    bool compact_locked();
+    bool append_locked(uint8_t type, const SessionIndexEntry& entry);
+    void insert_locked(const SessionIndexEntry& entry);
+    void erase_locked(uint32_t session_id);
+    void reset_locked();
+
+    SessionIndexEntry* entries_ = nullptr;   // Ascending session_id (PSRAM)
+    uint32_t capacity_ = 0;
+    uint32_t count_ = 0;
+    uint32_t file_records_ = 0;              // Records in the file, live or not
+    uint32_t total_events_ = 0;
+    uint32_t total_measurements_ = 0;
+};
@@ -0,0 +1,209 @@
+#include "session_journal.h"
+#include "grind_logging.h"
+#include "session_codec.h"
+#include "../system/crc32.h"
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "../config/logging.h"
+
+namespace {
+
+constexpr size_t kMaxBlockSize = sizeof(MeasurementBlockHeader) +
+                                 SESSION_JOURNAL_BLOCK_MEASUREMENTS * SESSION_CODEC_MAX_MEASUREMENT_SIZE;
+
+// Largest payload a reader accepts; anything bigger is a damaged length field
+constexpr size_t kMaxRecordPayload = sizeof(GrindEvent) * EVENT_TEMP_BUFFER_SIZE > kMaxBlockSize
+                                         ? sizeof(GrindEvent) * EVENT_TEMP_BUFFER_SIZE
+                                         : kMaxBlockSize;
+
+class MemorySink : public SessionBlockSink {
+public:
+    MemorySink(uint8_t* buffer, size_t capacity) : buffer_(buffer), capacity_(capacity), used_(0) {}
+
+    bool write(const uint8_t* data, size_t length) override {
+        if (capacity_ - used_ < length) {
+            return false;
+        }
+        memcpy(buffer_ + used_, data, length);
+        used_ += length;
+        return true;
+    }
+
+private:
+    uint8_t* buffer_;
+    size_t capacity_;
+    size_t used_;
+};
+
+uint32_t record_crc(SessionJournalRecordHeader header, const void* payload) {
+    header.crc = 0;
+    uint32_t crc = crc32_update(0, &header, sizeof(header));
+    return crc32_update(crc, payload, header.length);
+}
+
+void journal_path(uint32_t session_id, char* path, size_t size) {
+    snprintf(path, size, SESSION_JOURNAL_FORMAT, (unsigned long)session_id);
+}
+
+}
+
+bool SessionJournalWriter::open(const GrindSession& session) {
+    close();
+
+    if (!LittleFS.exists(SESSION_JOURNAL_DIR) && !LittleFS.mkdir(SESSION_JOURNAL_DIR)) {
+        LOG_BLE("ERROR: Failed to create journal directory\n");
+        return false;
+    }
+    block_buffer_ = (uint8_t*)malloc(kMaxBlockSize);
+    if (!block_buffer_) {
+        return false;
+    }
+
+    char path[64];
+    journal_path(session.session_id, path, sizeof(path));
+    file_ = LittleFS.open(path, "w");
+    if (!file_) {
+        LOG_BLE("ERROR: Failed to open session journal %s\n", path);
+        close();
+        return false;
+    }
+
+    SessionJournalFileHeader header = {};
+    header.magic = SESSION_JOURNAL_MAGIC;
+    header.version = SESSION_JOURNAL_VERSION;
+    header.session_id = session.session_id;
+    session_id_ = session.session_id;
+    bytes_written_ = 0;
+    if (file_.write((const uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        !append_record(SESSION_JOURNAL_START, 0, &session, sizeof(session))) {
+        close();
+        LittleFS.remove(path);
+        return false;
+    }
+    bytes_written_ += sizeof(header);
+    return true;
+}
+
+bool SessionJournalWriter::append_events(const GrindEvent* events, uint16_t count) {
+    return count == 0 || append_record(SESSION_JOURNAL_EVENTS, count, events, sizeof(GrindEvent) * count);
+}
+
+bool SessionJournalWriter::append_measurements(const GrindMeasurement* measurements, uint16_t count) {
+    if (count == 0) {
+        return true;
+    }
+    if (!block_buffer_ || count > SESSION_JOURNAL_BLOCK_MEASUREMENTS) {
+        return false;
+    }
+    MemorySink sink(block_buffer_, kMaxBlockSize);
+    size_t length = encode_measurement_block(measurements, count, sink);
+    return length > 0 && append_record(SESSION_JOURNAL_MEASUREMENTS, count, block_buffer_, length);
+}
+
+bool SessionJournalWriter::finish(const GrindSession& session) {
+    bool ok = append_record(SESSION_JOURNAL_END, 0, &session, sizeof(session));
+    close();
+    return ok;
+}
+
+void SessionJournalWriter::close() {
+    if (file_) {
+        file_.close();
+    }
+    free(block_buffer_);
+    block_buffer_ = nullptr;
+    session_id_ = 0;
+}
+
+bool SessionJournalWriter::remove(uint32_t session_id) {
+    char path[64];
+    journal_path(session_id, path, sizeof(path));
+    return !LittleFS.exists(path) || LittleFS.remove(path);
+}
+
+bool SessionJournalWriter::append_record(uint8_t type, uint16_t count, const void* payload, size_t length) {
+    if (!file_) {
+        return false;
+    }
+    SessionJournalRecordHeader header = {};
+    header.type = type;
+    header.count = count;
+    header.length = length;
+    header.crc = record_crc(header, payload);
+
+    // Flushed per record so a reset loses at most the record being written
+    bool ok = file_.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              file_.write((const uint8_t*)payload, length) == length;
+    file_.flush();
+    if (ok) {
+        bytes_written_ += sizeof(header) + length;
+    } else {
+        LOG_BLE("ERROR: Session journal %lu append failed\n", (unsigned long)session_id_);
+    }
+    return ok;
+}
+
+bool read_session_journal(File& file, GrindSession* session_out,
+                          GrindEvent* events_out, uint16_t max_events,
+                          GrindMeasurement* measurements_out, uint16_t max_measurements,
+                          SessionJournalContents* contents_out) {
+    memset(contents_out, 0, sizeof(*contents_out));
+
+    SessionJournalFileHeader file_header;
+    if (file.read((uint8_t*)&file_header, sizeof(file_header)) != sizeof(file_header) ||
+        file_header.magic != SESSION_JOURNAL_MAGIC || file_header.version != SESSION_JOURNAL_VERSION) {
+        return false;
+    }
+    contents_out->session_id = file_header.session_id;
+
+    uint8_t* payload = (uint8_t*)malloc(kMaxRecordPayload);
+    if (!payload) {
+        return false;
+    }
+
+    SessionJournalRecordHeader header;
+    while (!contents_out->ended &&
+           file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+           header.length <= kMaxRecordPayload &&
+           file.read(payload, header.length) == header.length &&
+           record_crc(header, payload) == header.crc) {
+        switch (header.type) {
+            case SESSION_JOURNAL_START:
+            case SESSION_JOURNAL_END:
+                if (header.length == sizeof(GrindSession)) {
+                    memcpy(session_out, payload, sizeof(GrindSession));
+                    contents_out->started = true;
+                    contents_out->ended = (header.type == SESSION_JOURNAL_END);
+                }
+                break;
+
+            case SESSION_JOURNAL_EVENTS:
+                if (header.length == sizeof(GrindEvent) * header.count &&
+                    contents_out->event_count + header.count <= max_events) {
+                    memcpy(&events_out[contents_out->event_count], payload, header.length);
+                    contents_out->event_count += header.count;
+                }
+                break;
+
+            case SESSION_JOURNAL_MEASUREMENTS: {
+                uint16_t base = contents_out->measurement_count;
+                if (base + header.count <= max_measurements &&
+                    decode_measurement_block(payload, header.length, header.count, &measurements_out[base])) {
+                    // Blocks number their measurements from 0
+                    for (uint16_t i = 0; i < header.count; i++) {
+                        measurements_out[base + i].sequence_id = base + i;
+                    }
+                    contents_out->measurement_count += header.count;
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    free(payload);
+    return contents_out->started;
+}
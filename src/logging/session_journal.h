@@ -0,0 +1,99 @@
+#pragma once
+#include <FS.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct GrindSession;
+struct GrindEvent;
+struct GrindMeasurement;
+
+/*
+ * Write-ahead journal of the session being ground, appended by the FileIO task while the
+ * grind runs so a brownout or watchdog reset does not lose it.
+ *
+ * File layout: [SessionJournalFileHeader][record]...
+ *   START         GrindSession as started
+ *   EVENTS        count raw GrindEvents, continuing the event sequence
+ *   MEASUREMENTS  count measurements as a session_codec measurement block
+ *   END           GrindSession as ended - the journal is complete
+ * Each record carries a CRC-32 over its header and payload. A reset mid-append leaves a torn
+ * last record, and readers stop before it. Measurements go out in blocks of
+ * SESSION_JOURNAL_BLOCK_MEASUREMENTS, so a reset loses at most one block.
+ *
+ * The journal is deleted once its session file is written. Journals found at boot become
+ * session files (ended or interrupted), or are dropped when they hold no measurements.
+ */
+
+#define SESSION_JOURNAL_DIR "/journal"
+#define SESSION_JOURNAL_FORMAT "/journal/session_%lu.jnl"
+#define SESSION_JOURNAL_MAGIC 0x4C4A5347u              // "GSJL"
+#define SESSION_JOURNAL_VERSION 1
+#define SESSION_JOURNAL_BLOCK_MEASUREMENTS 64          // About 1.3s of grinding per append
+
+#pragma pack(push, 1)
+
+struct SessionJournalFileHeader {
+    uint32_t magic;                   // SESSION_JOURNAL_MAGIC
+    uint16_t version;                 // SESSION_JOURNAL_VERSION
+    uint16_t reserved;
+    uint32_t session_id;
+};
+
+enum SessionJournalRecordType : uint8_t {
+    SESSION_JOURNAL_START = 1,
+    SESSION_JOURNAL_EVENTS = 2,
+    SESSION_JOURNAL_MEASUREMENTS = 3,
+    SESSION_JOURNAL_END = 4
+};
+
+struct SessionJournalRecordHeader {
+    uint8_t  type;                    // SessionJournalRecordType
+    uint8_t  reserved;
+    uint16_t count;                   // Events or measurements in the payload
+    uint32_t length;                  // Payload bytes
+    uint32_t crc;                     // CRC-32 of this header with crc = 0, then the payload
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(SessionJournalFileHeader) == 12, "Unexpected SessionJournalFileHeader size");
+static_assert(sizeof(SessionJournalRecordHeader) == 12, "Unexpected SessionJournalRecordHeader size");
+
+// Appends one session's journal. Blocking file I/O - FileIO task only.
+class SessionJournalWriter {
+public:
+    bool open(const GrindSession& session);       // Creates the file and writes the START record
+    bool append_events(const GrindEvent* events, uint16_t count);
+    bool append_measurements(const GrindMeasurement* measurements, uint16_t count);
+    bool finish(const GrindSession& session);     // Writes the END record and closes
+    void close();
+
+    bool is_open() const { return session_id_ != 0; }
+    uint32_t session_id() const { return session_id_; }
+    uint32_t bytes_written() const { return bytes_written_; }
+
+    static bool remove(uint32_t session_id);
+
+private:
+    bool append_record(uint8_t type, uint16_t count, const void* payload, size_t length);
+
+    File file_;
+    uint32_t session_id_ = 0;
+    uint32_t bytes_written_ = 0;
+    uint8_t* block_buffer_ = nullptr;             // Encoded measurement block, allocated while open
+};
+
+// What read_session_journal() found before the end of the file or the first damaged record
+struct SessionJournalContents {
+    uint32_t session_id;
+    bool started;                     // START record present - session_out is valid
+    bool ended;                       // END record present - session_out holds the ended session
+    uint16_t event_count;
+    uint16_t measurement_count;
+};
+
+// Reads the intact records of a journal. Events and measurements beyond the capacities are dropped.
+bool read_session_journal(File& file, GrindSession* session_out,
+                          GrindEvent* events_out, uint16_t max_events,
+                          GrindMeasurement* measurements_out, uint16_t max_measurements,
+                          SessionJournalContents* contents_out);
@@ -0,0 +1,390 @@
+#include "bulk_transfer_bench.h"
+#include "../../bluetooth/bulk_transfer.h"
+#include "../../config/system.h"
+#include <Arduino.h>
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+
+/*
+ * Windowed bulk transfer benchmark
+ *
+ * Runs BulkTransferSender against a simulated link and a receiver that follows the same ACK
+ * policy as tools/ble/grinder-ble.py, and compares it with the legacy export (one paced
+ * notification per BLE task cycle, no recovery).
+ *
+ * Link model, stepped in 1ms:
+ *   - the device side runs every SYS_TASK_BLUETOOTH_INTERVAL_MS like the BLE task
+ *   - notifications wait in a bounded stack queue; a full queue refuses the frame
+ *   - every connection interval up to --packets frames go each way, each lost with
+ *     probability --loss (queue overruns and drops the host stack does not recover)
+ */
+
+namespace {
+
+struct BenchConfig {
+    uint32_t file_bytes = 4096;        // About one schema v3 session file
+    uint32_t files = 40;
+    uint16_t mtu = 247;
+    uint32_t interval_ms = 15;
+    uint32_t packets_per_event = 6;
+    uint32_t queue_frames = 12;
+    uint32_t seed = 1;
+};
+
+constexpr uint32_t kLegacyChunkBytes = 512;    // BLE_DATA_CHUNK_SIZE_BYTES
+constexpr uint32_t kLegacyPacingMs = 25;
+constexpr uint32_t kLegacyCompleteDelayMs = 200;
+constexpr uint32_t kTimeLimitMs = 120000;
+
+typedef std::vector<uint8_t> Frame;
+
+struct SimLink {
+    const BenchConfig* config;
+    std::mt19937* rng;
+    float loss;
+    std::deque<Frame> to_client;
+
+    bool lost() { return std::uniform_real_distribution<float>(0.0f, 1.0f)(*rng) < loss; }
+};
+
+class LinkTransport : public BulkTransport {
+public:
+    explicit LinkTransport(SimLink* link) : link_(link) {}
+
+    bool send_frame(const uint8_t* frame, size_t length) override {
+        if (link_->to_client.size() >= link_->config->queue_frames) {
+            return false;
+        }
+        link_->to_client.emplace_back(frame, frame + length);
+        return true;
+    }
+
+private:
+    SimLink* link_;
+};
+
+class VectorSource : public BulkSource {
+public:
+    explicit VectorSource(const std::vector<uint8_t>* data) : data_(data) {}
+
+    bool read_at(uint32_t offset, uint8_t* buffer, size_t length) override {
+        if (offset + length > data_->size()) {
+            return false;
+        }
+        memcpy(buffer, data_->data() + offset, length);
+        return true;
+    }
+
+private:
+    const std::vector<uint8_t>* data_;
+};
+
+uint16_t get_u16(const uint8_t* in) { return (uint16_t)(in[0] | (in[1] << 8)); }
+uint32_t get_u32(const uint8_t* in) { return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24); }
+
+// Client side, same policy as BulkReceiver in grinder-ble.py: ACK every window/2 frames,
+// on a new gap (with NACK ranges for the holes) and on a duplicate.
+class BulkReceiver {
+public:
+    std::vector<uint8_t> data;
+
+    void on_frame(const Frame& frame, std::deque<Frame>& acks_out) {
+        if (frame.empty()) return;
+        if (frame[0] == BULK_FRAME_START && frame.size() >= 20) {
+            if (payload_ > 0 && get_u32(&frame[16]) == start_) {
+                return;                // Repeated START of the transfer in progress
+            }
+            window_ = frame[2];
+            payload_ = get_u16(&frame[4]) - BULK_DATA_HEADER_SIZE;
+            total_ = get_u32(&frame[12]);
+            start_ = get_u32(&frame[16]);
+            frame_count_ = (total_ - start_ + payload_ - 1) / payload_;
+            received_.assign(frame_count_, false);
+            data.resize(total_);
+            expected_ = 0;
+            highest_ = 0;
+            since_ack_ = 0;
+            ended_ = false;
+        } else if (frame[0] == BULK_FRAME_DATA && frame.size() > BULK_DATA_HEADER_SIZE && payload_ > 0) {
+            uint32_t seq = expected_ + (int16_t)(uint16_t)(get_u16(&frame[2]) - (uint16_t)expected_);
+            uint32_t offset = get_u32(&frame[4]);
+            bool duplicate = seq < expected_ || seq >= frame_count_ || received_[seq];
+            bool new_gap = !duplicate && seq > highest_ + 1 && seq > expected_;
+            if (!duplicate && offset + frame.size() - BULK_DATA_HEADER_SIZE <= total_) {
+                memcpy(&data[offset], &frame[BULK_DATA_HEADER_SIZE], frame.size() - BULK_DATA_HEADER_SIZE);
+                received_[seq] = true;
+                highest_ = std::max(highest_, seq);
+                while (expected_ < frame_count_ && received_[expected_]) expected_++;
+            }
+            since_ack_++;
+            if (duplicate || new_gap || since_ack_ >= std::max(1, window_ / 2) || expected_ == frame_count_) {
+                acks_out.push_back(build_ack());
+                since_ack_ = 0;
+            }
+        } else if (frame[0] == BULK_FRAME_END) {
+            ended_ = true;
+        }
+    }
+
+    bool complete() const { return frame_count_ > 0 ? expected_ == frame_count_ : total_ == start_ && ended_; }
+    uint32_t contiguous_bytes() const { return std::min(total_, start_ + expected_ * payload_); }
+
+private:
+    Frame build_ack() const {
+        Frame ack = {0x17, (uint8_t)expected_, (uint8_t)(expected_ >> 8), 0};
+        for (uint32_t seq = expected_; seq < highest_ && ack[3] < BulkAck::MAX_RANGES; seq++) {
+            if (received_[seq]) continue;
+            uint32_t count = 0;
+            while (seq + count < highest_ && !received_[seq + count] && count < 255) count++;
+            ack.push_back((uint8_t)seq);
+            ack.push_back((uint8_t)(seq >> 8));
+            ack.push_back((uint8_t)count);
+            ack[3]++;
+            seq += count;
+        }
+        return ack;
+    }
+
+    int window_ = 0;
+    uint32_t payload_ = 0;
+    uint32_t total_ = 0;
+    uint32_t start_ = 0;
+    uint32_t frame_count_ = 0;
+    uint32_t expected_ = 0;
+    uint32_t highest_ = 0;
+    int since_ack_ = 0;
+    bool ended_ = false;
+    std::vector<bool> received_;
+};
+
+struct RunResult {
+    uint32_t elapsed_ms = 0;
+    uint32_t frames_sent = 0;
+    uint32_t frames_retransmitted = 0;
+    uint32_t timeouts = 0;
+    bool intact = false;
+};
+
+// One connection event: frames to the client, then ACKs back to the device
+void connection_event(SimLink& link, BulkReceiver& receiver, std::deque<Frame>& client_acks,
+                      std::deque<BulkAck>& device_inbox) {
+    for (uint32_t i = 0; i < link.config->packets_per_event && !link.to_client.empty(); i++) {
+        Frame frame = std::move(link.to_client.front());
+        link.to_client.pop_front();
+        if (!link.lost()) {
+            receiver.on_frame(frame, client_acks);
+        }
+    }
+    for (uint32_t i = 0; i < link.config->packets_per_event && !client_acks.empty(); i++) {
+        Frame frame = std::move(client_acks.front());
+        client_acks.pop_front();
+        BulkAck ack;
+        if (!link.lost() && ack.parse(frame.data() + 1, frame.size() - 1)) {
+            device_inbox.push_back(ack);
+        }
+    }
+}
+
+// Sends file from start_offset; stops early once the receiver holds stop_after_bytes contiguous bytes
+RunResult run_windowed(const BenchConfig& config, SimLink& link, BulkReceiver& receiver,
+                       const std::vector<uint8_t>& file, uint32_t start_offset, uint8_t window,
+                       uint32_t stop_after_bytes = UINT32_MAX) {
+    LinkTransport transport(&link);
+    VectorSource source(&file);
+    BulkTransferSender sender;
+    std::deque<Frame> client_acks;
+    std::deque<BulkAck> device_inbox;
+    link.to_client.clear();
+    RunResult result;
+
+    for (uint32_t now = 0; now < kTimeLimitMs; now++) {
+        if (now % SYS_TASK_BLUETOOTH_INTERVAL_MS == 0) {
+            if (now == 0) {
+                sender.begin(&transport, &source, 1, file.size(), start_offset, window, config.mtu - 3, now);
+            }
+            while (!device_inbox.empty()) {
+                sender.on_ack(device_inbox.front(), now);
+                device_inbox.pop_front();
+            }
+            sender.poll(now);
+        }
+        if (now % config.interval_ms == 0) {
+            connection_event(link, receiver, client_acks, device_inbox);
+        }
+        if ((receiver.complete() && !sender.is_active()) || receiver.contiguous_bytes() >= stop_after_bytes) {
+            result.elapsed_ms = now;
+            break;
+        }
+    }
+
+    result.frames_sent = sender.stats().frames_sent;
+    result.frames_retransmitted = sender.stats().frames_retransmitted;
+    result.timeouts = sender.stats().timeouts;
+    result.intact = receiver.complete() && receiver.data == file;
+    return result;
+}
+
+// The original export: one chunk per BLE task cycle once 25ms have passed, then a 200ms wait
+RunResult run_legacy(const BenchConfig& config, SimLink& link, const std::vector<uint8_t>& file) {
+    uint32_t chunk = std::min<uint32_t>(kLegacyChunkBytes, config.mtu - 3u);
+    std::vector<uint8_t> received;
+    uint32_t sent = 0;
+    uint32_t next_chunk_time = 0;
+    link.to_client.clear();
+    RunResult result;
+
+    uint32_t now = 0;
+    for (; now < kTimeLimitMs; now++) {
+        if (now % SYS_TASK_BLUETOOTH_INTERVAL_MS == 0 && sent < file.size() && now >= next_chunk_time) {
+            uint32_t length = std::min<uint32_t>(chunk, file.size() - sent);
+            link.to_client.emplace_back(file.begin() + sent, file.begin() + sent + length);
+            sent += length;
+            result.frames_sent++;
+            next_chunk_time = now + kLegacyPacingMs;
+        }
+        if (now % config.interval_ms == 0) {
+            for (uint32_t i = 0; i < config.packets_per_event && !link.to_client.empty(); i++) {
+                if (!link.lost()) {
+                    received.insert(received.end(), link.to_client.front().begin(), link.to_client.front().end());
+                }
+                link.to_client.pop_front();
+            }
+        }
+        if (sent == file.size() && link.to_client.empty()) {
+            break;
+        }
+    }
+    result.elapsed_ms = now + kLegacyCompleteDelayMs;
+    result.intact = received == file;
+    return result;
+}
+
+struct Totals {
+    uint64_t bytes = 0;
+    uint64_t elapsed_ms = 0;
+    uint64_t frames_sent = 0;
+    uint64_t frames_retransmitted = 0;
+    uint64_t timeouts = 0;
+    uint32_t intact = 0;
+    uint32_t files = 0;
+
+    void add(const RunResult& result, uint32_t file_bytes) {
+        bytes += file_bytes;
+        elapsed_ms += result.elapsed_ms;
+        frames_sent += result.frames_sent;
+        frames_retransmitted += result.frames_retransmitted;
+        timeouts += result.timeouts;
+        intact += result.intact ? 1 : 0;
+        files++;
+    }
+
+    void print(const char* label) const {
+        printf("  %-12s %8.1f KB/s  %6.0f ms/file  intact %3u/%-3u  resent %5.1f%%  timeouts %.2f/file\n",
+               label, bytes / 1024.0 / std::max(elapsed_ms, (uint64_t)1) * 1000.0,
+               (double)elapsed_ms / std::max(files, 1u), intact, files,
+               100.0 * frames_retransmitted / std::max(frames_sent, (uint64_t)1),
+               (double)timeouts / std::max(files, 1u));
+    }
+};
+
+std::vector<uint8_t> random_file(std::mt19937& rng, uint32_t size) {
+    std::vector<uint8_t> file(size);
+    for (uint8_t& byte : file) byte = (uint8_t)rng();
+    return file;
+}
+
+bool parse_args(int argc, char** argv, BenchConfig& config) {
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--help") == 0 || i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--bytes") == 0) config.file_bytes = std::max(1UL, strtoul(value, nullptr, 10));
+        else if (strcmp(arg, "--files") == 0) config.files = std::max(1UL, strtoul(value, nullptr, 10));
+        else if (strcmp(arg, "--mtu") == 0) config.mtu = std::min(517UL, std::max(23UL, strtoul(value, nullptr, 10)));
+        else if (strcmp(arg, "--interval") == 0) config.interval_ms = std::max(1UL, strtoul(value, nullptr, 10));
+        else if (strcmp(arg, "--packets") == 0) config.packets_per_event = std::max(1UL, strtoul(value, nullptr, 10));
+        else if (strcmp(arg, "--queue") == 0) config.queue_frames = std::max(1UL, strtoul(value, nullptr, 10));
+        else if (strcmp(arg, "--seed") == 0) config.seed = strtoul(value, nullptr, 10);
+        else return false;
+    }
+    return true;
+}
+
+void print_help() {
+    BenchConfig defaults;
+    printf("Usage: bench-bulk [options]\n"
+           "  --bytes N       session file size (default %u)\n"
+           "  --files N       files per configuration (default %u)\n"
+           "  --mtu N         negotiated ATT MTU (default %u)\n"
+           "  --interval MS   connection interval (default %u)\n"
+           "  --packets N     notifications per connection event (default %u)\n"
+           "  --queue N       stack notification queue in frames (default %u)\n"
+           "  --seed N        RNG seed (default 1)\n",
+           (unsigned)defaults.file_bytes, (unsigned)defaults.files, (unsigned)defaults.mtu,
+           (unsigned)defaults.interval_ms, (unsigned)defaults.packets_per_event, (unsigned)defaults.queue_frames);
+}
+
+} // namespace
+
+int run_bulk_transfer_bench(int argc, char** argv) {
+    BenchConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_help();
+        return 1;
+    }
+
+    printf("%u x %u-byte files, MTU %u, %ums connection interval, %u packets/event, %u-frame queue\n",
+           (unsigned)config.files, (unsigned)config.file_bytes, (unsigned)config.mtu, (unsigned)config.interval_ms,
+           (unsigned)config.packets_per_event, (unsigned)config.queue_frames);
+
+    bool ok = true;
+    const float losses[] = {0.0f, 0.01f, 0.05f};
+    const uint8_t windows[] = {4, 8, 16, 32};
+    for (float loss : losses) {
+        printf("Loss %.0f%%:\n", loss * 100.0f);
+        std::mt19937 rng(config.seed);
+        SimLink link = {&config, &rng, loss, {}};
+
+        Totals legacy;
+        for (uint32_t i = 0; i < config.files; i++) {
+            std::vector<uint8_t> file = random_file(rng, config.file_bytes);
+            legacy.add(run_legacy(config, link, file), config.file_bytes);
+        }
+        legacy.print("legacy");
+
+        for (uint8_t window : windows) {
+            Totals windowed;
+            for (uint32_t i = 0; i < config.files; i++) {
+                std::vector<uint8_t> file = random_file(rng, config.file_bytes);
+                BulkReceiver receiver;
+                windowed.add(run_windowed(config, link, receiver, file, 0, window), config.file_bytes);
+            }
+            char label[24];
+            snprintf(label, sizeof(label), "window %u", (unsigned)window);
+            windowed.print(label);
+            ok = ok && windowed.intact == windowed.files;
+        }
+    }
+
+    // Disconnect halfway through, then resume from the bytes the client already holds
+    std::mt19937 rng(config.seed);
+    SimLink link = {&config, &rng, 0.01f, {}};
+    std::vector<uint8_t> file = random_file(rng, config.file_bytes * 4);
+    BulkReceiver receiver;
+    RunResult first = run_windowed(config, link, receiver, file, 0, BLE_BULK_DEFAULT_WINDOW, file.size() / 2);
+    uint32_t resume_offset = receiver.contiguous_bytes();
+    RunResult second = run_windowed(config, link, receiver, file, resume_offset, BLE_BULK_DEFAULT_WINDOW);
+    uint32_t payload = config.mtu - 3 - BULK_DATA_HEADER_SIZE;
+    uint32_t remaining_frames = (file.size() - resume_offset + payload - 1) / payload;
+    bool resumed = second.intact && second.frames_sent - second.frames_retransmitted == remaining_frames;
+    printf("Resume: interrupted at %u/%u bytes after %u ms, resumed in %u ms sending %u new frames - %s\n",
+           (unsigned)resume_offset, (unsigned)file.size(), (unsigned)first.elapsed_ms, (unsigned)second.elapsed_ms,
+           (unsigned)(second.frames_sent - second.frames_retransmitted), resumed ? "OK" : "FAILED");
+    ok = ok && resumed;
+
+    return ok ? 0 : 1;
+}
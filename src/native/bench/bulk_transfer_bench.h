@@ -0,0 +1,6 @@
+#pragma once
+
+// Windowed BLE bulk transfer (bluetooth/bulk_transfer.h) against the legacy paced export over a
+// simulated lossy link: throughput, retransmissions and integrity per loss rate and window,
+// plus a transfer interrupted at 50% and resumed. Usage: `bench-bulk [options]`.
+int run_bulk_transfer_bench(int argc, char** argv);
@@ -0,0 +1,158 @@
+#include "circular_buffer_math_bench.h"
+#include "../../hardware/circular_buffer_math/circular_buffer_math.h"
+#include <Arduino.h>
+#include <chrono>
+#include <random>
+#include <memory>
+
+/*
+ * CircularBufferMath per-tick benchmark
+ *
+ * Replays a synthetic grind (idle, ramp, steady flow, coast, settle) into two
+ * CircularBufferMath instances - one answering through the buffer scan, one
+ * through the incremental window statistics - and runs the same query mix
+ * GrindController::update() issues every SYS_TASK_GRIND_CONTROL_INTERVAL_MS tick.
+ * Reports host CPU time per tick for both paths and the largest disagreement
+ * between them so a regression in either speed or correctness is visible.
+ */
+
+namespace {
+
+struct TickResult {
+    int64_t low_latency;
+    int64_t display;
+    int64_t settle_mean;
+    float std_dev;
+    float flow_200;
+    float flow_1500;
+    int32_t range;
+};
+
+// Query mix of one control tick: loop data, predictive flow, settling checks, range check
+TickResult run_control_tick(CircularBufferMath& filter) {
+    TickResult result;
+    result.low_latency = filter.get_raw_low_latency();
+    result.display = filter.get_raw_high_latency();
+    result.flow_200 = filter.get_raw_flow_rate(200);
+    filter.get_raw_flow_rate(500);
+    result.flow_1500 = filter.get_raw_flow_rate(1500);
+    result.std_dev = filter.get_standard_deviation_raw(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
+    filter.get_standard_deviation_raw(GRIND_MOTOR_SETTLING_TIME_MS);
+    result.settle_mean = filter.get_smoothed_raw(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
+    result.range = filter.get_max_raw(GRIND_SCALE_PRECISION_SETTLING_TIME_MS) -
+                   filter.get_min_raw(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
+    return result;
+}
+
+// Synthetic raw ADC signal of a single grind in counts
+int32_t synthetic_raw(uint32_t t_ms, std::mt19937& rng) {
+    const float counts_per_gram = -DEBUG_MOCK_CAL_FACTOR;
+    const float flow_gps = DEBUG_MOCK_FLOW_RATE_GPS;
+    std::normal_distribution<float> noise(0.0f, 40.0f);
+
+    float grams = 0.0f;
+    if (t_ms > 1000 && t_ms <= 1350) {
+        grams = flow_gps * ((t_ms - 1000) / 1000.0f) * ((t_ms - 1000) / 350.0f) * 0.5f;
+    } else if (t_ms > 1350 && t_ms <= 10000) {
+        grams = flow_gps * 0.175f + flow_gps * ((t_ms - 1350) / 1000.0f);
+    } else if (t_ms > 10000) {
+        grams = flow_gps * 0.175f + flow_gps * 8.65f;
+    }
+    return DEBUG_MOCK_BASELINE_RAW + (int32_t)(grams * counts_per_gram + noise(rng));
+}
+
+void run_rate(uint32_t sps, uint32_t duration_ms) {
+    std::unique_ptr<CircularBufferMath> scan(new CircularBufferMath());
+    std::unique_ptr<CircularBufferMath> incremental(new CircularBufferMath());
+    scan->set_windowed_stats_enabled(false);
+    incremental->set_windowed_stats_enabled(true);
+
+    std::mt19937 rng(1234);
+    const uint32_t tick_ms = SYS_TASK_GRIND_CONTROL_INTERVAL_MS;
+    const float sample_interval_ms = 1000.0f / sps;
+    float next_sample_ms = 0.0f;
+
+    double scan_tick_ns = 0.0;
+    double incremental_tick_ns = 0.0;
+    double scan_add_ns = 0.0;
+    double incremental_add_ns = 0.0;
+    uint32_t ticks = 0;
+    uint32_t samples = 0;
+
+    int64_t max_mean_diff = 0;
+    float max_std_diff = 0.0f;
+    float max_flow_diff = 0.0f;
+    int32_t max_range_diff = 0;
+
+    using clock = std::chrono::steady_clock;
+
+    // Replay the grind repeatedly so short durations still give stable timings
+    for (uint32_t t = 0; t < duration_ms; t += tick_ms) {
+        native_clock::set_ms(t + 1000);
+
+        while (next_sample_ms <= t) {
+            int32_t raw = synthetic_raw(t % 12000, rng);
+            uint32_t timestamp = millis();
+
+            auto a0 = clock::now();
+            scan->add_sample(raw, timestamp);
+            auto a1 = clock::now();
+            incremental->add_sample(raw, timestamp);
+            auto a2 = clock::now();
+
+            scan_add_ns += std::chrono::duration<double, std::nano>(a1 - a0).count();
+            incremental_add_ns += std::chrono::duration<double, std::nano>(a2 - a1).count();
+            next_sample_ms += sample_interval_ms;
+            samples++;
+        }
+
+        auto t0 = clock::now();
+        TickResult scan_result = run_control_tick(*scan);
+        auto t1 = clock::now();
+        TickResult incremental_result = run_control_tick(*incremental);
+        auto t2 = clock::now();
+
+        scan_tick_ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+        incremental_tick_ns += std::chrono::duration<double, std::nano>(t2 - t1).count();
+        ticks++;
+
+        max_mean_diff = std::max(max_mean_diff, std::abs(scan_result.low_latency - incremental_result.low_latency));
+        max_mean_diff = std::max(max_mean_diff, std::abs(scan_result.display - incremental_result.display));
+        max_mean_diff = std::max(max_mean_diff, std::abs(scan_result.settle_mean - incremental_result.settle_mean));
+        max_std_diff = std::max(max_std_diff, std::fabs(scan_result.std_dev - incremental_result.std_dev));
+        max_flow_diff = std::max(max_flow_diff, std::fabs(scan_result.flow_200 - incremental_result.flow_200));
+        max_flow_diff = std::max(max_flow_diff, std::fabs(scan_result.flow_1500 - incremental_result.flow_1500));
+        max_range_diff = std::max(max_range_diff, std::abs(scan_result.range - incremental_result.range));
+    }
+
+    double scan_per_tick = scan_tick_ns / ticks;
+    double incremental_per_tick = incremental_tick_ns / ticks;
+    double scan_add_per_tick = scan_add_ns / ticks;
+    double incremental_add_per_tick = incremental_add_ns / ticks;
+
+    printf("%3lu SPS | ticks %6lu samples %6lu\n", (unsigned long)sps, (unsigned long)ticks, (unsigned long)samples);
+    printf("        | queries/tick    scan %9.0f ns   incremental %9.0f ns   (%.1fx)\n",
+           scan_per_tick, incremental_per_tick, scan_per_tick / std::max(incremental_per_tick, 1.0));
+    printf("        | add_sample/tick scan %9.0f ns   incremental %9.0f ns\n",
+           scan_add_per_tick, incremental_add_per_tick);
+    printf("        | total/tick      scan %9.0f ns   incremental %9.0f ns   (%.1fx)\n",
+           scan_per_tick + scan_add_per_tick, incremental_per_tick + incremental_add_per_tick,
+           (scan_per_tick + scan_add_per_tick) / std::max(incremental_per_tick + incremental_add_per_tick, 1.0));
+    printf("        | max diff: mean %lld counts, stddev %.4f counts, flow %.4f counts/s, range %ld counts\n",
+           (long long)max_mean_diff, max_std_diff, max_flow_diff, (long)max_range_diff);
+}
+
+} // namespace
+
+int run_circular_buffer_bench(int argc, char** argv) {
+    uint32_t duration_ms = 120000;
+    if (argc > 0) {
+        duration_ms = (uint32_t)strtoul(argv[0], nullptr, 10);
+    }
+
+    printf("CircularBufferMath per-tick benchmark (%lums simulated, %dms control tick)\n",
+           (unsigned long)duration_ms, SYS_TASK_GRIND_CONTROL_INTERVAL_MS);
+    run_rate(10, duration_ms);
+    run_rate(80, duration_ms);
+    return 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Compares scan-based and incremental CircularBufferMath queries per control tick at 10 and 80 SPS.
+// Optional argument: simulated duration in milliseconds.
+int run_circular_buffer_bench(int argc, char** argv);
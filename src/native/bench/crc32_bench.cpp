@@ -0,0 +1,145 @@
+#include "crc32_bench.h"
+#include "../../system/crc32.h"
+#include <Arduino.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+/*
+ * CRC-32 kernel benchmark
+ *
+ * Checks crc32_update() against the standard check value and against a bitwise
+ * reference over random data split at random points (the incremental use in the
+ * session writer), then times three kernels over session-file sized buffers:
+ *   - bitwise: 8 shifts per byte, no table
+ *   - bytewise: one 256-entry table lookup per byte
+ *   - crc32_update: slice-by-4, four lookups per 4 bytes
+ */
+
+namespace {
+
+constexpr size_t kBufferSize = 4096;   // About one schema v3 session file
+
+uint32_t crc32_bitwise(uint32_t crc, const uint8_t* data, size_t length) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1u) ? 0xEDB88320u : 0u);
+        }
+    }
+    return ~crc;
+}
+
+uint32_t g_byte_table[256];
+
+void build_byte_table() {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1u) ? 0xEDB88320u : 0u);
+        }
+        g_byte_table[i] = crc;
+    }
+}
+
+uint32_t crc32_bytewise(uint32_t crc, const uint8_t* data, size_t length) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = (crc >> 8) ^ g_byte_table[(crc ^ data[i]) & 0xFFu];
+    }
+    return ~crc;
+}
+
+uint32_t crc32_sliced(uint32_t crc, const uint8_t* data, size_t length) {
+    return crc32_update(crc, data, length);
+}
+
+typedef uint32_t (*CrcKernel)(uint32_t crc, const uint8_t* data, size_t length);
+
+double time_kernel(CrcKernel kernel, const std::vector<uint8_t>& buffer, size_t total_bytes, uint32_t* crc_out) {
+    size_t passes = max<size_t>(1, total_bytes / buffer.size());
+    uint32_t crc = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t pass = 0; pass < passes; pass++) {
+        crc = kernel(crc, buffer.data(), buffer.size());
+    }
+    auto end = std::chrono::steady_clock::now();
+    *crc_out = crc;
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return (double)(passes * buffer.size()) / (1024.0 * 1024.0) / max(seconds, 1e-9);
+}
+
+} // namespace
+
+int run_crc32_bench(int argc, char** argv) {
+    size_t megabytes = (argc >= 1) ? (size_t)max(1, atoi(argv[0])) : 64;
+    build_byte_table();
+
+    // Known answer (CRC-32/ISO-HDLC, also zlib.crc32(b"123456789"))
+    const char* check_input = "123456789";
+    uint32_t check = crc32_update(0, check_input, 9);
+    printf("Check value: 0x%08X (expected 0xCBF43926) %s\n", check, check == 0xCBF43926u ? "OK" : "FAILED");
+    bool ok = check == 0xCBF43926u;
+
+    // Random data, chained over random splits and alignments like the encoder's small writes
+    std::mt19937 rng(42);
+    std::vector<uint8_t> buffer(kBufferSize + 3);
+    for (uint8_t& byte : buffer) {
+        byte = (uint8_t)rng();
+    }
+    uint32_t mismatches = 0;
+    for (int trial = 0; trial < 1000; trial++) {
+        size_t offset = rng() % 4;
+        size_t length = rng() % kBufferSize;
+        uint32_t reference = crc32_bitwise(0, buffer.data() + offset, length);
+        uint32_t chained = 0;
+        size_t position = 0;
+        while (position < length) {
+            size_t piece = min<size_t>(length - position, 1 + rng() % 64);
+            chained = crc32_update(chained, buffer.data() + offset + position, piece);
+            position += piece;
+        }
+        if (chained != reference || crc32_bytewise(0, buffer.data() + offset, length) != reference) {
+            mismatches++;
+        }
+    }
+    printf("Incremental/unaligned vs bitwise reference: %u mismatches in 1000 trials %s\n",
+           (unsigned)mismatches, mismatches == 0 ? "OK" : "FAILED");
+    ok = ok && mismatches == 0;
+
+    buffer.resize(kBufferSize);
+    size_t total_bytes = megabytes * 1024 * 1024;
+    struct {
+        const char* name;
+        CrcKernel kernel;
+        size_t bytes;
+    } kernels[] = {
+        {"bitwise", crc32_bitwise, max<size_t>(kBufferSize, total_bytes / 16)},
+        {"bytewise", crc32_bytewise, total_bytes},
+        {"crc32_update", crc32_sliced, total_bytes},
+    };
+
+    printf("Throughput over %u-byte buffers (host):\n", (unsigned)kBufferSize);
+    uint32_t expected_crc = 0;
+    double bytewise_rate = 0.0;
+    for (const auto& entry : kernels) {
+        uint32_t crc = 0;
+        double rate = time_kernel(entry.kernel, buffer, entry.bytes, &crc);
+        if (entry.kernel == crc32_bytewise) {
+            bytewise_rate = rate;
+            expected_crc = crc;
+        } else if (entry.kernel == crc32_sliced && crc != expected_crc) {
+            printf("  %s result differs from bytewise\n", entry.name);
+            ok = false;
+        }
+        printf("  %-13s %9.1f MB/s  %7.2f us per session file", entry.name, rate,
+               kBufferSize / (rate * 1024.0 * 1024.0) * 1e6);
+        if (bytewise_rate > 0.0 && entry.kernel == crc32_sliced) {
+            printf("  (%.1fx bytewise)", rate / bytewise_rate);
+        }
+        printf("\n");
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Throughput of the crc32_update() kernel against bitwise and single-table references,
+// with known-answer and incremental-chaining checks. Optional argument: megabytes per kernel.
+int run_crc32_bench(int argc, char** argv);
@@ -0,0 +1,255 @@
+#include "flow_percentile_report.h"
+#include "../../hardware/circular_buffer_math/circular_buffer_math.h"
+#include "../../config/constants.h"
+#include <Arduino.h>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <vector>
+
+/*
+ * 95th percentile flow rate report
+ *
+ * Feeds synthetic grinds (idle, ramp, modulated flow, coast, settle) into two
+ * CircularBufferMath instances - one answering get_raw_flow_rate_95th_percentile()
+ * with the single-pass sub-window sweep, one through the original scan per
+ * sub-window - and issues the pulse flow query (PULSE_FLOW_WINDOW_MS) on every control
+ * tick. ADC conversions run at the configured rate with optional jitter and are
+ * timestamped when the sampling task polls them, as on the device.
+ *
+ * Reports the disagreement over all ticks and at the motor stop tick, where
+ * WeightGrindStrategy takes the value, plus host CPU time per query and per
+ * add_sample(). The two should always match: the sweep only changes how the
+ * sub-windows are found.
+ *
+ * With --csv the samples (in grams) and both answers are written out so
+ * tools/streamlit-reports/flow_percentile_accuracy.py can check them against the
+ * Python reference implementation used by the grind reports.
+ */
+
+namespace {
+
+const uint32_t PULSE_FLOW_WINDOW_MS = 2500;   // WeightGrindStrategy motor stop query
+const float MATCH_TOLERANCE_GPS = 0.001f;
+
+struct ReportConfig {
+    uint32_t grinds = 200;
+    uint32_t sps = HW_LOADCELL_SAMPLE_RATE_SPS;
+    float jitter_ms = 0.0f;
+    uint32_t poll_ms = SYS_TASK_WEIGHT_SAMPLING_INTERVAL_MS;
+    float noise_raw = DEBUG_MOCK_GRIND_NOISE_RAW;
+    uint32_t seed = 1;
+    const char* csv_path = nullptr;
+};
+
+struct ErrorStats {
+    std::vector<float> abs_errors;
+    uint32_t matches = 0;
+
+    void add(float sweep, float scan) {
+        float error = std::fabs(sweep - scan);
+        abs_errors.push_back(error);
+        if (error <= MATCH_TOLERANCE_GPS) matches++;
+    }
+};
+
+float percentile(std::vector<float> values, float p) {
+    if (values.empty()) return 0.0f;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p / 100.0f * (values.size() - 1) + 0.5f);
+    return values[std::min(index, values.size() - 1)];
+}
+
+void print_error_stats(const char* label, const ErrorStats& stats) {
+    if (stats.abs_errors.empty()) return;
+    double sum = 0.0;
+    for (float e : stats.abs_errors) sum += e;
+    printf("  %-10s n %7lu  match %6.2f%%  mae %.4f  p99 %.4f  max %.4f g/s\n",
+           label, (unsigned long)stats.abs_errors.size(),
+           100.0 * stats.matches / stats.abs_errors.size(), sum / stats.abs_errors.size(),
+           percentile(stats.abs_errors, 99), percentile(stats.abs_errors, 100));
+}
+
+bool parse_args(int argc, char** argv, ReportConfig& config) {
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--help") == 0 || i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--grinds") == 0) config.grinds = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--sps") == 0) config.sps = std::max(1UL, strtoul(value, nullptr, 10));
+        else if (strcmp(arg, "--jitter") == 0) config.jitter_ms = strtof(value, nullptr);
+        else if (strcmp(arg, "--poll") == 0) config.poll_ms = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--noise") == 0) config.noise_raw = strtof(value, nullptr);
+        else if (strcmp(arg, "--seed") == 0) config.seed = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--csv") == 0) config.csv_path = value;
+        else return false;
+    }
+    return true;
+}
+
+void print_help() {
+    printf("Usage: p95-report [options]\n"
+           "  --grinds N      number of synthetic grinds (default 200)\n"
+           "  --sps N         ADC conversion rate (default %d)\n"
+           "  --jitter MS     +/- uniform jitter on conversion times (default 0)\n"
+           "  --poll MS       sampling task poll interval, 0 = stamp at conversion (default %d)\n"
+           "  --noise RAW     peak grinding noise in ADC counts (default %.0f)\n"
+           "  --seed N        RNG seed (default 1)\n"
+           "  --csv FILE      write samples and query results for flow_percentile_accuracy.py\n",
+           HW_LOADCELL_SAMPLE_RATE_SPS, SYS_TASK_WEIGHT_SAMPLING_INTERVAL_MS, DEBUG_MOCK_GRIND_NOISE_RAW);
+}
+
+} // namespace
+
+int run_flow_percentile_report(int argc, char** argv) {
+    ReportConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_help();
+        return 1;
+    }
+
+    FILE* csv = nullptr;
+    if (config.csv_path) {
+        csv = fopen(config.csv_path, "w");
+        if (!csv) {
+            printf("Cannot open %s\n", config.csv_path);
+            return 1;
+        }
+        fprintf(csv, "grind,kind,timestamp_ms,weight_grams,sweep_gps,scan_gps\n");
+    }
+
+    std::unique_ptr<CircularBufferMath> sweep(new CircularBufferMath());
+    std::unique_ptr<CircularBufferMath> scan(new CircularBufferMath());
+    scan->set_flow_percentile_sweep_enabled(false);
+
+    std::mt19937 rng(config.seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> gaussian(0.0f, 1.0f);
+
+    const float counts_per_gram = -DEBUG_MOCK_CAL_FACTOR;
+    const float period_ms = 1000.0f / config.sps;
+    const uint32_t tick_ms = SYS_TASK_GRIND_CONTROL_INTERVAL_MS;
+
+    ErrorStats all_ticks;
+    ErrorStats stop_ticks;
+    double sweep_query_ns = 0.0;
+    double scan_query_ns = 0.0;
+    double sweep_add_ns = 0.0;
+    double scan_add_ns = 0.0;
+    uint64_t queries = 0;
+    uint64_t samples = 0;
+
+    using clock = std::chrono::steady_clock;
+
+    for (uint32_t grind = 0; grind < config.grinds; grind++) {
+        sweep->clear_all_samples();
+        scan->clear_all_samples();
+
+        // Grind timeline relative to grind start
+        const uint32_t motor_start_ms = 1500;
+        const uint32_t flow_start_ms = motor_start_ms + DEBUG_MOCK_START_DELAY_MS;
+        const uint32_t motor_stop_ms = flow_start_ms + 4000 + (uint32_t)(unit(rng) * 8000.0f);
+        const uint32_t flow_stop_ms = motor_stop_ms + DEBUG_MOCK_STOP_DELAY_MS;
+        const uint32_t grind_end_ms = flow_stop_ms + DEBUG_MOCK_FLOW_RAMP_MS + 2000;
+        const float flow_gps = DEBUG_MOCK_FLOW_RATE_GPS * (0.7f + 0.6f * unit(rng));
+        const float modulation_phase = unit(rng) * 6.2832f;
+
+        const uint32_t base_ms = 10000 + grind * 100000;
+        float grams = 0.0f;
+        float next_conversion_ms = period_ms * unit(rng);
+        int32_t latest_raw = 0;
+        bool conversion_pending = false;
+
+        for (uint32_t t = 0; t < grind_end_ms; t++) {
+            native_clock::set_ms(base_ms + t);
+
+            // Plant: ramped, slowly modulated flow between flow start and flow stop
+            float ramp = 0.0f;
+            if (t >= flow_start_ms && t < flow_stop_ms) {
+                ramp = std::min(1.0f, (t - flow_start_ms) / (float)DEBUG_MOCK_FLOW_RAMP_MS);
+            } else if (t >= flow_stop_ms && t < flow_stop_ms + DEBUG_MOCK_FLOW_RAMP_MS) {
+                ramp = 1.0f - (t - flow_stop_ms) / (float)DEBUG_MOCK_FLOW_RAMP_MS;
+            }
+            float modulation = 1.0f + 0.15f * std::sin(modulation_phase + t * 0.0037f);
+            grams += flow_gps * ramp * modulation / 1000.0f;
+
+            if (t >= next_conversion_ms) {
+                bool grinding = (t >= motor_start_ms && t < flow_stop_ms);
+                float noise_peak = grinding ? config.noise_raw : DEBUG_MOCK_IDLE_NOISE_RAW;
+                latest_raw = DEBUG_MOCK_BASELINE_RAW + (int32_t)(grams * counts_per_gram +
+                                                                 gaussian(rng) * noise_peak / 3.0f);
+                conversion_pending = true;
+                float jitter = config.jitter_ms * (2.0f * unit(rng) - 1.0f);
+                next_conversion_ms += std::max(1.0f, period_ms + jitter);
+            }
+
+            if (conversion_pending && (config.poll_ms == 0 || t % config.poll_ms == 0)) {
+                uint32_t timestamp = millis();
+                auto a0 = clock::now();
+                sweep->add_sample(latest_raw, timestamp);
+                auto a1 = clock::now();
+                scan->add_sample(latest_raw, timestamp);
+                auto a2 = clock::now();
+                sweep_add_ns += std::chrono::duration<double, std::nano>(a1 - a0).count();
+                scan_add_ns += std::chrono::duration<double, std::nano>(a2 - a1).count();
+                conversion_pending = false;
+                samples++;
+
+                if (csv) {
+                    fprintf(csv, "%lu,sample,%lu,%.6f,,\n", (unsigned long)grind, (unsigned long)timestamp,
+                            (latest_raw - DEBUG_MOCK_BASELINE_RAW) / counts_per_gram);
+                }
+            }
+
+            if (t % tick_ms != 0) continue;
+
+            auto q0 = clock::now();
+            float sweep_rate = sweep->get_raw_flow_rate_95th_percentile(PULSE_FLOW_WINDOW_MS);
+            auto q1 = clock::now();
+            float scan_rate = scan->get_raw_flow_rate_95th_percentile(PULSE_FLOW_WINDOW_MS);
+            auto q2 = clock::now();
+            sweep_query_ns += std::chrono::duration<double, std::nano>(q1 - q0).count();
+            scan_query_ns += std::chrono::duration<double, std::nano>(q2 - q1).count();
+            queries++;
+
+            float sweep_gps = sweep_rate / counts_per_gram;
+            float scan_gps = scan_rate / counts_per_gram;
+            bool is_stop_tick = (t >= motor_stop_ms && t < motor_stop_ms + tick_ms);
+            all_ticks.add(sweep_gps, scan_gps);
+            if (is_stop_tick) stop_ticks.add(sweep_gps, scan_gps);
+
+            if (csv) {
+                fprintf(csv, "%lu,%s,%lu,,%.6f,%.6f\n", (unsigned long)grind, is_stop_tick ? "stop" : "query",
+                        (unsigned long)millis(), sweep_gps, scan_gps);
+            }
+        }
+    }
+
+    if (csv) {
+        fclose(csv);
+    }
+
+    printf("95th percentile flow rate: single-pass sweep vs scan per sub-window (%lums window)\n",
+           (unsigned long)PULSE_FLOW_WINDOW_MS);
+    printf("  grinds %lu  %lu SPS  jitter +/-%.1fms  poll %lums  samples %llu  queries %llu\n",
+           (unsigned long)config.grinds, (unsigned long)config.sps, config.jitter_ms,
+           (unsigned long)config.poll_ms, (unsigned long long)samples, (unsigned long long)queries);
+    printf("Disagreement |sweep - scan| (match = within %.3f g/s):\n", MATCH_TOLERANCE_GPS);
+    print_error_stats("all ticks", all_ticks);
+    print_error_stats("motor stop", stop_ticks);
+    if (queries > 0 && samples > 0) {
+        double sweep_per_query = sweep_query_ns / queries;
+        double scan_per_query = scan_query_ns / queries;
+        printf("Host cost:\n");
+        printf("  query      sweep %8.0f ns   scan %8.0f ns   (%.1fx)\n",
+               sweep_per_query, scan_per_query, scan_per_query / std::max(sweep_per_query, 1.0));
+        printf("  add_sample sweep %8.0f ns   scan %8.0f ns   (no per-sample percentile state)\n",
+               sweep_add_ns / samples, scan_add_ns / samples);
+    }
+    if (config.csv_path) {
+        printf("Wrote %s\n", config.csv_path);
+    }
+    return 0;
+}
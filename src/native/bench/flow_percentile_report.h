@@ -0,0 +1,6 @@
+#pragma once
+
+// Accuracy and cost of the single-pass 95th percentile flow rate sweep against the sub-window scan
+// over synthetic grinds. Optionally exports samples and query results as CSV for
+// tools/streamlit-reports/flow_percentile_accuracy.py. Options are listed by `p95-report --help`.
+int run_flow_percentile_report(int argc, char** argv);
@@ -0,0 +1,231 @@
+#include "ota_apply_bench.h"
+#include "../../bluetooth/ota_patch_stream.h"
+#include <Arduino.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/*
+ * OTA patch apply harness
+ *
+ * Applies a sequential heatshrink detools patch (what tools/grinder.py uploads) to FROM and
+ * compares the result with EXPECTED when given. FROM "-" is a full update, patched against zeros
+ * like the firmware does without a source partition.
+ *
+ *   - streaming: the patch is fed in --chunk pieces as BLE writes would deliver them and the
+ *     image is written as it comes out; only finish() is left once the last chunk arrived
+ *   - staged:    the previous firmware flow - the whole patch is copied to a staging buffer
+ *     (the "patch" partition) and applied in one pass after the transfer
+ *
+ * Times are host CPU time. On the device the same split decides how long the grinder sits in
+ * kamikaze mode after the transfer, and flash bytes written are what each flow erases and programs.
+ */
+
+namespace {
+
+constexpr int kRuns = 5;
+
+class MemorySource : public OtaImageSource {
+public:
+    explicit MemorySource(const std::vector<uint8_t>* image) : image_(image) {}
+
+    bool read(uint32_t offset, uint8_t* buffer, size_t length) override {
+        if (offset + length > image_->size()) return false;
+        memcpy(buffer, image_->data() + offset, length);
+        return true;
+    }
+
+    uint32_t size() const override { return (uint32_t)image_->size(); }
+
+private:
+    const std::vector<uint8_t>* image_;
+};
+
+class MemorySink : public OtaImageSink {
+public:
+    bool write(const uint8_t* data, size_t length) override {
+        bytes.insert(bytes.end(), data, data + length);
+        writes++;
+        return true;
+    }
+
+    std::vector<uint8_t> bytes;
+    uint32_t writes = 0;
+};
+
+struct ApplyResult {
+    int status = 0;                 // Image size or negative detools error
+    double total_ms = 0.0;          // First chunk to image complete
+    double after_transfer_ms = 0.0; // Last chunk to image complete
+    uint32_t sink_writes = 0;
+    std::vector<uint8_t> image;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsed_ms(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+bool read_file(const std::string& path, std::vector<uint8_t>& data) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(file);
+    return true;
+}
+
+// One OtaPatchStream for all runs, like the single allocation in OTAHandler
+OtaPatchStream stream;
+
+ApplyResult apply_streaming(OtaImageSource* source, const std::vector<uint8_t>& patch, size_t chunk) {
+    ApplyResult result;
+    MemorySink sink;
+    Clock::time_point start = Clock::now();
+    result.status = stream.begin(source, &sink, (uint32_t)patch.size());
+    for (size_t offset = 0; result.status >= 0 && offset < patch.size(); offset += chunk) {
+        result.status = stream.write(patch.data() + offset, std::min(chunk, patch.size() - offset));
+    }
+    Clock::time_point transferred = Clock::now();
+    if (result.status >= 0) {
+        result.status = stream.finish();
+    }
+    Clock::time_point end = Clock::now();
+
+    result.total_ms = elapsed_ms(start, end);
+    result.after_transfer_ms = elapsed_ms(transferred, end);
+    result.sink_writes = sink.writes;
+    result.image.swap(sink.bytes);
+    return result;
+}
+
+ApplyResult apply_staged(OtaImageSource* source, const std::vector<uint8_t>& patch, size_t chunk) {
+    ApplyResult result;
+    MemorySink sink;
+    std::vector<uint8_t> staged;
+    staged.reserve(patch.size());
+    Clock::time_point start = Clock::now();
+    for (size_t offset = 0; offset < patch.size(); offset += chunk) {
+        size_t length = std::min(chunk, patch.size() - offset);
+        staged.insert(staged.end(), patch.data() + offset, patch.data() + offset + length);
+    }
+    Clock::time_point transferred = Clock::now();
+    result.status = stream.begin(source, &sink, (uint32_t)staged.size());
+    if (result.status >= 0) {
+        result.status = stream.write(staged.data(), staged.size());
+    }
+    if (result.status >= 0) {
+        result.status = stream.finish();
+    }
+    Clock::time_point end = Clock::now();
+
+    result.total_ms = elapsed_ms(start, end);
+    result.after_transfer_ms = elapsed_ms(transferred, end);
+    result.sink_writes = sink.writes;
+    result.image.swap(sink.bytes);
+    return result;
+}
+
+// Best of kRuns, so a scheduler hiccup does not decide the comparison
+ApplyResult best_of(ApplyResult (*apply)(OtaImageSource*, const std::vector<uint8_t>&, size_t),
+                    OtaImageSource* source, const std::vector<uint8_t>& patch, size_t chunk) {
+    ApplyResult best = apply(source, patch, chunk);
+    for (int run = 1; run < kRuns && best.status >= 0; run++) {
+        ApplyResult next = apply(source, patch, chunk);
+        if (next.total_ms < best.total_ms) {
+            best.total_ms = next.total_ms;
+            best.after_transfer_ms = next.after_transfer_ms;
+        }
+    }
+    return best;
+}
+
+void print_result(const char* label, const ApplyResult& result, uint32_t flash_bytes) {
+    double mb_per_s = result.total_ms > 0.0 ? result.image.size() / 1e6 / (result.total_ms / 1000.0) : 0.0;
+    printf("  %-10s %8.1f MB/s  %8.2f ms total  %8.2f ms after last chunk  %4u image writes  %7u KB flash written\n",
+           label, mb_per_s, result.total_ms, result.after_transfer_ms, (unsigned)result.sink_writes,
+           (unsigned)(flash_bytes / 1024));
+}
+
+// Offset of the first difference, or -1 when equal
+long first_mismatch(const std::vector<uint8_t>& image, const std::vector<uint8_t>& expected) {
+    size_t common = std::min(image.size(), expected.size());
+    for (size_t i = 0; i < common; i++) {
+        if (image[i] != expected[i]) return (long)i;
+    }
+    return image.size() == expected.size() ? -1 : (long)common;
+}
+
+void print_help() {
+    printf("Usage: ota-apply [--chunk N] FROM|- PATCH [EXPECTED]\n"
+           "  FROM       running firmware image, or - for a full update\n"
+           "  PATCH      sequential heatshrink detools patch\n"
+           "  EXPECTED   new firmware image to compare the result with\n"
+           "  --chunk N  patch bytes per write, like one BLE OTA write (default 512)\n");
+}
+
+} // namespace
+
+int run_ota_apply_bench(int argc, char** argv) {
+    size_t chunk = 512;     // CHUNK_SIZE in tools/ble/grinder-ble.py
+    std::vector<std::string> paths;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+            chunk = std::max(1UL, strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--help") == 0) {
+            print_help();
+            return 1;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.size() < 2 || paths.size() > 3) {
+        print_help();
+        return 1;
+    }
+
+    bool full_update = paths[0] == "-";
+    std::vector<uint8_t> from, patch, expected;
+    if ((!full_update && !read_file(paths[0], from)) || !read_file(paths[1], patch) ||
+        (paths.size() == 3 && !read_file(paths[2], expected))) {
+        printf("Could not read input files\n");
+        return 1;
+    }
+    MemorySource from_source(&from);
+    OtaImageSource* source = full_update ? nullptr : &from_source;
+
+    printf("%s update: %u KB source, %u KB patch, %u-byte chunks\n", full_update ? "Full" : "Delta",
+           (unsigned)(from.size() / 1024), (unsigned)(patch.size() / 1024), (unsigned)chunk);
+
+    ApplyResult streaming = best_of(apply_streaming, source, patch, chunk);
+    if (streaming.status < 0) {
+        printf("Patch failed: %s\n", detools_error_as_string(streaming.status));
+        return 1;
+    }
+    ApplyResult staged = best_of(apply_staged, source, patch, chunk);
+
+    uint32_t image_size = (uint32_t)streaming.image.size();
+    print_result("streaming", streaming, image_size);
+    print_result("staged", staged, (uint32_t)patch.size() + image_size);
+    printf("  Apply state %u bytes (detools %u, write buffer %u), no heap; staged flow also needs the %u KB patch partition\n",
+           (unsigned)sizeof(OtaPatchStream), (unsigned)sizeof(detools_apply_patch_t),
+           (unsigned)BLE_OTA_WRITE_BUFFER_BYTES, (unsigned)(patch.size() / 1024));
+
+    bool ok = staged.status == streaming.status && staged.image == streaming.image;
+    printf("Image: %u bytes, streaming and staged %s\n", (unsigned)image_size, ok ? "identical" : "DIFFER");
+    if (!expected.empty()) {
+        long mismatch = first_mismatch(streaming.image, expected);
+        if (mismatch < 0) {
+            printf("Matches EXPECTED\n");
+        } else {
+            printf("MISMATCH with EXPECTED at byte %ld (%u vs %u bytes)\n", mismatch, image_size,
+                   (unsigned)expected.size());
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Streaming OTA patch apply (bluetooth/ota_patch_stream.h) between two firmware images on disk:
+// throughput, the window left after the last chunk, flash bytes written and state size, against
+// staging the whole patch first. Usage: `ota-apply [--chunk N] FROM|- PATCH [EXPECTED]`.
+int run_ota_apply_bench(int argc, char** argv);
@@ -0,0 +1,226 @@
+#include "ota_resume_bench.h"
+#include "../../bluetooth/ota_block_receiver.h"
+#include "../../system/crc32.h"
+#include <Arduino.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+/*
+ * Resumable OTA benchmark
+ *
+ * The client follows tools/ble/grinder-ble.py: CHUNK_SIZE writes, and with block CRCs a BLOCK
+ * command after every BLE_OTA_BLOCK_BYTES. Each write is cut off by a disconnect with
+ * probability chunk/(--mtbf KB), or silently lost with probability --lose.
+ *
+ *   restart: the original protocol - a disconnect aborts the update and the upload starts again
+ *            at 0, lost writes go unnoticed until the patch fails to apply
+ *   resume:  the receiver pauses at the last verified block, the client reconnects and
+ *            continues there; a lost write fails that block's CRC and the block is resent
+ *
+ * Time is the bytes sent at --kbps plus --reconnect seconds per disconnect.
+ */
+
+namespace {
+
+struct BenchConfig {
+    uint32_t patch_bytes = 1024 * 1024;   // A full update of the ~1.5 MB image
+    uint32_t trials = 200;
+    float mtbf_kb = 256.0f;
+    float lose = 0.0f;
+    float kbps = 20.0f;                   // Upload rate of the 512-byte writes with 10 ms pacing
+    float reconnect_s = 4.0f;             // Scan, connect and service discovery
+    uint32_t max_attempts = 6;            // OTA_MAX_RESUMES + 1 in tools/ble/grinder-ble.py
+    uint32_t seed = 1;
+};
+
+constexpr uint32_t kChunkBytes = 512;     // CHUNK_SIZE in tools/ble/grinder-ble.py
+
+class MemoryPatchSink : public OtaPatchSink {
+public:
+    bool write_patch(const uint8_t* data, size_t length) override {
+        bytes.insert(bytes.end(), data, data + length);
+        return true;
+    }
+    std::vector<uint8_t> bytes;
+};
+
+struct TrialResult {
+    uint64_t bytes_sent = 0;
+    uint32_t disconnects = 0;
+    uint32_t blocks_resent = 0;
+    bool completed = false;
+    bool intact = false;
+};
+
+struct SimLink {
+    const BenchConfig* config;
+    std::mt19937* rng;
+
+    bool disconnects() {
+        float p = kChunkBytes / (config->mtbf_kb * 1024.0f);
+        return std::uniform_real_distribution<float>(0.0f, 1.0f)(*rng) < p;
+    }
+    bool loses() { return std::uniform_real_distribution<float>(0.0f, 1.0f)(*rng) < config->lose; }
+};
+
+TrialResult run_restart(const std::vector<uint8_t>& patch, SimLink& link, uint32_t max_attempts) {
+    TrialResult result;
+    OtaBlockReceiver receiver;
+    MemoryPatchSink sink;
+
+    for (uint32_t attempt = 0; attempt < max_attempts && !result.completed; attempt++) {
+        receiver.begin((uint32_t)patch.size(), 0, false);
+        sink.bytes.clear();
+        bool dropped = false;
+        for (uint32_t offset = 0; offset < patch.size() && !dropped; offset += kChunkBytes) {
+            uint32_t length = std::min<uint32_t>(kChunkBytes, (uint32_t)patch.size() - offset);
+            result.bytes_sent += length;
+            if (link.disconnects()) {
+                dropped = true;
+                result.disconnects++;
+            } else if (!link.loses()) {
+                receiver.write(patch.data() + offset, length, &sink);
+            }
+        }
+        // A lost write leaves the patch short; the client only learns that from the END
+        result.completed = !dropped;
+    }
+    result.intact = result.completed && sink.bytes == patch;
+    return result;
+}
+
+TrialResult run_resume(const std::vector<uint8_t>& patch, SimLink& link, uint32_t max_attempts) {
+    TrialResult result;
+    OtaBlockReceiver receiver;
+    MemoryPatchSink sink;
+    uint32_t patch_size = (uint32_t)patch.size();
+    receiver.begin(patch_size, crc32_update(0, patch.data(), patch.size()), true);
+
+    // Like the client, only give up after max_attempts resumes in a row without progress
+    for (uint32_t stalled = 0; stalled < max_attempts && !receiver.complete();) {
+        // START answers with the resume offset
+        uint32_t resumed_at = receiver.committed();
+        bool interrupted = false;
+        for (uint32_t block = receiver.committed(); block < patch_size && !interrupted; block += BLE_OTA_BLOCK_BYTES) {
+            uint32_t block_length = std::min<uint32_t>(BLE_OTA_BLOCK_BYTES, patch_size - block);
+            for (uint32_t offset = block; offset < block + block_length; offset += kChunkBytes) {
+                uint32_t length = std::min<uint32_t>(kChunkBytes, block + block_length - offset);
+                result.bytes_sent += length;
+                if (link.disconnects()) {
+                    interrupted = true;
+                    result.disconnects++;
+                    receiver.drop_partial();
+                    break;
+                }
+                if (!link.loses()) {
+                    receiver.write(patch.data() + offset, length, &sink);
+                }
+            }
+            if (!interrupted && receiver.end_block(block, crc32_update(0, patch.data() + block, block_length),
+                                                   &sink) != OTA_BLOCK_OK) {
+                interrupted = true;
+                result.blocks_resent++;
+            }
+        }
+        stalled = receiver.committed() > resumed_at ? 0 : stalled + 1;
+    }
+    result.completed = receiver.complete();
+    result.intact = result.completed && sink.bytes == patch;
+    return result;
+}
+
+void print_results(const char* label, const std::vector<TrialResult>& results, const BenchConfig& config) {
+    double bytes = 0.0, disconnects = 0.0, resent = 0.0;
+    uint32_t completed = 0, intact = 0;
+    for (const TrialResult& result : results) {
+        bytes += result.bytes_sent;
+        disconnects += result.disconnects;
+        resent += result.blocks_resent;
+        completed += result.completed ? 1 : 0;
+        intact += result.intact ? 1 : 0;
+    }
+    size_t n = results.size();
+    double mean_bytes = bytes / n;
+    double seconds = mean_bytes / 1024.0 / config.kbps + disconnects / n * config.reconnect_s;
+    printf("  %-8s %8.0f KB sent (%5.2fx patch)  %6.1f s  %5.2f disconnects  %5.2f blocks resent  "
+           "completed %3u/%-3u  intact %3u/%-3u\n",
+           label, mean_bytes / 1024.0, mean_bytes / config.patch_bytes, seconds, disconnects / n, resent / n,
+           (unsigned)completed, (unsigned)n, (unsigned)intact, (unsigned)n);
+}
+
+bool parse_args(int argc, char** argv, BenchConfig& config) {
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--help") == 0 || i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--bytes") == 0) config.patch_bytes = std::max(1UL, strtoul(value, nullptr, 10));
+        else if (strcmp(arg, "--trials") == 0) config.trials = std::max(1UL, strtoul(value, nullptr, 10));
+        else if (strcmp(arg, "--mtbf") == 0) config.mtbf_kb = std::max(1.0f, strtof(value, nullptr));
+        else if (strcmp(arg, "--lose") == 0) config.lose = std::min(1.0f, std::max(0.0f, strtof(value, nullptr)));
+        else if (strcmp(arg, "--kbps") == 0) config.kbps = std::max(0.1f, strtof(value, nullptr));
+        else if (strcmp(arg, "--reconnect") == 0) config.reconnect_s = std::max(0.0f, strtof(value, nullptr));
+        else if (strcmp(arg, "--attempts") == 0) config.max_attempts = std::max(1UL, strtoul(value, nullptr, 10));
+        else if (strcmp(arg, "--seed") == 0) config.seed = strtoul(value, nullptr, 10);
+        else return false;
+    }
+    return true;
+}
+
+void print_help() {
+    BenchConfig defaults;
+    printf("Usage: bench-ota-resume [options]\n"
+           "  --bytes N       patch size (default %u)\n"
+           "  --trials N      uploads per configuration (default %u)\n"
+           "  --mtbf KB       mean KB between disconnects (default %.0f; also 4x and 1/4x that)\n"
+           "  --lose P        probability a write is silently lost (default 0)\n"
+           "  --kbps R        upload rate for the time estimate (default %.0f)\n"
+           "  --reconnect S   seconds per reconnect (default %.0f)\n"
+           "  --attempts N    restarts, or resumes in a row without progress, before giving up (default %u)\n"
+           "  --seed N        RNG seed (default 1)\n",
+           (unsigned)defaults.patch_bytes, (unsigned)defaults.trials, defaults.mtbf_kb, defaults.kbps,
+           defaults.reconnect_s, (unsigned)defaults.max_attempts);
+}
+
+} // namespace
+
+int run_ota_resume_bench(int argc, char** argv) {
+    BenchConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_help();
+        return 1;
+    }
+
+    std::mt19937 rng(config.seed);
+    std::vector<uint8_t> patch(config.patch_bytes);
+    for (uint8_t& byte : patch) {
+        byte = (uint8_t)rng();
+    }
+
+    printf("%u KB patch, %u-byte writes, %u-byte blocks, %.1f%% writes lost, %u trials\n",
+           (unsigned)(config.patch_bytes / 1024), (unsigned)kChunkBytes, (unsigned)BLE_OTA_BLOCK_BYTES,
+           config.lose * 100.0f, (unsigned)config.trials);
+
+    bool resume_ok = true;
+    const float mtbf_scale[] = {4.0f, 1.0f, 0.25f};
+    for (float scale : mtbf_scale) {
+        BenchConfig run = config;
+        run.mtbf_kb = config.mtbf_kb * scale;
+        printf("Disconnect every %.0f KB on average:\n", run.mtbf_kb);
+
+        std::vector<TrialResult> restart, resume;
+        for (uint32_t trial = 0; trial < config.trials; trial++) {
+            std::mt19937 trial_rng(config.seed * 7919 + trial);
+            SimLink link = {&run, &trial_rng};
+            restart.push_back(run_restart(patch, link, config.max_attempts));
+            trial_rng.seed(config.seed * 7919 + trial);
+            resume.push_back(run_resume(patch, link, config.max_attempts));
+            resume_ok = resume_ok && (resume.back().intact || !resume.back().completed);
+        }
+        print_results("restart", restart, run);
+        print_results("resume", resume, run);
+    }
+    return resume_ok ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Resumable OTA upload (bluetooth/ota_block_receiver.h) against restarting from byte 0 over a
+// link with random disconnects and lost writes: bytes sent, upload time and intact patches.
+// Usage: `bench-ota-resume [options]`.
+int run_ota_resume_bench(int argc, char** argv);
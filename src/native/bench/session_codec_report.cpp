@@ -0,0 +1,307 @@
+#include "session_codec_report.h"
+#include "../../logging/grind_logging.h"
+#include "../../logging/session_codec.h"
+#include "../../system/crc32.h"
+#include <Arduino.h>
+#include <dirent.h>
+#include <string>
+#include <vector>
+
+/*
+ * Session file compression report
+ *
+ * Reads every session_*.bin under DIR (or DIR/sessions) and compares the schema v2
+ * layout (raw GrindEvent and GrindMeasurement records) against the v3 event and
+ * measurement blocks:
+ *   - v3 files are decoded and their size compared with the raw layout they replace
+ *   - v2 files are encoded, decoded again and compared field by field, which bounds
+ *     the quantization error the v3 format adds (events must round-trip exactly)
+ *
+ * session-verify checks the same files the way an importer should before trusting them:
+ * header/file-name agreement, the size recorded in the header, the CRC-32 and a full decode.
+ */
+
+namespace {
+
+class MemorySink : public SessionBlockSink {
+public:
+    bool write(const uint8_t* data, size_t length) override {
+        bytes.insert(bytes.end(), data, data + length);
+        return true;
+    }
+    std::vector<uint8_t> bytes;
+};
+
+struct FieldError {
+    float weight = 0.0f;
+    float weight_delta = 0.0f;
+    float flow_rate = 0.0f;
+    float stop_target = 0.0f;
+    uint32_t exact_mismatches = 0;   // timestamp, sequence, phase or motor state differ
+    uint32_t event_mismatches = 0;
+};
+
+struct ReportTotals {
+    uint32_t v2_files = 0;
+    uint32_t v3_files = 0;
+    uint32_t failed_files = 0;
+    uint64_t measurements = 0;
+    uint64_t raw_bytes = 0;
+    uint64_t v3_bytes = 0;
+    uint64_t event_bytes = 0;
+    uint64_t block_bytes = 0;
+    uint64_t events = 0;
+    FieldError error;
+};
+
+bool read_file(const std::string& path, std::vector<uint8_t>& data) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(file);
+    return true;
+}
+
+void collect_session_files(const std::string& dir, std::vector<std::string>& paths) {
+    DIR* handle = opendir(dir.c_str());
+    if (!handle) return;
+    while (struct dirent* entry = readdir(handle)) {
+        std::string name = entry->d_name;
+        if (name.rfind("session_", 0) == 0 && name.size() > 4 && name.compare(name.size() - 4, 4, ".bin") == 0) {
+            paths.push_back(dir + "/" + name);
+        }
+    }
+    closedir(handle);
+}
+
+void compare(const GrindMeasurement& original, const GrindMeasurement& decoded, FieldError& error) {
+    error.weight = max(error.weight, fabsf(original.weight_grams - decoded.weight_grams));
+    error.weight_delta = max(error.weight_delta, fabsf(original.weight_delta - decoded.weight_delta));
+    error.flow_rate = max(error.flow_rate, fabsf(original.flow_rate_g_per_s - decoded.flow_rate_g_per_s));
+    error.stop_target = max(error.stop_target, fabsf(original.motor_stop_target_weight - decoded.motor_stop_target_weight));
+    if (original.timestamp_ms != decoded.timestamp_ms || original.sequence_id != decoded.sequence_id ||
+        original.phase_id != decoded.phase_id || original.motor_is_on != decoded.motor_is_on) {
+        error.exact_mismatches++;
+    }
+}
+
+bool process_file(const std::string& path, ReportTotals& totals) {
+    std::vector<uint8_t> data;
+    TimeSeriesSessionHeader header;
+    if (!read_file(path, data) || data.size() < sizeof(header) + sizeof(GrindSession)) {
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+
+    size_t body_offset = sizeof(header) + sizeof(GrindSession);
+    size_t raw_events_size = header.event_count * sizeof(GrindEvent);
+    size_t raw_size = body_offset + raw_events_size + header.measurement_count * sizeof(GrindMeasurement);
+    std::vector<GrindEvent> events(max<size_t>(1, header.event_count));
+    std::vector<GrindMeasurement> measurements(max<size_t>(1, header.measurement_count));
+    size_t events_size = 0;
+    size_t block_size = 0;
+
+    if (header.schema_version >= 3) {
+        if (!decode_event_block(data.data() + body_offset, data.size() - body_offset,
+                                header.event_count, events.data(), &events_size)) {
+            return false;
+        }
+        size_t block_offset = body_offset + events_size;
+        block_size = data.size() - block_offset;
+        if (!decode_measurement_block(data.data() + block_offset, block_size,
+                                      header.measurement_count, measurements.data())) {
+            return false;
+        }
+        totals.v3_files++;
+        totals.v3_bytes += data.size();
+    } else {
+        if (data.size() < raw_size) {
+            return false;
+        }
+        std::vector<GrindEvent> original_events(max<size_t>(1, header.event_count));
+        std::vector<GrindMeasurement> original(max<size_t>(1, header.measurement_count));
+        memcpy(original_events.data(), data.data() + body_offset, raw_events_size);
+        memcpy(original.data(), data.data() + body_offset + raw_events_size,
+               header.measurement_count * sizeof(GrindMeasurement));
+
+        MemorySink event_sink;
+        MemorySink measurement_sink;
+        events_size = encode_event_block(original_events.data(), header.event_count, event_sink);
+        block_size = encode_measurement_block(original.data(), header.measurement_count, measurement_sink);
+        size_t consumed = 0;
+        if (events_size != event_sink.bytes.size() || block_size != measurement_sink.bytes.size() ||
+            !decode_event_block(event_sink.bytes.data(), event_sink.bytes.size(), header.event_count,
+                                events.data(), &consumed) ||
+            consumed != events_size ||
+            !decode_measurement_block(measurement_sink.bytes.data(), measurement_sink.bytes.size(),
+                                      header.measurement_count, measurements.data())) {
+            return false;
+        }
+        for (uint16_t i = 0; i < header.event_count; i++) {
+            if (memcmp(&original_events[i], &events[i], sizeof(GrindEvent)) != 0) {
+                totals.error.event_mismatches++;
+            }
+        }
+        for (uint16_t i = 0; i < header.measurement_count; i++) {
+            compare(original[i], measurements[i], totals.error);
+        }
+        totals.v2_files++;
+        totals.v3_bytes += body_offset + events_size + block_size;
+    }
+
+    totals.events += header.event_count;
+    totals.measurements += header.measurement_count;
+    totals.raw_bytes += raw_size;
+    totals.event_bytes += events_size;
+    totals.block_bytes += block_size;
+    return true;
+}
+
+// Empty string if the file is intact, otherwise what is wrong with it
+std::string verify_file(const std::string& path, bool* has_crc) {
+    std::vector<uint8_t> data;
+    TimeSeriesSessionHeader header;
+    *has_crc = false;
+    if (!read_file(path, data)) {
+        return "unreadable";
+    }
+    if (data.size() < sizeof(header) + sizeof(GrindSession)) {
+        return "shorter than the header and session";
+    }
+    memcpy(&header, data.data(), sizeof(header));
+
+    const char* name = strrchr(path.c_str(), '/');
+    unsigned long name_id = strtoul(name ? name + strlen("/session_") : path.c_str(), nullptr, 10);
+    if (header.session_id != name_id) {
+        return "header session_id " + std::to_string(header.session_id) + " does not match the file name";
+    }
+    if (data.size() != sizeof(header) + header.session_size) {
+        return "size " + std::to_string(data.size()) + " bytes, header says " +
+               std::to_string(sizeof(header) + header.session_size);
+    }
+
+    *has_crc = (header.flags & SESSION_FLAG_CRC32) != 0;
+    if (*has_crc) {
+        uint32_t body_crc = crc32_update(0, data.data() + sizeof(header), header.session_size);
+        uint32_t crc = session_file_checksum(body_crc, header);
+        if (crc != header.checksum) {
+            char message[64];
+            snprintf(message, sizeof(message), "CRC 0x%08X, header says 0x%08X", crc, header.checksum);
+            return message;
+        }
+    }
+
+    size_t body_offset = sizeof(header) + sizeof(GrindSession);
+    if (header.schema_version >= 3) {
+        std::vector<GrindEvent> events(max<size_t>(1, header.event_count));
+        std::vector<GrindMeasurement> measurements(max<size_t>(1, header.measurement_count));
+        size_t events_size = 0;
+        if (!decode_event_block(data.data() + body_offset, data.size() - body_offset,
+                                header.event_count, events.data(), &events_size) ||
+            !decode_measurement_block(data.data() + body_offset + events_size, data.size() - body_offset - events_size,
+                                      header.measurement_count, measurements.data())) {
+            return "event or measurement block does not decode";
+        }
+    } else if (header.session_size != sizeof(GrindSession) + header.event_count * sizeof(GrindEvent) +
+                                      header.measurement_count * sizeof(GrindMeasurement)) {
+        return "schema v2 record counts do not match the size";
+    }
+    return "";
+}
+
+} // namespace
+
+int run_session_verify(int argc, char** argv) {
+    if (argc < 1 || strcmp(argv[0], "--help") == 0) {
+        printf("Usage: session-verify DIR\n"
+               "  Checks every session_*.bin in DIR or DIR/sessions; exit status 1 if any is corrupt\n");
+        return argc < 1 ? 1 : 0;
+    }
+
+    std::string dir = argv[0];
+    std::vector<std::string> paths;
+    collect_session_files(dir, paths);
+    collect_session_files(dir + "/sessions", paths);
+    if (paths.empty()) {
+        printf("No session_*.bin files in %s\n", dir.c_str());
+        return 1;
+    }
+
+    uint32_t verified = 0;
+    uint32_t legacy = 0;
+    uint32_t corrupt = 0;
+    for (const std::string& path : paths) {
+        bool has_crc = false;
+        std::string problem = verify_file(path, &has_crc);
+        if (!problem.empty()) {
+            printf("  CORRUPT %s: %s\n", path.c_str(), problem.c_str());
+            corrupt++;
+        } else if (has_crc) {
+            verified++;
+        } else {
+            legacy++;
+        }
+    }
+
+    printf("Session files: %lu - %lu CRC verified, %lu without CRC (structure checked only), %lu corrupt\n",
+           (unsigned long)paths.size(), (unsigned long)verified, (unsigned long)legacy, (unsigned long)corrupt);
+    return corrupt == 0 ? 0 : 1;
+}
+
+int run_session_codec_report(int argc, char** argv) {
+    if (argc < 1 || strcmp(argv[0], "--help") == 0) {
+        printf("Usage: session-report DIR\n"
+               "  Reads session_*.bin from DIR or DIR/sessions (e.g. written by sim --save-sessions DIR)\n");
+        return argc < 1 ? 1 : 0;
+    }
+
+    std::string dir = argv[0];
+    std::vector<std::string> paths;
+    collect_session_files(dir, paths);
+    collect_session_files(dir + "/sessions", paths);
+    if (paths.empty()) {
+        printf("No session_*.bin files in %s\n", dir.c_str());
+        return 1;
+    }
+
+    ReportTotals totals;
+    for (const std::string& path : paths) {
+        if (!process_file(path, totals)) {
+            printf("  FAILED %s\n", path.c_str());
+            totals.failed_files++;
+        }
+    }
+
+    uint32_t files = totals.v2_files + totals.v3_files;
+    printf("Session files: %lu (schema v2 %lu, v3 %lu, failed %lu), %llu events, %llu measurements\n",
+           (unsigned long)files, (unsigned long)totals.v2_files, (unsigned long)totals.v3_files,
+           (unsigned long)totals.failed_files, (unsigned long long)totals.events,
+           (unsigned long long)totals.measurements);
+    if (files == 0) {
+        return 1;
+    }
+    printf("  raw layout   %8llu bytes  (%6.0f per session)\n",
+           (unsigned long long)totals.raw_bytes, (double)totals.raw_bytes / files);
+    printf("  schema v3    %8llu bytes  (%6.0f per session)  %.1fx smaller\n",
+           (unsigned long long)totals.v3_bytes, (double)totals.v3_bytes / files,
+           (double)totals.raw_bytes / max<uint64_t>(1, totals.v3_bytes));
+    printf("  events       %6.2f bytes each encoded vs %u raw (%.1fx)\n",
+           (double)totals.event_bytes / max<uint64_t>(1, totals.events), (unsigned)sizeof(GrindEvent),
+           (double)(totals.events * sizeof(GrindEvent)) / max<uint64_t>(1, totals.event_bytes));
+    printf("  measurements %6.2f bytes each encoded vs %u raw (%.1fx)\n",
+           (double)totals.block_bytes / max<uint64_t>(1, totals.measurements), (unsigned)sizeof(GrindMeasurement),
+           (double)(totals.measurements * sizeof(GrindMeasurement)) / max<uint64_t>(1, totals.block_bytes));
+
+    if (totals.v2_files > 0) {
+        printf("Round trip of v2 measurements (max |error|):\n");
+        printf("  weight %.4fg  weight_delta %.4fg  flow %.4fg/s  stop target %.4fg  exact-field mismatches %lu\n",
+               totals.error.weight, totals.error.weight_delta, totals.error.flow_rate,
+               totals.error.stop_target, (unsigned long)totals.error.exact_mismatches);
+        printf("  events differing after round trip: %lu\n", (unsigned long)totals.error.event_mismatches);
+    }
+    return totals.failed_files == 0 ? 0 : 1;
+}
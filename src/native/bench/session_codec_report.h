@@ -0,0 +1,10 @@
+#pragma once
+
+// Size and fidelity of the schema v3 event and measurement blocks over session files on the host
+// (a `sim --save-sessions DIR` directory or files pulled from a device). Schema v2 files
+// are re-encoded to measure the quantization error. Usage: `session-report DIR`.
+int run_session_codec_report(int argc, char** argv);
+
+// Integrity check of the session files in DIR: file name, size, CRC-32 and decode.
+// Usage: `session-verify DIR`; exits 1 if any file is corrupt.
+int run_session_verify(int argc, char** argv);
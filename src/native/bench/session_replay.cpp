@@ -0,0 +1,1177 @@
+#include "session_replay.h"
+#include "session_samples.h"
+#include "../sim/grind_simulator.h"
+#include "../../controllers/grind_controller.h"
+#include "../../controllers/grind_events.h"
+#include "../../hardware/WeightSensor.h"
+#include "../../hardware/grinder.h"
+#include "../../hardware/mock_hx711_driver.h"
+#include "../../logging/grind_logging.h"
+#include "../../config/constants.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <LittleFS.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+ * Deterministic session replay
+ *
+ * Reads every session_*.bin under DIR (or DIR/sessions) - files pulled from the device,
+ * written by `sim --save-sessions` or exported from the grinder-ble.py database with
+ * `grinder-ble.py dump-sessions` - and replays the weight mode grinds in session order through
+ * the production stack: WeightSensor (filters, settling detector, estimator), GrindController
+ * and WeightGrindStrategy, on the virtual clock. Sessions logged every control interval (as
+ * `sim` writes by default) run in the same 20ms lockstep of sampling, control and Core 1;
+ * others in 1ms steps with the control task woken as GrindControlTask does. MockHX711Driver
+ * plays the load cell samples recovered from the logged weights (recover_load_cell_samples())
+ * instead of its plant model, converted back to raw counts.
+ *
+ * The recording only holds what the scale saw for the motor commands the device gave, so
+ * SessionPlayback lines it up with the replay's commands: each motor start, motor stop and
+ * pulse of the replay jumps playback to the matching command in the log. Between commands
+ * the log plays as recorded until the log's next command; if the replay has not given it
+ * by then, the weight is extrapolated at the logged flow rate (motor running) or held.
+ * A stop or pulse that differs from the log shifts the weight by the grounds it added or
+ * saved - logged flow rate times the difference in motor-on time (pulses: beyond the motor
+ * latency). The tare lands on the sample it did in the log, and its new zero is solved from
+ * the samples in its window, so up to the first decision that differs from the log the scale
+ * reads the logged weights; later decisions see this approximation of what the scale would
+ * have shown.
+ *
+ * Not in the log: the samples at rest between grinds and during the purge confirmation wait,
+ * played as noise at the level the session shows - the settling detector's noise estimate
+ * learns from them - and weights below the 1mg the session codec keeps. `replay --self-check N`
+ * replays grinds `sim` writes with neither (noise-free at rest, finer weights) and fails
+ * unless every decision is identical.
+ *
+ * Decisions are the motor-on time of the prime and predictive runs, each pulse duration and
+ * the length of every settling phase, read back from the session the replay logs itself so
+ * both sides are measured the same way. They are compared per phase in order of occurrence
+ * against the log, or with --baseline against an earlier replay saved with --save, which is
+ * exact: both replays see the same samples up to the first decision that differs.
+ *
+ * Controller state (learned grind model, stop planner history) carries over from session to
+ * session as on the device, starting from defaults. Time mode sessions are skipped.
+ */
+
+namespace {
+
+const float SAME_DECISION_MS = 0.5f;
+const float IDLE_LEVEL_JUMP_G = 1.0f;    // Tare or cup change between two samples at rest
+const uint32_t TARE_WINDOW_MS = 250;     // Smoothing of the new zero (WeightSensor::sample_and_feed_filter())
+const float SELF_CHECK_WEIGHT_QUANTUM_G = 0.00001f;   // Well below one ADC count, so samples come back exact
+const int32_t REPLAY_ZERO_RAW = 0x800000;   // Mid-scale zero: logs on any zero stay in the 24-bit range
+
+enum class ReplayWakeup {
+    AUTO,
+    LOCKSTEP,
+    SAMPLE
+};
+
+struct ReplayConfig {
+    const char* dir = nullptr;
+    const char* save_path = nullptr;
+    const char* baseline_path = nullptr;
+    const char* session_dir = nullptr;
+    uint32_t sps = HW_LOADCELL_SAMPLE_RATE_SPS;
+    float motor_latency_ms = 0.0f;       // 0 = controller default
+    float purge_amount_g = GRIND_PURGE_AMOUNT_DEFAULT_G;
+    int stop_planner = GRIND_STOP_PLANNER_DEFAULT;
+    ReplayWakeup wakeup = ReplayWakeup::AUTO;
+    uint32_t self_check_grinds = 0;      // Replay this many fresh `sim` grinds instead of DIR
+    bool list = false;
+    bool verbose = false;
+};
+
+//------------------------------------------------------------------------------
+// Playback
+//------------------------------------------------------------------------------
+
+enum class ActuationKind : uint8_t {
+    MOTOR_START,
+    MOTOR_STOP,
+    PULSE
+};
+
+struct Actuation {
+    ActuationKind kind;
+    uint32_t log_ms;
+    float pulse_ms;                      // PULSE: logged duration
+    uint32_t active_tail_ms;             // PULSE: logged time in PULSE_EXECUTE beyond the duration
+    float flow_gps;                      // MOTOR_STOP: logged flow rate at the stop, PULSE: pulse flow rate
+};
+
+class SessionPlayback : public MockSampleSource {
+public:
+    // Idle scale between sessions
+    void clear() {
+        samples_.clear();
+        actuations_.clear();
+        measurements_.clear();
+        reset();
+    }
+
+    // tare_start_ms: log time the grind's tare started (UINT32_MAX = none)
+    void load(std::vector<RecoveredSample> samples, std::vector<Actuation> actuations,
+              const std::vector<GrindMeasurement>& measurements, uint32_t tare_start_ms, float motor_latency_ms) {
+        samples_ = std::move(samples);
+        actuations_ = std::move(actuations);
+        measurements_ = measurements;
+        motor_latency_ms_ = motor_latency_ms;
+        counts_per_g_ = sensor_ ? sensor_->get_calibration_factor() : DEBUG_MOCK_CAL_FACTOR;
+        base_raw_ = sensor_ ? sensor_->get_zero_offset() : 0;
+        reset();
+        locate_tare(tare_start_ms);
+        // At rest before the grind the scale reads what the log starts with
+        hold_counts_ = samples_.empty() ? 0 : log_counts(0);
+
+        // Synthetic samples carry the load cell noise the samples before the first command show,
+        // which the settling detector learns at rest
+        uint32_t first_command_ms = actuations_.empty() ? UINT32_MAX : actuations_[0].log_ms;
+        double weighted_squares = 0.0;
+        uint32_t differences = 0;
+        for (size_t i = 1; i < samples_.size() && samples_[i].timestamp_ms < first_command_ms; i++) {
+            const RecoveredSample& sample = samples_[i];
+            const RecoveredSample& previous = samples_[i - 1];
+            float difference = sample.weight - previous.weight;
+            if (fabsf(difference) >= IDLE_LEVEL_JUMP_G) continue;
+            // Successive differences: 2 sigma^2 between exact samples, sigma^2 / 2 with a mixed one
+            weighted_squares += difference * difference / (sample.mixed || previous.mixed ? 0.5f : 2.0f);
+            differences++;
+        }
+        if (differences >= 4) {
+            idle_sigma_g_ = (float)sqrt(weighted_squares / differences);
+        }
+    }
+
+    // Grind started: play the log from its start up to the first command
+    void start(unsigned long now_ms) {
+        enter_segment(0, now_ms);
+        next_ = 0;
+    }
+
+    // The scale the recording is played on
+    void attach(WeightSensor* sensor) {
+        sensor_ = sensor;
+    }
+
+    void on_motor_start(unsigned long now_ms) override {
+        if (splice(ActuationKind::MOTOR_START, now_ms)) {
+            replay_run_start_ms_ = now_ms;
+            log_run_start_ms_ = actuations_[matched_ - 1].log_ms;
+        }
+    }
+
+    void on_motor_stop(unsigned long now_ms) override {
+        if (splice(ActuationKind::MOTOR_STOP, now_ms)) {
+            const Actuation& stop = actuations_[matched_ - 1];
+            float replay_run_ms = (float)(now_ms - replay_run_start_ms_);
+            float log_run_ms = (float)(stop.log_ms - log_run_start_ms_);
+            offset_g_ += stop.flow_gps * (replay_run_ms - log_run_ms) / 1000.0f;
+            last_stop_flow_gps_ = stop.flow_gps;
+        }
+    }
+
+    uint32_t on_pulse(unsigned long now_ms, uint32_t duration_ms) override {
+        float grounds_ms = std::max(0.0f, (float)duration_ms - motor_latency_ms_);
+        uint32_t active_ms = duration_ms;
+        if (splice(ActuationKind::PULSE, now_ms)) {
+            const Actuation& pulse = actuations_[matched_ - 1];
+            active_ms += pulse.active_tail_ms;
+            last_pulse_flow_gps_ = pulse.flow_gps;
+            float log_grounds_ms = std::max(0.0f, pulse.pulse_ms - motor_latency_ms_);
+            pending_offset_g_ += pulse.flow_gps * (grounds_ms - log_grounds_ms) / 1000.0f;
+        } else {
+            // A pulse the log does not have: the last logged pulse flow, or the flow at the last stop
+            float flow_gps = last_pulse_flow_gps_ > 0.0f ? last_pulse_flow_gps_ : last_stop_flow_gps_;
+            pending_offset_g_ += flow_gps * grounds_ms / 1000.0f;
+        }
+        pending_offset_ms_ = now_ms + duration_ms;
+        return active_ms;
+    }
+
+    bool sample_due(unsigned long now_ms) const override {
+        if (playing_log()) {
+            return (int64_t)samples_[next_].timestamp_ms + shift_ms_ <= (int64_t)now_ms;
+        }
+        return (long)(now_ms - next_synthetic_ms_) >= 0;
+    }
+
+    // Logged weights are converted back to raw counts, on the zero the grind started with
+    // throughout, and played on the replay's zero at the start
+    int32_t take_sample(unsigned long now_ms) override {
+        if (pending_offset_g_ != 0.0f && (long)(now_ms - pending_offset_ms_) >= 0) {
+            offset_g_ += pending_offset_g_;
+            pending_offset_g_ = 0.0f;
+        }
+
+        int32_t counts;
+        if (playing_log()) {
+            // A sample still averaged with one the log does not hold is unmixed against the
+            // sample played before it, so the replay's window shows the logged weight
+            const RecoveredSample& sample = samples_[next_];
+            counts = log_counts(next_++);
+            if (sample.mixed && now_ms - last_played_ms_ <= LOGGED_WEIGHT_WINDOW_MS) {
+                counts = 2 * counts - last_played_counts_;
+            }
+            hold_counts_ = counts;
+            hold_since_ms_ = now_ms;
+            if (!playing_log()) {
+                next_synthetic_ms_ = now_ms + HW_LOADCELL_SAMPLE_INTERVAL_MS;
+            }
+        } else {
+            next_synthetic_ms_ = now_ms + HW_LOADCELL_SAMPLE_INTERVAL_MS;
+            counts = hold_counts_ + to_counts(hold_flow_gps_ * (float)(now_ms - hold_since_ms_) / 1000.0f + idle_noise());
+        }
+        last_played_counts_ = counts;
+        last_played_ms_ = now_ms;
+        return base_raw_ + counts + to_counts(offset_g_);
+    }
+
+private:
+    struct TareWindowSample {
+        int32_t counts;
+        uint32_t timestamp_ms;
+    };
+
+    int32_t to_counts(float weight_g) const {
+        return (int32_t)lround((double)weight_g * counts_per_g_);
+    }
+
+    // Log sample in counts on the zero the grind started with
+    int32_t log_counts(size_t index) const {
+        return to_counts(samples_[index].weight) + (index >= tare_index_ ? tare_zero_counts_ : 0);
+    }
+
+    // Weights are logged on the new zero from the sample the tare landed on, the last of the
+    // WeightSensor::TARE_SAMPLES after it started. The new zero is the smoothed raw of the
+    // samples in the tare window, that sample included, so the counts it reads fix it against
+    // the samples before it; when several values do (the zero is their median), the one whose
+    // average with the previous sample reads the weight logged on its arrival.
+    void locate_tare(uint32_t tare_start_ms) {
+        tare_index_ = samples_.size();
+        tare_zero_counts_ = 0;
+        size_t first = std::upper_bound(samples_.begin(), samples_.end(), tare_start_ms,
+                                        [](uint32_t ms, const RecoveredSample& s) { return ms < s.timestamp_ms; }) - samples_.begin();
+        if (tare_start_ms == UINT32_MAX || first + WeightSensor::TARE_SAMPLES > samples_.size()) {
+            return;
+        }
+        tare_index_ = first + WeightSensor::TARE_SAMPLES - 1;
+
+        // The window ends now on the replay clock, which the filter reads
+        const RecoveredSample& tared = samples_[tare_index_];
+        int32_t tared_counts = to_counts(tared.weight);
+        uint32_t now_ms = millis();
+        std::vector<TareWindowSample> window;
+        for (size_t i = first; i < tare_index_; i++) {
+            uint32_t age_ms = tared.timestamp_ms - samples_[i].timestamp_ms;
+            if (age_ms <= TARE_WINDOW_MS) {
+                window.push_back({to_counts(samples_[i].weight), now_ms - age_ms});
+            }
+        }
+        if (window.empty()) {
+            // The tare averaged the sample alone: it reads zero, at the level before it
+            tare_zero_counts_ = to_counts(samples_[tare_index_ - 1].weight);
+            return;
+        }
+
+        bool arrival_logged = false;
+        int32_t arrival_counts = 0;
+        auto logged = std::lower_bound(measurements_.begin(), measurements_.end(), tared.timestamp_ms,
+                                       [](const GrindMeasurement& m, uint32_t ms) { return m.timestamp_ms < ms; });
+        if (logged != measurements_.end() && logged->timestamp_ms == tared.timestamp_ms) {
+            arrival_logged = true;
+            arrival_counts = to_counts(logged->weight_grams);
+        }
+
+        CircularBufferMath filter;
+        auto tare_with = [&](int32_t counts, int64_t* score) {
+            filter.clear_all_samples();
+            for (const TareWindowSample& sample : window) {
+                filter.add_sample(sample.counts, sample.timestamp_ms);
+            }
+            filter.add_sample(counts, now_ms);
+            int32_t zero = filter.get_smoothed_raw(TARE_WINDOW_MS);
+            *score = (int64_t)abs(counts - zero - tared_counts) << 32;
+            if (arrival_logged) {
+                *score += abs(filter.get_smoothed_raw(LOGGED_WEIGHT_WINDOW_MS) - zero - arrival_counts);
+            }
+            return zero;
+        };
+        int32_t low = INT32_MAX;
+        int32_t high = INT32_MIN;
+        for (const TareWindowSample& sample : window) {
+            low = std::min(low, sample.counts);
+            high = std::max(high, sample.counts);
+        }
+        int32_t margin = high - low + abs(tared_counts) + 2;
+        int64_t best_score = INT64_MAX;
+        int32_t best_first = 0;
+        int32_t best_last = 0;
+        for (int32_t counts = low + tared_counts - margin; counts <= high + tared_counts + margin; counts++) {
+            int64_t score;
+            tare_with(counts, &score);
+            if (score < best_score) {
+                best_score = score;
+                best_first = counts;
+            }
+            if (score == best_score) {
+                best_last = counts;
+            }
+        }
+        int64_t score;
+        tare_zero_counts_ = tare_with(best_first + (best_last - best_first) / 2, &score);
+    }
+
+    float idle_noise() {
+        return idle_sigma_g_ > 0.0f ? std::normal_distribution<float>(0.0f, idle_sigma_g_)(noise_rng_) : 0.0f;
+    }
+
+    void reset() {
+        started_ = false;
+        matched_ = 0;
+        diverged_ = false;
+        next_ = 0;
+        segment_end_ms_ = 0;
+        shift_ms_ = 0;
+        offset_g_ = 0.0f;
+        pending_offset_g_ = 0.0f;
+        pending_offset_ms_ = 0;
+        hold_counts_ = 0;
+        hold_flow_gps_ = 0.0f;
+        hold_since_ms_ = 0;
+        next_synthetic_ms_ = 0;
+        replay_run_start_ms_ = 0;
+        log_run_start_ms_ = 0;
+        last_pulse_flow_gps_ = 0.0f;
+        last_stop_flow_gps_ = 0.0f;
+    }
+
+    bool playing_log() const {
+        return started_ && !diverged_ && next_ < samples_.size() && samples_[next_].timestamp_ms <= segment_end_ms_;
+    }
+
+    // Lines the log up with a replay command. False when the log has no matching command:
+    // the weight is held from here on.
+    bool splice(ActuationKind kind, unsigned long now_ms) {
+        if (diverged_ || matched_ >= actuations_.size() || actuations_[matched_].kind != kind) {
+            if (!diverged_) {
+                diverged_ = true;
+                hold_flow_gps_ = 0.0f;
+                hold_since_ms_ = now_ms;
+                next_synthetic_ms_ = now_ms;
+            }
+            return false;
+        }
+
+        matched_++;
+        enter_segment(actuations_[matched_ - 1].log_ms, now_ms);
+
+        // Past the log's next command without it: extrapolate at the flow up to the stop, or hold
+        if (kind == ActuationKind::MOTOR_START && matched_ < actuations_.size() &&
+            actuations_[matched_].kind == ActuationKind::MOTOR_STOP) {
+            hold_flow_gps_ = actuations_[matched_].flow_gps;
+        }
+        return true;
+    }
+
+    // Plays the log from log_ms (exclusive: a sample logged at a command's own millisecond is
+    // the one that triggered it) up to the next command
+    void enter_segment(uint32_t log_ms, unsigned long now_ms) {
+        started_ = true;
+        segment_end_ms_ = matched_ < actuations_.size() ? actuations_[matched_].log_ms : UINT32_MAX;
+        shift_ms_ = (int64_t)now_ms - log_ms;
+        next_ = std::upper_bound(samples_.begin(), samples_.end(), log_ms,
+                                 [](uint32_t ms, const RecoveredSample& s) { return ms < s.timestamp_ms; }) - samples_.begin();
+        hold_flow_gps_ = 0.0f;
+        hold_since_ms_ = now_ms;
+        next_synthetic_ms_ = now_ms + HW_LOADCELL_SAMPLE_INTERVAL_MS;
+    }
+
+    WeightSensor* sensor_ = nullptr;
+    std::vector<RecoveredSample> samples_;
+    std::vector<Actuation> actuations_;
+    std::vector<GrindMeasurement> measurements_;
+    float motor_latency_ms_ = 0.0f;
+    float counts_per_g_ = DEBUG_MOCK_CAL_FACTOR;
+    int32_t base_raw_ = 0;               // Replay zero at the start, where the log's starting zero plays
+    size_t tare_index_ = 0;              // First sample logged on the zero the grind tared to
+    int32_t tare_zero_counts_ = 0;       // That zero in counts on the starting zero
+
+    float idle_sigma_g_ = 0.0f;          // Load cell noise at rest, from the last session that showed it
+    std::mt19937 noise_rng_{1};
+
+    bool started_ = false;               // Playing the log (grind started)
+    size_t matched_ = 0;                 // Replay commands lined up with the log so far
+    bool diverged_ = false;              // A replay command had no counterpart in the log
+    size_t next_ = 0;                    // Next log sample
+    uint32_t segment_end_ms_ = 0;        // Log time of the next command
+    int64_t shift_ms_ = 0;               // Replay time - log time
+    float offset_g_ = 0.0f;              // Grounds added (+) or saved (-) by differing decisions
+    float pending_offset_g_ = 0.0f;      // Pulse grounds, applied once the pulse has ended
+    unsigned long pending_offset_ms_ = 0;
+    int32_t last_played_counts_ = 0;     // Last sample played, before the offset
+    unsigned long last_played_ms_ = 0;
+    int32_t hold_counts_ = 0;            // Last log sample played
+    float hold_flow_gps_ = 0.0f;
+    unsigned long hold_since_ms_ = 0;
+    unsigned long next_synthetic_ms_ = 0;
+    unsigned long replay_run_start_ms_ = 0;
+    uint32_t log_run_start_ms_ = 0;
+    float last_pulse_flow_gps_ = 0.0f;
+    float last_stop_flow_gps_ = 0.0f;
+};
+
+std::vector<Actuation> logged_actuations(const std::vector<GrindEvent>& events,
+                                         const std::vector<GrindMeasurement>& measurements) {
+    auto flow_at = [&](uint32_t ms) {
+        float flow = 0.0f;
+        for (const GrindMeasurement& m : measurements) {
+            if (m.timestamp_ms > ms) break;
+            flow = m.flow_rate_g_per_s;
+        }
+        return flow;
+    };
+
+    std::vector<Actuation> actuations;
+    for (const GrindEvent& event : events) {
+        GrindPhase phase = (GrindPhase)event.phase_id;
+        if (phase == GrindPhase::PRIME || phase == GrindPhase::PREDICTIVE) {
+            uint32_t stop_ms = event.timestamp_ms + event.duration_ms;
+            actuations.push_back({ActuationKind::MOTOR_START, event.timestamp_ms, 0.0f, 0, 0.0f});
+            actuations.push_back({ActuationKind::MOTOR_STOP, stop_ms, 0.0f, 0, max(0.0f, flow_at(stop_ms))});
+        } else if (phase == GrindPhase::PULSE_EXECUTE) {
+            // The device reports the pulse done after the RMT pulse, the simulator once its grounds have landed
+            uint32_t tail_ms = (uint32_t)max(0.0f, (float)event.duration_ms - event.pulse_duration_ms);
+            actuations.push_back({ActuationKind::PULSE, event.timestamp_ms, event.pulse_duration_ms, tail_ms,
+                                  event.pulse_flow_rate});
+        }
+    }
+    return actuations;
+}
+
+// The update that enters the purge confirmation logs no measurement, but the phase event it
+// closes holds the weight it read - often the sample that settled the prime
+std::vector<GrindMeasurement> with_unlogged_weights(const std::vector<GrindEvent>& events,
+                                                    const std::vector<GrindMeasurement>& measurements) {
+    std::vector<GrindMeasurement> result = measurements;
+    for (const GrindEvent& event : events) {
+        if ((GrindPhase)event.phase_id != GrindPhase::PURGE_CONFIRM) continue;
+        auto next = std::lower_bound(result.begin(), result.end(), event.timestamp_ms,
+                                     [](const GrindMeasurement& m, uint32_t ms) { return m.timestamp_ms < ms; });
+        if (next == result.begin() || (next != result.end() && next->timestamp_ms == event.timestamp_ms)) continue;
+        const GrindEvent* closed = nullptr;
+        for (const GrindEvent& e : events) {
+            if (e.timestamp_ms + e.duration_ms == event.timestamp_ms && &e != &event) closed = &e;
+        }
+        if (!closed) continue;
+        GrindMeasurement m = *(next - 1);
+        m.timestamp_ms = event.timestamp_ms;
+        m.weight_grams = closed->end_weight;
+        result.insert(next, m);
+    }
+    return result;
+}
+
+//------------------------------------------------------------------------------
+// Decisions
+//------------------------------------------------------------------------------
+
+struct Decision {
+    uint8_t phase_id;
+    float value_ms;                      // Motor-on time, pulse duration or settling time
+};
+
+struct SessionDecisions {
+    bool valid = false;
+    uint8_t termination_reason = (uint8_t)GrindTerminationReason::UNKNOWN;
+    float final_weight = 0.0f;
+    std::vector<Decision> decisions;
+};
+
+const GrindPhase DECISION_PHASES[] = {
+    GrindPhase::PRIME, GrindPhase::PRIME_SETTLING, GrindPhase::PREDICTIVE,
+    GrindPhase::PULSE_EXECUTE, GrindPhase::PULSE_SETTLING, GrindPhase::FINAL_SETTLING
+};
+
+const char* decision_label(GrindPhase phase) {
+    switch (phase) {
+        case GrindPhase::PRIME: return "prime stop";
+        case GrindPhase::PRIME_SETTLING: return "prime settling";
+        case GrindPhase::PREDICTIVE: return "predictive stop";
+        case GrindPhase::PULSE_EXECUTE: return "pulse duration";
+        case GrindPhase::PULSE_SETTLING: return "pulse settling";
+        case GrindPhase::FINAL_SETTLING: return "final settling";
+        default: return "?";
+    }
+}
+
+SessionDecisions extract_decisions(const std::vector<GrindEvent>& events, const GrindSession& session) {
+    SessionDecisions result;
+    result.valid = true;
+    result.termination_reason = session.termination_reason;
+    result.final_weight = session.final_weight;
+    for (const GrindEvent& event : events) {
+        GrindPhase phase = (GrindPhase)event.phase_id;
+        if (phase == GrindPhase::PULSE_EXECUTE) {
+            result.decisions.push_back({event.phase_id, event.pulse_duration_ms});
+        } else if (std::find(std::begin(DECISION_PHASES), std::end(DECISION_PHASES), phase) != std::end(DECISION_PHASES)) {
+            result.decisions.push_back({event.phase_id, (float)event.duration_ms});
+        }
+    }
+    return result;
+}
+
+// Baseline file: "S <session_id> <termination_reason> <final_weight>" then "D <session_id> <phase_id> <value_ms>" lines
+bool save_decisions(const char* path, const std::map<uint32_t, SessionDecisions>& sessions) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "# replay decisions\n");
+    for (const auto& entry : sessions) {
+        fprintf(file, "S %lu %u %.4f\n", (unsigned long)entry.first, entry.second.termination_reason,
+                entry.second.final_weight);
+        for (const Decision& d : entry.second.decisions) {
+            fprintf(file, "D %lu %u %.1f\n", (unsigned long)entry.first, d.phase_id, d.value_ms);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+bool load_decisions(const char* path, std::map<uint32_t, SessionDecisions>& sessions) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        unsigned long id;
+        unsigned a;
+        float value;
+        if (sscanf(line, "S %lu %u %f", &id, &a, &value) == 3) {
+            SessionDecisions& s = sessions[id];
+            s.valid = true;
+            s.termination_reason = (uint8_t)a;
+            s.final_weight = value;
+        } else if (sscanf(line, "D %lu %u %f", &id, &a, &value) == 3) {
+            sessions[id].decisions.push_back({(uint8_t)a, value});
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Replay stack
+//------------------------------------------------------------------------------
+
+struct UiState {
+    bool acknowledge_pending;
+    bool purge_pending;
+    unsigned long purge_entered_ms;
+    bool finished;
+};
+
+UiState ui_state;
+
+void on_ui_event(const GrindEventData& event) {
+    switch (event.event) {
+        case UIGrindEvent::PHASE_CHANGED:
+            if (event.phase == GrindPhase::INITIALIZING) {
+                ui_state.acknowledge_pending = true;
+            } else if (event.phase == GrindPhase::PURGE_CONFIRM) {
+                ui_state.purge_pending = true;
+                ui_state.purge_entered_ms = millis();
+            }
+            break;
+        case UIGrindEvent::COMPLETED:
+        case UIGrindEvent::TIMEOUT:
+            ui_state.finished = true;
+            break;
+        default:
+            break;
+    }
+}
+
+class SessionReplay {
+public:
+    explicit SessionReplay(const ReplayConfig& config, const std::string& host_root)
+        : config_(config), host_root_(host_root) {}
+
+    ~SessionReplay() {
+        MockHX711Driver::set_sample_source(nullptr);
+    }
+
+    void setup() {
+        native_clock::set_ms(1000);
+        MockHX711Driver::set_sample_source(&playback_);
+
+        preferences_.begin("grinder", false);
+        preferences_.putInt(GrindController::PREF_KEY_STOP_PLANNER, config_.stop_planner);
+        preferences_.putFloat(GrindController::PREF_KEY_GRINDER_AMOUNT_G, config_.purge_amount_g);
+
+        LittleFS.set_host_root(host_root_.c_str());
+        LittleFS.begin(true);
+        Preferences logging_prefs;
+        logging_prefs.begin("logging", false);
+        logging_prefs.putBool("enabled", true);
+        logging_prefs.end();
+
+        sensor_.reset(new WeightSensor());
+        sensor_->init(&preferences_);
+        sensor_->begin();
+        sensor_->set_hardware_initialized();
+        sensor_->set_zero_offset(REPLAY_ZERO_RAW);
+        playback_.attach(sensor_.get());
+        grinder_.init(HW_MOTOR_RELAY_PIN);
+
+        controller_.reset(new GrindController());
+        controller_->init(sensor_.get(), &grinder_, &preferences_);
+        controller_->set_ui_event_callback(on_ui_event);
+        if (config_.motor_latency_ms > 0.0f) {
+            controller_->save_motor_latency(config_.motor_latency_ms);
+        }
+        drain_core1_queues();
+    }
+
+    // Replays one logged weight mode session and returns the decisions the replay logged
+    SessionDecisions run(const GrindSession& session, const std::vector<GrindEvent>& events,
+                         const std::vector<GrindMeasurement>& measurements) {
+        purge_confirm_ms_ = 0;
+        bool purge = false;
+        uint32_t tare_start_ms = UINT32_MAX;
+        for (const GrindEvent& event : events) {
+            if ((GrindPhase)event.phase_id == GrindPhase::PURGE_CONFIRM) {
+                purge = true;
+                purge_confirm_ms_ = event.duration_ms;
+            } else if ((GrindPhase)event.phase_id == GrindPhase::TARE_CONFIRM && tare_start_ms == UINT32_MAX) {
+                tare_start_ms = event.timestamp_ms;
+            }
+        }
+        preferences_.putInt(GrindController::PREF_KEY_GRINDER_MODE,
+                            static_cast<int>(purge ? GrinderPurgeMode::PURGE : GrinderPurgeMode::PRIME));
+        controller_->set_grind_profile_id(session.profile_id);
+
+        std::vector<GrindMeasurement> weights = with_unlogged_weights(events, measurements);
+        playback_.load(recover_load_cell_samples(weights, config_.sps), logged_actuations(events, measurements),
+                       weights, tare_start_ms, controller_->get_motor_response_latency());
+        lockstep_ = config_.wakeup == ReplayWakeup::LOCKSTEP ||
+                    (config_.wakeup == ReplayWakeup::AUTO && logged_in_lockstep(measurements));
+
+        // The scale rests before each grind as in `sim` (2s after power-up, 1s between grinds), on
+        // synthetic samples at the weight and noise the session's own samples at rest show
+        run_for(first_session_ ? 3000 : 1000);
+        first_session_ = false;
+
+        ui_state = UiState();
+        unsigned long start_ms = millis();
+        playback_.start(start_ms);
+        // A sample logged at the session start came in just before the start, in the same step
+        sensor_->sample_and_feed_filter();
+        controller_->start_grind(session.target_weight, session.target_time_ms, GrindMode::WEIGHT);
+
+        const unsigned long limit_ms = GRIND_TIMEOUT_SEC * 1000UL + 10000UL + purge_confirm_ms_;
+        while (millis() - start_ms < limit_ms) {
+            tick();
+            if (ui_state.finished && !grind_logger.is_logging_active()) {
+                break;
+            }
+        }
+
+        if (controller_->is_active()) {
+            if (ui_state.finished) {
+                controller_->return_to_idle();
+            } else {
+                controller_->stop_grind();
+            }
+        }
+        drain_core1_queues();
+
+        SessionDecisions decisions;
+        const GrindSession* logged = grind_logger.get_current_session();
+        if (logged && ui_state.finished) {
+            char path[64];
+            snprintf(path, sizeof(path), SESSION_FILE_FORMAT, (unsigned long)logged->session_id);
+            std::vector<GrindEvent> replay_events;
+            std::vector<GrindMeasurement> replay_measurements;
+            GrindSession replay_session;
+            if (load_session_file(host_root_ + path, replay_events, replay_measurements, &replay_session)) {
+                decisions = extract_decisions(replay_events, replay_session);
+            }
+            if (!config_.session_dir) {
+                LittleFS.remove(path);
+            }
+        }
+
+        playback_.clear();
+        return decisions;
+    }
+
+private:
+    // Sessions written by `sim` in its default lockstep schedule log a measurement every control
+    // interval, on the interval grid from the start; only the purge confirmation wait is a gap
+    static bool logged_in_lockstep(const std::vector<GrindMeasurement>& measurements) {
+        uint32_t gaps = 0;
+        for (size_t i = 0; i < measurements.size(); i++) {
+            if (measurements[i].timestamp_ms % SYS_TASK_GRIND_CONTROL_INTERVAL_MS != 0) return false;
+            if (i > 0 && measurements[i].timestamp_ms - measurements[i - 1].timestamp_ms > SYS_TASK_GRIND_CONTROL_INTERVAL_MS) {
+                gaps++;
+            }
+        }
+        return gaps <= 1;
+    }
+
+    void tick() {
+        if (lockstep_) {
+            tick_lockstep();
+        } else {
+            tick_1ms();
+        }
+    }
+
+    // One control interval step, as `sim` runs by default: sampling, control, then Core 1
+    void tick_lockstep() {
+        native_clock::advance_ms(SYS_TASK_GRIND_CONTROL_INTERVAL_MS);
+        sensor_->sample_and_feed_filter();
+        last_control_ms_ = millis();
+        controller_->update();
+        run_core1();
+    }
+
+    // 1ms step: samples fed as they come due, control woken as GrindControlTask does, Core 1 every 20ms
+    void tick_1ms() {
+        native_clock::advance_ms(1);
+        unsigned long now = millis();
+
+        bool sample_fed = sensor_->sample_and_feed_filter();
+#if SYS_GRIND_CONTROL_EVENT_DRIVEN
+        uint32_t timeout_ms = controller_->needs_timed_updates() ? SYS_TASK_GRIND_CONTROL_INTERVAL_MS
+                                                                 : SYS_TASK_GRIND_CONTROL_FALLBACK_MS;
+        bool control_due = sample_fed || now - last_control_ms_ >= timeout_ms;
+#else
+        (void)sample_fed;
+        bool control_due = now % SYS_TASK_GRIND_CONTROL_INTERVAL_MS == 0;
+#endif
+        if (control_due) {
+            last_control_ms_ = now;
+            controller_->update();
+        }
+
+        if (now % SYS_TASK_GRIND_CONTROL_INTERVAL_MS == 0) {
+            run_core1();
+        }
+    }
+
+    void run_core1() {
+        controller_->process_queued_ui_events();
+        if (ui_state.acknowledge_pending) {
+            ui_state.acknowledge_pending = false;
+            controller_->ui_acknowledge_phase_transition();
+        }
+        if (ui_state.purge_pending && millis() - ui_state.purge_entered_ms >= purge_confirm_ms_) {
+            ui_state.purge_pending = false;
+            controller_->continue_from_purge();
+        }
+        if (millis() - last_file_io_ms_ >= SYS_TASK_FILE_IO_INTERVAL_MS) {
+            last_file_io_ms_ = millis();
+            drain_core1_queues();
+        }
+    }
+
+    void drain_core1_queues() {
+        controller_->process_queued_flash_operations();
+        controller_->process_queued_log_messages();
+        grind_logger.write_session_journals();
+        // Session committer task, woken at the end of each file I/O cycle
+        while (grind_logger.commit_pending_session()) {
+        }
+    }
+
+    void run_for(uint32_t duration_ms) {
+        unsigned long start_ms = millis();
+        while (millis() - start_ms < duration_ms) {
+            tick();
+        }
+    }
+
+    ReplayConfig config_;
+    std::string host_root_;
+    SessionPlayback playback_;
+    Preferences preferences_;
+    std::unique_ptr<WeightSensor> sensor_;
+    Grinder grinder_;
+    std::unique_ptr<GrindController> controller_;
+    uint32_t purge_confirm_ms_ = 0;
+    bool lockstep_ = false;
+    bool first_session_ = true;
+    unsigned long last_control_ms_ = 0;
+    unsigned long last_file_io_ms_ = 0;
+};
+
+//------------------------------------------------------------------------------
+// Diff
+//------------------------------------------------------------------------------
+
+struct DecisionStats {
+    uint32_t reference = 0;
+    uint32_t replay = 0;
+    uint32_t same = 0;
+    std::vector<float> deltas;           // Replay - reference of the decisions both made
+};
+
+struct DiffTotals {
+    std::map<uint8_t, DecisionStats> by_phase;
+    uint32_t sessions = 0;
+    uint32_t identical = 0;
+    uint32_t termination_changed = 0;
+    std::vector<float> reference_errors;
+    std::vector<float> replay_errors;
+};
+
+// Returns true if every decision and the termination reason match
+bool diff_session(uint32_t session_id, float target, const SessionDecisions& reference, const SessionDecisions& replay,
+                  DiffTotals& totals, bool list) {
+    bool identical = reference.decisions.size() == replay.decisions.size() &&
+                     reference.termination_reason == replay.termination_reason;
+    for (GrindPhase phase : DECISION_PHASES) {
+        std::vector<float> ref_values;
+        std::vector<float> replay_values;
+        for (const Decision& d : reference.decisions) {
+            if (d.phase_id == (uint8_t)phase) ref_values.push_back(d.value_ms);
+        }
+        for (const Decision& d : replay.decisions) {
+            if (d.phase_id == (uint8_t)phase) replay_values.push_back(d.value_ms);
+        }
+        DecisionStats& stats = totals.by_phase[(uint8_t)phase];
+        stats.reference += ref_values.size();
+        stats.replay += replay_values.size();
+        for (size_t i = 0; i < std::min(ref_values.size(), replay_values.size()); i++) {
+            float delta = replay_values[i] - ref_values[i];
+            stats.deltas.push_back(delta);
+            if (fabsf(delta) < SAME_DECISION_MS) {
+                stats.same++;
+            } else {
+                identical = false;
+            }
+        }
+        if (ref_values.size() != replay_values.size()) {
+            identical = false;
+        }
+    }
+
+    totals.sessions++;
+    if (identical) totals.identical++;
+    if (reference.termination_reason != replay.termination_reason) totals.termination_changed++;
+    totals.reference_errors.push_back(reference.final_weight - target);
+    totals.replay_errors.push_back(replay.final_weight - target);
+
+    if (list && !identical) {
+        printf("  session %lu:", (unsigned long)session_id);
+        for (const SessionDecisions* side : {&reference, &replay}) {
+            printf(side == &reference ? "\n    reference" : "\n    replay   ");
+            for (const Decision& d : side->decisions) {
+                printf(" %s %.0f", decision_label((GrindPhase)d.phase_id), d.value_ms);
+            }
+            printf("  -> %.2fg", side->final_weight);
+        }
+        printf("\n");
+    }
+    return identical;
+}
+
+float percentile(std::vector<float> values, float p) {
+    if (values.empty()) return 0.0f;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p / 100.0f * (values.size() - 1) + 0.5f);
+    return values[std::min(index, values.size() - 1)];
+}
+
+void print_error(const char* label, const std::vector<float>& errors) {
+    if (errors.empty()) return;
+    double sum_abs = 0.0;
+    uint32_t within = 0;
+    for (float e : errors) {
+        sum_abs += fabsf(e);
+        if (fabsf(e) <= GRIND_ACCURACY_TOLERANCE_G) within++;
+    }
+    printf("  %-22s mae %.3fg  p5 %+.3f  p50 %+.3f  p95 %+.3f  within +/-%.2fg %.1f%%\n", label,
+           sum_abs / errors.size(), percentile(errors, 5), percentile(errors, 50), percentile(errors, 95),
+           GRIND_ACCURACY_TOLERANCE_G, 100.0 * within / errors.size());
+}
+
+void print_diff(const DiffTotals& totals, const char* reference_label) {
+    printf("\nDecisions (replay - %s)\n", reference_label);
+    printf("  %-16s %9s %7s %7s %8s %8s %8s %8s %9s\n", "", reference_label, "replay", "same",
+           "mean", "p5", "p50", "p95", "max |d|");
+    for (GrindPhase phase : DECISION_PHASES) {
+        auto it = totals.by_phase.find((uint8_t)phase);
+        if (it == totals.by_phase.end() || (it->second.reference == 0 && it->second.replay == 0)) continue;
+        const DecisionStats& stats = it->second;
+        double sum = 0.0;
+        float max_abs = 0.0f;
+        for (float d : stats.deltas) {
+            sum += d;
+            max_abs = std::max(max_abs, fabsf(d));
+        }
+        float mean = stats.deltas.empty() ? 0.0f : (float)(sum / stats.deltas.size());
+        printf("  %-16s %9lu %7lu %7lu %+7.1f %+7.1f %+7.1f %+7.1f %8.1f ms\n", decision_label(phase),
+               (unsigned long)stats.reference, (unsigned long)stats.replay, (unsigned long)stats.same, mean,
+               percentile(stats.deltas, 5), percentile(stats.deltas, 50), percentile(stats.deltas, 95), max_abs);
+    }
+    printf("  sessions with identical decisions: %lu / %lu, termination reason changed: %lu\n",
+           (unsigned long)totals.identical, (unsigned long)totals.sessions, (unsigned long)totals.termination_changed);
+
+    printf("\nFinal weight - target\n");
+    print_error(reference_label, totals.reference_errors);
+    print_error("replay (estimated)", totals.replay_errors);
+}
+
+uint32_t session_id_from_path(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    unsigned long id = 0;
+    sscanf(path.c_str() + (slash == std::string::npos ? 0 : slash + 1), "session_%lu.bin", &id);
+    return (uint32_t)id;
+}
+
+void print_help() {
+    printf("Usage: replay DIR [options]\n"
+           "       replay --self-check N\n"
+           "  Reads session_*.bin from DIR or DIR/sessions (device files, sim --save-sessions, or\n"
+           "  exported from the grinder-ble.py database with `grinder-ble.py dump-sessions`)\n"
+           "  --save FILE           write the replayed decisions to FILE\n"
+           "  --baseline FILE       diff against decisions saved with --save instead of the log\n"
+           "  --list                print the decisions (ms) of every session that differs\n"
+           "  --motor-latency MS    pulse motor latency (default: controller default %.0f)\n"
+           "  --purge-amount G      prime/purge amount (default %.1f)\n"
+           "  --stop-planner NAME   motor stop planner: coast-ratio|model (default %s)\n"
+           "  --sps N               load cell sample rate of the recording (default %d)\n"
+           "  --wakeup MODE         control scheduling: auto|lockstep|sample (default auto: lockstep for\n"
+           "                        sessions logged every control interval, as `sim` writes by default)\n"
+           "  --save-sessions DIR   keep the replayed session files in DIR\n"
+           "  --self-check N        replay N (up to %d) grinds `sim` writes now and fail unless every\n"
+           "                        decision is identical (scale noise-free at rest, weights logged to 0.01mg)\n"
+           "  --verbose             print firmware log output\n",
+           GRIND_MOTOR_RESPONSE_LATENCY_DEFAULT_MS, GRIND_PURGE_AMOUNT_DEFAULT_G,
+           GRIND_STOP_PLANNER_DEFAULT == static_cast<int>(StopPlannerType::MODEL) ? "model" : "coast-ratio",
+           HW_LOADCELL_SAMPLE_RATE_SPS, MAX_STORED_SESSIONS_FLASH);
+}
+
+bool parse_args(int argc, char** argv, ReplayConfig& config) {
+    if (argc < 1 || strcmp(argv[0], "--help") == 0) {
+        return false;
+    }
+    int first = 0;
+    if (strncmp(argv[0], "--", 2) != 0) {
+        config.dir = argv[0];
+        first = 1;
+    }
+    for (int i = first; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--list") == 0) {
+            config.list = true;
+            continue;
+        }
+        if (strcmp(arg, "--verbose") == 0) {
+            config.verbose = true;
+            continue;
+        }
+        if (strcmp(arg, "--help") == 0 || i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--save") == 0) config.save_path = value;
+        else if (strcmp(arg, "--baseline") == 0) config.baseline_path = value;
+        else if (strcmp(arg, "--motor-latency") == 0) config.motor_latency_ms = strtof(value, nullptr);
+        else if (strcmp(arg, "--purge-amount") == 0) config.purge_amount_g = strtof(value, nullptr);
+        else if (strcmp(arg, "--sps") == 0) config.sps = std::max(1UL, strtoul(value, nullptr, 10));
+        else if (strcmp(arg, "--save-sessions") == 0) config.session_dir = value;
+        else if (strcmp(arg, "--self-check") == 0) {
+            // Older sessions would be rotated out, and the controller state they built with them
+            config.self_check_grinds = std::min<uint32_t>(strtoul(value, nullptr, 10), MAX_STORED_SESSIONS_FLASH);
+        }
+        else if (strcmp(arg, "--wakeup") == 0) {
+            if (strcmp(value, "auto") == 0) config.wakeup = ReplayWakeup::AUTO;
+            else if (strcmp(value, "lockstep") == 0) config.wakeup = ReplayWakeup::LOCKSTEP;
+            else if (strcmp(value, "sample") == 0) config.wakeup = ReplayWakeup::SAMPLE;
+            else return false;
+        }
+        else if (strcmp(arg, "--stop-planner") == 0) {
+            if (strcmp(value, "coast-ratio") == 0) config.stop_planner = static_cast<int>(StopPlannerType::COAST_RATIO);
+            else if (strcmp(value, "model") == 0) config.stop_planner = static_cast<int>(StopPlannerType::MODEL);
+            else return false;
+        }
+        else return false;
+    }
+    return (config.dir != nullptr) != (config.self_check_grinds > 0);
+}
+
+// Writes the sessions of a fresh `sim` run into dir, in a child process as the simulator and
+// the replay share the firmware globals. Lockstep only: a sample-driven control update logs a
+// sample averaged with the previous one, rounded down to a whole count, and where no later
+// measurement shows it alone the sample comes back one count off half the time.
+bool simulate_sessions(const ReplayConfig& config, const std::string& dir) {
+    std::string grinds = std::to_string(config.self_check_grinds);
+    char quantum[16];
+    snprintf(quantum, sizeof(quantum), "%g", SELF_CHECK_WEIGHT_QUANTUM_G);
+    std::vector<const char*> args = {"--grinds", grinds.c_str(), "--idle-noise", "0", "--weight-quantum", quantum,
+                                     "--save-sessions", dir.c_str()};
+
+    fflush(stdout);
+    pid_t child = fork();
+    if (child < 0) {
+        return false;
+    }
+    if (child == 0) {
+        if (!freopen("/dev/null", "w", stdout)) {
+            _exit(1);
+        }
+        _exit(run_grind_simulator((int)args.size(), const_cast<char**>(args.data())));
+    }
+    int status = 0;
+    return waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+} // namespace
+
+int run_session_replay(int argc, char** argv) {
+    ReplayConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_help();
+        return argc < 1 ? 1 : 0;
+    }
+
+    Serial.enabled = config.verbose;
+
+    // Self-check: this build's `sim` sessions, which hold everything the control code saw
+    std::string self_check_dir;
+    if (config.self_check_grinds > 0) {
+        char temp_dir[] = "/tmp/grind-self-check-XXXXXX";
+        if (!mkdtemp(temp_dir)) {
+            printf("Cannot create a temporary directory\n");
+            return 1;
+        }
+        self_check_dir = temp_dir;
+        config.dir = self_check_dir.c_str();
+        if (!simulate_sessions(config, self_check_dir)) {
+            printf("Simulator run for the self-check failed\n");
+            std::error_code error;
+            std::filesystem::remove_all(self_check_dir, error);
+            return 1;
+        }
+    }
+
+    std::string dir = config.dir;
+    std::vector<std::string> paths;
+    collect_session_files(dir, paths);
+    collect_session_files(dir + "/sessions", paths);
+    if (paths.empty()) {
+        printf("No session_*.bin files in %s\n", dir.c_str());
+        return 1;
+    }
+    std::sort(paths.begin(), paths.end(), [](const std::string& a, const std::string& b) {
+        return session_id_from_path(a) < session_id_from_path(b);
+    });
+
+    std::map<uint32_t, SessionDecisions> baseline;
+    if (config.baseline_path && !load_decisions(config.baseline_path, baseline)) {
+        printf("Cannot read baseline %s\n", config.baseline_path);
+        return 1;
+    }
+
+    // The replay logs its own sessions to read the decisions back
+    std::string host_root;
+    if (config.session_dir) {
+        host_root = config.session_dir;
+    } else {
+        char temp_dir[] = "/tmp/grind-replay-XXXXXX";
+        if (!mkdtemp(temp_dir)) {
+            printf("Cannot create a temporary directory\n");
+            return 1;
+        }
+        host_root = temp_dir;
+    }
+
+    SessionReplay replay(config, host_root);
+    replay.setup();
+
+    std::map<uint32_t, SessionDecisions> replayed;
+    DiffTotals totals;
+    uint32_t failed = 0;
+    uint32_t skipped = 0;
+    uint32_t unfinished = 0;
+    auto wall_start = std::chrono::steady_clock::now();
+    unsigned long sim_start_ms = millis();
+
+    for (const std::string& path : paths) {
+        std::vector<GrindEvent> events;
+        std::vector<GrindMeasurement> measurements;
+        GrindSession session;
+        if (!load_session_file(path, events, measurements, &session)) {
+            printf("  FAILED %s\n", path.c_str());
+            failed++;
+            continue;
+        }
+        bool has_predictive = std::any_of(events.begin(), events.end(), [](const GrindEvent& e) {
+            return (GrindPhase)e.phase_id == GrindPhase::PREDICTIVE;
+        });
+        if (session.grind_mode != static_cast<uint8_t>(GrindMode::WEIGHT) || !has_predictive || measurements.empty()) {
+            skipped++;
+            continue;
+        }
+
+        SessionDecisions result = replay.run(session, events, measurements);
+        if (!result.valid) {
+            unfinished++;
+            continue;
+        }
+        replayed[session.session_id] = result;
+
+        SessionDecisions reference;
+        if (config.baseline_path) {
+            auto it = baseline.find(session.session_id);
+            if (it == baseline.end()) continue;
+            reference = it->second;
+        } else {
+            reference = extract_decisions(events, session);
+        }
+        diff_session(session.session_id, session.target_weight, reference, result, totals, config.list);
+    }
+
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    double sim_s = (millis() - sim_start_ms) / 1000.0;
+
+    if (!config.session_dir) {
+        std::error_code error;
+        std::filesystem::remove_all(host_root, error);
+    }
+    if (!self_check_dir.empty()) {
+        std::error_code error;
+        std::filesystem::remove_all(self_check_dir, error);
+    }
+    if (config.save_path && !save_decisions(config.save_path, replayed)) {
+        printf("Cannot write %s\n", config.save_path);
+        failed++;
+    }
+
+    printf("Session replay: %lu files, %lu replayed, %lu skipped (time mode or incomplete), %lu unfinished, %lu failed\n",
+           (unsigned long)paths.size(), (unsigned long)replayed.size(), (unsigned long)skipped,
+           (unsigned long)unfinished, (unsigned long)failed);
+    printf("  speed: %.2fs wall, %.0f sessions/s, %.0fx real time\n", wall_s,
+           replayed.size() / std::max(wall_s, 1e-9), sim_s / std::max(wall_s, 1e-9));
+    print_diff(totals, config.baseline_path ? "baseline" : "log");
+
+    if (config.self_check_grinds > 0) {
+        bool passed = failed == 0 && totals.sessions == config.self_check_grinds && totals.identical == totals.sessions;
+        printf("\nSelf-check: %s (%lu of %lu sim grinds replayed with identical decisions)\n", passed ? "PASS" : "FAIL",
+               (unsigned long)totals.identical, (unsigned long)config.self_check_grinds);
+        return passed ? 0 : 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
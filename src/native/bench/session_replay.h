@@ -0,0 +1,7 @@
+#pragma once
+
+// Deterministic session replay: plays the load cell samples recovered from session files back
+// through WeightSensor, GrindController and WeightGrindStrategy on the virtual clock and diffs the
+// replayed decisions (motor stops, pulse durations, settling times) against the logged ones or a
+// saved baseline. Options are listed by `replay --help`.
+int run_session_replay(int argc, char** argv);
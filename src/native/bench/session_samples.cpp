@@ -0,0 +1,145 @@
+#include "session_samples.h"
+#include "../../logging/session_codec.h"
+#include <Arduino.h>
+#include <dirent.h>
+
+namespace {
+
+bool read_file(const std::string& path, std::vector<uint8_t>& data) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(file);
+    return true;
+}
+
+} // namespace
+
+void collect_session_files(const std::string& dir, std::vector<std::string>& paths) {
+    DIR* handle = opendir(dir.c_str());
+    if (!handle) return;
+    while (struct dirent* entry = readdir(handle)) {
+        std::string name = entry->d_name;
+        if (name.rfind("session_", 0) == 0 && name.size() > 4 && name.compare(name.size() - 4, 4, ".bin") == 0) {
+            paths.push_back(dir + "/" + name);
+        }
+    }
+    closedir(handle);
+}
+
+bool load_session_file(const std::string& path, std::vector<GrindEvent>& events,
+                       std::vector<GrindMeasurement>& measurements, GrindSession* session) {
+    std::vector<uint8_t> data;
+    TimeSeriesSessionHeader header;
+    if (!read_file(path, data) || data.size() < sizeof(header) + sizeof(GrindSession)) {
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (session) {
+        memcpy(session, data.data() + sizeof(header), sizeof(GrindSession));
+    }
+
+    size_t body_offset = sizeof(header) + sizeof(GrindSession);
+    events.resize(max<size_t>(1, header.event_count));
+    measurements.resize(max<size_t>(1, header.measurement_count));
+    if (header.schema_version >= 3) {
+        size_t events_size = 0;
+        if (!decode_event_block(data.data() + body_offset, data.size() - body_offset,
+                                header.event_count, events.data(), &events_size) ||
+            !decode_measurement_block(data.data() + body_offset + events_size, data.size() - body_offset - events_size,
+                                      header.measurement_count, measurements.data())) {
+            return false;
+        }
+    } else {
+        size_t events_size = header.event_count * sizeof(GrindEvent);
+        if (data.size() < body_offset + events_size + header.measurement_count * sizeof(GrindMeasurement)) {
+            return false;
+        }
+        memcpy(events.data(), data.data() + body_offset, events_size);
+        memcpy(measurements.data(), data.data() + body_offset + events_size,
+               header.measurement_count * sizeof(GrindMeasurement));
+    }
+    events.resize(header.event_count);
+    measurements.resize(header.measurement_count);
+    return true;
+}
+
+std::vector<RecoveredSample> recover_load_cell_samples(const std::vector<GrindMeasurement>& measurements,
+                                                       uint32_t sample_rate_sps) {
+    std::vector<RecoveredSample> samples;
+    if (measurements.empty()) return samples;
+
+    uint32_t interval_ms = 1000 / max<uint32_t>(1, sample_rate_sps);
+    // Up to two samples fit the window, and two are averaged
+    bool unmix_pairs = interval_ms * 2 > LOGGED_WEIGHT_WINDOW_MS;
+    const GrindMeasurement* sample_start = &measurements[0];
+    uint32_t sample_ms = sample_start->timestamp_ms;
+    float weight = sample_start->weight_grams;
+    // The log starts with a sample in the window: the first change is the next one arriving
+    uint32_t last_change_ms = sample_start->timestamp_ms - interval_ms;
+    uint32_t last_seen_ms = sample_start->timestamp_ms;
+    bool previous_exact = false;
+    auto emit = [&]() {
+        // Mixed with the previous sample if that was still in the window when last logged; the
+        // previous sample is usable only if it was logged itself and recovered exactly
+        bool previous_logged = !samples.empty() && sample_ms - samples.back().timestamp_ms <= interval_ms * 3 / 2;
+        uint32_t previous_ms = previous_logged ? samples.back().timestamp_ms : sample_ms - interval_ms;
+        bool mixed = unmix_pairs && last_seen_ms - previous_ms <= LOGGED_WEIGHT_WINDOW_MS;
+        float value = weight;
+        if (mixed && previous_logged && previous_exact) {
+            // In double: the float difference would round off counts at large weights
+            value = (float)(2.0 * weight - samples.back().weight);
+        }
+        previous_exact = !mixed || (previous_logged && previous_exact);
+        samples.push_back({sample_ms, value, sample_start->motor_is_on, sample_start->phase_id,
+                           (uint8_t)!previous_exact});
+    };
+
+    bool arrival_seen = false;
+    for (const GrindMeasurement& m : measurements) {
+        if (m.weight_grams != weight) {
+            if (m.timestamp_ms - last_change_ms >= interval_ms / 2) {
+                if (!arrival_seen) {
+                    // No arrival shows before the first change: the samples so far are dated back from
+                    // it, down to the one in the window of the first measurement
+                    samples.clear();
+                    previous_exact = false;
+                    uint32_t before = (m.timestamp_ms - measurements[0].timestamp_ms + interval_ms - 1) / interval_ms;
+                    for (uint32_t k = before; k >= 1; k--) {
+                        sample_ms = m.timestamp_ms >= k * interval_ms ? m.timestamp_ms - k * interval_ms : 0;
+                        emit();
+                    }
+                } else {
+                    emit();
+                    // Samples that logged unchanged in between were repeated
+                    while (m.timestamp_ms - sample_ms >= interval_ms * 3 / 2) {
+                        sample_ms += interval_ms;
+                        emit();
+                    }
+                }
+                sample_start = &m;
+                // Averaged with the previous sample it can log unchanged when it arrives: then it
+                // came in with the last measurement that was due for it
+                bool arrived_unchanged = arrival_seen && last_seen_ms - sample_ms >= interval_ms &&
+                                         m.timestamp_ms - last_seen_ms < interval_ms / 2;
+                sample_ms = arrived_unchanged ? last_seen_ms : m.timestamp_ms;
+                arrival_seen = true;
+            }
+            weight = m.weight_grams;
+            last_change_ms = m.timestamp_ms;
+        } else if (m.timestamp_ms - sample_ms >= interval_ms * 3 / 2) {
+            // Repeated sample, due one interval after the previous one
+            emit();
+            sample_start = &m;
+            sample_ms += interval_ms;
+            last_change_ms = sample_ms;
+        }
+        last_seen_ms = m.timestamp_ms;
+    }
+    emit();
+    return samples;
+}
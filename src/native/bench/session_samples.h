@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../../logging/grind_logging.h"
+#include <string>
+#include <vector>
+
+// Session file access shared by the host tools that replay logged grinds.
+
+// Appends the session_*.bin files in dir (not recursive)
+void collect_session_files(const std::string& dir, std::vector<std::string>& paths);
+
+// Decodes the events and measurements of a schema v2 or v3 session file, and its summary if session is set
+bool load_session_file(const std::string& path, std::vector<GrindEvent>& events,
+                       std::vector<GrindMeasurement>& measurements, GrindSession* session = nullptr);
+
+// Window of the weight logged with each measurement (CircularBufferMath::get_raw_low_latency())
+const uint32_t LOGGED_WEIGHT_WINDOW_MS = 100;
+
+struct RecoveredSample {
+    uint32_t timestamp_ms;    // Relative to session start
+    float weight;             // g
+    uint8_t motor_is_on;
+    uint8_t phase_id;
+    uint8_t mixed;            // Still averaged with the previous sample (see below)
+};
+
+// Load cell samples recovered from measurements logged with the 100ms low-latency weight:
+// the window changes twice per sample - when a sample arrives (averaged with the previous
+// one) and when the previous one leaves. A change after a quiet gap of half a sample
+// interval starts a new sample, and the last weight before it is the previous sample on
+// its own. An unchanged weight for 1.5 sample intervals is taken as a repeated sample, one
+// interval after the previous one; a change seen just after a measurement that was already
+// due for the next sample is dated to that measurement, as the average can round to the
+// previous weight. Before the first change no arrival shows: those samples are dated back
+// from it at the sample interval.
+// At rates where the window holds at most two samples, a weight last logged while the
+// previous sample was still in the window is their average and is unmixed, unless the
+// previous sample is not known exactly (after a gap in the log): then it stays mixed.
+std::vector<RecoveredSample> recover_load_cell_samples(const std::vector<GrindMeasurement>& measurements,
+                                                       uint32_t sample_rate_sps);
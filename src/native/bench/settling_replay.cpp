@@ -0,0 +1,270 @@
+#include "settling_replay.h"
+#include "session_samples.h"
+#include "../../hardware/circular_buffer_math/settling_detector.h"
+#include "../../controllers/grind_controller.h"
+#include "../../logging/grind_logging.h"
+#include "../../config/constants.h"
+#include <Arduino.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/*
+ * Sequential settling replay
+ *
+ * Reads every session_*.bin under DIR (or DIR/sessions), recovers the load cell sample
+ * stream from the logged measurements and runs SettlingDetector over the whole session,
+ * exactly as WeightSensor feeds it. For every settling round the session logged:
+ *   - stop and pulse rounds: PULSE_SETTLING after the predictive stop or after a pulse,
+ *     plus the PULSE_DECISION that read the settled weight. As in WeightGrindStrategy,
+ *     the detector ends the round early only on a segment that follows a rise: detected
+ *     GRIND_MOTOR_SETTLING_TIME_MS or more after the predictive stop, or at least the motor
+ *     response latency (--motor-latency, not logged) after a pulse started. After a pulse the
+ *     round also lasts until the grind latency (logged with the PREDICTIVE event) has passed
+ *     since the pulse started.
+ *   - final rounds: FINAL_SETTLING, where any settled segment counts
+ * it reports the logged wait, the wait with the detector OR-ed with the fixed window (as
+ * the firmware does) and the settled value against a reference - the mean weight over the
+ * last REFERENCE_WINDOW_MS of the round.
+ *
+ * Replay sessions recorded with the fixed window only (GRIND_SEQUENTIAL_SETTLING=0 or an
+ * older firmware): their rounds end on a long quiet window, which is what the reference needs.
+ * The samples are recovered from the logged low-latency weight (recover_load_cell_samples()).
+ */
+
+namespace {
+
+const uint32_t REFERENCE_WINDOW_MS = 300;
+
+struct ReplayConfig {
+    const char* dir = nullptr;
+    SettlingDetector::Config detector;
+    uint32_t sps = HW_LOADCELL_SAMPLE_RATE_SPS;
+    uint32_t motor_latency_ms = (uint32_t)GRIND_MOTOR_RESPONSE_LATENCY_DEFAULT_MS;
+};
+
+struct RoundStats {
+    std::vector<float> logged_ms;
+    std::vector<float> replay_ms;
+    std::vector<float> saved_ms;
+    std::vector<float> abs_errors;
+    uint32_t detector_settled = 0;
+    uint32_t false_settles = 0;
+};
+
+struct Sample {
+    uint32_t timestamp_ms;
+    float weight;
+    SettlingEstimate estimate;
+};
+
+std::vector<Sample> replay_samples(const std::vector<GrindMeasurement>& measurements, const ReplayConfig& config) {
+    SettlingDetector detector;
+    detector.configure(config.detector);
+
+    std::vector<Sample> samples;
+    for (const RecoveredSample& recovered : recover_load_cell_samples(measurements, config.sps)) {
+        detector.add_sample(recovered.weight, recovered.timestamp_ms);
+        samples.push_back({recovered.timestamp_ms, recovered.weight, detector.estimate()});
+    }
+    return samples;
+}
+
+bool reference_weight(const std::vector<Sample>& samples, uint32_t start_ms, uint32_t end_ms, float* reference) {
+    uint32_t from = end_ms - min(REFERENCE_WINDOW_MS, end_ms - start_ms);
+    double sum = 0.0;
+    int count = 0;
+    for (const Sample& s : samples) {
+        if (s.timestamp_ms > from && s.timestamp_ms <= end_ms) {
+            sum += s.weight;
+            count++;
+        }
+    }
+    if (count == 0) return false;
+    *reference = (float)(sum / count);
+    return true;
+}
+
+// rise_after_ms = 0: any settled segment counts, as for FINAL_SETTLING. Before settle_after_ms
+// the round cannot end early.
+void replay_round(const std::vector<Sample>& samples, uint32_t start_ms, uint32_t end_ms, uint32_t rise_after_ms,
+                  uint32_t settle_after_ms, float tolerance, RoundStats& stats) {
+    float reference;
+    if (end_ms <= start_ms || !reference_weight(samples, start_ms, end_ms, &reference)) {
+        return;
+    }
+
+    uint32_t logged_ms = end_ms - start_ms;
+    uint32_t replay_ms = logged_ms;
+    const Sample* settled = nullptr;
+    for (size_t i = 0; i < samples.size() && samples[i].timestamp_ms < end_ms; i++) {
+        const Sample& s = samples[i];
+        bool latest = i + 1 == samples.size() || samples[i + 1].timestamp_ms > start_ms;
+        if (s.timestamp_ms < start_ms && !latest) continue;
+        bool after_rise = s.estimate.last_rise_ms != 0 &&
+                          (int32_t)(s.estimate.last_rise_ms - rise_after_ms) >= 0 &&
+                          (int32_t)(s.estimate.segment_start_ms - s.estimate.last_rise_ms) >= 0;
+        if (s.estimate.settled && (rise_after_ms == 0 || after_rise) &&
+            (int32_t)(s.timestamp_ms - settle_after_ms) >= 0) {
+            settled = &s;
+            replay_ms = s.timestamp_ms > start_ms ? s.timestamp_ms - start_ms : 0;
+            break;
+        }
+    }
+
+    stats.logged_ms.push_back(logged_ms);
+    stats.replay_ms.push_back(replay_ms);
+    stats.saved_ms.push_back((float)logged_ms - replay_ms);
+    if (settled) {
+        float error = fabsf(settled->estimate.value - reference);
+        stats.detector_settled++;
+        stats.abs_errors.push_back(error);
+        if (error > tolerance) stats.false_settles++;
+    }
+}
+
+void replay_session(const std::vector<GrindEvent>& events, const std::vector<Sample>& samples,
+                    const ReplayConfig& config, RoundStats& stop_stats, RoundStats& pulse_stats,
+                    RoundStats& final_stats) {
+    float tolerance = config.detector.tolerance;
+    uint32_t grind_latency_ms = 0;
+    for (const GrindEvent& event : events) {
+        if ((GrindPhase)event.phase_id == GrindPhase::PREDICTIVE) {
+            grind_latency_ms = event.grind_latency_ms;
+        }
+    }
+    for (size_t i = 0; i < events.size(); i++) {
+        const GrindEvent& event = events[i];
+        GrindPhase phase = (GrindPhase)event.phase_id;
+        if (phase == GrindPhase::PULSE_SETTLING && i + 1 < events.size() &&
+                   (GrindPhase)events[i + 1].phase_id == GrindPhase::PULSE_DECISION) {
+            const GrindEvent& decision = events[i + 1];
+            bool after_pulse = i > 0 && (GrindPhase)events[i - 1].phase_id == GrindPhase::PULSE_EXECUTE;
+            uint32_t rise_after_ms = after_pulse ? events[i - 1].timestamp_ms + config.motor_latency_ms
+                                                 : event.timestamp_ms + GRIND_MOTOR_SETTLING_TIME_MS;
+            uint32_t settle_after_ms = after_pulse ? events[i - 1].timestamp_ms + grind_latency_ms : 0;
+            replay_round(samples, event.timestamp_ms, decision.timestamp_ms + decision.duration_ms,
+                         rise_after_ms, settle_after_ms, tolerance, after_pulse ? pulse_stats : stop_stats);
+        } else if (phase == GrindPhase::FINAL_SETTLING) {
+            replay_round(samples, event.timestamp_ms, event.timestamp_ms + event.duration_ms, 0, 0,
+                         tolerance, final_stats);
+        }
+    }
+}
+
+float percentile(std::vector<float> values, float p) {
+    if (values.empty()) return 0.0f;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p / 100.0f * (values.size() - 1) + 0.5f);
+    return values[std::min(index, values.size() - 1)];
+}
+
+float mean(const std::vector<float>& values) {
+    if (values.empty()) return 0.0f;
+    double sum = 0.0;
+    for (float v : values) sum += v;
+    return (float)(sum / values.size());
+}
+
+void print_rounds(const char* label, const RoundStats& stats, float false_settle_probability) {
+    size_t rounds = stats.logged_ms.size();
+    printf("%s rounds: %lu, detector settled in %lu\n", label, (unsigned long)rounds,
+           (unsigned long)stats.detector_settled);
+    if (rounds == 0) return;
+    printf("  logged wait   mean %6.0f  p50 %6.0f  p90 %6.0f ms\n", mean(stats.logged_ms),
+           percentile(stats.logged_ms, 50), percentile(stats.logged_ms, 90));
+    printf("  replay wait   mean %6.0f  p50 %6.0f  p90 %6.0f ms\n", mean(stats.replay_ms),
+           percentile(stats.replay_ms, 50), percentile(stats.replay_ms, 90));
+    printf("  time saved    mean %6.0f  p10 %6.0f  p50 %6.0f  p90 %6.0f ms per round\n", mean(stats.saved_ms),
+           percentile(stats.saved_ms, 10), percentile(stats.saved_ms, 50), percentile(stats.saved_ms, 90));
+    if (stats.detector_settled > 0) {
+        printf("  |settled - reference|  mean %.4f  p99 %.4f  max %.4f g\n", mean(stats.abs_errors),
+               percentile(stats.abs_errors, 99), percentile(stats.abs_errors, 100));
+        printf("  outside tolerance: %lu (%.2f%%, configured false settle probability %.2f%%)\n",
+               (unsigned long)stats.false_settles, 100.0 * stats.false_settles / stats.detector_settled,
+               100.0 * false_settle_probability);
+    }
+}
+
+void print_help() {
+    printf("Usage: settle-replay DIR [options]\n"
+           "  Reads session_*.bin from DIR or DIR/sessions (e.g. written by sim --save-sessions DIR)\n"
+           "  --probability P   false settle probability (default %.3f)\n"
+           "  --tolerance G     settled value tolerance in grams (default %.3f)\n"
+           "  --min-samples N   samples before a segment may settle (default %d)\n"
+           "  --sps N           load cell sample rate of the recording (default %d)\n"
+           "  --motor-latency MS  motor response latency before a pulse's grounds can land (default %.0f)\n",
+           GRIND_SETTLE_FALSE_SETTLE_PROBABILITY, GRIND_SETTLE_TOLERANCE_G, GRIND_SETTLE_MIN_SAMPLES,
+           HW_LOADCELL_SAMPLE_RATE_SPS, GRIND_MOTOR_RESPONSE_LATENCY_DEFAULT_MS);
+}
+
+bool parse_args(int argc, char** argv, ReplayConfig& config) {
+    if (argc < 1 || strcmp(argv[0], "--help") == 0) {
+        return false;
+    }
+    config.dir = argv[0];
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--help") == 0 || i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--probability") == 0) config.detector.false_settle_probability = strtof(value, nullptr);
+        else if (strcmp(arg, "--tolerance") == 0) config.detector.tolerance = strtof(value, nullptr);
+        else if (strcmp(arg, "--min-samples") == 0) config.detector.min_samples = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--sps") == 0) config.sps = std::max(1UL, strtoul(value, nullptr, 10));
+        else if (strcmp(arg, "--motor-latency") == 0) config.motor_latency_ms = strtoul(value, nullptr, 10);
+        else return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int run_settling_replay(int argc, char** argv) {
+    ReplayConfig config;
+    config.detector.tolerance = GRIND_SETTLE_TOLERANCE_G;
+    config.detector.false_settle_probability = GRIND_SETTLE_FALSE_SETTLE_PROBABILITY;
+    config.detector.min_samples = GRIND_SETTLE_MIN_SAMPLES;
+    config.detector.noise_initial = GRIND_SETTLE_NOISE_INITIAL_G;
+    config.detector.noise_min = GRIND_SETTLE_NOISE_MIN_G;
+    config.detector.cusum_slack = GRIND_SETTLE_CUSUM_SLACK;
+    config.detector.cusum_threshold = GRIND_SETTLE_CUSUM_THRESHOLD;
+    if (!parse_args(argc, argv, config)) {
+        print_help();
+        return argc < 1 ? 1 : 0;
+    }
+
+    std::string dir = config.dir;
+    std::vector<std::string> paths;
+    collect_session_files(dir, paths);
+    collect_session_files(dir + "/sessions", paths);
+    if (paths.empty()) {
+        printf("No session_*.bin files in %s\n", dir.c_str());
+        return 1;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    RoundStats stop_stats;
+    RoundStats pulse_stats;
+    RoundStats final_stats;
+    uint32_t failed = 0;
+    for (const std::string& path : paths) {
+        std::vector<GrindEvent> events;
+        std::vector<GrindMeasurement> measurements;
+        if (!load_session_file(path, events, measurements)) {
+            printf("  FAILED %s\n", path.c_str());
+            failed++;
+            continue;
+        }
+        replay_session(events, replay_samples(measurements, config), config, stop_stats, pulse_stats, final_stats);
+    }
+
+    printf("Settling replay: %lu sessions (%lu failed), tolerance %.3fg, false settle probability %.3f, "
+           "min samples %u\n", (unsigned long)paths.size(), (unsigned long)failed, config.detector.tolerance,
+           config.detector.false_settle_probability, (unsigned)config.detector.min_samples);
+    print_rounds("Predictive stop", stop_stats, config.detector.false_settle_probability);
+    print_rounds("Pulse", pulse_stats, config.detector.false_settle_probability);
+    print_rounds("Final", final_stats, config.detector.false_settle_probability);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Replays the logged weights of session files (a `sim --save-sessions DIR` directory or files
+// pulled from a device) through SettlingDetector and reports how much earlier it settles each
+// pulse and final settling round than the logged fixed-window wait, and how far from the
+// reference weight it settles. Options are listed by `settle-replay --help`.
+int run_settling_replay(int argc, char** argv);
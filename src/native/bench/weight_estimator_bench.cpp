@@ -0,0 +1,304 @@
+#include "weight_estimator_bench.h"
+#include "session_samples.h"
+#include "../../hardware/circular_buffer_math/circular_buffer_math.h"
+#include "../../hardware/circular_buffer_math/weight_flow_estimator.h"
+#include "../../controllers/grind_controller.h"
+#include "../../config/constants.h"
+#include <Arduino.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Weight/flow estimator benchmark
+ *
+ * Reads every session_*.bin under DIR (or DIR/sessions), recovers the load cell sample
+ * stream and the motor state from the logged measurements and feeds both, sample by
+ * sample, to:
+ *   - filters: CircularBufferMath as WeightSensor feeds it - the 100ms low-latency weight
+ *     and the 200ms flow rate GrindController used as its control values
+ *   - kalman:  WeightFlowEstimator with the configured noise model
+ * Each output is scored against a centred linear fit over +-REFERENCE_HALF_WINDOW_MS of
+ * samples - a non-causal estimate neither filter could have had at the time. Samples are
+ * split into flowing (motor running or within the coast window, reference flow above
+ * FLOWING_MIN_GPS), idle (no grounds can arrive) and stop (the last sample with the motor
+ * running in PREDICTIVE - the weight the stop planner acts on). The flow ramps down right
+ * after a stop, so the stop reference is fitted over the 2 * REFERENCE_HALF_WINDOW_MS of
+ * steady flow before it instead. Lag is the weight bias divided by the reference flow.
+ *
+ * A fit is only taken within one reference segment: a new segment starts at every phase
+ * change (the PREDICTIVE tare), after a logging gap and at a step the flow cannot explain -
+ * a second difference above REFERENCE_JUMP_SIGMA times its session-wide robust spread (a
+ * tare while the phase was unchanged, a cup lifted). Samples within two samples of a
+ * segment edge get no reference and are not scored.
+ */
+
+namespace {
+
+const uint32_t REFERENCE_HALF_WINDOW_MS = 300;
+const float FLOWING_MIN_GPS = 0.5f;
+const float REFERENCE_MAX_GAP_INTERVALS = 2.5f;   // Sample intervals without a sample that split a segment
+const float REFERENCE_JUMP_SIGMA = 8.0f;
+const float REFERENCE_MIN_SPREAD_G = 0.002f;      // Floor for the second difference spread
+
+struct BenchConfig {
+    const char* dir = nullptr;
+    WeightFlowEstimator::Config estimator;
+    uint32_t sps = HW_LOADCELL_SAMPLE_RATE_SPS;
+};
+
+struct ErrorStats {
+    uint32_t count = 0;
+    double weight_error_sum = 0.0;
+    double weight_error_squares = 0.0;
+    double flow_error_sum = 0.0;
+    double flow_error_squares = 0.0;
+    double lag_ms_sum = 0.0;
+    uint32_t lag_count = 0;
+
+    void add(float weight_error, float flow_error, float reference_flow) {
+        count++;
+        weight_error_sum += weight_error;
+        weight_error_squares += (double)weight_error * weight_error;
+        flow_error_sum += flow_error;
+        flow_error_squares += (double)flow_error * flow_error;
+        if (reference_flow > FLOWING_MIN_GPS) {
+            lag_ms_sum += -weight_error / reference_flow * 1000.0;
+            lag_count++;
+        }
+    }
+};
+
+struct MethodStats {
+    ErrorStats flowing;
+    ErrorStats idle;
+    ErrorStats stop;
+};
+
+struct Reference {
+    float weight;
+    float flow;
+};
+
+// Reference segment of every sample, see the header comment
+std::vector<uint32_t> reference_segments(const std::vector<RecoveredSample>& samples, uint32_t sps) {
+    std::vector<uint32_t> segments(samples.size(), 0);
+    if (samples.size() < 3) return segments;
+
+    // Robust spread of the second differences: 1.4826 * median absolute value
+    std::vector<float> second_differences;
+    for (size_t i = 2; i < samples.size(); i++) {
+        second_differences.push_back(fabsf(samples[i].weight - 2.0f * samples[i - 1].weight + samples[i - 2].weight));
+    }
+    std::nth_element(second_differences.begin(), second_differences.begin() + second_differences.size() / 2,
+                     second_differences.end());
+    float spread = std::max(1.4826f * second_differences[second_differences.size() / 2], REFERENCE_MIN_SPREAD_G);
+    float max_gap_ms = REFERENCE_MAX_GAP_INTERVALS * 1000.0f / sps;
+
+    uint32_t segment = 0;
+    for (size_t i = 1; i < samples.size(); i++) {
+        bool phase_change = samples[i].phase_id != samples[i - 1].phase_id;
+        bool gap = samples[i].timestamp_ms - samples[i - 1].timestamp_ms > max_gap_ms;
+        bool jump = i >= 2 && segments[i - 1] == segments[i - 2] &&
+                    fabsf(samples[i].weight - 2.0f * samples[i - 1].weight + samples[i - 2].weight) >
+                        REFERENCE_JUMP_SIGMA * spread;
+        if (phase_change || gap || jump) segment++;
+        segments[i] = segment;
+    }
+    return segments;
+}
+
+// Least squares line through the samples within the half window of samples[index] and its
+// reference segment, evaluated at samples[index]. trailing_only: fit the full window before it
+// instead (see the stop bucket).
+bool reference_at(const std::vector<RecoveredSample>& samples, const std::vector<uint32_t>& segments,
+                  size_t index, bool trailing_only, Reference* reference) {
+    uint32_t center = samples[index].timestamp_ms;
+    uint32_t before_ms = trailing_only ? 2 * REFERENCE_HALF_WINDOW_MS : REFERENCE_HALF_WINDOW_MS;
+    uint32_t after_ms = trailing_only ? 0 : REFERENCE_HALF_WINDOW_MS;
+    size_t first = index;
+    while (first > 0 && segments[first - 1] == segments[index] &&
+           center - samples[first - 1].timestamp_ms <= before_ms) first--;
+    size_t last = index;
+    while (last + 1 < samples.size() && segments[last + 1] == segments[index] &&
+           samples[last + 1].timestamp_ms - center <= after_ms) last++;
+    if (index - first < 2 || (!trailing_only && last - index < 2)) return false;
+
+    double n = 0.0, sum_t = 0.0, sum_w = 0.0, sum_tt = 0.0, sum_tw = 0.0;
+    for (size_t i = first; i <= last; i++) {
+        double t = ((int32_t)(samples[i].timestamp_ms - center)) / 1000.0;
+        double w = samples[i].weight;
+        n += 1.0;
+        sum_t += t;
+        sum_w += w;
+        sum_tt += t * t;
+        sum_tw += t * w;
+    }
+    double denominator = n * sum_tt - sum_t * sum_t;
+    if (denominator <= 0.0) return false;
+    double slope = (n * sum_tw - sum_t * sum_w) / denominator;
+    reference->flow = (float)slope;
+    reference->weight = (float)((sum_w - slope * sum_t) / n);
+    return true;
+}
+
+void bench_session(const std::vector<GrindMeasurement>& measurements, const BenchConfig& config,
+                   MethodStats& filter_stats, MethodStats& kalman_stats) {
+    std::vector<RecoveredSample> samples = recover_load_cell_samples(measurements, config.sps);
+    if (samples.empty()) return;
+    std::vector<uint32_t> segments = reference_segments(samples, config.sps);
+
+    // The filter windows are measured against millis() - run the clock with the samples
+    std::unique_ptr<CircularBufferMath> filter(new CircularBufferMath());
+    WeightFlowEstimator estimator;
+    estimator.configure(config.estimator);
+    const float counts_per_gram = 1000.0f;
+
+    uint32_t motor_stopped_ms = 0;
+    for (size_t i = 0; i < samples.size(); i++) {
+        const RecoveredSample& sample = samples[i];
+        native_clock::set_ms(sample.timestamp_ms + 1000);
+        filter->add_sample((int32_t)lroundf(sample.weight * counts_per_gram), sample.timestamp_ms + 1000);
+        float filter_weight = filter->get_raw_low_latency() / counts_per_gram;
+        float filter_flow = filter->get_raw_flow_rate(200) / counts_per_gram;
+
+        bool motor_on = sample.motor_is_on != 0;
+        if (!motor_on && i > 0 && samples[i - 1].motor_is_on) motor_stopped_ms = sample.timestamp_ms;
+        estimator.set_motor_running(motor_on, sample.timestamp_ms);
+        estimator.add_sample(sample.weight, sample.timestamp_ms);
+        const WeightFlowEstimator::Estimate& estimate = estimator.estimate();
+
+        bool coasting = motor_on || (motor_stopped_ms != 0 &&
+                                     sample.timestamp_ms - motor_stopped_ms < config.estimator.coast_window_ms);
+        bool stop = motor_on && (GrindPhase)sample.phase_id == GrindPhase::PREDICTIVE &&
+                    i + 1 < samples.size() && !samples[i + 1].motor_is_on;
+
+        Reference reference;
+        if (!reference_at(samples, segments, i, stop, &reference)) continue;
+
+        ErrorStats* filter_bucket = nullptr;
+        ErrorStats* kalman_bucket = nullptr;
+        if (stop) {
+            filter_bucket = &filter_stats.stop;
+            kalman_bucket = &kalman_stats.stop;
+        } else if (coasting && reference.flow > FLOWING_MIN_GPS) {
+            filter_bucket = &filter_stats.flowing;
+            kalman_bucket = &kalman_stats.flowing;
+        } else if (!coasting) {
+            filter_bucket = &filter_stats.idle;
+            kalman_bucket = &kalman_stats.idle;
+        }
+        if (!filter_bucket) continue;
+        filter_bucket->add(filter_weight - reference.weight, filter_flow - reference.flow, reference.flow);
+        kalman_bucket->add(estimate.weight - reference.weight, estimate.flow_rate - reference.flow, reference.flow);
+    }
+}
+
+void print_stats(const char* label, const ErrorStats& stats) {
+    if (stats.count == 0) {
+        printf("    %-8s no samples\n", label);
+        return;
+    }
+    double weight_bias = stats.weight_error_sum / stats.count;
+    double flow_bias = stats.flow_error_sum / stats.count;
+    printf("    %-8s weight rmse %.4f bias %+.4f g | flow rmse %.3f bias %+.3f g/s", label,
+           sqrt(stats.weight_error_squares / stats.count), weight_bias,
+           sqrt(stats.flow_error_squares / stats.count), flow_bias);
+    if (stats.lag_count > 0) {
+        printf(" | lag %.0f ms", stats.lag_ms_sum / stats.lag_count);
+    }
+    printf("\n");
+}
+
+void print_method(const char* label, const MethodStats& stats) {
+    printf("  %s\n", label);
+    print_stats("flowing", stats.flowing);
+    print_stats("stop", stats.stop);
+    print_stats("idle", stats.idle);
+}
+
+void print_help(const WeightFlowEstimator::Config& defaults) {
+    printf("Usage: bench-estimator DIR [options]\n"
+           "  Reads session_*.bin from DIR or DIR/sessions (e.g. written by sim --save-sessions DIR)\n"
+           "  --idle-noise G     sample noise sd with the motor stopped (default %.4f)\n"
+           "  --motor-noise G    sample noise sd with the motor running (default %.4f)\n"
+           "  --flowing-q Q      flow random walk while grounds can arrive (default %.2f)\n"
+           "  --idle-q Q         flow random walk once they cannot (default %.4f)\n"
+           "  --coast-ms N       grounds can land up to N ms after the motor stops (default %lu)\n"
+           "  --reset-sigma S    innovation that restarts the filter (default %.1f)\n"
+           "  --sps N            load cell sample rate of the recording (default %d)\n",
+           defaults.idle_noise, defaults.motor_noise, defaults.flowing_q, defaults.idle_q,
+           (unsigned long)defaults.coast_window_ms, defaults.reset_sigma, HW_LOADCELL_SAMPLE_RATE_SPS);
+}
+
+bool parse_args(int argc, char** argv, BenchConfig& config) {
+    if (argc < 1 || strcmp(argv[0], "--help") == 0) {
+        return false;
+    }
+    config.dir = argv[0];
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--help") == 0 || i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--idle-noise") == 0) config.estimator.idle_noise = strtof(value, nullptr);
+        else if (strcmp(arg, "--motor-noise") == 0) config.estimator.motor_noise = strtof(value, nullptr);
+        else if (strcmp(arg, "--flowing-q") == 0) config.estimator.flowing_q = strtof(value, nullptr);
+        else if (strcmp(arg, "--idle-q") == 0) config.estimator.idle_q = strtof(value, nullptr);
+        else if (strcmp(arg, "--coast-ms") == 0) config.estimator.coast_window_ms = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--reset-sigma") == 0) config.estimator.reset_sigma = strtof(value, nullptr);
+        else if (strcmp(arg, "--sps") == 0) config.sps = std::max(1UL, strtoul(value, nullptr, 10));
+        else return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int run_weight_estimator_bench(int argc, char** argv) {
+    BenchConfig config;
+    config.estimator.idle_noise = GRIND_ESTIMATOR_IDLE_NOISE_G;
+    config.estimator.motor_noise = GRIND_ESTIMATOR_MOTOR_NOISE_G;
+    config.estimator.flowing_q = GRIND_ESTIMATOR_FLOWING_Q;
+    config.estimator.idle_q = GRIND_ESTIMATOR_IDLE_Q;
+    config.estimator.coast_window_ms = GRIND_ESTIMATOR_COAST_WINDOW_MS;
+    config.estimator.idle_flow_decay_ms = GRIND_ESTIMATOR_IDLE_FLOW_DECAY_MS;
+    config.estimator.reset_sigma = GRIND_ESTIMATOR_RESET_SIGMA;
+    WeightFlowEstimator::Config defaults = config.estimator;
+    if (!parse_args(argc, argv, config)) {
+        print_help(defaults);
+        return argc < 1 ? 1 : 0;
+    }
+
+    std::string dir = config.dir;
+    std::vector<std::string> paths;
+    collect_session_files(dir, paths);
+    collect_session_files(dir + "/sessions", paths);
+    if (paths.empty()) {
+        printf("No session_*.bin files in %s\n", dir.c_str());
+        return 1;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    MethodStats filter_stats;
+    MethodStats kalman_stats;
+    uint32_t failed = 0;
+    for (const std::string& path : paths) {
+        std::vector<GrindEvent> events;
+        std::vector<GrindMeasurement> measurements;
+        if (!load_session_file(path, events, measurements)) {
+            printf("  FAILED %s\n", path.c_str());
+            failed++;
+            continue;
+        }
+        bench_session(measurements, config, filter_stats, kalman_stats);
+    }
+
+    printf("Weight/flow estimator benchmark: %lu sessions (%lu failed), reference = centred fit over +-%lums within segments\n",
+           (unsigned long)paths.size(), (unsigned long)failed, (unsigned long)REFERENCE_HALF_WINDOW_MS);
+    print_method("filters (100ms weight, 200ms flow)", filter_stats);
+    print_method("kalman", kalman_stats);
+    return failed == 0 ? 0 : 1;
+}
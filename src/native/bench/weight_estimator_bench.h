@@ -0,0 +1,6 @@
+#pragma once
+
+// Control weight and flow rate of WeightFlowEstimator against the CircularBufferMath filters
+// (100ms window weight, 200ms two-point flow) on the load cell samples recovered from session
+// files, scored against a centred (non-causal) fit. Options are listed by `bench-estimator --help`.
+int run_weight_estimator_bench(int argc, char** argv);
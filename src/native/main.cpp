@@ -0,0 +1,78 @@
+#include <Arduino.h>
+#include "bench/bulk_transfer_bench.h"
+#include "bench/circular_buffer_math_bench.h"
+#include "bench/crc32_bench.h"
+#include "bench/flow_percentile_report.h"
+#include "bench/ota_apply_bench.h"
+#include "bench/ota_resume_bench.h"
+#include "bench/session_codec_report.h"
+#include "bench/session_replay.h"
+#include "bench/settling_replay.h"
+#include "bench/weight_estimator_bench.h"
+#include "sim/autotune_simulator.h"
+#include "sim/grind_simulator.h"
+
+/*
+ * Host tool entry point for the `native` PlatformIO environment.
+ *
+ * Usage: program <command> [args...]
+ *   bench-stats [duration_ms]   CircularBufferMath scan vs incremental per-tick cost
+ *   p95-report [options]        Sweep vs scan 95th percentile flow rate accuracy and cost
+ *   sim [options]               Closed-loop grind simulation against the mock plant model
+ *   autotune-sim [options]      Binary vs Bayesian motor latency auto-tune against the mock plant
+ *   session-report DIR          Schema v3 session file size and round-trip error
+ *   session-verify DIR          Session file integrity (size, CRC-32, decode)
+ *   settle-replay DIR [options] Sequential settling detector vs the logged fixed-window waits
+ *   replay DIR [options]        Replay logged sessions through the control stack, diff decisions
+ *   bench-estimator DIR [opts]  Kalman weight/flow estimator vs the control filters on sessions
+ *   bench-crc [megabytes]       CRC-32 kernel throughput and known-answer checks
+ *   bench-bulk [options]        Windowed BLE bulk transfer vs legacy export over a lossy link
+ *   ota-apply [options]         Streaming vs staged OTA patch apply between two images
+ *   bench-ota-resume [options]  Resumable OTA upload vs restart over a link with disconnects
+ */
+
+struct NativeCommand {
+    const char* name;
+    int (*run)(int argc, char** argv);
+    const char* help;
+};
+
+static const NativeCommand NATIVE_COMMANDS[] = {
+    {"bench-stats", run_circular_buffer_bench, "[duration_ms]  CircularBufferMath per-tick cost at 10/80 SPS"},
+    {"p95-report", run_flow_percentile_report, "[options]  sweep vs scan 95th percentile flow rate (p95-report --help)"},
+    {"sim", run_grind_simulator, "[options]  closed-loop grind simulation (sim --help)"},
+    {"autotune-sim", run_autotune_simulator, "[options]  binary vs Bayesian latency auto-tune (autotune-sim --help)"},
+    {"session-report", run_session_codec_report, "DIR  session file compression and round-trip error"},
+    {"session-verify", run_session_verify, "DIR  session file integrity: size, CRC-32, decode"},
+    {"settle-replay", run_settling_replay, "DIR [options]  settling detector time saved per pulse (settle-replay --help)"},
+    {"replay", run_session_replay, "DIR [options]  replay sessions through the control code and diff decisions (replay --help)"},
+    {"bench-estimator", run_weight_estimator_bench, "DIR [options]  Kalman weight/flow vs control filters (bench-estimator --help)"},
+    {"bench-crc", run_crc32_bench, "[megabytes]  CRC-32 kernel throughput vs bitwise/bytewise"},
+    {"bench-bulk", run_bulk_transfer_bench, "[options]  windowed BLE transfer vs legacy export (bench-bulk --help)"},
+    {"ota-apply", run_ota_apply_bench, "[--chunk N] FROM|- PATCH [EXPECTED]  streaming vs staged OTA patch apply"},
+    {"bench-ota-resume", run_ota_resume_bench, "[options]  resumable OTA upload vs restart from 0 (bench-ota-resume --help)"},
+};
+
+static void print_usage(const char* program) {
+    printf("Usage: %s <command> [args...]\n", program);
+    for (const NativeCommand& command : NATIVE_COMMANDS) {
+        printf("  %-14s %s\n", command.name, command.help);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    for (const NativeCommand& command : NATIVE_COMMANDS) {
+        if (strcmp(argv[1], command.name) == 0) {
+            return command.run(argc - 2, argv + 2);
+        }
+    }
+
+    printf("Unknown command: %s\n", argv[1]);
+    print_usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,14 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "../system/diagnostics_controller.h"
+
+// Storage for shim globals shared by every host tool
+uint64_t native_clock::now_us = 0;
+NativeSerial Serial;
+fs::LittleFSFS LittleFS;
+
+// DiagnosticsController pulls in the display stack, so host builds link this
+// no-op instead; GrindController only calls it when a controller is attached.
+void DiagnosticsController::reset_diagnostic(DiagnosticCode code) {
+    (void)code;
+}
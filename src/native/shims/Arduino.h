@@ -0,0 +1,74 @@
+#pragma once
+
+//==============================================================================
+// NATIVE (HOST) ARDUINO SHIM
+//==============================================================================
+// Minimal stand-in for the Arduino core so firmware modules can be compiled
+// and exercised on a Linux host. Time is virtual: millis()/micros() return a
+// clock that host tools advance explicitly, which keeps runs deterministic and
+// lets them execute faster than real time.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cstdarg>
+#include <algorithm>
+#include <alloca.h>
+#include "WString.h"
+
+using std::min;
+using std::max;
+using std::abs;
+
+template <typename T, typename L, typename H>
+inline T constrain(T value, L low, H high) {
+    return value < low ? (T)low : (value > high ? (T)high : value);
+}
+
+// Virtual clock - advanced by host tools, never by the shim itself
+namespace native_clock {
+    extern uint64_t now_us;
+
+    inline void set_ms(uint32_t ms) { now_us = (uint64_t)ms * 1000ULL; }
+    inline void advance_ms(uint32_t ms) { now_us += (uint64_t)ms * 1000ULL; }
+    inline void advance_us(uint32_t us) { now_us += us; }
+}
+
+inline unsigned long millis() { return (unsigned long)(uint32_t)(native_clock::now_us / 1000ULL); }
+inline unsigned long micros() { return (unsigned long)(uint32_t)native_clock::now_us; }
+inline void delay(uint32_t ms) { native_clock::advance_ms(ms); }
+inline void delayMicroseconds(uint32_t us) { native_clock::advance_us(us); }
+
+// GPIO - no pins on the host; reads return LOW
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+inline void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+inline void digitalWrite(uint8_t pin, uint8_t value) { (void)pin; (void)value; }
+inline int digitalRead(uint8_t pin) { (void)pin; return LOW; }
+
+// Serial output - quiet by default so simulations are not dominated by logging
+class NativeSerial {
+public:
+    bool enabled = false;
+
+    int printf(const char* format, ...) {
+        if (!enabled) return 0;
+        va_list args;
+        va_start(args, format);
+        int written = vprintf(format, args);
+        va_end(args);
+        return written;
+    }
+    void print(const char* str) { if (enabled) fputs(str, stdout); }
+    void println(const char* str = "") { if (enabled) { fputs(str, stdout); fputc('\n', stdout); } }
+    void begin(unsigned long) {}
+    void flush() { fflush(stdout); }
+};
+
+extern NativeSerial Serial;
@@ -0,0 +1,215 @@
+#pragma once
+
+//==============================================================================
+// NATIVE (HOST) FILESYSTEM SHIM
+//==============================================================================
+// Subset of the Arduino-ESP32 fs::FS / fs::File API backed by a directory on
+// the host. Firmware paths ("/sessions/session_1.bin") are resolved below the
+// host root, so session files written by a simulation can be inspected and fed
+// to the same host tools that parse BLE exports.
+
+#include <Arduino.h>
+#include <algorithm>
+#include <cstdarg>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+namespace fs {
+
+class File {
+public:
+    File() {}
+
+    static File open_host(const std::string& host_path, const std::string& virtual_path, const char* mode) {
+        File file;
+        struct stat info;
+        bool exists = (stat(host_path.c_str(), &info) == 0);
+
+        if (exists && S_ISDIR(info.st_mode)) {
+            DIR* dir = opendir(host_path.c_str());
+            if (!dir) return file;
+            file.state_ = std::make_shared<State>();
+            file.state_->is_directory = true;
+            while (struct dirent* entry = readdir(dir)) {
+                if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+                file.state_->entries.push_back(entry->d_name);
+            }
+            closedir(dir);
+        } else {
+            std::string host_mode = mode ? mode : "r";
+            if (host_mode.find('b') == std::string::npos) host_mode += "b";
+            FILE* handle = fopen(host_path.c_str(), host_mode.c_str());
+            if (!handle) return file;
+            file.state_ = std::make_shared<State>();
+            file.state_->handle = handle;
+        }
+
+        file.state_->host_path = host_path;
+        file.state_->virtual_path = virtual_path;
+        return file;
+    }
+
+    explicit operator bool() const { return state_ && (state_->handle || state_->is_directory); }
+
+    size_t write(const uint8_t* buffer, size_t size) {
+        if (!state_ || !state_->handle) return 0;
+        return fwrite(buffer, 1, size, state_->handle);
+    }
+    size_t write(uint8_t value) { return write(&value, 1); }
+
+    size_t print(const char* text) { return write(reinterpret_cast<const uint8_t*>(text), strlen(text)); }
+    size_t println(const char* text = "") { return print(text) + print("\n"); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        if (length < 0) return 0;
+        return write(reinterpret_cast<const uint8_t*>(buffer), std::min((size_t)length, sizeof(buffer) - 1));
+    }
+
+    size_t read(uint8_t* buffer, size_t size) {
+        if (!state_ || !state_->handle) return 0;
+        return fread(buffer, 1, size, state_->handle);
+    }
+    int read() {
+        uint8_t value;
+        return read(&value, 1) == 1 ? value : -1;
+    }
+
+    int available() {
+        if (!state_ || !state_->handle) return 0;
+        return (int)(size() - position());
+    }
+
+    bool seek(uint32_t pos, SeekMode mode = SeekSet) {
+        if (!state_ || !state_->handle) return false;
+        int whence = (mode == SeekCur) ? SEEK_CUR : (mode == SeekEnd) ? SEEK_END : SEEK_SET;
+        return fseek(state_->handle, (long)pos, whence) == 0;
+    }
+
+    size_t position() const {
+        if (!state_ || !state_->handle) return 0;
+        long pos = ftell(state_->handle);
+        return pos < 0 ? 0 : (size_t)pos;
+    }
+
+    size_t size() const {
+        if (!state_ || !state_->handle) return 0;
+        fflush(state_->handle);
+        struct stat info;
+        return (stat(state_->host_path.c_str(), &info) == 0) ? (size_t)info.st_size : 0;
+    }
+
+    void flush() {
+        if (state_ && state_->handle) fflush(state_->handle);
+    }
+
+    void close() {
+        if (state_ && state_->handle) {
+            fclose(state_->handle);
+            state_->handle = nullptr;
+        }
+        state_.reset();
+    }
+
+    const char* path() const { return state_ ? state_->virtual_path.c_str() : ""; }
+
+    const char* name() const {
+        if (!state_) return "";
+        const char* slash = strrchr(state_->virtual_path.c_str(), '/');
+        return slash ? slash + 1 : state_->virtual_path.c_str();
+    }
+
+    bool isDirectory() const { return state_ && state_->is_directory; }
+
+    File openNextFile(const char* mode = "r") {
+        if (!state_ || !state_->is_directory || state_->next_entry >= state_->entries.size()) {
+            return File();
+        }
+        const std::string& entry = state_->entries[state_->next_entry++];
+        std::string separator = (!state_->virtual_path.empty() && state_->virtual_path.back() == '/') ? "" : "/";
+        return open_host(state_->host_path + "/" + entry, state_->virtual_path + separator + entry, mode);
+    }
+
+    void rewindDirectory() {
+        if (state_) state_->next_entry = 0;
+    }
+
+private:
+    struct State {
+        FILE* handle = nullptr;
+        bool is_directory = false;
+        std::string host_path;
+        std::string virtual_path;
+        std::vector<std::string> entries;
+        size_t next_entry = 0;
+
+        ~State() {
+            if (handle) fclose(handle);
+        }
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+class FS {
+public:
+    explicit FS(const char* host_root) : host_root_(host_root) {}
+
+    // Directory on the host that stands in for the flash partition root
+    void set_host_root(const char* host_root) { host_root_ = host_root ? host_root : "."; }
+    const char* get_host_root() const { return host_root_.c_str(); }
+
+    File open(const char* path, const char* mode = "r", bool create = false) {
+        (void)create;
+        return File::open_host(host_path(path), path ? path : "/", mode);
+    }
+    File open(const String& path, const char* mode = "r", bool create = false) {
+        return open(path.c_str(), mode, create);
+    }
+
+    bool exists(const char* path) {
+        struct stat info;
+        return stat(host_path(path).c_str(), &info) == 0;
+    }
+    bool exists(const String& path) { return exists(path.c_str()); }
+
+    bool remove(const char* path) { return ::unlink(host_path(path).c_str()) == 0; }
+    bool remove(const String& path) { return remove(path.c_str()); }
+
+    bool rename(const char* from, const char* to) {
+        return ::rename(host_path(from).c_str(), host_path(to).c_str()) == 0;
+    }
+
+    bool mkdir(const char* path) { return ::mkdir(host_path(path).c_str(), 0755) == 0; }
+    bool mkdir(const String& path) { return mkdir(path.c_str()); }
+
+    bool rmdir(const char* path) { return ::rmdir(host_path(path).c_str()) == 0; }
+
+protected:
+    std::string host_path(const char* path) const {
+        std::string relative = path ? path : "";
+        if (!relative.empty() && relative[0] == '/') relative.erase(0, 1);
+        return relative.empty() ? host_root_ : host_root_ + "/" + relative;
+    }
+
+    std::string host_root_;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
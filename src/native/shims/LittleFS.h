@@ -0,0 +1,40 @@
+#pragma once
+
+//==============================================================================
+// NATIVE (HOST) LITTLEFS SHIM
+//==============================================================================
+// LittleFS mounted on a host directory (default ".pio/native_littlefs").
+// begin() creates the directory; host tools may point it elsewhere with
+// LittleFS.set_host_root() before the firmware code mounts it.
+
+#include "FS.h"
+
+namespace fs {
+
+class LittleFSFS : public FS {
+public:
+    LittleFSFS() : FS(".pio/native_littlefs") {}
+
+    bool begin(bool format_on_fail = false, const char* base_path = "/littlefs",
+               uint8_t max_open_files = 10, const char* partition_label = "spiffs") {
+        (void)format_on_fail;
+        (void)base_path;
+        (void)max_open_files;
+        (void)partition_label;
+        std::string partial;
+        for (size_t i = 0; i <= host_root_.size(); i++) {
+            if (i == host_root_.size() || host_root_[i] == '/') {
+                if (!partial.empty()) ::mkdir(partial.c_str(), 0755);
+            }
+            if (i < host_root_.size()) partial += host_root_[i];
+        }
+        struct stat info;
+        return stat(host_root_.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    }
+
+    void end() {}
+};
+
+} // namespace fs
+
+extern fs::LittleFSFS LittleFS;
@@ -0,0 +1,117 @@
+#pragma once
+
+//==============================================================================
+// NATIVE (HOST) PREFERENCES SHIM
+//==============================================================================
+// In-memory replacement for the ESP32 NVS Preferences library. Every
+// Preferences object opened on the same namespace sees the same key/value
+// store for the lifetime of the process, matching how firmware modules share
+// NVS namespaces. Values are stored as raw bytes; typed getters return the
+// default when the key is missing or was stored with a different size.
+// native_preferences::clear_all() wipes every namespace between simulation runs.
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace native_preferences {
+    typedef std::map<std::string, std::vector<uint8_t>> Namespace;
+
+    inline std::map<std::string, Namespace>& store() {
+        static std::map<std::string, Namespace> namespaces;
+        return namespaces;
+    }
+
+    inline void clear_all() { store().clear(); }
+}
+
+class Preferences {
+public:
+    bool begin(const char* name, bool read_only = false, const char* partition_label = nullptr) {
+        (void)partition_label;
+        namespace_ = &native_preferences::store()[name ? name : ""];
+        read_only_ = read_only;
+        return true;
+    }
+
+    void end() { namespace_ = nullptr; }
+
+    bool clear() {
+        if (!writable()) return false;
+        namespace_->clear();
+        return true;
+    }
+
+    bool remove(const char* key) {
+        if (!writable()) return false;
+        return namespace_->erase(key) > 0;
+    }
+
+    bool isKey(const char* key) { return find(key) != nullptr; }
+
+    size_t putBool(const char* key, bool value) { uint8_t v = value ? 1 : 0; return put(key, &v, sizeof(v)); }
+    size_t putUChar(const char* key, uint8_t value) { return put(key, &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return put(key, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return put(key, &value, sizeof(value)); }
+    size_t putLong(const char* key, int32_t value) { return put(key, &value, sizeof(value)); }
+    size_t putULong(const char* key, uint32_t value) { return put(key, &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return put(key, &value, sizeof(value)); }
+    size_t putBytes(const char* key, const void* value, size_t length) { return put(key, value, length); }
+    size_t putString(const char* key, const char* value) {
+        return value ? put(key, value, strlen(value) + 1) : 0;
+    }
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+
+    bool getBool(const char* key, bool default_value = false) { uint8_t v = default_value ? 1 : 0; get(key, &v, sizeof(v)); return v != 0; }
+    uint8_t getUChar(const char* key, uint8_t default_value = 0) { get(key, &default_value, sizeof(default_value)); return default_value; }
+    int32_t getInt(const char* key, int32_t default_value = 0) { get(key, &default_value, sizeof(default_value)); return default_value; }
+    uint32_t getUInt(const char* key, uint32_t default_value = 0) { get(key, &default_value, sizeof(default_value)); return default_value; }
+    int32_t getLong(const char* key, int32_t default_value = 0) { get(key, &default_value, sizeof(default_value)); return default_value; }
+    uint32_t getULong(const char* key, uint32_t default_value = 0) { get(key, &default_value, sizeof(default_value)); return default_value; }
+    float getFloat(const char* key, float default_value = NAN) { get(key, &default_value, sizeof(default_value)); return default_value; }
+
+    size_t getBytesLength(const char* key) {
+        const std::vector<uint8_t>* value = find(key);
+        return value ? value->size() : 0;
+    }
+
+    size_t getBytes(const char* key, void* buffer, size_t max_length) {
+        const std::vector<uint8_t>* value = find(key);
+        if (!value || value->size() > max_length) return 0;
+        memcpy(buffer, value->data(), value->size());
+        return value->size();
+    }
+
+    String getString(const char* key, const String default_value = String()) {
+        const std::vector<uint8_t>* value = find(key);
+        if (!value || value->empty()) return default_value;
+        return String(reinterpret_cast<const char*>(value->data()));
+    }
+
+private:
+    bool writable() const { return namespace_ && !read_only_; }
+
+    const std::vector<uint8_t>* find(const char* key) const {
+        if (!namespace_ || !key) return nullptr;
+        auto it = namespace_->find(key);
+        return it == namespace_->end() ? nullptr : &it->second;
+    }
+
+    size_t put(const char* key, const void* value, size_t length) {
+        if (!writable() || !key) return 0;
+        const uint8_t* bytes = static_cast<const uint8_t*>(value);
+        (*namespace_)[key].assign(bytes, bytes + length);
+        return length;
+    }
+
+    void get(const char* key, void* value, size_t length) const {
+        const std::vector<uint8_t>* stored = find(key);
+        if (stored && stored->size() == length) {
+            memcpy(value, stored->data(), length);
+        }
+    }
+
+    native_preferences::Namespace* namespace_ = nullptr;
+    bool read_only_ = false;
+};
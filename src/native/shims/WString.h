@@ -0,0 +1,71 @@
+#pragma once
+
+//==============================================================================
+// NATIVE (HOST) ARDUINO STRING SHIM
+//==============================================================================
+// std::string backed subset of the Arduino String class - only the members the
+// firmware sources actually use (path building and session file name parsing).
+
+#include <string>
+#include <cstdlib>
+
+class String {
+public:
+    String() {}
+    String(const char* str) : value_(str ? str : "") {}
+    String(const std::string& str) : value_(str) {}
+    String(char c) : value_(1, c) {}
+    String(int number) : value_(std::to_string(number)) {}
+    String(unsigned int number) : value_(std::to_string(number)) {}
+    String(long number) : value_(std::to_string(number)) {}
+    String(unsigned long number) : value_(std::to_string(number)) {}
+
+    const char* c_str() const { return value_.c_str(); }
+    unsigned int length() const { return (unsigned int)value_.length(); }
+    bool isEmpty() const { return value_.empty(); }
+
+    bool startsWith(const String& prefix) const {
+        return value_.compare(0, prefix.value_.length(), prefix.value_) == 0;
+    }
+    bool endsWith(const String& suffix) const {
+        return value_.length() >= suffix.value_.length() &&
+               value_.compare(value_.length() - suffix.value_.length(), suffix.value_.length(), suffix.value_) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return to_index(value_.find(c, from)); }
+    int indexOf(const String& str, unsigned int from = 0) const { return to_index(value_.find(str.value_, from)); }
+    int lastIndexOf(char c) const { return to_index(value_.rfind(c)); }
+    int lastIndexOf(const String& str) const { return to_index(value_.rfind(str.value_)); }
+
+    String substring(unsigned int begin) const {
+        return begin >= value_.length() ? String() : String(value_.substr(begin));
+    }
+    String substring(unsigned int begin, unsigned int end) const {
+        if (end < begin) std::swap(begin, end);
+        if (begin >= value_.length()) return String();
+        return String(value_.substr(begin, end - begin));
+    }
+
+    long toInt() const { return strtol(value_.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(value_.c_str(), nullptr); }
+
+    String& operator+=(const String& rhs) { value_ += rhs.value_; return *this; }
+    String& operator+=(const char* rhs) { value_ += rhs ? rhs : ""; return *this; }
+    String& operator+=(char rhs) { value_ += rhs; return *this; }
+    bool concat(const String& rhs) { value_ += rhs.value_; return true; }
+
+    bool operator==(const String& rhs) const { return value_ == rhs.value_; }
+    bool operator!=(const String& rhs) const { return value_ != rhs.value_; }
+    bool operator<(const String& rhs) const { return value_ < rhs.value_; }
+
+    friend String operator+(const String& lhs, const String& rhs) { return String(lhs.value_ + rhs.value_); }
+    friend String operator+(const String& lhs, const char* rhs) { return String(lhs.value_ + (rhs ? rhs : "")); }
+    friend String operator+(const char* lhs, const String& rhs) { return String((lhs ? lhs : "") + rhs.value_); }
+
+private:
+    static int to_index(std::string::size_type pos) {
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+
+    std::string value_;
+};
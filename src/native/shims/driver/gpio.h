@@ -0,0 +1,9 @@
+#pragma once
+
+//==============================================================================
+// NATIVE (HOST) GPIO DRIVER SHIM
+//==============================================================================
+
+#include "../esp_err.h"
+
+typedef int gpio_num_t;
@@ -0,0 +1,38 @@
+#pragma once
+
+//==============================================================================
+// NATIVE (HOST) RMT ENCODER SHIM
+//==============================================================================
+// Type-only stand-in: host builds drive the grinder through the mock path, so
+// the RMT calls compile but never produce a waveform.
+
+#include "../esp_err.h"
+#include <cstdint>
+#include <cstddef>
+
+typedef struct native_rmt_encoder* rmt_encoder_handle_t;
+
+typedef union {
+    struct {
+        uint16_t duration0 : 15;
+        uint16_t level0 : 1;
+        uint16_t duration1 : 15;
+        uint16_t level1 : 1;
+    };
+    uint32_t val;
+} rmt_symbol_word_t;
+
+typedef struct {
+    uint32_t reserved;
+} rmt_copy_encoder_config_t;
+
+inline esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t* config, rmt_encoder_handle_t* ret_encoder) {
+    (void)config;
+    *ret_encoder = nullptr;
+    return ESP_FAIL;
+}
+
+inline esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder) {
+    (void)encoder;
+    return ESP_OK;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+//==============================================================================
+// NATIVE (HOST) SPI MASTER SHIM
+//==============================================================================
+// Types only - the HX711 SPI read path is firmware-only, but its header is
+// included by WeightSensor.
+
+typedef struct spi_device_t* spi_device_handle_t;
@@ -0,0 +1,13 @@
+#pragma once
+
+//==============================================================================
+// NATIVE (HOST) ESP-IDF LOG SHIM
+//==============================================================================
+// ESP-IDF component logging is silenced on the host; firmware diagnostics go
+// through LOG_BLE and the Serial shim instead.
+
+#define ESP_LOGE(tag, format, ...) ((void)(tag))
+#define ESP_LOGW(tag, format, ...) ((void)(tag))
+#define ESP_LOGI(tag, format, ...) ((void)(tag))
+#define ESP_LOGD(tag, format, ...) ((void)(tag))
+#define ESP_LOGV(tag, format, ...) ((void)(tag))
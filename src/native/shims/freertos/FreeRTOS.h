@@ -0,0 +1,24 @@
+#pragma once
+
+//==============================================================================
+// NATIVE (HOST) FREERTOS SHIM
+//==============================================================================
+// Host tools run the firmware single-threaded against the virtual clock in
+// Arduino.h, so the kernel reduces to a 1 ms tick and the types the firmware
+// headers mention. Queues, tasks and semaphores live in their own headers as
+// on the real kernel.
+
+#include <Arduino.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define configTICK_RATE_HZ 1000
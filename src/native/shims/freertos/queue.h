@@ -0,0 +1,71 @@
+#pragma once
+
+//==============================================================================
+// NATIVE (HOST) FREERTOS QUEUE SHIM
+//==============================================================================
+// Fixed-capacity copy-in/copy-out FIFO with the FreeRTOS queue semantics the
+// firmware relies on: items are copied by value and a full queue rejects sends.
+// Host tools are single-threaded, so ticks_to_wait is ignored - a send to a
+// full queue or a receive from an empty one fails immediately.
+
+#include "FreeRTOS.h"
+#include <vector>
+
+struct NativeQueue {
+    std::vector<uint8_t> storage;
+    UBaseType_t item_size;
+    UBaseType_t capacity;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+typedef NativeQueue* QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    if (length == 0 || item_size == 0) return nullptr;
+    NativeQueue* queue = new NativeQueue();
+    queue->storage.resize((size_t)length * item_size);
+    queue->item_size = item_size;
+    queue->capacity = length;
+    queue->head = 0;
+    queue->count = 0;
+    return queue;
+}
+
+inline void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    (void)ticks_to_wait;
+    if (!queue || queue->count >= queue->capacity) return pdFAIL;
+    UBaseType_t slot = (queue->head + queue->count) % queue->capacity;
+    memcpy(&queue->storage[(size_t)slot * queue->item_size], item, queue->item_size);
+    queue->count++;
+    return pdPASS;
+}
+
+inline BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    return xQueueSend(queue, item, ticks_to_wait);
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait) {
+    (void)ticks_to_wait;
+    if (!queue || queue->count == 0) return pdFAIL;
+    memcpy(item, &queue->storage[(size_t)queue->head * queue->item_size], queue->item_size);
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+    return pdPASS;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return queue ? queue->count : 0;
+}
+
+inline BaseType_t xQueueReset(QueueHandle_t queue) {
+    if (queue) {
+        queue->head = 0;
+        queue->count = 0;
+    }
+    return pdPASS;
+}
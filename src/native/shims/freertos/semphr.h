@@ -0,0 +1,37 @@
+#pragma once
+
+//==============================================================================
+// NATIVE (HOST) FREERTOS SEMAPHORE SHIM
+//==============================================================================
+// Host tools are single-threaded: mutexes always succeed and only exist so
+// firmware locking code compiles unchanged.
+
+#include "FreeRTOS.h"
+
+struct StaticSemaphore_t {
+    int reserved;
+};
+
+typedef StaticSemaphore_t* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* buffer) {
+    return buffer;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+    static StaticSemaphore_t shared_mutex;
+    return &shared_mutex;
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait) {
+    (void)ticks_to_wait;
+    return semaphore ? pdTRUE : pdFALSE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    return semaphore ? pdTRUE : pdFALSE;
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    (void)semaphore;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+//==============================================================================
+// NATIVE (HOST) FREERTOS TASK SHIM
+//==============================================================================
+// Delays advance the virtual clock instead of blocking, so firmware code that
+// waits with vTaskDelay() completes instantly in simulated time.
+
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+
+inline void vTaskDelay(TickType_t ticks) {
+    native_clock::advance_ms(ticks);
+}
+
+inline TickType_t xTaskGetTickCount() {
+    return (TickType_t)millis();
+}
+
+inline void vTaskDelayUntil(TickType_t* previous_wake_time, TickType_t period) {
+    *previous_wake_time += period;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previous_wake_time - now) > 0) {
+        native_clock::advance_ms(*previous_wake_time - now);
+    }
+}
@@ -0,0 +1,252 @@
+#include "autotune_simulator.h"
+#include "../../controllers/autotune_controller.h"
+#include "../../controllers/grind_controller.h"
+#include "../../hardware/WeightSensor.h"
+#include "../../hardware/grinder.h"
+#include "../../hardware/mock_hx711_driver.h"
+#include "../../config/constants.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <vector>
+
+/*
+ * Motor latency auto-tune simulator
+ *
+ * Wires WeightSensor, Grinder, GrindController and AutoTuneController as the firmware
+ * does and runs complete auto-tunes on the virtual clock: sampling every 20ms on Core 0
+ * and AutoTuneController::update() on the same tick, as the UI task calls it.
+ *
+ * Every run draws the plant's pulse latency uniformly from [--latency-min, --latency-max]
+ * and each pulse adds +/- --jitter to it, so the shortest pulse that produces grounds
+ * varies from pulse to pulse. Both searches see the same plants (same seed per run).
+ *
+ * A pulse of d ms puts flow * (d - latency) / 1000 grams in the cup, detected above
+ * GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G, so the true success rate of a tuned latency is
+ * the fraction of the jitter range with d >= latency + detection offset. The report
+ * lists how often the tuned value falls below GRIND_AUTOTUNE_SUCCESS_RATE.
+ */
+
+namespace {
+
+struct SimConfig {
+    uint32_t runs = 200;
+    uint32_t seed = 1;
+    float latency_min_ms = 40.0f;
+    float latency_max_ms = 150.0f;
+    float jitter_ms = 5.0f;
+    bool verbose = false;
+    MockGrinderModel model;
+};
+
+struct RunOutcome {
+    bool success;
+    uint32_t pulses;                     // Test pulses after priming
+    uint32_t duration_ms;                // start() to COMPLETE_*
+    float latency_ms;                    // Tuned latency
+    float success_rate;                  // True success rate of a pulse of latency_ms
+    float threshold_ms;                  // Pulse with 50% success on this plant
+};
+
+class AutoTuneSimulation {
+public:
+    AutoTuneSimulation(const SimConfig& config, AutoTuneSearch search)
+        : config_(config), search_(search) {}
+
+    RunOutcome run(uint32_t run_seed) {
+        std::mt19937 rng(run_seed);
+        std::uniform_real_distribution<float> latency(config_.latency_min_ms, config_.latency_max_ms);
+        MockGrinderModel model = config_.model;
+        model.pulse_latency_ms = latency(rng);
+        model.pulse_latency_jitter_ms = config_.jitter_ms;
+
+        native_clock::set_ms(1000);
+        srandom(run_seed);
+        MockHX711Driver::set_model(model);
+        MockHX711Driver::empty_cup();
+
+        Preferences preferences;
+        preferences.begin("grinder", false);
+        preferences.clear();
+
+        std::unique_ptr<WeightSensor> sensor(new WeightSensor());
+        sensor->init(&preferences);
+        sensor->begin();
+        sensor->set_hardware_initialized();
+        Grinder grinder;
+        grinder.init(HW_MOTOR_RELAY_PIN);
+        std::unique_ptr<GrindController> controller(new GrindController());
+        controller->init(sensor.get(), &grinder, &preferences);
+        std::unique_ptr<AutoTuneController> autotune(new AutoTuneController());
+        autotune->init(sensor.get(), &grinder, controller.get());
+        autotune->set_search(search_);
+
+        run_for(sensor.get(), nullptr, 2000);
+
+        RunOutcome outcome = {};
+        unsigned long start_ms = millis();
+        uint32_t pulses = 0;
+        bool pulse_was_active = false;
+        if (autotune->start()) {
+            const unsigned long limit_ms = 30UL * 60UL * 1000UL;
+            while (autotune->is_active() && millis() - start_ms < limit_ms) {
+                tick(sensor.get(), autotune.get());
+                bool pulse_active = grinder.is_pulse_active();
+                if (pulse_active && !pulse_was_active) pulses++;
+                pulse_was_active = pulse_active;
+            }
+            const AutoTuneResult& result = autotune->get_result();
+            outcome.success = !autotune->is_active() && result.success;
+            outcome.latency_ms = result.latency_ms;
+        }
+        outcome.duration_ms = (uint32_t)(millis() - start_ms);
+        outcome.pulses = pulses > 0 ? pulses - 1 : 0;     // Priming pulse is common to both searches
+
+        // d >= latency + jitter + detection offset, jitter uniform in +/- jitter_ms
+        float detection_ms = 1000.0f * GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G / model.flow_rate_gps;
+        outcome.threshold_ms = model.pulse_latency_ms + detection_ms;
+        float margin_ms = outcome.latency_ms - outcome.threshold_ms;
+        if (config_.jitter_ms <= 0.0f) {
+            outcome.success_rate = margin_ms >= 0.0f ? 1.0f : 0.0f;
+        } else {
+            outcome.success_rate = std::max(0.0f, std::min(1.0f, 0.5f + margin_ms / (2.0f * config_.jitter_ms)));
+        }
+        return outcome;
+    }
+
+private:
+    // One SYS_TASK_GRIND_CONTROL_INTERVAL_MS step: sampling task, then the UI task's autotune update
+    void tick(WeightSensor* sensor, AutoTuneController* autotune) {
+        native_clock::advance_ms(SYS_TASK_GRIND_CONTROL_INTERVAL_MS);
+        sensor->sample_and_feed_filter();
+        if (autotune) {
+            autotune->update();
+        }
+    }
+
+    void run_for(WeightSensor* sensor, AutoTuneController* autotune, uint32_t duration_ms) {
+        unsigned long start_ms = millis();
+        while (millis() - start_ms < duration_ms) {
+            tick(sensor, autotune);
+        }
+    }
+
+    SimConfig config_;
+    AutoTuneSearch search_;
+};
+
+float percentile(std::vector<float> values, float p) {
+    if (values.empty()) return 0.0f;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p / 100.0f * (values.size() - 1) + 0.5f);
+    return values[std::min(index, values.size() - 1)];
+}
+
+void print_distribution(const char* label, const std::vector<float>& values, const char* unit) {
+    if (values.empty()) return;
+    double sum = 0.0;
+    for (float v : values) sum += v;
+    printf("  %-22s mean %7.2f  p5 %7.2f  p50 %7.2f  p95 %7.2f  max %7.2f %s\n",
+           label, sum / values.size(), percentile(values, 5), percentile(values, 50),
+           percentile(values, 95), percentile(values, 100), unit);
+}
+
+void run_search(const SimConfig& config, AutoTuneSearch search, const char* label) {
+    AutoTuneSimulation simulation(config, search);
+
+    std::vector<float> pulses;
+    std::vector<float> durations_s;
+    std::vector<float> margins_ms;
+    std::vector<float> rates;
+    uint32_t failures = 0;
+    uint32_t below_target = 0;
+
+    auto wall_start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < config.runs; i++) {
+        RunOutcome outcome = simulation.run(config.seed + i);
+        if (!outcome.success) {
+            failures++;
+            continue;
+        }
+        pulses.push_back((float)outcome.pulses);
+        durations_s.push_back(outcome.duration_ms / 1000.0f);
+        margins_ms.push_back(outcome.latency_ms - outcome.threshold_ms);
+        rates.push_back(100.0f * outcome.success_rate);
+        if (outcome.success_rate < GRIND_AUTOTUNE_SUCCESS_RATE) {
+            below_target++;
+        }
+    }
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+
+    printf("\n%s (%.2fs wall)\n", label, wall_s);
+    printf("  completed %lu  failed %lu\n", (unsigned long)pulses.size(), (unsigned long)failures);
+    if (pulses.empty()) return;
+    print_distribution("test pulses", pulses, "");
+    print_distribution("total time", durations_s, "s");
+    print_distribution("result - 50% pulse", margins_ms, "ms");
+    print_distribution("true success rate", rates, "%");
+    printf("  below %.0f%% success rate: %lu (%.1f%%)\n", 100.0f * GRIND_AUTOTUNE_SUCCESS_RATE,
+           (unsigned long)below_target, 100.0 * below_target / pulses.size());
+}
+
+bool parse_args(int argc, char** argv, SimConfig& config) {
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--verbose") == 0) {
+            config.verbose = true;
+            continue;
+        }
+        if (strcmp(arg, "--help") == 0 || i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--runs") == 0) config.runs = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--seed") == 0) config.seed = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--latency-min") == 0) config.latency_min_ms = strtof(value, nullptr);
+        else if (strcmp(arg, "--latency-max") == 0) config.latency_max_ms = strtof(value, nullptr);
+        else if (strcmp(arg, "--jitter") == 0) config.jitter_ms = strtof(value, nullptr);
+        else if (strcmp(arg, "--flow") == 0) config.model.flow_rate_gps = strtof(value, nullptr);
+        else if (strcmp(arg, "--idle-noise") == 0) config.model.idle_noise_raw = strtof(value, nullptr);
+        else return false;
+    }
+    return config.latency_max_ms >= config.latency_min_ms;
+}
+
+void print_help() {
+    printf("Usage: autotune-sim [options]\n"
+           "  --runs N              auto-tunes per search (default 200)\n"
+           "  --seed N              RNG seed of the first run (default 1)\n"
+           "  --latency-min MS      shortest plant latency drawn (default 40)\n"
+           "  --latency-max MS      longest plant latency drawn (default 150)\n"
+           "  --jitter MS           +/- pulse-to-pulse latency variation (default 5)\n"
+           "  --flow GPS            flow rate (default %.2f)\n"
+           "  --idle-noise RAW      peak idle noise in ADC counts (default %.0f)\n"
+           "  --verbose             print firmware log output\n",
+           DEBUG_MOCK_FLOW_RATE_GPS, DEBUG_MOCK_IDLE_NOISE_RAW);
+}
+
+} // namespace
+
+int run_autotune_simulator(int argc, char** argv) {
+    SimConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_help();
+        return 1;
+    }
+
+    Serial.enabled = config.verbose;
+
+    printf("Auto-tune simulator: %lu runs per search, seed %lu\n", (unsigned long)config.runs,
+           (unsigned long)config.seed);
+    printf("  plant: latency %.0f-%.0fms +/-%.1fms per pulse, flow %.2fg/s, idle noise %.0f counts\n",
+           config.latency_min_ms, config.latency_max_ms, config.jitter_ms, config.model.flow_rate_gps,
+           config.model.idle_noise_raw);
+    printf("  target: %.0f%% success rate, accuracy %.1fms, Bayesian confidence %.2f\n",
+           100.0f * GRIND_AUTOTUNE_SUCCESS_RATE, GRIND_AUTOTUNE_TARGET_ACCURACY_MS, GRIND_AUTOTUNE_BAYES_CONFIDENCE);
+
+    run_search(config, AutoTuneSearch::BINARY, "Binary search + verification");
+    run_search(config, AutoTuneSearch::BAYESIAN, "Bayesian search");
+    return 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Motor latency auto-tune simulator: runs AutoTuneController with the binary search and the
+// Bayesian search against MockHX711Driver plants with random latency and pulse-to-pulse jitter
+// and reports test pulses, total time and the success rate the tuned latency reaches.
+// Options are listed by `autotune-sim --help`.
+int run_autotune_simulator(int argc, char** argv);
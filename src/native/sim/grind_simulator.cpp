@@ -0,0 +1,559 @@
+#include "grind_simulator.h"
+#include "../../controllers/grind_controller.h"
+#include "../../controllers/grind_events.h"
+#include "../../hardware/WeightSensor.h"
+#include "../../hardware/grinder.h"
+#include "../../hardware/mock_hx711_driver.h"
+#include "../../logging/grind_logging.h"
+#include "../../logging/session_codec.h"
+#include "../../config/constants.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <LittleFS.h>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <vector>
+
+/*
+ * Closed-loop grind simulator
+ *
+ * Wires the production control stack exactly as the firmware does - WeightSensor
+ * owning a MockHX711Driver, Grinder on its mock path, GrindController with the
+ * weight strategy - and steps it on the virtual clock with the same cadence as the
+ * FreeRTOS tasks: sampling and control every 20ms on Core 0, UI event draining
+ * every tick and flash operations every SYS_TASK_FILE_IO_INTERVAL_MS on Core 1.
+ *
+ * The plant is MockGrinderModel. Each grind draws its flow rate from
+ * flow_rate_gps * (1 +/- flow_jitter) so the controller has to adapt rather than
+ * replay one trajectory. The UI side is played by on_ui_event(): it acknowledges
+ * INITIALIZING, empties the cup and confirms in PURGE_CONFIRM, and records the
+ * outcome on COMPLETED/TIMEOUT.
+ *
+ * --wakeup picks how the control task is scheduled against the samples:
+ *   lockstep  one 20ms tick runs sampling then control (default, original model)
+ *   interval  1ms steps; samples are fed at conversion (DOUT interrupt) and control
+ *             runs on its own 20ms grid with a random phase per grind, as on the device
+ *             with SYS_GRIND_CONTROL_EVENT_DRIVEN=0
+ *   sample    1ms steps; control runs on every fed sample, falling back to the 20ms
+ *             interval in motor-timing phases and SYS_TASK_GRIND_CONTROL_FALLBACK_MS
+ *             elsewhere, as GrindControlTask does with SYS_GRIND_CONTROL_EVENT_DRIVEN=1
+ * Stop-decision latency is the time from the newest fed sample to the motor stop command.
+ */
+
+namespace {
+
+enum class ControlWakeup {
+    LOCKSTEP,
+    INTERVAL,
+    SAMPLE
+};
+
+struct SimConfig {
+    uint32_t grinds = 1000;
+    float target_g = 18.0f;
+    float flow_jitter = 0.10f;           // +/- fraction applied to flow per grind
+    uint32_t seed = 1;
+    uint32_t idle_between_ms = 1000;     // Scale idle time before each grind
+    uint32_t purge_confirm_ms = 1500;    // Simulated user delay in PURGE_CONFIRM
+    int purge_mode = GRIND_PURGE_MODE_DEFAULT;
+    const char* session_dir = nullptr;   // Host directory for saved session files (logging off if null)
+    float weight_quantum_g = 0.0f;       // Weight step of saved sessions, 0 = codec default
+    bool verbose = false;
+    ControlWakeup wakeup = ControlWakeup::LOCKSTEP;
+    int stop_planner = GRIND_STOP_PLANNER_DEFAULT;
+    MockGrinderModel model;
+};
+
+struct GrindOutcome {
+    bool finished;
+    bool timed_out;
+    GrindController::GrindSessionResult result;
+    float scale_error_g;                 // Final scale reading - target
+    float cup_error_g;                   // Grounds actually in the cup - target
+    uint8_t pulses;
+    uint32_t time_to_target_ms;          // start_grind() to COMPLETED/TIMEOUT
+    uint32_t motor_on_ms;
+    uint32_t control_updates;            // GrindController::update() calls during the grind
+    int32_t stop_latency_ms;             // Newest sample to the predictive motor stop, -1 if none
+};
+
+// UI side of the simulation - GrindController only accepts a plain function pointer
+struct UiState {
+    GrindController* controller;
+    bool acknowledge_pending;
+    bool purge_pending;
+    unsigned long purge_entered_ms;
+    bool finished;
+    bool timed_out;
+    float final_weight;
+    unsigned long finished_ms;
+};
+
+UiState ui_state;
+
+void on_ui_event(const GrindEventData& event) {
+    switch (event.event) {
+        case UIGrindEvent::PHASE_CHANGED:
+            if (event.phase == GrindPhase::INITIALIZING) {
+                ui_state.acknowledge_pending = true;
+            } else if (event.phase == GrindPhase::PURGE_CONFIRM) {
+                ui_state.purge_pending = true;
+                ui_state.purge_entered_ms = millis();
+            }
+            break;
+        case UIGrindEvent::COMPLETED:
+            ui_state.finished = true;
+            ui_state.final_weight = event.final_weight;
+            ui_state.finished_ms = millis();
+            break;
+        case UIGrindEvent::TIMEOUT:
+            ui_state.finished = true;
+            ui_state.timed_out = true;
+            ui_state.final_weight = event.error_weight;
+            ui_state.finished_ms = millis();
+            break;
+        default:
+            break;
+    }
+}
+
+class GrindSimulation {
+public:
+    explicit GrindSimulation(const SimConfig& config)
+        : config_(config), rng_(config.seed), phase_rng_(config.seed ^ 0x5bd1e995u) {}
+
+    void setup() {
+        native_clock::set_ms(1000);
+        srandom(config_.seed);
+        MockHX711Driver::set_model(config_.model);
+
+        preferences_.begin("grinder", false);
+        preferences_.putInt(GrindController::PREF_KEY_GRINDER_MODE, config_.purge_mode);
+        preferences_.putInt(GrindController::PREF_KEY_STOP_PLANNER, config_.stop_planner);
+
+        if (config_.session_dir) {
+            LittleFS.set_host_root(config_.session_dir);
+            LittleFS.begin(true);
+            Preferences logging_prefs;
+            logging_prefs.begin("logging", false);
+            logging_prefs.putBool("enabled", true);
+            logging_prefs.end();
+            grind_logger.set_weight_quantum(config_.weight_quantum_g);
+        }
+
+        sensor_.reset(new WeightSensor());
+        sensor_->init(&preferences_);
+        sensor_->begin();
+        sensor_->set_hardware_initialized();
+        grinder_.init(HW_MOTOR_RELAY_PIN);
+
+        controller_.reset(new GrindController());
+        controller_->init(sensor_.get(), &grinder_, &preferences_);
+        controller_->set_ui_event_callback(on_ui_event);
+        ui_state.controller = controller_.get();
+
+        run_for(2000);
+    }
+
+    GrindOutcome run_grind() {
+        MockGrinderModel model = config_.model;
+        std::uniform_real_distribution<float> jitter(-config_.flow_jitter, config_.flow_jitter);
+        model.flow_rate_gps *= 1.0f + jitter(rng_);
+        MockHX711Driver::set_model(model);
+
+        MockHX711Driver::empty_cup();
+        run_for(config_.idle_between_ms);
+
+        ui_state = UiState();
+        ui_state.controller = controller_.get();
+
+        // Control task phase against the sampling grid is arbitrary on the device
+        control_phase_ms_ = phase_rng_() % SYS_TASK_GRIND_CONTROL_INTERVAL_MS;
+        control_updates_ = 0;
+        stop_latency_ms_ = -1;
+
+        unsigned long start_ms = millis();
+        controller_->start_grind(config_.target_g, 0, GrindMode::WEIGHT);
+
+        const unsigned long limit_ms = GRIND_TIMEOUT_SEC * 1000UL + 10000UL;
+        while (millis() - start_ms < limit_ms) {
+            tick();
+            if (ui_state.finished && !grind_logger.is_logging_active()) {
+                break;
+            }
+        }
+
+        GrindOutcome outcome = {};
+        outcome.finished = ui_state.finished;
+        outcome.timed_out = ui_state.timed_out;
+        outcome.result = controller_->get_last_session_result();
+        outcome.scale_error_g = ui_state.final_weight - config_.target_g;
+        outcome.cup_error_g = MockHX711Driver::get_cup_mass_g() - config_.target_g;
+        outcome.time_to_target_ms = ui_state.finished ? (uint32_t)(ui_state.finished_ms - start_ms) : (uint32_t)limit_ms;
+
+        const GrindSession* session = grind_logger.get_current_session();
+        if (session) {
+            outcome.pulses = session->pulse_count;
+            outcome.motor_on_ms = session->total_motor_on_time_ms;
+        }
+        outcome.control_updates = control_updates_;
+        outcome.stop_latency_ms = stop_latency_ms_;
+
+        if (controller_->is_active()) {
+            if (ui_state.finished) {
+                controller_->return_to_idle();
+            } else {
+                controller_->stop_grind();
+            }
+        }
+        drain_core1_queues();
+        return outcome;
+    }
+
+private:
+    void tick() {
+        if (config_.wakeup == ControlWakeup::LOCKSTEP) {
+            tick_lockstep();
+        } else {
+            tick_1ms();
+        }
+    }
+
+    // One SYS_TASK_GRIND_CONTROL_INTERVAL_MS step of every task that touches the grind
+    void tick_lockstep() {
+        native_clock::advance_ms(SYS_TASK_GRIND_CONTROL_INTERVAL_MS);
+
+        // Core 0: sampling task (priority 4) then control task (priority 3)
+        if (sensor_->sample_and_feed_filter()) {
+            last_sample_ms_ = millis();
+        }
+        run_control();
+
+        run_core1();
+    }
+
+    // Millisecond step: interrupt-driven sampling, control per --wakeup, Core 1 every 20ms
+    void tick_1ms() {
+        native_clock::advance_ms(1);
+        unsigned long now = millis();
+
+        bool sample_fed = sensor_->sample_and_feed_filter();
+        if (sample_fed) {
+            last_sample_ms_ = now;
+        }
+
+        bool control_due;
+        if (config_.wakeup == ControlWakeup::SAMPLE) {
+            uint32_t timeout_ms = controller_->needs_timed_updates() ? SYS_TASK_GRIND_CONTROL_INTERVAL_MS
+                                                                     : SYS_TASK_GRIND_CONTROL_FALLBACK_MS;
+            control_due = sample_fed || now - last_control_ms_ >= timeout_ms;
+        } else {
+            control_due = (now + control_phase_ms_) % SYS_TASK_GRIND_CONTROL_INTERVAL_MS == 0;
+        }
+        if (control_due) {
+            last_control_ms_ = now;
+            run_control();
+        }
+
+        if (now % SYS_TASK_GRIND_CONTROL_INTERVAL_MS == 0) {
+            run_core1();
+        }
+    }
+
+    // Control task body - same stop detection as GrindControlTask::update_grind_control()
+    void run_control() {
+        uint32_t predictive_stops = controller_->get_predictive_stop_count();
+        controller_->update();
+        if (controller_->is_active()) {
+            control_updates_++;
+        }
+        if (controller_->get_predictive_stop_count() != predictive_stops) {
+            stop_latency_ms_ = (int32_t)(millis() - last_sample_ms_);
+        }
+    }
+
+    void run_core1() {
+        // Core 1: UI task drains events and plays the user
+        controller_->process_queued_ui_events();
+        if (ui_state.acknowledge_pending) {
+            ui_state.acknowledge_pending = false;
+            controller_->ui_acknowledge_phase_transition();
+        }
+        if (ui_state.purge_pending && millis() - ui_state.purge_entered_ms >= config_.purge_confirm_ms) {
+            ui_state.purge_pending = false;
+            MockHX711Driver::empty_cup();
+            controller_->continue_from_purge();
+        }
+
+        // Core 1: file I/O task
+        if (millis() - last_file_io_ms_ >= SYS_TASK_FILE_IO_INTERVAL_MS) {
+            last_file_io_ms_ = millis();
+            drain_core1_queues();
+        }
+    }
+
+    void drain_core1_queues() {
+        controller_->process_queued_flash_operations();
+        controller_->process_queued_log_messages();
+        grind_logger.write_session_journals();
+        // Session committer task, woken at the end of each file I/O cycle
+        while (grind_logger.commit_pending_session()) {
+        }
+    }
+
+    void run_for(uint32_t duration_ms) {
+        unsigned long start_ms = millis();
+        while (millis() - start_ms < duration_ms) {
+            tick();
+        }
+    }
+
+    SimConfig config_;
+    std::mt19937 rng_;
+    Preferences preferences_;
+    std::unique_ptr<WeightSensor> sensor_;
+    Grinder grinder_;
+    std::unique_ptr<GrindController> controller_;
+    unsigned long last_file_io_ms_ = 0;
+    std::mt19937 phase_rng_;
+    uint32_t control_phase_ms_ = 0;
+    unsigned long last_control_ms_ = 0;
+    unsigned long last_sample_ms_ = 0;
+    uint32_t control_updates_ = 0;
+    int32_t stop_latency_ms_ = -1;
+};
+
+float percentile(std::vector<float> values, float p) {
+    if (values.empty()) return 0.0f;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p / 100.0f * (values.size() - 1) + 0.5f);
+    return values[std::min(index, values.size() - 1)];
+}
+
+void print_distribution(const char* label, const std::vector<float>& values, const char* unit, bool is_error) {
+    if (values.empty()) return;
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    double sum_abs = 0.0;
+    for (float v : values) {
+        sum += v;
+        sum_squares += (double)v * v;
+        sum_abs += std::fabs(v);
+    }
+    double mean = sum / values.size();
+    double variance = std::max(0.0, sum_squares / values.size() - mean * mean);
+    if (is_error) {
+        printf("  %-15s mean %+7.3f  sd %6.3f  mae %6.3f  p5 %+7.3f  p50 %+7.3f  p95 %+7.3f  min %+7.3f  max %+7.3f %s\n",
+               label, mean, std::sqrt(variance), sum_abs / values.size(),
+               percentile(values, 5), percentile(values, 50), percentile(values, 95),
+               percentile(values, 0), percentile(values, 100), unit);
+    } else {
+        printf("  %-15s mean %7.2f  sd %6.2f  p5 %7.2f  p50 %7.2f  p95 %7.2f  max %7.2f %s\n",
+               label, mean, std::sqrt(variance),
+               percentile(values, 5), percentile(values, 50), percentile(values, 95),
+               percentile(values, 100), unit);
+    }
+}
+
+void print_error_histogram(const std::vector<float>& errors) {
+    const float bin_g = 0.02f;
+    const int half_bins = 8;
+    int bins[2 * half_bins + 2] = {};
+    for (float e : errors) {
+        int bin = (int)std::floor(e / bin_g) + half_bins;
+        bin = std::max(-1, std::min(bin, 2 * half_bins)) + 1;
+        bins[bin]++;
+    }
+    int peak = *std::max_element(bins, bins + 2 * half_bins + 2);
+    for (int i = 0; i < 2 * half_bins + 2; i++) {
+        if (i == 0) {
+            printf("    %15s  ", "< -0.16g");
+        } else if (i == 2 * half_bins + 1) {
+            printf("    %15s  ", ">= +0.16g");
+        } else {
+            float lo = (i - 1 - half_bins) * bin_g;
+            printf("    [%+.2f,%+.2f)g  ", lo, lo + bin_g);
+        }
+        int width = peak > 0 ? (bins[i] * 50 + peak - 1) / peak : 0;
+        printf("%6d %s\n", bins[i], std::string(width, '#').c_str());
+    }
+}
+
+bool parse_args(int argc, char** argv, SimConfig& config) {
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--verbose") == 0) {
+            config.verbose = true;
+            continue;
+        }
+        if (strcmp(arg, "--help") == 0 || i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--grinds") == 0) config.grinds = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--target") == 0) config.target_g = strtof(value, nullptr);
+        else if (strcmp(arg, "--seed") == 0) config.seed = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--flow") == 0) config.model.flow_rate_gps = strtof(value, nullptr);
+        else if (strcmp(arg, "--flow-jitter") == 0) config.flow_jitter = strtof(value, nullptr);
+        else if (strcmp(arg, "--start-delay") == 0) config.model.start_delay_ms = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--coast") == 0) config.model.stop_delay_ms = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--ramp") == 0) config.model.flow_ramp_ms = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--pulse-latency") == 0) config.model.pulse_latency_ms = strtof(value, nullptr);
+        else if (strcmp(arg, "--idle-noise") == 0) config.model.idle_noise_raw = strtof(value, nullptr);
+        else if (strcmp(arg, "--grind-noise") == 0) config.model.grind_noise_raw = strtof(value, nullptr);
+        else if (strcmp(arg, "--chute-retention") == 0) config.model.chute_retention_g = strtof(value, nullptr);
+        else if (strcmp(arg, "--chute-release") == 0) config.model.chute_release_ms = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--save-sessions") == 0) config.session_dir = value;
+        else if (strcmp(arg, "--weight-quantum") == 0) config.weight_quantum_g = strtof(value, nullptr);
+        else if (strcmp(arg, "--wakeup") == 0) {
+            if (strcmp(value, "lockstep") == 0) config.wakeup = ControlWakeup::LOCKSTEP;
+            else if (strcmp(value, "interval") == 0) config.wakeup = ControlWakeup::INTERVAL;
+            else if (strcmp(value, "sample") == 0) config.wakeup = ControlWakeup::SAMPLE;
+            else return false;
+        }
+        else if (strcmp(arg, "--stop-planner") == 0) {
+            if (strcmp(value, "coast-ratio") == 0) config.stop_planner = static_cast<int>(StopPlannerType::COAST_RATIO);
+            else if (strcmp(value, "model") == 0) config.stop_planner = static_cast<int>(StopPlannerType::MODEL);
+            else return false;
+        }
+        else if (strcmp(arg, "--purge") == 0) config.purge_mode = (strcmp(value, "prime") == 0)
+                                                                 ? static_cast<int>(GrinderPurgeMode::PRIME)
+                                                                 : static_cast<int>(GrinderPurgeMode::PURGE);
+        else return false;
+    }
+    return true;
+}
+
+void print_help() {
+    printf("Usage: sim [options]\n"
+           "  --grinds N            number of simulated grinds (default 1000)\n"
+           "  --target G            target weight in grams (default 18.0)\n"
+           "  --seed N              RNG seed for noise and flow jitter (default 1)\n"
+           "  --flow GPS            nominal flow rate (default %.2f)\n"
+           "  --flow-jitter F       per-grind flow variation, +/- fraction (default 0.10)\n"
+           "  --start-delay MS      motor start to first grounds (default %d)\n"
+           "  --coast MS            motor stop to flow end (default %d)\n"
+           "  --ramp MS             flow ramp up/down time (default %d)\n"
+           "  --pulse-latency MS    shortest pulse that produces grounds (default %.1f)\n"
+           "  --idle-noise RAW      peak idle noise in ADC counts (default %.0f)\n"
+           "  --grind-noise RAW     peak grinding noise in ADC counts (default %.0f)\n"
+           "  --chute-retention G   grounds held back in the chute (default 0)\n"
+           "  --chute-release MS    chute drain time constant (default 0)\n"
+           "  --purge prime|purge   grinder purge mode (default purge)\n"
+           "  --save-sessions DIR   enable grind logging with LittleFS mounted on DIR\n"
+           "  --weight-quantum G    weight step of the saved sessions (default %g)\n"
+           "  --wakeup MODE         control scheduling: lockstep|interval|sample (default lockstep)\n"
+           "  --stop-planner NAME   motor stop planner: coast-ratio|model (default %s)\n"
+           "  --verbose             print firmware log output\n",
+           DEBUG_MOCK_FLOW_RATE_GPS, DEBUG_MOCK_START_DELAY_MS, DEBUG_MOCK_STOP_DELAY_MS,
+           DEBUG_MOCK_FLOW_RAMP_MS, DEBUG_MOCK_MOTOR_LATENCY_MS,
+           DEBUG_MOCK_IDLE_NOISE_RAW, DEBUG_MOCK_GRIND_NOISE_RAW, SESSION_CODEC_WEIGHT_QUANTUM_G,
+           GRIND_STOP_PLANNER_DEFAULT == static_cast<int>(StopPlannerType::MODEL) ? "model" : "coast-ratio");
+}
+
+} // namespace
+
+int run_grind_simulator(int argc, char** argv) {
+    SimConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_help();
+        return 1;
+    }
+
+    Serial.enabled = config.verbose;
+
+    GrindSimulation simulation(config);
+    simulation.setup();
+
+    std::vector<float> scale_errors;
+    std::vector<float> cup_errors;
+    std::vector<float> times_s;
+    std::vector<float> motor_s;
+    std::vector<float> stop_latencies_ms;
+    uint64_t total_control_updates = 0;
+    uint32_t pulse_histogram[GRIND_MAX_PULSE_ATTEMPTS + 1] = {};
+    uint32_t result_counts[6] = {};
+    uint32_t within_tolerance = 0;
+    uint32_t unfinished = 0;
+    uint64_t total_pulses = 0;
+
+    auto wall_start = std::chrono::steady_clock::now();
+    unsigned long sim_start_ms = millis();
+
+    for (uint32_t i = 0; i < config.grinds; i++) {
+        GrindOutcome outcome = simulation.run_grind();
+        if (!outcome.finished) {
+            unfinished++;
+            continue;
+        }
+
+        result_counts[static_cast<int>(outcome.result)]++;
+        if (outcome.timed_out) {
+            continue;
+        }
+
+        scale_errors.push_back(outcome.scale_error_g);
+        cup_errors.push_back(outcome.cup_error_g);
+        times_s.push_back(outcome.time_to_target_ms / 1000.0f);
+        motor_s.push_back(outcome.motor_on_ms / 1000.0f);
+        pulse_histogram[std::min<uint32_t>(outcome.pulses, GRIND_MAX_PULSE_ATTEMPTS)]++;
+        total_pulses += outcome.pulses;
+        total_control_updates += outcome.control_updates;
+        if (outcome.stop_latency_ms >= 0) {
+            stop_latencies_ms.push_back((float)outcome.stop_latency_ms);
+        }
+        if (std::fabs(outcome.scale_error_g) <= GRIND_ACCURACY_TOLERANCE_G) {
+            within_tolerance++;
+        }
+    }
+
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    double sim_s = (millis() - sim_start_ms) / 1000.0;
+
+    const MockGrinderModel& model = config.model;
+    printf("Grind simulator: %lu grinds, target %.2fg, seed %lu\n",
+           (unsigned long)config.grinds, config.target_g, (unsigned long)config.seed);
+    printf("  plant: flow %.2fg/s +/-%.0f%%, start delay %lums, coast %lums, ramp %lums, pulse latency %.1fms\n",
+           model.flow_rate_gps, config.flow_jitter * 100.0f, (unsigned long)model.start_delay_ms,
+           (unsigned long)model.stop_delay_ms, (unsigned long)model.flow_ramp_ms, model.pulse_latency_ms);
+    printf("         noise %.0f/%.0f counts idle/grind, chute retention %.2fg release %lums, purge mode %s\n",
+           model.idle_noise_raw, model.grind_noise_raw, model.chute_retention_g,
+           (unsigned long)model.chute_release_ms,
+           config.purge_mode == static_cast<int>(GrinderPurgeMode::PRIME) ? "prime" : "purge");
+    static const char* wakeup_names[] = {"lockstep", "interval", "sample"};
+    printf("  control wakeup: %s\n", wakeup_names[static_cast<int>(config.wakeup)]);
+    printf("  stop planner: %s\n", config.stop_planner == static_cast<int>(StopPlannerType::MODEL) ? "model" : "coast-ratio");
+    printf("  speed: %.2fs wall, %.0f grinds/s, %.0fx real time\n",
+           wall_s, config.grinds / std::max(wall_s, 1e-9), sim_s / std::max(wall_s, 1e-9));
+
+    printf("\nResults\n");
+    printf("  success %lu  overshoot %lu  max pulses %lu  timeout %lu  error %lu  unfinished %lu\n",
+           (unsigned long)result_counts[static_cast<int>(GrindController::GrindSessionResult::SUCCESS)],
+           (unsigned long)result_counts[static_cast<int>(GrindController::GrindSessionResult::OVERSHOOT)],
+           (unsigned long)result_counts[static_cast<int>(GrindController::GrindSessionResult::MAX_PULSES)],
+           (unsigned long)result_counts[static_cast<int>(GrindController::GrindSessionResult::TIMEOUT)],
+           (unsigned long)result_counts[static_cast<int>(GrindController::GrindSessionResult::ERROR)],
+           (unsigned long)unfinished);
+    if (scale_errors.empty()) {
+        return 1;
+    }
+    printf("  within +/-%.2fg: %.1f%%\n", GRIND_ACCURACY_TOLERANCE_G, 100.0 * within_tolerance / scale_errors.size());
+    print_distribution("scale error", scale_errors, "g", true);
+    print_distribution("cup error", cup_errors, "g", true);
+    print_distribution("time to target", times_s, "s", false);
+    print_distribution("motor on", motor_s, "s", false);
+    print_distribution("stop latency", stop_latencies_ms, "ms", false);
+    printf("  control updates per grind: %.0f\n", (double)total_control_updates / scale_errors.size());
+
+    printf("\nPulses per grind (mean %.2f)\n", (double)total_pulses / scale_errors.size());
+    for (int p = 0; p <= GRIND_MAX_PULSE_ATTEMPTS; p++) {
+        if (pulse_histogram[p] > 0) {
+            printf("    %2d  %6lu\n", p, (unsigned long)pulse_histogram[p]);
+        }
+    }
+
+    printf("\nScale error histogram\n");
+    print_error_histogram(scale_errors);
+    return 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Closed-loop grind simulator: runs the real GrindController, WeightGrindStrategy,
+// WeightSensor and MockHX711Driver against a configurable grinder/scale plant model
+// on the virtual clock and reports final-weight error, pulse count and time-to-target.
+// Options are listed by `sim --help`.
+int run_grind_simulator(int argc, char** argv);
@@ -0,0 +1,61 @@
+#include "crc32.h"
+
+#include <string.h>
+
+namespace {
+
+constexpr uint32_t kPolynomial = 0xEDB88320u;
+
+struct Crc32Tables {
+    uint32_t table[4][256];
+
+    constexpr Crc32Tables() : table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ ((crc & 1u) ? kPolynomial : 0u);
+            }
+            table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int slice = 1; slice < 4; slice++) {
+                uint32_t previous = table[slice - 1][i];
+                table[slice][i] = (previous >> 8) ^ table[0][previous & 0xFFu];
+            }
+        }
+    }
+};
+
+constexpr Crc32Tables kTables;
+
+} // namespace
+
+uint32_t crc32_update(uint32_t crc, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+
+    while (length > 0 && (reinterpret_cast<uintptr_t>(bytes) & 3u) != 0) {
+        crc = (crc >> 8) ^ kTables.table[0][(crc ^ *bytes++) & 0xFFu];
+        length--;
+    }
+
+    // Four bytes per step; both targets are little-endian
+    while (length >= 4) {
+        uint32_t word;
+        memcpy(&word, bytes, sizeof(word));
+        crc ^= word;
+        crc = kTables.table[3][crc & 0xFFu] ^
+              kTables.table[2][(crc >> 8) & 0xFFu] ^
+              kTables.table[1][(crc >> 16) & 0xFFu] ^
+              kTables.table[0][crc >> 24];
+        bytes += 4;
+        length -= 4;
+    }
+
+    while (length > 0) {
+        crc = (crc >> 8) ^ kTables.table[0][(crc ^ *bytes++) & 0xFFu];
+        length--;
+    }
+
+    return ~crc;
+}
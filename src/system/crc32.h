@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * CRC-32 (IEEE 802.3: reflected, polynomial 0xEDB88320) - the same value as Python's
+ * zlib.crc32 / binascii.crc32, so host tools can check device data with the standard library.
+ *
+ * Incremental: pass the previous result to continue over the next piece,
+ *   crc32_update(crc32_update(0, a, a_len), b, b_len) == crc32 of a followed by b
+ *
+ * Slice-by-4 over constant tables (4 KB in flash), one table lookup per byte for the
+ * unaligned head and tail.
+ */
+uint32_t crc32_update(uint32_t crc, const void* data, size_t length);
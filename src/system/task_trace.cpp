@@ -0,0 +1,134 @@
+#include "task_trace.h"
+
+#if SYS_TASK_TRACE
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <string.h>
+
+static_assert((SYS_TASK_TRACE_EVENTS_PER_CORE & (SYS_TASK_TRACE_EVENTS_PER_CORE - 1)) == 0,
+              "SYS_TASK_TRACE_EVENTS_PER_CORE must be a power of two");
+static_assert(sizeof(TraceEvent) == 8, "TraceEvent is part of the download format");
+static_assert(SYS_TASK_TRACE_EVENTS_PER_CORE > TRACE_SNAPSHOT_HEADROOM, "Trace ring smaller than the snapshot headroom");
+
+namespace {
+
+struct TraceRing {
+    TraceEvent* events;
+    uint32_t reserved;     // Slots handed out
+    uint32_t committed;    // Slots written - equal to reserved when no write is in progress
+};
+
+TraceRing rings[TRACE_CORE_COUNT];
+bool recording = false;
+
+const uint32_t TRACE_INDEX_MASK = SYS_TASK_TRACE_EVENTS_PER_CORE - 1;
+const uint32_t TRACE_QUIESCE_TICKS = 10;   // Longest wait for a preempted writer during a snapshot
+
+TraceEvent* allocate_ring() {
+    size_t bytes = SYS_TASK_TRACE_EVENTS_PER_CORE * sizeof(TraceEvent);
+    void* memory = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!memory) {
+        memory = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    }
+    return static_cast<TraceEvent*>(memory);
+}
+
+} // namespace
+
+bool task_trace_init() {
+    if (rings[0].events) return true;
+
+    for (uint8_t core = 0; core < TRACE_CORE_COUNT; core++) {
+        rings[core].events = allocate_ring();
+        if (!rings[core].events) {
+            LOG_BLE("TaskTrace: Failed to allocate %u-event ring for core %u\n",
+                    (unsigned)SYS_TASK_TRACE_EVENTS_PER_CORE, core);
+            for (uint8_t i = 0; i < core; i++) {
+                heap_caps_free(rings[i].events);
+                rings[i].events = nullptr;
+            }
+            return false;
+        }
+    }
+
+    __atomic_store_n(&recording, true, __ATOMIC_RELEASE);
+    LOG_BLE("TaskTrace: Recording %u events per core\n", (unsigned)SYS_TASK_TRACE_EVENTS_PER_CORE);
+    return true;
+}
+
+void task_trace_record(uint8_t id, uint8_t type, uint16_t arg) {
+    if (!__atomic_load_n(&recording, __ATOMIC_ACQUIRE)) return;
+
+    TraceRing& ring = rings[xPortGetCoreID()];
+    uint32_t index = __atomic_fetch_add(&ring.reserved, 1, __ATOMIC_RELAXED);
+    TraceEvent& event = ring.events[index & TRACE_INDEX_MASK];
+    event.time_us = (uint32_t)esp_timer_get_time();
+    event.id = id;
+    event.type = type;
+    event.arg = arg;
+    __atomic_fetch_add(&ring.committed, 1, __ATOMIC_RELEASE);
+}
+
+uint8_t* task_trace_snapshot(size_t* size) {
+    if (size) *size = 0;
+    if (!rings[0].events) return nullptr;
+
+    size_t max_bytes = sizeof(TraceSnapshotHeader) + TRACE_CORE_COUNT * SYS_TASK_TRACE_EVENTS_PER_CORE * sizeof(TraceEvent);
+    uint8_t* buffer = static_cast<uint8_t*>(heap_caps_malloc(max_bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+    if (!buffer) {
+        buffer = static_cast<uint8_t*>(heap_caps_malloc(max_bytes, MALLOC_CAP_8BIT));
+    }
+    if (!buffer) return nullptr;
+
+    // Stop new records, then let writers that already reserved a slot finish theirs. A writer
+    // that checked recording before the pause but reserves after this wait writes past
+    // recorded[core], into the headroom the copy below leaves out.
+    __atomic_store_n(&recording, false, __ATOMIC_RELEASE);
+    uint32_t recorded[TRACE_CORE_COUNT];
+    for (uint32_t tick = 0; tick < TRACE_QUIESCE_TICKS; tick++) {
+        bool quiet = true;
+        for (uint8_t core = 0; core < TRACE_CORE_COUNT; core++) {
+            recorded[core] = __atomic_load_n(&rings[core].reserved, __ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&rings[core].committed, __ATOMIC_ACQUIRE) != recorded[core]) {
+                quiet = false;
+            }
+        }
+        if (quiet) break;
+        vTaskDelay(1);
+    }
+
+    TraceSnapshotHeader header = {};
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_FORMAT_VERSION;
+    header.core_count = TRACE_CORE_COUNT;
+    header.event_size = sizeof(TraceEvent);
+    header.capture_us = (uint32_t)esp_timer_get_time();
+
+    size_t offset = sizeof(TraceSnapshotHeader);
+    for (uint8_t core = 0; core < TRACE_CORE_COUNT; core++) {
+        const TraceRing& ring = rings[core];
+        const uint32_t capacity = SYS_TASK_TRACE_EVENTS_PER_CORE - TRACE_SNAPSHOT_HEADROOM;
+        uint32_t count = recorded[core] < capacity ? recorded[core] : capacity;
+        header.cores[core].recorded = recorded[core];
+        header.cores[core].count = count;
+
+        // Oldest first: the ring may wrap once within the copied range
+        uint32_t first = (recorded[core] - count) & TRACE_INDEX_MASK;
+        uint32_t head_part = count < SYS_TASK_TRACE_EVENTS_PER_CORE - first ? count : SYS_TASK_TRACE_EVENTS_PER_CORE - first;
+        memcpy(buffer + offset, &ring.events[first], head_part * sizeof(TraceEvent));
+        memcpy(buffer + offset + head_part * sizeof(TraceEvent), ring.events, (count - head_part) * sizeof(TraceEvent));
+        offset += count * sizeof(TraceEvent);
+    }
+    memcpy(buffer, &header, sizeof(header));
+
+    __atomic_store_n(&recording, true, __ATOMIC_RELEASE);
+
+    if (size) *size = offset;
+    return buffer;
+}
+
+#endif
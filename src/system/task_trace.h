@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../config/constants.h"
+
+/**
+ * Task trace - microsecond begin/end records of the task cycles and queue sends
+ *
+ * Each core has its own ring of TraceEvent records stamped with esp_timer_get_time(). Writers
+ * reserve a slot with an atomic increment and publish it with a second one, so tasks on the
+ * same core can preempt each other without a lock and a record costs well under a microsecond.
+ * When a ring is full the oldest records are overwritten.
+ *
+ * task_trace_snapshot() copies both rings into one buffer, downloaded over the data service
+ * (BLE_DATA_CMD_REQUEST_TRACE) and turned into Chrome/Perfetto trace JSON by
+ * tools/ble/grinder-ble.py trace. Layout, little-endian:
+ *   header   [magic u32 "GTRC"][version u8][core_count u8][event_size u8][0 u8][capture_us u32]
+ *   per core [recorded u32][count u32]          recorded - count = records overwritten or held back
+ *   events   core 0 records then core 1 records, oldest first
+ *
+ * Timestamps are the low 32 bits of esp_timer_get_time() (wrap every ~71 minutes); the tool
+ * unwraps them against capture_us. IDs below are part of the format - append only.
+ *
+ * Compiled out with SYS_TASK_TRACE=0 (the default on the native host build).
+ */
+
+#define TRACE_MAGIC 0x43525447u        // "GTRC"
+#define TRACE_FORMAT_VERSION 1
+#define TRACE_CORE_COUNT 2
+#define TRACE_SNAPSHOT_HEADROOM 32       // Ring slots a snapshot leaves to late writers (> tasks per core)
+
+enum TraceEventType : uint8_t {
+    TRACE_EVENT_BEGIN = 0,
+    TRACE_EVENT_END = 1,
+    TRACE_EVENT_INSTANT = 2
+};
+
+enum TraceId : uint8_t {
+    // Task cycles (BEGIN/END)
+    TRACE_ID_WEIGHT_SAMPLING = 0,
+    TRACE_ID_GRIND_CONTROL = 1,
+    TRACE_ID_UI_RENDER = 2,
+    TRACE_ID_BLUETOOTH = 3,
+    TRACE_ID_FILE_IO = 4,
+    TRACE_ID_DISPLAY_FLUSH = 5,        // One draw buffer to the panel, inside the UI cycle
+    TRACE_ID_UI_FRAME = 6,             // UI logic + LVGL inside a UI cycle the frame governor ran
+
+    // Queue sends and notifications (INSTANT, arg = messages waiting after the send, 0xFFFF = full)
+    TRACE_ID_SAMPLE_NOTIFY = 32,       // Sampling -> control task notification
+    TRACE_ID_QUEUE_UI_EVENT = 33,      // Grind controller -> UI events
+    TRACE_ID_QUEUE_FLASH_OP = 34,      // Grind controller -> flash operations
+    TRACE_ID_QUEUE_LOG = 35,           // Grind controller -> log messages
+    TRACE_ID_QUEUE_UI_STATUS = 36      // BLE -> UI status messages
+};
+
+#define TRACE_ARG_QUEUE_FULL 0xFFFF
+
+struct TraceEvent {
+    uint32_t time_us;
+    uint8_t id;                        // TraceId
+    uint8_t type;                      // TraceEventType
+    uint16_t arg;
+};
+
+struct TraceSnapshotHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t core_count;
+    uint8_t event_size;
+    uint8_t reserved;
+    uint32_t capture_us;
+    struct {
+        uint32_t recorded;
+        uint32_t count;
+    } cores[TRACE_CORE_COUNT];
+};
+
+#if SYS_TASK_TRACE
+
+// Allocates the rings (PSRAM when available). Records before this are dropped.
+bool task_trace_init();
+
+void task_trace_record(uint8_t id, uint8_t type, uint16_t arg = 0);
+
+// Copies the rings into a newly allocated buffer (free with heap_caps_free). Recording pauses
+// while the rings are copied; the newest TRACE_SNAPSHOT_HEADROOM slots of a full ring are left
+// out, for writers that passed the recording check just before the pause. Returns nullptr if tracing is not initialized or out of memory.
+uint8_t* task_trace_snapshot(size_t* size);
+
+#define TRACE_BEGIN(id) task_trace_record((id), TRACE_EVENT_BEGIN)
+#define TRACE_END(id) task_trace_record((id), TRACE_EVENT_END)
+#define TRACE_QUEUE_SEND(id, queue, result) \
+    task_trace_record((id), TRACE_EVENT_INSTANT, (result) == pdPASS ? (uint16_t)uxQueueMessagesWaiting(queue) : TRACE_ARG_QUEUE_FULL)
+#define TRACE_INSTANT(id, arg) task_trace_record((id), TRACE_EVENT_INSTANT, (arg))
+
+#else
+
+inline bool task_trace_init() { return false; }
+inline uint8_t* task_trace_snapshot(size_t* size) { if (size) *size = 0; return nullptr; }
+
+#define TRACE_BEGIN(id) ((void)0)
+#define TRACE_END(id) ((void)0)
+#define TRACE_QUEUE_SEND(id, queue, result) ((void)0)
+#define TRACE_INSTANT(id, arg) ((void)0)
+
+#endif
@@ -1,6 +1,7 @@
 #include "file_io_task.h"
 #include "../logging/grind_logging.h"
 #include "../config/constants.h"
+#include "../system/task_trace.h"
 #include <Arduino.h>
 #include <LittleFS.h>
 #include <Preferences.h>
@@ -13,6 +14,7 @@ FileIOTask* FileIOTask::instance = nullptr;
 
 FileIOTask::FileIOTask() {
     task_handle = nullptr;
+    commit_task_handle = nullptr;
     task_running = false;
     file_io_queue = nullptr;
     
@@ -35,6 +37,17 @@ FileIOTask::FileIOTask() {
     preference_operations_processed = 0;
     data_export_operations_processed = 0;
     
+    session_commits = 0;
+    commit_cycles = 0;
+    commit_time_sum_ms = 0;
+    commit_time_max_ms = 0;
+    commit_latency_sum_ms = 0;
+    commit_latency_max_ms = 0;
+    slot_occupancy_sum = 0;
+    slot_occupancy_peak = 0;
+    durable_latency_max_ms = 0;
+    journal_tail_max_bytes = 0;
+    
     instance = this;
 }
 
@@ -57,6 +70,24 @@ void FileIOTask::init(QueueHandle_t io_queue) {
         LOG_BLE("FileIOTask: LittleFS filesystem unavailable\n");
     }
     
+    // Session file writes take tens of milliseconds; they get their own task so session
+    // starts and journal blocks queued meanwhile are not held up behind them
+    if (!commit_task_handle) {
+        BaseType_t result = xTaskCreatePinnedToCore(
+            commit_task_wrapper,
+            "SessionCommit",
+            SYS_TASK_SESSION_COMMIT_STACK_SIZE,
+            nullptr,
+            SYS_TASK_PRIORITY_SESSION_COMMIT,
+            &commit_task_handle,
+            1  // Pin to Core 1
+        );
+        if (result != pdPASS) {
+            LOG_BLE("ERROR: Failed to create session commit task - sessions stay in their slots\n");
+            commit_task_handle = nullptr;
+        }
+    }
+    
     LOG_BLE("FileIOTask: Initialized with file I/O queue\n");
 }
 
@@ -140,6 +171,7 @@ void FileIOTask::task_impl() {
     // Main file I/O processing loop
     while (task_running) {
         uint32_t cycle_start_time = millis();
+        TRACE_BEGIN(TRACE_ID_FILE_IO);
         
         // Process file I/O operations from queue
         process_file_io_operations();
@@ -150,6 +182,13 @@ void FileIOTask::task_impl() {
         grind_controller.process_queued_flash_operations();
         grind_controller.process_queued_log_messages();
         
+        // Journal the running session block by block, then wake the committer for ended
+        // sessions - Core 0 is already logging the next one into the other slot
+        grind_logger.write_session_journals();
+        if (commit_task_handle) {
+            xTaskNotifyGive(commit_task_handle);
+        }
+        
         // Periodic filesystem health check
         if (cycle_start_time - last_filesystem_check_time >= 30000) { // Every 30 seconds
             check_filesystem_health();
@@ -157,6 +196,7 @@ void FileIOTask::task_impl() {
         }
         
         uint32_t cycle_end_time = millis();
+        TRACE_END(TRACE_ID_FILE_IO);
         
         // Record performance metrics
         record_timing(cycle_start_time, cycle_end_time);
@@ -224,7 +264,7 @@ void FileIOTask::process_flash_operation(const FlashOpRequest& request) {
         case FlashOpRequest::END_GRIND_SESSION:
             LOG_BLE("[%lums FLASH_OP] Processing END_GRIND_SESSION: %s, %.2fg, %d pulses\n", 
                     millis(), request.result_string, request.final_weight, request.pulse_count);
-            grind_logger.end_grind_session(request.result_string, request.final_weight, request.pulse_count);
+            grind_logger.end_grind_session(request.result_string, request.final_weight, request.pulse_count, request.session_id);
             break;
             
         default:
@@ -234,6 +274,53 @@ void FileIOTask::process_flash_operation(const FlashOpRequest& request) {
     }
 }
 
+void FileIOTask::commit_task_wrapper(void* parameter) {
+    if (instance) {
+        instance->commit_task_impl();
+    }
+    vTaskDelete(nullptr);
+}
+
+void FileIOTask::commit_task_impl() {
+    LOG_BLE("Session Commit Task started on Core %d\n", xPortGetCoreID());
+    
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        commit_pending_sessions();
+    }
+}
+
+void FileIOTask::commit_pending_sessions() {
+    uint8_t occupied = grind_logger.get_occupied_session_slots();
+    commit_cycles++;
+    slot_occupancy_sum += occupied;
+    if (occupied > slot_occupancy_peak) {
+        slot_occupancy_peak = occupied;
+    }
+    
+    SessionCommitResult result;
+    while (grind_logger.commit_pending_session(&result)) {
+        session_commits++;
+        commit_time_sum_ms += result.duration_ms;
+        commit_latency_sum_ms += result.latency_ms;
+        if (result.duration_ms > commit_time_max_ms) {
+            commit_time_max_ms = result.duration_ms;
+        }
+        if (result.latency_ms > commit_latency_max_ms) {
+            commit_latency_max_ms = result.latency_ms;
+        }
+        if (result.durable_ms > durable_latency_max_ms) {
+            durable_latency_max_ms = result.durable_ms;
+        }
+        if (result.journal_tail_bytes > journal_tail_max_bytes) {
+            journal_tail_max_bytes = result.journal_tail_bytes;
+        }
+        LOG_BLE("[%lums FILE_IO] Committed session %lu: %lums write, %lums after end, journal tail %lu bytes%s\n",
+                millis(), result.session_id, result.duration_ms, result.latency_ms, result.journal_tail_bytes,
+                result.saved ? "" : " (not saved)");
+    }
+}
+
 void FileIOTask::process_log_message(const LogMessage& message) {
     // Output the log message using BLE_LOG (extracted from GrindController)
     LOG_BLE("%s", message.message);
@@ -384,6 +471,12 @@ void FileIOTask::print_heartbeat() const {
     LOG_BLE("[%lums FILE_IO_HEARTBEAT] Cycles: %lu/10s | Avg: %lums (%lu-%lums) | FS: %s | Ops: %lu | Failed: %lu | Build: #%d\n",
            millis(), cycle_count, avg_cycle_time, cycle_time_min_ms, cycle_time_max_ms,
            fs_status, total_operations_processed, failed_operations_count, BUILD_NUMBER);
+    if (session_commits > 0) {
+        LOG_BLE("[%lums FILE_IO_HEARTBEAT] Session commits: %lu | Write avg/max: %lu/%lums | Latency avg/max: %lu/%lums | Slots peak: %u/%d | Stalls: %lu\n",
+               millis(), session_commits, commit_time_sum_ms / session_commits, commit_time_max_ms,
+               commit_latency_sum_ms / session_commits, commit_latency_max_ms,
+               slot_occupancy_peak, SESSION_SLOT_COUNT, grind_logger.get_session_slot_stalls());
+    }
 #endif
 }
 
@@ -416,6 +509,15 @@ void FileIOTask::print_operation_stats() const {
     LOG_BLE("Log messages: %lu\n", log_messages_processed);
     LOG_BLE("Preference writes: %lu\n", preference_operations_processed);
     LOG_BLE("Data exports: %lu\n", data_export_operations_processed);
+    LOG_BLE("Session commits: %lu\n", session_commits);
+    if (session_commits > 0) {
+        LOG_BLE("Session write time: avg %lums, max %lums\n", commit_time_sum_ms / session_commits, commit_time_max_ms);
+        LOG_BLE("Session commit latency: avg %lums, max %lums\n", commit_latency_sum_ms / session_commits, commit_latency_max_ms);
+        LOG_BLE("Session durable after end: max %lums, journal tail max %lu bytes\n", durable_latency_max_ms, journal_tail_max_bytes);
+    }
+    LOG_BLE("Session slots: peak %u/%d, average %.2f\n", slot_occupancy_peak, SESSION_SLOT_COUNT,
+           commit_cycles > 0 ? (float)slot_occupancy_sum / commit_cycles : 0.0f);
+    LOG_BLE("Session slot stalls: %lu\n", grind_logger.get_session_slot_stalls());
     LOG_BLE("Total operations: %lu\n", total_operations_processed);
     LOG_BLE("Failed operations: %lu\n", failed_operations_count);
     LOG_BLE("Success rate: %.1f%%\n", 
@@ -39,6 +39,8 @@ struct FileIORequest {
  * 
  * Responsibilities:
  * - Process flash operations (grind session logging)
+ * - Journal running grind sessions; a lower-priority committer task writes ended ones
+ *   from their PSRAM slots to flash
  * - Handle log message output to serial/BLE
  * - Manage preference/settings persistence
  * - Coordinate data export operations
@@ -54,6 +56,7 @@ class FileIOTask {
 private:
     // Task management
     TaskHandle_t task_handle;
+    TaskHandle_t commit_task_handle;         // Session committer, woken every FileIO cycle
     volatile bool task_running;
     
     // Inter-task communication
@@ -78,6 +81,18 @@ private:
     uint32_t preference_operations_processed;
     uint32_t data_export_operations_processed;
     
+    // Session commit statistics (sessions ended on Core 0, written by the committer task)
+    uint32_t session_commits;
+    uint32_t commit_cycles;                  // Committer wakeups sampled for slot occupancy
+    uint32_t commit_time_sum_ms;
+    uint32_t commit_time_max_ms;
+    uint32_t commit_latency_sum_ms;
+    uint32_t commit_latency_max_ms;
+    uint32_t slot_occupancy_sum;             // Occupied session slots summed per cycle
+    uint8_t slot_occupancy_peak;
+    uint32_t durable_latency_max_ms;         // End of grind until its journal END record was written
+    uint32_t journal_tail_max_bytes;         // Journal bytes left for the commit
+    
     // Static instance for task callback
     static FileIOTask* instance;
     
@@ -103,8 +118,9 @@ public:
     void print_performance_stats() const;
     void print_operation_stats() const;
     
-    // Static task wrapper
+    // Static task wrappers
     static void task_wrapper(void* parameter);
+    static void commit_task_wrapper(void* parameter);
     
     // Task implementation (public for TaskManager access)
     void task_impl();
@@ -117,6 +133,8 @@ private:
     void process_log_message(const LogMessage& message);
     void process_preference_write(const char* key, const char* value);
     void process_data_export(const char* export_path, uint32_t start_id, uint32_t end_id);
+    void commit_task_impl();
+    void commit_pending_sessions();
     
     // File system management
     void check_filesystem_health();
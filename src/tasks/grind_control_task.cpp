@@ -1,11 +1,14 @@
 #include "grind_control_task.h"
+#include "weight_sampling_task.h"
 #include "../controllers/grind_controller.h"
 #include "../hardware/WeightSensor.h"
 #include "../hardware/grinder.h"
 #include "../logging/grind_logging.h"
 #include "../config/constants.h"
+#include "../system/task_trace.h"
 #include <Arduino.h>
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
 
 // Global instance
 GrindControlTask grind_control_task;
@@ -28,6 +31,16 @@ GrindControlTask::GrindControlTask() {
     cycle_time_min_ms = UINT32_MAX;
     cycle_time_max_ms = 0;
     last_heartbeat_time = 0;
+    event_driven = false;
+    sample_wakeup_count = 0;
+    timer_wakeup_count = 0;
+    update_latency_count = 0;
+    update_latency_sum_us = 0;
+    update_latency_max_us = 0;
+    stop_latency_count = 0;
+    stop_latency_sum_us = 0;
+    stop_latency_max_us = 0;
+    stop_latency_last_us = 0;
     
     // Initialize grind state
     grind_active = false;
@@ -134,10 +147,28 @@ void GrindControlTask::task_impl() {
     
     // Reset performance metrics
     reset_performance_metrics();
+    stop_latency_count = 0;
+    stop_latency_sum_us = 0;
+    stop_latency_max_us = 0;
+    stop_latency_last_us = 0;
+    
+#if SYS_GRIND_CONTROL_EVENT_DRIVEN
+    // Run the controller as soon as a new sample is in the filters instead of on the next tick
+    weight_sampling_task.set_sample_listener(xTaskGetCurrentTaskHandle());
+    event_driven = true;
+#endif
+    LOG_BLE("GrindControlTask: %s wakeups\n", event_driven ? "Sample-driven" : "Fixed-interval");
+    
+    bool woken_by_sample = false;
     
     // Main grind control loop
     while (task_running) {
         uint32_t cycle_start_time = millis();
+        TRACE_BEGIN(TRACE_ID_GRIND_CONTROL);
+        
+        if (woken_by_sample) {
+            record_update_latency();
+        }
         
         // Update grind control logic
         update_grind_control();
@@ -149,12 +180,21 @@ void GrindControlTask::task_impl() {
         esp_task_wdt_reset();
         
         uint32_t cycle_end_time = millis();
+        TRACE_END(TRACE_ID_GRIND_CONTROL);
         
         // Record performance metrics
         record_timing(cycle_start_time, cycle_end_time);
         
-        // Use vTaskDelayUntil for predictable timing (eliminates busy-wait)
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        if (event_driven) {
+            woken_by_sample = wait_for_sample();
+        } else {
+            // Use vTaskDelayUntil for predictable timing (eliminates busy-wait)
+            vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        }
+    }
+    
+    if (event_driven) {
+        weight_sampling_task.set_sample_listener(nullptr);
     }
     
     // Remove task from watchdog monitoring before exit
@@ -167,11 +207,18 @@ void GrindControlTask::task_impl() {
 void GrindControlTask::update_grind_control() {
     if (!grind_controller) return;
     
+    // Only the predictive stop is decided on the newest sample; timeouts and cancels are not timed
+    uint32_t predictive_stops = grind_controller->get_predictive_stop_count();
+    
     // Execute main grind controller logic
     // This calls the existing GrindController::update() method which contains
     // all the grinding algorithms, state machine, and pulse control logic
     grind_controller->update();
     
+    if (grind_controller->get_predictive_stop_count() != predictive_stops) {
+        record_stop_latency();
+    }
+    
     // Update timing for performance tracking
     last_grind_update_time = millis();
 }
@@ -195,6 +242,20 @@ void GrindControlTask::monitor_grind_state() {
     }
 }
 
+bool GrindControlTask::wait_for_sample() {
+    // Motor-timing phases keep the fixed control interval as a fallback; elsewhere the
+    // timer only keeps the watchdog and UI handshakes moving when samples stop arriving
+    bool timed_phase = grind_controller && grind_controller->needs_timed_updates();
+    uint32_t timeout_ms = timed_phase ? SYS_TASK_GRIND_CONTROL_INTERVAL_MS : SYS_TASK_GRIND_CONTROL_FALLBACK_MS;
+    
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms)) > 0) {
+        sample_wakeup_count++;
+        return true;
+    }
+    timer_wakeup_count++;
+    return false;
+}
+
 bool GrindControlTask::validate_hardware_ready() const {
     bool grind_controller_ready = (grind_controller != nullptr);
     bool weight_sensor_ready = (weight_sensor != nullptr && weight_sensor->is_initialized());
@@ -244,6 +305,26 @@ void GrindControlTask::record_timing(uint32_t start_time, uint32_t end_time) {
 #endif
 }
 
+void GrindControlTask::record_update_latency() {
+    uint32_t latency_us = (uint32_t)esp_timer_get_time() - weight_sampling_task.get_last_sample_time_us();
+    update_latency_count++;
+    update_latency_sum_us += latency_us;
+    if (latency_us > update_latency_max_us) {
+        update_latency_max_us = latency_us;
+    }
+}
+
+void GrindControlTask::record_stop_latency() {
+    uint32_t latency_us = (uint32_t)esp_timer_get_time() - weight_sampling_task.get_last_sample_time_us();
+    stop_latency_count++;
+    stop_latency_sum_us += latency_us;
+    stop_latency_last_us = latency_us;
+    if (latency_us > stop_latency_max_us) {
+        stop_latency_max_us = latency_us;
+    }
+    LOG_GRIND_DEBUG("[GRIND_CONTROL] Predictive stop %luus after newest sample\n", latency_us);
+}
+
 void GrindControlTask::print_heartbeat() const {
 #if SYS_ENABLE_REALTIME_HEARTBEAT
     uint32_t avg_cycle_time = cycle_count > 0 ? cycle_time_sum_ms / cycle_count : 0;
@@ -251,8 +332,11 @@ void GrindControlTask::print_heartbeat() const {
     float current_weight = weight_sensor ? weight_sensor->get_weight_low_latency() : 0.0f;
     const char* grind_status = grind_active ? "ACTIVE" : "IDLE";
     
-    LOG_BLE("[%lums GRIND_CONTROL_HEARTBEAT] Cycles: %lu/10s | Avg: %lums (%lu-%lums) | Status: %s | Target: %.1fg | Current: %.3fg | Build: #%d\n",
+    uint32_t avg_update_latency_us = update_latency_count > 0 ? (uint32_t)(update_latency_sum_us / update_latency_count) : 0;
+    
+    LOG_BLE("[%lums GRIND_CONTROL_HEARTBEAT] Cycles: %lu/10s | Avg: %lums (%lu-%lums) | Wakes: %lu sample/%lu timer | Sample->update: %luus (max %luus) | Status: %s | Target: %.1fg | Current: %.3fg | Build: #%d\n",
            millis(), cycle_count, avg_cycle_time, cycle_time_min_ms, cycle_time_max_ms,
+           sample_wakeup_count, timer_wakeup_count, avg_update_latency_us, update_latency_max_us,
            grind_status, target_weight, current_weight, BUILD_NUMBER);
 #endif
 }
@@ -262,6 +346,11 @@ void GrindControlTask::reset_performance_metrics() {
     cycle_time_sum_ms = 0;
     cycle_time_min_ms = UINT32_MAX;
     cycle_time_max_ms = 0;
+    sample_wakeup_count = 0;
+    timer_wakeup_count = 0;
+    update_latency_count = 0;
+    update_latency_sum_us = 0;
+    update_latency_max_us = 0;
 }
 
 void GrindControlTask::print_performance_stats() const {
@@ -275,6 +364,18 @@ void GrindControlTask::print_performance_stats() const {
         LOG_BLE("Average cycle time: %lums (%lu-%lums)\n", avg_cycle_time, cycle_time_min_ms, cycle_time_max_ms);
     }
     
+    LOG_BLE("Wakeups: %s (%lu sample, %lu timer)\n", event_driven ? "sample-driven" : "fixed interval",
+            sample_wakeup_count, timer_wakeup_count);
+    if (update_latency_count > 0) {
+        LOG_BLE("Sample-to-update latency: avg %luus, max %luus (%lu updates)\n",
+                (uint32_t)(update_latency_sum_us / update_latency_count), update_latency_max_us, update_latency_count);
+    }
+    if (stop_latency_count > 0) {
+        LOG_BLE("Stop-decision latency: avg %luus, max %luus, last %luus (%lu predictive stops)\n",
+                (uint32_t)(stop_latency_sum_us / stop_latency_count), stop_latency_max_us,
+                stop_latency_last_us, stop_latency_count);
+    }
+    
     if (grind_active) {
         LOG_BLE("Current grind duration: %lums\n", get_grind_duration_ms());
     }
@@ -25,7 +25,9 @@ class GrindLogger;
  * 
  * Architecture:
  * - Runs on Core 0 at high priority (3)
- * - Uses vTaskDelayUntil for predictable timing
+ * - Event-driven (SYS_GRIND_CONTROL_EVENT_DRIVEN): woken by WeightSamplingTask after every
+ *   fed sample, with the control interval as fallback timer in motor-timing phases
+ * - Otherwise uses vTaskDelayUntil for predictable timing
  * - Thread-safe coordination with weight sampling
  * - Real-time grind control without file I/O blocking
  */
@@ -48,6 +50,20 @@ private:
     uint32_t cycle_time_max_ms;
     uint32_t last_heartbeat_time;
     
+    // Wakeup source and sample-to-update latency (event-driven mode)
+    bool event_driven;
+    uint32_t sample_wakeup_count;
+    uint32_t timer_wakeup_count;
+    uint32_t update_latency_count;
+    uint64_t update_latency_sum_us;
+    uint32_t update_latency_max_us;
+    
+    // Newest sample to the predictive motor stop command (kept across heartbeats)
+    uint32_t stop_latency_count;
+    uint64_t stop_latency_sum_us;
+    uint32_t stop_latency_max_us;
+    uint32_t stop_latency_last_us;
+    
     // Grind control state
     bool grind_active;
     uint32_t grind_start_time;
@@ -74,6 +90,7 @@ public:
     
     // Performance monitoring
     uint32_t get_cycle_count() const { return cycle_count; }
+    bool is_event_driven() const { return event_driven; }
     void print_performance_stats() const;
     
     // Static task wrapper
@@ -90,9 +107,12 @@ private:
     // Grind control coordination
     void update_grind_control();
     void monitor_grind_state();
+    bool wait_for_sample();
     
     // Performance tracking
     void record_timing(uint32_t start_time, uint32_t end_time);
+    void record_update_latency();
+    void record_stop_latency();
     void print_heartbeat() const;
     void reset_performance_metrics();
     
@@ -12,6 +12,7 @@
 #include "../hardware/grinder.h"
 #include "../logging/grind_logging.h"
 #include "../config/constants.h"
+#include "../system/task_trace.h"
 #include <esp_task_wdt.h>
 #include <Arduino.h>
 
@@ -120,6 +121,9 @@ void TaskManager::cleanup_queues() {
 }
 
 bool TaskManager::create_all_tasks() {
+    // Before the tasks start so their first cycles are recorded
+    task_trace_init();
+    
     // Create tasks in order of priority (highest to lowest)
     
     if (!create_weight_sampling_task()) {
@@ -478,41 +482,69 @@ void TaskManager::grind_control_task_impl() {
 void TaskManager::ui_render_task_impl() {
     TickType_t xLastWakeTime = xTaskGetTickCount();
     const TickType_t xFrequency = pdMS_TO_TICKS(SYS_TASK_UI_INTERVAL_MS);
+    UIState last_state = state_machine ? state_machine->get_current_state() : UIState::READY;
     
     LOG_BLE("UI Render Task started on Core %d\n", xPortGetCoreID());
     
     while (true) {
         uint32_t start_time = millis();
+        bool activity = false;
+        TRACE_BEGIN(TRACE_ID_UI_RENDER);
 
         // Process queued UI events from Core 0 here to ensure
         // all LVGL interactions happen on the UI task context
         if (grind_controller) {
-            grind_controller->process_queued_ui_events();
+            activity |= grind_controller->process_queued_ui_events();
         }
 
-        // UI rendering separated from touch handling
-        // Process touch events from TouchInputTask queue
-        // TODO: Process touch events from queue and update UI
-
-        // UI logic and display updates (separated from touch input)
-        if (ui_manager) {
-            // Drain BLE UI status messages here to keep LVGL single-threaded
-            if (bluetooth_manager) {
-                char status[64];
-                auto* ota = ui_manager->get_ota_data_export_controller();
-                while (ota && bluetooth_manager->dequeue_ui_status(status, sizeof(status))) {
-                    ota->update_status(status);
-                }
+        // Drain BLE UI status messages here to keep LVGL single-threaded
+        if (ui_manager && bluetooth_manager) {
+            char status[64];
+            auto* ota = ui_manager->get_ota_data_export_controller();
+            while (ota && bluetooth_manager->dequeue_ui_status(status, sizeof(status))) {
+                ota->update_status(status);
+                activity = true;
             }
-            ui_manager->update();
         }
-        
-        // LVGL processing and display update - this contains lv_timer_handler()
-        if (hardware_manager) {
-            hardware_manager->get_display()->update();
+
+        // Touch is polled every tick so a press is never throttled, even on idle screens
+        DisplayManager* display = hardware_manager ? hardware_manager->get_display() : nullptr;
+        if (display && display->poll_touch()) {
+            activity = true;
+        }
+
+        if (state_machine) {
+            UIState state = state_machine->get_current_state();
+            if (state != last_state || state == UIState::GRINDING || state == UIState::AUTOTUNING) {
+                activity = true;
+            }
+            last_state = state;
+        }
+
+        if (lv_anim_count_running() > 0) {
+            activity = true;
+        }
+
+        if (activity) {
+            ui_governor.mark_active(start_time);
+        }
+
+        // UI logic and LVGL processing (lv_timer_handler) at the governed rate
+        if (ui_governor.should_render(start_time)) {
+            uint32_t frame_start_us = micros();
+            TRACE_BEGIN(TRACE_ID_UI_FRAME);
+            if (ui_manager) {
+                ui_manager->update();
+            }
+            if (display) {
+                display->render();
+            }
+            TRACE_END(TRACE_ID_UI_FRAME);
+            ui_governor.record_frame(millis(), micros() - frame_start_us);
         }
         
         uint32_t end_time = millis();
+        TRACE_END(TRACE_ID_UI_RENDER);
         record_task_timing(2, start_time, end_time); // Task index 2 for UI render
         
         // Use vTaskDelayUntil for predictable timing
@@ -529,6 +561,7 @@ void TaskManager::bluetooth_task_impl() {
     
     while (true) {
         uint32_t start_time = millis();
+        TRACE_BEGIN(TRACE_ID_BLUETOOTH);
         
         // Use existing bluetooth manager handle method
         if (bluetooth_manager) {
@@ -540,6 +573,7 @@ void TaskManager::bluetooth_task_impl() {
         }
         
         uint32_t end_time = millis();
+        TRACE_END(TRACE_ID_BLUETOOTH);
         record_task_timing(4, start_time, end_time); // Task index 4 for bluetooth
         
         // Use vTaskDelayUntil for predictable timing
@@ -573,6 +607,10 @@ void TaskManager::record_task_timing(int task_index, uint32_t start_time, uint32
     if (end_time - metrics.last_heartbeat_time >= SYS_REALTIME_HEARTBEAT_INTERVAL_MS) {
         const char* task_names[] = {"WeightSampling", "GrindControl", "UIRender", "Bluetooth", "FileIO"};
         print_task_heartbeat(task_index, task_names[task_index]);
+        if (task_index == 2) {
+            print_display_heartbeat();
+            print_ui_frame_heartbeat();
+        }
         
         // Reset metrics
         metrics.cycle_count = 0;
@@ -595,6 +633,36 @@ void TaskManager::print_task_heartbeat(int task_index, const char* task_name) co
 #endif
 }
 
+void TaskManager::print_display_heartbeat() {
+#if SYS_ENABLE_REALTIME_HEARTBEAT
+    if (!hardware_manager) return;
+    DisplayMetrics display = hardware_manager->get_display()->take_metrics();
+    uint32_t avg_frame_us = display.frames > 0 ? display.frame_us_sum / display.frames : 0;
+    uint32_t avg_render_us = display.renders > 0 ? display.render_us_sum / display.renders : 0;
+    uint32_t avg_flush_us = display.strips > 0 ? display.flush_us_sum / display.strips : 0;
+    
+    // Frame = refresh start to last strip on the panel; render includes the flushes
+    LOG_BLE("[%lums TASK_HEARTBEAT_Display] Frames: %lu/10s | Frame: %luus (max %lu) | Render: %luus | Flush: %lu strips, %luus (max %lu)\n",
+           millis(), display.frames, avg_frame_us, display.frame_us_max, avg_render_us,
+           display.strips, avg_flush_us, display.flush_us_max);
+#endif
+}
+
+void TaskManager::print_ui_frame_heartbeat() {
+#if SYS_ENABLE_REALTIME_HEARTBEAT
+    uint32_t now = millis();
+    FrameGovernorStats frames = ui_governor.take_stats(now);
+    uint32_t fps_x10 = frames.window_ms > 0 ? (uint32_t)((uint64_t)frames.frames * 10000 / frames.window_ms) : 0;
+    uint32_t avg_frame_us = frames.frames > 0 ? frames.frame_us_sum / frames.frames : 0;
+    
+    // Cost = UI logic + lv_timer_handler(); skipped ticks only polled touch and the event queues
+    LOG_BLE("[%lums TASK_HEARTBEAT_UIFrames] FPS: %lu.%lu (%lu frames, %lu full rate) | Skipped: %lu/%lu ticks | Cost: %luus (max %lu) | Mode: %s\n",
+           now, fps_x10 / 10, fps_x10 % 10, frames.frames, frames.active_frames,
+           frames.skipped, frames.ticks, avg_frame_us, frames.frame_us_max,
+           ui_governor.is_active(now) ? "active" : "idle");
+#endif
+}
+
 bool TaskManager::are_tasks_healthy() const {
     return tasks_initialized && 
            task_handles.weight_sampling_task && 
@@ -4,6 +4,7 @@
 #include <freertos/task.h>
 #include <freertos/queue.h>
 #include "../config/constants.h"
+#include "../ui/frame_governor.h"
 
 // Forward declarations
 class HardwareManager;
@@ -73,6 +74,7 @@ private:
     
     // Task monitoring
     TaskMetrics task_metrics[5]; // One for each task
+    FrameGovernor ui_governor;   // UI task only
     bool tasks_initialized;
     bool ota_suspended;
     TaskHandle_t ota_watchdog_task;
@@ -133,6 +135,8 @@ private:
     // Performance monitoring
     void record_task_timing(int task_index, uint32_t start_time, uint32_t end_time);
     void print_task_heartbeat(int task_index, const char* task_name) const;
+    void print_display_heartbeat();
+    void print_ui_frame_heartbeat();
     
     // Task validation
     bool validate_hardware_ready() const;
@@ -2,8 +2,10 @@
 #include "../hardware/WeightSensor.h"
 #include "../logging/grind_logging.h"
 #include "../config/constants.h"
+#include "../system/task_trace.h"
 #include <Arduino.h>
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
 
 // Global instance
 WeightSamplingTask weight_sampling_task;
@@ -23,6 +25,12 @@ WeightSamplingTask::WeightSamplingTask() {
     cycle_time_min_ms = UINT32_MAX;
     cycle_time_max_ms = 0;
     last_heartbeat_time = 0;
+    event_driven = false;
+    sample_latency_count = 0;
+    sample_latency_sum_us = 0;
+    sample_latency_max_us = 0;
+    sample_listener = nullptr;
+    last_sample_time_us = 0;
     
     // Initialize hardware state
     hardware_initialized = false;
@@ -135,9 +143,14 @@ void WeightSamplingTask::task_impl() {
     // Reset performance metrics
     reset_performance_metrics();
     
+    // Let the driver wake us per conversion; without it the loop polls as before
+    event_driven = weight_sensor && weight_sensor->set_data_ready_task(xTaskGetCurrentTaskHandle());
+    LOG_BLE("WeightSamplingTask: %s acquisition\n", event_driven ? "Interrupt-driven" : "Polled");
+    
     // Main sampling loop
     while (task_running) {
         uint32_t cycle_start_time = millis();
+        TRACE_BEGIN(TRACE_ID_WEIGHT_SAMPLING);
         
         // Core sampling operations (extracted from RealtimeController)
         sample_and_feed_weight_sensor();
@@ -151,12 +164,22 @@ void WeightSamplingTask::task_impl() {
         esp_task_wdt_reset();
         
         uint32_t cycle_end_time = millis();
+        TRACE_END(TRACE_ID_WEIGHT_SAMPLING);
         
         // Record performance metrics
         record_timing(cycle_start_time, cycle_end_time);
         
-        // Use vTaskDelayUntil for predictable timing (eliminates busy-wait)
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        if (event_driven) {
+            // Sleep until the DOUT interrupt; the timeout keeps update() and the watchdog running
+            ulTaskNotifyTake(pdTRUE, xFrequency);
+        } else {
+            // Use vTaskDelayUntil for predictable timing (eliminates busy-wait)
+            vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        }
+    }
+    
+    if (weight_sensor) {
+        weight_sensor->set_data_ready_task(nullptr);
     }
     
     // Mark hardware as no longer initialized
@@ -254,14 +277,43 @@ void WeightSamplingTask::sample_and_feed_weight_sensor() {
     // Call WeightSensor's Core 0 sampling method - this performs HX711 sampling
     // and feeds data to CircularBufferMath, updating all weight readings
     // (Extracted from RealtimeController::sample_and_feed_weight_sensor)
-    bool sample_taken = weight_sensor->sample_and_feed_filter();
-    
+    // Drain everything the driver buffered since the last wake (normally one sample)
+    uint8_t samples_fed = 0;
+    for (uint8_t i = 0; i < HW_LOADCELL_SAMPLE_RING_SIZE; i++) {
+        bool sample_taken = weight_sensor->sample_and_feed_filter();
+        if (!sample_taken) break;
+        
+        samples_fed++;
+        record_sample_latency();
 #if SYS_ENABLE_REALTIME_HEARTBEAT
-    // Record timestamp for SPS tracking when a sample was actually taken
-    if (sample_taken) {
+        // Record timestamp for SPS tracking when a sample was actually taken
         weight_sensor->record_sample_timestamp();
-    }
 #endif
+    }
+    
+    if (samples_fed == 0) return;
+    
+    // Drivers without conversion timestamps report the time the sample was fed
+    uint64_t sample_time_us = weight_sensor->get_last_sample_timestamp_us();
+    last_sample_time_us = (uint32_t)(sample_time_us != 0 ? sample_time_us : esp_timer_get_time());
+    
+    TaskHandle_t listener = sample_listener;
+    if (listener) {
+        xTaskNotifyGive(listener);
+        TRACE_INSTANT(TRACE_ID_SAMPLE_NOTIFY, samples_fed);
+    }
+}
+
+void WeightSamplingTask::record_sample_latency() {
+    uint64_t sample_time_us = weight_sensor->get_last_sample_timestamp_us();
+    if (sample_time_us == 0) return; // Driver does not timestamp conversions
+    
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - sample_time_us);
+    sample_latency_count++;
+    sample_latency_sum_us += latency_us;
+    if (latency_us > sample_latency_max_us) {
+        sample_latency_max_us = latency_us;
+    }
 }
 
 bool WeightSamplingTask::validate_hardware_ready() const {
@@ -308,10 +360,12 @@ void WeightSamplingTask::print_heartbeat() const {
     int current_sample_count = weight_sensor ? weight_sensor->get_sample_count() : 0;
     int32_t raw_reading = weight_sensor ? weight_sensor->get_raw_adc_instant() : 0;
     
-    LOG_BLE("[%lums WEIGHT_SAMPLING_HEARTBEAT] Cycles: %lu/10s | Avg: %lums (%lu-%lums) | Weight: %.3fg | Raw: %ld | SPS: %.1f | Samples: %d | Build: #%d\n",
+    uint32_t avg_latency_us = sample_latency_count > 0 ? (uint32_t)(sample_latency_sum_us / sample_latency_count) : 0;
+    
+    LOG_BLE("[%lums WEIGHT_SAMPLING_HEARTBEAT] Cycles: %lu/10s | Avg: %lums (%lu-%lums) | Weight: %.3fg | Raw: %ld | SPS: %.1f | Samples: %d | Latency: %luus (max %luus) | Build: #%d\n",
            millis(), cycle_count, avg_cycle_time, cycle_time_min_ms, cycle_time_max_ms,
            weight_sensor ? weight_sensor->get_weight_low_latency() : 0.0f,
-           (long)raw_reading, current_sps, current_sample_count, BUILD_NUMBER);
+           (long)raw_reading, current_sps, current_sample_count, avg_latency_us, sample_latency_max_us, BUILD_NUMBER);
 #endif
 }
 
@@ -320,6 +374,9 @@ void WeightSamplingTask::reset_performance_metrics() {
     cycle_time_sum_ms = 0;
     cycle_time_min_ms = UINT32_MAX;
     cycle_time_max_ms = 0;
+    sample_latency_count = 0;
+    sample_latency_sum_us = 0;
+    sample_latency_max_us = 0;
 }
 
 float WeightSamplingTask::get_current_sps() const {
@@ -331,6 +388,7 @@ void WeightSamplingTask::print_performance_stats() const {
     LOG_BLE("Task running: %s\n", task_running ? "YES" : "NO");
     LOG_BLE("Hardware initialized: %s\n", hardware_initialized ? "YES" : "NO");
     LOG_BLE("Hardware validation passed: %s\n", hardware_validation_passed ? "YES" : "NO");
+    LOG_BLE("Acquisition: %s\n", event_driven ? "interrupt-driven" : "polled");
     LOG_BLE("Current SPS: %.1f\n", get_current_sps());
     LOG_BLE("Cycle count: %lu\n", cycle_count);
     
@@ -338,6 +396,10 @@ void WeightSamplingTask::print_performance_stats() const {
         uint32_t avg_cycle_time = cycle_time_sum_ms / cycle_count;
         LOG_BLE("Average cycle time: %lums (%lu-%lums)\n", avg_cycle_time, cycle_time_min_ms, cycle_time_max_ms);
     }
+    if (sample_latency_count > 0) {
+        LOG_BLE("Conversion-to-filter latency: avg %luus, max %luus (%lu samples)\n",
+                (uint32_t)(sample_latency_sum_us / sample_latency_count), sample_latency_max_us, sample_latency_count);
+    }
     LOG_BLE("====================================\n");
 }
 
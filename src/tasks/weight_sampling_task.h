@@ -15,15 +15,18 @@ class GrindLogger;
  * that handles ONLY weight sensor sampling operations.
  * 
  * Responsibilities:
- * - Non-blocking HX711 sampling (polling at fixed rate; sensor delivers at HW rate)
- * - Feed data to CircularBufferMath filters
+ * - Non-blocking HX711 sampling: woken by the driver's DOUT interrupt when it supports
+ *   one (HW_LOADCELL_IRQ_ACQUISITION), otherwise polling at a fixed rate
+ * - Feed data to CircularBufferMath filters and notify the grind control task
  * - Hardware initialization on Core 0
  * - SPS performance monitoring
  * - Hardware validation and error recovery
  * 
  * Architecture:
  * - Runs on Core 0 at highest priority (4)
- * - Uses vTaskDelayUntil for predictable timing
+ * - Event-driven: blocks on a task notification with the polling interval as timeout,
+ *   so update() and the watchdog keep their cadence without samples
+ * - Polling: uses vTaskDelayUntil for predictable timing
  * - Thread-safe access to weight sensor hardware
  * - No file I/O or blocking operations
  */
@@ -44,6 +47,16 @@ private:
     uint32_t cycle_time_max_ms;
     uint32_t last_heartbeat_time;
     
+    // Conversion-to-filter latency (timestamped drivers only)
+    bool event_driven;
+    uint32_t sample_latency_count;
+    uint64_t sample_latency_sum_us;
+    uint32_t sample_latency_max_us;
+    
+    // Control task woken after every fed sample (SYS_GRIND_CONTROL_EVENT_DRIVEN)
+    volatile TaskHandle_t sample_listener;
+    volatile uint32_t last_sample_time_us;   // Conversion time of the newest fed sample (low 32 bits)
+    
     // Hardware state
     bool hardware_initialized;
     bool hardware_validation_passed;
@@ -67,6 +80,11 @@ public:
     // Performance monitoring
     float get_current_sps() const;
     uint32_t get_cycle_count() const { return cycle_count; }
+    bool is_event_driven() const { return event_driven; }
+    
+    // Sample notifications - the listener gets a task notification per batch of fed samples
+    void set_sample_listener(TaskHandle_t task) { sample_listener = task; }
+    uint32_t get_last_sample_time_us() const { return last_sample_time_us; }
     void print_performance_stats() const;
     
     // Static task wrapper
@@ -86,6 +104,7 @@ private:
     
     // Performance tracking
     void record_timing(uint32_t start_time, uint32_t end_time);
+    void record_sample_latency();
     void print_heartbeat() const;
     void reset_performance_metrics();
     
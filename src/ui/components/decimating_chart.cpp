@@ -0,0 +1,204 @@
+#include "decimating_chart.h"
+#include <algorithm>
+#include <cstring>
+
+lv_obj_t* DecimatingChart::create(lv_obj_t* parent, int32_t height) {
+    obj = lv_obj_create(parent);
+    lv_obj_set_size(obj, LV_PCT(100), height);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(obj, draw_cb, LV_EVENT_DRAW_MAIN, this);
+    lv_obj_add_event_cb(obj, size_changed_cb, LV_EVENT_SIZE_CHANGED, this);
+
+    for (uint8_t s = 0; s < SERIES_COUNT; s++) {
+        colors[s] = lv_color_white();
+    }
+    clear();
+    return obj;
+}
+
+void DecimatingChart::set_series_color(uint8_t series, lv_color_t color) {
+    if (series >= SERIES_COUNT) return;
+    colors[series] = color;
+    if (obj) lv_obj_invalidate(obj);
+}
+
+void DecimatingChart::set_line_width(uint8_t width) {
+    line_width = width > 0 ? width : 1;
+    if (obj) lv_obj_invalidate(obj);
+}
+
+void DecimatingChart::set_range(uint8_t series, int32_t max_value) {
+    if (series >= SERIES_COUNT) return;
+    max_value = std::max<int32_t>(max_value, 1);
+    if (range_max[series] == max_value) return;
+
+    range_max[series] = max_value;
+    // Stored values are unscaled - the new range is applied by the next draw
+    if (obj && last_column >= 0) lv_obj_invalidate(obj);
+}
+
+void DecimatingChart::set_window(uint32_t points) {
+    points = std::max<uint32_t>(points, 1);
+    if (points == window) return;
+    window = points;
+    clear();
+}
+
+void DecimatingChart::clear() {
+    bool had_data = last_column >= 0;
+    memset(columns, 0, sizeof(columns));
+    last_column = -1;
+    point_count = 0;
+    if (obj && had_data) lv_obj_invalidate(obj);
+}
+
+void DecimatingChart::add_point(const int32_t values[SERIES_COUNT]) {
+    if (!obj) return;
+    if (column_count == 0) {
+        lv_obj_update_layout(obj);
+        update_column_count();
+        if (column_count == 0) return;
+    }
+
+    if (point_count >= window) {
+        compact();
+    }
+
+    int16_t clamped[SERIES_COUNT];
+    for (uint8_t s = 0; s < SERIES_COUNT; s++) {
+        clamped[s] = (int16_t)std::min<int32_t>(std::max<int32_t>(values[s], INT16_MIN), INT16_MAX);
+    }
+
+    int32_t column = (int32_t)((uint64_t)point_count * column_count / window);
+    point_count++;
+
+    // Fewer points than columns: interpolate across the skipped columns so the line stays joined
+    int32_t first = column;
+    if (last_column >= 0 && column > last_column + 1) {
+        const Column& from = columns[last_column];
+        int32_t span = column - last_column;
+        for (int32_t c = last_column + 1; c < column; c++) {
+            int16_t interpolated[SERIES_COUNT];
+            for (uint8_t s = 0; s < SERIES_COUNT; s++) {
+                interpolated[s] = (int16_t)(from.last[s] + (clamped[s] - from.last[s]) * (c - last_column) / span);
+            }
+            fill_column((uint16_t)c, interpolated);
+        }
+        first = last_column + 1;
+    }
+
+    fill_column((uint16_t)column, clamped);
+    last_column = column;
+    invalidate_columns(first, column);
+}
+
+void DecimatingChart::fill_column(uint16_t column, const int16_t values[SERIES_COUNT]) {
+    Column& col = columns[column];
+    for (uint8_t s = 0; s < SERIES_COUNT; s++) {
+        if (!col.used) {
+            col.min[s] = values[s];
+            col.max[s] = values[s];
+        } else {
+            col.min[s] = std::min(col.min[s], values[s]);
+            col.max[s] = std::max(col.max[s], values[s]);
+        }
+        col.last[s] = values[s];
+    }
+    col.used = true;
+}
+
+// The grind ran past the predicted window - halve the time resolution
+void DecimatingChart::compact() {
+    for (uint16_t c = 0; c < column_count; c++) {
+        uint16_t a = c * 2;
+        uint16_t b = a + 1;
+        Column merged = {};
+        if (a < column_count && columns[a].used) {
+            merged = columns[a];
+        }
+        if (b < column_count && columns[b].used) {
+            const Column& second = columns[b];
+            for (uint8_t s = 0; s < SERIES_COUNT; s++) {
+                merged.min[s] = merged.used ? std::min(merged.min[s], second.min[s]) : second.min[s];
+                merged.max[s] = merged.used ? std::max(merged.max[s], second.max[s]) : second.max[s];
+                merged.last[s] = second.last[s];
+            }
+            merged.used = true;
+        }
+        columns[c] = merged;
+    }
+    window *= 2;
+    last_column = last_column >= 0 ? last_column / 2 : -1;
+    lv_obj_invalidate(obj);
+}
+
+void DecimatingChart::invalidate_columns(int32_t first, int32_t last) {
+    lv_area_t content;
+    lv_obj_get_content_coords(obj, &content);
+    int32_t half = line_width / 2;
+
+    lv_area_t area;
+    area.x1 = content.x1 + first - half;
+    area.x2 = content.x1 + last + half;
+    area.y1 = content.y1;
+    area.y2 = content.y2;
+    lv_obj_invalidate_area(obj, &area);
+}
+
+void DecimatingChart::update_column_count() {
+    int32_t width = lv_obj_get_content_width(obj);
+    uint16_t count = (uint16_t)std::min<int32_t>(std::max<int32_t>(width, 0), HW_DISPLAY_WIDTH_PX);
+    if (count != column_count) {
+        column_count = count;
+        clear();
+    }
+}
+
+void DecimatingChart::size_changed_cb(lv_event_t* e) {
+    static_cast<DecimatingChart*>(lv_event_get_user_data(e))->update_column_count();
+}
+
+void DecimatingChart::draw_cb(lv_event_t* e) {
+    static_cast<DecimatingChart*>(lv_event_get_user_data(e))->draw(lv_event_get_layer(e));
+}
+
+void DecimatingChart::draw(lv_layer_t* layer) {
+    if (last_column < 0) return;
+
+    lv_area_t content;
+    lv_obj_get_content_coords(obj, &content);
+    int32_t height = lv_area_get_height(&content);
+    int32_t half = line_width / 2;
+
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_opa = LV_OPA_COVER;
+
+    // One vertical span per column: its own min..max, joined to the previous column's last value.
+    // LVGL drops the spans outside the invalidated area.
+    for (uint8_t s = 0; s < SERIES_COUNT; s++) {
+        dsc.bg_color = colors[s];
+        int32_t range = range_max[s];
+
+        for (int32_t c = 0; c <= last_column; c++) {
+            const Column& col = columns[c];
+            if (!col.used) continue;
+
+            int32_t low = col.min[s];
+            int32_t high = col.max[s];
+            if (c > 0 && columns[c - 1].used) {
+                low = std::min<int32_t>(low, columns[c - 1].last[s]);
+                high = std::max<int32_t>(high, columns[c - 1].last[s]);
+            }
+            low = std::min(std::max<int32_t>(low, 0), range);
+            high = std::min(std::max<int32_t>(high, 0), range);
+
+            lv_area_t area;
+            area.x1 = std::max(content.x1 + c - half, content.x1);
+            area.x2 = std::min(content.x1 + c + half, content.x2);
+            area.y1 = std::max(content.y2 - high * (height - 1) / range - half, content.y1);
+            area.y2 = std::min(content.y2 - low * (height - 1) / range + half, content.y2);
+            lv_draw_rect(layer, &dsc, &area);
+        }
+    }
+}
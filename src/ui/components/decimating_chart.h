@@ -0,0 +1,63 @@
+#pragma once
+#include <lvgl.h>
+#include <stdint.h>
+#include "../../config/constants.h"
+
+/*
+ * DecimatingChart - line chart drawn from per-pixel-column min/max values
+ *
+ * Replaces lv_chart for the live grind plot. Each content column keeps the min, max and last
+ * value of every series that landed on it, so a new point only invalidates the few columns it
+ * touches instead of the whole widget, and drawing costs one rect per column and series no
+ * matter how many points were added.
+ *
+ * The X axis spans `window` points. When a grind runs past it the window doubles and column
+ * pairs merge (one full redraw), instead of shifting every pixel on every point. Y ranges are
+ * only applied when drawing, so changing them never touches the stored data.
+ */
+class DecimatingChart {
+public:
+    static const uint8_t SERIES_COUNT = 2;
+
+    lv_obj_t* create(lv_obj_t* parent, int32_t height);
+    lv_obj_t* get_obj() const { return obj; }
+
+    void set_series_color(uint8_t series, lv_color_t color);
+    void set_line_width(uint8_t width);
+
+    // Values map 0..max_value onto the content height; takes effect on the next redraw
+    void set_range(uint8_t series, int32_t max_value);
+
+    // Number of points spread across the width. Changing it clears the chart.
+    void set_window(uint32_t points);
+    uint32_t get_window() const { return window; }
+
+    void add_point(const int32_t values[SERIES_COUNT]);
+    void clear();
+
+private:
+    struct Column {
+        int16_t min[SERIES_COUNT];
+        int16_t max[SERIES_COUNT];
+        int16_t last[SERIES_COUNT];
+        bool used;
+    };
+
+    static void draw_cb(lv_event_t* e);
+    static void size_changed_cb(lv_event_t* e);
+    void draw(lv_layer_t* layer);
+    void update_column_count();
+    void fill_column(uint16_t column, const int16_t values[SERIES_COUNT]);
+    void compact();
+    void invalidate_columns(int32_t first, int32_t last);
+
+    lv_obj_t* obj = nullptr;
+    Column columns[HW_DISPLAY_WIDTH_PX];
+    uint16_t column_count = 0;
+    int32_t last_column = -1;                 // Column of the newest point, -1 when empty
+    uint32_t window = 1;
+    uint32_t point_count = 0;                 // Points added since the last clear
+    int32_t range_max[SERIES_COUNT] = {1, 1};
+    lv_color_t colors[SERIES_COUNT];
+    uint8_t line_width = 3;
+};
@@ -77,7 +77,7 @@ void CalibrationUIController::update() {
         float weight = ui_manager_->get_hardware_manager()->get_weight_sensor()->get_display_weight();
         ui_manager_->calibration_screen.update_current_weight(weight);
     } else {
-        int32_t raw_reading = ui_manager_->get_hardware_manager()->get_weight_sensor()->get_raw_adc_instant();
+        int32_t raw_reading = ui_manager_->get_hardware_manager()->get_weight_sensor()->get_snapshot().raw_instant;
         ui_manager_->calibration_screen.update_current_weight(static_cast<float>(raw_reading));
 
         // In weight step, verify user has placed weight on scale
@@ -102,7 +102,7 @@ void CalibrationUIController::handle_ok() {
         case CAL_STEP_EMPTY:
             UIOperations::execute_tare(ui_manager_->get_hardware_manager(), [this]() {
                 // Capture baseline ADC value after taring
-                baseline_adc_value_ = ui_manager_->get_hardware_manager()->get_weight_sensor()->get_raw_adc_instant();
+                baseline_adc_value_ = ui_manager_->get_hardware_manager()->get_weight_sensor()->get_snapshot().raw_instant;
                 ui_manager_->calibration_screen.set_step(CAL_STEP_WEIGHT);
                 if (ui_manager_) {
                     ui_manager_->refresh_auto_action_settings();
@@ -227,7 +227,7 @@ void CalibrationUIController::update_noise_check() {
     constexpr unsigned long kForceEnableMs = 15000;
 
     unsigned long now = millis();
-    float std_dev = weight_sensor->get_standard_deviation_g(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
+    float std_dev = weight_sensor->get_snapshot().std_dev_g;
     ui_manager_->calibration_screen.update_noise_metric(std_dev);
 
     bool noise_ok = weight_sensor->noise_level_diagnostic();
@@ -49,6 +49,7 @@ void MenuUIController::register_events() {
     EventBridgeLVGL::register_handler(ET::GRIND_MODE_RADIO_BUTTON, [this](lv_event_t*) { handle_grind_mode_radio_button(); });
     EventBridgeLVGL::register_handler(ET::AUTO_START_TOGGLE, [this](lv_event_t*) { handle_auto_start_toggle(); });
     EventBridgeLVGL::register_handler(ET::AUTO_RETURN_TOGGLE, [this](lv_event_t*) { handle_auto_return_toggle(); });
+    EventBridgeLVGL::register_handler(ET::STOP_PLANNER_TOGGLE, [this](lv_event_t*) { handle_stop_planner_toggle(); });
     EventBridgeLVGL::register_handler(ET::GRINDER_PURGE_MODE_RADIO_BUTTON, [this](lv_event_t*) { handle_grinder_purge_mode_radio_button(); });
     EventBridgeLVGL::register_handler(ET::GRINDER_PURGE_AMOUNT_SLIDER, [this](lv_event_t*) { handle_grinder_purge_amount_slider(); });
     EventBridgeLVGL::register_handler(ET::GRINDER_PURGE_AMOUNT_SLIDER_RELEASED, [this](lv_event_t*) { handle_grinder_purge_amount_slider_released(); });
@@ -381,6 +382,24 @@ void MenuUIController::handle_auto_return_toggle() {
     LOG_DEBUG_PRINTLN(enabled ? "Auto return on cup removal enabled" : "Auto return on cup removal disabled");
 }
 
+void MenuUIController::handle_stop_planner_toggle() {
+    if (!ui_manager_) return;
+
+    auto* toggle = ui_manager_->menu_screen.get_stop_planner_toggle();
+    if (!toggle) return;
+
+    bool learned = lv_obj_has_state(toggle, LV_STATE_CHECKED);
+    StopPlannerType planner = learned ? StopPlannerType::MODEL : StopPlannerType::COAST_RATIO;
+
+    auto* hardware = ui_manager_->get_hardware_manager();
+    Preferences* prefs = hardware ? hardware->get_preferences() : nullptr;
+    if (prefs) {
+        prefs->putInt(GrindController::PREF_KEY_STOP_PLANNER, static_cast<int>(planner));
+    }
+
+    LOG_DEBUG_PRINTLN(learned ? "Stop planner: learned model" : "Stop planner: coast ratio");
+}
+
 void MenuUIController::handle_grinder_purge_mode_radio_button() {
     if (!ui_manager_) return;
 
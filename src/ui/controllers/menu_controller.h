@@ -28,6 +28,7 @@ public:
     void handle_grind_mode_radio_button();
     void handle_auto_start_toggle();
     void handle_auto_return_toggle();
+    void handle_stop_planner_toggle();
     void handle_grinder_purge_mode_radio_button();
     void handle_grinder_purge_amount_slider();
     void handle_grinder_purge_amount_slider_released();
@@ -44,9 +44,9 @@ void ScreenTimeoutController::update() {
 
     uint32_t ms_since_touch = touch_driver->get_ms_since_last_touch();
     auto* sensor = hardware->get_weight_sensor();
-    bool recent_weight_activity = sensor &&
-                                  sensor->weight_range_exceeds(USER_SCREEN_AUTO_DIM_TIMEOUT_MS,
-                                                               USER_WEIGHT_ACTIVITY_THRESHOLD_G);
+    uint32_t last_weight_activity_ms = sensor ? sensor->get_snapshot().last_activity_ms : 0;
+    bool recent_weight_activity = last_weight_activity_ms != 0 &&
+                                  (millis() - last_weight_activity_ms) < USER_SCREEN_AUTO_DIM_TIMEOUT_MS;
 
     bool should_dim = (ms_since_touch >= USER_SCREEN_AUTO_DIM_TIMEOUT_MS) && !recent_weight_activity;
 
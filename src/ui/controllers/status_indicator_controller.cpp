@@ -3,6 +3,7 @@
 #include "../../config/constants.h"
 #include "../../system/diagnostics_controller.h"
 #include "../ui_manager.h"
+#include "../ui_helpers.h"
 
 StatusIndicatorController::StatusIndicatorController(UIManager* manager)
     : ui_manager_(manager) {}
@@ -50,13 +51,12 @@ void StatusIndicatorController::update_ble_status_icon() {
 
     auto* bluetooth = ui_manager_->bluetooth_manager;
     if (bluetooth && bluetooth->is_enabled()) {
-        lv_obj_clear_flag(ble_status_icon_, LV_OBJ_FLAG_HIDDEN);
-        lv_obj_set_style_text_color(ble_status_icon_,
-                                    bluetooth->is_connected() ? lv_color_hex(THEME_COLOR_SUCCESS)
-                                                              : lv_color_hex(THEME_COLOR_ACCENT),
-                                    0);
+        set_hidden_if_changed(ble_status_icon_, false);
+        set_text_color_if_changed(ble_status_icon_,
+                                  bluetooth->is_connected() ? lv_color_hex(THEME_COLOR_SUCCESS)
+                                                            : lv_color_hex(THEME_COLOR_ACCENT));
     } else {
-        lv_obj_add_flag(ble_status_icon_, LV_OBJ_FLAG_HIDDEN);
+        set_hidden_if_changed(ble_status_icon_, true);
     }
 }
 
@@ -69,11 +69,11 @@ void StatusIndicatorController::update_warning_icon() {
     if (ui_manager_->diagnostics_controller_) {
         DiagnosticCode diagnostic = ui_manager_->diagnostics_controller_->get_highest_priority_warning();
         if (diagnostic != DiagnosticCode::NONE) {
-            lv_obj_clear_flag(warning_icon_, LV_OBJ_FLAG_HIDDEN);
+            set_hidden_if_changed(warning_icon_, false);
         } else {
-            lv_obj_add_flag(warning_icon_, LV_OBJ_FLAG_HIDDEN);
+            set_hidden_if_changed(warning_icon_, true);
         }
     } else {
-        lv_obj_add_flag(warning_icon_, LV_OBJ_FLAG_HIDDEN);
+        set_hidden_if_changed(warning_icon_, true);
     }
 }
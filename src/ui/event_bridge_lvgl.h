@@ -38,6 +38,7 @@ public:
         GRINDER_PURGE_MODE_RADIO_BUTTON,
         GRINDER_PURGE_AMOUNT_SLIDER,
         GRINDER_PURGE_AMOUNT_SLIDER_RELEASED,
+        STOP_PLANNER_TOGGLE,
         BRIGHTNESS_NORMAL_SLIDER,
         BRIGHTNESS_NORMAL_SLIDER_RELEASED,
         BRIGHTNESS_SCREENSAVER_SLIDER,
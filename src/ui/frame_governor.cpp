@@ -0,0 +1,47 @@
+#include "frame_governor.h"
+
+void FrameGovernor::mark_active(uint32_t now_ms) {
+    last_activity_ms = now_ms;
+    has_activity = true;
+}
+
+bool FrameGovernor::is_active(uint32_t now_ms) const {
+#if SYS_UI_FRAME_GOVERNOR
+    return has_activity && (now_ms - last_activity_ms) < SYS_UI_ACTIVE_HOLD_MS;
+#else
+    return true;
+#endif
+}
+
+bool FrameGovernor::should_render(uint32_t now_ms) {
+    stats.ticks++;
+
+    frame_active = is_active(now_ms);
+    bool render = frame_active || !has_frame || (now_ms - last_frame_ms) >= SYS_UI_IDLE_INTERVAL_MS;
+    if (!render) {
+        stats.skipped++;
+    }
+    return render;
+}
+
+void FrameGovernor::record_frame(uint32_t now_ms, uint32_t cost_us) {
+    last_frame_ms = now_ms;
+    has_frame = true;
+
+    stats.frames++;
+    if (frame_active) {
+        stats.active_frames++;
+    }
+    stats.frame_us_sum += cost_us;
+    if (cost_us > stats.frame_us_max) {
+        stats.frame_us_max = cost_us;
+    }
+}
+
+FrameGovernorStats FrameGovernor::take_stats(uint32_t now_ms) {
+    FrameGovernorStats result = stats;
+    result.window_ms = now_ms - window_start_ms;
+    stats = {};
+    window_start_ms = now_ms;
+    return result;
+}
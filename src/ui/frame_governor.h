@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+#include "../config/constants.h"
+
+// UI frame timing since the last take_stats() call
+struct FrameGovernorStats {
+    uint32_t ticks;                  // UI task wakeups
+    uint32_t frames;                 // Ticks that ran UI logic + lv_timer_handler()
+    uint32_t skipped;                // Ticks that only polled touch and the event queues
+    uint32_t active_frames;          // Frames run at the full rate
+    uint32_t frame_us_sum;           // UI logic + LVGL cost per frame
+    uint32_t frame_us_max;
+    uint32_t window_ms;              // Length of the window
+};
+
+/*
+ * FrameGovernor - decides which UI task ticks run the UI logic and LVGL
+ *
+ * The UI task keeps waking every SYS_TASK_UI_INTERVAL_MS so touch and the Core 0 event queue
+ * are never more than one tick late. A tick with activity (grinding, autotuning, a touch, a
+ * running animation, a drained event or a screen change) renders at once and keeps the full
+ * rate for SYS_UI_ACTIVE_HOLD_MS. Otherwise a frame only runs every SYS_UI_IDLE_INTERVAL_MS,
+ * which is plenty for the live weight readouts on the menu and calibration screens.
+ */
+class FrameGovernor {
+public:
+    // Activity seen this tick - restarts the full-rate hold
+    void mark_active(uint32_t now_ms);
+
+    // True when this tick should run a frame
+    bool should_render(uint32_t now_ms);
+
+    // Cost of the frame should_render() allowed
+    void record_frame(uint32_t now_ms, uint32_t cost_us);
+
+    bool is_active(uint32_t now_ms) const;
+
+    // Returns the stats gathered since the previous call and starts a new window
+    FrameGovernorStats take_stats(uint32_t now_ms);
+
+private:
+    uint32_t last_activity_ms = 0;
+    uint32_t last_frame_ms = 0;
+    bool has_activity = false;
+    bool has_frame = false;
+    bool frame_active = false;
+    uint32_t window_start_ms = 0;
+    FrameGovernorStats stats = {};
+};
@@ -167,7 +167,7 @@ void CalibrationScreen::update_current_weight(float weight) {
             long raw_display = (long)weight;
             snprintf(weight_text, sizeof(weight_text), SYS_RAW_VALUE_FORMAT, raw_display);
         }
-        lv_label_set_text(weight_label, weight_text);
+        set_label_text_if_changed(weight_label, weight_text);
     }
 }
 
@@ -192,8 +192,8 @@ void CalibrationScreen::update_noise_status(const char* text, lv_color_t color)
         return;
     }
 
-    lv_label_set_text(noise_status_label, text);
-    lv_obj_set_style_text_color(noise_status_label, color, 0);
+    set_label_text_if_changed(noise_status_label, text);
+    set_text_color_if_changed(noise_status_label, color);
 }
 
 void CalibrationScreen::update_noise_metric(float std_dev_g) {
@@ -202,11 +202,11 @@ void CalibrationScreen::update_noise_metric(float std_dev_g) {
     }
 
     if (std::isnan(std_dev_g) || std_dev_g < 0.0f) {
-        lv_label_set_text(noise_metric_label, "Std Dev: --");
+        set_label_text_if_changed(noise_metric_label, "Std Dev: --");
     } else {
         char buffer[32];
         snprintf(buffer, sizeof(buffer), "Std Dev: %.4fg", std_dev_g);
-        lv_label_set_text(noise_metric_label, buffer);
+        set_label_text_if_changed(noise_metric_label, buffer);
     }
 }
 
@@ -1,6 +1,7 @@
 #include "grinding_screen_arc.h"
 #include <Arduino.h>
 #include "../../config/constants.h"
+#include "../ui_helpers.h"
 
 void GrindingScreenArc::create() {
     screen = lv_obj_create(lv_scr_act());
@@ -90,17 +91,17 @@ void GrindingScreenArc::update_target_weight_text(const char* text) {
 void GrindingScreenArc::update_target_time(float seconds) {
     char target_text[32];
     snprintf(target_text, sizeof(target_text), "Time: %.1fs", seconds);
-    lv_label_set_text(target_label, target_text);
+    set_label_text_if_changed(target_label, target_text);
 }
 
 void GrindingScreenArc::update_current_weight(float weight) {
     char weight_text[16];
     snprintf(weight_text, sizeof(weight_text), SYS_WEIGHT_DISPLAY_FORMAT, weight);
-    lv_label_set_text(weight_label, weight_text);
+    set_label_text_if_changed(weight_label, weight_text);
 }
 
 void GrindingScreenArc::update_tare_display() {
-    lv_label_set_text(weight_label, "TARE");
+    set_label_text_if_changed(weight_label, "TARE");
     lv_arc_set_value(progress_arc, 0);  // Reset arc to 0 during taring
 }
 
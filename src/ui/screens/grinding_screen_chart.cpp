@@ -3,6 +3,7 @@
 #include "../../config/constants.h"
 #include <lvgl.h>
 #include <widgets/span/lv_span.h>
+#include "../ui_helpers.h"
 
 void GrindingScreenChart::create() {
     screen = lv_obj_create(lv_scr_act());
@@ -26,17 +27,14 @@ void GrindingScreenChart::create() {
     lv_obj_set_style_text_color(profile_label, lv_color_hex(THEME_COLOR_SECONDARY), 0);
 
     // Create chart - use full screen width
-    chart = lv_chart_create(screen);
-    lv_obj_set_size(chart, LV_PCT(100), 140);
-    lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
-    lv_chart_set_point_count(chart, MAX_CHART_POINTS);
-    lv_chart_set_div_line_count(chart, 0, 0);  // No grid lines for clean look
+    lv_obj_t* chart_obj = chart.create(screen, 140);
     
     // Chart styling - dark background
-    lv_obj_set_style_bg_color(chart, lv_color_hex(0x111111), LV_PART_MAIN);
-    lv_obj_set_style_border_width(chart, 1, LV_PART_MAIN);
-    lv_obj_set_style_border_color(chart, lv_color_hex(0x333333), LV_PART_MAIN);
-    lv_obj_set_style_pad_all(chart, 0, LV_PART_MAIN);
+    lv_obj_set_style_bg_color(chart_obj, lv_color_hex(0x111111), LV_PART_MAIN);
+    lv_obj_set_style_border_width(chart_obj, 1, LV_PART_MAIN);
+    lv_obj_set_style_border_color(chart_obj, lv_color_hex(0x333333), LV_PART_MAIN);
+    lv_obj_set_style_radius(chart_obj, 0, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(chart_obj, 0, LV_PART_MAIN);
     
     // Initialize data tracking
     target_weight_value = 18.0f;
@@ -49,40 +47,19 @@ void GrindingScreenChart::create() {
     time_mode = false;
     target_time_seconds = 0.0f;
     
-    // Set chart update mode (point count is finalized after series creation)
-    lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_SHIFT); // Slide data left when full
+    // Series in z-order: weight (red) below flow rate (green)
+    chart.set_series_color(WEIGHT_SERIES, lv_color_hex(THEME_COLOR_PRIMARY));
+    chart.set_series_color(FLOW_RATE_SERIES, lv_color_hex(THEME_COLOR_SUCCESS));
+    chart.set_line_width(3);
     
-    // Set Y-axis ranges (scale by 10 to handle decimals)
-    lv_chart_set_axis_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, (int32_t)(max_y_value * 10)); // Weight axis
-    lv_chart_set_axis_range(chart, LV_CHART_AXIS_SECONDARY_Y, 0, 25); // Flow rate axis: 0-2.5 g/s * 10
-    
-    // Add data series in z-order: weight (bottom/filled), flow rate, target (top)
-    // Weight series (red filled area) - Use primary Y axis for weight
-    weight_series = lv_chart_add_series(chart, lv_color_hex(THEME_COLOR_PRIMARY), LV_CHART_AXIS_PRIMARY_Y);
-    
-    // Flow rate series (green line) - Use secondary Y axis for flow rate
-    flow_rate_series = lv_chart_add_series(chart, lv_color_hex(THEME_COLOR_SUCCESS), LV_CHART_AXIS_SECONDARY_Y);
-    
-    // Configure chart to show both lines and bars (for filled area effect)
-    lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
-    
-    // Style each series individually - remove data point markers
-    lv_obj_set_style_line_width(chart, 3, LV_PART_ITEMS);
-    lv_obj_set_style_line_color(chart, lv_color_hex(THEME_COLOR_PRIMARY), LV_PART_ITEMS);
-    lv_obj_set_style_bg_color(chart, lv_color_hex(THEME_COLOR_PRIMARY), LV_PART_ITEMS);
-    // lv_obj_set_style_bg_opa(chart, LV_OPA_20, LV_PART_ITEMS);
-    
-    // Remove data point markers/circles - set both width and height to 0
-    lv_obj_set_style_width(chart, 0, LV_PART_INDICATOR);
-    lv_obj_set_style_height(chart, 0, LV_PART_INDICATOR);
-    lv_obj_set_style_radius(chart, 0, LV_PART_INDICATOR);
-    
-    // Flow rate and target series will inherit line styling
+    // Y ranges (scaled by 10 to handle decimals)
+    chart.set_range(WEIGHT_SERIES, (int32_t)(max_y_value * 10)); // Weight axis
+    chart.set_range(FLOW_RATE_SERIES, 25); // Flow rate axis: 0-2.5 g/s * 10
     
     // Configure the initial point count based on defaults
     update_chart_point_configuration();
 
-    // Initialize all series with zero values
+    // Start with an empty chart
     reset_chart_data();
 
     // Current/Target weight display with mixed font sizes using spangroup
@@ -152,12 +129,8 @@ void GrindingScreenChart::update_target_weight(float weight) {
         }
     }
     
-    // Update chart configuration
-    lv_chart_set_point_count(chart, predicted_chart_points);
-    lv_chart_set_axis_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, (int32_t)(max_y_value * 10)); // Weight axis
-    lv_chart_set_axis_range(chart, LV_CHART_AXIS_SECONDARY_Y, 0, 25); // Flow rate axis: 0-2.5 g/s * 10
-    
-    lv_chart_refresh(chart);
+    // Only the weight range changes - the chart applies it on its next redraw
+    chart.set_range(WEIGHT_SERIES, (int32_t)(max_y_value * 10)); // Weight axis
 }
 
 void GrindingScreenChart::update_target_weight_text(const char* text) {
@@ -172,8 +145,9 @@ void GrindingScreenChart::update_target_weight_text(const char* text) {
         } else {
             snprintf(formatted_text, sizeof(formatted_text), "%s", target_text);
         }
-        lv_span_set_text(separator_span, formatted_text);
-        lv_spangroup_refresh(weight_spangroup);
+        if (set_span_text_if_changed(separator_span, formatted_text)) {
+            lv_spangroup_refresh(weight_spangroup);
+        }
     }
 }
 
@@ -186,8 +160,9 @@ void GrindingScreenChart::update_target_time(float seconds) {
         // Keep the current weight span untouched; show time on a new line without slash
         char target_text[48];
         snprintf(target_text, sizeof(target_text), "\nTime: %.1fs", seconds);
-        lv_span_set_text(separator_span, target_text);
-        lv_spangroup_refresh(weight_spangroup);
+        if (set_span_text_if_changed(separator_span, target_text)) {
+            lv_spangroup_refresh(weight_spangroup);
+        }
     }
 
     uint32_t predicted_ms = (seconds > 0.0f) ? static_cast<uint32_t>(seconds * 1000.0f) : 0;
@@ -204,15 +179,18 @@ void GrindingScreenChart::update_current_weight(float weight) {
     lv_span_t* separator_span = lv_spangroup_get_child(weight_spangroup, 1);
     
     if (current_span && separator_span) {
-        lv_span_set_text(current_span, current_text);
+        // Called on every weight sample - skip the relayout when the text is unchanged
+        bool changed = set_span_text_if_changed(current_span, current_text);
         if (time_mode) {
             char time_text[48];
             snprintf(time_text, sizeof(time_text), "\nTime: %.1fs", target_time_seconds);
-            lv_span_set_text(separator_span, time_text);
+            changed |= set_span_text_if_changed(separator_span, time_text);
         } else {
-            lv_span_set_text(separator_span, target_text);
+            changed |= set_span_text_if_changed(separator_span, target_text);
+        }
+        if (changed) {
+            lv_spangroup_refresh(weight_spangroup);
         }
-        lv_spangroup_refresh(weight_spangroup);
     }
 }
 
@@ -225,15 +203,17 @@ void GrindingScreenChart::update_tare_display() {
     lv_span_t* separator_span = lv_spangroup_get_child(weight_spangroup, 1);
     
     if (current_span && separator_span) {
-        lv_span_set_text(current_span, "TARE");
+        bool changed = set_span_text_if_changed(current_span, "TARE");
         if (time_mode) {
             char time_text[48];
             snprintf(time_text, sizeof(time_text), "\nTime: %.1fs", target_time_seconds);
-            lv_span_set_text(separator_span, time_text);
+            changed |= set_span_text_if_changed(separator_span, time_text);
         } else {
-            lv_span_set_text(separator_span, target_text);
+            changed |= set_span_text_if_changed(separator_span, target_text);
+        }
+        if (changed) {
+            lv_spangroup_refresh(weight_spangroup);
         }
-        lv_spangroup_refresh(weight_spangroup);
     }
 }
 
@@ -250,17 +230,15 @@ void GrindingScreenChart::add_chart_data_point(float current_weight, float flow_
     
     last_data_point_time_ms = current_time_ms;
     
-    // Scale weight and flow rate by 10 to handle decimals in LVGL chart
-    lv_coord_t weight_value = (lv_coord_t)(current_weight * 10);
+    // Scale weight and flow rate by 10 to handle decimals
+    int32_t values[DecimatingChart::SERIES_COUNT];
+    values[WEIGHT_SERIES] = (int32_t)(current_weight * 10);
     // Clamp flow rate to 0-2.5 g/s range then scale by 10
     float clamped_flow_rate = (flow_rate < 0.0f) ? 0.0f : ((flow_rate > 2.5f) ? 2.5f : flow_rate);
-    lv_coord_t flow_rate_value = (lv_coord_t)(clamped_flow_rate * 10);
-    
-    // Add data points to series (LVGL will handle sliding window due to SHIFT mode)
-    lv_chart_set_next_value(chart, weight_series, weight_value);
-    lv_chart_set_next_value(chart, flow_rate_series, flow_rate_value);
+    values[FLOW_RATE_SERIES] = (int32_t)(clamped_flow_rate * 10);
     
-    lv_chart_refresh(chart);
+    // Only redraws the columns this point lands on; past the window the chart compacts itself
+    chart.add_point(values);
 }
 
 void GrindingScreenChart::set_chart_time_prediction(uint32_t predicted_time_ms) {
@@ -272,18 +250,12 @@ void GrindingScreenChart::reset_chart_data() {
     chart_start_time_ms = 0;
     last_data_point_time_ms = 0;
 
-    if (!chart) {
+    if (!chart.get_obj()) {
         return;
     }
 
-    if (weight_series) {
-        lv_chart_set_all_values(chart, weight_series, 0);
-    }
-    if (flow_rate_series) {
-        lv_chart_set_all_values(chart, flow_rate_series, 0);
-    }
-
-    predicted_chart_points = static_cast<uint16_t>(lv_chart_get_point_count(chart));
+    chart.clear();
+    predicted_chart_points = static_cast<uint16_t>(chart.get_window());
 }
 
 void GrindingScreenChart::set_time_mode(bool enabled) {
@@ -297,7 +269,7 @@ void GrindingScreenChart::set_time_mode(bool enabled) {
 }
 
 void GrindingScreenChart::update_chart_point_configuration() {
-    if (!chart) {
+    if (!chart.get_obj()) {
         return;
     }
 
@@ -319,19 +291,10 @@ void GrindingScreenChart::update_chart_point_configuration() {
         new_count_32 = MAX_CHART_POINTS;
     }
 
-    uint16_t new_count = static_cast<uint16_t>(new_count_32);
-    uint16_t current_count = static_cast<uint16_t>(lv_chart_get_point_count(chart));
+    uint16_t current_count = static_cast<uint16_t>(new_count_32);
 
-    if (new_count != current_count) {
-        lv_chart_set_point_count(chart, new_count);
-        if (weight_series) {
-            lv_chart_set_all_values(chart, weight_series, 0);
-        }
-        if (flow_rate_series) {
-            lv_chart_set_all_values(chart, flow_rate_series, 0);
-        }
-        current_count = new_count;
-    }
+    // Clears the chart when the window changes
+    chart.set_window(current_count);
 
     predicted_chart_points = current_count;
     predicted_grind_time_ms = static_cast<uint32_t>(current_count) * DATA_POINT_INTERVAL_MS;
@@ -1,6 +1,7 @@
 #pragma once
 #include <lvgl.h>
 #include "grinding_screen_base.h"
+#include "../components/decimating_chart.h"
 #include "../../config/constants.h"
 
 class GrindingScreenChart : public IGrindingScreen {
@@ -8,9 +9,7 @@ private:
     lv_obj_t* screen;
     lv_obj_t* profile_label;
     lv_obj_t* weight_spangroup;
-    lv_obj_t* chart;
-    lv_chart_series_t* weight_series;
-    lv_chart_series_t* flow_rate_series;
+    DecimatingChart chart;
     bool visible;
     bool time_mode;
     
@@ -19,6 +18,8 @@ private:
     static const uint16_t MAX_CHART_POINTS = 1000;
     static constexpr float REFERENCE_FLOW_RATE_GPS = 1.6f;  // Reference flow rate for time prediction
     static const uint32_t DATA_POINT_INTERVAL_MS = SYS_TASK_GRIND_CONTROL_INTERVAL_MS; // Match grind control loop (50Hz)
+    static const uint8_t WEIGHT_SERIES = 0;
+    static const uint8_t FLOW_RATE_SERIES = 1;
     uint32_t chart_start_time_ms;
     uint32_t predicted_grind_time_ms;
     uint16_t predicted_chart_points;
@@ -44,6 +44,7 @@ void MenuScreen::create(BluetoothManager* bluetooth, GrindController* grind_ctrl
     grinder_purge_mode_radio_group = nullptr;
     grinder_purge_amount_slider = nullptr;
     grinder_purge_amount_label = nullptr;
+    stop_planner_toggle = nullptr;
     lv_obj_add_flag(screen, LV_OBJ_FLAG_HIDDEN);
 
     // Create menu UI immediately at boot for instant access
@@ -400,6 +401,11 @@ void MenuScreen::create_grind_mode_page(lv_obj_t* parent) {
     create_slider_row(parent, "Amount", &grinder_purge_amount_label, &grinder_purge_amount_slider,
                      lv_color_hex(THEME_COLOR_ACCENT), slider_min_units, slider_max_units);
 
+    // Motor stop planner section
+    create_separator(parent, "Stopping");
+    create_description_label(parent, "Learn how much coffee follows a motor stop from previous grinds. Off uses the fixed latency ratio.");
+    create_toggle_row(parent, "Learn", &stop_planner_toggle);
+
     // Register events for the toggles (done here because widgets are created lazily)
     using ET = EventBridgeLVGL::EventType;
     if (grind_mode_swipe_toggle) {
@@ -414,6 +420,10 @@ void MenuScreen::create_grind_mode_page(lv_obj_t* parent) {
         lv_obj_add_event_cb(auto_return_toggle, EventBridgeLVGL::dispatch_event, LV_EVENT_VALUE_CHANGED,
                            reinterpret_cast<void*>(static_cast<intptr_t>(ET::AUTO_RETURN_TOGGLE)));
     }
+    if (stop_planner_toggle) {
+        lv_obj_add_event_cb(stop_planner_toggle, EventBridgeLVGL::dispatch_event, LV_EVENT_VALUE_CHANGED,
+                           reinterpret_cast<void*>(static_cast<intptr_t>(ET::STOP_PLANNER_TOGGLE)));
+    }
     if (grinder_purge_amount_slider) {
         lv_obj_add_event_cb(grinder_purge_amount_slider, EventBridgeLVGL::dispatch_event, LV_EVENT_VALUE_CHANGED,
                            reinterpret_cast<void*>(static_cast<intptr_t>(ET::GRINDER_PURGE_AMOUNT_SLIDER)));
@@ -624,9 +634,10 @@ void MenuScreen::hide() {
 void MenuScreen::update_info(const WeightSensor* weight_sensor, unsigned long uptime_ms, size_t free_heap) {
     if (!visible) return;
 
-    set_label_text_float(instant_label, weight_sensor->get_instant_weight(), "g");
-    set_label_text_int(samples_label, weight_sensor->get_sample_count());
-    set_label_text_int(raw_label, weight_sensor->get_raw_adc_instant());
+    const WeightSnapshot snapshot = weight_sensor->get_snapshot();
+    set_label_text_float(instant_label, snapshot.instant_weight, "g");
+    set_label_text_int(samples_label, snapshot.sample_count);
+    set_label_text_int(raw_label, snapshot.raw_instant);
 
     // Update uptime - use compact format to avoid horizontal scrolling
     unsigned long seconds = uptime_ms / 1000;
@@ -636,7 +647,7 @@ void MenuScreen::update_info(const WeightSensor* weight_sensor, unsigned long up
 
     char uptime_text[48];
     snprintf(uptime_text, sizeof(uptime_text), "%02lu:%02lu:%02lu", hours, minutes, seconds);
-    lv_label_set_text(uptime_label, uptime_text);
+    set_label_text_if_changed(uptime_label, uptime_text);
 
     set_label_text_int(memory_label, free_heap / 1024, "kB");
 }
@@ -650,13 +661,14 @@ void MenuScreen::update_diagnostics(WeightSensor* weight_sensor) {
     if (now - last_std_dev_update >= 1000) {  // Update every 1 second
         last_std_dev_update = now;
 
-        // Get standard deviations using same window as grind control precision settling
-        float std_dev_g = weight_sensor->get_standard_deviation_g(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);  // 500ms window
-        int32_t std_dev_adc = weight_sensor->get_standard_deviation_adc(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);  // 500ms window
+        // Standard deviations over the grind control precision settling window (500ms), as published
+        const WeightSnapshot snapshot = weight_sensor->get_snapshot();
+        float std_dev_g = snapshot.std_dev_g;
+        int32_t std_dev_adc = (int32_t)snapshot.std_dev_raw;
 
         char std_dev_g_text[32];
         snprintf(std_dev_g_text, sizeof(std_dev_g_text), "%.4f", std_dev_g);
-        lv_label_set_text(diag_std_dev_g_label, std_dev_g_text);
+        set_label_text_if_changed(diag_std_dev_g_label, std_dev_g_text);
 
         set_label_text_int(diag_std_dev_adc_label, std_dev_adc);
 
@@ -665,11 +677,11 @@ void MenuScreen::update_diagnostics(WeightSensor* weight_sensor) {
 
         // Update noise level indicator
         if (noise_acceptable) {
-            lv_label_set_text(diag_noise_level_label, "OK");
-            lv_obj_set_style_text_color(diag_noise_level_label, lv_color_hex(THEME_COLOR_TEXT_SECONDARY), 0);
+            set_label_text_if_changed(diag_noise_level_label, "OK");
+            set_text_color_if_changed(diag_noise_level_label, lv_color_hex(THEME_COLOR_TEXT_SECONDARY));
         } else {
-            lv_label_set_text(diag_noise_level_label, "Too High");
-            lv_obj_set_style_text_color(diag_noise_level_label, lv_color_hex(THEME_COLOR_ERROR), 0);
+            set_label_text_if_changed(diag_noise_level_label, "Too High");
+            set_text_color_if_changed(diag_noise_level_label, lv_color_hex(THEME_COLOR_ERROR));
         }
     }
 
@@ -677,16 +689,16 @@ void MenuScreen::update_diagnostics(WeightSensor* weight_sensor) {
     float cal_factor = weight_sensor->get_calibration_factor();
     char cal_factor_text[32];
     snprintf(cal_factor_text, sizeof(cal_factor_text), "%.2f", cal_factor);
-    lv_label_set_text(diag_calibration_factor_label, cal_factor_text);
+    set_label_text_if_changed(diag_calibration_factor_label, cal_factor_text);
 
     // Update motor latency
     if (grind_controller) {
         float motor_latency = grind_controller->get_motor_response_latency();
         char latency_text[32];
         snprintf(latency_text, sizeof(latency_text), "%.0f ms", motor_latency);
-        lv_label_set_text(diag_motor_latency_label, latency_text);
+        set_label_text_if_changed(diag_motor_latency_label, latency_text);
     } else {
-        lv_label_set_text(diag_motor_latency_label, "-- ms");
+        set_label_text_if_changed(diag_motor_latency_label, "-- ms");
     }
 
     // Get highest priority diagnostic
@@ -694,22 +706,22 @@ void MenuScreen::update_diagnostics(WeightSensor* weight_sensor) {
 
     // Update status label
     if (diagnostic == DiagnosticCode::NONE) {
-        lv_label_set_text(diag_status_label, "OK");
-        lv_obj_set_style_text_color(diag_status_label, lv_color_hex(THEME_COLOR_SUCCESS), 0);
-        lv_obj_add_flag(diag_info_label, LV_OBJ_FLAG_HIDDEN);
+        set_label_text_if_changed(diag_status_label, "OK");
+        set_text_color_if_changed(diag_status_label, lv_color_hex(THEME_COLOR_SUCCESS));
+        set_hidden_if_changed(diag_info_label, true);
     } else {
-        lv_label_set_text(diag_status_label, LV_SYMBOL_WARNING " Warning");
-        lv_obj_set_style_text_color(diag_status_label, lv_color_hex(THEME_COLOR_WARNING), 0);
+        set_label_text_if_changed(diag_status_label, LV_SYMBOL_WARNING " Warning");
+        set_text_color_if_changed(diag_status_label, lv_color_hex(THEME_COLOR_WARNING));
 
         // Show appropriate warning message
         if (diagnostic == DiagnosticCode::LOAD_CELL_NOT_CALIBRATED) {
-            lv_label_set_text(diag_info_label, "Loadcell not calibrated");
-            lv_obj_clear_flag(diag_info_label, LV_OBJ_FLAG_HIDDEN);
+            set_label_text_if_changed(diag_info_label, "Loadcell not calibrated");
+            set_hidden_if_changed(diag_info_label, false);
         } else {
             // For future noise/mechanical warnings, show in info label
             const char* message = diagnostics_controller->get_diagnostic_message(diagnostic);
-            lv_label_set_text(diag_info_label, message);
-            lv_obj_clear_flag(diag_info_label, LV_OBJ_FLAG_HIDDEN);
+            set_label_text_if_changed(diag_info_label, message);
+            set_hidden_if_changed(diag_info_label, false);
         }
     }
 }
@@ -727,23 +739,23 @@ void MenuScreen::update_ble_status() {
     // Update status text
     if (bluetooth_manager->is_enabled()) {
         if (bluetooth_manager->is_connected()) {
-            lv_label_set_text(ble_status_label, "Connected");
+            set_label_text_if_changed(ble_status_label, "Connected");
         } else {
-            lv_label_set_text(ble_status_label, "Advertising");
+            set_label_text_if_changed(ble_status_label, "Advertising");
         }
-        lv_obj_clear_flag(ble_status_label, LV_OBJ_FLAG_HIDDEN);
+        set_hidden_if_changed(ble_status_label, false);
         
         // Show remaining time
         unsigned long remaining_ms = bluetooth_manager->get_bluetooth_timeout_remaining_ms();
         unsigned long remaining_min = remaining_ms / (60 * 1000);
         char timer_text[64];
         snprintf(timer_text, sizeof(timer_text), "Auto-disable in: %lu min", remaining_min);
-        lv_label_set_text(ble_timer_label, timer_text);
-        lv_obj_clear_flag(ble_timer_label, LV_OBJ_FLAG_HIDDEN);
+        set_label_text_if_changed(ble_timer_label, timer_text);
+        set_hidden_if_changed(ble_timer_label, false);
     } else {
         // When nothing to display hide the status labels
-        lv_obj_add_flag(ble_status_label, LV_OBJ_FLAG_HIDDEN);
-        lv_obj_add_flag(ble_timer_label, LV_OBJ_FLAG_HIDDEN);
+        set_hidden_if_changed(ble_status_label, true);
+        set_hidden_if_changed(ble_timer_label, true);
     }
 }
 
@@ -1075,7 +1087,7 @@ void MenuScreen::update_scale_weight(float weight) {
     }
     char buffer[24];
     snprintf(buffer, sizeof(buffer), SYS_WEIGHT_DISPLAY_FORMAT, weight);
-    lv_label_set_text(scale_weight_label, buffer);
+    set_label_text_if_changed(scale_weight_label, buffer);
 }
 
 void MenuScreen::update_grind_mode_toggles() {
@@ -1089,6 +1101,7 @@ void MenuScreen::update_grind_mode_toggles() {
     int mode_index = 0; // Default to Weight (index 0)
     int grinder_purge_mode_index = GRIND_PURGE_MODE_DEFAULT;  // Default to Purge
     float grinder_purge_amount_g = GRIND_PURGE_AMOUNT_DEFAULT_G;  // Default to 1.0g
+    int stop_planner = GRIND_STOP_PLANNER_DEFAULT;
     if (hardware_manager) {
         Preferences* main_prefs = hardware_manager->get_preferences();
         if (main_prefs) {
@@ -1096,6 +1109,7 @@ void MenuScreen::update_grind_mode_toggles() {
             mode_index = (stored_mode == static_cast<int>(GrindMode::TIME)) ? 1 : 0;
             grinder_purge_mode_index = main_prefs->getInt(GrindController::PREF_KEY_GRINDER_MODE, GRIND_PURGE_MODE_DEFAULT);
             grinder_purge_amount_g = main_prefs->getFloat(GrindController::PREF_KEY_GRINDER_AMOUNT_G, GRIND_PURGE_AMOUNT_DEFAULT_G);
+            stop_planner = main_prefs->getInt(GrindController::PREF_KEY_STOP_PLANNER, GRIND_STOP_PLANNER_DEFAULT);
         }
     }
 
@@ -1134,6 +1148,14 @@ void MenuScreen::update_grind_mode_toggles() {
         }
     }
 
+    if (stop_planner_toggle) {
+        if (stop_planner == static_cast<int>(StopPlannerType::MODEL)) {
+            lv_obj_add_state(stop_planner_toggle, LV_STATE_CHECKED);
+        } else {
+            lv_obj_clear_state(stop_planner_toggle, LV_STATE_CHECKED);
+        }
+    }
+
     // Update grinder purge mode radio group selection
     if (grinder_purge_mode_radio_group) {
         radio_button_group_set_selection(grinder_purge_mode_radio_group, grinder_purge_mode_index);
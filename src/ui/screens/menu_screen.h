@@ -64,6 +64,7 @@ private:
     lv_obj_t* grinder_purge_mode_radio_group;
     lv_obj_t* grinder_purge_amount_slider;
     lv_obj_t* grinder_purge_amount_label;
+    lv_obj_t* stop_planner_toggle;
     
     // Tools entries / scale page elements
     lv_obj_t* scale_item;
@@ -133,6 +134,7 @@ public:
     lv_obj_t* get_grind_mode_swipe_toggle() const { return grind_mode_swipe_toggle; }
     lv_obj_t* get_auto_start_toggle() const { return auto_start_toggle; }
     lv_obj_t* get_auto_return_toggle() const { return auto_return_toggle; }
+    lv_obj_t* get_stop_planner_toggle() const { return stop_planner_toggle; }
     lv_obj_t* get_grinder_purge_mode_radio_group() const { return grinder_purge_mode_radio_group; }
     lv_obj_t* get_grinder_purge_amount_slider() const { return grinder_purge_amount_slider; }
 
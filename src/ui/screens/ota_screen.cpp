@@ -1,6 +1,7 @@
 #include "ota_screen.h"
 #include <Arduino.h>
 #include "../../config/constants.h"
+#include "../ui_helpers.h"
 
 void OTAScreen::create() {
     screen = lv_obj_create(lv_scr_act());
@@ -72,15 +73,15 @@ void OTAScreen::update_progress(int percent) {
     
     char percentage_text[8];
     snprintf(percentage_text, sizeof(percentage_text), "%d%%", percent);
-    lv_label_set_text(percentage_label, percentage_text);
+    set_label_text_if_changed(percentage_label, percentage_text);
 }
 
 void OTAScreen::update_status(const char* status) {
-    lv_label_set_text(status_label, status);
+    set_label_text_if_changed(status_label, status);
 }
 
 void OTAScreen::update_title(const char* title) {
-    lv_label_set_text(title_label, title);
+    set_label_text_if_changed(title_label, title);
 }
 
 void OTAScreen::show_ota_mode() {
@@ -1,6 +1,7 @@
 #include "ui_helpers.h"
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 void style_as_button(lv_obj_t* object, int32_t width, int32_t height, const lv_font_t* font) {
     lv_obj_set_style_radius(object, THEME_CORNER_RADIUS_PX, 0);
@@ -42,7 +43,7 @@ void set_label_text_int(lv_obj_t* label, int32_t value, const char* unit) {
         snprintf(buf, sizeof(buf), "%ld", value);
     }
 
-    lv_label_set_text(label, buf);
+    set_label_text_if_changed(label, buf);
 }
 
 void set_label_text_float(lv_obj_t* label, float value, const char* unit) {
@@ -55,7 +56,36 @@ void set_label_text_float(lv_obj_t* label, float value, const char* unit) {
         snprintf(buf, sizeof(buf), "%.2f", value);
     }
 
-    lv_label_set_text(label, buf);
+    set_label_text_if_changed(label, buf);
+}
+
+void set_label_text_if_changed(lv_obj_t* label, const char* text) {
+    if (!label || !text) return;
+    const char* current = lv_label_get_text(label);
+    if (current && strcmp(current, text) == 0) return;
+    lv_label_set_text(label, text);
+}
+
+bool set_span_text_if_changed(lv_span_t* span, const char* text) {
+    if (!span || !text) return false;
+    const char* current = lv_span_get_text(span);
+    if (current && strcmp(current, text) == 0) return false;
+    lv_span_set_text(span, text);
+    return true;
+}
+
+void set_hidden_if_changed(lv_obj_t* object, bool hidden) {
+    if (!object || lv_obj_has_flag(object, LV_OBJ_FLAG_HIDDEN) == hidden) return;
+    if (hidden) {
+        lv_obj_add_flag(object, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_clear_flag(object, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+void set_text_color_if_changed(lv_obj_t* object, lv_color_t color) {
+    if (!object || lv_color_eq(lv_obj_get_style_text_color(object, 0), color)) return;
+    lv_obj_set_style_text_color(object, color, 0);
 }
 
 lv_obj_t* create_profile_label(lv_obj_t* parent, lv_obj_t** profile_label, lv_obj_t** weight_label){
@@ -14,6 +14,13 @@ void set_label_text_int(lv_obj_t* label, int32_t value, const char* unit = nullp
 
 void set_label_text_float(lv_obj_t* label, float value, const char* unit = nullptr);
 
+// Change-only setters for values refreshed from update() loops: LVGL invalidates (and re-lays out
+// labels) on every set call, even when the value is the same, which costs a redraw per tick
+void set_label_text_if_changed(lv_obj_t* label, const char* text);
+bool set_span_text_if_changed(lv_span_t* span, const char* text); // True if changed - refresh the spangroup
+void set_hidden_if_changed(lv_obj_t* object, bool hidden);
+void set_text_color_if_changed(lv_obj_t* object, lv_color_t color);
+
 lv_obj_t* create_profile_label(lv_obj_t* parent, lv_obj_t** profile_label, lv_obj_t** weight_label);
 
 lv_obj_t* create_dual_button_row(lv_obj_t* parent, lv_obj_t** left_button, lv_obj_t** right_button, 
@@ -365,27 +365,26 @@ void UIManager::update_auto_actions() {
     const bool grinder_active = (grind_controller && grind_controller->is_active());
     const bool on_ready_tab = state_machine->is_state(UIState::READY) && current_tab < 3;
 
-    if (auto_actions_.auto_start_enabled && on_ready_tab && !grinder_active && grinding_controller_) {
-        auto* filter = sensor->get_raw_filter();
+    // Published by the sampling task after every sample - no buffer walks from this core
+    const WeightSnapshot snapshot = sensor->get_snapshot();
 
-        // Extended window = settling period + trigger window
+    if (auto_actions_.auto_start_enabled && on_ready_tab && !grinder_active && grinding_controller_) {
+        // Extended window = settling period + trigger window (the snapshot's rise window)
         constexpr uint32_t kExtendedWindow = USER_AUTO_GRIND_TRIGGER_SETTLING_MS + USER_AUTO_GRIND_TRIGGER_WINDOW_MS;
 
-        if (filter && filter->get_buffer_time_span_ms() >= kExtendedWindow) {
+        if (snapshot.buffer_span_ms >= kExtendedWindow) {
             constexpr int kBaseSampleRequirement =
                 (HW_LOADCELL_SAMPLE_RATE_SPS * kExtendedWindow) / 1000;
             constexpr int kMinSamplesForWindow = (kBaseSampleRequirement > 2) ? kBaseSampleRequirement : 2;
 
-            if (sensor->get_sample_count() >= kMinSamplesForWindow) {
-                // Check settled state first (cheap) to short-circuit expensive delta calculation
-                if (sensor->is_settled()) {
-                    float delta_g = 0.0f;
-                    int samples_used = 0;
-                    uint32_t span_ms = 0;
+            if (snapshot.sample_count >= kMinSamplesForWindow) {
+                if (snapshot.settled) {
+                    const float delta_g = snapshot.rise_delta_g;
+                    const uint32_t span_ms = snapshot.rise_span_ms;
 
                     // Weight is settled - now check delta over extended window
-                    if (sensor->get_weight_delta(kExtendedWindow, &delta_g, &samples_used, &span_ms) &&
-                        samples_used >= kMinSamplesForWindow &&
+                    if (snapshot.rise_valid &&
+                        snapshot.rise_samples >= kMinSamplesForWindow &&
                         span_ms <= kExtendedWindow &&
                         delta_g >= USER_AUTO_GRIND_TRIGGER_DELTA_G) {
 
@@ -412,7 +411,7 @@ void UIManager::update_auto_actions() {
     if (state_machine->is_state(UIState::GRIND_COMPLETE) ||
         state_machine->is_state(UIState::GRIND_TIMEOUT)) {
         constexpr float kCompleteExitThresholdG = 2.0f;  // Treat scale as empty once weight drops below this point
-        const float live_weight = sensor->get_weight_low_latency();
+        const float live_weight = snapshot.low_latency_weight;
         const bool rearm_ready =
             (now - auto_actions_.last_auto_return_ms) >= USER_AUTO_GRIND_REARM_DELAY_MS;
 
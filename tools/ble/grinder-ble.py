@@ -17,14 +17,18 @@ Usage:
     ./grinder-ble connect [--interactive]      # Connect and run commands
     ./grinder-ble debug                        # Stream live debug logs
     ./grinder-ble info                         # Get comprehensive device information
+    ./grinder-ble trace [--out trace.json]     # Download task timing trace (Chrome/Perfetto JSON)
+    ./grinder-ble dump-sessions --out DIR      # Write the database's sessions as session_*.bin for `replay`
 """
 
 import argparse
 import asyncio
+import itertools
 import sys
 import os
 import struct
 import time
+import zlib
 import subprocess
 import tempfile
 import sqlite3
@@ -108,12 +112,36 @@ BLE_SYSINFO_DIAGNOSTICS_CHAR_UUID = "22334455-ff00-1111-2222-334455667788"
 BLE_OTA_CMD_START = 0x01
 BLE_OTA_CMD_END = 0x03
 BLE_OTA_CMD_ABORT = 0x04
+BLE_OTA_CMD_BLOCK = 0x05
+BLE_OTA_CMD_QUERY = 0x06
+
+# Resumable OTA (src/bluetooth/ota_block_receiver.h)
+OTA_BLOCK_BYTES = 4096          # BLE_OTA_BLOCK_BYTES - a BLOCK command with the CRC-32 follows each
+OTA_MAX_RESUMES = 5             # Resumes in a row without progress before giving up
+OTA_RECONNECT_ATTEMPTS = 3
 
 BLE_DATA_CMD_STOP_EXPORT = 0x11
 BLE_DATA_CMD_GET_COUNT = 0x12
 BLE_DATA_CMD_CLEAR_DATA = 0x13
 BLE_DATA_CMD_GET_FILE_LIST = 0x14
 BLE_DATA_CMD_REQUEST_FILE = 0x15
+BLE_DATA_CMD_REQUEST_FILE_WINDOWED = 0x16
+BLE_DATA_CMD_ACK = 0x17
+BLE_DATA_CMD_REQUEST_TRACE = 0x18
+BLE_TRACE_TRANSFER_ID = 0xFFFFFFFF   # Bulk transfer id of a task trace download
+
+# Windowed bulk transfer (src/bluetooth/bulk_transfer.h)
+BULK_FRAME_START = 0xB0
+BULK_FRAME_DATA = 0xB1
+BULK_FRAME_END = 0xB2
+BULK_END_OK = 0
+BULK_DATA_HEADER_SIZE = 8
+BULK_MAX_FRAME_BYTES = 512
+BULK_WINDOW = 16
+BULK_MAX_NACK_RANGES = 8
+BULK_STALL_TIMEOUT = 3.0        # Seconds without a frame before re-requesting from the received offset
+BULK_END_TIMEOUT = 2.0          # Seconds to wait for END once every byte is in
+BULK_MAX_RESUMES = 3
 
 BLE_DEBUG_CMD_ENABLE = 0x01
 BLE_DEBUG_CMD_DISABLE = 0x02
@@ -121,10 +149,16 @@ BLE_DEBUG_CMD_DISABLE = 0x02
 BLE_OTA_IDLE = 0x00
 
 # Binary log schema definitions (must match firmware)
-LOG_SCHEMA_VERSION = 2
+LOG_SCHEMA_VERSION = 3
 SESSION_STRUCT_SIZE = 80
 EVENT_STRUCT_SIZE = 44
 MEASUREMENT_STRUCT_SIZE = 24
+EVENT_STRUCT_FORMAT = '<IIIIfffffHHBBB'     # GrindEvent without the trailing reserved byte
+MEASUREMENT_STRUCT_FORMAT = '<IffffHBB'     # GrindMeasurement
+MEASUREMENT_BLOCK_HEADER_SIZE = 12          # Schema v3 (src/logging/session_codec.h)
+MEASUREMENT_COLUMN_COUNT = 6
+SESSION_HEADER_SIZE = 24
+SESSION_FLAG_CRC32 = 0x0001                 # TimeSeriesSessionHeader.flags: checksum is a CRC-32
 BLE_OTA_READY = 0x01
 BLE_OTA_RECEIVING = 0x02
 BLE_OTA_SUCCESS = 0x03
@@ -139,6 +173,108 @@ DEVICE_NAME = "GrindByWeight"
 CHUNK_SIZE = 512
 DATA_CHUNK_SIZE = 500
 
+class BulkReceiver:
+    """Client side of one windowed transfer - a session file or the task trace.
+
+    DATA frames are placed by offset, so a resumed request keeps the bytes already received.
+    ACKs go out every window/2 frames, on a new gap (with NACK ranges for the holes) and on a
+    duplicate - the same policy bench-bulk simulates.
+    """
+
+    def __init__(self, session_id: int):
+        self.session_id = session_id
+        self.data = bytearray()
+        self.total_size = None
+        self.ended = False
+        self.end_status = None
+        self.last_frame_time = time.time()
+        self._start_offset = 0
+        self._payload = 0
+        self._window = BULK_WINDOW
+        self._received = []
+        self._expected = 0
+        self._highest = 0
+        self._since_ack = 0
+
+    @property
+    def started(self) -> bool:
+        return self._payload > 0
+
+    @property
+    def complete(self) -> bool:
+        return self.started and self.contiguous_bytes() >= self.total_size
+
+    def contiguous_bytes(self) -> int:
+        if not self.started:
+            return self._start_offset
+        return min(self.total_size, self._start_offset + self._expected * self._payload)
+
+    def on_frame(self, frame: bytes) -> Optional[bytes]:
+        """Handles one notification. Returns an ACK to write back, if one is due."""
+        self.last_frame_time = time.time()
+        if not frame:
+            return None
+
+        if frame[0] == BULK_FRAME_START and len(frame) >= 20:
+            window, frame_size = frame[2], struct.unpack_from('<H', frame, 4)[0]
+            session_id, total_size, start_offset = struct.unpack_from('<III', frame, 8)
+            if session_id != self.session_id or frame_size <= BULK_DATA_HEADER_SIZE:
+                return None
+            if self.started and start_offset == self._start_offset:
+                return None  # START repeated because no ACK had reached the grinder yet
+            self.total_size = total_size
+            if len(self.data) < total_size:
+                self.data.extend(bytes(total_size - len(self.data)))
+            self._start_offset = start_offset
+            self._window = window or BULK_WINDOW
+            self._payload = frame_size - BULK_DATA_HEADER_SIZE
+            frame_count = (total_size - start_offset + self._payload - 1) // self._payload
+            self._received = [False] * frame_count
+            self._expected = 0
+            self._highest = 0
+            self._since_ack = 0
+            return None
+
+        if frame[0] == BULK_FRAME_DATA and len(frame) > BULK_DATA_HEADER_SIZE and self.started:
+            wire_seq, offset = struct.unpack_from('<HI', frame, 2)
+            seq = self._expected + ((wire_seq - self._expected + 0x8000) & 0xFFFF) - 0x8000
+            payload = frame[BULK_DATA_HEADER_SIZE:]
+            duplicate = seq < self._expected or seq >= len(self._received) or self._received[seq]
+            new_gap = not duplicate and seq > self._highest + 1 and seq > self._expected
+            if not duplicate and offset + len(payload) <= self.total_size:
+                self.data[offset:offset + len(payload)] = payload
+                self._received[seq] = True
+                self._highest = max(self._highest, seq)
+                while self._expected < len(self._received) and self._received[self._expected]:
+                    self._expected += 1
+            self._since_ack += 1
+            if (duplicate or new_gap or self._since_ack >= max(1, self._window // 2)
+                    or self._expected == len(self._received)):
+                self._since_ack = 0
+                return self._build_ack()
+            return None
+
+        if frame[0] == BULK_FRAME_END and len(frame) >= 12:
+            self.ended = True
+            self.end_status = frame[1]
+        return None
+
+    def _build_ack(self) -> bytes:
+        # [0x17][next_seq u16][nack_count u8] then nack_count x [start_seq u16][count u8]
+        ranges = []
+        seq = self._expected
+        while seq < self._highest and len(ranges) < BULK_MAX_NACK_RANGES:
+            if self._received[seq]:
+                seq += 1
+                continue
+            count = 0
+            while seq + count < self._highest and not self._received[seq + count] and count < 255:
+                count += 1
+            ranges.append(struct.pack('<HB', seq & 0xFFFF, count))
+            seq += count
+        return struct.pack('<BHB', BLE_DATA_CMD_ACK, self._expected & 0xFFFF, len(ranges)) + b"".join(ranges)
+
+
 class GrinderBLETool:
     """Unified BLE tool for all grinder operations."""
     
@@ -146,9 +282,13 @@ class GrinderBLETool:
         self.client: Optional[BleakClient] = None
         self.connected = False
         self.current_ota_status = BLE_OTA_IDLE
+        self.ota_resume_offset: Optional[int] = None   # Last verified patch offset, None on older firmware
         self.current_data_status = BLE_DATA_IDLE
         self.status_updated = asyncio.Event()
         self.data_chunks = []
+        self.bulk_receiver: Optional[BulkReceiver] = None
+        self.windowed_transfer_supported = True
+        self._pending_acks = set()
         self.session_count = 0
         self.receiving_data = False
         self.debug_buffer = ""
@@ -278,10 +418,19 @@ class GrinderBLETool:
     async def on_ota_status(self, _: BleakGATTCharacteristic, data: bytearray):
         if len(data) > 0:
             self.current_ota_status = data[0]
+            self.ota_resume_offset = struct.unpack_from('<I', data, 1)[0] if len(data) >= 5 else None
             self.status_updated.set()
     
     def on_data_received(self, _: BleakGATTCharacteristic, data: bytearray):
-        if self.receiving_data:
+        if self.bulk_receiver is not None:
+            ack = self.bulk_receiver.on_frame(bytes(data))
+            if ack is not None:
+                # Notification callbacks cannot await; write without response so ACKs never queue
+                task = asyncio.ensure_future(
+                    self.client.write_gatt_char(BLE_DATA_CONTROL_CHAR_UUID, ack, response=False))
+                self._pending_acks.add(task)
+                task.add_done_callback(self._pending_acks.discard)
+        elif self.receiving_data:
             self.data_chunks.append(bytes(data))
     
     def on_debug_message(self, _: BleakGATTCharacteristic, data: bytearray):
@@ -468,6 +617,7 @@ class GrinderBLETool:
             self.safe_print(f"[INFO] Full update: {patch_size//1024}KB ({self.full_reason})")
         
         # Protocol: [CMD][patch_size:4][is_full_update:1][build_number_length:1][build_number:N]
+        #           [version_length:1][version:N][patch_crc32:4]
         start_data = struct.pack('<I', patch_size)
         
         # Add full update flag (1 byte: 1 for full update, 0 for delta)
@@ -482,24 +632,48 @@ class GrinderBLETool:
         else:
             # No build number
             start_data += struct.pack('<B', 0)
+
+        # No firmware version, then the patch CRC: the grinder checks every block and can resume
+        start_data += struct.pack('<BI', 0, zlib.crc32(patch_data))
             
         self.safe_print(f"[INFO] Sending {'full' if is_full_update else 'delta'} update flag")
-        await self.client.write_gatt_char(BLE_OTA_CONTROL_CHAR_UUID, bytes([BLE_OTA_CMD_START]) + start_data)
-        
-        if not await self.wait_for_ota_status(BLE_OTA_RECEIVING, timeout=15): return False
-        
         start_time = time.time()
-        try:
-            for i in range(0, len(patch_data), CHUNK_SIZE):
-                chunk = patch_data[i:i + CHUNK_SIZE]
-                await self.client.write_gatt_char(BLE_OTA_DATA_CHAR_UUID, chunk)
-                progress = int(((i + len(chunk)) / patch_size) * 100)
-                if progress % 5 == 0:
-                    self._update_status(f"[UPLOAD] Uploading: {progress}%")
-                await asyncio.sleep(0.01)
-        except Exception:
-            await self.client.write_gatt_char(BLE_OTA_CONTROL_CHAR_UUID, bytes([BLE_OTA_CMD_ABORT]))
-            return False
+        last_offset = -1
+        stalled = 0
+        for attempt in itertools.count():
+            if attempt > 0:
+                if not await self._reconnect_for_ota():
+                    return False
+                # The grinder keeps the verified blocks; START with the same patch continues after them
+                await self.client.write_gatt_char(BLE_OTA_CONTROL_CHAR_UUID, bytes([BLE_OTA_CMD_QUERY]))
+                await asyncio.sleep(0.3)
+                if self.ota_resume_offset:
+                    self.safe_print(f"[INFO] Grinder holds {self.ota_resume_offset // 1024}KB of the patch")
+
+            self.current_ota_status = BLE_OTA_IDLE
+            await self.client.write_gatt_char(BLE_OTA_CONTROL_CHAR_UUID, bytes([BLE_OTA_CMD_START]) + start_data)
+            if not await self.wait_for_ota_status(BLE_OTA_RECEIVING, timeout=15): return False
+
+            # Older firmware neither reports an offset nor checks blocks, and always starts at 0
+            offset = self.ota_resume_offset or 0
+            stalled = 0 if offset > last_offset else stalled + 1
+            last_offset = offset
+            if stalled > OTA_MAX_RESUMES:
+                self.safe_print(f"[ERROR] Upload made no progress in {stalled} attempts - giving up")
+                try:
+                    await self.client.write_gatt_char(BLE_OTA_CONTROL_CHAR_UUID, bytes([BLE_OTA_CMD_ABORT]))
+                except Exception:
+                    pass
+                return False
+            if offset > 0:
+                self.safe_print(f"[INFO] Resuming upload at {offset // 1024}KB")
+
+            try:
+                if await self._send_patch_blocks(patch_data, offset):
+                    break
+                self.safe_print(f"\n[WARNING] Grinder rejected a block - resending from the last verified one")
+            except Exception as e:
+                self.safe_print(f"\n[WARNING] Upload interrupted: {e}")
         
         self.safe_print(f"\n[OK] Upload complete in {time.time() - start_time:.1f}s")
         self.safe_print("[INFO] Applying update...")
@@ -509,12 +683,157 @@ class GrinderBLETool:
         except BleakError:
             return True
 
+    async def _send_patch_blocks(self, patch_data: bytes, offset: int) -> bool:
+        """Sends the patch from offset, each OTA_BLOCK_BYTES block followed by its CRC-32.
+        False if the grinder rejected a block; link errors raise."""
+        patch_size = len(patch_data)
+        for block_start in range(offset, patch_size, OTA_BLOCK_BYTES):
+            block = patch_data[block_start:block_start + OTA_BLOCK_BYTES]
+            for i in range(0, len(block), CHUNK_SIZE):
+                chunk = block[i:i + CHUNK_SIZE]
+                await self.client.write_gatt_char(BLE_OTA_DATA_CHAR_UUID, chunk)
+                progress = int(((block_start + i + len(chunk)) / patch_size) * 100)
+                if progress % 5 == 0:
+                    self._update_status(f"[UPLOAD] Uploading: {progress}%")
+                await asyncio.sleep(0.01)
+            await self.client.write_gatt_char(BLE_OTA_CONTROL_CHAR_UUID,
+                                              struct.pack('<BII', BLE_OTA_CMD_BLOCK, block_start, zlib.crc32(block)))
+            if self.current_ota_status == BLE_OTA_ERROR:
+                return False
+        return True
+
+    async def _reconnect_for_ota(self) -> bool:
+        for attempt in range(OTA_RECONNECT_ATTEMPTS):
+            if self.client and self.client.is_connected:
+                return True
+            self.safe_print("[INFO] Reconnecting to resume the upload...")
+            self.connected = False
+            await asyncio.sleep(1.0)
+            if await self.connect_to_device():
+                return True
+        self.safe_print("[ERROR] Could not reconnect - run the upload again to resume it")
+        return False
+
     # === Data Export Functions (Refactored) ===
     async def get_session_count(self) -> int:
         await self.client.write_gatt_char(BLE_DATA_CONTROL_CHAR_UUID, bytes([BLE_DATA_CMD_GET_COUNT]))
         await asyncio.sleep(1)
         return self.session_count
     
+    async def _receive_file_windowed(self, session_id: int) -> Optional[bytes]:
+        """Fetches one session file with the windowed protocol, resuming from the bytes already
+        received when the transfer stalls. Returns None if the grinder reported an error, which is
+        also how firmware without the windowed protocol answers the request."""
+        def build_request(offset: int, frame_size: int) -> bytes:
+            return struct.pack('<BIIBH', BLE_DATA_CMD_REQUEST_FILE_WINDOWED, session_id, offset,
+                               BULK_WINDOW, frame_size)
+        return await self._receive_windowed(session_id, build_request, f"session {session_id}")
+
+    async def _receive_windowed(self, transfer_id: int, build_request, label: str) -> Optional[bytes]:
+        """Runs one windowed bulk transfer. build_request(offset, frame_size) returns the control
+        command that starts (offset 0) or resumes it."""
+        receiver = BulkReceiver(transfer_id)
+        mtu = getattr(self.client, 'mtu_size', 0) or 0
+        frame_size = min(BULK_MAX_FRAME_BYTES, mtu - 3) if mtu - 3 > BULK_DATA_HEADER_SIZE else 0
+
+        try:
+            for attempt in range(BULK_MAX_RESUMES + 1):
+                offset = receiver.contiguous_bytes()
+                if attempt > 0:
+                    self.safe_print(f"[INFO] Transfer stalled - resuming {label} at byte {offset}")
+                    # The grinder ignores a new request while it still considers the old one running
+                    await self.client.write_gatt_char(BLE_DATA_CONTROL_CHAR_UUID, bytes([BLE_DATA_CMD_STOP_EXPORT]))
+                    await asyncio.sleep(0.1)
+
+                self.bulk_receiver = receiver
+                self.current_data_status = BLE_DATA_IDLE
+                receiver.last_frame_time = time.time()
+                await self.client.write_gatt_char(BLE_DATA_CONTROL_CHAR_UUID, build_request(offset, frame_size))
+
+                while not receiver.complete and not receiver.ended:
+                    if self.current_data_status == BLE_DATA_ERROR:
+                        return None
+                    if time.time() - receiver.last_frame_time > BULK_STALL_TIMEOUT:
+                        break
+                    await asyncio.sleep(0.05)
+
+                if receiver.ended and receiver.end_status != BULK_END_OK:
+                    self.safe_print(f"[ERROR] Grinder could not read {label}")
+                    return None
+                if receiver.complete:
+                    # The grinder sends END once it sees the final ACK; a lost ACK is resent on its timeout
+                    end_wait_start = time.time()
+                    while not receiver.ended and time.time() - end_wait_start < BULK_END_TIMEOUT:
+                        await asyncio.sleep(0.05)
+                    if not receiver.ended:
+                        await self.client.write_gatt_char(BLE_DATA_CONTROL_CHAR_UUID, bytes([BLE_DATA_CMD_STOP_EXPORT]))
+                    return bytes(receiver.data[:receiver.total_size])
+
+            self.safe_print(f"[ERROR] Transfer of {label} stalled {BULK_MAX_RESUMES + 1} times - giving up")
+            return None
+        finally:
+            self.bulk_receiver = None
+
+    async def download_trace(self, json_path: Optional[str] = None, raw_path: Optional[str] = None) -> bool:
+        """Downloads the task trace rings, prints per-task timing percentiles and optionally
+        writes Chrome/Perfetto trace JSON (open in https://ui.perfetto.dev)."""
+        import task_trace
+
+        def build_request(offset: int, frame_size: int) -> bytes:
+            # Offset 0 captures a fresh snapshot; a resume continues the one already taken
+            return struct.pack('<BIBH', BLE_DATA_CMD_REQUEST_TRACE, offset, BULK_WINDOW, frame_size)
+
+        self.safe_print("[INFO] Capturing task trace...")
+        start_time = time.time()
+        data = await self._receive_windowed(BLE_TRACE_TRANSFER_ID, build_request, "task trace")
+        if data is None:
+            self.safe_print("[ERROR] Grinder has no task trace (built with SYS_TASK_TRACE=0?)")
+            return False
+        self.safe_print(f"[OK] Received {len(data)} bytes in {time.time() - start_time:.1f}s")
+
+        if raw_path:
+            with open(raw_path, 'wb') as f:
+                f.write(data)
+            self.safe_print(f"[OK] Raw capture saved to {raw_path}")
+
+        try:
+            trace = task_trace.parse_trace(data)
+        except task_trace.TraceFormatError as e:
+            self.safe_print(f"[ERROR] Unreadable trace: {e}")
+            return False
+
+        slices = task_trace.build_slices(trace)
+        task_trace.print_report(trace, task_trace.task_statistics(slices))
+        if json_path:
+            with open(json_path, 'w') as f:
+                json.dump(task_trace.to_chrome_trace(trace, slices), f)
+            self.safe_print(f"[OK] Trace JSON saved to {json_path}")
+        return True
+
+    async def _receive_file_legacy(self, session_id: int) -> Optional[bytes]:
+        """Fetches one session file with the original paced stream (no loss recovery)."""
+        # Set up reception state BEFORE sending command to avoid race condition
+        self.data_chunks = []
+        self.receiving_data = True
+
+        request_data = bytes([BLE_DATA_CMD_REQUEST_FILE]) + struct.pack('<I', session_id)
+        await self.client.write_gatt_char(BLE_DATA_CONTROL_CHAR_UUID, request_data)
+
+        file_start_time = time.time()
+        timeout_seconds = 30
+
+        while self.receiving_data and (time.time() - file_start_time) < timeout_seconds:
+            await asyncio.sleep(0.1)
+
+        if self.receiving_data:
+            self.receiving_data = False
+            self.safe_print(f"[ERROR] Timeout waiting for session file {session_id}")
+            return None
+
+        if not self.data_chunks or self.current_data_status == BLE_DATA_ERROR:
+            return None
+        return b"".join(self.data_chunks)
+
     async def export_data(self, db_path: str = None) -> bool:
         if db_path is None:
             # Default to tools/database/grinder_data.db
@@ -580,30 +899,21 @@ class GrinderBLETool:
             self.safe_print(f"[INFO] Requesting session file {session_id} ({i+1}/{len(session_ids)})")
             
             # Request individual file
-            request_data = bytes([BLE_DATA_CMD_REQUEST_FILE]) + struct.pack('<I', session_id)
-            await self.client.write_gatt_char(BLE_DATA_CONTROL_CHAR_UUID, request_data)
-            
-            # Wait for file transfer
-            self.data_chunks = []
-            self.receiving_data = True
-            
-            file_start_time = time.time()
-            timeout_seconds = 30
-            
-            while self.receiving_data and (time.time() - file_start_time) < timeout_seconds:
-                await asyncio.sleep(0.1)
-            
-            if self.receiving_data:
-                self.safe_print(f"[ERROR] Timeout waiting for session file {session_id}")
-                continue
-            
-            if not self.data_chunks:
+            file_data = None
+            if self.windowed_transfer_supported:
+                file_data = await self._receive_file_windowed(session_id)
+            if file_data is None:
+                file_data = await self._receive_file_legacy(session_id)
+                if file_data is not None and self.windowed_transfer_supported:
+                    self.safe_print("[INFO] Grinder firmware has no windowed transfer - using the paced stream")
+                    self.windowed_transfer_supported = False
+
+            if not file_data:
                 self.safe_print(f"[ERROR] No data received for session {session_id}")
                 continue
             
             # Process individual file
             try:
-                file_data = b"".join(self.data_chunks)
                 self.safe_print(f"[INFO] Received {len(file_data)} bytes for session {session_id}")
                 
                 # Parse this single session file
@@ -631,13 +941,118 @@ class GrinderBLETool:
             self.safe_print("[ERROR] No sessions were successfully processed")
             return False
     
+    @staticmethod
+    def _read_varint(data: bytes, pos: int) -> Tuple[int, int]:
+        value = 0
+        shift = 0
+        while True:
+            if pos >= len(data) or shift > 28:
+                raise ValueError(f"Truncated or oversized varint at offset {pos}")
+            byte = data[pos]
+            pos += 1
+            value |= (byte & 0x7F) << shift
+            if not byte & 0x80:
+                return value, pos
+            shift += 7
+
+    @staticmethod
+    def _zigzag_decode(value: int) -> int:
+        return (value >> 1) ^ -(value & 1)
+
+    def _decode_v3_events(self, data: bytes, pos: int, count: int) -> Tuple[List[tuple], int]:
+        """Schema v3 event block: varint integers, floats only when non-zero (mask byte)."""
+        events = []
+        timestamp_ms = 0
+        for index in range(count):
+            delta, pos = self._read_varint(data, pos)
+            timestamp_ms += self._zigzag_decode(delta)
+            duration_ms, pos = self._read_varint(data, pos)
+            grind_latency_ms, pos = self._read_varint(data, pos)
+            settling_duration_ms, pos = self._read_varint(data, pos)
+            if pos >= len(data):
+                raise ValueError(f"Event block truncated at event {index}")
+            mask = data[pos]
+            pos += 1
+            floats = []
+            for bit in range(5):
+                if mask & (1 << bit):
+                    floats.append(struct.unpack_from('<f', data, pos)[0])
+                    pos += 4
+                else:
+                    floats.append(0.0)
+            loop_count, pos = self._read_varint(data, pos)
+            if pos + 3 > len(data):
+                raise ValueError(f"Event block truncated at event {index}")
+            phase_id, pulse_attempt_number, event_flags = data[pos], data[pos + 1], data[pos + 2]
+            pos += 3
+            events.append((timestamp_ms, duration_ms, grind_latency_ms, settling_duration_ms, *floats,
+                           index, loop_count, phase_id, pulse_attempt_number, event_flags))
+        return events, pos
+
+    def _decode_v3_numeric_column(self, data: bytes, pos: int, count: int) -> Tuple[List[int], int]:
+        """Tokens: zigzag(value) << 1 for a non-zero value, run_length << 1 | 1 for a zero run."""
+        values = []
+        while len(values) < count:
+            token, pos = self._read_varint(data, pos)
+            if token & 1:
+                values.extend([0] * (token >> 1))
+            else:
+                values.append(self._zigzag_decode(token >> 1))
+        if len(values) != count:
+            raise ValueError("Zero run overruns measurement column")
+        return values, pos
+
+    def _decode_v3_measurements(self, data: bytes, pos: int, count: int) -> List[tuple]:
+        """Schema v3 measurement block: delta/zigzag varint columns plus phase/motor runs."""
+        if pos + MEASUREMENT_BLOCK_HEADER_SIZE > len(data):
+            raise ValueError("Measurement block header truncated")
+        weight_quantum, flow_quantum, column_count = struct.unpack_from('<ffB', data, pos)
+        if column_count != MEASUREMENT_COLUMN_COUNT:
+            raise ValueError(f"Unsupported measurement column count {column_count}")
+        pos += MEASUREMENT_BLOCK_HEADER_SIZE
+
+        def running_sum(values):
+            total = 0
+            for value in values:
+                total += value
+                yield total
+
+        timestamp_dd, pos = self._decode_v3_numeric_column(data, pos, count)
+        weight_steps, pos = self._decode_v3_numeric_column(data, pos, count)
+        delta_residuals, pos = self._decode_v3_numeric_column(data, pos, count)
+        flow_steps, pos = self._decode_v3_numeric_column(data, pos, count)
+        target_steps, pos = self._decode_v3_numeric_column(data, pos, count)
+
+        timestamps = list(running_sum(running_sum(timestamp_dd)))
+        weights_q = list(running_sum(weight_steps))
+        flows_q = list(running_sum(flow_steps))
+        targets_q = list(running_sum(target_steps))
+
+        phases = []
+        while len(phases) < count:
+            run, pos = self._read_varint(data, pos)
+            if run == 0 or pos + 2 > len(data) or len(phases) + run > count:
+                raise ValueError("Malformed phase run in measurement block")
+            phases.extend([(data[pos], data[pos + 1])] * run)
+            pos += 2
+
+        measurements = []
+        previous_weight_q = 0
+        for i in range(count):
+            weight_delta_q = delta_residuals[i] + weights_q[i] - previous_weight_q
+            previous_weight_q = weights_q[i]
+            phase_id, motor_is_on = phases[i]
+            measurements.append((timestamps[i], weights_q[i] * weight_quantum, weight_delta_q * weight_quantum,
+                                 flows_q[i] * flow_quantum, targets_q[i] * weight_quantum, i, motor_is_on, phase_id))
+        return measurements
+
     def _parse_single_file_data(self, file_data: bytes, session_id: int) -> Tuple[List[Dict], List[Dict], List[Dict]]:
         """Parse data from a single session file.
         Format on device (LittleFS):
         [TimeSeriesSessionHeader (24 bytes)]
         [GrindSession (80 bytes)]
-        [GrindEvent x event_count (44 bytes each)]
-        [GrindMeasurement x measurement_count (24 bytes each)]
+        schema 2: [GrindEvent x event_count (44 bytes each)] [GrindMeasurement x measurement_count (24 bytes each)]
+        schema 3: [event block] [measurement block] (see src/logging/session_codec.h)
         """
         if len(file_data) < (24 + SESSION_STRUCT_SIZE):
             raise ValueError(f"File data too small: {len(file_data)} bytes")
@@ -653,12 +1068,18 @@ class GrinderBLETool:
         
         # Parse 24-byte TimeSeriesSessionHeader
         hdr_session_id, hdr_session_ts, hdr_session_size, hdr_checksum, event_count, measurement_count, \
-            schema_version, _reserved = struct.unpack_from('<IIIIHHHH', file_data, offset)
-        offset += 24
+            schema_version, hdr_flags = struct.unpack_from('<IIIIHHHH', file_data, offset)
+        offset += SESSION_HEADER_SIZE
 
         if hdr_session_id != session_id:
             raise ValueError(f"Header session ID mismatch: expected {session_id}, got {hdr_session_id}")
-        if schema_version != LOG_SCHEMA_VERSION:
+        if hdr_flags & SESSION_FLAG_CRC32:
+            # Body first, then the header with its checksum field zeroed (see session_file_checksum)
+            unsigned_header = file_data[:12] + b'\x00\x00\x00\x00' + file_data[16:SESSION_HEADER_SIZE]
+            crc = zlib.crc32(unsigned_header, zlib.crc32(file_data[SESSION_HEADER_SIZE:]))
+            if crc != hdr_checksum:
+                raise ValueError(f"Checksum mismatch: header 0x{hdr_checksum:08X}, data 0x{crc:08X}")
+        if schema_version not in (2, LOG_SCHEMA_VERSION):
             self.safe_print(
                 f"[WARNING] Session {session_id} uses schema {schema_version}, expected {LOG_SCHEMA_VERSION}. Attempting to parse anyway."
             )
@@ -725,33 +1146,34 @@ class GrinderBLETool:
             'checksum': hdr_checksum
         }
         
+        # Decode both layouts into struct-ordered tuples
+        if schema_version >= 3:
+            event_records, offset = self._decode_v3_events(file_data, offset, event_count)
+            measurement_records = self._decode_v3_measurements(file_data, offset, measurement_count)
+        else:
+            event_records = []
+            for event_idx in range(event_count):
+                if offset + EVENT_STRUCT_SIZE > len(file_data):
+                    raise ValueError(f"File too small for event at offset {offset}")
+                event_records.append(struct.unpack_from(EVENT_STRUCT_FORMAT, file_data, offset))
+                offset += EVENT_STRUCT_SIZE
+            measurement_records = []
+            for meas_idx in range(measurement_count):
+                if offset + MEASUREMENT_STRUCT_SIZE > len(file_data):
+                    raise ValueError(f"File too small for measurement at offset {offset}")
+                measurement_records.append(struct.unpack_from(MEASUREMENT_STRUCT_FORMAT, file_data, offset))
+                offset += MEASUREMENT_STRUCT_SIZE
+
         events = []
-        EVENT_SIZE = EVENT_STRUCT_SIZE
         expected_event_sequence = 0  # Events should start at 0 and increment
 
-        for event_idx in range(event_count):
-            if offset + EVENT_SIZE > len(file_data):
-                raise ValueError(f"File too small for event at offset {offset}")
-
-            event_bytes = file_data[offset:offset + EVENT_SIZE]
-            timestamp_ms = struct.unpack_from('<I', event_bytes, 0)[0]
-            duration_ms = struct.unpack_from('<I', event_bytes, 4)[0]
-            grind_latency_ms = struct.unpack_from('<I', event_bytes, 8)[0]
-            settling_duration_ms = struct.unpack_from('<I', event_bytes, 12)[0]
-            start_weight = struct.unpack_from('<f', event_bytes, 16)[0]
-            end_weight = struct.unpack_from('<f', event_bytes, 20)[0]
-            motor_stop_target_weight = struct.unpack_from('<f', event_bytes, 24)[0]
-            pulse_duration_ms = struct.unpack_from('<f', event_bytes, 28)[0]
-            pulse_flow_rate = struct.unpack_from('<f', event_bytes, 32)[0]
-            event_sequence_id = struct.unpack_from('<H', event_bytes, 36)[0]
-            loop_count = struct.unpack_from('<H', event_bytes, 38)[0]
-            phase_id = struct.unpack_from('<B', event_bytes, 40)[0]
-            pulse_attempt_number = struct.unpack_from('<B', event_bytes, 41)[0]
-            event_flags = struct.unpack_from('<B', event_bytes, 42)[0]
+        for event_idx, record in enumerate(event_records):
+            (timestamp_ms, duration_ms, grind_latency_ms, settling_duration_ms, start_weight, end_weight,
+             motor_stop_target_weight, pulse_duration_ms, pulse_flow_rate, event_sequence_id, loop_count,
+             phase_id, pulse_attempt_number, event_flags) = record
 
             if timestamp_ms == 0xFFFFFFFF or phase_id == 0xFF:  # Skip invalid/empty events
                 expected_event_sequence += 1
-                offset += EVENT_SIZE
                 continue
 
             if event_sequence_id != expected_event_sequence:
@@ -759,7 +1181,6 @@ class GrinderBLETool:
                     f"Event sequence out of order: expected {expected_event_sequence}, got {event_sequence_id} at event {event_idx}"
                 )
 
-            offset += EVENT_SIZE
             event = {
                 'session_id': parsed_session_id,
                 'timestamp_ms': timestamp_ms,
@@ -782,33 +1203,20 @@ class GrinderBLETool:
             expected_event_sequence += 1
 
         measurements = []
-        MEASUREMENT_SIZE = MEASUREMENT_STRUCT_SIZE
         expected_measurement_sequence = 0  # Measurements should start at 0 and increment
 
-        for meas_idx in range(measurement_count):
-            if offset + MEASUREMENT_SIZE > len(file_data):
-                raise ValueError(f"File too small for measurement at offset {offset}")
-
-            meas_bytes = file_data[offset:offset + MEASUREMENT_SIZE]
-            timestamp_ms = struct.unpack_from('<I', meas_bytes, 0)[0]
-            weight_grams = struct.unpack_from('<f', meas_bytes, 4)[0]
-            weight_delta = struct.unpack_from('<f', meas_bytes, 8)[0]
-            flow_rate_g_per_s = struct.unpack_from('<f', meas_bytes, 12)[0]
-            motor_stop_target_weight = struct.unpack_from('<f', meas_bytes, 16)[0]
-            sequence_id = struct.unpack_from('<H', meas_bytes, 20)[0]
-            motor_is_on = struct.unpack_from('<B', meas_bytes, 22)[0]
-            phase_id = struct.unpack_from('<B', meas_bytes, 23)[0]
+        for meas_idx, record in enumerate(measurement_records):
+            (timestamp_ms, weight_grams, weight_delta, flow_rate_g_per_s, motor_stop_target_weight,
+             sequence_id, motor_is_on, phase_id) = record
 
             if timestamp_ms == 0xFFFFFFFF or weight_grams == -999.0:  # Skip invalid measurements
                 expected_measurement_sequence += 1
-                offset += MEASUREMENT_SIZE
                 continue
 
             # Fail fast on any sequence error - skip entire session
             if sequence_id != expected_measurement_sequence:
                 raise ValueError(f"Session {parsed_session_id} corrupted: measurement sequence error at index {meas_idx} (expected {expected_measurement_sequence}, got {sequence_id})")
 
-            offset += MEASUREMENT_SIZE
             measurement = {
                 'session_id': parsed_session_id,
                 'sequence_id': sequence_id,
@@ -924,7 +1332,56 @@ class GrinderBLETool:
                 [(m['session_id'], m['sequence_id'], m['timestamp_ms'], m['weight_grams'], m['weight_delta'], m['flow_rate_g_per_s'], m['motor_is_on'], m['phase_id'], m['phase_name'], m['motor_stop_target_weight']) for m in measurements])
             
             conn.commit()
-    
+
+    def dump_sessions(self, db_path: str, out_dir: str) -> bool:
+        """Write every session in the database back out as a raw schema v2 session_<id>.bin
+        (header, GrindSession, events, measurements) for the native replay tools."""
+        if db_path is None:
+            tools_dir = Path(__file__).parent.parent
+            db_path = str(tools_dir / "database" / "grinder_data.db")
+        if not os.path.exists(db_path):
+            self.safe_print(f"[ERROR] Database not found: {db_path}")
+            return False
+        os.makedirs(out_dir, exist_ok=True)
+
+        with sqlite3.connect(db_path) as conn:
+            conn.row_factory = sqlite3.Row
+            cursor = conn.cursor()
+            sessions = cursor.execute("SELECT * FROM grind_sessions ORDER BY session_id").fetchall()
+            for s in sessions:
+                events = cursor.execute(
+                    "SELECT * FROM grind_events WHERE session_id = ? ORDER BY event_sequence_id", (s['session_id'],)).fetchall()
+                measurements = cursor.execute(
+                    "SELECT * FROM grind_measurements WHERE session_id = ? ORDER BY sequence_id", (s['session_id'],)).fetchall()
+
+                body = struct.pack('<IIIIIiffffffffBBBBB3x16s',
+                                   s['session_id'], s['session_timestamp'] or 0, s['target_time_ms'] or 0,
+                                   s['total_time_ms'] or 0, s['total_motor_on_time_ms'] or 0, s['time_error_ms'] or 0,
+                                   s['target_weight'] or 0.0, s['tolerance'] or 0.0, s['final_weight'] or 0.0,
+                                   s['error_grams'] or 0.0, s['start_weight'] or 0.0, 0.0,
+                                   s['latency_to_coast_ratio'] or 0.0, s['flow_rate_threshold'] or 0.0,
+                                   s['profile_id'] or 0, s['grind_mode'] or 0, s['max_pulse_attempts'] or 0,
+                                   s['pulse_count'] or 0, s['termination_reason'] if s['termination_reason'] is not None else 255,
+                                   (s['result_status'] or '').encode('utf-8')[:15])
+                for e in events:
+                    body += struct.pack(EVENT_STRUCT_FORMAT + 'x',
+                                        e['timestamp_ms'], e['duration_ms'], e['grind_latency_ms'], e['settling_duration_ms'],
+                                        e['start_weight'], e['end_weight'], e['motor_stop_target_weight'],
+                                        e['pulse_duration_ms'], e['pulse_flow_rate'], e['event_sequence_id'],
+                                        e['loop_count'], e['phase_id'], e['pulse_attempt_number'], e['event_flags'] or 0)
+                for m in measurements:
+                    body += struct.pack(MEASUREMENT_STRUCT_FORMAT,
+                                        m['timestamp_ms'], m['weight_grams'], m['weight_delta'], m['flow_rate_g_per_s'],
+                                        m['motor_stop_target_weight'], m['sequence_id'], int(m['motor_is_on']), m['phase_id'])
+
+                header = struct.pack('<IIIIHHHH', s['session_id'], s['session_timestamp'] or 0, len(body), 0,
+                                     len(events), len(measurements), 2, 0)
+                with open(os.path.join(out_dir, f"session_{s['session_id']}.bin"), 'wb') as f:
+                    f.write(header + body)
+
+        self.safe_print(f"[OK] Wrote {len(sessions)} session files to {out_dir}")
+        return True
+
     # === Analyze Data (Export + Streamlit Report) ===
     async def analyze_data(self, db_path: str = None, skip_export: bool = False) -> bool:
         """Export data from grinder and launch Streamlit report."""
@@ -1213,8 +1670,14 @@ async def main():
     sysinfo_parser = subparsers.add_parser('info', help='Get comprehensive device system information')
     diagnostics_parser = subparsers.add_parser('diagnostics', help='Get comprehensive diagnostic report for GitHub issues')
     diagnostics_parser.add_argument('--save', metavar='FILE', help='Save report to file (default: print to console)')
-
-    for p in [upload_parser, export_parser, analyse_parser, connect_parser, debug_parser, sysinfo_parser, diagnostics_parser]:
+    trace_parser = subparsers.add_parser('trace', help='Download task timing trace and print per-task percentiles')
+    trace_parser.add_argument('--out', metavar='FILE', help='Write Chrome/Perfetto trace JSON')
+    trace_parser.add_argument('--raw', metavar='FILE', help='Save the raw capture (decode later with task_trace.py)')
+    dump_parser = subparsers.add_parser('dump-sessions', help='Write exported sessions as session_*.bin files (no device needed)')
+    dump_parser.add_argument('--db', default=None, help='Database file (default: tools/database/grinder_data.db)')
+    dump_parser.add_argument('--out', required=True, metavar='DIR', help='Output directory')
+
+    for p in [upload_parser, export_parser, analyse_parser, connect_parser, debug_parser, sysinfo_parser, diagnostics_parser, trace_parser]:
         p.add_argument('--device', default=DEVICE_NAME, help='Device name to connect to')
 
     args = parser.parse_args()
@@ -1223,8 +1686,11 @@ async def main():
     try:
         if args.command == 'scan':
             await tool.scan_devices()
+
+        elif args.command == 'dump-sessions':
+            return 0 if tool.dump_sessions(args.db, args.out) else 1
         
-        elif args.command in ['upload', 'export', 'analyse', 'connect', 'debug', 'info', 'diagnostics']:
+        elif args.command in ['upload', 'export', 'analyse', 'connect', 'debug', 'info', 'diagnostics', 'trace']:
             if not await tool.connect_to_device(args.device): return 1
 
             if args.command == 'upload':
@@ -1261,6 +1727,8 @@ async def main():
                         print()
                 else:
                     tool.safe_print("[ERROR] Failed to retrieve diagnostic report")
+            elif args.command == 'trace':
+                await tool.download_trace(args.out, args.raw)
 
             await tool.disconnect()
             
@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+"""
+Task trace decoder - turns a capture from the grinder's task trace recorder
+(src/system/task_trace.h, downloaded with `grinder-ble.py trace`) into Chrome/Perfetto
+trace JSON and prints per-task timing percentiles.
+
+Usage:
+    python3 tools/ble/task_trace.py trace.bin                  # Percentile report
+    python3 tools/ble/task_trace.py trace.bin --json trace.json  # Also write trace JSON
+
+Open the JSON in https://ui.perfetto.dev or chrome://tracing. Each core is a process and
+each task a thread; the UI frame slices nest inside the UI render cycle.
+"""
+
+import argparse
+import json
+import struct
+import sys
+from typing import Dict, List, Optional
+
+# Snapshot layout - must match task_trace.h
+TRACE_MAGIC = 0x43525447            # "GTRC"
+TRACE_FORMAT_VERSION = 1
+TRACE_HEADER_FORMAT = '<IBBBBI'
+TRACE_CORE_FORMAT = '<II'           # recorded, count
+TRACE_EVENT_FORMAT = '<IBBH'        # time_us, id, type, arg
+TRACE_EVENT_SIZE = 8
+
+TRACE_EVENT_BEGIN = 0
+TRACE_EVENT_END = 1
+TRACE_EVENT_INSTANT = 2
+TRACE_ARG_QUEUE_FULL = 0xFFFF
+
+# TraceId -> (name, track). Slices on the same track nest.
+TRACE_IDS = {
+    0: ("WeightSampling", "WeightSampling"),
+    1: ("GrindControl", "GrindControl"),
+    2: ("UIRender", "UIRender"),
+    3: ("Bluetooth", "Bluetooth"),
+    4: ("FileIO", "FileIO"),
+    5: ("DisplayFlush", "DisplayFlush"),
+    6: ("UIFrame", "UIRender"),
+    32: ("SampleNotify", "WeightSampling"),
+    33: ("QueueUIEvent", "GrindControl"),
+    34: ("QueueFlashOp", "GrindControl"),
+    35: ("QueueLog", "GrindControl"),
+    36: ("QueueUIStatus", "Bluetooth"),
+}
+
+PERCENTILES = (50, 90, 99, 99.9)
+
+
+class TraceFormatError(ValueError):
+    pass
+
+
+def trace_name(trace_id: int) -> str:
+    return TRACE_IDS.get(trace_id, (f"Id{trace_id}", f"Id{trace_id}"))[0]
+
+
+def trace_track(trace_id: int) -> str:
+    return TRACE_IDS.get(trace_id, (f"Id{trace_id}", f"Id{trace_id}"))[1]
+
+
+def parse_trace(data: bytes) -> Dict:
+    """Decodes a snapshot. Event times are returned in microseconds relative to the oldest
+    record, unwrapped against the capture time (valid for captures shorter than ~71 minutes)."""
+    header_size = struct.calcsize(TRACE_HEADER_FORMAT)
+    if len(data) < header_size:
+        raise TraceFormatError("capture is shorter than the header")
+    magic, version, core_count, event_size, _, capture_us = struct.unpack_from(TRACE_HEADER_FORMAT, data, 0)
+    if magic != TRACE_MAGIC:
+        raise TraceFormatError(f"bad magic 0x{magic:08X}")
+    if version != TRACE_FORMAT_VERSION or event_size != TRACE_EVENT_SIZE:
+        raise TraceFormatError(f"unsupported trace version {version} (event size {event_size})")
+
+    pos = header_size
+    core_info = []
+    for _ in range(core_count):
+        core_info.append(struct.unpack_from(TRACE_CORE_FORMAT, data, pos))
+        pos += struct.calcsize(TRACE_CORE_FORMAT)
+
+    cores = []
+    for core, (recorded, count) in enumerate(core_info):
+        if pos + count * TRACE_EVENT_SIZE > len(data):
+            raise TraceFormatError(f"core {core} events run past the end of the capture")
+        events = []
+        for time_us, trace_id, event_type, arg in struct.iter_unpack(
+                TRACE_EVENT_FORMAT, data[pos:pos + count * TRACE_EVENT_SIZE]):
+            age_us = (capture_us - time_us) & 0xFFFFFFFF
+            events.append((-age_us, trace_id, event_type, arg))
+        pos += count * TRACE_EVENT_SIZE
+        # A task preempted between its timestamp and slot reservation lands slightly out of order
+        events.sort(key=lambda e: e[0])
+        cores.append({'recorded': recorded, 'overwritten': recorded - count, 'events': events})
+
+    oldest = min((c['events'][0][0] for c in cores if c['events']), default=0)
+    for c in cores:
+        c['events'] = [(t - oldest, i, ty, a) for t, i, ty, a in c['events']]
+    return {'capture_us': capture_us, 'cores': cores}
+
+
+def build_slices(trace: Dict) -> List[Dict]:
+    """Pairs BEGIN/END records into slices: {core, id, start_us, dur_us}. Records cut off by
+    the ring (an END without its BEGIN, a BEGIN still open at capture) are dropped."""
+    slices = []
+    for core, c in enumerate(trace['cores']):
+        open_begin: Dict[int, int] = {}
+        for t, trace_id, event_type, _ in c['events']:
+            if event_type == TRACE_EVENT_BEGIN:
+                open_begin[trace_id] = t
+            elif event_type == TRACE_EVENT_END and trace_id in open_begin:
+                start = open_begin.pop(trace_id)
+                slices.append({'core': core, 'id': trace_id, 'start_us': start, 'dur_us': t - start})
+    slices.sort(key=lambda s: s['start_us'])
+    return slices
+
+
+def to_chrome_trace(trace: Dict, slices: Optional[List[Dict]] = None) -> Dict:
+    """Chrome trace event format: one process per core, one thread per task track."""
+    if slices is None:
+        slices = build_slices(trace)
+
+    tids: Dict[str, int] = {}
+
+    def tid_for(track: str) -> int:
+        return tids.setdefault(track, len(tids) + 1)
+
+    events = []
+    for s in slices:
+        events.append({'name': trace_name(s['id']), 'ph': 'X', 'pid': s['core'],
+                       'tid': tid_for(trace_track(s['id'])), 'ts': s['start_us'], 'dur': s['dur_us']})
+
+    for core, c in enumerate(trace['cores']):
+        for t, trace_id, event_type, arg in c['events']:
+            if event_type != TRACE_EVENT_INSTANT:
+                continue
+            args = {'full': True} if arg == TRACE_ARG_QUEUE_FULL else {'waiting': arg}
+            events.append({'name': trace_name(trace_id), 'ph': 'i', 's': 't', 'pid': core,
+                           'tid': tid_for(trace_track(trace_id)), 'ts': t, 'args': args})
+
+    # Metadata last so every (pid, tid) pair seen above gets a name
+    used = sorted({(e['pid'], e['tid']) for e in events})
+    track_names = {tid: track for track, tid in tids.items()}
+    for core in range(len(trace['cores'])):
+        events.append({'name': 'process_name', 'ph': 'M', 'pid': core, 'args': {'name': f"Core {core}"}})
+    for pid, tid in used:
+        events.append({'name': 'thread_name', 'ph': 'M', 'pid': pid, 'tid': tid,
+                       'args': {'name': track_names[tid]}})
+
+    return {
+        'traceEvents': events,
+        'displayTimeUnit': 'ms',
+        'otherData': {
+            'source': 'smart-grind-by-weight task trace',
+            'overwritten': [c['overwritten'] for c in trace['cores']],
+        },
+    }
+
+
+def percentile(sorted_values: List[int], pct: float) -> int:
+    if not sorted_values:
+        return 0
+    rank = min(len(sorted_values) - 1, max(0, int(round(pct / 100.0 * (len(sorted_values) - 1)))))
+    return sorted_values[rank]
+
+
+def log2_histogram(values: List[int]) -> List[tuple]:
+    """(upper bound us, count) buckets at powers of two."""
+    buckets: Dict[int, int] = {}
+    for v in values:
+        bound = 1
+        while bound < v:
+            bound <<= 1
+        buckets[bound] = buckets.get(bound, 0) + 1
+    return sorted(buckets.items())
+
+
+def task_statistics(slices: List[Dict]) -> Dict[str, Dict]:
+    """Per task: cycle duration and start-to-start period percentiles."""
+    by_task: Dict[tuple, List[Dict]] = {}
+    for s in slices:
+        by_task.setdefault((s['core'], s['id']), []).append(s)
+
+    stats = {}
+    for (core, trace_id), items in sorted(by_task.items()):
+        durations = sorted(s['dur_us'] for s in items)
+        starts = [s['start_us'] for s in items]
+        periods = sorted(b - a for a, b in zip(starts, starts[1:]))
+        stats[f"{trace_name(trace_id)}@{core}"] = {
+            'count': len(items),
+            'duration': {f"p{p}": percentile(durations, p) for p in PERCENTILES} | {'max': durations[-1]},
+            'period': ({f"p{p}": percentile(periods, p) for p in PERCENTILES} | {'max': periods[-1]}) if periods else {},
+            'duration_histogram': log2_histogram(durations),
+        }
+    return stats
+
+
+def print_report(trace: Dict, stats: Dict[str, Dict], histograms: bool = True):
+    span_us = max((c['events'][-1][0] for c in trace['cores'] if c['events']), default=0)
+    print(f"Trace: {span_us / 1000:.1f} ms captured", end="")
+    for core, c in enumerate(trace['cores']):
+        print(f" | core {core}: {len(c['events'])} records ({c['overwritten']} overwritten)", end="")
+    print()
+
+    header = f"{'Task':<18}{'Cycles':>8}  " + "".join(f"{'p' + str(p):>8}" for p in PERCENTILES) + f"{'max':>8}"
+    print("\nCycle duration (us)")
+    print(header)
+    for name, s in stats.items():
+        d = s['duration']
+        print(f"{name:<18}{s['count']:>8}  " + "".join(f"{d[f'p{p}']:>8}" for p in PERCENTILES) + f"{d['max']:>8}")
+
+    print("\nPeriod, start to start (us) - jitter shows as the spread")
+    print(header)
+    for name, s in stats.items():
+        d = s['period']
+        if not d:
+            continue
+        print(f"{name:<18}{s['count'] - 1:>8}  " + "".join(f"{d[f'p{p}']:>8}" for p in PERCENTILES) + f"{d['max']:>8}")
+
+    if histograms:
+        for name, s in stats.items():
+            total = s['count']
+            print(f"\n{name} duration histogram")
+            for bound, count in s['duration_histogram']:
+                bar = '#' * max(1, round(40 * count / total))
+                print(f"  <= {bound:>7} us {count:>7}  {bar}")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Decode a grinder task trace capture")
+    parser.add_argument('capture', help="Raw capture from `grinder-ble.py trace --raw`")
+    parser.add_argument('--json', metavar='FILE', help="Write Chrome/Perfetto trace JSON")
+    parser.add_argument('--no-histograms', action='store_true', help="Only print the percentile tables")
+    args = parser.parse_args()
+
+    with open(args.capture, 'rb') as f:
+        data = f.read()
+    try:
+        trace = parse_trace(data)
+    except TraceFormatError as e:
+        print(f"[ERROR] {args.capture}: {e}")
+        return 1
+
+    slices = build_slices(trace)
+    print_report(trace, task_statistics(slices), not args.no_histograms)
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(to_chrome_trace(trace, slices), f)
+        print(f"\n[OK] Trace JSON written to {args.json}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,503 @@
+#!/usr/bin/env python3
+"""
+Glyph subsetting for the large LVGL fonts in src/font/.
+
+The 50-60 px Montserrat fonts are full lv_font_conv outputs (ASCII, degree sign, bullet and the
+FontAwesome symbols), but the UI only draws numeric readouts with them. This module parses an
+lv_font_conv C file, keeps the glyphs listed in src/font/font_subsets.json and writes a drop-in
+replacement with the same public symbol - bitmaps, glyph descriptors, character map and kerning
+classes are all cut down to the kept glyphs.
+
+Bitmaps can optionally be stored in LVGL's compressed format (RLE with line prefilter, the same
+encoding lv_font_conv produces without --no-compress). That needs LV_USE_FONT_COMPRESSED in
+lv_conf.h and costs a decode on every glyph draw, so it is opt-in per font.
+"""
+
+import json
+import os
+import re
+
+
+# ------------------------------------------------------------------------------------------------
+# Parsing
+# ------------------------------------------------------------------------------------------------
+
+_HEX = re.compile(r'0x[0-9a-fA-F]+')
+_INT = re.compile(r'-?\d+')
+_GLYPH_DSC = re.compile(
+    r'\{\.bitmap_index = (\d+), \.adv_w = (\d+), \.box_w = (\d+), \.box_h = (\d+), '
+    r'\.ofs_x = (-?\d+), \.ofs_y = (-?\d+)\}')
+_CMAP = re.compile(
+    r'\.range_start = (\d+), \.range_length = (\d+), \.glyph_id_start = (\d+),\s*'
+    r'\.unicode_list = (\w+), \.glyph_id_ofs_list = (\w+), \.list_length = (\d+), '
+    r'\.type = (\w+)')
+
+
+def _array_body(source, name):
+    """Text between the braces of `name[] = { ... };`, or None if the array is absent."""
+    match = re.search(r'\b' + name + r'\[\] = \{(.*?)\n\};', source, re.S)
+    return match.group(1) if match else None
+
+
+def _array_values(source, name, pattern=_INT):
+    body = _array_body(source, name)
+    if body is None:
+        return None
+    # Drop comments first - glyph bitmaps are annotated with /* U+0030 "0" */
+    body = re.sub(r'/\*.*?\*/', '', body)
+    return [int(token, 0) for token in pattern.findall(body)]
+
+
+def _field(source, name, default=None):
+    match = re.search(r'\.' + name + r'\s*=\s*(-?\d+)', source)
+    if match:
+        return int(match.group(1))
+    if default is None:
+        raise ValueError(f"font field .{name} not found")
+    return default
+
+
+def parse_font(path):
+    """Parse an lv_font_conv generated C font into a dict of its tables."""
+    with open(path, 'r') as f:
+        source = f.read()
+
+    name = re.search(r'lv_font_t (\w+) = \{', source).group(1)
+    guard = re.search(r'#if (LV_FONT_\w+)\n', source).group(1)
+    header = re.match(r'/\*+\n(.*?)\n \*+/', source, re.S).group(1)
+
+    bpp = _field(source, 'bpp')
+    if _field(source, 'bitmap_format') != 0:
+        raise ValueError(f"{path}: only uncompressed (--no-compress) fonts can be subset")
+
+    glyphs = [dict(bitmap_index=int(m[0]), adv_w=int(m[1]), box_w=int(m[2]), box_h=int(m[3]),
+                   ofs_x=int(m[4]), ofs_y=int(m[5]))
+              for m in _GLYPH_DSC.findall(_array_body(source, 'glyph_dsc'))]
+
+    # Codepoint -> glyph id
+    glyph_ids = {}
+    for start, length, id_start, unicode_list, ofs_list, list_length, cmap_type in _CMAP.findall(source):
+        start, id_start = int(start), int(id_start)
+        if ofs_list != 'NULL':
+            raise ValueError(f"{path}: {cmap_type} character maps are not supported")
+        if cmap_type.endswith('FORMAT0_TINY'):
+            for i in range(int(length)):
+                glyph_ids[start + i] = id_start + i
+        else:
+            for i, offset in enumerate(_array_values(source, unicode_list, _HEX)):
+                glyph_ids[start + offset] = id_start + i
+
+    kerning = None
+    if re.search(r'\.kern_classes = 1', source):
+        kerning = dict(
+            left=_array_values(source, 'kern_left_class_mapping'),
+            right=_array_values(source, 'kern_right_class_mapping'),
+            values=_array_values(source, 'kern_class_values'),
+            left_cnt=_field(source, 'left_class_cnt'),
+            right_cnt=_field(source, 'right_class_cnt'),
+            scale=_field(source, 'kern_scale'))
+    elif not re.search(r'\.kern_dsc = NULL', source):
+        raise ValueError(f"{path}: only class based kerning (--force-fast-kern-format) is supported")
+
+    return dict(
+        name=name, guard=guard, header=header, bpp=bpp,
+        bitmap=_array_values(source, 'glyph_bitmap', _HEX),
+        glyphs=glyphs, glyph_ids=glyph_ids, kerning=kerning,
+        line_height=_field(source, 'line_height'), base_line=_field(source, 'base_line'),
+        underline_position=_field(source, 'underline_position', 0),
+        underline_thickness=_field(source, 'underline_thickness', 0))
+
+
+def glyph_bitmap(font, glyph_id):
+    glyph = font['glyphs'][glyph_id]
+    size = (glyph['box_w'] * glyph['box_h'] * font['bpp'] + 7) // 8
+    return font['bitmap'][glyph['bitmap_index']:glyph['bitmap_index'] + size]
+
+
+# ------------------------------------------------------------------------------------------------
+# LVGL compressed bitmaps (lv_font_fmt_txt.c: rle_next() / decompress())
+# ------------------------------------------------------------------------------------------------
+
+class _BitWriter:
+    def __init__(self):
+        self.data = bytearray()
+        self.bits = 0
+
+    def write(self, value, length):
+        for shift in range(length - 1, -1, -1):
+            if self.bits % 8 == 0:
+                self.data.append(0)
+            if (value >> shift) & 1:
+                self.data[-1] |= 0x80 >> (self.bits % 8)
+            self.bits += 1
+
+
+class _BitReader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def read(self, length):
+        value = 0
+        for _ in range(length):
+            byte = self.data[self.pos >> 3] if (self.pos >> 3) < len(self.data) else 0
+            value = (value << 1) | ((byte >> (7 - (self.pos & 7))) & 1)
+            self.pos += 1
+        return value
+
+
+def _pixels(bitmap, width, height, bpp):
+    reader = _BitReader(bitmap)
+    return [reader.read(bpp) for _ in range(width * height)]
+
+
+def _prefilter(pixels, width):
+    return [value ^ pixels[i - width] if i >= width else value for i, value in enumerate(pixels)]
+
+
+def _rle_encode(values, bpp):
+    """Encode so that LVGL's rle_next() reproduces `values`.
+
+    A literal equal to the previous one switches the decoder to repeat mode, where each '1' bit
+    repeats the value; after 11 repeats a 6-bit counter covers up to 62 more. A '0' bit (or the
+    end of a counter run) is followed by the next literal.
+    """
+    out = _BitWriter()
+    i, count = 0, len(values)
+    prev = None
+    repeating = False
+    while i < count:
+        value = values[i]
+        if not repeating:
+            out.write(value, bpp)
+            repeating = i > 0 and value == prev
+            repeat_bits = 0
+            prev = value
+            i += 1
+        elif value == prev:
+            out.write(1, 1)
+            repeat_bits += 1
+            i += 1
+            if repeat_bits == 11:
+                run = 0
+                while i + run < count and values[i + run] == prev and run < 62:
+                    run += 1
+                # Counter n yields n-1 repeats, then a literal; 0 would redefine this pixel
+                out.write(run + 1, 6)
+                i += run
+                if i < count:
+                    prev = values[i]
+                    out.write(prev, bpp)
+                    i += 1
+                repeating = False
+        else:
+            out.write(0, 1)
+            out.write(value, bpp)
+            prev = value
+            repeating = False
+            i += 1
+    return bytes(out.data)
+
+
+def _rle_decode(data, count, bpp):
+    """Python port of LVGL's rle_next(), used to check every encoded glyph."""
+    reader = _BitReader(data)
+    state, prev, repeats, values = 'single', 0, 0, []
+    for index in range(count):
+        if state == 'single':
+            value = reader.read(bpp)
+            if index > 0 and value == prev:
+                state, repeats = 'repeated', 0
+            prev = value
+        elif state == 'repeated':
+            repeats += 1
+            if reader.read(1):
+                value = prev
+                if repeats == 11:
+                    repeats = reader.read(6)
+                    if repeats:
+                        state = 'counter'
+                    else:
+                        value = prev = reader.read(bpp)
+                        state = 'single'
+            else:
+                value = prev = reader.read(bpp)
+                state = 'single'
+        else:
+            value = prev
+            repeats -= 1
+            if repeats == 0:
+                value = prev = reader.read(bpp)
+                state = 'single'
+        values.append(value)
+    return values
+
+
+def compress_glyph(bitmap, width, height, bpp):
+    pixels = _pixels(bitmap, width, height, bpp)
+    filtered = _prefilter(pixels, width)
+    encoded = _rle_encode(filtered, bpp)
+    if _rle_decode(encoded, len(filtered), bpp) != filtered:
+        raise AssertionError("compressed glyph does not decode back to the original")
+    return encoded
+
+
+# ------------------------------------------------------------------------------------------------
+# Subsetting
+# ------------------------------------------------------------------------------------------------
+
+def subset_font(font, codepoints, compress=False):
+    """Return a new font dict holding only `codepoints` (sorted, all must exist in the font)."""
+    missing = [cp for cp in codepoints if cp not in font['glyph_ids']]
+    if missing:
+        raise ValueError(f"{font['name']}: glyphs not in the font: " +
+                         ", ".join(f"U+{cp:04X}" for cp in missing))
+
+    old_ids = [font['glyph_ids'][cp] for cp in codepoints]
+    bitmap = []
+    glyphs = [dict(bitmap_index=0, adv_w=0, box_w=0, box_h=0, ofs_x=0, ofs_y=0)]
+    for old_id in old_ids:
+        glyph = dict(font['glyphs'][old_id], bitmap_index=len(bitmap))
+        data = glyph_bitmap(font, old_id)
+        if compress and glyph['box_w'] and glyph['box_h']:
+            data = compress_glyph(data, glyph['box_w'], glyph['box_h'], font['bpp'])
+        bitmap.extend(data)
+        glyphs.append(glyph)
+    if compress:
+        bitmap.append(0)  # rle reads two bytes at a time near the end of a glyph
+
+    kerning = None
+    old = font['kerning']
+    if old:
+        # Keep only the classes the remaining glyphs use, renumbered from 1
+        left_used = sorted({old['left'][gid] for gid in old_ids} - {0})
+        right_used = sorted({old['right'][gid] for gid in old_ids} - {0})
+        values = [old['values'][(l - 1) * old['right_cnt'] + (r - 1)]
+                  for l in left_used for r in right_used]
+        if any(values):
+            left_map = {c: i + 1 for i, c in enumerate(left_used)}
+            right_map = {c: i + 1 for i, c in enumerate(right_used)}
+            kerning = dict(
+                left=[0] + [left_map.get(old['left'][gid], 0) for gid in old_ids],
+                right=[0] + [right_map.get(old['right'][gid], 0) for gid in old_ids],
+                values=values, left_cnt=len(left_used), right_cnt=len(right_used),
+                scale=old['scale'])
+
+    return dict(font, bitmap=bitmap, glyphs=glyphs, kerning=kerning, compressed=compress,
+                glyph_ids={cp: i + 1 for i, cp in enumerate(codepoints)})
+
+
+def flash_bytes(font):
+    """Approximate const data size: bitmaps, 8-byte glyph descriptors, cmap and kerning tables."""
+    size = len(font['bitmap']) + 8 * len(font['glyphs'])
+    size += 20 + 2 * len(font['glyph_ids'])
+    if font['kerning']:
+        kerning = font['kerning']
+        size += len(kerning['left']) + len(kerning['right']) + len(kerning['values']) + 16
+    return size
+
+
+# ------------------------------------------------------------------------------------------------
+# Output
+# ------------------------------------------------------------------------------------------------
+
+def _format_array(values, per_line, fmt):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(fmt(v) for v in values[i:i + per_line]))
+    return ",\n".join(lines)
+
+
+def _glyph_comment(cp):
+    char = chr(cp)
+    if cp < 0x80 and char.isprintable():
+        return f'U+{cp:04X} "{char}"'
+    return f'U+{cp:04X}'
+
+
+def emit_font(font, source_name):
+    """Render the font dict as an lv_font_conv style C file."""
+    codepoints = sorted(font['glyph_ids'], key=font['glyph_ids'].get)
+    out = []
+    out.append("/*******************************************************************************\n")
+    out.append(font['header'] + "\n")
+    out.append(f" * Subset of {source_name}: " +
+               "".join(chr(cp) if 0x20 < cp < 0x7F else f"\\u{cp:04x}" for cp in codepoints) + "\n")
+    out.append(" * Generated by tools/build-scripts/font_subset.py - DO NOT EDIT MANUALLY\n")
+    out.append(" ******************************************************************************/\n\n")
+    out.append("#ifdef LV_LVGL_H_INCLUDE_SIMPLE\n    #include \"lvgl.h\"\n#else\n    #include \"../../lvgl.h\"\n#endif\n\n")
+    out.append(f"#ifndef {font['guard']}\n    #define {font['guard']} 1\n#endif\n\n#if {font['guard']}\n\n")
+
+    out.append("/*-----------------\n *    BITMAPS\n *----------------*/\n\n")
+    out.append("/*Store the image of the glyphs*/\n")
+    out.append("static LV_ATTRIBUTE_LARGE_CONST const uint8_t glyph_bitmap[] = {\n")
+    for index, cp in enumerate(codepoints):
+        glyph = font['glyphs'][index + 1]
+        end = font['glyphs'][index + 2]['bitmap_index'] if index + 2 < len(font['glyphs']) else len(font['bitmap'])
+        data = font['bitmap'][glyph['bitmap_index']:end]
+        out.append(f"    /* {_glyph_comment(cp)} */\n")
+        if data:
+            out.append(_format_array(data, 8, lambda v: f"0x{v:x}") + ",\n")
+        out.append("\n")
+    out[-1] = "};\n\n\n"
+
+    out.append("/*---------------------\n *  GLYPH DESCRIPTION\n *--------------------*/\n\n")
+    out.append("static const lv_font_fmt_txt_glyph_dsc_t glyph_dsc[] = {\n")
+    rows = []
+    for index, glyph in enumerate(font['glyphs']):
+        row = ("    {{.bitmap_index = {bitmap_index}, .adv_w = {adv_w}, .box_w = {box_w}, "
+               ".box_h = {box_h}, .ofs_x = {ofs_x}, .ofs_y = {ofs_y}}}").format(**glyph)
+        rows.append(row + (" /* id = 0 reserved */" if index == 0 else ""))
+    out.append(",\n".join(rows) + "\n};\n\n")
+
+    start = codepoints[0]
+    out.append("/*---------------------\n *  CHARACTER MAPPING\n *--------------------*/\n\n")
+    out.append("static const uint16_t unicode_list_0[] = {\n")
+    out.append(_format_array([cp - start for cp in codepoints], 8, lambda v: f"0x{v:x}") + "\n};\n\n")
+    out.append("/*Collect the unicode lists and glyph_id offsets*/\n")
+    out.append("static const lv_font_fmt_txt_cmap_t cmaps[] = {\n    {\n")
+    out.append(f"        .range_start = {start}, .range_length = {codepoints[-1] - start + 1}, .glyph_id_start = 1,\n")
+    out.append(f"        .unicode_list = unicode_list_0, .glyph_id_ofs_list = NULL, .list_length = {len(codepoints)}, "
+               ".type = LV_FONT_FMT_TXT_CMAP_SPARSE_TINY\n    }\n};\n\n")
+
+    kerning = font['kerning']
+    if kerning:
+        out.append("/*-----------------\n *    KERNING\n *----------------*/\n\n\n")
+        out.append("/*Map glyph_ids to kern left classes*/\n")
+        out.append("static const uint8_t kern_left_class_mapping[] = {\n")
+        out.append(_format_array(kerning['left'], 8, str) + "\n};\n\n")
+        out.append("/*Map glyph_ids to kern right classes*/\n")
+        out.append("static const uint8_t kern_right_class_mapping[] = {\n")
+        out.append(_format_array(kerning['right'], 8, str) + "\n};\n\n")
+        out.append("/*Kern values between classes*/\n")
+        out.append("static const int8_t kern_class_values[] = {\n")
+        out.append(_format_array(kerning['values'], 8, str) + "\n};\n\n\n")
+        out.append("/*Collect the kern class' data in one place*/\n")
+        out.append("static const lv_font_fmt_txt_kern_classes_t kern_classes = {\n")
+        out.append("    .class_pair_values   = kern_class_values,\n")
+        out.append("    .left_class_mapping  = kern_left_class_mapping,\n")
+        out.append("    .right_class_mapping = kern_right_class_mapping,\n")
+        out.append(f"    .left_class_cnt      = {kerning['left_cnt']},\n")
+        out.append(f"    .right_class_cnt     = {kerning['right_cnt']},\n}};\n\n")
+
+    out.append("/*--------------------\n *  ALL CUSTOM DATA\n *--------------------*/\n\n")
+    out.append("#if LVGL_VERSION_MAJOR == 8\n    /*Store all the custom data of the font*/\n"
+               "    static  lv_font_fmt_txt_glyph_cache_t cache;\n#endif\n\n")
+    out.append("#if LVGL_VERSION_MAJOR >= 8\nstatic const lv_font_fmt_txt_dsc_t font_dsc = {\n#else\n"
+               "static lv_font_fmt_txt_dsc_t font_dsc = {\n#endif\n")
+    out.append("    .glyph_bitmap = glyph_bitmap,\n    .glyph_dsc = glyph_dsc,\n    .cmaps = cmaps,\n")
+    if kerning:
+        out.append(f"    .kern_dsc = &kern_classes,\n    .kern_scale = {kerning['scale']},\n")
+    else:
+        out.append("    .kern_dsc = NULL,\n    .kern_scale = 0,\n")
+    out.append(f"    .cmap_num = 1,\n    .bpp = {font['bpp']},\n    .kern_classes = {1 if kerning else 0},\n")
+    out.append(f"    .bitmap_format = {1 if font.get('compressed') else 0},\n")
+    out.append("#if LVGL_VERSION_MAJOR == 8\n    .cache = &cache\n#endif\n};\n\n\n\n")
+
+    out.append("/*-----------------\n *  PUBLIC FONT\n *----------------*/\n\n")
+    out.append("/*Initialize a public general font descriptor*/\n")
+    out.append(f"#if LVGL_VERSION_MAJOR >= 8\nconst lv_font_t {font['name']} = {{\n#else\n"
+               f"lv_font_t {font['name']} = {{\n#endif\n")
+    out.append("    .get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt,    /*Function pointer to get glyph's data*/\n")
+    out.append("    .get_glyph_bitmap = lv_font_get_bitmap_fmt_txt,    /*Function pointer to get glyph's bitmap*/\n")
+    out.append(f"    .line_height = {font['line_height']},          /*The maximum line height required by the font*/\n")
+    out.append(f"    .base_line = {font['base_line']},             /*Baseline measured from the bottom of the line*/\n")
+    out.append("#if !(LVGL_VERSION_MAJOR == 6 && LVGL_VERSION_MINOR == 0)\n    .subpx = LV_FONT_SUBPX_NONE,\n#endif\n")
+    out.append("#if LV_VERSION_CHECK(7, 4, 0) || LVGL_VERSION_MAJOR >= 8\n")
+    out.append(f"    .underline_position = {font['underline_position']},\n")
+    out.append(f"    .underline_thickness = {font['underline_thickness']},\n#endif\n")
+    out.append("    .dsc = &font_dsc,          /*The custom font data. Will be accessed by `get_glyph_bitmap/dsc` */\n")
+    out.append("#if LV_VERSION_CHECK(8, 2, 0) || LVGL_VERSION_MAJOR >= 9\n    .fallback = NULL,\n#endif\n")
+    out.append("    .user_data = NULL,\n};\n\n\n\n")
+    out.append(f"#endif /*#if {font['guard']}*/\n")
+    return "".join(out)
+
+
+# ------------------------------------------------------------------------------------------------
+# Manifest driven build step
+# ------------------------------------------------------------------------------------------------
+
+def load_manifest(font_dir):
+    with open(os.path.join(font_dir, "font_subsets.json"), 'r') as f:
+        return json.load(f)
+
+
+def compression_enabled(lv_conf_path):
+    try:
+        with open(lv_conf_path, 'r') as f:
+            return re.search(r'#define LV_USE_FONT_COMPRESSED\s+1\b', f.read()) is not None
+    except IOError:
+        return False
+
+
+def referenced_fonts(src_dir):
+    """Names of the src/font fonts the firmware sources take the address of."""
+    names = set()
+    for root, dirs, files in os.walk(src_dir):
+        dirs[:] = [d for d in dirs if d not in ('font', 'native')]
+        for file in files:
+            if file.endswith(('.c', '.cpp', '.h')):
+                with open(os.path.join(root, file), 'r', errors='ignore') as f:
+                    names.update(re.findall(r'&(lv_font_montserrat_\d+)', f.read()))
+    return names
+
+
+def build_subsets(project_dir, out_dir=None, log=print):
+    """Subset every font in the manifest.
+
+    Writes <font>.c into out_dir when given (only if the content changed, so unchanged fonts don't
+    rebuild) and returns a list of (font name, generated path or None) for the fonts replaced.
+    """
+    font_dir = os.path.join(project_dir, "src", "font")
+    manifest = load_manifest(font_dir)
+    can_compress = compression_enabled(os.path.join(project_dir, "include", "lv_conf.h"))
+    used = referenced_fonts(os.path.join(project_dir, "src"))
+
+    replaced = []
+    total_before = total_after = 0
+    log("=== Font subsets ===")
+    for file in sorted(os.listdir(font_dir)):
+        name, ext = os.path.splitext(file)
+        if ext != '.c':
+            continue
+        if name not in manifest['fonts']:
+            state = "referenced, not in font_subsets.json - kept whole" if name in used else \
+                    "unreferenced - dropped by the linker"
+            log(f"  {name}: {state}")
+            continue
+
+        entry = manifest['fonts'][name]
+        codepoints = sorted({ord(ch) for text in entry['screens'].values() for ch in text})
+        font = parse_font(os.path.join(font_dir, file))
+        plain = subset_font(font, codepoints)
+        packed = subset_font(font, codepoints, compress=True)
+        compress = entry.get('compress', False)
+        if compress and not can_compress:
+            log(f"  {name}: compression requested but LV_USE_FONT_COMPRESSED is 0 - storing plain bitmaps")
+            compress = False
+        result = packed if compress else plain
+
+        before, after = flash_bytes(font), flash_bytes(result)
+        total_before += before
+        total_after += after
+        note = "" if compress else f", {flash_bytes(packed)} B if compressed"
+        log(f"  {name}: {len(font['glyph_ids'])} -> {len(codepoints)} glyphs, "
+            f"{before} -> {after} B (saves {before - after} B{note})"
+            + ("" if name in used else " [unreferenced]"))
+
+        path = None
+        if out_dir:
+            os.makedirs(out_dir, exist_ok=True)
+            path = os.path.join(out_dir, file)
+            content = emit_font(result, file)
+            existing = None
+            if os.path.exists(path):
+                with open(path, 'r') as f:
+                    existing = f.read()
+            if existing != content:
+                with open(path, 'w') as f:
+                    f.write(content)
+        replaced.append((name, path))
+
+    log(f"  Total: {total_before} -> {total_after} B (saves {total_before - total_after} B)")
+    return replaced
@@ -2,7 +2,8 @@
 """
 Pre-build script for PlatformIO build system.
 This script automatically increments build numbers, captures Git commit ID and branch information,
-and creates a header file with the build information.
+and creates a header file with the build information. It also swaps the large fonts in src/font/
+for glyph subsets (see font_subset.py and src/font/font_subsets.json).
 """
 
 try:
@@ -130,9 +131,44 @@ def create_git_info_header():
     except Exception as e:
         print(f"Error creating header file: {e}", file=sys.stderr)
 
+def get_project_root():
+    if platformio_mode:
+        return env.get("PROJECT_DIR", os.getcwd())
+    return os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+def subset_fonts(report_only=False):
+    """Build the large fonts from the glyph subsets listed in src/font/font_subsets.json."""
+    project_root = get_project_root()
+    sys.path.insert(0, os.path.join(project_root, "tools", "build-scripts"))
+    import font_subset
+
+    if report_only:
+        font_subset.build_subsets(project_root)
+        return
+
+    if env.GetProjectOption("custom_font_subset", "yes").lower() in ("no", "false", "0"):
+        print("Font subsetting disabled (custom_font_subset) - building full fonts")
+        return
+
+    out_dir = os.path.join(env.subst("$BUILD_DIR"), "font_subset")
+    try:
+        replaced = font_subset.build_subsets(project_root, out_dir)
+    except (ValueError, IOError) as e:
+        print(f"Warning: Font subsetting failed, building full fonts: {e}", file=sys.stderr)
+        return
+
+    # Compile the generated subsets instead of the full fonts in src/font/
+    for name, _ in replaced:
+        env.AddBuildMiddleware(lambda env, node: None, f"*/font/{name}.c")
+    if replaced:
+        env.BuildSources(os.path.join("$BUILD_DIR", "font_subset_obj"), out_dir)
+
 def main():
     """Main function to handle different modes."""
-    if len(sys.argv) > 1 and sys.argv[1] == "--header":
+    if len(sys.argv) > 1 and sys.argv[1] == "--fonts":
+        # Report the font subset savings without building
+        subset_fonts(report_only=True)
+    elif len(sys.argv) > 1 and sys.argv[1] == "--header":
         # Generate header file mode (manual call)
         create_git_info_header()
     else:
@@ -145,6 +181,8 @@ def main():
 # When run from PlatformIO, execute immediately
 if platformio_mode:
     create_git_info_header()
+    if env.get("PIOPLATFORM") != "native":
+        subset_fonts()
 
 # When run manually
 if __name__ == "__main__":
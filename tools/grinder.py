@@ -394,6 +394,26 @@ class GrinderTool:
 
         return await self.run_async_command(cmd)
 
+    async def cmd_trace(self, args: argparse.Namespace) -> int:
+        """Download the task timing trace."""
+        self.print_header("Task Trace")
+
+        if not self.check_venv():
+            return 1
+
+        cmd = [str(self.venv_python), str(self.ble_tool), "trace"]
+
+        if hasattr(args, 'device') and args.device:
+            cmd.extend(["--device", args.device])
+
+        if hasattr(args, 'out') and args.out:
+            cmd.extend(["--out", args.out])
+
+        if hasattr(args, 'raw') and args.raw:
+            cmd.extend(["--raw", args.raw])
+
+        return await self.run_async_command(cmd)
+
     def cmd_install(self, args: argparse.Namespace) -> int:
         """Manually install Python dependencies."""
         self.print_header("Installing Dependencies")
@@ -461,6 +481,7 @@ def create_parser() -> argparse.ArgumentParser:
   python3 grinder.py upload --device MyGrinder # Upload to specific device
   python3 grinder.py connect                   # Connect to grinder device
   python3 grinder.py info                      # Get device system information
+  python3 grinder.py trace --out trace.json    # Task timing trace for Perfetto
         """
     )
     
@@ -509,6 +530,11 @@ def create_parser() -> argparse.ArgumentParser:
     diagnostics_parser.add_argument('--device', default='GrindByWeight', help='Specify device name')
     diagnostics_parser.add_argument('--save', metavar='FILE', help='Save report to file (default: print to console)')
 
+    trace_parser = subparsers.add_parser('trace', help='Download task timing trace and print per-task percentiles')
+    trace_parser.add_argument('--device', default='GrindByWeight', help='Specify device name')
+    trace_parser.add_argument('--out', metavar='FILE', help='Write Chrome/Perfetto trace JSON')
+    trace_parser.add_argument('--raw', metavar='FILE', help='Save the raw capture')
+
     # Development Commands
     install_parser = subparsers.add_parser('install', help='Manually install Python dependencies (auto-setup when needed)')
     monitor_parser = subparsers.add_parser('monitor', help='Monitor live debug output via BLE (alias for debug)')
@@ -551,6 +577,8 @@ async def main():
             return await tool.cmd_info(args)
         elif args.command == 'diagnostics':
             return await tool.cmd_diagnostics(args)
+        elif args.command == 'trace':
+            return await tool.cmd_trace(args)
         elif args.command == 'install':
             return tool.cmd_install(args)
         elif args.command == 'clean':
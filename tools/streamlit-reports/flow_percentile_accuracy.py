@@ -0,0 +1,67 @@
+"""
+Accuracy check of the firmware's 95th percentile flow rate against the Python
+reference in circular_buffer_math.py
+
+Input is the CSV written by the native host tool:
+    .pio/build/native/program p95-report --csv p95.csv
+    python flow_percentile_accuracy.py p95.csv
+
+For each query row the reference is evaluated on the samples seen up to that
+timestamp and compared with both firmware answers (single-pass sweep and scan per sub-window).
+"""
+import argparse
+import sys
+
+import numpy as np
+import pandas as pd
+
+from circular_buffer_math import calculate_95th_percentile_flow_rate
+
+PULSE_FLOW_WINDOW_MS = 2500  # WeightGrindStrategy motor stop query
+MATCH_TOLERANCE_GPS = 0.001
+
+
+def summarize(label: str, errors: np.ndarray) -> None:
+    if len(errors) == 0:
+        return
+    matches = np.mean(errors <= MATCH_TOLERANCE_GPS) * 100.0
+    print(f"  {label:<22} n {len(errors):7d}  match {matches:6.2f}%  "
+          f"mae {errors.mean():.4f}  p99 {np.percentile(errors, 99):.4f}  max {errors.max():.4f} g/s")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('csv', help='CSV written by p95-report --csv')
+    parser.add_argument('--every', type=int, default=10,
+                        help='evaluate every Nth control tick query (motor stop queries are always evaluated)')
+    args = parser.parse_args()
+
+    data = pd.read_csv(args.csv)
+    samples = data[data['kind'] == 'sample']
+    queries = data[data['kind'] != 'sample']
+    queries = queries[(queries['kind'] == 'stop') | (np.arange(len(queries)) % max(1, args.every) == 0)]
+
+    rows = []
+    for grind, grind_queries in queries.groupby('grind'):
+        measurements = samples[samples['grind'] == grind][['timestamp_ms', 'weight_grams']]
+        for query in grind_queries.itertuples():
+            now_ms = int(query.timestamp_ms)
+            reference = calculate_95th_percentile_flow_rate(
+                measurements[measurements['timestamp_ms'] <= now_ms], now_ms, PULSE_FLOW_WINDOW_MS)
+            rows.append((query.kind, reference, query.sweep_gps, query.scan_gps))
+
+    if not rows:
+        print("No queries found")
+        return 1
+
+    results = pd.DataFrame(rows, columns=['kind', 'reference', 'sweep', 'scan'])
+    print(f"Python reference vs firmware ({len(results)} queries, {PULSE_FLOW_WINDOW_MS}ms window)")
+    for kind, label in (('query', 'ticks'), ('stop', 'motor stop')):
+        subset = results[results['kind'] == kind]
+        summarize(f"sweep {label}", np.abs(subset['sweep'] - subset['reference']).to_numpy())
+        summarize(f"scan {label}", np.abs(subset['scan'] - subset['reference']).to_numpy())
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())